@@ -0,0 +1,235 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+/*
+ * Compression ratio and decompression speed of firmware LZ codec.
+ *
+ * Usage : vs-bench-firmware-lz <firmware image> [<firmware image> ...]
+ *
+ * Each image is compressed by all supported windows. Decompression is performed the same way as Thing does it :
+ * compressed stream is passed by FLDT-sized parts and is decompressed to firmware chunks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <update-config.h>
+
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/firmware/firmware_compression.h>
+
+#define BENCH_INPUT_PART_SIZE (200)
+#define BENCH_CHUNK_SIZE (4096)
+#define BENCH_MIN_DURATION (0.5)
+
+/*************************************************************************/
+bool
+vs_logger_output_hal(const char *buffer) {
+    return buffer && fputs(buffer, stderr) >= 0;
+}
+
+/*************************************************************************/
+static double
+_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*************************************************************************/
+static uint8_t *
+_load_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    uint8_t *data = NULL;
+    long file_sz;
+
+    if (!f) {
+        return NULL;
+    }
+
+    if (0 == fseek(f, 0, SEEK_END) && (file_sz = ftell(f)) > 0 && 0 == fseek(f, 0, SEEK_SET)) {
+        data = malloc(file_sz);
+        if (data && fread(data, 1, file_sz, f) != (size_t)file_sz) {
+            free(data);
+            data = NULL;
+        }
+        *size = file_sz;
+    }
+
+    fclose(f);
+    return data;
+}
+
+/*************************************************************************/
+static bool
+_decompress(const uint8_t *compressed, size_t compressed_sz, uint8_t *out, size_t out_sz) {
+    vs_firmware_lz_ctx_t ctx;
+    uint8_t chunk[BENCH_CHUNK_SIZE];
+    size_t chunk_used = 0;
+    size_t out_pos = 0;
+    size_t pos;
+    size_t part;
+    size_t in_used;
+    size_t out_used;
+    size_t room;
+
+    if (VS_CODE_OK != vs_firmware_lz_decode_init(&ctx)) {
+        return false;
+    }
+
+    for (pos = 0; pos < compressed_sz && out_pos < out_sz;) {
+        part = compressed_sz - pos > BENCH_INPUT_PART_SIZE ? BENCH_INPUT_PART_SIZE : compressed_sz - pos;
+
+        while (part && out_pos < out_sz) {
+            room = sizeof(chunk) - chunk_used;
+            if (room > out_sz - out_pos - chunk_used) {
+                room = out_sz - out_pos - chunk_used;
+            }
+
+            if (VS_CODE_OK !=
+                vs_firmware_lz_decode(&ctx, &compressed[pos], part, &in_used, &chunk[chunk_used], room, &out_used)) {
+                vs_firmware_lz_decode_free(&ctx);
+                return false;
+            }
+
+            pos += in_used;
+            part -= in_used;
+            chunk_used += out_used;
+
+            // Firmware chunk is ready to be saved
+            if (out_used == room) {
+                memcpy(&out[out_pos], chunk, chunk_used);
+                out_pos += chunk_used;
+                chunk_used = 0;
+            }
+        }
+    }
+
+    vs_firmware_lz_decode_free(&ctx);
+
+    return out_pos == out_sz;
+}
+
+/*************************************************************************/
+static bool
+_bench_image(const char *path) {
+    uint8_t *image;
+    uint8_t *compressed;
+    uint8_t *restored;
+    size_t image_sz = 0;
+    size_t compressed_buf_sz;
+    size_t compressed_sz;
+    uint8_t window_bits;
+    double start;
+    double encode_time;
+    double decode_time;
+    int iterations;
+    bool res = false;
+
+    image = _load_file(path, &image_sz);
+    if (!image) {
+        fprintf(stderr, "Unable to read %s\n", path);
+        return false;
+    }
+
+    compressed_buf_sz = image_sz + image_sz / 8 + 5;
+    compressed = malloc(compressed_buf_sz);
+    restored = malloc(image_sz);
+    if (!compressed || !restored) {
+        goto terminate;
+    }
+
+    printf("%s : %lu bytes\n", path, (unsigned long)image_sz);
+    printf("  window  compressed      ratio  encode, MB/s  decode, MB/s\n");
+
+    for (window_bits = 8; window_bits <= VS_FIRMWARE_LZ_WINDOW_BITS; ++window_bits) {
+        start = _now();
+        if (VS_CODE_OK !=
+            vs_firmware_lz_encode(image, image_sz, window_bits, compressed, compressed_buf_sz, &compressed_sz)) {
+            fprintf(stderr, "Unable to compress %s\n", path);
+            goto terminate;
+        }
+        encode_time = _now() - start;
+
+        iterations = 0;
+        start = _now();
+        do {
+            if (!_decompress(compressed, compressed_sz, restored, image_sz) || memcmp(image, restored, image_sz)) {
+                fprintf(stderr, "Decompressed %s differs from the original\n", path);
+                goto terminate;
+            }
+            ++iterations;
+        } while ((decode_time = _now() - start) < BENCH_MIN_DURATION);
+
+        printf("  %6lu  %10lu  %8.2f%%  %12.2f  %12.2f\n",
+               1UL << window_bits,
+               (unsigned long)compressed_sz,
+               100.0 * compressed_sz / image_sz,
+               image_sz / encode_time / 1e6,
+               iterations * image_sz / decode_time / 1e6);
+    }
+
+    res = true;
+
+terminate:
+    free(image);
+    free(compressed);
+    free(restored);
+
+    return res;
+}
+
+/*************************************************************************/
+int
+main(int argc, char *argv[]) {
+    int i;
+    int res = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage : %s <firmware image> [<firmware image> ...]\n", argv[0]);
+        return 1;
+    }
+
+    vs_logger_init(VS_LOGLEV_ERROR);
+
+    for (i = 1; i < argc; ++i) {
+        if (!_bench_image(argv[i])) {
+            res = 1;
+        }
+    }
+
+    return res;
+}
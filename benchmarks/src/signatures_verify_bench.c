@@ -0,0 +1,435 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+/*
+ * Signatures verification speed for different quantities of verification threads.
+ *
+ * Usage : vs-bench-signatures-verify [<signatures count>]
+ *
+ * Test recovery, auth and firmware keys are created by software Security Module in memory storage. Hash is signed by
+ * auth and firmware keys alternately, and signatures block is verified the same way as Firmware and Trust List are.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <trust_list-config.h>
+
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/provision/provision.h>
+#include <virgil/iot/secmodule/secmodule.h>
+#include <virgil/iot/secmodule/secmodule-helpers.h>
+#include <virgil/iot/secmodule/devices/secmodule-soft.h>
+#include <virgil/iot/vs-soft-secmodule/vs-soft-secmodule.h>
+
+#define BENCH_FILES_QTY (32)
+#define BENCH_FILE_SZ_LIMIT (64 * 1024)
+#define BENCH_SIGNATURES_DEFAULT (4)
+#define BENCH_MIN_DURATION (1.0)
+#define BENCH_KEY_BUF_SIZE (256)
+
+#define BENCH_REC_KEYPAIR VS_KEY_SLOT_STD_MTP_10
+#define BENCH_AUTH_KEYPAIR VS_KEY_SLOT_STD_MTP_11
+#define BENCH_FW_KEYPAIR VS_KEY_SLOT_STD_MTP_12
+
+typedef struct {
+    bool used;
+    vs_storage_element_id_t id;
+    uint8_t *data;
+    size_t size;
+} bench_file_t;
+
+static bench_file_t _files[BENCH_FILES_QTY];
+static pthread_mutex_t _files_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*************************************************************************/
+bool
+vs_logger_output_hal(const char *buffer) {
+    return buffer && fputs(buffer, stderr) >= 0;
+}
+
+/*************************************************************************/
+static double
+_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*************************************************************************/
+static bench_file_t *
+_find_file(const vs_storage_element_id_t id) {
+    int i;
+
+    for (i = 0; i < BENCH_FILES_QTY; ++i) {
+        if (_files[i].used && 0 == memcmp(_files[i].id, id, sizeof(vs_storage_element_id_t))) {
+            return &_files[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*************************************************************************/
+static vs_status_e
+_storage_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    int i;
+
+    pthread_mutex_lock(&_files_mutex);
+    for (i = 0; i < BENCH_FILES_QTY; ++i) {
+        free(_files[i].data);
+    }
+    memset(_files, 0, sizeof(_files));
+    pthread_mutex_unlock(&_files_mutex);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_storage_file_t
+_storage_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    bench_file_t *file;
+    int i;
+
+    pthread_mutex_lock(&_files_mutex);
+    file = _find_file(id);
+    for (i = 0; !file && i < BENCH_FILES_QTY; ++i) {
+        if (!_files[i].used) {
+            file = &_files[i];
+            file->used = true;
+            memcpy(file->id, id, sizeof(vs_storage_element_id_t));
+        }
+    }
+    pthread_mutex_unlock(&_files_mutex);
+
+    return file;
+}
+
+/*************************************************************************/
+static vs_status_e
+_storage_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_storage_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_storage_save(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              size_t offset,
+              const uint8_t *in_data,
+              size_t data_sz) {
+    bench_file_t *f = (bench_file_t *)file;
+    vs_status_e res = VS_CODE_OK;
+    uint8_t *data;
+
+    if (offset + data_sz > BENCH_FILE_SZ_LIMIT) {
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    pthread_mutex_lock(&_files_mutex);
+    if (offset + data_sz > f->size) {
+        data = realloc(f->data, offset + data_sz);
+        if (data) {
+            memset(&data[f->size], 0xFF, offset + data_sz - f->size);
+            f->data = data;
+            f->size = offset + data_sz;
+        } else {
+            res = VS_CODE_ERR_NO_MEMORY;
+        }
+    }
+    if (VS_CODE_OK == res) {
+        memcpy(&f->data[offset], in_data, data_sz);
+    }
+    pthread_mutex_unlock(&_files_mutex);
+
+    return res;
+}
+
+/*************************************************************************/
+static vs_status_e
+_storage_load(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              size_t offset,
+              uint8_t *out_data,
+              size_t data_sz) {
+    bench_file_t *f = (bench_file_t *)file;
+    vs_status_e res = VS_CODE_ERR_FILE_READ;
+
+    pthread_mutex_lock(&_files_mutex);
+    if (offset + data_sz <= f->size) {
+        memcpy(out_data, &f->data[offset], data_sz);
+        res = VS_CODE_OK;
+    }
+    pthread_mutex_unlock(&_files_mutex);
+
+    return res;
+}
+
+/*************************************************************************/
+static ssize_t
+_storage_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    bench_file_t *file;
+    ssize_t res;
+
+    pthread_mutex_lock(&_files_mutex);
+    file = _find_file(id);
+    res = (file && file->size) ? (ssize_t)file->size : VS_CODE_ERR_NOT_FOUND;
+    pthread_mutex_unlock(&_files_mutex);
+
+    return res;
+}
+
+/*************************************************************************/
+static vs_status_e
+_storage_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    bench_file_t *file;
+
+    pthread_mutex_lock(&_files_mutex);
+    file = _find_file(id);
+    if (file) {
+        free(file->data);
+        memset(file, 0, sizeof(*file));
+    }
+    pthread_mutex_unlock(&_files_mutex);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static void
+_storage_init(vs_storage_op_ctx_t *storage) {
+    memset(storage, 0, sizeof(*storage));
+
+    storage->impl_func.deinit = _storage_deinit;
+    storage->impl_func.open = _storage_open;
+    storage->impl_func.sync = _storage_sync;
+    storage->impl_func.close = _storage_close;
+    storage->impl_func.save = _storage_save;
+    storage->impl_func.load = _storage_load;
+    storage->impl_func.size = _storage_size;
+    storage->impl_func.del = _storage_del;
+    storage->file_sz_limit = BENCH_FILE_SZ_LIMIT;
+}
+
+/*************************************************************************/
+static bool
+_create_hl_key(vs_secmodule_impl_t *secmodule,
+               vs_key_type_e key_type,
+               vs_iot_secmodule_slot_e keypair_slot,
+               vs_iot_secmodule_slot_e pubkey_slot) {
+    uint8_t buf[BENCH_KEY_BUF_SIZE];
+    uint8_t hash[VS_HASH_SHA256_LEN];
+    int key_len = vs_secmodule_get_pubkey_len(VS_KEYPAIR_EC_SECP256R1);
+    int sign_len = vs_secmodule_get_signature_len(VS_KEYPAIR_EC_SECP256R1);
+    uint16_t slot_sz = sizeof(vs_pubkey_dated_t) + key_len;
+    vs_pubkey_dated_t *key = (vs_pubkey_dated_t *)buf;
+    vs_secmodule_keypair_type_e keypair_type;
+    vs_sign_t *sign;
+    uint16_t sz;
+
+    memset(buf, 0, sizeof(buf));
+    key->start_date = 0;
+    key->expire_date = UINT32_MAX;
+    key->pubkey.ec_type = VS_KEYPAIR_EC_SECP256R1;
+    key->pubkey.key_type = key_type;
+    key->pubkey.meta_data_sz = 0;
+
+    if (VS_CODE_OK != secmodule->create_keypair(keypair_slot, VS_KEYPAIR_EC_SECP256R1) ||
+        VS_CODE_OK != secmodule->get_pubkey(keypair_slot, key->pubkey.meta_and_pubkey, key_len, &sz, &keypair_type)) {
+        return false;
+    }
+
+    // Recovery key is trusted as is, other ones are signed by it
+    if (VS_KEY_RECOVERY != key_type) {
+        sign = (vs_sign_t *)&key->pubkey.meta_and_pubkey[key_len];
+        sign->signer_type = VS_KEY_RECOVERY;
+        sign->hash_type = VS_HASH_SHA_256;
+        sign->ec_type = VS_KEYPAIR_EC_SECP256R1;
+        slot_sz += sizeof(vs_sign_t) + sign_len + key_len;
+
+        if (VS_CODE_OK != secmodule->hash(VS_HASH_SHA_256,
+                                          buf,
+                                          sizeof(vs_pubkey_dated_t) + key_len,
+                                          hash,
+                                          sizeof(hash),
+                                          &sz) ||
+            VS_CODE_OK != secmodule->ecdsa_sign(
+                                  BENCH_REC_KEYPAIR, VS_HASH_SHA_256, hash, sign->raw_sign_pubkey, sign_len, &sz) ||
+            VS_CODE_OK != secmodule->get_pubkey(
+                                  BENCH_REC_KEYPAIR, &sign->raw_sign_pubkey[sign_len], key_len, &sz, &keypair_type)) {
+            return false;
+        }
+    }
+
+    return VS_CODE_OK == secmodule->slot_save(pubkey_slot, buf, slot_sz);
+}
+
+/*************************************************************************/
+static uint8_t *
+_create_signatures(vs_secmodule_impl_t *secmodule, const uint8_t *hash, uint8_t signatures_count, size_t *size) {
+    int key_len = vs_secmodule_get_pubkey_len(VS_KEYPAIR_EC_SECP256R1);
+    int sign_len = vs_secmodule_get_signature_len(VS_KEYPAIR_EC_SECP256R1);
+    size_t sign_sz = sizeof(vs_sign_t) + sign_len + key_len;
+    vs_secmodule_keypair_type_e keypair_type;
+    vs_iot_secmodule_slot_e slot;
+    uint8_t *signatures;
+    vs_sign_t *sign;
+    uint16_t sz;
+    uint8_t i;
+
+    signatures = calloc(signatures_count, sign_sz);
+    if (!signatures) {
+        return NULL;
+    }
+
+    for (i = 0; i < signatures_count; ++i) {
+        sign = (vs_sign_t *)&signatures[i * sign_sz];
+        slot = (i % 2) ? BENCH_FW_KEYPAIR : BENCH_AUTH_KEYPAIR;
+        sign->signer_type = (i % 2) ? VS_KEY_FIRMWARE : VS_KEY_AUTH;
+        sign->hash_type = VS_HASH_SHA_256;
+        sign->ec_type = VS_KEYPAIR_EC_SECP256R1;
+
+        if (VS_CODE_OK != secmodule->ecdsa_sign(slot, VS_HASH_SHA_256, hash, sign->raw_sign_pubkey, sign_len, &sz) ||
+            VS_CODE_OK != secmodule->get_pubkey(slot, &sign->raw_sign_pubkey[sign_len], key_len, &sz, &keypair_type)) {
+            free(signatures);
+            return NULL;
+        }
+    }
+
+    *size = signatures_count * sign_sz;
+    return signatures;
+}
+
+/*************************************************************************/
+static bool
+_bench_threads(const uint8_t *hash, const uint8_t *signatures, uint8_t signatures_count, size_t signatures_sz) {
+    const vs_key_type_e rules[] = {VS_KEY_AUTH, VS_KEY_FIRMWARE};
+    double single_rate = 0;
+    double start;
+    double duration;
+    double rate;
+    int iterations;
+    uint8_t threads;
+
+    printf("%u signatures\n", (unsigned)signatures_count);
+    printf("  threads  verifications/s  speedup\n");
+
+    for (threads = 0; threads <= VS_PROVISION_VERIFY_THREADS_QTY; ++threads) {
+        if (VS_CODE_OK != vs_provision_set_verify_threads(threads)) {
+            fprintf(stderr, "Unable to set %u verification threads\n", (unsigned)threads);
+            return false;
+        }
+
+        iterations = 0;
+        start = _now();
+        do {
+            if (VS_CODE_OK != vs_provision_verify_hash_signatures(
+                                      hash, signatures, signatures_count, signatures_sz, rules, 2)) {
+                fprintf(stderr, "Signatures verification has been failed\n");
+                return false;
+            }
+            ++iterations;
+        } while ((duration = _now() - start) < BENCH_MIN_DURATION);
+
+        rate = iterations / duration;
+        if (!threads) {
+            single_rate = rate;
+        }
+
+        printf("  %7u  %15.1f  %6.2fx\n", (unsigned)threads, rate, rate / single_rate);
+    }
+
+    return true;
+}
+
+/*************************************************************************/
+int
+main(int argc, char *argv[]) {
+    vs_storage_op_ctx_t storage;
+    vs_secmodule_impl_t *secmodule;
+    vs_provision_events_t events = {NULL};
+    uint8_t hash[VS_HASH_SHA256_LEN];
+    uint8_t *signatures = NULL;
+    size_t signatures_sz = 0;
+    int signatures_count = BENCH_SIGNATURES_DEFAULT;
+    int res = 1;
+
+    if (argc > 2 || (argc == 2 && ((signatures_count = atoi(argv[1])) < 2 || signatures_count > UINT8_MAX))) {
+        fprintf(stderr, "Usage : %s [<signatures count, 2..255>]\n", argv[0]);
+        return 1;
+    }
+
+    vs_logger_init(VS_LOGLEV_ERROR);
+
+    _storage_init(&storage);
+    secmodule = vs_soft_secmodule_impl(&storage);
+
+    if (!secmodule || VS_CODE_OK != vs_provision_init(&storage, secmodule, events)) {
+        fprintf(stderr, "Unable to initialize provision\n");
+        goto terminate;
+    }
+
+    if (!_create_hl_key(secmodule, VS_KEY_RECOVERY, BENCH_REC_KEYPAIR, REC1_KEY_SLOT) ||
+        !_create_hl_key(secmodule, VS_KEY_AUTH, BENCH_AUTH_KEYPAIR, AUTH1_KEY_SLOT) ||
+        !_create_hl_key(secmodule, VS_KEY_FIRMWARE, BENCH_FW_KEYPAIR, FW1_KEY_SLOT)) {
+        fprintf(stderr, "Unable to create test keys\n");
+        goto terminate;
+    }
+
+    memset(hash, 0xA5, sizeof(hash));
+    signatures = _create_signatures(secmodule, hash, signatures_count, &signatures_sz);
+    if (!signatures) {
+        fprintf(stderr, "Unable to sign test hash\n");
+        goto terminate;
+    }
+
+    if (_bench_threads(hash, signatures, signatures_count, signatures_sz)) {
+        res = 0;
+    }
+
+terminate:
+    free(signatures);
+    vs_provision_deinit();
+    vs_soft_secmodule_deinit();
+
+    return res;
+}
@@ -0,0 +1,716 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+/*
+ * Storage HAL implementations speed and behaviour for typical SDK workloads.
+ *
+ * Usage : vs-bench-storage <directory> [<latency, us> [<sync latency, us> [<failures, per mille>]]]
+ *
+ * Default POSIX storage is compared with stdio based storage that opens, seeks and flushes file for each call, as
+ * storage implementations of tests and samples do. POSIX storage wrapped by open handles cache and log-structured
+ * storage are measured too if library has been built with them. Each workload is performed by the SDK calls sequence :
+ *
+ * - firmware chunks : firmware image download by open, save of one chunk and close per chunk and sync after the last
+ * one. Log-structured storage is intended for small elements, so this workload is skipped for it.
+ * - tl read : random Trust List keys reading by open, load of one key and close.
+ * - slot rewrite : random element of the secure slots set is rewritten as secure module does : delete, open, save,
+ * sync and close.
+ * - descriptor update : one firmware descriptor is saved in place within descriptors element by open, save, sync and
+ * close.
+ *
+ * Throughput, operation latency percentiles, sync calls and bytes sent to block device are reported for each workload.
+ * Device bytes are taken from /proc/self/io and are zero for tmpfs.
+ *
+ * Storage is wrapped by fault injection. Latency arguments delay each load and save and each sync to emulate slow
+ * flash, failures argument fails random calls with torn saves. The same wrapper can be placed under firmware, Trust
+ * List or secbox modules storage to see how they behave on such flash. Failed operations are counted and the workload
+ * goes on.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/storage_hal/storage_fault_injection.h>
+#include <virgil/iot/vs-posix-storage/posix-storage.h>
+#if BENCH_HANDLE_CACHE
+#include <virgil/iot/storage_hal/storage_handle_cache.h>
+#endif
+#if BENCH_LOG_STORAGE
+#include <virgil/iot/vs-log-storage/log-storage.h>
+#endif
+
+#define BENCH_FILE_SZ_LIMIT (4 * 1024 * 1024)
+#define BENCH_FIRMWARE_SIZE (2 * 1024 * 1024)
+#define BENCH_FIRMWARE_CHUNK_SIZE (4096)
+#define BENCH_TL_SIZE (16 * 1024)
+#define BENCH_TL_KEY_SIZE (64)
+#define BENCH_TL_ITERATIONS (20000)
+#define BENCH_SLOTS (16)
+#define BENCH_SLOT_SIZE (256)
+#define BENCH_SLOT_ITERATIONS (2000)
+#define BENCH_DESCRIPTORS (8)
+#define BENCH_DESCRIPTOR_SIZE (48)
+#define BENCH_DESCRIPTOR_ITERATIONS (2000)
+#define BENCH_HANDLE_CACHE_SIZE (4)
+
+// Iterations are reduced when latency is injected, except firmware chunks that are limited by image size
+#define BENCH_SLOW_DIVIDER (20)
+
+typedef struct {
+    const char *name;
+    size_t iterations;
+    size_t op_sz;
+    bool large;
+    bool (*setup)(const vs_storage_op_ctx_t *storage);
+    bool (*op)(const vs_storage_op_ctx_t *storage, size_t i);
+    bool (*finish)(const vs_storage_op_ctx_t *storage);
+    bool (*cleanup)(const vs_storage_op_ctx_t *storage);
+} bench_workload_t;
+
+typedef struct {
+    const char *dir;
+} bench_stdio_storage_t;
+
+typedef struct {
+    char path[512];
+} bench_stdio_file_t;
+
+/*************************************************************************/
+bool
+vs_logger_output_hal(const char *buffer) {
+    return buffer && fputs(buffer, stderr) >= 0;
+}
+
+/*************************************************************************/
+static double
+_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*************************************************************************/
+static void
+_stdio_path(const bench_stdio_storage_t *storage, const vs_storage_element_id_t id, char *path, size_t path_sz) {
+    snprintf(path, path_sz, "%s/%s", storage->dir, (const char *)id);
+}
+
+/*************************************************************************/
+static vs_status_e
+_stdio_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    free(storage_ctx);
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_storage_file_t
+_stdio_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    bench_stdio_file_t *file = calloc(1, sizeof(bench_stdio_file_t));
+
+    if (file) {
+        _stdio_path((const bench_stdio_storage_t *)storage_ctx, id, file->path, sizeof(file->path));
+    }
+
+    return file;
+}
+
+/*************************************************************************/
+static vs_status_e
+_stdio_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    FILE *f = fopen(((const bench_stdio_file_t *)file)->path, "r+b");
+    vs_status_e ret_code;
+
+    if (!f) {
+        return VS_CODE_ERR_FILE;
+    }
+
+    ret_code = 0 == fflush(f) && 0 == fsync(fileno(f)) ? VS_CODE_OK : VS_CODE_ERR_FILE_WRITE;
+    fclose(f);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_stdio_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    free(file);
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_stdio_save(const vs_storage_impl_data_ctx_t storage_ctx,
+            const vs_storage_file_t file,
+            size_t offset,
+            const uint8_t *data,
+            size_t data_sz) {
+    const char *path = ((const bench_stdio_file_t *)file)->path;
+    FILE *f = fopen(path, "r+b");
+    vs_status_e ret_code;
+
+    if (!f) {
+        f = fopen(path, "w+b");
+    }
+    if (!f) {
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    ret_code = VS_CODE_ERR_FILE_WRITE;
+    if (0 == fseek(f, offset, SEEK_SET) && 1 == fwrite(data, data_sz, 1, f)) {
+        ret_code = VS_CODE_OK;
+    }
+    fclose(f);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_stdio_load(const vs_storage_impl_data_ctx_t storage_ctx,
+            const vs_storage_file_t file,
+            size_t offset,
+            uint8_t *out_data,
+            size_t data_sz) {
+    FILE *f = fopen(((const bench_stdio_file_t *)file)->path, "rb");
+    vs_status_e ret_code;
+
+    if (!f) {
+        return VS_CODE_ERR_FILE_READ;
+    }
+
+    ret_code = VS_CODE_ERR_FILE_READ;
+    if (0 == fseek(f, offset, SEEK_SET) && 1 == fread(out_data, data_sz, 1, f)) {
+        ret_code = VS_CODE_OK;
+    }
+    fclose(f);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static ssize_t
+_stdio_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    char path[512];
+    struct stat st;
+
+    _stdio_path((const bench_stdio_storage_t *)storage_ctx, id, path, sizeof(path));
+
+    return 0 == stat(path, &st) ? st.st_size : VS_CODE_ERR_NOT_FOUND;
+}
+
+/*************************************************************************/
+static vs_status_e
+_stdio_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    char path[512];
+
+    _stdio_path((const bench_stdio_storage_t *)storage_ctx, id, path, sizeof(path));
+
+    return 0 == remove(path) || ENOENT == errno ? VS_CODE_OK : VS_CODE_ERR_FILE_DELETE;
+}
+
+/*************************************************************************/
+static vs_status_e
+_stdio_init(vs_storage_op_ctx_t *storage_ctx, const char *dir) {
+    bench_stdio_storage_t *storage;
+
+    if (0 != mkdir(dir, S_IRWXU) && EEXIST != errno) {
+        return VS_CODE_ERR_FILE;
+    }
+
+    storage = calloc(1, sizeof(bench_stdio_storage_t));
+    if (!storage) {
+        return VS_CODE_ERR_NO_MEMORY;
+    }
+    storage->dir = dir;
+
+    memset(storage_ctx, 0, sizeof(*storage_ctx));
+    storage_ctx->impl_func.deinit = _stdio_deinit;
+    storage_ctx->impl_func.open = _stdio_open;
+    storage_ctx->impl_func.sync = _stdio_sync;
+    storage_ctx->impl_func.close = _stdio_close;
+    storage_ctx->impl_func.save = _stdio_save;
+    storage_ctx->impl_func.load = _stdio_load;
+    storage_ctx->impl_func.size = _stdio_size;
+    storage_ctx->impl_func.del = _stdio_del;
+    storage_ctx->impl_data = storage;
+    storage_ctx->file_sz_limit = BENCH_FILE_SZ_LIMIT;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static void
+_element_id(const char *name, vs_storage_element_id_t id) {
+    memset(id, 0, sizeof(vs_storage_element_id_t));
+    strncpy((char *)id, name, sizeof(vs_storage_element_id_t) - 1);
+}
+
+/*************************************************************************/
+static bool
+_write_element(const vs_storage_op_ctx_t *storage,
+               const vs_storage_element_id_t id,
+               size_t offset,
+               const uint8_t *data,
+               size_t data_sz,
+               bool need_sync) {
+    vs_storage_file_t f = storage->impl_func.open(storage->impl_data, id);
+    bool res;
+
+    if (!f) {
+        return false;
+    }
+
+    res = VS_CODE_OK == storage->impl_func.save(storage->impl_data, f, offset, data, data_sz) &&
+          (!need_sync || VS_CODE_OK == storage->impl_func.sync(storage->impl_data, f));
+
+    return VS_CODE_OK == storage->impl_func.close(storage->impl_data, f) && res;
+}
+
+/*************************************************************************/
+static bool
+_del_element(const vs_storage_op_ctx_t *storage, const char *name) {
+    vs_storage_element_id_t id;
+
+    _element_id(name, id);
+
+    return VS_CODE_OK == storage->impl_func.del(storage->impl_data, id);
+}
+
+/*************************************************************************/
+static bool
+_firmware_setup(const vs_storage_op_ctx_t *storage) {
+    vs_storage_element_id_t id;
+
+    _element_id("firmware", id);
+
+    return !storage->impl_func.reserve ||
+           VS_CODE_OK == storage->impl_func.reserve(storage->impl_data, id, BENCH_FIRMWARE_SIZE);
+}
+
+/*************************************************************************/
+static bool
+_firmware_op(const vs_storage_op_ctx_t *storage, size_t i) {
+    vs_storage_element_id_t id;
+    uint8_t chunk[BENCH_FIRMWARE_CHUNK_SIZE];
+
+    _element_id("firmware", id);
+    memset(chunk, (int)i, sizeof(chunk));
+
+    return _write_element(storage, id, i * sizeof(chunk), chunk, sizeof(chunk), false);
+}
+
+/*************************************************************************/
+static bool
+_firmware_finish(const vs_storage_op_ctx_t *storage) {
+    vs_storage_element_id_t id;
+    vs_storage_file_t f;
+    bool res;
+
+    _element_id("firmware", id);
+
+    f = storage->impl_func.open(storage->impl_data, id);
+    res = f && VS_CODE_OK == storage->impl_func.sync(storage->impl_data, f);
+    if (f) {
+        storage->impl_func.close(storage->impl_data, f);
+    }
+
+    return res;
+}
+
+/*************************************************************************/
+static bool
+_firmware_cleanup(const vs_storage_op_ctx_t *storage) {
+    return _del_element(storage, "firmware");
+}
+
+/*************************************************************************/
+static bool
+_tl_setup(const vs_storage_op_ctx_t *storage) {
+    static uint8_t tl[BENCH_TL_SIZE];
+    vs_storage_element_id_t id;
+    size_t i;
+
+    _element_id("tl", id);
+    for (i = 0; i < BENCH_TL_SIZE; ++i) {
+        tl[i] = (uint8_t)i;
+    }
+
+    return _write_element(storage, id, 0, tl, sizeof(tl), true);
+}
+
+/*************************************************************************/
+static bool
+_tl_op(const vs_storage_op_ctx_t *storage, size_t i) {
+    vs_storage_element_id_t id;
+    uint8_t key[BENCH_TL_KEY_SIZE];
+    size_t offset = (size_t)rand() % (BENCH_TL_SIZE / BENCH_TL_KEY_SIZE) * BENCH_TL_KEY_SIZE;
+    vs_storage_file_t f;
+    bool res;
+
+    _element_id("tl", id);
+
+    f = storage->impl_func.open(storage->impl_data, id);
+    if (!f) {
+        return false;
+    }
+
+    res = VS_CODE_OK == storage->impl_func.load(storage->impl_data, f, offset, key, sizeof(key)) &&
+          key[0] == (uint8_t)offset;
+
+    return VS_CODE_OK == storage->impl_func.close(storage->impl_data, f) && res;
+}
+
+/*************************************************************************/
+static bool
+_tl_cleanup(const vs_storage_op_ctx_t *storage) {
+    return _del_element(storage, "tl");
+}
+
+/*************************************************************************/
+static void
+_slot_id(size_t slot, vs_storage_element_id_t id) {
+    char name[16];
+
+    snprintf(name, sizeof(name), "slot%d", (int)slot);
+    _element_id(name, id);
+}
+
+/*************************************************************************/
+static bool
+_slot_op(const vs_storage_op_ctx_t *storage, size_t i) {
+    vs_storage_element_id_t id;
+    uint8_t slot[BENCH_SLOT_SIZE];
+
+    _slot_id((size_t)rand() % BENCH_SLOTS, id);
+    memset(slot, (int)i, sizeof(slot));
+
+    return VS_CODE_OK == storage->impl_func.del(storage->impl_data, id) &&
+           _write_element(storage, id, 0, slot, sizeof(slot), true);
+}
+
+/*************************************************************************/
+static bool
+_slot_cleanup(const vs_storage_op_ctx_t *storage) {
+    vs_storage_element_id_t id;
+    bool res = true;
+    size_t i;
+
+    for (i = 0; i < BENCH_SLOTS; ++i) {
+        _slot_id(i, id);
+        res = VS_CODE_OK == storage->impl_func.del(storage->impl_data, id) && res;
+    }
+
+    return res;
+}
+
+/*************************************************************************/
+static bool
+_slot_setup(const vs_storage_op_ctx_t *storage) {
+    return _slot_cleanup(storage);
+}
+
+/*************************************************************************/
+static bool
+_descriptor_setup(const vs_storage_op_ctx_t *storage) {
+    uint8_t descriptors[BENCH_DESCRIPTORS * BENCH_DESCRIPTOR_SIZE];
+    vs_storage_element_id_t id;
+
+    _element_id("descriptors", id);
+    memset(descriptors, 0xFF, sizeof(descriptors));
+
+    return _write_element(storage, id, 0, descriptors, sizeof(descriptors), true);
+}
+
+/*************************************************************************/
+static bool
+_descriptor_op(const vs_storage_op_ctx_t *storage, size_t i) {
+    uint8_t descriptor[BENCH_DESCRIPTOR_SIZE];
+    vs_storage_element_id_t id;
+
+    _element_id("descriptors", id);
+    memset(descriptor, (int)i, sizeof(descriptor));
+
+    return _write_element(
+            storage, id, i % BENCH_DESCRIPTORS * BENCH_DESCRIPTOR_SIZE, descriptor, sizeof(descriptor), true);
+}
+
+/*************************************************************************/
+static bool
+_descriptor_cleanup(const vs_storage_op_ctx_t *storage) {
+    return _del_element(storage, "descriptors");
+}
+
+/*************************************************************************/
+static const bench_workload_t _workloads[] = {
+        {"firmware chunks",
+         BENCH_FIRMWARE_SIZE / BENCH_FIRMWARE_CHUNK_SIZE,
+         BENCH_FIRMWARE_CHUNK_SIZE,
+         true,
+         _firmware_setup,
+         _firmware_op,
+         _firmware_finish,
+         _firmware_cleanup},
+        {"tl read", BENCH_TL_ITERATIONS, BENCH_TL_KEY_SIZE, false, _tl_setup, _tl_op, NULL, _tl_cleanup},
+        {"slot rewrite", BENCH_SLOT_ITERATIONS, BENCH_SLOT_SIZE, false, _slot_setup, _slot_op, NULL, _slot_cleanup},
+        {"descriptor update",
+         BENCH_DESCRIPTOR_ITERATIONS,
+         BENCH_DESCRIPTOR_SIZE,
+         false,
+         _descriptor_setup,
+         _descriptor_op,
+         NULL,
+         _descriptor_cleanup},
+};
+
+/*************************************************************************/
+// Bytes sent to block device by the current process
+static unsigned long long
+_device_written(void) {
+    FILE *f = fopen("/proc/self/io", "r");
+    unsigned long long device_bytes = 0;
+    char line[128];
+
+    while (f && fgets(line, sizeof(line), f)) {
+        if (1 == sscanf(line, "write_bytes: %llu", &device_bytes)) {
+            break;
+        }
+    }
+
+    if (f) {
+        fclose(f);
+    }
+
+    return device_bytes;
+}
+
+/*************************************************************************/
+static int
+_compare_latency(const void *a, const void *b) {
+    double l = *(const double *)a;
+    double r = *(const double *)b;
+
+    return (l > r) - (l < r);
+}
+
+/*************************************************************************/
+static double
+_percentile(const double *sorted, size_t count, double part) {
+    return sorted[(size_t)(part * (count - 1))];
+}
+
+/*************************************************************************/
+static bool
+_run_workload(const bench_workload_t *workload,
+              const vs_storage_op_ctx_t *storage,
+              const vs_storage_op_ctx_t *fault,
+              const vs_storage_fault_config_t *config) {
+    bool slow = config->load_latency_us || config->save_latency_us || config->sync_latency_us;
+    size_t iterations = workload->iterations / (slow && !workload->large ? BENCH_SLOW_DIVIDER : 1);
+    vs_storage_fault_stats_t stats_start, stats_end;
+    unsigned long long device_start, device_end;
+    double *latencies;
+    double start, op_start, duration;
+    size_t failed = 0;
+    size_t i;
+    bool res;
+
+    latencies = calloc(iterations, sizeof(double));
+    if (!latencies || !workload->setup(storage)) {
+        fprintf(stderr, "%s workload cannot be prepared\n", workload->name);
+        free(latencies);
+        return false;
+    }
+
+    vs_storage_fault_injection_configure(fault, config);
+    vs_storage_fault_injection_get_stats(fault, &stats_start);
+    device_start = _device_written();
+    start = _now();
+
+    for (i = 0; i < iterations; ++i) {
+        op_start = _now();
+        if (!workload->op(storage, i)) {
+            ++failed;
+        }
+        latencies[i] = (_now() - op_start) * 1e6;
+    }
+
+    if (workload->finish && !workload->finish(storage)) {
+        ++failed;
+    }
+
+    duration = _now() - start;
+    device_end = _device_written();
+    vs_storage_fault_injection_get_stats(fault, &stats_end);
+    vs_storage_fault_injection_configure(fault, NULL);
+
+    qsort(latencies, iterations, sizeof(double), _compare_latency);
+
+    printf("  %-18s  %9.0f  %7.2f  %8.1f  %8.1f  %8.1f  %6u  %6u  %12.0f\n",
+           workload->name,
+           iterations / duration,
+           (double)(iterations - failed) * workload->op_sz / duration / 1e6,
+           _percentile(latencies, iterations, 0.5),
+           _percentile(latencies, iterations, 0.99),
+           latencies[iterations - 1],
+           stats_end.syncs - stats_start.syncs,
+           (unsigned)failed,
+           (double)(device_end - device_start) / iterations);
+
+    free(latencies);
+
+    res = workload->cleanup(storage);
+    if (!res) {
+        fprintf(stderr, "%s workload cannot be cleaned up\n", workload->name);
+    }
+
+    // Failures are expected only if they are injected
+    return res && (!failed || config->failures_per_mille);
+}
+
+/*************************************************************************/
+static bool
+_bench_storage(const char *title,
+               vs_storage_op_ctx_t *backend,
+               size_t handle_cache_size,
+               bool large,
+               const vs_storage_fault_config_t *config) {
+    vs_storage_op_ctx_t fault;
+    vs_storage_op_ctx_t storage;
+    bool res = true;
+    size_t i;
+
+    // Faults are injected under handle cache as it is done by flash
+    if (VS_CODE_OK != vs_storage_fault_injection_init(&fault, backend, NULL)) {
+        backend->impl_func.deinit(backend->impl_data);
+        return false;
+    }
+    storage = fault;
+
+#if BENCH_HANDLE_CACHE
+    if (handle_cache_size && VS_CODE_OK != vs_storage_handle_cache_init(&storage, &fault, handle_cache_size)) {
+        fault.impl_func.deinit(fault.impl_data);
+        return false;
+    }
+#endif
+
+    printf("\n  %s\n", title);
+
+    for (i = 0; i < sizeof(_workloads) / sizeof(_workloads[0]); ++i) {
+        if (_workloads[i].large && !large) {
+            printf("  %-18s  %9s\n", _workloads[i].name, "-");
+        } else if (!_run_workload(&_workloads[i], &storage, &fault, config)) {
+            fprintf(stderr, "%s storage failed\n", title);
+            res = false;
+        }
+    }
+
+    storage.impl_func.deinit(storage.impl_data);
+
+    return res;
+}
+
+/*************************************************************************/
+int
+main(int argc, char *argv[]) {
+    vs_storage_fault_config_t config;
+    vs_storage_op_ctx_t backend;
+    char stdio_dir[256];
+    char posix_dir[256];
+#if BENCH_LOG_STORAGE
+    char log_path[256];
+#endif
+    int res = 0;
+
+    if (argc < 2 || argc > 5) {
+        fprintf(stderr,
+                "Usage : %s <directory> [<latency, us> [<sync latency, us> [<failures, per mille>]]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.load_latency_us = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 0;
+    config.save_latency_us = config.load_latency_us;
+    config.sync_latency_us = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 0;
+    config.failures_per_mille = argc > 4 ? (uint16_t)strtoul(argv[4], NULL, 10) : 0;
+    config.failure_ops = VS_STORAGE_FAULT_OPEN | VS_STORAGE_FAULT_LOAD | VS_STORAGE_FAULT_SAVE |
+                         VS_STORAGE_FAULT_SYNC | VS_STORAGE_FAULT_DEL;
+    config.torn_saves = true;
+    config.seed = 1;
+
+    vs_logger_init(VS_LOGLEV_ERROR);
+
+    snprintf(stdio_dir, sizeof(stdio_dir), "%s/stdio", argv[1]);
+    snprintf(posix_dir, sizeof(posix_dir), "%s/posix", argv[1]);
+#if BENCH_LOG_STORAGE
+    snprintf(log_path, sizeof(log_path), "%s/storage.log", argv[1]);
+#endif
+
+    printf("  latency : %u us, sync latency : %u us, failures : %u per mille\n",
+           (unsigned)config.load_latency_us,
+           (unsigned)config.sync_latency_us,
+           (unsigned)config.failures_per_mille);
+    printf("\n  workload                 op/s     MB/s   p50, us   p99, us   max, us   syncs  failed  device, B/op\n");
+
+    if (VS_CODE_OK != _stdio_init(&backend, stdio_dir) || !_bench_storage("stdio", &backend, 0, true, &config)) {
+        res = 1;
+    }
+
+    if (VS_CODE_OK != vs_posix_storage_init(&backend, posix_dir, BENCH_FILE_SZ_LIMIT) ||
+        !_bench_storage("posix", &backend, 0, true, &config)) {
+        res = 1;
+    }
+
+#if BENCH_HANDLE_CACHE
+    if (VS_CODE_OK != vs_posix_storage_init(&backend, posix_dir, BENCH_FILE_SZ_LIMIT) ||
+        !_bench_storage("posix + handle cache", &backend, BENCH_HANDLE_CACHE_SIZE, true, &config)) {
+        res = 1;
+    }
+#endif
+
+#if BENCH_LOG_STORAGE
+    if (VS_CODE_OK != vs_log_storage_init(&backend, log_path, BENCH_FILE_SZ_LIMIT) ||
+        !_bench_storage("log", &backend, 0, false, &config)) {
+        res = 1;
+    }
+#endif
+
+    return res;
+}
@@ -59,4 +59,31 @@ vs_impl_device_serial(uint8_t *udid);
 void
 vs_impl_msleep(size_t msec);
 
+/** Millisecond clock availability
+ *
+ * Set it to 0 if platform doesn't implement #vs_impl_msec. Standard time() with second resolution is used instead in
+ * this case, so timers can expire up to one second earlier or later.
+ */
+#define VS_IMPL_MSEC 1
+
+#if VS_IMPL_MSEC
+
+/** Get monotonic time
+ *
+ * It's used by SNAP services timers, e.g. FLDT client retransmissions. Value can wrap around.
+ *
+ * \return Time in milliseconds since some unspecified starting point.
+ */
+uint32_t
+vs_impl_msec(void);
+
+#else
+
+#include <time.h>
+
+/** Second resolution replacement of #vs_impl_msec */
+#define vs_impl_msec() ((uint32_t)time(NULL) * 1000U)
+
+#endif // VS_IMPL_MSEC
+
 #endif // VS_IOT_SDK_GLOBAL_HAL_H
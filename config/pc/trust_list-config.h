@@ -46,7 +46,10 @@
  *
  * Please note that library uses three type of storage,
  * so you need have at least \a VS_TL_STORAGE_SIZE * 3 memory size
- * (excluding filesystem)
+ * (excluding filesystem). Each of them is stored in one storage element,
+ * so storage file size limit must be enough for the whole TrustList and its offsets table.
+ * TrustList stored element by element by previous versions is repacked on start. If it doesn't fit
+ * one storage element, it's used in previous layout until new TrustList replaces it.
  */
 #define VS_TL_STORAGE_SIZE (10 * 4096)
 
@@ -57,6 +60,29 @@
 
 #define VS_TL_STORAGE_MAX_PART_SIZE (512)
 
+/** Keep Trust List keys in RAM for keys search.
+ *
+ * Keys of current Trust List are loaded once after its verification, so #vs_tl_find_key doesn't read storage.
+ * It needs up to \a VS_TL_STORAGE_SIZE memory size. Set to 0 to search keys in storage.
+ */
+#define VS_TL_KEY_INDEX (1)
+
+/** Cache Trust List verification result
+ *
+ * Successful signatures verification is saved to storage and sealed by MAC derived from the device private key. Next
+ * start checks unchanged Trust List by its hash without signatures verification. Signer keys are still checked against
+ * high-level keys each time. Set to 1 to enable. It's disabled by default, because starts that use cache write to
+ * storage, see #VS_TL_VERIFY_CACHE_PERIOD.
+ */
+#define VS_TL_VERIFY_CACHE (0)
+
+/** Full Trust List verification period
+ *
+ * Signatures are verified again after this quantity of starts that used verification cache. Cache uses counter is
+ * saved to storage on each such start. Set to 0 to use cache until Trust List change without storage writes.
+ */
+#define VS_TL_VERIFY_CACHE_PERIOD (16)
+
 /* Trust List signature rules */
 
 /** Minimum quantity of required signatures, which must be in TL footer */
@@ -74,4 +100,13 @@
     VS_KEY_TRUSTLIST                                                                                                \
 }
 
+/* Signatures verification */
+
+/** Quantity of threads that verify signatures together with the calling one
+ *
+ * It's used only if library has been built with VIRGIL_IOT_PARALLEL_VERIFY option. Can be changed in runtime by
+ * #vs_provision_set_verify_threads call up to this value.
+ */
+#define VS_PROVISION_VERIFY_THREADS_QTY (3)
+
 #endif // VS_IOT_SDK_TL_CONFIG_H
@@ -45,6 +45,20 @@
 /** Maximum size for Firmware file */
 #define VS_MAX_FIRMWARE_UPDATE_SIZE (2 * 1024 * 1024)
 
+/** Firmware chunks write buffer size
+ *
+ * Consecutive firmware chunks are collected and written by blocks aligned to this size. Set 0 to write each chunk
+ * immediately.
+ */
+#define VS_FIRMWARE_WRITE_BUFFER_SIZE (4096)
+
+/** Maximum age of not written firmware chunks in milliseconds
+ *
+ * Buffered chunks older than this age are written when the next chunk is saved or by FLDT client periodical
+ * processing, see #vs_firmware_flush_expired_chunks.
+ */
+#define VS_FIRMWARE_WRITE_BUFFER_FLUSH_MS (1000)
+
 /*Firmware signature rules*/
 
 /** Minimum quantity of required signatures, which must be in firmware footer */
@@ -60,4 +74,91 @@
     VS_KEY_FIRMWARE                                                                                                \
 };
 
+/* Gateway firmware cache */
+
+/** Maximum amount of images tracked by firmware cache including previous versions
+ *
+ * It's used only if library has been built with FIRMWARE_CACHE option.
+ */
+#define VS_FIRMWARE_CACHE_IMAGES_MAX (16)
+
+/** Keep previous firmware version when newer one is stored
+ *
+ * Previous versions are evicted the same way as other images unless they are pinned. Set 0 to keep pinned ones only.
+ */
+#define VS_FIRMWARE_CACHE_KEEP_PREVIOUS (1)
+
+/* Firmware chunks deduplication */
+
+/** Size of firmware data blocks that are stored once
+ *
+ * It's used only if library has been built with FIRMWARE_DEDUP option. Smaller blocks find more duplicates but need
+ * more storage elements and memory for index.
+ */
+#define VS_FIRMWARE_DEDUP_BLOCK_SIZE (4096)
+
+/* Firmware compression */
+
+/** Maximum LZ window of compressed firmware as log2 of bytes amount
+ *
+ * Decoder allocates 2 ^ VS_FIRMWARE_LZ_WINDOW_BITS bytes. Compressed firmware with a bigger window is rejected.
+ * It's used only if library has been built with FIRMWARE_COMPRESSION option. MUST be in 8..12 range.
+ */
+#define VS_FIRMWARE_LZ_WINDOW_BITS (12)
+
+/* FLDT settings */
+
+/** Initial capacity of FLDT file type mapping index
+ *
+ * It's used by both FLDT client and server. Index is doubled each time it becomes 3/4 full.
+ * MUST be a power of two.
+ */
+#define VS_FLDT_FILE_TYPES_INITIAL_CAPACITY (8)
+
+/** FLDT client retransmission timeout in milliseconds before the first round-trip time measurement */
+#define VS_FLDT_RTO_INITIAL_MS (1000)
+
+/** Minimal FLDT client retransmission timeout in milliseconds
+ *
+ * Retransmission timeout is calculated from smoothed round-trip time and its variation. It is not less than this value
+ * to tolerate gateway's storage latency.
+ */
+#define VS_FLDT_RTO_MIN_MS (100)
+
+/** Maximal FLDT client retransmission timeout in milliseconds
+ *
+ * Timeout is doubled for each retry of the same request, but it's not bigger than this value.
+ */
+#define VS_FLDT_RTO_MAX_MS (10000)
+
+/** Maximum amount of transfers downloading files from FLDT server simultaneously
+ *
+ * Transfer is identified by client MAC address and file type. It starts with the first GNFD request for this file and
+ * finishes with GNFF one for the same file. Other clients get "retry later" hint.
+ */
+#define VS_FLDT_SERVER_TRANSFERS_MAX (4)
+
+/** Transfer without requests during this time in milliseconds is considered as aborted and its slot is released */
+#define VS_FLDT_SERVER_TRANSFER_IDLE_MS (15000)
+
+/** Delay in milliseconds sent to clients that have not been admitted because of #VS_FLDT_SERVER_TRANSFERS_MAX limit */
+#define VS_FLDT_SERVER_ADMISSION_RETRY_MS (5000)
+
+/** Delay in milliseconds sent to clients that request data of file which has not been received by gateway yet
+ *
+ * It's used for files distributed while they are being downloaded, see \ref firmware_relay.h.
+ */
+#define VS_FLDT_SERVER_RELAY_RETRY_MS (500)
+
+/** FLDT server scheduling round duration in milliseconds */
+#define VS_FLDT_SERVER_ROUND_MS (1000)
+
+/** Amount of GNFD responses per scheduling round
+ *
+ * It's shared equally between active transfers, so each client gets not less than its part. Clients that have exhausted
+ * their part get "retry later" hint up to the round end. It leaves network bandwidth for other services. Zero value
+ * disables this limit.
+ */
+#define VS_FLDT_SERVER_ROUND_CHUNKS (256)
+
 #endif //VS_IOT_SDK_UPDATE_CONFIG_H
@@ -36,13 +36,161 @@
 #include <virgil/iot/macros/macros.h>
 #include "private/vs-soft-secmodule-internal.h"
 
+#if SOFT_SECMODULE_SLOT_CACHE_LOCK
+#include <pthread.h>
+#endif
+
 static vs_storage_op_ctx_t *_storage = NULL;
 
+#if SOFT_SECMODULE_SLOT_CACHE
+// Slot content read from storage. Absent slots are cached too, because public key search checks all key slots.
+// Generation is changed by each slot modification and cache fill, so load started before them doesn't fill cache by
+// previous content.
+typedef struct {
+    bool valid;
+    bool present;
+    uint16_t data_sz;
+    uint8_t *data;
+    uint32_t generation;
+} vs_soft_secmodule_slot_cache_t;
+
+static vs_soft_secmodule_slot_cache_t _slot_cache[VS_KEY_SLOT_TMP_MAX];
+
+// Only public key slots searched by signatures verification are cached. Private key and other secret slots are not
+// kept in memory.
+#define _SLOT_CACHED(SLOT)                                                                                             \
+    (((SLOT) >= REC1_KEY_SLOT && (SLOT) <= REC2_KEY_SLOT) || ((SLOT) >= AUTH1_KEY_SLOT && (SLOT) <= FW2_KEY_SLOT))
+
+#if SOFT_SECMODULE_SLOT_CACHE_LOCK
+static pthread_mutex_t _slot_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define _LOCK() pthread_mutex_lock(&_slot_cache_lock)
+#define _UNLOCK() pthread_mutex_unlock(&_slot_cache_lock)
+#else
+#define _LOCK()
+#define _UNLOCK()
+#endif // SOFT_SECMODULE_SLOT_CACHE_LOCK
+
+/******************************************************************************/
+// _slot_cache_lock must be locked
+static void
+_slot_cache_clear(vs_soft_secmodule_slot_cache_t *cache) {
+    if (cache->data) {
+        VS_IOT_MEMSET(cache->data, 0, cache->data_sz);
+        VS_IOT_FREE(cache->data);
+    }
+
+    cache->data = NULL;
+    cache->data_sz = 0;
+    cache->present = false;
+    cache->valid = false;
+}
+
+/******************************************************************************/
+static void
+_slot_cache_invalidate(vs_iot_secmodule_slot_e slot) {
+    _LOCK();
+    _slot_cache_clear(&_slot_cache[slot]);
+    ++_slot_cache[slot].generation;
+    _UNLOCK();
+}
+
+/******************************************************************************/
+static uint32_t
+_slot_cache_generation(vs_iot_secmodule_slot_e slot) {
+    uint32_t generation;
+
+    _LOCK();
+    generation = _slot_cache[slot].generation;
+    _UNLOCK();
+
+    return generation;
+}
+
+/******************************************************************************/
+// Slot is cached as absent if data is NULL. Cache is not filled if there is no memory for slot content.
+// Load passes generation got before storage read and fills cache only if slot hasn't been changed since then. Save and
+// delete pass NULL, because their content is already stored.
+static void
+_slot_cache_fill(vs_iot_secmodule_slot_e slot, const uint32_t *generation, const uint8_t *data, uint16_t data_sz) {
+    vs_soft_secmodule_slot_cache_t *cache = &_slot_cache[slot];
+    uint8_t *copy = NULL;
+
+    if (data) {
+        copy = VS_IOT_MALLOC(data_sz ? data_sz : 1);
+        if (!copy) {
+            return;
+        }
+        VS_IOT_MEMCPY(copy, data, data_sz);
+    }
+
+    _LOCK();
+    if (!generation || *generation == cache->generation) {
+        _slot_cache_clear(cache);
+        cache->data = copy;
+        cache->data_sz = data ? data_sz : 0;
+        cache->present = NULL != data;
+        cache->valid = true;
+        ++cache->generation;
+        copy = NULL;
+    }
+    _UNLOCK();
+
+    if (copy) {
+        VS_IOT_MEMSET(copy, 0, data_sz);
+        VS_IOT_FREE(copy);
+    }
+}
+
+/******************************************************************************/
+// Returns false if slot content is not cached
+static bool
+_slot_cache_load(vs_iot_secmodule_slot_e slot,
+                 uint8_t *data,
+                 uint16_t buf_sz,
+                 uint16_t *out_sz,
+                 vs_status_e *ret_code) {
+    const vs_soft_secmodule_slot_cache_t *cache = &_slot_cache[slot];
+    bool res;
+
+    _LOCK();
+
+    res = cache->valid;
+    if (res && !cache->present) {
+        VS_LOG_ERROR("Slot size is wrong");
+        *ret_code = VS_CODE_ERR_FILE_WRITE;
+    } else if (res && cache->data_sz > buf_sz) {
+        VS_LOG_ERROR("Cannot read file because of small buffer");
+        *ret_code = VS_CODE_ERR_FILE_WRITE;
+    } else if (res) {
+        VS_IOT_MEMCPY(data, cache->data, cache->data_sz);
+        *out_sz = cache->data_sz;
+        *ret_code = VS_CODE_OK;
+    }
+
+    _UNLOCK();
+
+    return res;
+}
+
+/******************************************************************************/
+static void
+_slot_cache_reset(void) {
+    size_t i;
+
+    _LOCK();
+    for (i = 0; i < sizeof(_slot_cache) / sizeof(_slot_cache[0]); ++i) {
+        _slot_cache_clear(&_slot_cache[i]);
+        ++_slot_cache[i].generation;
+    }
+    _UNLOCK();
+}
+#endif // SOFT_SECMODULE_SLOT_CACHE
+
 /********************************************************************************/
 static vs_status_e
 vs_secmodule_slot_save(vs_iot_secmodule_slot_e slot, const uint8_t *data, uint16_t data_sz) {
     CHECK_NOT_ZERO_RET(_storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    vs_storage_file_t f;
+    vs_storage_file_t f = NULL;
     vs_storage_element_id_t id;
     const char *slot_name = _get_slot_name(slot);
     vs_status_e res = VS_CODE_ERR_FILE_WRITE;
@@ -54,6 +202,12 @@ vs_secmodule_slot_save(vs_iot_secmodule_slot_e slot, const uint8_t *data, uint16
               "Slot name too big");
     VS_IOT_STRCPY((char *)id, slot_name);
 
+#if SOFT_SECMODULE_SLOT_CACHE
+    if (_SLOT_CACHED(slot)) {
+        _slot_cache_invalidate(slot);
+    }
+#endif
+
     // Remove the old file
     STATUS_CHECK(res = _storage->impl_func.del(_storage->impl_data, id), "Can't delete file");
 
@@ -70,6 +224,12 @@ terminate:
         res_close = _storage->impl_func.close(_storage->impl_data, f);
     }
 
+#if SOFT_SECMODULE_SLOT_CACHE
+    if (_SLOT_CACHED(slot) && VS_CODE_OK == res && VS_CODE_OK == res_close) {
+        _slot_cache_fill(slot, NULL, data, data_sz);
+    }
+#endif
+
     return (VS_CODE_OK == res) ? res_close : res;
 }
 
@@ -77,12 +237,22 @@ terminate:
 static vs_status_e
 vs_secmodule_slot_load(vs_iot_secmodule_slot_e slot, uint8_t *data, uint16_t buf_sz, uint16_t *out_sz) {
     CHECK_NOT_ZERO_RET(_storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    vs_storage_file_t f;
+    vs_storage_file_t f = NULL;
     vs_storage_element_id_t id;
     const char *slot_name = _get_slot_name(slot);
     vs_status_e res = VS_CODE_ERR_FILE_WRITE;
     vs_status_e res_close = VS_CODE_OK;
-    ssize_t file_sz;
+    ssize_t file_sz = VS_CODE_ERR_FILE;
+#if SOFT_SECMODULE_SLOT_CACHE
+    uint32_t generation = 0;
+
+    if (_SLOT_CACHED(slot)) {
+        if (_slot_cache_load(slot, data, buf_sz, out_sz, &res)) {
+            return res;
+        }
+        generation = _slot_cache_generation(slot);
+    }
+#endif
 
     VS_IOT_MEMSET(id, 0, sizeof(vs_storage_element_id_t));
     CHECK_RET(VS_IOT_STRLEN(slot_name) < sizeof(vs_storage_element_id_t),
@@ -108,6 +278,15 @@ terminate:
         res_close = _storage->impl_func.close(_storage->impl_data, f);
     }
 
+#if SOFT_SECMODULE_SLOT_CACHE
+    // Storage errors are not cached, only slot content or its absence
+    if (_SLOT_CACHED(slot) && VS_CODE_OK == res && VS_CODE_OK == res_close) {
+        _slot_cache_fill(slot, &generation, data, *out_sz);
+    } else if (_SLOT_CACHED(slot) && (0 == file_sz || VS_CODE_ERR_NOT_FOUND == file_sz)) {
+        _slot_cache_fill(slot, &generation, NULL, 0);
+    }
+#endif
+
     return (VS_CODE_OK == res) ? res_close : res;
 }
 
@@ -125,6 +304,20 @@ vs_secmodule_slot_delete(vs_iot_secmodule_slot_e slot) {
               "Slot name too big");
     VS_IOT_STRCPY((char *)id, slot_name);
 
+#if SOFT_SECMODULE_SLOT_CACHE
+    if (_SLOT_CACHED(slot)) {
+        vs_status_e res;
+
+        _slot_cache_invalidate(slot);
+        res = _storage->impl_func.del(_storage->impl_data, id);
+        if (VS_CODE_OK == res) {
+            _slot_cache_fill(slot, NULL, NULL, 0);
+        }
+
+        return res;
+    }
+#endif
+
     return _storage->impl_func.del(_storage->impl_data, id);
 }
 
@@ -161,6 +354,10 @@ _get_slot_size(vs_iot_secmodule_slot_e slot) {
 /********************************************************************************/
 void
 _secmodule_deinit(void) {
+#if SOFT_SECMODULE_SLOT_CACHE
+    _slot_cache_reset();
+#endif
+
     if (_storage && _storage->impl_func.deinit) {
         _storage->impl_func.deinit(_storage->impl_data);
     }
@@ -173,6 +370,9 @@ _fill_slots_impl(vs_secmodule_impl_t *secmodule_impl, vs_storage_op_ctx_t *slots
     CHECK_NOT_ZERO_RET(slots_storage_impl, VS_CODE_ERR_NULLPTR_ARGUMENT);
 
     _storage = slots_storage_impl;
+#if SOFT_SECMODULE_SLOT_CACHE
+    _slot_cache_reset();
+#endif
 
     secmodule_impl->deinit = _secmodule_deinit;
 
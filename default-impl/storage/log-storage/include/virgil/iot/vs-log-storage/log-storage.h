@@ -0,0 +1,116 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+/**
+ * @file log-storage.h
+ * @brief Log-structured storage implementation for small elements
+ *
+ * Storage HAL implementation that keeps all elements in one append-only log file. It is intended for small elements
+ * that are rewritten as a whole : secure module slots, Trust List, secbox records, firmware descriptors. Each element
+ * rewrite appends one record instead of rewriting element file and its metadata, so flash memory is written
+ * sequentially by small portions.
+ *
+ * - All elements are kept in memory. \a load and \a size don't access the file.
+ * - \a save modifies element in memory. Element is appended to the log by \a sync or \a close, so several saves of one
+ * element produce one record.
+ * - \a sync appends all modified elements by one write and stores them by one fdatasync call.
+ * - \a del is appended to the log by the next \a sync call. It's dropped if element is saved again before that, so
+ * delete and save sequence produces one record.
+ * - Log is compacted by background thread when obsolete records are larger than alive ones and than
+ * #VS_LOG_STORAGE_COMPACT_MIN_SZ. Alive records are copied to the new log file that replaces the current one by rename.
+ * - Each record has CRC-32 checksum. Log is truncated after the last valid record during initialization, so element
+ * has either its previous or new content after power loss.
+ *
+ * Storage initialization example :
+ *  \code
+
+vs_storage_op_ctx_t slots_storage_impl;     // Storage implementation for slot
+vs_secmodule_impl_t *secmodule_impl;        // Security implementation
+
+STATUS_CHECK(vs_log_storage_init(&slots_storage_impl, "/var/lib/device/slots.log", VS_SLOTS_STORAGE_MAX_SIZE),
+             "Cannot initialize slots storage");
+secmodule_impl = vs_soft_secmodule_impl(&slots_storage_impl);
+
+...
+
+slots_storage_impl.impl_func.deinit(slots_storage_impl.impl_data);
+\endcode
+*/
+
+#ifndef VS_LOG_STORAGE_H
+#define VS_LOG_STORAGE_H
+
+#include <virgil/iot/storage_hal/storage_hal.h>
+
+/** Obsolete records size that starts log compaction */
+#ifndef VS_LOG_STORAGE_COMPACT_MIN_SZ
+#define VS_LOG_STORAGE_COMPACT_MIN_SZ (16 * 1024)
+#endif
+
+/** Log storage statistics */
+typedef struct {
+    uint64_t records;         /**< Records appended to the log */
+    uint64_t syncs;           /**< Log file synchronizations */
+    uint64_t bytes_written;   /**< Bytes written to the log files including compaction */
+    uint64_t compactions;     /**< Finished compactions */
+    uint64_t compacted_bytes; /**< Bytes written by compactions */
+    uint64_t recovered_bytes; /**< Bytes of incomplete or damaged records removed by initialization */
+    size_t log_sz;            /**< Current log size */
+    size_t alive_sz;          /**< Size of records with current elements content */
+} vs_log_storage_stats_t;
+
+/** Initialize log storage
+ *
+ * Log file is created if it's absent. Its directory must exist.
+ *
+ * \param[out] storage_ctx Storage context to be filled. Must not be NULL.
+ * \param[in] path Log file path. Must not be NULL.
+ * \param[in] file_sz_limit Maximum size of storage element. Must not be zero.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_log_storage_init(vs_storage_op_ctx_t *storage_ctx, const char *path, size_t file_sz_limit);
+
+/** Get log storage statistics
+ *
+ * \param[in] storage_ctx Storage context filled by #vs_log_storage_init. Must not be NULL.
+ * \param[out] stats Output buffer for statistics. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_log_storage_get_stats(const vs_storage_op_ctx_t *storage_ctx, vs_log_storage_stats_t *stats);
+
+#endif // VS_LOG_STORAGE_H
@@ -0,0 +1,882 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <stdlib-config.h>
+
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/vs-log-storage/log-storage.h>
+
+#if defined(__APPLE__)
+#define _DATA_SYNC(FD) fsync(FD)
+#else
+#define _DATA_SYNC(FD) fdatasync(FD)
+#endif
+
+#define VS_LOG_STORAGE_COMPACT_SUFFIX ".compact"
+#define VS_LOG_STORAGE_MAGIC (0x564C4F47)
+#define VS_LOG_STORAGE_DELETED (0x01)
+
+// Record header is followed by element data. Checksum covers the rest of header and data.
+typedef struct __attribute__((__packed__)) {
+    uint32_t magic;
+    uint32_t crc;
+    vs_storage_element_id_t id;
+    uint32_t data_sz;
+    uint8_t flags;
+} vs_log_storage_record_t;
+
+typedef struct {
+    vs_storage_element_id_t id;
+    uint8_t *data;
+    size_t data_sz;
+    bool present;
+    bool modified;     // Element content differs from its last log record
+    size_t record_pos; // Position of the last record with element content in the log
+    size_t record_sz;  // Size of this record. 0 if log doesn't contain element content
+} vs_log_storage_entry_t;
+
+typedef struct {
+    char *path;
+    char *compact_path;
+    int fd;
+    int dir_fd;
+    size_t file_sz_limit;
+    vs_log_storage_entry_t **entries;
+    size_t entries_cnt;
+    size_t entries_max;
+    vs_log_storage_stats_t stats;
+    pthread_mutex_t lock;
+    pthread_cond_t compact_cond;
+    pthread_t compact_thread;
+    bool stop;
+} vs_log_storage_t;
+
+// Alive record that is copied by compaction
+typedef struct {
+    vs_log_storage_entry_t *entry;
+    size_t old_pos;
+    size_t new_pos;
+    size_t record_sz;
+} vs_log_storage_snapshot_t;
+
+/******************************************************************************/
+static uint32_t
+_crc32(uint32_t crc, const uint8_t *data, size_t data_sz) {
+    static const uint32_t table[16] = {0x00000000,
+                                       0x1DB71064,
+                                       0x3B6E20C8,
+                                       0x26D930AC,
+                                       0x76DC4190,
+                                       0x6B6B51F4,
+                                       0x4DB26158,
+                                       0x5005713C,
+                                       0xEDB88320,
+                                       0xF00F9344,
+                                       0xD6D6A3E8,
+                                       0xCB61B38C,
+                                       0x9B64C2B0,
+                                       0x86D3D2D4,
+                                       0xA00AE278,
+                                       0xBDBDF21C};
+
+    crc = ~crc;
+    while (data_sz--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+
+    return ~crc;
+}
+
+/******************************************************************************/
+static uint32_t
+_record_crc(const vs_log_storage_record_t *record, const uint8_t *data) {
+    const uint8_t *checked = (const uint8_t *)&record->id;
+    uint32_t crc;
+
+    crc = _crc32(0, checked, sizeof(vs_log_storage_record_t) - (checked - (const uint8_t *)record));
+
+    return _crc32(crc, data, record->data_sz);
+}
+
+/******************************************************************************/
+static vs_status_e
+_write_all(int fd, size_t offset, const uint8_t *data, size_t data_sz) {
+    ssize_t written;
+
+    while (data_sz) {
+        written = pwrite(fd, data, data_sz, offset);
+        if (written < 0 && EINTR == errno) {
+            continue;
+        }
+        CHECK_RET(written > 0, VS_CODE_ERR_FILE_WRITE, "Cannot write storage log : %s", strerror(errno));
+
+        data += written;
+        data_sz -= written;
+        offset += written;
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_read_all(int fd, size_t offset, uint8_t *data, size_t data_sz) {
+    ssize_t res;
+
+    while (data_sz) {
+        res = pread(fd, data, data_sz, offset);
+        if (res < 0 && EINTR == errno) {
+            continue;
+        }
+        CHECK_RET(res > 0, VS_CODE_ERR_FILE_READ, "Cannot read storage log : %s", strerror(errno));
+
+        data += res;
+        data_sz -= res;
+        offset += res;
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_log_storage_entry_t *
+_entry_get(vs_log_storage_t *storage, const vs_storage_element_id_t id, bool create) {
+    vs_log_storage_entry_t **entries;
+    vs_log_storage_entry_t *entry;
+    size_t i;
+
+    for (i = 0; i < storage->entries_cnt; ++i) {
+        if (0 == VS_IOT_MEMCMP(storage->entries[i]->id, id, sizeof(vs_storage_element_id_t))) {
+            return storage->entries[i];
+        }
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    if (storage->entries_cnt == storage->entries_max) {
+        entries = VS_IOT_MALLOC(sizeof(vs_log_storage_entry_t *) * (storage->entries_max * 2 + 8));
+        CHECK_RET(entries, NULL, "Cannot allocate memory for storage index");
+        if (storage->entries_cnt) {
+            VS_IOT_MEMCPY(entries, storage->entries, sizeof(vs_log_storage_entry_t *) * storage->entries_cnt);
+        }
+        VS_IOT_FREE(storage->entries);
+        storage->entries = entries;
+        storage->entries_max = storage->entries_max * 2 + 8;
+    }
+
+    entry = VS_IOT_CALLOC(1, sizeof(vs_log_storage_entry_t));
+    CHECK_RET(entry, NULL, "Cannot allocate memory for storage element");
+    VS_IOT_MEMCPY(entry->id, id, sizeof(vs_storage_element_id_t));
+    storage->entries[storage->entries_cnt++] = entry;
+
+    return entry;
+}
+
+/******************************************************************************/
+// Element data buffer is kept if its size is enough
+static vs_status_e
+_entry_resize(vs_log_storage_entry_t *entry, size_t data_sz) {
+    uint8_t *data;
+
+    if (entry->present && data_sz <= entry->data_sz) {
+        entry->data_sz = data_sz;
+        return VS_CODE_OK;
+    }
+
+    data = VS_IOT_MALLOC(data_sz ? data_sz : 1);
+    CHECK_RET(data, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage element");
+
+    if (entry->present) {
+        VS_IOT_MEMCPY(data, entry->data, entry->data_sz);
+        VS_IOT_MEMSET(&data[entry->data_sz], 0, data_sz - entry->data_sz);
+    } else {
+        VS_IOT_MEMSET(data, 0, data_sz);
+    }
+
+    VS_IOT_FREE(entry->data);
+    entry->data = data;
+    entry->data_sz = data_sz;
+    entry->present = true;
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static void
+_entry_clear(vs_log_storage_entry_t *entry) {
+    VS_IOT_FREE(entry->data);
+    entry->data = NULL;
+    entry->data_sz = 0;
+    entry->present = false;
+}
+
+/******************************************************************************/
+// Deleted element needs record only if log contains its content
+static size_t
+_entry_record_sz(const vs_log_storage_entry_t *entry) {
+    if (!entry->modified || (!entry->present && !entry->record_sz)) {
+        return 0;
+    }
+
+    return sizeof(vs_log_storage_record_t) + (entry->present ? entry->data_sz : 0);
+}
+
+/******************************************************************************/
+static bool
+_need_compaction(const vs_log_storage_t *storage) {
+    size_t obsolete_sz = storage->stats.log_sz - storage->stats.alive_sz;
+
+    return obsolete_sz >= VS_LOG_STORAGE_COMPACT_MIN_SZ && obsolete_sz > storage->stats.alive_sz;
+}
+
+/******************************************************************************/
+// Appends records of modified elements by one write. All modified elements are appended if entry is NULL.
+static vs_status_e
+_append(vs_log_storage_t *storage, vs_log_storage_entry_t *entry) {
+    vs_log_storage_entry_t **entries = entry ? &entry : storage->entries;
+    size_t entries_cnt = entry ? 1 : storage->entries_cnt;
+    vs_log_storage_record_t record;
+    uint8_t *buf;
+    size_t buf_sz = 0;
+    size_t pos;
+    size_t i;
+
+    for (i = 0; i < entries_cnt; ++i) {
+        buf_sz += _entry_record_sz(entries[i]);
+    }
+
+    if (!buf_sz) {
+        for (i = 0; i < entries_cnt; ++i) {
+            entries[i]->modified = false;
+        }
+        return VS_CODE_OK;
+    }
+
+    buf = VS_IOT_MALLOC(buf_sz);
+    CHECK_RET(buf, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage log records");
+
+    for (i = 0, pos = 0; i < entries_cnt; ++i) {
+        if (!_entry_record_sz(entries[i])) {
+            continue;
+        }
+
+        record.magic = VS_LOG_STORAGE_MAGIC;
+        VS_IOT_MEMCPY(record.id, entries[i]->id, sizeof(vs_storage_element_id_t));
+        record.data_sz = entries[i]->present ? entries[i]->data_sz : 0;
+        record.flags = entries[i]->present ? 0 : VS_LOG_STORAGE_DELETED;
+        record.crc = _record_crc(&record, entries[i]->data);
+
+        VS_IOT_MEMCPY(&buf[pos], &record, sizeof(record));
+        if (record.data_sz) {
+            VS_IOT_MEMCPY(&buf[pos + sizeof(record)], entries[i]->data, record.data_sz);
+        }
+        pos += sizeof(record) + record.data_sz;
+    }
+
+    if (VS_CODE_OK != _write_all(storage->fd, storage->stats.log_sz, buf, buf_sz)) {
+        // Partial records are removed to keep appending after the last valid record
+        if (0 != ftruncate(storage->fd, storage->stats.log_sz)) {
+            VS_LOG_ERROR("Cannot truncate storage log : %s", strerror(errno));
+        }
+        VS_IOT_FREE(buf);
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    VS_IOT_FREE(buf);
+
+    for (i = 0, pos = storage->stats.log_sz; i < entries_cnt; ++i) {
+        size_t record_sz = _entry_record_sz(entries[i]);
+
+        entries[i]->modified = false;
+        if (!record_sz) {
+            continue;
+        }
+
+        storage->stats.alive_sz -= entries[i]->record_sz;
+        entries[i]->record_pos = pos;
+        entries[i]->record_sz = entries[i]->present ? record_sz : 0;
+        storage->stats.alive_sz += entries[i]->record_sz;
+
+        pos += record_sz;
+        ++storage->stats.records;
+    }
+
+    storage->stats.bytes_written += buf_sz;
+    storage->stats.log_sz += buf_sz;
+
+    if (_need_compaction(storage)) {
+        pthread_cond_signal(&storage->compact_cond);
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+// Fills elements index by log records. Log is truncated after the last valid record.
+static vs_status_e
+_recover(vs_log_storage_t *storage) {
+    vs_log_storage_record_t record;
+    vs_log_storage_entry_t *entry;
+    struct stat st;
+    uint8_t *log = NULL;
+    size_t log_sz;
+    size_t pos = 0;
+    vs_status_e ret_code = VS_CODE_ERR_FILE_READ;
+
+    CHECK_RET(0 == fstat(storage->fd, &st), VS_CODE_ERR_FILE_READ, "Cannot get storage log size");
+    log_sz = st.st_size;
+
+    if (log_sz) {
+        log = VS_IOT_MALLOC(log_sz);
+        CHECK_RET(log, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage log");
+        STATUS_CHECK(_read_all(storage->fd, 0, log, log_sz), "Cannot read storage log");
+    }
+
+    while (log_sz - pos >= sizeof(record)) {
+        VS_IOT_MEMCPY(&record, &log[pos], sizeof(record));
+
+        if (VS_LOG_STORAGE_MAGIC != record.magic || record.data_sz > log_sz - pos - sizeof(record) ||
+            record.crc != _record_crc(&record, &log[pos + sizeof(record)])) {
+            break;
+        }
+
+        ret_code = VS_CODE_ERR_NO_MEMORY;
+        CHECK(entry = _entry_get(storage, record.id, true), "Cannot add storage element");
+
+        storage->stats.alive_sz -= entry->record_sz;
+        if (record.flags & VS_LOG_STORAGE_DELETED) {
+            _entry_clear(entry);
+            entry->record_sz = 0;
+        } else {
+            _entry_clear(entry);
+            STATUS_CHECK(ret_code = _entry_resize(entry, record.data_sz), "Cannot load storage element");
+            VS_IOT_MEMCPY(entry->data, &log[pos + sizeof(record)], record.data_sz);
+            entry->record_pos = pos;
+            entry->record_sz = sizeof(record) + record.data_sz;
+        }
+        storage->stats.alive_sz += entry->record_sz;
+
+        pos += sizeof(record) + record.data_sz;
+    }
+
+    ret_code = VS_CODE_OK;
+
+    if (pos < log_sz) {
+        VS_LOG_WARNING("Storage log %s has %lu bytes of incomplete records after %lu bytes. They are removed.",
+                       storage->path,
+                       (unsigned long)(log_sz - pos),
+                       (unsigned long)pos);
+
+        ret_code = VS_CODE_ERR_FILE_WRITE;
+        CHECK(0 == ftruncate(storage->fd, pos) && 0 == _DATA_SYNC(storage->fd), "Cannot truncate storage log");
+        storage->stats.recovered_bytes = log_sz - pos;
+        ret_code = VS_CODE_OK;
+    }
+
+    storage->stats.log_sz = pos;
+
+terminate:
+    VS_IOT_FREE(log);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+// Copies alive records to the new log. It's called with storage lock, which is released while snapshot is written.
+static vs_status_e
+_compact(vs_log_storage_t *storage) {
+    vs_log_storage_snapshot_t *snapshot = NULL;
+    size_t snapshot_cnt = 0;
+    size_t snapshot_sz = 0;
+    size_t snapshot_end = storage->stats.log_sz;
+    uint8_t *buf = NULL;
+    size_t tail_sz;
+    size_t i;
+    int fd = -1;
+    int old_fd = storage->fd;
+    vs_log_storage_entry_t *entry;
+    vs_status_e ret_code = VS_CODE_ERR_NO_MEMORY;
+
+    snapshot = VS_IOT_MALLOC(sizeof(vs_log_storage_snapshot_t) * (storage->entries_cnt + 1));
+    CHECK_RET(snapshot, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage log compaction");
+
+    for (i = 0; i < storage->entries_cnt; ++i) {
+        entry = storage->entries[i];
+        if (entry->record_sz) {
+            snapshot[snapshot_cnt].entry = entry;
+            snapshot[snapshot_cnt].old_pos = entry->record_pos;
+            snapshot[snapshot_cnt].new_pos = snapshot_sz;
+            snapshot[snapshot_cnt].record_sz = entry->record_sz;
+            snapshot_sz += entry->record_sz;
+            ++snapshot_cnt;
+        }
+    }
+
+    // Records before snapshot end are not changed, so they are copied without lock
+    pthread_mutex_unlock(&storage->lock);
+
+    buf = VS_IOT_MALLOC(snapshot_sz ? snapshot_sz : 1);
+    fd = open(storage->compact_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (buf && fd >= 0) {
+        ret_code = VS_CODE_OK;
+        for (i = 0; i < snapshot_cnt && VS_CODE_OK == ret_code; ++i) {
+            ret_code = _read_all(old_fd, snapshot[i].old_pos, &buf[snapshot[i].new_pos], snapshot[i].record_sz);
+        }
+        if (VS_CODE_OK == ret_code) {
+            ret_code = _write_all(fd, 0, buf, snapshot_sz);
+        }
+    } else {
+        VS_LOG_ERROR("Cannot create %s : %s", storage->compact_path, strerror(errno));
+        ret_code = buf ? VS_CODE_ERR_FILE_WRITE : VS_CODE_ERR_NO_MEMORY;
+    }
+
+    pthread_mutex_lock(&storage->lock);
+    VS_IOT_FREE(buf);
+    buf = NULL;
+    STATUS_CHECK(ret_code, "Cannot write compacted storage log");
+
+    // Records appended during snapshot writing are copied as is
+    tail_sz = storage->stats.log_sz - snapshot_end;
+    ret_code = VS_CODE_ERR_NO_MEMORY;
+    CHECK(buf = VS_IOT_MALLOC(tail_sz ? tail_sz : 1), "Cannot allocate memory for storage log compaction");
+    STATUS_CHECK(ret_code = _read_all(storage->fd, snapshot_end, buf, tail_sz), "Cannot read storage log");
+    STATUS_CHECK(ret_code = _write_all(fd, snapshot_sz, buf, tail_sz), "Cannot write compacted storage log");
+
+    ret_code = VS_CODE_ERR_FILE_WRITE;
+    CHECK(0 == _DATA_SYNC(fd), "Cannot sync compacted storage log");
+    CHECK(0 == rename(storage->compact_path, storage->path), "Cannot replace storage log : %s", strerror(errno));
+    if (0 != fsync(storage->dir_fd)) {
+        VS_LOG_WARNING("Cannot sync storage log directory : %s", strerror(errno));
+    }
+
+    // Records positions are changed in the new log
+    for (i = 0; i < snapshot_cnt; ++i) {
+        entry = snapshot[i].entry;
+        if (entry->record_sz && entry->record_pos == snapshot[i].old_pos) {
+            entry->record_pos = snapshot[i].new_pos;
+        }
+    }
+    for (i = 0; i < storage->entries_cnt; ++i) {
+        entry = storage->entries[i];
+        if (entry->record_sz && entry->record_pos >= snapshot_end) {
+            entry->record_pos = entry->record_pos - snapshot_end + snapshot_sz;
+        }
+    }
+
+    close(storage->fd);
+    storage->fd = fd;
+    fd = -1;
+
+    storage->stats.log_sz = snapshot_sz + tail_sz;
+    storage->stats.bytes_written += snapshot_sz + tail_sz;
+    storage->stats.compacted_bytes += snapshot_sz + tail_sz;
+    ++storage->stats.compactions;
+
+    ret_code = VS_CODE_OK;
+
+terminate:
+    if (fd >= 0) {
+        close(fd);
+        unlink(storage->compact_path);
+    }
+    VS_IOT_FREE(buf);
+    VS_IOT_FREE(snapshot);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static void *
+_compact_thread(void *ctx) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)ctx;
+
+    pthread_mutex_lock(&storage->lock);
+
+    while (!storage->stop) {
+        // Failed compaction is repeated after the next append
+        if (_need_compaction(storage) && VS_CODE_OK == _compact(storage)) {
+            continue;
+        }
+        pthread_cond_wait(&storage->compact_cond, &storage->lock);
+    }
+
+    pthread_mutex_unlock(&storage->lock);
+
+    return NULL;
+}
+
+/******************************************************************************/
+static void
+_storage_free(vs_log_storage_t *storage) {
+    size_t i;
+
+    for (i = 0; i < storage->entries_cnt; ++i) {
+        VS_IOT_FREE(storage->entries[i]->data);
+        VS_IOT_FREE(storage->entries[i]);
+    }
+    VS_IOT_FREE(storage->entries);
+
+    if (storage->fd >= 0) {
+        close(storage->fd);
+    }
+    if (storage->dir_fd >= 0) {
+        close(storage->dir_fd);
+    }
+    VS_IOT_FREE(storage->path);
+    VS_IOT_FREE(storage->compact_path);
+    VS_IOT_FREE(storage);
+}
+
+/******************************************************************************/
+static vs_status_e
+_log_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)storage_ctx;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&storage->lock);
+    storage->stop = true;
+    pthread_cond_signal(&storage->compact_cond);
+    pthread_mutex_unlock(&storage->lock);
+    pthread_join(storage->compact_thread, NULL);
+
+    // Pending deletions are written without sync, as other implementations do for closed files
+    ret_code = _append(storage, NULL);
+
+    pthread_cond_destroy(&storage->compact_cond);
+    pthread_mutex_destroy(&storage->lock);
+    _storage_free(storage);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_storage_file_t
+_log_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)storage_ctx;
+    vs_log_storage_entry_t *entry;
+
+    CHECK_NOT_ZERO_RET(storage, NULL);
+    CHECK_NOT_ZERO_RET(id, NULL);
+
+    pthread_mutex_lock(&storage->lock);
+    entry = _entry_get(storage, id, true);
+    pthread_mutex_unlock(&storage->lock);
+
+    return entry;
+}
+
+/******************************************************************************/
+static vs_status_e
+_log_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)storage_ctx;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&storage->lock);
+
+    ret_code = _append(storage, NULL);
+    if (VS_CODE_OK == ret_code) {
+        if (0 == _DATA_SYNC(storage->fd)) {
+            ++storage->stats.syncs;
+        } else {
+            VS_LOG_ERROR("Cannot sync storage log : %s", strerror(errno));
+            ret_code = VS_CODE_ERR_FILE_WRITE;
+        }
+    }
+
+    pthread_mutex_unlock(&storage->lock);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_log_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)storage_ctx;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // Entry stays in the index, so only its modification is stored
+    pthread_mutex_lock(&storage->lock);
+    ret_code = _append(storage, (vs_log_storage_entry_t *)file);
+    pthread_mutex_unlock(&storage->lock);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_log_save(const vs_storage_impl_data_ctx_t storage_ctx,
+          const vs_storage_file_t file,
+          size_t offset,
+          const uint8_t *data,
+          size_t data_sz) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)storage_ctx;
+    vs_log_storage_entry_t *entry = (vs_log_storage_entry_t *)file;
+    vs_status_e ret_code = VS_CODE_OK;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data || !data_sz, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(offset + data_sz <= storage->file_sz_limit,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Storage element exceeds size limit");
+
+    pthread_mutex_lock(&storage->lock);
+
+    if (!entry->present || offset + data_sz > entry->data_sz) {
+        ret_code = _entry_resize(entry, offset + data_sz);
+    }
+
+    if (VS_CODE_OK == ret_code) {
+        if (data_sz) {
+            VS_IOT_MEMCPY(&entry->data[offset], data, data_sz);
+        }
+        entry->modified = true;
+    }
+
+    pthread_mutex_unlock(&storage->lock);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_log_load(const vs_storage_impl_data_ctx_t storage_ctx,
+          const vs_storage_file_t file,
+          size_t offset,
+          uint8_t *out_data,
+          size_t data_sz) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)storage_ctx;
+    vs_log_storage_entry_t *entry = (vs_log_storage_entry_t *)file;
+    vs_status_e ret_code = VS_CODE_ERR_FILE_READ;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(out_data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&storage->lock);
+
+    if (entry->present && offset <= entry->data_sz && data_sz <= entry->data_sz - offset) {
+        VS_IOT_MEMCPY(out_data, &entry->data[offset], data_sz);
+        ret_code = VS_CODE_OK;
+    }
+
+    pthread_mutex_unlock(&storage->lock);
+
+    if (VS_CODE_OK != ret_code) {
+        VS_LOG_ERROR("Cannot read storage element");
+    }
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static ssize_t
+_log_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)storage_ctx;
+    vs_log_storage_entry_t *entry;
+    ssize_t size = VS_CODE_ERR_NOT_FOUND;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(id, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&storage->lock);
+    entry = _entry_get(storage, id, false);
+    if (entry && entry->present) {
+        size = entry->data_sz;
+    }
+    pthread_mutex_unlock(&storage->lock);
+
+    return size;
+}
+
+/******************************************************************************/
+static vs_status_e
+_log_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_log_storage_t *storage = (vs_log_storage_t *)storage_ctx;
+    vs_log_storage_entry_t *entry;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(id, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // Deletion record is appended by the next sync if element is not saved again before it
+    pthread_mutex_lock(&storage->lock);
+    entry = _entry_get(storage, id, false);
+    if (entry && entry->present) {
+        _entry_clear(entry);
+        entry->modified = true;
+    }
+    pthread_mutex_unlock(&storage->lock);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static char *
+_path_dup(const char *path, const char *suffix) {
+    size_t path_sz = VS_IOT_STRLEN(path) + VS_IOT_STRLEN(suffix) + 1;
+    char *res = VS_IOT_MALLOC(path_sz);
+
+    if (res) {
+        VS_IOT_SNPRINTF(res, path_sz, "%s%s", path, suffix);
+    }
+
+    return res;
+}
+
+/******************************************************************************/
+static int
+_dir_open(const char *path) {
+    char *dir_path = _path_dup(path, "");
+    int fd = -1;
+
+    if (dir_path) {
+        fd = open(dirname(dir_path), O_RDONLY | O_CLOEXEC);
+        VS_IOT_FREE(dir_path);
+    }
+
+    return fd;
+}
+
+/******************************************************************************/
+vs_status_e
+vs_log_storage_init(vs_storage_op_ctx_t *storage_ctx, const char *path, size_t file_sz_limit) {
+    vs_log_storage_t *storage;
+
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(path, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_sz_limit, VS_CODE_ERR_INCORRECT_ARGUMENT);
+    CHECK_RET(file_sz_limit <= UINT32_MAX, VS_CODE_ERR_INCORRECT_ARGUMENT, "Storage element size limit is too big");
+
+    storage = VS_IOT_CALLOC(1, sizeof(vs_log_storage_t));
+    CHECK_RET(storage, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage context");
+
+    storage->file_sz_limit = file_sz_limit;
+    storage->path = _path_dup(path, "");
+    storage->compact_path = _path_dup(path, VS_LOG_STORAGE_COMPACT_SUFFIX);
+    storage->dir_fd = _dir_open(path);
+    storage->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+    if (!storage->path || !storage->compact_path || storage->dir_fd < 0 || storage->fd < 0) {
+        VS_LOG_ERROR("Cannot open storage log %s : %s", path, strerror(errno));
+        _storage_free(storage);
+        return VS_CODE_ERR_FILE;
+    }
+
+    // Compaction could be interrupted before the new log replaced the current one
+    unlink(storage->compact_path);
+
+    if (VS_CODE_OK != _recover(storage)) {
+        _storage_free(storage);
+        return VS_CODE_ERR_FILE_READ;
+    }
+
+    if (0 != pthread_mutex_init(&storage->lock, NULL)) {
+        _storage_free(storage);
+        return VS_CODE_ERR_NO_MEMORY;
+    }
+
+    if (0 != pthread_cond_init(&storage->compact_cond, NULL)) {
+        pthread_mutex_destroy(&storage->lock);
+        _storage_free(storage);
+        return VS_CODE_ERR_NO_MEMORY;
+    }
+
+    if (0 != pthread_create(&storage->compact_thread, NULL, _compact_thread, storage)) {
+        VS_LOG_ERROR("Cannot start storage log compaction thread");
+        pthread_cond_destroy(&storage->compact_cond);
+        pthread_mutex_destroy(&storage->lock);
+        _storage_free(storage);
+        return VS_CODE_ERR_NO_MEMORY;
+    }
+
+    VS_IOT_MEMSET(storage_ctx, 0, sizeof(vs_storage_op_ctx_t));
+    storage_ctx->impl_func.deinit = _log_deinit;
+    storage_ctx->impl_func.open = _log_open;
+    storage_ctx->impl_func.sync = _log_sync;
+    storage_ctx->impl_func.close = _log_close;
+    storage_ctx->impl_func.save = _log_save;
+    storage_ctx->impl_func.load = _log_load;
+    storage_ctx->impl_func.size = _log_size;
+    storage_ctx->impl_func.del = _log_del;
+    storage_ctx->impl_data = storage;
+    storage_ctx->file_sz_limit = file_sz_limit;
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+vs_status_e
+vs_log_storage_get_stats(const vs_storage_op_ctx_t *storage_ctx, vs_log_storage_stats_t *stats) {
+    vs_log_storage_t *storage;
+
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(storage_ctx->impl_data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(stats, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    storage = (vs_log_storage_t *)storage_ctx->impl_data;
+
+    pthread_mutex_lock(&storage->lock);
+    *stats = storage->stats;
+    pthread_mutex_unlock(&storage->lock);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
@@ -0,0 +1,73 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+
+#ifndef VS_POSIX_STORAGE_INTERNAL_H
+#define VS_POSIX_STORAGE_INTERNAL_H
+
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/storage_hal/storage_hal.h>
+
+typedef struct vs_posix_storage_uring_s vs_posix_storage_uring_t;
+
+typedef struct {
+    char *dir;
+    int dir_fd;
+    size_t file_sz_limit;
+    vs_posix_storage_uring_t *uring;
+} vs_posix_storage_t;
+
+// File descriptor is -1 until absent element is saved
+typedef struct {
+    int fd;
+    bool renamed;
+    char path[];
+} vs_posix_storage_file_t;
+
+vs_status_e
+_request_perform(int fd, vs_storage_request_t *request, size_t done_sz);
+
+vs_posix_storage_uring_t *
+_uring_init(void);
+
+void
+_uring_deinit(vs_posix_storage_uring_t *uring);
+
+vs_status_e
+_uring_submit(vs_posix_storage_uring_t *uring, int fd, vs_storage_request_t *request);
+
+vs_status_e
+_uring_complete(vs_posix_storage_uring_t *uring, vs_storage_request_t *request);
+
+#endif // VS_POSIX_STORAGE_INTERNAL_H
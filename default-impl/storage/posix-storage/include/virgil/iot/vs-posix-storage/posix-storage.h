@@ -0,0 +1,89 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+
+/**
+ * @file posix-storage.h
+ * @brief POSIX file storage implementation
+ *
+ * Storage HAL implementation for Linux and other POSIX systems. Each storage element is a file in the storage
+ * directory named by hexadecimal element identifier.
+ *
+ * - \a load and \a save use positional pread/pwrite calls, so element is opened once and doesn't need seeks.
+ * - \a save that rewrites whole element writes data to the temporary file, stores it by fdatasync and renames it over
+ * the element, so readers and restarted device see either previous or new element content. Elements with reserved
+ * space are written in place.
+ * - \a sync stores file data by fdatasync and directory entry after rename by directory fsync. Other calls except
+ * rewriting \a save don't wait for the storage device.
+ * - \a reserve preallocates element space by fallocate without changing its size. Firmware module uses it to
+ * allocate firmware image by the size from descriptor before download.
+ * - \a load_v and \a save_v use preadv/pwritev calls. Vectored save rewrites whole element the same way as \a save.
+ * - \a submit and \a complete use io_uring if library has been built with it and kernel allows it. Otherwise request
+ * is performed by \a submit call. Asynchronous save is always performed in place.
+ *
+ * Storage initialization example :
+ *  \code
+
+vs_storage_op_ctx_t slots_storage_impl;     // Storage implementation for slot
+vs_secmodule_impl_t *secmodule_impl;        // Security implementation
+
+STATUS_CHECK(vs_posix_storage_init(&slots_storage_impl, "/var/lib/device/slots", VS_SLOTS_STORAGE_MAX_SIZE),
+             "Cannot initialize slots storage");
+secmodule_impl = vs_soft_secmodule_impl(&slots_storage_impl);
+
+...
+
+slots_storage_impl.impl_func.deinit(slots_storage_impl.impl_data);
+\endcode
+*/
+
+#ifndef VS_POSIX_STORAGE_H
+#define VS_POSIX_STORAGE_H
+
+#include <virgil/iot/storage_hal/storage_hal.h>
+
+/** Initialize POSIX file storage
+ *
+ * Directory is created if it's absent. Its parent directory must exist.
+ *
+ * \param[out] storage_ctx Storage context to be filled. Must not be NULL.
+ * \param[in] dir Storage directory. Must not be NULL.
+ * \param[in] file_sz_limit Maximum size of storage element. Must not be zero.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_posix_storage_init(vs_storage_op_ctx_t *storage_ctx, const char *dir, size_t file_sz_limit);
+
+#endif // VS_POSIX_STORAGE_H
@@ -0,0 +1,350 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+
+// Asynchronous requests by io_uring. Ring is used by system calls directly to avoid liburing dependency.
+
+#include <stdlib-config.h>
+
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/macros/macros.h>
+#include <private/posix-storage-internal.h>
+
+#if POSIX_STORAGE_IO_URING
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define VS_POSIX_STORAGE_URING_DEPTH (16)
+
+// Pending request keeps file descriptor + 1 in impl_data to finish short transfers
+#define _PENDING_FD(REQUEST) ((int)(intptr_t)(REQUEST)->impl_data - 1)
+#define _PENDING_DATA(FD) ((void *)(intptr_t)((FD) + 1))
+
+struct vs_posix_storage_uring_s {
+    int fd;
+    pthread_mutex_t lock;
+    uint32_t inflight;
+
+    void *sq_ptr;
+    size_t sq_sz;
+    void *cq_ptr;
+    size_t cq_sz;
+    struct io_uring_sqe *sqes;
+    size_t sqes_sz;
+
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned sq_entries;
+
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+/******************************************************************************/
+static void
+_uring_unmap(vs_posix_storage_uring_t *uring) {
+    if (uring->sqes && MAP_FAILED != uring->sqes) {
+        munmap(uring->sqes, uring->sqes_sz);
+    }
+    if (uring->cq_ptr && MAP_FAILED != uring->cq_ptr && uring->cq_ptr != uring->sq_ptr) {
+        munmap(uring->cq_ptr, uring->cq_sz);
+    }
+    if (uring->sq_ptr && MAP_FAILED != uring->sq_ptr) {
+        munmap(uring->sq_ptr, uring->sq_sz);
+    }
+    close(uring->fd);
+}
+
+/******************************************************************************/
+vs_posix_storage_uring_t *
+_uring_init(void) {
+    vs_posix_storage_uring_t *uring;
+    struct io_uring_params params;
+
+    uring = VS_IOT_CALLOC(1, sizeof(vs_posix_storage_uring_t));
+    CHECK_RET(uring, NULL, "Cannot allocate memory for io_uring");
+
+    VS_IOT_MEMSET(&params, 0, sizeof(params));
+    uring->fd = (int)syscall(__NR_io_uring_setup, VS_POSIX_STORAGE_URING_DEPTH, &params);
+    if (uring->fd < 0) {
+        // Old kernel or forbidden by sandbox, so requests are performed synchronously
+        VS_LOG_DEBUG("io_uring is not available : %s", strerror(errno));
+        VS_IOT_FREE(uring);
+        return NULL;
+    }
+
+    uring->sq_sz = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    uring->cq_sz = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        uring->sq_sz = uring->cq_sz > uring->sq_sz ? uring->cq_sz : uring->sq_sz;
+        uring->cq_sz = uring->sq_sz;
+    }
+    uring->sqes_sz = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    uring->sq_ptr = mmap(NULL,
+                         uring->sq_sz,
+                         PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE,
+                         uring->fd,
+                         IORING_OFF_SQ_RING);
+    if (MAP_FAILED == uring->sq_ptr) {
+        goto terminate;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        uring->cq_ptr = uring->sq_ptr;
+    } else {
+        uring->cq_ptr = mmap(NULL,
+                             uring->cq_sz,
+                             PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE,
+                             uring->fd,
+                             IORING_OFF_CQ_RING);
+        if (MAP_FAILED == uring->cq_ptr) {
+            goto terminate;
+        }
+    }
+
+    uring->sqes = mmap(NULL,
+                       uring->sqes_sz,
+                       PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE,
+                       uring->fd,
+                       IORING_OFF_SQES);
+    if (MAP_FAILED == uring->sqes) {
+        goto terminate;
+    }
+
+    uring->sq_head = (unsigned *)((uint8_t *)uring->sq_ptr + params.sq_off.head);
+    uring->sq_tail = (unsigned *)((uint8_t *)uring->sq_ptr + params.sq_off.tail);
+    uring->sq_mask = (unsigned *)((uint8_t *)uring->sq_ptr + params.sq_off.ring_mask);
+    uring->sq_array = (unsigned *)((uint8_t *)uring->sq_ptr + params.sq_off.array);
+    uring->sq_entries = params.sq_entries;
+
+    uring->cq_head = (unsigned *)((uint8_t *)uring->cq_ptr + params.cq_off.head);
+    uring->cq_tail = (unsigned *)((uint8_t *)uring->cq_ptr + params.cq_off.tail);
+    uring->cq_mask = (unsigned *)((uint8_t *)uring->cq_ptr + params.cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe *)((uint8_t *)uring->cq_ptr + params.cq_off.cqes);
+
+    if (0 != pthread_mutex_init(&uring->lock, NULL)) {
+        goto terminate;
+    }
+
+    return uring;
+
+terminate:
+    VS_LOG_WARNING("Cannot map io_uring : %s", strerror(errno));
+    _uring_unmap(uring);
+    VS_IOT_FREE(uring);
+
+    return NULL;
+}
+
+/******************************************************************************/
+// Must be called under lock
+static void
+_uring_reap(vs_posix_storage_uring_t *uring) {
+    unsigned head = *uring->cq_head;
+    unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        const struct io_uring_cqe *cqe = &uring->cqes[head & *uring->cq_mask];
+        vs_storage_request_t *request = (vs_storage_request_t *)(uintptr_t)cqe->user_data;
+        int fd = _PENDING_FD(request);
+
+        if (cqe->res < 0) {
+            request->result = -EINVAL == cqe->res ? _request_perform(fd, request, 0)
+                                                  : (request->save ? VS_CODE_ERR_FILE_WRITE : VS_CODE_ERR_FILE_READ);
+        } else if ((size_t)cqe->res < request->data_sz) {
+            // Short transfer is finished synchronously
+            request->result = _request_perform(fd, request, cqe->res);
+        } else {
+            request->result = VS_CODE_OK;
+        }
+
+        request->impl_data = NULL;
+        --uring->inflight;
+        ++head;
+    }
+
+    __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/******************************************************************************/
+void
+_uring_deinit(vs_posix_storage_uring_t *uring) {
+    if (!uring) {
+        return;
+    }
+
+    pthread_mutex_lock(&uring->lock);
+    while (uring->inflight) {
+        if (syscall(__NR_io_uring_enter, uring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && EINTR != errno) {
+            break;
+        }
+        _uring_reap(uring);
+    }
+    pthread_mutex_unlock(&uring->lock);
+
+    pthread_mutex_destroy(&uring->lock);
+    _uring_unmap(uring);
+    VS_IOT_FREE(uring);
+}
+
+/******************************************************************************/
+vs_status_e
+_uring_submit(vs_posix_storage_uring_t *uring, int fd, vs_storage_request_t *request) {
+    struct io_uring_sqe *sqe;
+    unsigned tail;
+    long res;
+
+    CHECK_NOT_ZERO_RET(uring, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // IORING_OP_READ and IORING_OP_WRITE lengths are 32 bits
+    if (request->data_sz > UINT32_MAX) {
+        return VS_CODE_ERR_NOT_IMPLEMENTED;
+    }
+
+    pthread_mutex_lock(&uring->lock);
+
+    if (uring->inflight >= uring->sq_entries) {
+        pthread_mutex_unlock(&uring->lock);
+        return VS_CODE_ERR_CTX_NOT_READY;
+    }
+
+    tail = *uring->sq_tail;
+    sqe = &uring->sqes[tail & *uring->sq_mask];
+    VS_IOT_MEMSET(sqe, 0, sizeof(*sqe));
+    sqe->opcode = request->save ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->off = request->offset;
+    sqe->addr = (uintptr_t)request->data;
+    sqe->len = (uint32_t)request->data_sz;
+    sqe->user_data = (uintptr_t)request;
+
+    uring->sq_array[tail & *uring->sq_mask] = tail & *uring->sq_mask;
+    __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    request->impl_data = _PENDING_DATA(fd);
+    ++uring->inflight;
+
+    do {
+        res = syscall(__NR_io_uring_enter, uring->fd, 1, 0, 0, NULL, 0);
+    } while (res < 0 && EINTR == errno);
+
+    if (res < 0) {
+        // Entry has not been consumed by kernel, so it is withdrawn
+        VS_LOG_WARNING("Cannot submit io_uring request : %s", strerror(errno));
+        __atomic_store_n(uring->sq_tail, tail, __ATOMIC_RELEASE);
+        request->impl_data = NULL;
+        --uring->inflight;
+        pthread_mutex_unlock(&uring->lock);
+        return VS_CODE_ERR_FILE;
+    }
+
+    pthread_mutex_unlock(&uring->lock);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+vs_status_e
+_uring_complete(vs_posix_storage_uring_t *uring, vs_storage_request_t *request) {
+    long res;
+
+    CHECK_NOT_ZERO_RET(uring, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&uring->lock);
+
+    _uring_reap(uring);
+    while (request->impl_data) {
+        res = syscall(__NR_io_uring_enter, uring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (res < 0 && EINTR != errno) {
+            pthread_mutex_unlock(&uring->lock);
+            VS_LOG_ERROR("Cannot wait for io_uring request : %s", strerror(errno));
+            return VS_CODE_ERR_FILE;
+        }
+        _uring_reap(uring);
+    }
+
+    pthread_mutex_unlock(&uring->lock);
+
+    return request->result;
+}
+
+#else // POSIX_STORAGE_IO_URING
+
+/******************************************************************************/
+vs_posix_storage_uring_t *
+_uring_init(void) {
+    return NULL;
+}
+
+/******************************************************************************/
+void
+_uring_deinit(vs_posix_storage_uring_t *uring) {
+    (void)uring;
+}
+
+/******************************************************************************/
+vs_status_e
+_uring_submit(vs_posix_storage_uring_t *uring, int fd, vs_storage_request_t *request) {
+    (void)uring;
+    (void)fd;
+    (void)request;
+    return VS_CODE_ERR_NOT_IMPLEMENTED;
+}
+
+/******************************************************************************/
+vs_status_e
+_uring_complete(vs_posix_storage_uring_t *uring, vs_storage_request_t *request) {
+    (void)uring;
+    (void)request;
+    return VS_CODE_ERR_NOT_IMPLEMENTED;
+}
+
+#endif // POSIX_STORAGE_IO_URING
+
+/******************************************************************************/
@@ -0,0 +1,666 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include <stdlib-config.h>
+
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/vs-posix-storage/posix-storage.h>
+#include <private/posix-storage-internal.h>
+
+#if defined(__APPLE__)
+#define _DATA_SYNC(FD) fsync(FD)
+#else
+#define _DATA_SYNC(FD) fdatasync(FD)
+#endif
+
+#define VS_POSIX_STORAGE_TMP_SUFFIX ".tmp"
+#define VS_POSIX_STORAGE_NAME_SZ (sizeof(vs_storage_element_id_t) * 2 + sizeof(VS_POSIX_STORAGE_TMP_SUFFIX))
+
+/******************************************************************************/
+static char *
+_element_path(const vs_posix_storage_t *storage, const vs_storage_element_id_t id) {
+    static const char hex[] = "0123456789abcdef";
+    size_t dir_len = VS_IOT_STRLEN(storage->dir);
+    char *path = VS_IOT_MALLOC(dir_len + 1 + VS_POSIX_STORAGE_NAME_SZ);
+    char *pos;
+    size_t i;
+
+    CHECK_RET(path, NULL, "Cannot allocate memory for storage element path");
+
+    VS_IOT_MEMCPY(path, storage->dir, dir_len);
+    pos = &path[dir_len];
+    *pos++ = '/';
+
+    for (i = 0; i < sizeof(vs_storage_element_id_t); ++i) {
+        *pos++ = hex[id[i] >> 4];
+        *pos++ = hex[id[i] & 0x0F];
+    }
+    *pos = 0;
+
+    return path;
+}
+
+/******************************************************************************/
+static size_t
+_iov_size(const struct iovec *iov, int iov_cnt) {
+    size_t size = 0;
+    int i;
+
+    for (i = 0; i < iov_cnt; ++i) {
+        size += iov[i].iov_len;
+    }
+
+    return size;
+}
+
+/******************************************************************************/
+// Skips transferred data after partial preadv/pwritev
+static void
+_iov_advance(struct iovec **iov, int *iov_cnt, size_t done_sz) {
+    while (*iov_cnt && done_sz >= (*iov)->iov_len) {
+        done_sz -= (*iov)->iov_len;
+        ++*iov;
+        --*iov_cnt;
+    }
+
+    if (*iov_cnt) {
+        (*iov)->iov_base = (uint8_t *)(*iov)->iov_base + done_sz;
+        (*iov)->iov_len -= done_sz;
+    }
+}
+
+/******************************************************************************/
+static vs_status_e
+_write_v(int fd, size_t offset, struct iovec *iov, int iov_cnt) {
+    ssize_t written;
+
+    _iov_advance(&iov, &iov_cnt, 0);
+
+    while (iov_cnt) {
+        written = pwritev(fd, iov, iov_cnt, offset);
+        if (written < 0 && EINTR == errno) {
+            continue;
+        }
+        CHECK_RET(written > 0, VS_CODE_ERR_FILE_WRITE, "Cannot write storage element : %s", strerror(errno));
+
+        offset += written;
+        _iov_advance(&iov, &iov_cnt, written);
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_read_v(int fd, size_t offset, struct iovec *iov, int iov_cnt) {
+    ssize_t read_sz;
+
+    _iov_advance(&iov, &iov_cnt, 0);
+
+    while (iov_cnt) {
+        read_sz = preadv(fd, iov, iov_cnt, offset);
+        if (read_sz < 0 && EINTR == errno) {
+            continue;
+        }
+        CHECK_RET(read_sz > 0, VS_CODE_ERR_FILE_READ, "Cannot read storage element");
+
+        offset += read_sz;
+        _iov_advance(&iov, &iov_cnt, read_sz);
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static struct iovec *
+_iov_from_bufs(const vs_storage_buf_t *bufs, size_t bufs_cnt) {
+    struct iovec *iov;
+    size_t i;
+
+    CHECK_RET(bufs_cnt <= IOV_MAX, NULL, "Too many storage buffers");
+
+    iov = VS_IOT_MALLOC(bufs_cnt * sizeof(struct iovec));
+    CHECK_RET(iov, NULL, "Cannot allocate memory for storage buffers");
+
+    for (i = 0; i < bufs_cnt; ++i) {
+        iov[i].iov_base = bufs[i].data;
+        iov[i].iov_len = bufs[i].data_sz;
+    }
+
+    return iov;
+}
+
+/******************************************************************************/
+vs_status_e
+_request_perform(int fd, vs_storage_request_t *request, size_t done_sz) {
+    struct iovec iov;
+
+    CHECK_RET(fd >= 0, VS_CODE_ERR_FILE_READ, "Storage element is absent");
+
+    iov.iov_base = request->data + done_sz;
+    iov.iov_len = request->data_sz - done_sz;
+
+    return request->save ? _write_v(fd, request->offset + done_sz, &iov, 1)
+                         : _read_v(fd, request->offset + done_sz, &iov, 1);
+}
+
+/******************************************************************************/
+static bool
+_is_rewrite(const vs_posix_storage_file_t *file, size_t offset, size_t data_sz) {
+    struct stat st;
+    off_t used_sz;
+
+    if (offset) {
+        return false;
+    }
+
+    if (file->fd < 0) {
+        return true;
+    }
+
+    if (0 != fstat(file->fd, &st) || st.st_size > (off_t)data_sz) {
+        return false;
+    }
+
+    // Reserved space is used by in place writes
+    used_sz = st.st_blksize > 0 ? (st.st_size + st.st_blksize - 1) / st.st_blksize * st.st_blksize : st.st_size;
+    return (off_t)st.st_blocks * 512 <= used_sz;
+}
+
+/******************************************************************************/
+static vs_status_e
+_rewrite(vs_posix_storage_file_t *file, struct iovec *iov, int iov_cnt) {
+    size_t tmp_path_sz = VS_IOT_STRLEN(file->path) + sizeof(VS_POSIX_STORAGE_TMP_SUFFIX);
+    char *tmp_path = VS_IOT_MALLOC(tmp_path_sz);
+    int fd;
+
+    CHECK_RET(tmp_path, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage element path");
+    VS_IOT_SNPRINTF(tmp_path, tmp_path_sz, "%s%s", file->path, VS_POSIX_STORAGE_TMP_SUFFIX);
+
+    fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        VS_LOG_ERROR("Cannot create %s : %s", tmp_path, strerror(errno));
+        VS_IOT_FREE(tmp_path);
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    // New content is stored before rename, so power loss can't leave renamed element without its data
+    if (VS_CODE_OK != _write_v(fd, 0, iov, iov_cnt) || 0 != _DATA_SYNC(fd) || 0 != rename(tmp_path, file->path)) {
+        VS_LOG_ERROR("Cannot replace %s : %s", file->path, strerror(errno));
+        close(fd);
+        unlink(tmp_path);
+        VS_IOT_FREE(tmp_path);
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    VS_IOT_FREE(tmp_path);
+
+    if (file->fd >= 0) {
+        close(file->fd);
+    }
+    file->fd = fd;
+    file->renamed = true;
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _uring_deinit(storage->uring);
+    close(storage->dir_fd);
+    VS_IOT_FREE(storage->dir);
+    VS_IOT_FREE(storage);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_storage_file_t
+_posix_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+    vs_posix_storage_file_t *file;
+    char *path;
+
+    CHECK_NOT_ZERO_RET(storage, NULL);
+    CHECK_NOT_ZERO_RET(id, NULL);
+
+    path = _element_path(storage, id);
+    CHECK_NOT_ZERO_RET(path, NULL);
+
+    file = VS_IOT_MALLOC(sizeof(vs_posix_storage_file_t) + VS_IOT_STRLEN(path) + 1);
+    if (!file) {
+        VS_IOT_FREE(path);
+        VS_LOG_ERROR("Cannot allocate memory for storage element");
+        return NULL;
+    }
+
+    VS_IOT_STRCPY(file->path, path);
+    VS_IOT_FREE(path);
+    file->renamed = false;
+
+    file->fd = open(file->path, O_RDWR | O_CLOEXEC);
+    if (file->fd < 0 && ENOENT != errno) {
+        VS_LOG_ERROR("Cannot open %s : %s", file->path, strerror(errno));
+        VS_IOT_FREE(file);
+        return NULL;
+    }
+
+    return file;
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+    vs_posix_storage_file_t *f = (vs_posix_storage_file_t *)file;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (f->fd >= 0) {
+        CHECK_RET(0 == _DATA_SYNC(f->fd), VS_CODE_ERR_FILE_WRITE, "Cannot sync %s : %s", f->path, strerror(errno));
+    }
+
+    // Renamed element is stored after its directory entry
+    if (f->renamed) {
+        CHECK_RET(0 == fsync(storage->dir_fd), VS_CODE_ERR_FILE_WRITE, "Cannot sync storage directory");
+        f->renamed = false;
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    vs_posix_storage_file_t *f = (vs_posix_storage_file_t *)file;
+    vs_status_e ret_code = VS_CODE_OK;
+
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (f->fd >= 0 && 0 != close(f->fd)) {
+        VS_LOG_ERROR("Cannot close %s : %s", f->path, strerror(errno));
+        ret_code = VS_CODE_ERR_FILE;
+    }
+
+    VS_IOT_FREE(f);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_open_for_save(vs_posix_storage_file_t *f) {
+    if (f->fd < 0) {
+        f->fd = open(f->path, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        CHECK_RET(f->fd >= 0, VS_CODE_ERR_FILE_WRITE, "Cannot create %s : %s", f->path, strerror(errno));
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_save_iov(const vs_posix_storage_t *storage,
+          vs_posix_storage_file_t *f,
+          size_t offset,
+          struct iovec *iov,
+          int iov_cnt) {
+    size_t data_sz = _iov_size(iov, iov_cnt);
+    vs_status_e ret_code;
+
+    CHECK_RET(offset + data_sz <= storage->file_sz_limit,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Storage element %s exceeds size limit",
+              f->path);
+
+    if (_is_rewrite(f, offset, data_sz)) {
+        return _rewrite(f, iov, iov_cnt);
+    }
+
+    STATUS_CHECK_RET(_open_for_save(f), "Cannot open storage element");
+
+    return _write_v(f->fd, offset, iov, iov_cnt);
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_save(const vs_storage_impl_data_ctx_t storage_ctx,
+            const vs_storage_file_t file,
+            size_t offset,
+            const uint8_t *data,
+            size_t data_sz) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+    vs_posix_storage_file_t *f = (vs_posix_storage_file_t *)file;
+    struct iovec iov;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    iov.iov_base = (void *)data;
+    iov.iov_len = data_sz;
+
+    return _save_iov(storage, f, offset, &iov, 1);
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_save_v(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              size_t offset,
+              const vs_storage_buf_t *bufs,
+              size_t bufs_cnt) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+    vs_posix_storage_file_t *f = (vs_posix_storage_file_t *)file;
+    struct iovec *iov;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(bufs, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(bufs_cnt, VS_CODE_ERR_ZERO_ARGUMENT);
+
+    iov = _iov_from_bufs(bufs, bufs_cnt);
+    CHECK_NOT_ZERO_RET(iov, VS_CODE_ERR_NO_MEMORY);
+
+    ret_code = _save_iov(storage, f, offset, iov, (int)bufs_cnt);
+    VS_IOT_FREE(iov);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_load(const vs_storage_impl_data_ctx_t storage_ctx,
+            const vs_storage_file_t file,
+            size_t offset,
+            uint8_t *out_data,
+            size_t data_sz) {
+    vs_posix_storage_file_t *f = (vs_posix_storage_file_t *)file;
+    struct iovec iov;
+
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(out_data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(f->fd >= 0, VS_CODE_ERR_FILE_READ, "Storage element %s is absent", f->path);
+
+    iov.iov_base = out_data;
+    iov.iov_len = data_sz;
+
+    return _read_v(f->fd, offset, &iov, 1);
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_load_v(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              size_t offset,
+              const vs_storage_buf_t *bufs,
+              size_t bufs_cnt) {
+    vs_posix_storage_file_t *f = (vs_posix_storage_file_t *)file;
+    struct iovec *iov;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(bufs, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(bufs_cnt, VS_CODE_ERR_ZERO_ARGUMENT);
+    CHECK_RET(f->fd >= 0, VS_CODE_ERR_FILE_READ, "Storage element %s is absent", f->path);
+
+    iov = _iov_from_bufs(bufs, bufs_cnt);
+    CHECK_NOT_ZERO_RET(iov, VS_CODE_ERR_NO_MEMORY);
+
+    ret_code = _read_v(f->fd, offset, iov, (int)bufs_cnt);
+    VS_IOT_FREE(iov);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_submit(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              vs_storage_request_t *request) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+    vs_posix_storage_file_t *f = (vs_posix_storage_file_t *)file;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(request, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(request->data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    request->impl_data = NULL;
+
+    // Asynchronous save is always performed in place
+    if (request->save) {
+        CHECK_RET(request->offset + request->data_sz <= storage->file_sz_limit,
+                  VS_CODE_ERR_INCORRECT_ARGUMENT,
+                  "Storage element %s exceeds size limit",
+                  f->path);
+        STATUS_CHECK_RET(_open_for_save(f), "Cannot open storage element");
+    } else {
+        CHECK_RET(f->fd >= 0, VS_CODE_ERR_FILE_READ, "Storage element %s is absent", f->path);
+    }
+
+    if (storage->uring && VS_CODE_OK == _uring_submit(storage->uring, f->fd, request)) {
+        return VS_CODE_OK;
+    }
+
+    // Request is performed now and its result is returned by completion
+    request->result = _request_perform(f->fd, request, 0);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_complete(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_request_t *request) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(request, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (!request->impl_data) {
+        return request->result;
+    }
+
+    return _uring_complete(storage->uring, request);
+}
+
+/******************************************************************************/
+static ssize_t
+_posix_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+    struct stat st;
+    char *path;
+    int res;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(id, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    path = _element_path(storage, id);
+    CHECK_NOT_ZERO_RET(path, VS_CODE_ERR_NO_MEMORY);
+
+    res = stat(path, &st);
+    VS_IOT_FREE(path);
+
+    if (0 != res) {
+        return ENOENT == errno ? VS_CODE_ERR_NOT_FOUND : VS_CODE_ERR_FILE;
+    }
+
+    return st.st_size;
+}
+
+/******************************************************************************/
+static vs_status_e
+_posix_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+    char *path;
+    int res;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(id, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    path = _element_path(storage, id);
+    CHECK_NOT_ZERO_RET(path, VS_CODE_ERR_NO_MEMORY);
+
+    res = unlink(path);
+    if (0 != res && ENOENT != errno) {
+        VS_LOG_ERROR("Cannot delete %s : %s", path, strerror(errno));
+        VS_IOT_FREE(path);
+        return VS_CODE_ERR_FILE_DELETE;
+    }
+
+    VS_IOT_FREE(path);
+
+    return VS_CODE_OK;
+}
+
+#if defined(__linux__)
+/******************************************************************************/
+static vs_status_e
+_posix_reserve(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id, size_t size) {
+    vs_posix_storage_t *storage = (vs_posix_storage_t *)storage_ctx;
+    vs_status_e ret_code = VS_CODE_OK;
+    char *path;
+    int fd;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(id, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (!size) {
+        return VS_CODE_OK;
+    }
+
+    path = _element_path(storage, id);
+    CHECK_NOT_ZERO_RET(path, VS_CODE_ERR_NO_MEMORY);
+
+    fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        VS_LOG_ERROR("Cannot create %s : %s", path, strerror(errno));
+        VS_IOT_FREE(path);
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    // File systems without preallocation support allocate space by writes as usual
+    if (0 != fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size) && EOPNOTSUPP != errno && ENOSYS != errno) {
+        VS_LOG_ERROR("Cannot reserve %lu bytes for %s : %s", (unsigned long)size, path, strerror(errno));
+        ret_code = ENOSPC == errno ? VS_CODE_ERR_NO_MEMORY : VS_CODE_ERR_FILE_WRITE;
+    }
+
+    close(fd);
+    VS_IOT_FREE(path);
+
+    return ret_code;
+}
+#endif // __linux__
+
+/******************************************************************************/
+vs_status_e
+vs_posix_storage_init(vs_storage_op_ctx_t *storage_ctx, const char *dir, size_t file_sz_limit) {
+    vs_posix_storage_t *storage;
+
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(dir, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_sz_limit, VS_CODE_ERR_INCORRECT_ARGUMENT);
+
+    CHECK_RET(0 == mkdir(dir, S_IRWXU) || EEXIST == errno,
+              VS_CODE_ERR_FILE,
+              "Cannot create storage directory %s : %s",
+              dir,
+              strerror(errno));
+
+    storage = VS_IOT_CALLOC(1, sizeof(vs_posix_storage_t));
+    CHECK_RET(storage, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage context");
+
+    storage->dir = VS_IOT_MALLOC(VS_IOT_STRLEN(dir) + 1);
+    storage->dir_fd = open(dir, O_RDONLY | O_CLOEXEC);
+    if (!storage->dir || storage->dir_fd < 0) {
+        VS_LOG_ERROR("Cannot open storage directory %s", dir);
+        if (storage->dir_fd >= 0) {
+            close(storage->dir_fd);
+        }
+        VS_IOT_FREE(storage->dir);
+        VS_IOT_FREE(storage);
+        return VS_CODE_ERR_FILE;
+    }
+    VS_IOT_STRCPY(storage->dir, dir);
+    storage->file_sz_limit = file_sz_limit;
+    storage->uring = _uring_init();
+
+    VS_IOT_MEMSET(storage_ctx, 0, sizeof(vs_storage_op_ctx_t));
+    storage_ctx->impl_func.deinit = _posix_deinit;
+    storage_ctx->impl_func.open = _posix_open;
+    storage_ctx->impl_func.sync = _posix_sync;
+    storage_ctx->impl_func.close = _posix_close;
+    storage_ctx->impl_func.save = _posix_save;
+    storage_ctx->impl_func.load = _posix_load;
+    storage_ctx->impl_func.size = _posix_size;
+    storage_ctx->impl_func.del = _posix_del;
+#if defined(__linux__)
+    storage_ctx->impl_func.reserve = _posix_reserve;
+#endif
+    storage_ctx->impl_func.load_v = _posix_load_v;
+    storage_ctx->impl_func.save_v = _posix_save_v;
+    storage_ctx->impl_func.submit = _posix_submit;
+    storage_ctx->impl_func.complete = _posix_complete;
+    storage_ctx->impl_data = storage;
+    storage_ctx->file_sz_limit = file_sz_limit;
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
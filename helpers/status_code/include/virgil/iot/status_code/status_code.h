@@ -75,6 +75,7 @@ extern "C" {
  * Zero value #VS_CODE_OK is used for non-error values. Negative values mean error
  */
 typedef enum {
+    VS_CODE_COMMAND_RETRY_LATER = 101,  /**< Request is postponed, negative response contains service specific hint */
     VS_CODE_COMMAND_NO_RESPONSE = 100,  /**< No need in response */
     VS_CODE_OLD_VERSION = 1,    /**< Provided file is not newer than the current file */
     VS_CODE_OK = 0, /**< Successful operation */
@@ -0,0 +1,159 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+/*! \file storage_fault_injection.h
+ * \brief Storage HAL latency and failures injection
+ *
+ * Fault injection storage wraps any #vs_storage_op_ctx_t and delays or fails its calls, so modules can be checked on
+ * slow or unreliable flash memory without such device. It counts backend calls too, so it can be used to measure
+ * amount of syncs and transferred data of any module.
+ *
+ * \section storage_fault_injection_usage Storage Fault Injection Usage
+ *
+ * Fault injection context is the usual #vs_storage_op_ctx_t, so it can be passed to any module instead of backend one :
+ * \code
+ *  vs_storage_op_ctx_t backend_storage;
+ *  vs_storage_op_ctx_t firmware_storage;
+ *  vs_storage_fault_config_t slow_flash = {0};
+ *
+ *  slow_flash.save_latency_us = 2000;
+ *  slow_flash.sync_latency_us = 20000;
+ *  slow_flash.byte_latency_ns = 100;
+ *  slow_flash.failures_per_mille = 5;
+ *  slow_flash.failure_ops = VS_STORAGE_FAULT_SAVE | VS_STORAGE_FAULT_SYNC;
+ *
+ *  // Backend storage initialization
+ *  ...
+ *  STATUS_CHECK(vs_storage_fault_injection_init(&firmware_storage, &backend_storage, &slow_flash),
+ *               "Cannot initialize fault injection storage");
+ *  STATUS_CHECK(vs_firmware_init(&firmware_storage, secmodule_impl, manufacture_id, device_type, &ver),
+ *               "Cannot initialize Firmware module");
+ * \endcode
+ *
+ * Fault injection \a deinit call destroys backend storage context too.
+ *
+ * Failed call returns error code without backend call. Failed save with \a torn_saves writes the first half of data
+ * before error, as power loss during flash programming does. Failures are selected by pseudo-random sequence of
+ * \a seed, so test run can be repeated.
+ */
+
+#ifndef VS_STORAGE_FAULT_INJECTION_H
+#define VS_STORAGE_FAULT_INJECTION_H
+
+#include <virgil/iot/storage_hal/storage_hal.h>
+
+#ifdef __cplusplus
+namespace VirgilIoTKit {
+extern "C" {
+#endif
+
+/** Operations that can be failed */
+typedef enum {
+    VS_STORAGE_FAULT_OPEN = 1 << 0, /**< \a open returns NULL */
+    VS_STORAGE_FAULT_LOAD = 1 << 1, /**< \a load, \a load_v and read \a submit return #VS_CODE_ERR_FILE_READ */
+    VS_STORAGE_FAULT_SAVE = 1 << 2, /**< \a save, \a save_v and write \a submit return #VS_CODE_ERR_FILE_WRITE */
+    VS_STORAGE_FAULT_SYNC = 1 << 3, /**< \a sync returns #VS_CODE_ERR_FILE_WRITE */
+    VS_STORAGE_FAULT_DEL = 1 << 4,  /**< \a del returns #VS_CODE_ERR_FILE_DELETE */
+} vs_storage_fault_op_e;
+
+/** Injected latency and failures */
+typedef struct {
+    uint32_t load_latency_us;    /**< Delay of each load call */
+    uint32_t save_latency_us;    /**< Delay of each save call */
+    uint32_t sync_latency_us;    /**< Delay of each sync call */
+    uint32_t byte_latency_ns;    /**< Additional delay of load and save calls for each transferred byte */
+    uint16_t failures_per_mille; /**< Failed calls per 1000 calls of \a failure_ops operations */
+    uint32_t failure_ops;        /**< Mask of #vs_storage_fault_op_e operations to be failed */
+    bool torn_saves;             /**< Failed save writes the first half of data */
+    uint32_t seed;               /**< Failures pseudo-random sequence seed */
+} vs_storage_fault_config_t;
+
+/** Storage fault injection statistics */
+typedef struct {
+    uint32_t opens;        /**< Open calls */
+    uint32_t loads;        /**< Load calls including vectored and asynchronous ones */
+    uint32_t saves;        /**< Save calls including vectored and asynchronous ones */
+    uint32_t syncs;        /**< Sync calls */
+    uint32_t dels;         /**< Delete calls */
+    uint64_t loaded_bytes; /**< Data size requested by load calls */
+    uint64_t saved_bytes;  /**< Data size passed to save calls */
+    uint32_t failures;     /**< Injected failures */
+    uint64_t injected_us;  /**< Total injected latency */
+} vs_storage_fault_stats_t;
+
+/** Initialize storage fault injection
+ *
+ * Fills \a storage_ctx by fault injection implementation that uses \a backend calls. Backend context is copied, so the
+ * caller must not use or destroy it after successful call. Use \a deinit member of \a storage_ctx to destroy both
+ * contexts.
+ *
+ * \param[out] storage_ctx Storage context to be filled. Must not be NULL.
+ * \param[in] backend Backend storage context. Must not be NULL.
+ * \param[in] config Injected latency and failures. NULL to count calls only.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_storage_fault_injection_init(vs_storage_op_ctx_t *storage_ctx,
+                                const vs_storage_op_ctx_t *backend,
+                                const vs_storage_fault_config_t *config);
+
+/** Change injected latency and failures
+ *
+ * It can be used to enable failures after data preparation or to disable them for results check.
+ *
+ * \param[in] storage_ctx Storage context initialized by #vs_storage_fault_injection_init. Must not be NULL.
+ * \param[in] config Injected latency and failures. NULL to disable injection.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_storage_fault_injection_configure(const vs_storage_op_ctx_t *storage_ctx, const vs_storage_fault_config_t *config);
+
+/** Get storage fault injection statistics
+ *
+ * \param[in] storage_ctx Storage context initialized by #vs_storage_fault_injection_init. Must not be NULL.
+ * \param[out] stats Output buffer for statistics. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_storage_fault_injection_get_stats(const vs_storage_op_ctx_t *storage_ctx, vs_storage_fault_stats_t *stats);
+
+#ifdef __cplusplus
+} // extern "C"
+} // namespace VirgilIoTKit
+#endif
+
+#endif // VS_STORAGE_FAULT_INJECTION_H
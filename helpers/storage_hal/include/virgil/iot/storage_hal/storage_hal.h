@@ -53,6 +53,13 @@
  * - \a load : loads data from storage to the memory.
  * - \a save : saves data from memory to the storage.
  * - \a deinit : destroys storage context.
+ * - \a reserve : optional call that reserves storage space for element of expected size, e.g. for firmware image.
+ * - \a load_v and \a save_v : optional vectored calls that load or save contiguous element data from/to several
+ * buffers by one storage access.
+ * - \a submit and \a complete : optional asynchronous load or save. Caller can process previous data while request is
+ * being performed.
+ *
+ * Optional calls can be NULL. In this case callers use \a load and \a save calls.
  *
  */
 
@@ -61,6 +68,8 @@
 
 #include <virgil/iot/status_code/status_code.h>
 #include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 namespace VirgilIoTKit {
@@ -187,6 +196,108 @@ typedef vs_status_e (*vs_storage_del_hal_t)(
         const vs_storage_impl_data_ctx_t storage_ctx,
         const vs_storage_element_id_t id);
 
+/** Reserve storage space for storage element
+ *
+ * Reserves space for element data of \a size bytes, so next saves don't allocate it piece by piece. Element size
+ * returned by \a size call is not changed. Element is created if it's absent.
+ *
+ * \param[in] storage_ctx Storage context. Cannot be NULL.
+ * \param[in] id Storage element identifier.
+ * \param[in] size Expected element size.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+typedef vs_status_e (*vs_storage_reserve_hal_t)(
+        const vs_storage_impl_data_ctx_t storage_ctx,
+        const vs_storage_element_id_t id,
+        size_t size);
+
+/** Data buffer for vectored load and save */
+typedef struct {
+    uint8_t *data;  /**< Data buffer. It's not changed by save calls */
+    size_t data_sz; /**< Data size */
+} vs_storage_buf_t;
+
+/** Load storage element to several buffers
+ *
+ * Loads contiguous element data starting from \a offset to \a bufs buffers in their order.
+ *
+ * \param[in] storage_ctx Storage context. Cannot be NULL.
+ * \param[in] file Storage file context.
+ * \param[in] offset Data offset.
+ * \param[in] bufs Output buffers. Cannot be NULL.
+ * \param[in] bufs_cnt Buffers amount. Cannot be zero.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+typedef vs_status_e (*vs_storage_load_v_hal_t)(
+        const vs_storage_impl_data_ctx_t storage_ctx,
+        const vs_storage_file_t file,
+        size_t offset,
+        const vs_storage_buf_t *bufs,
+        size_t bufs_cnt);
+
+/** Save storage element from several buffers
+ *
+ * Saves \a bufs buffers in their order as contiguous element data starting from \a offset.
+ *
+ * \param[in] storage_ctx Storage context. Cannot be NULL.
+ * \param[in] file Storage file context.
+ * \param[in] offset Save data offset.
+ * \param[in] bufs Data buffers. Cannot be NULL.
+ * \param[in] bufs_cnt Buffers amount. Cannot be zero.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+typedef vs_status_e (*vs_storage_save_v_hal_t)(
+        const vs_storage_impl_data_ctx_t storage_ctx,
+        const vs_storage_file_t file,
+        size_t offset,
+        const vs_storage_buf_t *bufs,
+        size_t bufs_cnt);
+
+/** Asynchronous load or save request
+ *
+ * Request is owned by caller. It must not be changed or freed until its completion.
+ */
+typedef struct {
+    bool save;          /**< Save \a data if true, load it otherwise */
+    size_t offset;      /**< Data offset */
+    uint8_t *data;      /**< Data buffer */
+    size_t data_sz;     /**< Data size */
+    vs_status_e result; /**< Request result. It's set by \a complete call */
+    void *impl_data;    /**< Storage implementation specific data */
+} vs_storage_request_t;
+
+/** Submit asynchronous request
+ *
+ * Starts load or save described by \a request. Submitted request must be completed by \a complete call before file
+ * close. Implementation can perform request during this call.
+ *
+ * \param[in] storage_ctx Storage context. Cannot be NULL.
+ * \param[in] file Storage file context.
+ * \param[in,out] request Request to be performed. Cannot be NULL.
+ *
+ * \return #VS_CODE_OK if request has been submitted or error code.
+ */
+typedef vs_status_e (*vs_storage_submit_hal_t)(
+        const vs_storage_impl_data_ctx_t storage_ctx,
+        const vs_storage_file_t file,
+        vs_storage_request_t *request);
+
+/** Complete asynchronous request
+ *
+ * Waits for submitted request completion.
+ *
+ * \param[in] storage_ctx Storage context. Cannot be NULL.
+ * \param[in,out] request Submitted request. Cannot be NULL.
+ *
+ * \return Request result : #VS_CODE_OK in case of success or error code.
+ */
+typedef vs_status_e (*vs_storage_complete_hal_t)(
+        const vs_storage_impl_data_ctx_t storage_ctx,
+        vs_storage_request_t *request);
+
 /** Load currently executed firmware descriptor
  *
  * \param[out] descriptor Output buffer to store firmware descriptor. Cannot be NULL.
@@ -212,6 +323,14 @@ typedef struct {
     vs_storage_file_size_hal_t size; /**< Get storage element size */
 
     vs_storage_del_hal_t del; /**< Delete storage element */
+
+    vs_storage_reserve_hal_t reserve; /**< Reserve space for storage element. Optional, can be NULL */
+
+    vs_storage_load_v_hal_t load_v; /**< Load storage element to several buffers. Optional, can be NULL */
+    vs_storage_save_v_hal_t save_v; /**< Save storage element from several buffers. Optional, can be NULL */
+
+    vs_storage_submit_hal_t submit; /**< Submit asynchronous request. Optional, can be NULL with \a complete */
+    vs_storage_complete_hal_t complete; /**< Complete asynchronous request. Optional, can be NULL with \a submit */
 } vs_storage_impl_func_t;
 
 /** Storage element context
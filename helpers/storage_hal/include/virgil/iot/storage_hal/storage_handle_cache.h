@@ -0,0 +1,131 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+
+/*! \file storage_handle_cache.h
+ * \brief Storage HAL open handles cache
+ *
+ * Storage handles cache wraps any #vs_storage_op_ctx_t and keeps storage elements opened after their close calls. Next
+ * open of the same element returns the same handle without backend open call, so frequently used elements like
+ * secure slots, Trust List and firmware image are not reopened for each operation.
+ *
+ * \section storage_handle_cache_usage Storage Handles Cache Usage
+ *
+ * Cache context is the usual #vs_storage_op_ctx_t, so it can be passed to any module instead of backend one :
+ * \code
+ *  vs_storage_op_ctx_t backend_storage;
+ *  vs_storage_op_ctx_t tl_storage;
+ *
+ *  // Backend storage initialization
+ *  ...
+ *  STATUS_CHECK(vs_storage_handle_cache_init(&tl_storage, &backend_storage, 4), "Cannot initialize handles cache");
+ *  STATUS_CHECK(vs_tl_init(&tl_storage, secmodule_impl), "Cannot initialize Trust List module");
+ * \endcode
+ *
+ * Cache \a deinit call destroys backend storage context too.
+ *
+ * Each open call increments reference counter of the element handle and each close call decrements it. Backend
+ * handle is closed when it becomes the least recently used one among unreferenced handles and \a max_open handles are
+ * already opened. If all cached handles are referenced, element is opened and closed by backend as without cache.
+ * \a del call closes unreferenced handle of the element. Referenced handle is marked as stale : it is still valid for
+ * current users and it is closed by the last close call, but next open call opens the element again.
+ *
+ * \warning Backend close call is postponed, so data saved by backend with delayed write is stored by \a sync call or
+ * handle eviction. Call \a sync after the last element save if it must be stored immediately.
+ *
+ * \warning Opens of the same element share one backend handle. Backend must allow such handle usage by several
+ * users.
+ */
+
+#ifndef VS_STORAGE_HANDLE_CACHE_H
+#define VS_STORAGE_HANDLE_CACHE_H
+
+#include <virgil/iot/storage_hal/storage_hal.h>
+
+#ifdef __cplusplus
+namespace VirgilIoTKit {
+extern "C" {
+#endif
+
+/** Storage handles cache statistics */
+typedef struct {
+    uint32_t hits;      /**< Open calls that used already opened handle */
+    uint32_t misses;    /**< Open calls that called backend open */
+    uint32_t evictions; /**< Unreferenced handles closed to open another element */
+    uint32_t uncached;  /**< Open calls served without cache because all handles were referenced */
+    uint32_t opened;    /**< Backend handles that are opened now */
+} vs_storage_handle_cache_stats_t;
+
+/** Initialize storage handles cache
+ *
+ * Fills \a storage_ctx by cache implementation that uses \a backend calls. Backend context is copied, so the caller
+ * must not use or destroy it after successful call. Use \a deinit member of \a storage_ctx to destroy both contexts.
+ *
+ * \param[out] storage_ctx Storage context to be filled. Must not be NULL.
+ * \param[in] backend Backend storage context. Must not be NULL.
+ * \param[in] max_open Maximum amount of cached backend handles. Must not be zero.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_storage_handle_cache_init(vs_storage_op_ctx_t *storage_ctx, const vs_storage_op_ctx_t *backend, size_t max_open);
+
+/** Close unreferenced handles
+ *
+ * Closes all cached backend handles that are not used now. It can be called before long idle periods to release
+ * backend resources.
+ *
+ * \param[in] storage_ctx Storage context initialized by #vs_storage_handle_cache_init. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_storage_handle_cache_flush(const vs_storage_op_ctx_t *storage_ctx);
+
+/** Get storage handles cache statistics
+ *
+ * \param[in] storage_ctx Storage context initialized by #vs_storage_handle_cache_init. Must not be NULL.
+ * \param[out] stats Output buffer for statistics. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_storage_handle_cache_get_stats(const vs_storage_op_ctx_t *storage_ctx, vs_storage_handle_cache_stats_t *stats);
+
+#ifdef __cplusplus
+} // extern "C"
+} // namespace VirgilIoTKit
+#endif
+
+#endif // VS_STORAGE_HANDLE_CACHE_H
@@ -0,0 +1,465 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <stdlib-config.h>
+
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/storage_hal/storage_fault_injection.h>
+
+typedef struct {
+    vs_storage_op_ctx_t backend;
+    vs_storage_fault_config_t config;
+    uint32_t random;
+    vs_storage_fault_stats_t stats;
+    pthread_mutex_t lock;
+} vs_storage_fault_injection_t;
+
+static vs_storage_file_t
+_fault_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id);
+
+/******************************************************************************/
+static vs_storage_fault_injection_t *
+_fault_from_ctx(const vs_storage_op_ctx_t *storage_ctx) {
+    if (!storage_ctx || storage_ctx->impl_func.open != _fault_open) {
+        return NULL;
+    }
+    return (vs_storage_fault_injection_t *)storage_ctx->impl_data;
+}
+
+/******************************************************************************/
+// Sets configuration and restarts failures sequence. Lock must be held.
+static void
+_configure(vs_storage_fault_injection_t *fault, const vs_storage_fault_config_t *config) {
+    if (config) {
+        VS_IOT_MEMCPY(&fault->config, config, sizeof(*config));
+    } else {
+        VS_IOT_MEMSET(&fault->config, 0, sizeof(fault->config));
+    }
+
+    // xorshift state must not be zero
+    fault->random = fault->config.seed ? fault->config.seed : 1;
+}
+
+/******************************************************************************/
+static uint32_t
+_next_random(vs_storage_fault_injection_t *fault) {
+    uint32_t x = fault->random;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    fault->random = x;
+
+    return x;
+}
+
+/******************************************************************************/
+static void
+_delay(uint64_t delay_ns) {
+    struct timespec ts;
+
+    ts.tv_sec = delay_ns / 1000000000ULL;
+    ts.tv_nsec = delay_ns % 1000000000ULL;
+
+    while (0 != nanosleep(&ts, &ts) && EINTR == errno) {
+    }
+}
+
+/******************************************************************************/
+// Counts the call, delays it and returns true if it must be failed
+static bool
+_inject(vs_storage_fault_injection_t *fault, vs_storage_fault_op_e op, size_t data_sz) {
+    uint64_t delay_ns = 0;
+    bool failed = false;
+
+    pthread_mutex_lock(&fault->lock);
+
+    switch (op) {
+    case VS_STORAGE_FAULT_OPEN:
+        ++fault->stats.opens;
+        break;
+    case VS_STORAGE_FAULT_LOAD:
+        ++fault->stats.loads;
+        fault->stats.loaded_bytes += data_sz;
+        delay_ns = fault->config.load_latency_us * 1000ULL + (uint64_t)data_sz * fault->config.byte_latency_ns;
+        break;
+    case VS_STORAGE_FAULT_SAVE:
+        ++fault->stats.saves;
+        fault->stats.saved_bytes += data_sz;
+        delay_ns = fault->config.save_latency_us * 1000ULL + (uint64_t)data_sz * fault->config.byte_latency_ns;
+        break;
+    case VS_STORAGE_FAULT_SYNC:
+        ++fault->stats.syncs;
+        delay_ns = fault->config.sync_latency_us * 1000ULL;
+        break;
+    case VS_STORAGE_FAULT_DEL:
+        ++fault->stats.dels;
+        break;
+    }
+
+    if ((fault->config.failure_ops & op) && fault->config.failures_per_mille &&
+        _next_random(fault) % 1000 < fault->config.failures_per_mille) {
+        ++fault->stats.failures;
+        failed = true;
+    }
+
+    fault->stats.injected_us += delay_ns / 1000;
+
+    pthread_mutex_unlock(&fault->lock);
+
+    // Calls of several threads are delayed simultaneously as requests to flash controller with queue
+    if (delay_ns) {
+        _delay(delay_ns);
+    }
+
+    return failed;
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+    vs_status_e ret_code = VS_CODE_OK;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (fault->backend.impl_func.deinit) {
+        ret_code = fault->backend.impl_func.deinit(fault->backend.impl_data);
+    }
+
+    pthread_mutex_destroy(&fault->lock);
+    VS_IOT_FREE(fault);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_storage_file_t
+_fault_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, NULL);
+
+    if (_inject(fault, VS_STORAGE_FAULT_OPEN, 0)) {
+        return NULL;
+    }
+
+    return fault->backend.impl_func.open(fault->backend.impl_data, id);
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (_inject(fault, VS_STORAGE_FAULT_SYNC, 0)) {
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    return fault->backend.impl_func.sync(fault->backend.impl_data, file);
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return fault->backend.impl_func.close(fault->backend.impl_data, file);
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_save(const vs_storage_impl_data_ctx_t storage_ctx,
+            const vs_storage_file_t file,
+            size_t offset,
+            const uint8_t *data,
+            size_t data_sz) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (!_inject(fault, VS_STORAGE_FAULT_SAVE, data_sz)) {
+        return fault->backend.impl_func.save(fault->backend.impl_data, file, offset, data, data_sz);
+    }
+
+    if (fault->config.torn_saves && data_sz / 2) {
+        fault->backend.impl_func.save(fault->backend.impl_data, file, offset, data, data_sz / 2);
+    }
+
+    return VS_CODE_ERR_FILE_WRITE;
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_load(const vs_storage_impl_data_ctx_t storage_ctx,
+            const vs_storage_file_t file,
+            size_t offset,
+            uint8_t *out_data,
+            size_t data_sz) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (_inject(fault, VS_STORAGE_FAULT_LOAD, data_sz)) {
+        return VS_CODE_ERR_FILE_READ;
+    }
+
+    return fault->backend.impl_func.load(fault->backend.impl_data, file, offset, out_data, data_sz);
+}
+
+/******************************************************************************/
+static ssize_t
+_fault_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return fault->backend.impl_func.size(fault->backend.impl_data, id);
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (_inject(fault, VS_STORAGE_FAULT_DEL, 0)) {
+        return VS_CODE_ERR_FILE_DELETE;
+    }
+
+    return fault->backend.impl_func.del(fault->backend.impl_data, id);
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_reserve(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id, size_t size) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return fault->backend.impl_func.reserve(fault->backend.impl_data, id, size);
+}
+
+/******************************************************************************/
+static size_t
+_bufs_size(const vs_storage_buf_t *bufs, size_t bufs_cnt) {
+    size_t size = 0;
+    size_t i;
+
+    for (i = 0; i < bufs_cnt; ++i) {
+        size += bufs[i].data_sz;
+    }
+
+    return size;
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_load_v(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              size_t offset,
+              const vs_storage_buf_t *bufs,
+              size_t bufs_cnt) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(bufs, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (_inject(fault, VS_STORAGE_FAULT_LOAD, _bufs_size(bufs, bufs_cnt))) {
+        return VS_CODE_ERR_FILE_READ;
+    }
+
+    return fault->backend.impl_func.load_v(fault->backend.impl_data, file, offset, bufs, bufs_cnt);
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_save_v(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              size_t offset,
+              const vs_storage_buf_t *bufs,
+              size_t bufs_cnt) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+    size_t torn_sz;
+    size_t part_sz;
+    size_t i;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(bufs, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    torn_sz = _bufs_size(bufs, bufs_cnt);
+    if (!_inject(fault, VS_STORAGE_FAULT_SAVE, torn_sz)) {
+        return fault->backend.impl_func.save_v(fault->backend.impl_data, file, offset, bufs, bufs_cnt);
+    }
+
+    // The first half of data is written by buffers parts
+    torn_sz = fault->config.torn_saves ? torn_sz / 2 : 0;
+    for (i = 0; i < bufs_cnt && torn_sz; ++i) {
+        part_sz = bufs[i].data_sz < torn_sz ? bufs[i].data_sz : torn_sz;
+        if (part_sz) {
+            fault->backend.impl_func.save(fault->backend.impl_data, file, offset, bufs[i].data, part_sz);
+        }
+        offset += part_sz;
+        torn_sz -= part_sz;
+    }
+
+    return VS_CODE_ERR_FILE_WRITE;
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_submit(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              vs_storage_request_t *request) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(request, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // Latency delays submit call, so asynchronous request doesn't hide it
+    if (!_inject(fault, request->save ? VS_STORAGE_FAULT_SAVE : VS_STORAGE_FAULT_LOAD, request->data_sz)) {
+        return fault->backend.impl_func.submit(fault->backend.impl_data, file, request);
+    }
+
+    if (!request->save) {
+        return VS_CODE_ERR_FILE_READ;
+    }
+
+    if (fault->config.torn_saves && request->data_sz / 2) {
+        fault->backend.impl_func.save(
+                fault->backend.impl_data, file, request->offset, request->data, request->data_sz / 2);
+    }
+
+    return VS_CODE_ERR_FILE_WRITE;
+}
+
+/******************************************************************************/
+static vs_status_e
+_fault_complete(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_request_t *request) {
+    vs_storage_fault_injection_t *fault = (vs_storage_fault_injection_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(fault, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return fault->backend.impl_func.complete(fault->backend.impl_data, request);
+}
+
+/******************************************************************************/
+vs_status_e
+vs_storage_fault_injection_init(vs_storage_op_ctx_t *storage_ctx,
+                                const vs_storage_op_ctx_t *backend,
+                                const vs_storage_fault_config_t *config) {
+    vs_storage_fault_injection_t *fault;
+
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(backend, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(backend->impl_func.open && backend->impl_func.close && backend->impl_func.load &&
+                      backend->impl_func.save && backend->impl_func.sync && backend->impl_func.size &&
+                      backend->impl_func.del,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Backend storage implementation is incomplete");
+
+    fault = VS_IOT_CALLOC(1, sizeof(vs_storage_fault_injection_t));
+    CHECK_RET(fault, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage fault injection");
+
+    if (0 != pthread_mutex_init(&fault->lock, NULL)) {
+        VS_IOT_FREE(fault);
+        VS_LOG_ERROR("Cannot initialize storage fault injection mutex");
+        return VS_CODE_ERR_INCORRECT_ARGUMENT;
+    }
+
+    VS_IOT_MEMCPY(&fault->backend, backend, sizeof(vs_storage_op_ctx_t));
+    _configure(fault, config);
+
+    VS_IOT_MEMSET(storage_ctx, 0, sizeof(vs_storage_op_ctx_t));
+    storage_ctx->impl_func.deinit = _fault_deinit;
+    storage_ctx->impl_func.open = _fault_open;
+    storage_ctx->impl_func.sync = _fault_sync;
+    storage_ctx->impl_func.close = _fault_close;
+    storage_ctx->impl_func.save = _fault_save;
+    storage_ctx->impl_func.load = _fault_load;
+    storage_ctx->impl_func.size = _fault_size;
+    storage_ctx->impl_func.del = _fault_del;
+    storage_ctx->impl_func.reserve = backend->impl_func.reserve ? _fault_reserve : NULL;
+    storage_ctx->impl_func.load_v = backend->impl_func.load_v ? _fault_load_v : NULL;
+    storage_ctx->impl_func.save_v = backend->impl_func.save_v ? _fault_save_v : NULL;
+    if (backend->impl_func.submit && backend->impl_func.complete) {
+        storage_ctx->impl_func.submit = _fault_submit;
+        storage_ctx->impl_func.complete = _fault_complete;
+    }
+    storage_ctx->impl_data = fault;
+    storage_ctx->file_sz_limit = backend->file_sz_limit;
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+vs_status_e
+vs_storage_fault_injection_configure(const vs_storage_op_ctx_t *storage_ctx, const vs_storage_fault_config_t *config) {
+    vs_storage_fault_injection_t *fault = _fault_from_ctx(storage_ctx);
+
+    CHECK_RET(fault, VS_CODE_ERR_INCORRECT_ARGUMENT, "Storage context is not storage fault injection");
+
+    pthread_mutex_lock(&fault->lock);
+    _configure(fault, config);
+    pthread_mutex_unlock(&fault->lock);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+vs_status_e
+vs_storage_fault_injection_get_stats(const vs_storage_op_ctx_t *storage_ctx, vs_storage_fault_stats_t *stats) {
+    vs_storage_fault_injection_t *fault = _fault_from_ctx(storage_ctx);
+
+    CHECK_RET(fault, VS_CODE_ERR_INCORRECT_ARGUMENT, "Storage context is not storage fault injection");
+    CHECK_NOT_ZERO_RET(stats, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&fault->lock);
+    VS_IOT_MEMCPY(stats, &fault->stats, sizeof(*stats));
+    pthread_mutex_unlock(&fault->lock);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
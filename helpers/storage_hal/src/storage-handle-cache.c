@@ -0,0 +1,523 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+
+#include <stdlib-config.h>
+
+#if STORAGE_HANDLE_CACHE_LOCK
+#include <pthread.h>
+#endif
+
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/storage_hal/storage_handle_cache.h>
+
+// Backend handle of one storage element. Handle pointer is returned to the user as vs_storage_file_t.
+typedef struct {
+    vs_storage_element_id_t id;
+    vs_storage_file_t file;
+    uint32_t refs;
+    uint32_t last_use;
+    bool used;
+    bool stale;
+    bool uncached;
+} vs_storage_handle_cache_entry_t;
+
+typedef struct {
+    vs_storage_op_ctx_t backend;
+    vs_storage_handle_cache_entry_t *entries;
+    size_t entries_cnt;
+    uint32_t tick;
+    vs_storage_handle_cache_stats_t stats;
+#if STORAGE_HANDLE_CACHE_LOCK
+    pthread_mutex_t lock;
+#endif
+} vs_storage_handle_cache_t;
+
+#if STORAGE_HANDLE_CACHE_LOCK
+#define _LOCK(CACHE) pthread_mutex_lock(&(CACHE)->lock)
+#define _UNLOCK(CACHE) pthread_mutex_unlock(&(CACHE)->lock)
+#else
+#define _LOCK(CACHE)
+#define _UNLOCK(CACHE)
+#endif // STORAGE_HANDLE_CACHE_LOCK
+
+static vs_storage_file_t
+_cache_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id);
+
+/******************************************************************************/
+static vs_storage_handle_cache_t *
+_cache_from_ctx(const vs_storage_op_ctx_t *storage_ctx) {
+    if (!storage_ctx || storage_ctx->impl_func.open != _cache_open) {
+        return NULL;
+    }
+    return (vs_storage_handle_cache_t *)storage_ctx->impl_data;
+}
+
+/******************************************************************************/
+static vs_status_e
+_backend_close(vs_storage_handle_cache_t *cache, vs_storage_handle_cache_entry_t *entry) {
+    vs_status_e ret_code = cache->backend.impl_func.close(cache->backend.impl_data, entry->file);
+
+    if (VS_CODE_OK != ret_code) {
+        VS_LOG_ERROR("Cannot close storage element");
+    }
+
+    if (!entry->uncached) {
+        --cache->stats.opened;
+    }
+
+    entry->file = NULL;
+    entry->used = false;
+    entry->stale = false;
+    entry->refs = 0;
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_storage_handle_cache_entry_t *
+_entry_find(vs_storage_handle_cache_t *cache, const vs_storage_element_id_t id) {
+    size_t pos;
+
+    for (pos = 0; pos < cache->entries_cnt; ++pos) {
+        vs_storage_handle_cache_entry_t *entry = &cache->entries[pos];
+        if (entry->used && !entry->stale && 0 == VS_IOT_MEMCMP(entry->id, id, sizeof(vs_storage_element_id_t))) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/******************************************************************************/
+static vs_storage_handle_cache_entry_t *
+_entry_take(vs_storage_handle_cache_t *cache) {
+    vs_storage_handle_cache_entry_t *lru = NULL;
+    size_t pos;
+
+    for (pos = 0; pos < cache->entries_cnt; ++pos) {
+        vs_storage_handle_cache_entry_t *entry = &cache->entries[pos];
+
+        if (!entry->used) {
+            return entry;
+        }
+
+        if (!entry->refs && (!lru || cache->tick - entry->last_use > cache->tick - lru->last_use)) {
+            lru = entry;
+        }
+    }
+
+    if (lru) {
+        ++cache->stats.evictions;
+        _backend_close(cache, lru);
+    }
+
+    return lru;
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    vs_status_e ret_code = VS_CODE_OK;
+    size_t pos;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    for (pos = 0; pos < cache->entries_cnt; ++pos) {
+        if (cache->entries[pos].used) {
+            if (cache->entries[pos].refs) {
+                VS_LOG_WARNING("Storage element is still used during storage deinitialization");
+            }
+            _backend_close(cache, &cache->entries[pos]);
+        }
+    }
+
+    if (cache->backend.impl_func.deinit) {
+        ret_code = cache->backend.impl_func.deinit(cache->backend.impl_data);
+    }
+
+#if STORAGE_HANDLE_CACHE_LOCK
+    pthread_mutex_destroy(&cache->lock);
+#endif
+
+    VS_IOT_FREE(cache->entries);
+    VS_IOT_FREE(cache);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_storage_file_t
+_cache_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    vs_storage_handle_cache_entry_t *entry;
+    vs_storage_file_t file;
+
+    CHECK_NOT_ZERO_RET(cache, NULL);
+    CHECK_NOT_ZERO_RET(id, NULL);
+
+    _LOCK(cache);
+
+    ++cache->tick;
+
+    entry = _entry_find(cache, id);
+    if (entry) {
+        ++cache->stats.hits;
+        ++entry->refs;
+        entry->last_use = cache->tick;
+        _UNLOCK(cache);
+        return entry;
+    }
+
+    ++cache->stats.misses;
+
+    // Evict before backend open to keep amount of opened handles within the limit
+    entry = _entry_take(cache);
+    if (!entry) {
+        entry = VS_IOT_CALLOC(1, sizeof(vs_storage_handle_cache_entry_t));
+        if (!entry) {
+            _UNLOCK(cache);
+            VS_LOG_ERROR("Cannot allocate memory for storage handle");
+            return NULL;
+        }
+        entry->uncached = true;
+    }
+
+    file = cache->backend.impl_func.open(cache->backend.impl_data, id);
+    if (!file) {
+        if (entry->uncached) {
+            VS_IOT_FREE(entry);
+        }
+        _UNLOCK(cache);
+        return NULL;
+    }
+
+    if (entry->uncached) {
+        ++cache->stats.uncached;
+    } else {
+        ++cache->stats.opened;
+    }
+
+    VS_IOT_MEMCPY(entry->id, id, sizeof(vs_storage_element_id_t));
+    entry->file = file;
+    entry->refs = 1;
+    entry->last_use = cache->tick;
+    entry->used = true;
+    entry->stale = false;
+
+    _UNLOCK(cache);
+
+    return entry;
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    const vs_storage_handle_cache_entry_t *entry = (const vs_storage_handle_cache_entry_t *)file;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.sync(cache->backend.impl_data, entry->file);
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    vs_storage_handle_cache_entry_t *entry = (vs_storage_handle_cache_entry_t *)file;
+    vs_status_e ret_code = VS_CODE_OK;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _LOCK(cache);
+
+    if (!entry->used || !entry->refs) {
+        _UNLOCK(cache);
+        VS_LOG_ERROR("Storage element has been already closed");
+        return VS_CODE_ERR_INCORRECT_PARAMETER;
+    }
+
+    if (0 == --entry->refs) {
+        if (entry->uncached) {
+            ret_code = _backend_close(cache, entry);
+            VS_IOT_FREE(entry);
+        } else if (entry->stale) {
+            ret_code = _backend_close(cache, entry);
+        }
+    }
+
+    _UNLOCK(cache);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_save(const vs_storage_impl_data_ctx_t storage_ctx,
+            const vs_storage_file_t file,
+            size_t offset,
+            const uint8_t *data,
+            size_t data_sz) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    const vs_storage_handle_cache_entry_t *entry = (const vs_storage_handle_cache_entry_t *)file;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.save(cache->backend.impl_data, entry->file, offset, data, data_sz);
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_load(const vs_storage_impl_data_ctx_t storage_ctx,
+            const vs_storage_file_t file,
+            size_t offset,
+            uint8_t *out_data,
+            size_t data_sz) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    const vs_storage_handle_cache_entry_t *entry = (const vs_storage_handle_cache_entry_t *)file;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.load(cache->backend.impl_data, entry->file, offset, out_data, data_sz);
+}
+
+/******************************************************************************/
+static ssize_t
+_cache_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.size(cache->backend.impl_data, id);
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    vs_storage_handle_cache_entry_t *entry;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(id, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _LOCK(cache);
+
+    entry = _entry_find(cache, id);
+    if (entry) {
+        if (entry->refs) {
+            entry->stale = true;
+        } else {
+            _backend_close(cache, entry);
+        }
+    }
+
+    ret_code = cache->backend.impl_func.del(cache->backend.impl_data, id);
+
+    _UNLOCK(cache);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_reserve(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id, size_t size) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.reserve(cache->backend.impl_data, id, size);
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_load_v(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              size_t offset,
+              const vs_storage_buf_t *bufs,
+              size_t bufs_cnt) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    const vs_storage_handle_cache_entry_t *entry = (const vs_storage_handle_cache_entry_t *)file;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.load_v(cache->backend.impl_data, entry->file, offset, bufs, bufs_cnt);
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_save_v(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              size_t offset,
+              const vs_storage_buf_t *bufs,
+              size_t bufs_cnt) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    const vs_storage_handle_cache_entry_t *entry = (const vs_storage_handle_cache_entry_t *)file;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.save_v(cache->backend.impl_data, entry->file, offset, bufs, bufs_cnt);
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_submit(const vs_storage_impl_data_ctx_t storage_ctx,
+              const vs_storage_file_t file,
+              vs_storage_request_t *request) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+    const vs_storage_handle_cache_entry_t *entry = (const vs_storage_handle_cache_entry_t *)file;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(entry, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.submit(cache->backend.impl_data, entry->file, request);
+}
+
+/******************************************************************************/
+static vs_status_e
+_cache_complete(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_request_t *request) {
+    vs_storage_handle_cache_t *cache = (vs_storage_handle_cache_t *)storage_ctx;
+
+    CHECK_NOT_ZERO_RET(cache, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return cache->backend.impl_func.complete(cache->backend.impl_data, request);
+}
+
+/******************************************************************************/
+vs_status_e
+vs_storage_handle_cache_init(vs_storage_op_ctx_t *storage_ctx, const vs_storage_op_ctx_t *backend, size_t max_open) {
+    vs_storage_handle_cache_t *cache;
+
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(backend, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(max_open, VS_CODE_ERR_INCORRECT_ARGUMENT);
+    CHECK_RET(backend->impl_func.open && backend->impl_func.close && backend->impl_func.load &&
+                      backend->impl_func.save && backend->impl_func.sync && backend->impl_func.size &&
+                      backend->impl_func.del,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Backend storage implementation is incomplete");
+
+    cache = VS_IOT_CALLOC(1, sizeof(vs_storage_handle_cache_t));
+    CHECK_RET(cache, VS_CODE_ERR_NO_MEMORY, "Cannot allocate memory for storage handles cache");
+
+    cache->entries = VS_IOT_CALLOC(max_open, sizeof(vs_storage_handle_cache_entry_t));
+    if (!cache->entries) {
+        VS_IOT_FREE(cache);
+        VS_LOG_ERROR("Cannot allocate memory for storage handles cache");
+        return VS_CODE_ERR_NO_MEMORY;
+    }
+
+#if STORAGE_HANDLE_CACHE_LOCK
+    if (0 != pthread_mutex_init(&cache->lock, NULL)) {
+        VS_IOT_FREE(cache->entries);
+        VS_IOT_FREE(cache);
+        VS_LOG_ERROR("Cannot initialize storage handles cache mutex");
+        return VS_CODE_ERR_INCORRECT_ARGUMENT;
+    }
+#endif
+
+    VS_IOT_MEMCPY(&cache->backend, backend, sizeof(vs_storage_op_ctx_t));
+    cache->entries_cnt = max_open;
+
+    VS_IOT_MEMSET(storage_ctx, 0, sizeof(vs_storage_op_ctx_t));
+    storage_ctx->impl_func.deinit = _cache_deinit;
+    storage_ctx->impl_func.open = _cache_open;
+    storage_ctx->impl_func.sync = _cache_sync;
+    storage_ctx->impl_func.close = _cache_close;
+    storage_ctx->impl_func.save = _cache_save;
+    storage_ctx->impl_func.load = _cache_load;
+    storage_ctx->impl_func.size = _cache_size;
+    storage_ctx->impl_func.del = _cache_del;
+    storage_ctx->impl_func.reserve = backend->impl_func.reserve ? _cache_reserve : NULL;
+    storage_ctx->impl_func.load_v = backend->impl_func.load_v ? _cache_load_v : NULL;
+    storage_ctx->impl_func.save_v = backend->impl_func.save_v ? _cache_save_v : NULL;
+    if (backend->impl_func.submit && backend->impl_func.complete) {
+        storage_ctx->impl_func.submit = _cache_submit;
+        storage_ctx->impl_func.complete = _cache_complete;
+    }
+    storage_ctx->impl_data = cache;
+    storage_ctx->file_sz_limit = backend->file_sz_limit;
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+vs_status_e
+vs_storage_handle_cache_flush(const vs_storage_op_ctx_t *storage_ctx) {
+    vs_storage_handle_cache_t *cache = _cache_from_ctx(storage_ctx);
+    vs_status_e ret_code = VS_CODE_OK;
+    size_t pos;
+
+    CHECK_RET(cache, VS_CODE_ERR_INCORRECT_ARGUMENT, "Storage context is not storage handles cache");
+
+    _LOCK(cache);
+
+    for (pos = 0; pos < cache->entries_cnt; ++pos) {
+        if (cache->entries[pos].used && !cache->entries[pos].refs) {
+            if (VS_CODE_OK != _backend_close(cache, &cache->entries[pos])) {
+                ret_code = VS_CODE_ERR_FILE_WRITE;
+            }
+        }
+    }
+
+    _UNLOCK(cache);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+vs_status_e
+vs_storage_handle_cache_get_stats(const vs_storage_op_ctx_t *storage_ctx, vs_storage_handle_cache_stats_t *stats) {
+    vs_storage_handle_cache_t *cache = _cache_from_ctx(storage_ctx);
+
+    CHECK_RET(cache, VS_CODE_ERR_INCORRECT_ARGUMENT, "Storage context is not storage handles cache");
+    CHECK_NOT_ZERO_RET(stats, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _LOCK(cache);
+    VS_IOT_MEMCPY(stats, &cache->stats, sizeof(*stats));
+    _UNLOCK(cache);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
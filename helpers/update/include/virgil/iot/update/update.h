@@ -63,6 +63,9 @@ extern "C" {
 enum vs_update_file_type_id_t {
     VS_UPDATE_FIRMWARE, /**< Firmware files for different manufactures and device types */
     VS_UPDATE_TRUST_LIST, /**< Trust List files */
+    VS_UPDATE_FIRMWARE_DELTA, /**< Firmware delta files, see firmware_delta.h */
+    VS_UPDATE_FIRMWARE_COMPRESSED, /**< Compressed firmware files, see firmware_compression.h */
+    VS_UPDATE_FIRMWARE_CHUNKED, /**< Firmware files with signed chunk hashes, see firmware_chunk_hashes.h */
     VS_UPDATE_USER_FILES = 256 /**< User file types must have an identifier that is not lower than this code */
 };
 
@@ -280,6 +283,45 @@ typedef vs_status_e (*vs_update_verify_object_cb_t)(void *context, vs_update_fil
  */
 typedef void (*vs_update_free_item_cb_t)(void *context, vs_update_file_type_t *file_type);
 
+/** File has been requested
+ *
+ * FLDT server calls it for each file header request. This callback is optional.
+ *
+ * \param[in] context File context.
+ * \param[in] file_type Requested file type.  Cannot be NULL.
+ */
+typedef void (*vs_update_file_requested_cb_t)(void *context, const vs_update_file_type_t *file_type);
+
+/** Get file data size available for reading
+ *
+ * FLDT server calls it to distribute file that is still being received. This callback is optional, file is
+ * considered as completely stored if it is NULL.
+ *
+ * \param[in] context File context.
+ * \param[in] file_type Current file type.  Cannot be NULL.
+ * \param[out] available_size Size of stored data from the file beginning. It is used if \a is_complete is false.
+ * Cannot be NULL.
+ * \param[out] is_complete True if the whole file including footer has been stored. Cannot be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+typedef vs_status_e (*vs_update_get_available_size_cb_t)(void *context,
+                                                         vs_update_file_type_t *file_type,
+                                                         uint32_t *available_size,
+                                                         bool *is_complete);
+
+/** Periodical processing
+ *
+ * FLDT client calls it from SNAP periodical processing while file is being received. Implementation can finish
+ * delayed operations, e.g. write buffered data of stalled download.
+ *
+ * \param[in] context File context.
+ * \param[in] file_type Current file type.  Cannot be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+typedef vs_status_e (*vs_update_periodical_cb_t)(void *context, vs_update_file_type_t *file_type);
+
 /** Update interface context */
 typedef struct __attribute__((__packed__)) vs_update_interface_t {
     vs_update_get_header_size_cb_t    get_header_size; /**< Get header */
@@ -298,6 +340,9 @@ typedef struct __attribute__((__packed__)) vs_update_interface_t {
     vs_update_delete_object_cb_t        delete_object; /**< Delete item */
     vs_update_verify_object_cb_t        verify_object; /**< Verify item */
     vs_update_free_item_cb_t          free_item; /**< Free item */
+    vs_update_file_requested_cb_t     file_requested; /**< File has been requested. Can be NULL */
+    vs_update_get_available_size_cb_t get_available_size; /**< Get available data size. Can be NULL */
+    vs_update_periodical_cb_t         periodical; /**< Periodical task while file is being received. Can be NULL */
 
     vs_storage_op_ctx_t *storage_context; /**< Storage context */
 
@@ -90,6 +90,39 @@ vs_update_file_type_str(const vs_update_file_type_t *file_type, char *opt_buf, s
     }
     break;
 
+    case VS_UPDATE_FIRMWARE_DELTA:
+        res = VS_IOT_SNPRINTF(buf,
+                              sz,
+                              "Firmware delta (\"%s\", \"%c%c%c%c\")",
+                              manufacture_id,
+                              (char)file_type->info.device_type[0],
+                              (char)file_type->info.device_type[1],
+                              (char)file_type->info.device_type[2],
+                              (char)file_type->info.device_type[3]);
+        break;
+
+    case VS_UPDATE_FIRMWARE_COMPRESSED:
+        res = VS_IOT_SNPRINTF(buf,
+                              sz,
+                              "Compressed firmware (\"%s\", \"%c%c%c%c\")",
+                              manufacture_id,
+                              (char)file_type->info.device_type[0],
+                              (char)file_type->info.device_type[1],
+                              (char)file_type->info.device_type[2],
+                              (char)file_type->info.device_type[3]);
+        break;
+
+    case VS_UPDATE_FIRMWARE_CHUNKED:
+        res = VS_IOT_SNPRINTF(buf,
+                              sz,
+                              "Chunked firmware (\"%s\", \"%c%c%c%c\")",
+                              manufacture_id,
+                              (char)file_type->info.device_type[0],
+                              (char)file_type->info.device_type[1],
+                              (char)file_type->info.device_type[2],
+                              (char)file_type->info.device_type[3]);
+        break;
+
     case VS_UPDATE_TRUST_LIST:
         res = VS_IOT_SNPRINTF(buf,
                               sz,"Trust List");
@@ -44,6 +44,8 @@
 
 #if FLDT_SERVER || FLDT_CLIENT
 #include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_delta.h>
+#include <virgil/iot/firmware/firmware_compression.h>
 #endif // FLDT_SERVER || FLDT_CLIENT
 
 #if FLDT_SERVER
@@ -158,6 +160,15 @@ vs_high_level_init(vs_device_manufacture_id_t manufacture_id,
                  "Unable to add firmware file type");
     STATUS_CHECK(vs_fldt_client_add_file_type(vs_tl_update_file_type(), vs_tl_update_ctx()),
                  "Unable to add firmware file type");
+#if FIRMWARE_DELTA
+    STATUS_CHECK(vs_fldt_client_add_file_type(vs_firmware_delta_update_file_type(), vs_firmware_delta_update_ctx()),
+                 "Unable to add firmware delta file type");
+#endif // FIRMWARE_DELTA
+#if FIRMWARE_COMPRESSION
+    STATUS_CHECK(vs_fldt_client_add_file_type(vs_firmware_compressed_update_file_type(),
+                                              vs_firmware_compressed_update_ctx()),
+                 "Unable to add compressed firmware file type");
+#endif // FIRMWARE_COMPRESSION
 #endif // FLDT_CLIENT
 
     res = VS_CODE_OK;
@@ -178,6 +189,16 @@ _add_filetype(const vs_update_file_type_t *file_type, vs_update_interface_t **up
     case VS_UPDATE_TRUST_LIST:
         *update_ctx = vs_tl_update_ctx();
         break;
+#if FIRMWARE_DELTA
+    case VS_UPDATE_FIRMWARE_DELTA:
+        *update_ctx = vs_firmware_delta_update_ctx();
+        break;
+#endif // FIRMWARE_DELTA
+#if FIRMWARE_COMPRESSION
+    case VS_UPDATE_FIRMWARE_COMPRESSED:
+        *update_ctx = vs_firmware_compressed_update_ctx();
+        break;
+#endif // FIRMWARE_COMPRESSION
     default:
         VS_LOG_ERROR("Unsupported file type : %d", file_type->type);
         return VS_CODE_ERR_UNSUPPORTED_PARAMETER;
@@ -207,6 +228,10 @@ _on_file_updated(vs_update_file_type_t *file_type,
 
     if (VS_UPDATE_FIRMWARE == file_type->type) {
         file_type_descr = "firmware";
+    } else if (VS_UPDATE_FIRMWARE_DELTA == file_type->type) {
+        file_type_descr = "firmware delta";
+    } else if (VS_UPDATE_FIRMWARE_COMPRESSED == file_type->type) {
+        file_type_descr = "compressed firmware";
     } else {
         file_type_descr = "trust list";
     }
@@ -220,7 +245,9 @@ _on_file_updated(vs_update_file_type_t *file_type,
                 (unsigned long long)new_file_ver->build);
 
 
-    if (file_type->type == VS_UPDATE_FIRMWARE && successfully_updated) {
+    if ((file_type->type == VS_UPDATE_FIRMWARE || file_type->type == VS_UPDATE_FIRMWARE_DELTA ||
+         file_type->type == VS_UPDATE_FIRMWARE_COMPRESSED) &&
+        successfully_updated) {
         if (_iotkit_events.reboot_request_cb) {
             _iotkit_events.reboot_request_cb();
         }
@@ -32,6 +32,8 @@
 //
 //  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
 
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 
 extern "C" bool
@@ -45,3 +47,9 @@ extern "C" void
 vs_impl_msleep(size_t msec) {
     (void)msec;
 }
+
+extern "C" uint32_t
+vs_impl_msec(void) {
+    using namespace std::chrono;
+    return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
@@ -52,6 +52,7 @@ VSQSnapInfoClient::VSQSnapInfoClient() {
     m_snapInfoImpl.device_start = startNotify;
     m_snapInfoImpl.general_info = generalInfo;
     m_snapInfoImpl.statistics = statistics;
+    m_snapInfoImpl.fldt_statistics = nullptr;
 
     m_snapService = vs_snap_info_client(m_snapInfoImpl);
 
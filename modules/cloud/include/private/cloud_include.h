@@ -46,6 +46,11 @@
 #include <virgil/iot/trust_list/trust_list.h>
 #include <virgil/iot/trust_list/tl_structs.h>
 #include <virgil/iot/firmware/firmware_hal.h>
+#include <virgil/iot/firmware/firmware_compression.h>
+#include <virgil/iot/firmware/firmware_chunk_hashes.h>
+#include <virgil/iot/firmware/firmware_cache.h>
+#include <virgil/iot/firmware/firmware_dedup.h>
+#include <virgil/iot/firmware/firmware_relay.h>
 #include <virgil/iot/secmodule/secmodule-helpers.h>
 #include <virgil/iot/json/json_parser.h>
 
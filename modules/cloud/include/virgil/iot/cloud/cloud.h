@@ -140,6 +140,15 @@ tl_topic_process(const uint8_t *url, uint16_t length) {
      }
  }
 
+void
+tl_delta_topic_process(const uint8_t *delta_url, const uint8_t *url) {
+
+     // Delta is applicable to the previous Trust List version only, so the whole Trust List is fetched otherwise
+     if (VS_CODE_OK == vs_cloud_fetch_and_apply_tl_delta(delta_url) || VS_CODE_OK == vs_cloud_fetch_and_store_tl(url)) {
+         // Trust list is correct. Process it
+     }
+ }
+
  * \endcode
  *
  */
@@ -220,6 +229,26 @@ typedef struct {
 vs_status_e
 vs_cloud_fetch_and_store_fw_file(const char *fw_file_url, vs_firmware_header_t *fetched_header);
 
+#if FIRMWARE_CUT_THROUGH
+/** Firmware relay has been started
+ *
+ * Callback for #vs_cloud_set_fw_relay_cb function. It is called by #vs_cloud_fetch_and_store_fw_file() after
+ * firmware descriptor has been stored and before firmware data downloading. Gateway can announce new firmware by
+ * #vs_fldt_server_add_file_type() call here, FLDT server distributes data as soon as it is received.
+ * See firmware_relay.h for details.
+ *
+ * \param[in] descriptor Firmware descriptor. Cannot be NULL.
+ */
+typedef void (*vs_cloud_fw_relay_cb_t)(const vs_firmware_descriptor_t *descriptor);
+
+/** Set firmware relay callback
+ *
+ * \param[in] relay_cb Callback. NULL disables firmware relay.
+ */
+void
+vs_cloud_set_fw_relay_cb(vs_cloud_fw_relay_cb_t relay_cb);
+#endif // FIRMWARE_CUT_THROUGH
+
 /** Fetch and store Trust List
  *
  * Fetches Trust List and stores it in internal storage.
@@ -231,6 +260,19 @@ vs_cloud_fetch_and_store_fw_file(const char *fw_file_url, vs_firmware_header_t *
 vs_status_e
 vs_cloud_fetch_and_store_tl(const char *tl_file_url);
 
+/** Fetch and apply Trust List delta
+ *
+ * Fetches Trust List delta and applies it to the current Trust List by #vs_tl_apply_delta. Delta is made for the
+ * specified Trust List version, so caller fetches the whole Trust List by #vs_cloud_fetch_and_store_tl if this call
+ * fails. Delta size is limited by VS_TL_STORAGE_SIZE.
+ *
+ * \param[in] tl_delta_url Trust List delta URL to fetch. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_cloud_fetch_and_apply_tl_delta(const char *tl_delta_url);
+
 /** List of available topics
  *
  * This structure contains list of topics to be subscribed.
@@ -48,6 +48,9 @@
 
 static const vs_cloud_impl_t *_hal_impl = NULL;
 static vs_secmodule_impl_t *_secmodule = NULL;
+#if FIRMWARE_CUT_THROUGH
+static vs_cloud_fw_relay_cb_t _fw_relay_cb = NULL;
+#endif // FIRMWARE_CUT_THROUGH
 
 /******************************************************************************/
 static bool
@@ -312,14 +315,26 @@ vs_cloud_fetch_message_bin_credentials(const char *cloud_host, char *out_answer,
     return _get_credentials(cloud_host, VS_THING_EP, VS_MQTT_ID, out_answer, in_out_answer_len);
 }
 
+#if FIRMWARE_CUT_THROUGH
+/******************************************************************************/
+void
+vs_cloud_set_fw_relay_cb(vs_cloud_fw_relay_cb_t relay_cb) {
+    _fw_relay_cb = relay_cb;
+}
+#endif // FIRMWARE_CUT_THROUGH
+
 #define VS_CLOUD_FETCH_FW_STEP_HEADER 0
-#define VS_CLOUD_FETCH_FW_STEP_CHUNKS 1
-#define VS_CLOUD_FETCH_FW_STEP_FOOTER 2
-#define VS_CLOUD_FETCH_FW_STEP_DONE 3
+#define VS_CLOUD_FETCH_FW_STEP_HASHES 1
+#define VS_CLOUD_FETCH_FW_STEP_CHUNKS 2
+#define VS_CLOUD_FETCH_FW_STEP_FOOTER 3
+#define VS_CLOUD_FETCH_FW_STEP_DONE 4
 
 typedef struct {
     uint8_t step;
     bool is_descriptor_stored;
+#if FIRMWARE_CUT_THROUGH
+    bool is_relayed;
+#endif // FIRMWARE_CUT_THROUGH
     vs_firmware_header_t header;
     uint32_t file_offset;
     uint16_t chunks_qty;
@@ -328,22 +343,125 @@ typedef struct {
     uint32_t buff_sz;
     size_t footer_sz;
     size_t used_size;
+#if FIRMWARE_COMPRESSION
+    bool is_compressed;
+    vs_firmware_compressed_header_t compressed_header;
+    vs_firmware_compressed_ctx_t decompress_ctx;
+#endif // FIRMWARE_COMPRESSION
+#if FIRMWARE_CHUNK_HASHES
+    bool has_hashes;
+    vs_firmware_chunks_ctx_t chunks_ctx;
+#endif // FIRMWARE_CHUNK_HASHES
 } fw_resp_buff_t;
 
 /*************************************************************************/
 static bool
 _check_firmware_header(vs_firmware_header_t *header) {
-    return header->descriptor.firmware_length == header->code_length &&
-           header->code_offset == sizeof(vs_firmware_header_t) && header->footer_offset >= header->code_length &&
+    bool code_length_ok = header->descriptor.firmware_length == header->code_length;
+    bool code_offset_ok = header->code_offset == sizeof(vs_firmware_header_t);
+
+#if FIRMWARE_COMPRESSION
+    // Compressed code has its own size
+    code_length_ok = code_length_ok || header->code_length > VS_FIRMWARE_LZ_HEADER_SIZE;
+#endif // FIRMWARE_COMPRESSION
+
+#if FIRMWARE_CHUNK_HASHES
+    // Chunk hashes table is placed between header and code
+    code_offset_ok = code_offset_ok || header->code_offset > sizeof(vs_firmware_header_t);
+#endif // FIRMWARE_CHUNK_HASHES
+
+    return code_length_ok && code_offset_ok && header->footer_offset >= header->code_length &&
            header->footer_offset + header->footer_length < VS_MAX_FIRMWARE_UPDATE_SIZE;
 }
 
+#if FIRMWARE_COMPRESSION
+/*************************************************************************/
+static vs_status_e
+_start_fw_decompression(fw_resp_buff_t *resp) {
+    vs_status_e ret_code;
+
+    resp->is_compressed = resp->header.descriptor.firmware_length != resp->header.code_length;
+    if (!resp->is_compressed) {
+        return VS_CODE_OK;
+    }
+
+    VS_IOT_MEMCPY(&resp->compressed_header.descriptor, &resp->header.descriptor, sizeof(vs_firmware_descriptor_t));
+    resp->compressed_header.compressed_length = resp->header.code_length;
+
+    // Compressed stream is kept to be served by FLDT
+    STATUS_CHECK_RET(vs_firmware_compressed_save_header(&resp->compressed_header),
+                     "Unable to save compressed firmware header");
+
+    return vs_firmware_compressed_apply_init(
+            &resp->decompress_ctx, &resp->header.descriptor, resp->header.code_length);
+}
+#endif // FIRMWARE_COMPRESSION
+
+#if FIRMWARE_CHUNK_HASHES
+/*************************************************************************/
+static vs_status_e
+_start_fw_hashes(fw_resp_buff_t *resp) {
+    vs_firmware_chunked_header_t chunked_header;
+
+    VS_IOT_MEMCPY(&chunked_header.descriptor, &resp->header.descriptor, sizeof(vs_firmware_descriptor_t));
+    chunked_header.hashes_length = resp->header.code_offset - sizeof(vs_firmware_header_t);
+    resp->has_hashes = true;
+
+    return vs_firmware_chunks_init(&resp->chunks_ctx, &chunked_header);
+}
+#endif // FIRMWARE_CHUNK_HASHES
+
+/*************************************************************************/
+static vs_status_e
+_save_fw_code_chunk(fw_resp_buff_t *resp, uint32_t chunk_sz) {
+#if FIRMWARE_COMPRESSION
+    vs_status_e ret_code;
+
+    if (resp->is_compressed) {
+        STATUS_CHECK_RET(vs_firmware_compressed_save_chunk(
+                                 &resp->compressed_header, resp->buff, chunk_sz, resp->file_offset),
+                         "Unable to save compressed firmware chunk");
+
+        return vs_firmware_compressed_apply_data(&resp->decompress_ctx, resp->buff, chunk_sz);
+    }
+#endif // FIRMWARE_COMPRESSION
+
+#if FIRMWARE_CHUNK_HASHES
+    // Damaged chunk stops downloading immediately
+    if (resp->has_hashes) {
+        return vs_firmware_chunks_save_chunk(&resp->chunks_ctx, resp->file_offset, resp->buff, chunk_sz);
+    }
+#endif // FIRMWARE_CHUNK_HASHES
+
+    return vs_firmware_save_firmware_chunk(&resp->header.descriptor, resp->buff, chunk_sz, resp->file_offset);
+}
+
+/*************************************************************************/
+static vs_status_e
+_save_fw_footer(fw_resp_buff_t *resp) {
+#if FIRMWARE_COMPRESSION
+    vs_status_e ret_code;
+
+    if (resp->is_compressed) {
+        STATUS_CHECK_RET(vs_firmware_compressed_save_footer(
+                                 &resp->compressed_header, resp->buff, resp->header.footer_length),
+                         "Unable to save compressed firmware footer");
+
+        return vs_firmware_compressed_apply_finish(&resp->decompress_ctx, resp->buff);
+    }
+#endif // FIRMWARE_COMPRESSION
+
+    return vs_firmware_save_firmware_footer(&resp->header.descriptor, resp->buff);
+}
+
 /*************************************************************************/
 static size_t
 _store_fw_handler(const char *contents, size_t chunksize, void *userdata) {
     fw_resp_buff_t *resp = (fw_resp_buff_t *)userdata;
     size_t rest_data_sz = chunksize;
+#if !FIRMWARE_CACHE
     vs_firmware_descriptor_t old_desc;
+#endif // !FIRMWARE_CACHE
 
     if (NULL == resp->buff) {
         return 0;
@@ -370,18 +488,31 @@ _store_fw_handler(const char *contents, size_t chunksize, void *userdata) {
                 return 0;
             }
 
+#if FIRMWARE_CACHE
+            // Keep old version for rollback and free room for new one
+            if (VS_CODE_OK != vs_firmware_cache_reserve(&resp->header.descriptor)) {
+                return 0;
+            }
+#else
             // Remove old version from fw storage
             if (VS_CODE_OK == vs_firmware_load_firmware_descriptor(resp->header.descriptor.info.manufacture_id,
                                                                    resp->header.descriptor.info.device_type,
                                                                    &old_desc)) {
                 vs_firmware_delete_firmware(&old_desc);
             }
+#endif // FIRMWARE_CACHE
 
             if (VS_CODE_OK != vs_firmware_save_firmware_descriptor(&resp->header.descriptor)) {
                 return 0;
             }
             resp->is_descriptor_stored = true;
 
+#if FIRMWARE_COMPRESSION
+            if (VS_CODE_OK != _start_fw_decompression(resp)) {
+                return 0;
+            }
+#endif // FIRMWARE_COMPRESSION
+
             resp->chunks_qty = resp->header.code_length / resp->header.descriptor.chunk_size;
             if (resp->header.code_length % resp->header.descriptor.chunk_size) {
                 resp->chunks_qty++;
@@ -394,6 +525,23 @@ _store_fw_handler(const char *contents, size_t chunksize, void *userdata) {
             }
 
             resp->step = VS_CLOUD_FETCH_FW_STEP_CHUNKS;
+
+#if FIRMWARE_CHUNK_HASHES
+            if (resp->header.code_offset > sizeof(vs_firmware_header_t)) {
+                if (VS_CODE_OK != _start_fw_hashes(resp)) {
+                    return 0;
+                }
+                resp->step = VS_CLOUD_FETCH_FW_STEP_HASHES;
+            }
+#endif // FIRMWARE_CHUNK_HASHES
+
+#if FIRMWARE_CUT_THROUGH
+            // Firmware data is distributed while it is being downloaded
+            if (_fw_relay_cb && VS_CODE_OK == vs_firmware_relay_start(&resp->header.descriptor)) {
+                resp->is_relayed = true;
+                _fw_relay_cb(&resp->header.descriptor);
+            }
+#endif // FIRMWARE_CUT_THROUGH
         }
 
         if (read_sz == chunksize) {
@@ -404,6 +552,33 @@ _store_fw_handler(const char *contents, size_t chunksize, void *userdata) {
         rest_data_sz = chunksize - read_sz;
         resp->used_size = 0;
     }
+    case VS_CLOUD_FETCH_FW_STEP_HASHES:
+#if FIRMWARE_CHUNK_HASHES
+        if (VS_CLOUD_FETCH_FW_STEP_HASHES == resp->step) {
+            uint32_t hashes_rest = resp->chunks_ctx.header.hashes_length - resp->chunks_ctx.hashes_offset;
+            size_t read_sz = rest_data_sz > hashes_rest ? hashes_rest : rest_data_sz;
+
+            // Table is verified by its last part, so forged firmware is rejected before code downloading
+            if (VS_CODE_OK != vs_firmware_chunks_save_hashes(&resp->chunks_ctx,
+                                                             resp->chunks_ctx.hashes_offset,
+                                                             (const uint8_t *)contents,
+                                                             read_sz)) {
+                return 0;
+            }
+
+            contents += read_sz;
+            rest_data_sz -= read_sz;
+
+            if (resp->chunks_ctx.hashes_verified) {
+                resp->step = VS_CLOUD_FETCH_FW_STEP_CHUNKS;
+            }
+        }
+
+        if (!rest_data_sz) {
+            break;
+        }
+#endif // FIRMWARE_CHUNK_HASHES
+
     case VS_CLOUD_FETCH_FW_STEP_CHUNKS:
         while (rest_data_sz && VS_CLOUD_FETCH_FW_STEP_CHUNKS == resp->step) {
             size_t read_sz = rest_data_sz;
@@ -424,9 +599,7 @@ _store_fw_handler(const char *contents, size_t chunksize, void *userdata) {
 
             if (resp->used_size == required_chunk_size) {
                 resp->used_size = 0;
-                if (VS_CODE_OK !=
-                    vs_firmware_save_firmware_chunk(
-                            &resp->header.descriptor, resp->buff, required_chunk_size, resp->file_offset)) {
+                if (VS_CODE_OK != _save_fw_code_chunk(resp, required_chunk_size)) {
                     return 0;
                 }
 
@@ -470,7 +643,7 @@ _store_fw_handler(const char *contents, size_t chunksize, void *userdata) {
                 return VS_CODE_ERR_INCORRECT_ARGUMENT;
             }
 
-            if (VS_CODE_OK != vs_firmware_save_firmware_footer(&resp->header.descriptor, resp->buff)) {
+            if (VS_CODE_OK != _save_fw_footer(resp)) {
                 return 0;
             }
             resp->step = VS_CLOUD_FETCH_FW_STEP_DONE;
@@ -510,10 +683,56 @@ vs_cloud_fetch_and_store_fw_file(const char *fw_file_url, vs_firmware_header_t *
             vs_firmware_delete_firmware(&resp.header.descriptor);
         }
 
+#if FIRMWARE_CUT_THROUGH
+        // Stop relay after data deletion, so FLDT server does not verify partial firmware
+        if (resp.is_relayed) {
+            vs_firmware_relay_stop();
+        }
+#endif // FIRMWARE_CUT_THROUGH
+
+#if FIRMWARE_COMPRESSION
+        if (resp.is_compressed) {
+            vs_firmware_compressed_delete(&resp.compressed_header);
+        }
+#endif // FIRMWARE_COMPRESSION
+
+#if FIRMWARE_CHUNK_HASHES
+        if (resp.has_hashes) {
+            vs_firmware_chunked_delete(&resp.chunks_ctx.header);
+        }
+#endif // FIRMWARE_CHUNK_HASHES
+
     } else {
         VS_IOT_MEMCPY(fetched_header, &resp.header, sizeof(vs_firmware_header_t));
+
+#if FIRMWARE_CUT_THROUGH
+        // Footer has been stored, FLDT server can verify firmware and send footer
+        if (resp.is_relayed) {
+            vs_firmware_relay_stop();
+        }
+#endif // FIRMWARE_CUT_THROUGH
+
+#if FIRMWARE_DEDUP
+        if (VS_CODE_OK != vs_firmware_dedup_firmware(&resp.header.descriptor)) {
+            VS_LOG_WARNING("Unable to deduplicate firmware");
+        }
+#endif // FIRMWARE_DEDUP
+
+#if FIRMWARE_CACHE
+        if (VS_CODE_OK != vs_firmware_cache_commit(&resp.header.descriptor)) {
+            VS_LOG_WARNING("Unable to register firmware in cache");
+        }
+#endif // FIRMWARE_CACHE
     }
 
+#if FIRMWARE_COMPRESSION
+    vs_firmware_compressed_apply_free(&resp.decompress_ctx);
+#endif // FIRMWARE_COMPRESSION
+
+#if FIRMWARE_CHUNK_HASHES
+    vs_firmware_chunks_free(&resp.chunks_ctx);
+#endif // FIRMWARE_CHUNK_HASHES
+
     VS_IOT_FREE(resp.buff);
     return res;
 }
@@ -715,4 +934,79 @@ vs_cloud_fetch_and_store_tl(const char *tl_file_url) {
     return res;
 }
 
+typedef struct {
+    uint8_t *buff;
+    size_t buff_sz;
+    size_t used_size;
+} tl_delta_resp_buff_t;
+
+/*************************************************************************/
+static size_t
+_tl_delta_handler(const char *contents, size_t chunksize, void *userdata) {
+    tl_delta_resp_buff_t *resp = (tl_delta_resp_buff_t *)userdata;
+    uint8_t *buff;
+    size_t new_sz;
+
+    // Delta cannot exceed Trust List storage, so bigger data is rejected
+    if (resp->used_size + chunksize > VS_TL_STORAGE_SIZE) {
+        VS_LOG_ERROR("Trust List delta exceeds %u bytes", (unsigned)VS_TL_STORAGE_SIZE);
+        return 0;
+    }
+
+    if (resp->used_size + chunksize > resp->buff_sz) {
+        new_sz = resp->buff_sz ? resp->buff_sz : VS_TL_STORAGE_MAX_PART_SIZE;
+        while (new_sz < resp->used_size + chunksize) {
+            new_sz *= 2;
+        }
+        if (new_sz > VS_TL_STORAGE_SIZE) {
+            new_sz = VS_TL_STORAGE_SIZE;
+        }
+
+        buff = VS_IOT_CALLOC(new_sz, 1);
+        CHECK_NOT_ZERO_RET(buff, 0);
+        if (resp->buff) {
+            VS_IOT_MEMCPY(buff, resp->buff, resp->used_size);
+            VS_IOT_FREE(resp->buff);
+        }
+        resp->buff = buff;
+        resp->buff_sz = new_sz;
+    }
+
+    VS_IOT_MEMCPY(&resp->buff[resp->used_size], contents, chunksize);
+    resp->used_size += chunksize;
+
+    return chunksize;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_cloud_fetch_and_apply_tl_delta(const char *tl_delta_url) {
+    vs_status_e res;
+    size_t in_out_answer_len = 0;
+    tl_delta_resp_buff_t resp;
+
+    CHECK_NOT_ZERO_RET(tl_delta_url, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_hal_impl, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(_hal_impl->http_request, VS_CODE_ERR_NOINIT);
+
+    VS_IOT_MEMSET(&resp, 0, sizeof(resp));
+
+    if (VS_CODE_OK != _hal_impl->http_request(VS_CLOUD_REQUEST_GET,
+                                              tl_delta_url,
+                                              NULL,
+                                              0,
+                                              NULL,
+                                              _tl_delta_handler,
+                                              &resp,
+                                              &in_out_answer_len) ||
+        !resp.used_size) {
+        res = VS_CODE_ERR_CLOUD;
+    } else {
+        res = vs_tl_apply_delta(resp.buff, resp.used_size);
+    }
+
+    VS_IOT_FREE(resp.buff);
+    return res;
+}
+
 /*************************************************************************/
@@ -0,0 +1,138 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#ifndef HELPERS_FIRMWARE_ENCODED_H
+#define HELPERS_FIRMWARE_ENCODED_H
+
+#if FIRMWARE_DELTA || FIRMWARE_COMPRESSION || FIRMWARE_CHUNK_HASHES
+
+#include <stddef.h>
+
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/storage_hal/storage_hal.h>
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/update/update.h>
+
+// Encoded firmware file is stored as single element : header, payload, optional footer
+typedef struct {
+    vs_storage_element_id_t id;
+    uint32_t header_sz;
+    uint32_t payload_sz;
+} vs_firmware_encoded_file_t;
+
+// Encoded firmware file type for update interface. Headers passed to callbacks are in host byte order.
+typedef struct {
+    uint16_t file_type;       // vs_update_file_type_id_t
+    const char *name;         // Name for log messages
+    uint32_t header_sz;       // Header size
+    size_t descriptor_offset; // Offset of target firmware descriptor inside header
+
+    void (*ntoh_header)(void *header);
+    void (*hton_header)(void *header);
+
+    // FLDT file data size
+    uint32_t (*data_size)(const void *header);
+
+    // Stored file
+    vs_status_e (*load_header)(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                               const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                               void *header);
+    vs_status_e (*load_data)(const void *header, uint32_t offset, uint8_t *data, size_t buf_sz, size_t *data_sz);
+    vs_status_e (*load_footer)(const void *header, uint8_t *data, size_t buf_sz, size_t *data_sz);
+    vs_status_e (*delete_file)(const void *header);
+
+    // Header reported if there is no stored file. Optional.
+    vs_status_e (*current_header)(const vs_update_file_type_t *file_type, void *header);
+
+    // Receiving. check_header is optional.
+    vs_status_e (*check_header)(const void *header);
+    vs_status_e (*start)(const void *header);
+    vs_status_e (*save_data)(const uint8_t *data, uint32_t data_sz, uint32_t offset);
+    vs_status_e (*finish)(const uint8_t *footer);
+    void (*stop)(void);
+
+    // Stored file verification. Firmware signatures are checked if it is NULL.
+    vs_status_e (*verify)(const void *header);
+} vs_firmware_encoded_type_t;
+
+void
+vs_firmware_encoded_file_init(vs_firmware_encoded_file_t *file,
+                              const char *suffix,
+                              const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                              const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                              uint32_t header_sz,
+                              uint32_t payload_sz);
+
+vs_status_e
+vs_firmware_encoded_save_header(const vs_firmware_encoded_file_t *file, const void *net_header);
+
+vs_status_e
+vs_firmware_encoded_save_data(const vs_firmware_encoded_file_t *file,
+                              bool need_sync,
+                              uint32_t offset,
+                              const void *data,
+                              size_t data_sz);
+
+vs_status_e
+vs_firmware_encoded_save_footer(const vs_firmware_encoded_file_t *file, const uint8_t *footer, size_t footer_sz);
+
+vs_status_e
+vs_firmware_encoded_load_header(const vs_firmware_encoded_file_t *file, void *net_header);
+
+vs_status_e
+vs_firmware_encoded_load_data(const vs_firmware_encoded_file_t *file,
+                              uint32_t offset,
+                              uint8_t *data,
+                              size_t buf_sz,
+                              size_t *data_sz);
+
+vs_status_e
+vs_firmware_encoded_load_footer(const vs_firmware_encoded_file_t *file, uint8_t *data, size_t buf_sz, size_t *data_sz);
+
+vs_status_e
+vs_firmware_encoded_delete(const vs_firmware_encoded_file_t *file);
+
+vs_status_e
+vs_firmware_encoded_update_init(vs_update_interface_t *update_ctx,
+                                const vs_firmware_encoded_type_t *type,
+                                vs_storage_op_ctx_t *storage_ctx,
+                                vs_device_manufacture_id_t manufacture,
+                                vs_device_type_t device_type);
+
+const vs_update_file_type_t *
+vs_firmware_encoded_update_file_type(uint16_t file_type);
+
+#endif // FIRMWARE_DELTA || FIRMWARE_COMPRESSION || FIRMWARE_CHUNK_HASHES
+
+#endif // HELPERS_FIRMWARE_ENCODED_H
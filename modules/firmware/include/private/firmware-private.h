@@ -38,10 +38,95 @@
 
 #include <virgil/iot/status_code/status_code.h>
 #include <virgil/iot/storage_hal/storage_hal.h>
+#include <virgil/iot/secmodule/secmodule.h>
 
 vs_status_e
 vs_update_firmware_init(vs_storage_op_ctx_t *storage_ctx,
                         vs_device_manufacture_id_t manufacture,
                         vs_device_type_t device_type);
 
+vs_status_e
+vs_firmware_read_data(vs_storage_element_id_t id, uint32_t offset, uint8_t *data, ssize_t buff_sz, size_t *data_sz);
+
+vs_status_e
+vs_firmware_write_data(vs_storage_element_id_t id, bool need_sync, uint32_t offset, const void *data, size_t data_sz);
+
+vs_storage_op_ctx_t *
+vs_firmware_storage_ctx(void);
+
+vs_secmodule_impl_t *
+vs_firmware_secmodule(void);
+
+ssize_t
+vs_firmware_data_size(vs_storage_element_id_t id);
+
+vs_status_e
+vs_firmware_delete_data(vs_storage_element_id_t id);
+
+vs_status_e
+vs_firmware_check_footer_size(const uint8_t *footer, size_t footer_sz);
+
+vs_status_e
+vs_firmware_verify_hash_signatures(const uint8_t *hash,
+                                   const uint8_t *signatures,
+                                   uint8_t signatures_count,
+                                   size_t signatures_sz);
+
+#if FIRMWARE_DELTA
+vs_status_e
+vs_update_firmware_delta_init(vs_storage_op_ctx_t *storage_ctx,
+                              vs_device_manufacture_id_t manufacture,
+                              vs_device_type_t device_type);
+#endif // FIRMWARE_DELTA
+
+#if FIRMWARE_COMPRESSION
+vs_status_e
+vs_update_firmware_compressed_init(vs_storage_op_ctx_t *storage_ctx,
+                                   vs_device_manufacture_id_t manufacture,
+                                   vs_device_type_t device_type);
+#endif // FIRMWARE_COMPRESSION
+
+#if FIRMWARE_CHUNK_HASHES
+vs_status_e
+vs_update_firmware_chunked_init(vs_storage_op_ctx_t *storage_ctx,
+                                vs_device_manufacture_id_t manufacture,
+                                vs_device_type_t device_type);
+#endif // FIRMWARE_CHUNK_HASHES
+
+#if FIRMWARE_DEDUP
+vs_status_e
+vs_firmware_dedup_init(void);
+
+void
+vs_firmware_dedup_lock(void);
+
+void
+vs_firmware_dedup_unlock(void);
+
+void
+vs_firmware_dedup_deinit(void);
+
+bool
+vs_firmware_dedup_is_packed(const vs_storage_element_id_t id);
+
+ssize_t
+vs_firmware_dedup_size(const vs_storage_element_id_t id);
+
+vs_status_e
+vs_firmware_dedup_read(const vs_storage_element_id_t id,
+                       uint32_t offset,
+                       uint8_t *data,
+                       size_t buff_sz,
+                       size_t *data_sz);
+
+vs_status_e
+vs_firmware_dedup_pack(const vs_storage_element_id_t id, uint32_t data_sz);
+
+vs_status_e
+vs_firmware_dedup_expand(const vs_storage_element_id_t id);
+
+vs_status_e
+vs_firmware_dedup_delete(const vs_storage_element_id_t id);
+#endif // FIRMWARE_DEDUP
+
 #endif // HELPERS_FIRMWARE_PRIVATE_H
@@ -277,6 +277,8 @@ vs_firmware_deinit(void);
  *
  * Gateway saves a chunk of data received from Cloud. Thing automatically saves the chunk of data received from Gateway.
  *
+ * Data can be buffered, see #vs_firmware_flush_firmware_chunks for details.
+ *
  * See \ref firmware_usage_gateway for data flow details.
  *
  * \param[in] descriptor #vs_firmware_descriptor_t firmware descriptor. Must not be NULL.
@@ -292,6 +294,33 @@ vs_firmware_save_firmware_chunk(const vs_firmware_descriptor_t *descriptor,
                                 size_t chunk_sz,
                                 size_t offset);
 
+/** Write buffered firmware data
+ *
+ * #vs_firmware_save_firmware_chunk collects consecutive chunks and writes them by #VS_FIRMWARE_WRITE_BUFFER_SIZE
+ * aligned blocks. Buffered data is written when the buffer becomes full, when a chunk of another firmware or a non
+ * consecutive chunk is saved, when it becomes older than #VS_FIRMWARE_WRITE_BUFFER_FLUSH_MS and before firmware
+ * footer is saved or firmware is loaded or verified. Buffer age is checked when the next chunk is saved and by
+ * #vs_firmware_flush_expired_chunks call.
+ *
+ * This call writes buffered data and synchronizes firmware storage. Data that has been saved before is durable after
+ * successful call. Call it periodically while firmware is being received to limit data loss on power failure.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_flush_firmware_chunks(void);
+
+/** Write expired buffered firmware data
+ *
+ * Writes buffered data if it is older than #VS_FIRMWARE_WRITE_BUFFER_FLUSH_MS, so stalled download does not keep
+ * received data in memory. Storage is not synchronized. Firmware update interfaces call it from
+ * #vs_update_interface_t \a periodical callback, FLDT client calls it periodically while file is being received.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_flush_expired_chunks(void);
+
 /** Save firmware footer
  *
  * Gateway saves firmware footer received from Cloud. Thing automatically saves footer firmware received from Gateway.
@@ -350,6 +379,9 @@ vs_firmware_load_firmware_footer(const vs_firmware_descriptor_t *descriptor,
  *
  * Gateway verifies firmware received from Cloud. Thing verifies firmware before its installation.
  *
+ * Firmware saved sequentially by #vs_firmware_save_firmware_chunk and #vs_firmware_save_firmware_footer is hashed
+ * on the fly, so its first verification checks signatures only. Otherwise the stored image is read and hashed.
+ *
  * See \ref firmware_usage_gateway for data flow details.
  *
  * \param[in] descriptor #vs_firmware_descriptor_t firmware descriptor. Must not be NULL.
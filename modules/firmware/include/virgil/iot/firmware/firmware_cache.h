@@ -0,0 +1,194 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+/*! \file firmware_cache.h
+ * \brief Gateway firmware cache
+ *
+ * Gateway keeps one firmware for each manufacturer and device type to be distributed by FLDT. Firmware cache limits
+ * the total size of stored images by byte quota, keeps previous versions for rollback and evicts images that are
+ * requested rarely. It is available if library has been built with \a FIRMWARE_CACHE option.
+ *
+ * Cache tracks images of the following kinds :
+ * - Active ones, which are stored by #vs_firmware_save_firmware_descriptor() and other Firmware calls and are
+ * served by FLDT.
+ * - Previous versions. Active image is copied to a separate storage element when newer firmware for the same device
+ * type is stored, if #VS_FIRMWARE_CACHE_KEEP_PREVIOUS is set or image is pinned. It can be restored by
+ * #vs_firmware_cache_restore().
+ *
+ * When there is no room for new firmware, not pinned images are evicted in order of #vs_firmware_cache_policy_e.
+ * Requests are counted by FLDT server for each GNFH request of #VS_UPDATE_FIRMWARE file type, so the same statistics
+ * allows to estimate hit rate for gateway flash sizing. Cache state is stored with firmware images and survives
+ * gateway restart.
+ *
+ * Cloud library reserves room for new firmware during #vs_cloud_fetch_and_store_fw_file() call instead of plain old
+ * version removing :
+ *
+ * \code
+
+STATUS_CHECK(vs_firmware_init(&fw_storage_impl, secmodule_impl, manufacture_id, device_type, &ver), "Unable to initialize Firmware");
+STATUS_CHECK(vs_firmware_cache_init(VS_GATEWAY_FW_QUOTA, VS_FIRMWARE_CACHE_LFU), "Unable to initialize Firmware cache");
+...
+STATUS_CHECK(vs_firmware_cache_pin(&known_good_firmware.info, true), "Unable to pin firmware");
+
+ * \endcode
+ */
+
+#ifndef VS_FIRMWARE_CACHE_H
+#define VS_FIRMWARE_CACHE_H
+
+#if FIRMWARE_CACHE
+
+#include <virgil/iot/firmware/firmware.h>
+
+#ifdef __cplusplus
+namespace VirgilIoTKit {
+extern "C" {
+#endif
+
+/** Eviction policy */
+typedef enum {
+    VS_FIRMWARE_CACHE_LRU, /**< Least recently requested image is evicted first */
+    VS_FIRMWARE_CACHE_LFU  /**< Least frequently requested image is evicted first */
+} vs_firmware_cache_policy_e;
+
+/** Cache statistics */
+typedef struct {
+    uint32_t requests;  /**< FLDT requests of firmware */
+    uint32_t hits;      /**< Requests of firmware that has been stored */
+    uint32_t misses;    /**< Requests of firmware that has not been stored */
+    uint32_t evictions; /**< Images removed to free space */
+    size_t quota;       /**< Cache quota in bytes */
+    size_t used;        /**< Size of stored images in bytes */
+    uint16_t images;    /**< Amount of stored images including previous versions */
+    uint16_t pinned;    /**< Amount of pinned images */
+} vs_firmware_cache_stats_t;
+
+/** Initialize firmware cache
+ *
+ * Must be called after #vs_firmware_init(). Stored cache state is loaded. Images are evicted if they don't fit the
+ * quota.
+ *
+ * \param[in] quota Maximum size of all stored images in bytes. Image size is \a app_size field of its descriptor.
+ * \param[in] policy Eviction policy.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_cache_init(size_t quota, vs_firmware_cache_policy_e policy);
+
+/** Destroy firmware cache
+ *
+ * Cache state is saved.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_cache_deinit(void);
+
+/** Prepare cache for new firmware
+ *
+ * Must be called before new firmware storing instead of old version removing. Stored firmware for the same device
+ * type is kept as previous version or removed. Other images are evicted if there is not enough room for new one.
+ * If cache has not been initialized, old version is just removed.
+ *
+ * \param[in] descriptor New firmware descriptor. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success, #VS_CODE_ERR_NO_MEMORY if pinned images don't leave room for new firmware
+ * or another error code.
+ */
+vs_status_e
+vs_firmware_cache_reserve(const vs_firmware_descriptor_t *descriptor);
+
+/** Register stored firmware
+ *
+ * Must be called after new firmware has been stored. It does nothing if cache has not been initialized.
+ *
+ * \param[in] descriptor Firmware descriptor. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_cache_commit(const vs_firmware_descriptor_t *descriptor);
+
+/** Count firmware request
+ *
+ * FLDT server calls it for each firmware header request. Request is a hit if firmware for this device type is stored.
+ * It does nothing if cache has not been initialized.
+ *
+ * \param[in] info Requested file information. Must not be NULL.
+ */
+void
+vs_firmware_cache_request(const vs_file_info_t *info);
+
+/** Pin or unpin firmware
+ *
+ * Pinned images are never evicted. Active pinned image is kept as previous version when newer firmware is stored.
+ *
+ * \param[in] info Firmware manufacturer, device type and version. Must not be NULL.
+ * \param[in] pinned true to pin image, false to unpin.
+ *
+ * \return #VS_CODE_OK in case of success, #VS_CODE_ERR_NOT_FOUND if there is no such image or another error code.
+ */
+vs_status_e
+vs_firmware_cache_pin(const vs_file_info_t *info, bool pinned);
+
+/** Restore previous firmware version
+ *
+ * Previous version becomes active one, current active image is kept as previous version or removed the same way as
+ * #vs_firmware_cache_reserve() does. Restored image is verified. Call #vs_fldt_server_add_file_type() to announce it.
+ *
+ * \param[in] info Firmware manufacturer, device type and version. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success, #VS_CODE_ERR_NOT_FOUND if there is no such previous version or another
+ * error code.
+ */
+vs_status_e
+vs_firmware_cache_restore(const vs_file_info_t *info);
+
+/** Get cache statistics
+ *
+ * \param[out] stats Statistics. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_cache_stats(vs_firmware_cache_stats_t *stats);
+
+#ifdef __cplusplus
+} // extern "C"
+} // namespace VirgilIoTKit
+#endif
+
+#endif // FIRMWARE_CACHE
+
+#endif // VS_FIRMWARE_CACHE_H
@@ -0,0 +1,249 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+/*! \file firmware_chunk_hashes.h
+ * \brief Firmware chunks verification by signed hashes table
+ *
+ * Firmware signatures cover the whole image, so corrupted or forged data is detected after full download only. Signed
+ * table of firmware chunks hashes allows to verify each chunk as soon as it has been received, to accept chunks in any
+ * order and to request again only damaged ones. It is available if library has been built with
+ * \a FIRMWARE_CHUNK_HASHES option.
+ *
+ * Table has the following layout :
+ * - #vs_firmware_chunk_hashes_t header. Descriptor is the same as in the firmware footer.
+ * - SHA-256 hashes of \a descriptor.chunk_size bytes firmware chunks. The last chunk can be smaller.
+ * - Signatures of table header and hashes. They are made by the same keys as firmware signatures.
+ *
+ * virgil-firmware-signer utility with \a --chunk-hashes option stores the table in _Update.bin file between header
+ * and code. In this case header's \a code_offset is bigger than \a sizeof(vs_firmware_header_t). Cloud library
+ * verifies the table and each code chunk during #vs_cloud_fetch_and_store_fw_file() call and keeps the table for
+ * #VS_UPDATE_FIRMWARE_CHUNKED FLDT file type :
+ *
+ * \code
+
+STATUS_CHECK(vs_fldt_server_add_file_type(&chunked_file_type, vs_firmware_chunked_update_ctx(), true),
+             "Unable to add chunked firmware");
+
+ * \endcode
+ *
+ * FLDT file data of this type is the table followed by firmware code. Thing adds
+ * #vs_firmware_chunked_update_file_type() to FLDT Client. Chunk that doesn't match its hash is not saved and FLDT
+ * Client requests it again. Firmware signatures are still verified after footer receiving.
+ */
+
+#ifndef VS_FIRMWARE_CHUNK_HASHES_H
+#define VS_FIRMWARE_CHUNK_HASHES_H
+
+#if FIRMWARE_CHUNK_HASHES
+
+#include <virgil/iot/firmware/firmware.h>
+
+#ifdef __cplusplus
+namespace VirgilIoTKit {
+extern "C" {
+#endif
+
+/** Chunk hashes table header */
+typedef struct __attribute__((__packed__)) {
+    vs_firmware_descriptor_t descriptor; /**< Firmware descriptor */
+    uint32_t chunks_count;               /**< Chunks amount */
+    uint8_t hash_type;                   /**< #vs_secmodule_hash_type_e. Only #VS_HASH_SHA_256 is supported */
+    uint8_t signatures_count;            /**< Signatures amount */
+    uint8_t data[];                      /**< Hashes followed by signatures */
+} vs_firmware_chunk_hashes_t;
+
+/** Chunked firmware header */
+typedef struct __attribute__((__packed__)) {
+    vs_firmware_descriptor_t descriptor; /**< Firmware descriptor */
+    uint32_t hashes_length;              /**< Signed hashes table size */
+} vs_firmware_chunked_header_t;
+
+/** Chunked firmware receiving context */
+typedef struct {
+    vs_firmware_chunked_header_t header; /**< Header in host byte order */
+    uint32_t chunks_count;               /**< Chunks amount */
+    uint32_t chunks_received;            /**< Verified and saved chunks amount */
+    uint32_t hashes_offset;              /**< Bytes of hashes table already saved */
+    bool hashes_verified;                /**< Hashes table signatures have been verified */
+    uint8_t *received;                   /**< Bit map of verified and saved chunks */
+} vs_firmware_chunks_ctx_t;
+
+/** Start chunked firmware receiving
+ *
+ * Previous hashes table for the same device type is removed.
+ *
+ * \param[out] ctx Context. Must not be NULL.
+ * \param[in] header Header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_chunks_init(vs_firmware_chunks_ctx_t *ctx, const vs_firmware_chunked_header_t *header);
+
+/** Save next part of hashes table
+ *
+ * Table parts have to be passed sequentially, repeated parts are skipped. Table is verified after the last part.
+ *
+ * \param[in,out] ctx Context. Must not be NULL.
+ * \param[in] offset Offset inside hashes table.
+ * \param[in] data Table data. Must not be NULL.
+ * \param[in] data_sz Table data size.
+ *
+ * \return #VS_CODE_OK in case of success, #VS_CODE_ERR_VERIFY for wrong table or another error code.
+ */
+vs_status_e
+vs_firmware_chunks_save_hashes(vs_firmware_chunks_ctx_t *ctx, uint32_t offset, const uint8_t *data, uint32_t data_sz);
+
+/** Verify and save firmware chunk
+ *
+ * Chunks can be passed in any order. Chunk is saved only if it matches the verified hashes table.
+ *
+ * \param[in,out] ctx Context. Must not be NULL.
+ * \param[in] offset Firmware offset. Must be aligned to \a descriptor.chunk_size.
+ * \param[in] chunk Chunk data. Must not be NULL.
+ * \param[in] chunk_sz Chunk size. Must be equal to \a descriptor.chunk_size except the last chunk.
+ *
+ * \return #VS_CODE_OK in case of success, #VS_CODE_ERR_VERIFY for damaged chunk or another error code.
+ */
+vs_status_e
+vs_firmware_chunks_save_chunk(vs_firmware_chunks_ctx_t *ctx, uint32_t offset, const uint8_t *chunk, uint32_t chunk_sz);
+
+/** Find chunk that has not been received yet
+ *
+ * \param[in] ctx Context. Must not be NULL.
+ * \param[in] from_offset Firmware offset to start search from.
+ * \param[out] offset Firmware offset of the missing chunk. Must not be NULL.
+ *
+ * \return #VS_CODE_OK if missing chunk has been found, #VS_CODE_ERR_NOT_FOUND if there is no one or error code.
+ */
+vs_status_e
+vs_firmware_chunks_next_missing(const vs_firmware_chunks_ctx_t *ctx, uint32_t from_offset, uint32_t *offset);
+
+/** Check all chunks have been received
+ *
+ * \param[in] ctx Context. Must not be NULL.
+ *
+ * \return true if all firmware chunks have been verified and saved.
+ */
+bool
+vs_firmware_chunks_is_complete(const vs_firmware_chunks_ctx_t *ctx);
+
+/** Free chunked firmware receiving context
+ *
+ * Saved data is kept.
+ *
+ * \param[in,out] ctx Context. Must not be NULL.
+ */
+void
+vs_firmware_chunks_free(vs_firmware_chunks_ctx_t *ctx);
+
+/** Load chunked firmware header
+ *
+ * \param[in] manufacture_id Manufacture ID.
+ * \param[in] device_type Device type.
+ * \param[out] header Header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_chunked_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                                const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                                vs_firmware_chunked_header_t *header);
+
+/** Load hashes table data
+ *
+ * \param[in] header Header in host byte order. Must not be NULL.
+ * \param[in] offset Offset inside hashes table.
+ * \param[out] data Output buffer. Must not be NULL.
+ * \param[in] buf_sz Buffer size.
+ * \param[out] data_sz Loaded data size. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_chunked_load_hashes(const vs_firmware_chunked_header_t *header,
+                                uint32_t offset,
+                                uint8_t *data,
+                                size_t buf_sz,
+                                size_t *data_sz);
+
+/** Delete stored hashes table
+ *
+ * \param[in] header Header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_chunked_delete(const vs_firmware_chunked_header_t *header);
+
+/** Return chunked firmware Update interface
+ *
+ * \return Update interface implementation
+ */
+vs_update_interface_t *
+vs_firmware_chunked_update_ctx(void);
+
+/** Return chunked firmware file type for Update library
+ *
+ * \return File type information for Update library
+ */
+const vs_update_file_type_t *
+vs_firmware_chunked_update_file_type(void);
+
+/** ntoh conversion for chunked firmware header
+ *
+ * \warning This call changes \a header input parameter.
+ *
+ * \param[in,out] header Header. Must not be NULL.
+ */
+void
+vs_firmware_chunked_ntoh_header(vs_firmware_chunked_header_t *header);
+
+/** hton conversion for chunked firmware header
+ *
+ * \warning This call changes \a header input parameter.
+ *
+ * \param[in,out] header Header. Must not be NULL.
+ */
+void
+vs_firmware_chunked_hton_header(vs_firmware_chunked_header_t *header);
+
+#ifdef __cplusplus
+} // extern "C"
+} // namespace VirgilIoTKit
+#endif
+
+#endif // FIRMWARE_CHUNK_HASHES
+
+#endif // VS_FIRMWARE_CHUNK_HASHES_H
@@ -0,0 +1,359 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+/*! \file firmware_compression.h
+ * \brief Compressed firmware update
+ *
+ * Firmware code can be transferred compressed by small window LZ codec. Compressed stream is decompressed on the fly,
+ * so firmware is stored uncompressed and its signatures cover the original image. It is available if library has been
+ * built with \a FIRMWARE_COMPRESSION option.
+ *
+ * Compressed stream has the following layout :
+ * - "VLZ" magic and window size as log2 of bytes amount. It is not bigger than #VS_FIRMWARE_LZ_WINDOW_BITS.
+ * - Tokens groups. Each group starts with flags byte, its bits from the lowest one describe up to 8 tokens :
+ *   - 1 : literal byte.
+ *   - 0 : 2 bytes big-endian match. High 12 bits are (distance - 1), low 4 bits are (length - 3).
+ *
+ * virgil-firmware-signer utility with \a --compress option stores compressed code in _Update.bin file. In this case
+ * header's \a code_length is the compressed stream size, while \a descriptor.firmware_length is the original size.
+ * Cloud library decompresses it during #vs_cloud_fetch_and_store_fw_file() call and keeps compressed stream for
+ * #VS_UPDATE_FIRMWARE_COMPRESSED FLDT file type :
+ *
+ * \code
+
+STATUS_CHECK(vs_fldt_server_add_file_type(&compressed_file_type, vs_firmware_compressed_update_ctx(), true),
+             "Unable to add compressed firmware");
+
+ * \endcode
+ *
+ * Thing adds #vs_firmware_compressed_update_file_type() to FLDT Client. Gateway has to broadcast either full or
+ * compressed firmware for the same device type.
+ */
+
+#ifndef VS_FIRMWARE_COMPRESSION_H
+#define VS_FIRMWARE_COMPRESSION_H
+
+#if FIRMWARE_COMPRESSION
+
+#include <virgil/iot/firmware/firmware.h>
+
+#ifdef __cplusplus
+namespace VirgilIoTKit {
+extern "C" {
+#endif
+
+/** Compressed stream header size */
+#define VS_FIRMWARE_LZ_HEADER_SIZE (4)
+
+/** Minimal match length */
+#define VS_FIRMWARE_LZ_MIN_MATCH (3)
+
+/** Maximal match length */
+#define VS_FIRMWARE_LZ_MAX_MATCH (VS_FIRMWARE_LZ_MIN_MATCH + 15)
+
+/** Maximal window size as log2 of bytes amount supported by stream format */
+#define VS_FIRMWARE_LZ_MAX_WINDOW_BITS (12)
+
+/** LZ decoder context */
+typedef struct {
+    uint8_t *window;                            /**< History window */
+    uint16_t window_mask;                       /**< Window size - 1 */
+    uint16_t window_pos;                        /**< Next position in \a window */
+    uint8_t header[VS_FIRMWARE_LZ_HEADER_SIZE]; /**< Stream header */
+    uint8_t header_used;                        /**< Bytes used in \a header */
+    uint8_t flags;                              /**< Current flags byte */
+    uint8_t flags_left;                         /**< Tokens left for \a flags */
+    bool match_started;                         /**< First byte of match has been read */
+    uint8_t match_hi;                           /**< First byte of match */
+    uint16_t match_distance;                    /**< Current match distance */
+    uint8_t match_left;                         /**< Current match bytes to be copied */
+} vs_firmware_lz_ctx_t;
+
+/** Compressed firmware header */
+typedef struct __attribute__((__packed__)) {
+    vs_firmware_descriptor_t descriptor; /**< Firmware descriptor */
+    uint32_t compressed_length;          /**< Compressed stream size */
+} vs_firmware_compressed_header_t;
+
+/** Compressed firmware applying context */
+typedef struct {
+    vs_firmware_descriptor_t descriptor; /**< Resulting firmware */
+    uint32_t compressed_length;          /**< Compressed stream size */
+    uint32_t compressed_offset;          /**< Bytes of compressed stream already processed */
+    uint32_t out_offset;                 /**< Bytes of resulting firmware already saved */
+    uint8_t *chunk;                      /**< Output chunk buffer of descriptor.chunk_size bytes */
+    uint16_t chunk_used;                 /**< Bytes used in \a chunk */
+    vs_firmware_lz_ctx_t lz;             /**< Decoder */
+} vs_firmware_compressed_ctx_t;
+
+/** Initialize LZ decoder
+ *
+ * \param[out] ctx Decoder context. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_lz_decode_init(vs_firmware_lz_ctx_t *ctx);
+
+/** Decompress next part of stream
+ *
+ * Stream can be split to any parts. Call is finished when either input is processed or output buffer is full.
+ *
+ * \param[in,out] ctx Decoder context. Must not be NULL.
+ * \param[in] in Compressed data. Must not be NULL.
+ * \param[in] in_sz Compressed data size.
+ * \param[out] in_used Processed compressed data size. Must not be NULL.
+ * \param[out] out Output buffer. Must not be NULL.
+ * \param[in] out_sz Output buffer size.
+ * \param[out] out_used Decompressed data size. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_lz_decode(vs_firmware_lz_ctx_t *ctx,
+                      const uint8_t *in,
+                      size_t in_sz,
+                      size_t *in_used,
+                      uint8_t *out,
+                      size_t out_sz,
+                      size_t *out_used);
+
+/** Free LZ decoder
+ *
+ * \param[in,out] ctx Decoder context. Must not be NULL.
+ */
+void
+vs_firmware_lz_decode_free(vs_firmware_lz_ctx_t *ctx);
+
+/** Compress data
+ *
+ * Gateways and tools can use it to prepare compressed firmware. Thing doesn't need it.
+ *
+ * \param[in] in Data to be compressed. Must not be NULL.
+ * \param[in] in_sz Data size.
+ * \param[in] window_bits Window size as log2 of bytes amount. 8..#VS_FIRMWARE_LZ_MAX_WINDOW_BITS.
+ * \param[out] out Output buffer. Must not be NULL.
+ * \param[in] out_buf_sz Output buffer size. Compressed data is not bigger than \a in_sz + \a in_sz / 8 + 5.
+ * \param[out] out_sz Compressed data size. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_lz_encode(const uint8_t *in,
+                      size_t in_sz,
+                      uint8_t window_bits,
+                      uint8_t *out,
+                      size_t out_buf_sz,
+                      size_t *out_sz);
+
+/** Start compressed firmware applying
+ *
+ * Resulting firmware is saved as a regular one for \a descriptor.
+ *
+ * \param[out] ctx Context. Must not be NULL.
+ * \param[in] descriptor Resulting firmware descriptor in host byte order. Must not be NULL.
+ * \param[in] compressed_length Compressed stream size.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_apply_init(vs_firmware_compressed_ctx_t *ctx,
+                                  const vs_firmware_descriptor_t *descriptor,
+                                  uint32_t compressed_length);
+
+/** Apply next part of compressed stream
+ *
+ * Stream can be split to any parts, they have to be passed sequentially.
+ *
+ * \param[in,out] ctx Context. Must not be NULL.
+ * \param[in] data Compressed data. Must not be NULL.
+ * \param[in] data_sz Compressed data size.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_apply_data(vs_firmware_compressed_ctx_t *ctx, const uint8_t *data, uint32_t data_sz);
+
+/** Finish compressed firmware applying
+ *
+ * Saves the rest of resulting firmware and its \a footer. Call #vs_firmware_verify_firmware() after that.
+ *
+ * \param[in,out] ctx Context. Must not be NULL.
+ * \param[in] footer Firmware footer. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_apply_finish(vs_firmware_compressed_ctx_t *ctx, const uint8_t *footer);
+
+/** Free compressed firmware applying context
+ *
+ * \param[in,out] ctx Context. Must not be NULL.
+ */
+void
+vs_firmware_compressed_apply_free(vs_firmware_compressed_ctx_t *ctx);
+
+/** Save compressed firmware header
+ *
+ * Gateway saves compressed firmware to serve it by FLDT. Previous compressed firmware is removed.
+ *
+ * \param[in] header Header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_save_header(const vs_firmware_compressed_header_t *header);
+
+/** Save compressed stream data
+ *
+ * \param[in] header Header in host byte order. Must not be NULL.
+ * \param[in] chunk Compressed data. Must not be NULL.
+ * \param[in] chunk_sz Compressed data size.
+ * \param[in] offset Offset inside compressed stream.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_save_chunk(const vs_firmware_compressed_header_t *header,
+                                  const uint8_t *chunk,
+                                  size_t chunk_sz,
+                                  uint32_t offset);
+
+/** Save compressed firmware footer
+ *
+ * \param[in] header Header in host byte order. Must not be NULL.
+ * \param[in] footer Firmware footer. Must not be NULL.
+ * \param[in] footer_sz Footer size.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_save_footer(const vs_firmware_compressed_header_t *header,
+                                   const uint8_t *footer,
+                                   size_t footer_sz);
+
+/** Load compressed firmware header
+ *
+ * \param[in] manufacture_id Manufacture ID.
+ * \param[in] device_type Device type.
+ * \param[out] header Header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                                   const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                                   vs_firmware_compressed_header_t *header);
+
+/** Load compressed stream data
+ *
+ * \param[in] header Header in host byte order. Must not be NULL.
+ * \param[in] offset Offset inside compressed stream.
+ * \param[out] data Output buffer. Must not be NULL.
+ * \param[in] buf_sz Buffer size.
+ * \param[out] data_sz Loaded data size. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_load_chunk(const vs_firmware_compressed_header_t *header,
+                                  uint32_t offset,
+                                  uint8_t *data,
+                                  size_t buf_sz,
+                                  size_t *data_sz);
+
+/** Load compressed firmware footer
+ *
+ * \param[in] header Header in host byte order. Must not be NULL.
+ * \param[out] data Output buffer. Must not be NULL.
+ * \param[in] buf_sz Buffer size.
+ * \param[out] data_sz Loaded footer size. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_load_footer(const vs_firmware_compressed_header_t *header,
+                                   uint8_t *data,
+                                   size_t buf_sz,
+                                   size_t *data_sz);
+
+/** Delete stored compressed firmware
+ *
+ * \param[in] header Header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_compressed_delete(const vs_firmware_compressed_header_t *header);
+
+/** Return compressed firmware Update interface
+ *
+ * \return Update interface implementation
+ */
+vs_update_interface_t *
+vs_firmware_compressed_update_ctx(void);
+
+/** Return compressed firmware file type for Update library
+ *
+ * \return File type information for Update library
+ */
+const vs_update_file_type_t *
+vs_firmware_compressed_update_file_type(void);
+
+/** ntoh conversion for compressed firmware header
+ *
+ * \warning This call changes \a header input parameter.
+ *
+ * \param[in,out] header Header. Must not be NULL.
+ */
+void
+vs_firmware_compressed_ntoh_header(vs_firmware_compressed_header_t *header);
+
+/** hton conversion for compressed firmware header
+ *
+ * \warning This call changes \a header input parameter.
+ *
+ * \param[in,out] header Header. Must not be NULL.
+ */
+void
+vs_firmware_compressed_hton_header(vs_firmware_compressed_header_t *header);
+
+#ifdef __cplusplus
+} // extern "C"
+} // namespace VirgilIoTKit
+#endif
+
+#endif // FIRMWARE_COMPRESSION
+
+#endif // VS_FIRMWARE_COMPRESSION_H
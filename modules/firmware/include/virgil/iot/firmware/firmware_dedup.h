@@ -0,0 +1,101 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+/*! \file firmware_dedup.h
+ * \brief Firmware chunks deduplication
+ *
+ * Gateway stores firmware for several device types, and consecutive versions of the same firmware differ a little.
+ * Content-addressed chunk store keeps each unique block of firmware data once. It is available if library has been
+ * built with \a FIRMWARE_DEDUP option.
+ *
+ * Firmware is stored as usual by #vs_firmware_save_firmware_chunk() and #vs_firmware_save_firmware_footer() calls.
+ * After that #vs_firmware_dedup_firmware() splits its data into blocks of #VS_FIRMWARE_DEDUP_BLOCK_SIZE bytes. Each
+ * block is addressed by its SHA-256 hash and is referenced by all images that contain it. Image itself is replaced by
+ * manifest with blocks list and footer. Block is removed when the last image that references it is deleted.
+ *
+ * #vs_firmware_load_firmware_chunk(), #vs_firmware_load_firmware_footer(), #vs_firmware_verify_firmware() and other
+ * Firmware calls read deduplicated images transparently. Image is expanded back when its data is changed.
+ *
+ * Cloud library deduplicates firmware after #vs_cloud_fetch_and_store_fw_file() call, firmware cache does it for
+ * previous versions.
+ */
+
+#ifndef VS_FIRMWARE_DEDUP_H
+#define VS_FIRMWARE_DEDUP_H
+
+#if FIRMWARE_DEDUP
+
+#include <virgil/iot/firmware/firmware.h>
+
+#ifdef __cplusplus
+namespace VirgilIoTKit {
+extern "C" {
+#endif
+
+/** Chunk store statistics */
+typedef struct {
+    uint32_t images;     /**< Amount of deduplicated images */
+    uint32_t chunks;     /**< Amount of unique blocks */
+    uint32_t references; /**< Amount of blocks referenced by all images */
+    size_t logical_size; /**< Size of images data in bytes */
+    size_t stored_size;  /**< Size of unique blocks in bytes */
+} vs_firmware_dedup_stats_t;
+
+/** Deduplicate stored firmware
+ *
+ * Firmware data is moved to chunk store. It does nothing if firmware has already been deduplicated.
+ *
+ * \param[in] descriptor Firmware descriptor. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code. Firmware is kept as is in case of error.
+ */
+vs_status_e
+vs_firmware_dedup_firmware(const vs_firmware_descriptor_t *descriptor);
+
+/** Get chunk store statistics
+ *
+ * \param[out] stats Statistics. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_dedup_stats(vs_firmware_dedup_stats_t *stats);
+
+#ifdef __cplusplus
+} // extern "C"
+} // namespace VirgilIoTKit
+#endif
+
+#endif // FIRMWARE_DEDUP
+
+#endif // VS_FIRMWARE_DEDUP_H
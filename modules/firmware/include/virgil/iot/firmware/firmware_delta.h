@@ -0,0 +1,276 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+/*! \file firmware_delta.h
+ * \brief Delta firmware update
+ *
+ * Delta update transfers binary difference between currently installed firmware and the new one instead of the whole
+ * image. It is distributed by FLDT as #VS_UPDATE_FIRMWARE_DELTA file type and is available if library has been built
+ * with \a FIRMWARE_DELTA option.
+ *
+ * Delta file is produced by virgil-firmware-signer utility and has the following layout (all numbers are big-endian) :
+ * - #vs_firmware_delta_header_t header.
+ * - Patch of \a patch_length bytes. It is a sequence of operations :
+ *   - #VS_FIRMWARE_DELTA_OP_COPY, 4 bytes source offset, 4 bytes length : copy bytes from current firmware.
+ *   - #VS_FIRMWARE_DELTA_OP_INSERT, 4 bytes length, data : insert bytes from patch.
+ * - Footer of the new firmware. It is the same as for full firmware file.
+ *
+ * Gateway stores delta file by #vs_firmware_delta_save_header(), #vs_firmware_delta_save_chunk() and
+ * #vs_firmware_delta_save_footer() calls and adds it to FLDT Server :
+ *
+ * \code
+
+STATUS_CHECK(vs_fldt_server_add_file_type(&delta_file_type, vs_firmware_delta_update_ctx(), true),
+             "Unable to add firmware delta");
+
+ * \endcode
+ *
+ * Thing adds #vs_firmware_delta_update_file_type() to FLDT Client. It applies patch on the fly against its current
+ * firmware, which is read by #vs_firmware_read_own_firmware_hal(). Restored firmware is saved as a regular firmware, so
+ * it is verified by #vs_firmware_verify_firmware() and installed by #vs_firmware_install_firmware().
+ */
+
+#ifndef VS_FIRMWARE_DELTA_H
+#define VS_FIRMWARE_DELTA_H
+
+#if FIRMWARE_DELTA
+
+#include <virgil/iot/firmware/firmware.h>
+
+#ifdef __cplusplus
+namespace VirgilIoTKit {
+extern "C" {
+#endif
+
+/** Patch operations */
+typedef enum {
+    VS_FIRMWARE_DELTA_OP_COPY = 1,   /**< Copy data from current firmware */
+    VS_FIRMWARE_DELTA_OP_INSERT = 2, /**< Insert data from patch */
+} vs_firmware_delta_op_e;
+
+/** Max size of patch operation header */
+#define VS_FIRMWARE_DELTA_OP_HEADER_MAX (1 + 2 * sizeof(uint32_t))
+
+/** Delta header */
+typedef struct __attribute__((__packed__)) {
+    vs_firmware_descriptor_t base;   /**< Firmware the patch has to be applied to */
+    vs_firmware_descriptor_t target; /**< Resulting firmware */
+    uint32_t patch_length;           /**< Patch size */
+} vs_firmware_delta_header_t;
+
+/** Patch applying context */
+typedef struct {
+    vs_firmware_delta_header_t header;                 /**< Delta header */
+    uint8_t *chunk;                                    /**< Output chunk buffer of target.chunk_size bytes */
+    uint16_t chunk_used;                               /**< Bytes used in \a chunk */
+    uint32_t out_offset;                               /**< Bytes of resulting firmware already saved */
+    uint32_t patch_offset;                             /**< Bytes of patch already processed */
+    uint8_t op_buf[VS_FIRMWARE_DELTA_OP_HEADER_MAX];   /**< Partially received operation header */
+    uint8_t op_used;                                   /**< Bytes used in \a op_buf */
+    uint8_t op;                                        /**< Current #vs_firmware_delta_op_e or 0 */
+    uint32_t op_rest;                                  /**< Rest of current operation */
+} vs_firmware_delta_ctx_t;
+
+/** Start patch applying
+ *
+ * Resulting firmware is saved as a regular one for \a header->target descriptor.
+ *
+ * \param[out] ctx Patch context. Must not be NULL.
+ * \param[in] header Delta header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_apply_init(vs_firmware_delta_ctx_t *ctx, const vs_firmware_delta_header_t *header);
+
+/** Apply next part of patch
+ *
+ * Patch data can be split to any parts, they have to be passed sequentially.
+ *
+ * \param[in,out] ctx Patch context. Must not be NULL.
+ * \param[in] data Patch data. Must not be NULL.
+ * \param[in] data_sz Patch data size.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_apply_data(vs_firmware_delta_ctx_t *ctx, const uint8_t *data, uint32_t data_sz);
+
+/** Finish patch applying
+ *
+ * Saves the rest of resulting firmware and its \a footer. Call #vs_firmware_verify_firmware() after that.
+ *
+ * \param[in,out] ctx Patch context. Must not be NULL.
+ * \param[in] footer Footer of resulting firmware. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_apply_finish(vs_firmware_delta_ctx_t *ctx, const uint8_t *footer);
+
+/** Free patch context
+ *
+ * \param[in,out] ctx Patch context. Must not be NULL.
+ */
+void
+vs_firmware_delta_apply_free(vs_firmware_delta_ctx_t *ctx);
+
+/** Save delta header
+ *
+ * Gateway saves delta header received from Cloud.
+ *
+ * \param[in] header Delta header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_save_header(const vs_firmware_delta_header_t *header);
+
+/** Save patch data
+ *
+ * \param[in] header Delta header in host byte order. Must not be NULL.
+ * \param[in] chunk Patch data. Must not be NULL.
+ * \param[in] chunk_sz Patch data size.
+ * \param[in] offset Offset inside patch.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_save_chunk(const vs_firmware_delta_header_t *header,
+                             const uint8_t *chunk,
+                             size_t chunk_sz,
+                             uint32_t offset);
+
+/** Save delta footer
+ *
+ * \param[in] header Delta header in host byte order. Must not be NULL.
+ * \param[in] footer Footer of resulting firmware. Must not be NULL.
+ * \param[in] footer_sz Footer size.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_save_footer(const vs_firmware_delta_header_t *header, const uint8_t *footer, size_t footer_sz);
+
+/** Load delta header
+ *
+ * \param[in] manufacture_id Manufacture ID.
+ * \param[in] device_type Device type.
+ * \param[out] header Delta header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                              const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                              vs_firmware_delta_header_t *header);
+
+/** Load patch data
+ *
+ * \param[in] header Delta header in host byte order. Must not be NULL.
+ * \param[in] offset Offset inside patch.
+ * \param[out] data Output buffer. Must not be NULL.
+ * \param[in] buf_sz Buffer size.
+ * \param[out] data_sz Loaded data size. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_load_chunk(const vs_firmware_delta_header_t *header,
+                             uint32_t offset,
+                             uint8_t *data,
+                             size_t buf_sz,
+                             size_t *data_sz);
+
+/** Load delta footer
+ *
+ * \param[in] header Delta header in host byte order. Must not be NULL.
+ * \param[out] data Output buffer. Must not be NULL.
+ * \param[in] buf_sz Buffer size.
+ * \param[out] data_sz Loaded footer size. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_load_footer(const vs_firmware_delta_header_t *header, uint8_t *data, size_t buf_sz, size_t *data_sz);
+
+/** Delete stored delta
+ *
+ * \param[in] header Delta header in host byte order. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_delta_delete(const vs_firmware_delta_header_t *header);
+
+/** Return delta Update interface
+ *
+ * \return Update interface implementation
+ */
+vs_update_interface_t *
+vs_firmware_delta_update_ctx(void);
+
+/** Return delta file type for Update library
+ *
+ * \return File type information for Update library
+ */
+const vs_update_file_type_t *
+vs_firmware_delta_update_file_type(void);
+
+/** ntoh conversion for delta header
+ *
+ * \warning This call changes \a header input parameter.
+ *
+ * \param[in,out] header Delta header. Must not be NULL.
+ */
+void
+vs_firmware_delta_ntoh_header(vs_firmware_delta_header_t *header);
+
+/** hton conversion for delta header
+ *
+ * \warning This call changes \a header input parameter.
+ *
+ * \param[in,out] header Delta header. Must not be NULL.
+ */
+void
+vs_firmware_delta_hton_header(vs_firmware_delta_header_t *header);
+
+#ifdef __cplusplus
+} // extern "C"
+} // namespace VirgilIoTKit
+#endif
+
+#endif // FIRMWARE_DELTA
+
+#endif // VS_FIRMWARE_DELTA_H
@@ -94,6 +94,24 @@ vs_firmware_install_append_data_hal(const void *data, uint16_t data_sz);
 vs_status_e
 vs_firmware_get_own_firmware_footer_hal(void *footer, size_t footer_sz);
 
+#if FIRMWARE_DELTA
+/** Read own firmware data
+ *
+ * Signature for function that is called by Firmware library during delta update to read current firmware image. Patch
+ * copies unchanged parts of new firmware from it.
+ *
+ * It is required only if library has been built with \a FIRMWARE_DELTA option.
+ *
+ * \param[in] offset Offset from the image beginning
+ * \param[out] data Output buffer
+ * \param[in] data_sz Data size to be read
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_read_own_firmware_hal(uint32_t offset, void *data, uint16_t data_sz);
+#endif // FIRMWARE_DELTA
+
 #ifdef __cplusplus
 } // extern "C"
 } // namespace VirgilIoTKit
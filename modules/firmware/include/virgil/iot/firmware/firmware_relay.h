@@ -0,0 +1,108 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+/*! \file firmware_relay.h
+ * \brief Firmware cut-through relay
+ *
+ * Gateway can distribute firmware by FLDT server while it is still being downloaded from Cloud. It is available if
+ * library has been built with \a FIRMWARE_CUT_THROUGH option.
+ *
+ * #vs_firmware_relay_start() is called after firmware descriptor has been saved. Firmware data written by
+ * #vs_firmware_save_firmware_chunk() becomes available for reading as soon as it is stored. FLDT server gets this
+ * size by #vs_update_interface_t::get_available_size callback. It gives "retry later" hint to clients requesting data
+ * that has not been received yet. Footer requests are deferred up to #vs_firmware_relay_stop() call, and firmware is
+ * verified by FLDT server before footer sending.
+ *
+ * Cloud library does it in #vs_cloud_fetch_and_store_fw_file() call, see #vs_cloud_set_fw_relay_cb() to announce
+ * firmware before downloading end.
+ *
+ * \warning Firmware data is read and written by different threads. Storage implementation must allow reading of
+ * element that is being written.
+ */
+
+#ifndef VS_FIRMWARE_RELAY_H
+#define VS_FIRMWARE_RELAY_H
+
+#if FIRMWARE_CUT_THROUGH
+
+#include <virgil/iot/firmware/firmware.h>
+
+#ifdef __cplusplus
+namespace VirgilIoTKit {
+extern "C" {
+#endif
+
+/** Start firmware relay
+ *
+ * Firmware with the same manufacturer and device type is considered as being received up to #vs_firmware_relay_stop()
+ * call. Only one firmware can be relayed at the same time, previous relay is stopped.
+ *
+ * \param[in] descriptor Firmware descriptor. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_relay_start(const vs_firmware_descriptor_t *descriptor);
+
+/** Stop firmware relay
+ *
+ * It is called after the whole firmware including footer has been stored or after firmware deletion.
+ */
+void
+vs_firmware_relay_stop(void);
+
+/** Get firmware data size available for reading
+ *
+ * \param[in] manufacture_id Manufacture ID.
+ * \param[in] device_type Device type.
+ * \param[out] available_sz Size of stored data from the firmware beginning. Must not be NULL.
+ * \param[out] is_complete True if firmware is not being received. \a available_sz is not set in this case.
+ * Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_firmware_relay_available(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                            const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                            uint32_t *available_sz,
+                            bool *is_complete);
+
+#ifdef __cplusplus
+} // extern "C"
+} // namespace VirgilIoTKit
+#endif
+
+#endif // FIRMWARE_CUT_THROUGH
+
+#endif // VS_FIRMWARE_RELAY_H
@@ -35,13 +35,19 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#if FIRMWARE_CUT_THROUGH
+#include <pthread.h>
+#endif // FIRMWARE_CUT_THROUGH
+
 #include <update-config.h>
 #include <endian-config.h>
+#include <global-hal.h>
 
 #include <virgil/iot/macros/macros.h>
 #include <virgil/iot/status_code/status_code.h>
 #include <virgil/iot/firmware/firmware.h>
 #include <virgil/iot/firmware/firmware_hal.h>
+#include <virgil/iot/firmware/firmware_relay.h>
 #include <virgil/iot/storage_hal/storage_hal.h>
 #include <virgil/iot/logger/logger.h>
 #include <virgil/iot/provision/provision.h>
@@ -54,8 +60,58 @@ static const vs_key_type_e sign_rules_list[VS_FW_SIGNATURES_QTY] = VS_FW_SIGNER_
 
 #define DESCRIPTORS_FILENAME "firmware_descriptors"
 
+#define VS_FW_FILL_BLOCK_SZ (256)
+
+// Consecutive firmware chunks that have not been written yet
+typedef struct {
+    bool active;
+    bool dirty; // Data has been written without sync
+    vs_storage_element_id_t data_id;
+    uint32_t offset;
+    size_t used;
+    size_t capacity;
+    uint32_t started_ms;
+    uint8_t *data;
+} vs_firmware_write_buffer_t;
+
+// Descriptors file is an array of descriptor slots. Free slot is filled by zeros
+#define VS_FW_DESCRIPTORS_GROW_STEP (4)
+
+// Hash of firmware being saved sequentially. It lets verification skip reading of the stored image
+typedef struct {
+    bool active;
+    bool finished;
+    vs_firmware_descriptor_t descriptor;
+    uint32_t offset;
+    int32_t footer_sz;
+    vs_secmodule_sw_sha256_ctx ctx;
+    uint8_t hash[VS_HASH_SHA256_LEN];
+} vs_firmware_running_hash_t;
+
 static vs_storage_op_ctx_t *_storage_ctx = NULL;
 static vs_secmodule_impl_t *_secmodule = NULL;
+static vs_firmware_running_hash_t _running_hash;
+static uint8_t _fill_block[VS_FW_FILL_BLOCK_SZ];
+static vs_firmware_write_buffer_t _write_buffer;
+
+// In-memory mirror of descriptors file
+static const vs_firmware_descriptor_t _free_descriptor_slot;
+static vs_firmware_descriptor_t *_descriptors = NULL;
+static size_t _descriptors_count = 0;
+static size_t _descriptors_capacity = 0;
+
+#if FIRMWARE_CUT_THROUGH
+// Firmware that is distributed while it is being received
+typedef struct {
+    bool active;
+    vs_storage_element_id_t data_id;
+    uint32_t firmware_length;
+    uint32_t stored_sz; // Contiguous data from the firmware beginning that has been written to storage
+} vs_firmware_relay_t;
+
+static vs_firmware_relay_t _relay;
+static pthread_mutex_t _relay_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif // FIRMWARE_CUT_THROUGH
 
 /*************************************************************************/
 static void
@@ -74,6 +130,272 @@ _create_descriptors_filename(vs_storage_element_id_t id) {
     VS_IOT_MEMCPY(&id[0], DESCRIPTORS_FILENAME, sizeof(DESCRIPTORS_FILENAME));
 }
 
+/*************************************************************************/
+static void
+_free_descriptors(void) {
+    VS_IOT_FREE(_descriptors);
+    _descriptors = NULL;
+    _descriptors_count = 0;
+    _descriptors_capacity = 0;
+}
+
+/*************************************************************************/
+static bool
+_is_descriptor_slot_free(const vs_firmware_descriptor_t *slot) {
+    return 0 == VS_IOT_MEMCMP(slot, &_free_descriptor_slot, sizeof(vs_firmware_descriptor_t));
+}
+
+/*************************************************************************/
+static bool
+_has_descriptors(void) {
+    size_t i;
+
+    for (i = 0; i < _descriptors_count; ++i) {
+        if (!_is_descriptor_slot_free(&_descriptors[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*************************************************************************/
+static bool
+_find_descriptor_slot(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                      const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                      size_t *slot) {
+    size_t i;
+
+    for (i = 0; i < _descriptors_count; ++i) {
+        vs_firmware_descriptor_t *ptr = &_descriptors[i];
+
+        if (!_is_descriptor_slot_free(ptr) &&
+            0 == VS_IOT_MEMCMP(ptr->info.manufacture_id, manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE) &&
+            0 == VS_IOT_MEMCMP(ptr->info.device_type, device_type, VS_DEVICE_TYPE_SIZE)) {
+            *slot = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*************************************************************************/
+static vs_status_e
+_load_descriptors(void) {
+    vs_storage_element_id_t desc_id;
+    ssize_t file_sz;
+    size_t read_sz;
+
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _free_descriptors();
+
+    // cppcheck-suppress uninitvar
+    _create_descriptors_filename(desc_id);
+
+    file_sz = _storage_ctx->impl_func.size(_storage_ctx->impl_data, desc_id);
+
+    if (file_sz < (ssize_t)sizeof(vs_firmware_descriptor_t)) {
+        return VS_CODE_OK;
+    }
+
+    // Incomplete tail is ignored and will be overwritten by the next slot
+    _descriptors_count = file_sz / sizeof(vs_firmware_descriptor_t);
+    _descriptors_capacity = _descriptors_count + VS_FW_DESCRIPTORS_GROW_STEP;
+    _descriptors = VS_IOT_CALLOC(_descriptors_capacity, sizeof(vs_firmware_descriptor_t));
+
+    if (NULL == _descriptors) {
+        _descriptors_count = 0;
+        _descriptors_capacity = 0;
+        return VS_CODE_ERR_NO_MEMORY;
+    }
+
+    if (VS_CODE_OK != vs_firmware_read_data(desc_id,
+                                            0,
+                                            (uint8_t *)_descriptors,
+                                            _descriptors_count * sizeof(vs_firmware_descriptor_t),
+                                            &read_sz) ||
+        read_sz != _descriptors_count * sizeof(vs_firmware_descriptor_t)) {
+        _free_descriptors();
+        return VS_CODE_ERR_FILE_READ;
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_save_descriptor_slot(size_t slot, const vs_firmware_descriptor_t *descriptor) {
+    vs_storage_element_id_t desc_id;
+    vs_status_e ret_code;
+
+    // cppcheck-suppress uninitvar
+    _create_descriptors_filename(desc_id);
+
+    ret_code = vs_firmware_write_data(
+            desc_id, true, slot * sizeof(vs_firmware_descriptor_t), descriptor, sizeof(vs_firmware_descriptor_t));
+
+    if (VS_CODE_OK == ret_code) {
+        VS_IOT_MEMCPY(&_descriptors[slot], descriptor, sizeof(vs_firmware_descriptor_t));
+    }
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static void
+_relay_stored(const vs_storage_element_id_t data_id, uint32_t offset, size_t sz) {
+#if FIRMWARE_CUT_THROUGH
+    pthread_mutex_lock(&_relay_mutex);
+    if (_relay.active && 0 == VS_IOT_MEMCMP(_relay.data_id, data_id, sizeof(vs_storage_element_id_t)) &&
+        offset <= _relay.stored_sz && offset + sz > _relay.stored_sz) {
+        _relay.stored_sz = offset + sz;
+        if (_relay.stored_sz > _relay.firmware_length) {
+            _relay.stored_sz = _relay.firmware_length;
+        }
+    }
+    pthread_mutex_unlock(&_relay_mutex);
+#else
+    (void)data_id;
+    (void)offset;
+    (void)sz;
+#endif // FIRMWARE_CUT_THROUGH
+}
+
+/*************************************************************************/
+static bool
+_relay_is_stored(const vs_storage_element_id_t data_id, uint32_t offset, size_t sz) {
+    bool res = false;
+#if FIRMWARE_CUT_THROUGH
+    pthread_mutex_lock(&_relay_mutex);
+    if (_relay.active && 0 == VS_IOT_MEMCMP(_relay.data_id, data_id, sizeof(vs_storage_element_id_t)) &&
+        offset < _relay.firmware_length) {
+        // The last chunk is requested by the whole buffer size, but only the firmware tail is read
+        if (sz > _relay.firmware_length - offset) {
+            sz = _relay.firmware_length - offset;
+        }
+        res = offset + sz <= _relay.stored_sz;
+    }
+    pthread_mutex_unlock(&_relay_mutex);
+#else
+    (void)data_id;
+    (void)offset;
+    (void)sz;
+#endif // FIRMWARE_CUT_THROUGH
+    return res;
+}
+
+/*************************************************************************/
+static vs_status_e
+_write_buffer_flush(bool need_sync) {
+    vs_status_e ret_code = VS_CODE_OK;
+
+    if (_write_buffer.active && _write_buffer.used) {
+        ret_code = vs_firmware_write_data(
+                _write_buffer.data_id, need_sync, _write_buffer.offset, _write_buffer.data, _write_buffer.used);
+        _write_buffer.dirty = VS_CODE_OK == ret_code && !need_sync;
+
+        if (VS_CODE_OK == ret_code) {
+            _relay_stored(_write_buffer.data_id, _write_buffer.offset, _write_buffer.used);
+        }
+    }
+
+    _write_buffer.active = false;
+    _write_buffer.used = 0;
+
+    if (VS_CODE_OK != ret_code) {
+        // Hashed data has been lost
+        _running_hash.active = false;
+        VS_LOG_ERROR("Can't write buffered firmware data");
+    }
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static bool
+_is_write_buffer_for(const vs_storage_element_id_t data_id) {
+    return _write_buffer.active && 0 == VS_IOT_MEMCMP(_write_buffer.data_id, data_id, sizeof(vs_storage_element_id_t));
+}
+
+/*************************************************************************/
+static vs_status_e
+_write_buffer_flush_for(const vs_storage_element_id_t data_id) {
+    return _is_write_buffer_for(data_id) ? _write_buffer_flush(false) : VS_CODE_OK;
+}
+
+/*************************************************************************/
+static bool
+_is_write_buffer_expired(void) {
+    return _write_buffer.active &&
+           (uint32_t)(vs_impl_msec() - _write_buffer.started_ms) >= VS_FIRMWARE_WRITE_BUFFER_FLUSH_MS;
+}
+
+/*************************************************************************/
+static vs_status_e
+_write_direct(vs_storage_element_id_t data_id, const uint8_t *chunk, size_t chunk_sz, size_t offset) {
+    vs_status_e ret_code = vs_firmware_write_data(data_id, false, offset, chunk, chunk_sz);
+
+    if (VS_CODE_OK == ret_code) {
+        _relay_stored(data_id, offset, chunk_sz);
+    }
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_write_buffer_save(vs_storage_element_id_t data_id, const uint8_t *chunk, size_t chunk_sz, size_t offset) {
+    vs_status_e ret_code;
+    size_t sz;
+
+    if (!VS_FIRMWARE_WRITE_BUFFER_SIZE) {
+        return _write_direct(data_id, chunk, chunk_sz, offset);
+    }
+
+    // Write old data and data that is not consecutive to buffered one
+    if (_write_buffer.active &&
+        (!_is_write_buffer_for(data_id) || offset != _write_buffer.offset + _write_buffer.used ||
+         _is_write_buffer_expired())) {
+        STATUS_CHECK_RET(_write_buffer_flush(false), "Can't write buffered firmware data");
+    }
+
+    if (!_write_buffer.data) {
+        _write_buffer.data = VS_IOT_MALLOC(VS_FIRMWARE_WRITE_BUFFER_SIZE);
+        if (!_write_buffer.data) {
+            return _write_direct(data_id, chunk, chunk_sz, offset);
+        }
+    }
+
+    while (chunk_sz) {
+        if (!_write_buffer.active) {
+            VS_IOT_MEMCPY(_write_buffer.data_id, data_id, sizeof(vs_storage_element_id_t));
+            _write_buffer.offset = offset;
+            _write_buffer.used = 0;
+            // Buffer ends at aligned offset
+            _write_buffer.capacity = VS_FIRMWARE_WRITE_BUFFER_SIZE - offset % VS_FIRMWARE_WRITE_BUFFER_SIZE;
+            _write_buffer.started_ms = vs_impl_msec();
+            _write_buffer.active = true;
+        }
+
+        sz = _write_buffer.capacity - _write_buffer.used;
+        sz = chunk_sz < sz ? chunk_sz : sz;
+
+        VS_IOT_MEMCPY(_write_buffer.data + _write_buffer.used, chunk, sz);
+        _write_buffer.used += sz;
+        chunk += sz;
+        chunk_sz -= sz;
+        offset += sz;
+
+        if (_write_buffer.used == _write_buffer.capacity) {
+            STATUS_CHECK_RET(_write_buffer_flush(false), "Can't write buffered firmware data");
+        }
+    }
+
+    return VS_CODE_OK;
+}
+
 /*************************************************************************/
 static vs_status_e
 _read_data(vs_storage_element_id_t id, uint32_t offset, uint8_t *data, ssize_t buff_sz, size_t *data_sz) {
@@ -81,11 +403,11 @@ _read_data(vs_storage_element_id_t id, uint32_t offset, uint8_t *data, ssize_t b
     ssize_t file_sz;
     ssize_t bytes_left;
 
-    CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.open, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.load, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.close, VS_CODE_ERR_NULLPTR_ARGUMENT);
+#if FIRMWARE_DEDUP
+    if (vs_firmware_dedup_is_packed(id)) {
+        return vs_firmware_dedup_read(id, offset, data, buff_sz, data_sz);
+    }
+#endif // FIRMWARE_DEDUP
 
     *data_sz = 0;
     file_sz = _storage_ctx->impl_func.size(_storage_ctx->impl_data, id);
@@ -107,9 +429,34 @@ _read_data(vs_storage_element_id_t id, uint32_t offset, uint8_t *data, ssize_t b
     return _storage_ctx->impl_func.close(_storage_ctx->impl_data, f);
 }
 
+/*************************************************************************/
+vs_status_e
+vs_firmware_read_data(vs_storage_element_id_t id, uint32_t offset, uint8_t *data, ssize_t buff_sz, size_t *data_sz) {
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.open, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.load, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.close, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+#if FIRMWARE_DEDUP
+    // Data isn't packed or expanded by another thread while it's read
+    vs_firmware_dedup_lock();
+#endif // FIRMWARE_DEDUP
+
+    ret_code = _read_data(id, offset, data, buff_sz, data_sz);
+
+#if FIRMWARE_DEDUP
+    vs_firmware_dedup_unlock();
+#endif // FIRMWARE_DEDUP
+
+    return ret_code;
+}
+
 /******************************************************************************/
-static vs_status_e
-_write_data(vs_storage_element_id_t id, bool need_sync, uint32_t offset, const void *data, size_t data_sz) {
+vs_status_e
+vs_firmware_write_data(vs_storage_element_id_t id, bool need_sync, uint32_t offset, const void *data, size_t data_sz) {
     vs_storage_file_t f = NULL;
 
     CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
@@ -122,6 +469,13 @@ _write_data(vs_storage_element_id_t id, bool need_sync, uint32_t offset, const v
     CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.close, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_RET(data_sz <= _storage_ctx->file_sz_limit, VS_CODE_ERR_INCORRECT_ARGUMENT, "Requested size is too big");
 
+#if FIRMWARE_DEDUP
+    // Deduplicated data is restored before it's changed
+    if (vs_firmware_dedup_is_packed(id)) {
+        CHECK_RET(VS_CODE_OK == vs_firmware_dedup_expand(id), VS_CODE_ERR_FILE_WRITE, "Can't expand stored data");
+    }
+#endif // FIRMWARE_DEDUP
+
     f = _storage_ctx->impl_func.open(_storage_ctx->impl_data, id);
     if (NULL == f) {
         VS_LOG_ERROR("Can't open file");
@@ -136,12 +490,46 @@ _write_data(vs_storage_element_id_t id, bool need_sync, uint32_t offset, const v
 
     if (need_sync) {
         int res = _storage_ctx->impl_func.sync(_storage_ctx->impl_data, f);
-        CHECK_RET(VS_CODE_OK == res, res, "Can't sync file");
+        if (VS_CODE_OK != res) {
+            _storage_ctx->impl_func.close(_storage_ctx->impl_data, f);
+            VS_LOG_ERROR("Can't sync file");
+            return res;
+        }
     }
 
     return _storage_ctx->impl_func.close(_storage_ctx->impl_data, f);
 }
 
+/******************************************************************************/
+ssize_t
+vs_firmware_data_size(vs_storage_element_id_t id) {
+    CHECK_NOT_ZERO_RET(_storage_ctx, -1);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.size, -1);
+
+#if FIRMWARE_DEDUP
+    if (vs_firmware_dedup_is_packed(id)) {
+        return vs_firmware_dedup_size(id);
+    }
+#endif // FIRMWARE_DEDUP
+
+    return _storage_ctx->impl_func.size(_storage_ctx->impl_data, id);
+}
+
+/******************************************************************************/
+vs_status_e
+vs_firmware_delete_data(vs_storage_element_id_t id) {
+    CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.del, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+#if FIRMWARE_DEDUP
+    if (vs_firmware_dedup_is_packed(id)) {
+        return vs_firmware_dedup_delete(id);
+    }
+#endif // FIRMWARE_DEDUP
+
+    return _storage_ctx->impl_func.del(_storage_ctx->impl_data, id);
+}
+
 /******************************************************************************/
 vs_status_e
 vs_firmware_init(vs_storage_op_ctx_t *storage_ctx,
@@ -161,10 +549,40 @@ vs_firmware_init(vs_storage_op_ctx_t *storage_ctx,
 
     _storage_ctx = storage_ctx;
     _secmodule = secmodule;
+    _running_hash.active = false;
+    _write_buffer.active = false;
+    _write_buffer.dirty = false;
+    _write_buffer.used = 0;
+    VS_IOT_MEMSET(_fill_block, 0xFF, sizeof(_fill_block));
+
+#if FIRMWARE_CUT_THROUGH
+    vs_firmware_relay_stop();
+#endif // FIRMWARE_CUT_THROUGH
+
+    STATUS_CHECK_RET(_load_descriptors(), "Unable to load firmware descriptors");
+
+#if FIRMWARE_DEDUP
+    STATUS_CHECK_RET(vs_firmware_dedup_init(), "Unable to load firmware chunks index");
+#endif // FIRMWARE_DEDUP
 
     STATUS_CHECK_RET(vs_update_firmware_init(storage_ctx, manufacture, device_type),
                      "Unable to initialize Firmware module");
 
+#if FIRMWARE_DELTA
+    STATUS_CHECK_RET(vs_update_firmware_delta_init(storage_ctx, manufacture, device_type),
+                     "Unable to initialize Firmware delta module");
+#endif // FIRMWARE_DELTA
+
+#if FIRMWARE_COMPRESSION
+    STATUS_CHECK_RET(vs_update_firmware_compressed_init(storage_ctx, manufacture, device_type),
+                     "Unable to initialize compressed Firmware module");
+#endif // FIRMWARE_COMPRESSION
+
+#if FIRMWARE_CHUNK_HASHES
+    STATUS_CHECK_RET(vs_update_firmware_chunked_init(storage_ctx, manufacture, device_type),
+                     "Unable to initialize chunked Firmware module");
+#endif // FIRMWARE_CHUNK_HASHES
+
     STATUS_CHECK_RET(vs_firmware_get_own_firmware_descriptor(&fw_descr), "Unable to get own firmware descriptor");
 
     VS_LOG_DEBUG("Current Firmware version: %d.%d.%d.%d",
@@ -178,12 +596,36 @@ vs_firmware_init(vs_storage_op_ctx_t *storage_ctx,
     return ret_code;
 }
 
+/******************************************************************************/
+vs_storage_op_ctx_t *
+vs_firmware_storage_ctx(void) {
+    return _storage_ctx;
+}
+
+/******************************************************************************/
+vs_secmodule_impl_t *
+vs_firmware_secmodule(void) {
+    return _secmodule;
+}
+
 /******************************************************************************/
 vs_status_e
 vs_firmware_deinit(void) {
     CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.deinit, VS_CODE_ERR_NULLPTR_ARGUMENT);
 
+    _free_descriptors();
+
+    if (VS_CODE_OK != vs_firmware_flush_firmware_chunks()) {
+        VS_LOG_ERROR("Can't write buffered firmware data");
+    }
+    VS_IOT_FREE(_write_buffer.data);
+    _write_buffer.data = NULL;
+
+#if FIRMWARE_DEDUP
+    vs_firmware_dedup_deinit();
+#endif // FIRMWARE_DEDUP
+
     return _storage_ctx->impl_func.deinit(_storage_ctx->impl_data);
 }
 
@@ -196,6 +638,7 @@ vs_firmware_load_firmware_chunk(const vs_firmware_descriptor_t *descriptor,
                                 size_t *data_sz) {
 
     vs_storage_element_id_t data_id;
+    vs_status_e ret_code;
     CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(data_sz, VS_CODE_ERR_NULLPTR_ARGUMENT);
@@ -203,7 +646,80 @@ vs_firmware_load_firmware_chunk(const vs_firmware_descriptor_t *descriptor,
     // cppcheck-suppress uninitvar
     _create_data_filename(descriptor->info.manufacture_id, descriptor->info.device_type, data_id);
 
-    return _read_data(data_id, offset, data, buff_sz, data_sz);
+    // Relayed data is read by another thread, so write buffer is not touched
+    if (!_relay_is_stored(data_id, offset, buff_sz)) {
+        STATUS_CHECK_RET(_write_buffer_flush_for(data_id), "Can't write buffered firmware data");
+    }
+
+    return vs_firmware_read_data(data_id, offset, data, buff_sz, data_sz);
+}
+
+/*************************************************************************/
+static bool
+_is_running_hash_for(const vs_firmware_descriptor_t *descriptor) {
+    return _running_hash.active &&
+           0 == VS_IOT_MEMCMP(&_running_hash.descriptor, descriptor, sizeof(vs_firmware_descriptor_t));
+}
+
+/*************************************************************************/
+static void
+_hash_fill(vs_secmodule_sw_sha256_ctx *ctx, uint32_t fill_sz) {
+    while (fill_sz) {
+        uint32_t sz = fill_sz > sizeof(_fill_block) ? sizeof(_fill_block) : fill_sz;
+        _secmodule->hash_update(ctx, _fill_block, sz);
+        fill_sz -= sz;
+    }
+}
+
+/*************************************************************************/
+static void
+_running_hash_update(const vs_firmware_descriptor_t *descriptor, const uint8_t *chunk, size_t chunk_sz, size_t offset) {
+    if (!_secmodule) {
+        return;
+    }
+
+    if (0 == offset) {
+        VS_IOT_MEMCPY(&_running_hash.descriptor, descriptor, sizeof(vs_firmware_descriptor_t));
+        _running_hash.active = true;
+        _running_hash.finished = false;
+        _running_hash.offset = 0;
+        _secmodule->hash_init(&_running_hash.ctx);
+    } else if (!_is_running_hash_for(descriptor)) {
+        return;
+    }
+
+    // Only sequential data can be hashed. Verification will read stored image otherwise
+    if (_running_hash.finished || offset != _running_hash.offset ||
+        chunk_sz > descriptor->firmware_length - _running_hash.offset) {
+        _running_hash.active = false;
+        return;
+    }
+
+    _secmodule->hash_update(&_running_hash.ctx, chunk, chunk_sz);
+    _running_hash.offset += chunk_sz;
+}
+
+/*************************************************************************/
+static void
+_running_hash_finish(const vs_firmware_descriptor_t *descriptor, const uint8_t *footer, size_t footer_sz) {
+    uint32_t fill_sz;
+
+    if (!_is_running_hash_for(descriptor)) {
+        return;
+    }
+
+    fill_sz = descriptor->app_size - descriptor->firmware_length;
+    if (_running_hash.finished || _running_hash.offset != descriptor->firmware_length ||
+        descriptor->app_size < descriptor->firmware_length || footer_sz > fill_sz) {
+        _running_hash.active = false;
+        return;
+    }
+
+    _hash_fill(&_running_hash.ctx, fill_sz - footer_sz);
+    _secmodule->hash_update(&_running_hash.ctx, footer, sizeof(vs_firmware_footer_t));
+    _secmodule->hash_finish(&_running_hash.ctx, _running_hash.hash);
+    _running_hash.footer_sz = footer_sz;
+    _running_hash.finished = true;
 }
 
 /*************************************************************************/
@@ -214,13 +730,95 @@ vs_firmware_save_firmware_chunk(const vs_firmware_descriptor_t *descriptor,
                                 size_t offset) {
 
     vs_storage_element_id_t data_id;
+    vs_status_e ret_code;
     CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(chunk, VS_CODE_ERR_NULLPTR_ARGUMENT);
 
     // cppcheck-suppress uninitvar
     _create_data_filename(descriptor->info.manufacture_id, descriptor->info.device_type, data_id);
 
-    return _write_data(data_id, false, offset, chunk, chunk_sz);
+    ret_code = _write_buffer_save(data_id, chunk, chunk_sz, offset);
+
+    if (VS_CODE_OK == ret_code) {
+        _running_hash_update(descriptor, chunk, chunk_sz, offset);
+    } else if (_is_running_hash_for(descriptor)) {
+        _running_hash.active = false;
+    }
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_flush_firmware_chunks(void) {
+    vs_storage_file_t f;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.open, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.sync, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.close, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (_write_buffer.active && _write_buffer.used) {
+        return _write_buffer_flush(true);
+    }
+
+    if (!_write_buffer.dirty) {
+        return VS_CODE_OK;
+    }
+
+    // Sync data that has been written by previous flushes
+    f = _storage_ctx->impl_func.open(_storage_ctx->impl_data, _write_buffer.data_id);
+    CHECK_RET(NULL != f, VS_CODE_ERR_FILE, "Can't open file");
+
+    ret_code = _storage_ctx->impl_func.sync(_storage_ctx->impl_data, f);
+    _storage_ctx->impl_func.close(_storage_ctx->impl_data, f);
+    CHECK_RET(VS_CODE_OK == ret_code, ret_code, "Can't sync file");
+
+    _write_buffer.dirty = false;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_flush_expired_chunks(void) {
+    return _is_write_buffer_expired() ? _write_buffer_flush(false) : VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_check_footer_size(const uint8_t *footer, size_t footer_sz) {
+    uint8_t i;
+    int key_len;
+    int sign_len;
+    size_t used_sz = sizeof(vs_firmware_footer_t);
+    const vs_firmware_footer_t *f = (const vs_firmware_footer_t *)footer;
+
+    CHECK_NOT_ZERO_RET(footer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(footer_sz >= sizeof(vs_firmware_footer_t),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Footer size %u is less than %u",
+              (uint32_t)footer_sz,
+              (uint32_t)sizeof(vs_firmware_footer_t));
+
+    for (i = 0; i < f->signatures_count; ++i) {
+        const vs_sign_t *sign = (const vs_sign_t *)(footer + used_sz);
+
+        CHECK_RET(used_sz + sizeof(vs_sign_t) <= footer_sz,
+                  VS_CODE_ERR_INCORRECT_ARGUMENT,
+                  "Footer signature is outside of footer");
+
+        sign_len = vs_secmodule_get_signature_len(sign->ec_type);
+        key_len = vs_secmodule_get_pubkey_len(sign->ec_type);
+
+        CHECK_RET(sign_len > 0 && key_len > 0, VS_CODE_ERR_INCORRECT_ARGUMENT, "Unsupported signature ec_type");
+
+        used_sz += sizeof(vs_sign_t) + sign_len + key_len;
+        CHECK_RET(used_sz <= footer_sz, VS_CODE_ERR_INCORRECT_ARGUMENT, "Footer signature is outside of footer");
+    }
+
+    return VS_CODE_OK;
 }
 
 /*************************************************************************/
@@ -228,6 +826,7 @@ vs_status_e
 vs_firmware_save_firmware_footer(const vs_firmware_descriptor_t *descriptor, const uint8_t *footer) {
     uint8_t i;
     vs_storage_element_id_t data_id;
+    vs_status_e ret_code;
     size_t footer_sz = sizeof(vs_firmware_footer_t);
     vs_firmware_footer_t *f = (vs_firmware_footer_t *)footer;
 
@@ -250,7 +849,23 @@ vs_firmware_save_firmware_footer(const vs_firmware_descriptor_t *descriptor, con
         footer_sz += sizeof(vs_sign_t) + sign_len + key_len;
     }
 
-    return _write_data(data_id, true, descriptor->firmware_length, footer, footer_sz);
+    ret_code = _write_buffer_flush_for(data_id);
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = vs_firmware_write_data(data_id, true, descriptor->firmware_length, footer, footer_sz);
+    }
+
+    if (VS_CODE_OK == ret_code && 0 == VS_IOT_MEMCMP(_write_buffer.data_id, data_id, sizeof(vs_storage_element_id_t))) {
+        _write_buffer.dirty = false;
+    }
+
+    if (VS_CODE_OK == ret_code) {
+        _running_hash_finish(descriptor, footer, footer_sz);
+    } else if (_is_running_hash_for(descriptor)) {
+        _running_hash.active = false;
+    }
+
+    return ret_code;
 }
 
 /*************************************************************************/
@@ -261,6 +876,7 @@ vs_firmware_load_firmware_footer(const vs_firmware_descriptor_t *descriptor,
                                  size_t *data_sz) {
     ssize_t file_sz;
     vs_storage_element_id_t data_id;
+    vs_status_e ret_code;
 
     CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
@@ -270,7 +886,9 @@ vs_firmware_load_firmware_footer(const vs_firmware_descriptor_t *descriptor,
     // cppcheck-suppress uninitvar
     _create_data_filename(descriptor->info.manufacture_id, descriptor->info.device_type, data_id);
 
-    file_sz = _storage_ctx->impl_func.size(_storage_ctx->impl_data, data_id);
+    STATUS_CHECK_RET(_write_buffer_flush_for(data_id), "Can't write buffered firmware data");
+
+    file_sz = vs_firmware_data_size(data_id);
 
     if (file_sz > 0) {
 
@@ -280,82 +898,85 @@ vs_firmware_load_firmware_footer(const vs_firmware_descriptor_t *descriptor,
         *data_sz = footer_sz;
         CHECK_RET(footer_sz <= buff_sz, VS_CODE_ERR_FILE, "Buffer to small");
 
-        return _read_data(data_id, descriptor->firmware_length, data, footer_sz, data_sz);
+        return vs_firmware_read_data(data_id, descriptor->firmware_length, data, footer_sz, data_sz);
     }
     return VS_CODE_ERR_FILE_READ;
 }
 
 /*************************************************************************/
-vs_status_e
-vs_firmware_save_firmware_descriptor(const vs_firmware_descriptor_t *descriptor) {
-    ssize_t file_sz;
-    vs_storage_element_id_t desc_id;
-    uint8_t *buf = NULL;
-    uint8_t *newbuf = NULL;
-    uint32_t offset = 0;
-    int res;
-
-    CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+static void
+_reserve_firmware_data(const vs_firmware_descriptor_t *descriptor) {
+    vs_storage_element_id_t data_id;
+    int footer_sz;
+    size_t reserve_sz;
 
-    // cppcheck-suppress uninitvar
-    _create_descriptors_filename(desc_id);
+    if (!_storage_ctx->impl_func.reserve) {
+        return;
+    }
 
-    file_sz = _storage_ctx->impl_func.size(_storage_ctx->impl_data, desc_id);
+    footer_sz = vs_firmware_get_expected_footer_len();
+    reserve_sz = descriptor->firmware_length + (footer_sz > 0 ? footer_sz : 0);
 
-    if (file_sz > 0) {
-        size_t read_sz;
-        buf = VS_IOT_CALLOC(1, file_sz);
-        CHECK_NOT_ZERO_RET(buf, VS_CODE_ERR_NO_MEMORY);
+    // cppcheck-suppress uninitvar
+    _create_data_filename(descriptor->info.manufacture_id, descriptor->info.device_type, data_id);
 
-        if (VS_CODE_OK != _read_data(desc_id, 0, buf, file_sz, &read_sz)) {
-            VS_IOT_FREE(buf);
-            return VS_CODE_ERR_FILE_READ;
-        }
+    // Space reservation is an optimization only, so download is continued without it
+    if (VS_CODE_OK != _storage_ctx->impl_func.reserve(_storage_ctx->impl_data, data_id, reserve_sz)) {
+        VS_LOG_WARNING("Can't reserve storage space for firmware image");
+    }
+}
 
-        while (offset < file_sz) {
-            if (offset + sizeof(vs_firmware_descriptor_t) > file_sz) {
-                file_sz = offset;
-                break;
-            }
+/*************************************************************************/
+vs_status_e
+vs_firmware_save_firmware_descriptor(const vs_firmware_descriptor_t *descriptor) {
+    size_t slot;
+    vs_status_e ret_code;
 
-            vs_firmware_descriptor_t *ptr = (vs_firmware_descriptor_t *)(buf + offset);
+    CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(!_is_descriptor_slot_free(descriptor), VS_CODE_ERR_INCORRECT_ARGUMENT, "Empty firmware descriptor");
 
-            if (0 == memcmp(ptr->info.manufacture_id, descriptor->info.manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE) &&
-                0 == memcmp(ptr->info.device_type, descriptor->info.device_type, VS_DEVICE_TYPE_SIZE)) {
-                VS_IOT_MEMCPY(ptr, descriptor, sizeof(vs_firmware_descriptor_t));
-                newbuf = buf;
-                goto save_data;
-            }
+    // Update descriptor in place
+    if (_find_descriptor_slot(descriptor->info.manufacture_id, descriptor->info.device_type, &slot)) {
+        if (0 == VS_IOT_MEMCMP(&_descriptors[slot], descriptor, sizeof(vs_firmware_descriptor_t))) {
+            return VS_CODE_OK;
+        }
+        STATUS_CHECK_RET(_save_descriptor_slot(slot, descriptor), "Can't save firmware descriptor");
+        _reserve_firmware_data(descriptor);
+        return VS_CODE_OK;
+    }
 
-            offset += sizeof(vs_firmware_descriptor_t);
+    // Reuse free slot
+    for (slot = 0; slot < _descriptors_count; ++slot) {
+        if (_is_descriptor_slot_free(&_descriptors[slot])) {
+            STATUS_CHECK_RET(_save_descriptor_slot(slot, descriptor), "Can't save firmware descriptor");
+            _reserve_firmware_data(descriptor);
+            return VS_CODE_OK;
         }
+    }
 
-        newbuf = VS_IOT_CALLOC(1, file_sz + sizeof(vs_firmware_descriptor_t));
+    // Append new slot
+    if (_descriptors_count == _descriptors_capacity) {
+        size_t capacity = _descriptors_capacity + VS_FW_DESCRIPTORS_GROW_STEP;
+        vs_firmware_descriptor_t *descriptors = VS_IOT_CALLOC(capacity, sizeof(vs_firmware_descriptor_t));
+        CHECK_NOT_ZERO_RET(descriptors, VS_CODE_ERR_NO_MEMORY);
 
-        if (NULL == newbuf) {
-            VS_IOT_FREE(buf);
-            return VS_CODE_ERR_NO_MEMORY;
+        if (_descriptors_count) {
+            VS_IOT_MEMCPY(descriptors, _descriptors, _descriptors_count * sizeof(vs_firmware_descriptor_t));
         }
+        VS_IOT_FREE(_descriptors);
+        _descriptors = descriptors;
+        _descriptors_capacity = capacity;
+    }
 
-        VS_IOT_MEMCPY(newbuf, buf, file_sz);
-        VS_IOT_MEMCPY(newbuf + file_sz, descriptor, sizeof(vs_firmware_descriptor_t));
-        file_sz += sizeof(vs_firmware_descriptor_t);
-
-        VS_IOT_FREE(buf);
-    } else {
-        file_sz = sizeof(vs_firmware_descriptor_t);
-        newbuf = VS_IOT_CALLOC(1, file_sz);
-        CHECK_NOT_ZERO_RET(newbuf, VS_CODE_ERR_NO_MEMORY);
-        VS_IOT_MEMCPY(newbuf, (uint8_t *)descriptor, file_sz);
+    if (VS_CODE_OK != _save_descriptor_slot(_descriptors_count, descriptor)) {
+        return VS_CODE_ERR_FILE_WRITE;
     }
+    _descriptors_count++;
 
-save_data:
-    res = _write_data(desc_id, true, 0, newbuf, file_sz);
-    VS_IOT_FREE(newbuf);
+    _reserve_firmware_data(descriptor);
 
-    return res;
+    return VS_CODE_OK;
 }
 
 /*************************************************************************/
@@ -363,69 +984,32 @@ vs_status_e
 vs_firmware_load_firmware_descriptor(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
                                      const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
                                      vs_firmware_descriptor_t *descriptor) {
-
-    vs_storage_element_id_t desc_id;
-    int res = VS_CODE_ERR_NOT_FOUND;
-    ssize_t file_sz;
-    uint8_t *buf = NULL;
-    uint32_t offset = 0;
+    size_t slot;
 
     CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
 
     VS_IOT_MEMSET(descriptor, 0, sizeof(*descriptor));
 
-    // cppcheck-suppress uninitvar
-    _create_descriptors_filename(desc_id);
-
-    file_sz = _storage_ctx->impl_func.size(_storage_ctx->impl_data, desc_id);
-
-    if (file_sz <= 0) {
-        goto terminate;
-    }
-
-    size_t read_sz;
-    buf = VS_IOT_CALLOC(1, file_sz);
-    CHECK_NOT_ZERO_RET(buf, VS_CODE_ERR_NO_MEMORY);
-
-    if (VS_CODE_OK != _read_data(desc_id, 0, buf, file_sz, &read_sz)) {
-        res = VS_CODE_ERR_FILE_READ;
-        goto terminate;
-    }
-
-    while (offset + sizeof(vs_firmware_descriptor_t) <= file_sz) {
-        vs_firmware_descriptor_t *ptr = (vs_firmware_descriptor_t *)(buf + offset);
-
-        if (0 == memcmp(ptr->info.manufacture_id, manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE) &&
-            0 == memcmp(ptr->info.device_type, device_type, VS_DEVICE_TYPE_SIZE)) {
-            VS_IOT_MEMCPY(descriptor, ptr, sizeof(vs_firmware_descriptor_t));
-            res = VS_CODE_OK;
-            break;
-        }
-
-        offset += sizeof(vs_firmware_descriptor_t);
+    if (!_find_descriptor_slot(manufacture_id, device_type, &slot)) {
+        return VS_CODE_ERR_NOT_FOUND;
     }
 
-terminate:
-    VS_IOT_FREE(buf);
+    VS_IOT_MEMCPY(descriptor, &_descriptors[slot], sizeof(vs_firmware_descriptor_t));
 
-    return res;
+    return VS_CODE_OK;
 }
 
 /*************************************************************************/
 vs_status_e
 vs_firmware_delete_firmware(const vs_firmware_descriptor_t *descriptor) {
     int res = VS_CODE_ERR_NOT_FOUND;
-    ssize_t file_sz;
+    size_t slot;
     vs_storage_element_id_t desc_id;
     vs_storage_element_id_t data_id;
 
-    uint8_t *buf = NULL;
-
     CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
-    CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(_storage_ctx->impl_func.del, VS_CODE_ERR_NULLPTR_ARGUMENT);
 
     // cppcheck-suppress uninitvar
@@ -433,70 +1017,49 @@ vs_firmware_delete_firmware(const vs_firmware_descriptor_t *descriptor) {
     // cppcheck-suppress uninitvar
     _create_data_filename(descriptor->info.manufacture_id, descriptor->info.device_type, data_id);
 
-    file_sz = _storage_ctx->impl_func.size(_storage_ctx->impl_data, desc_id);
-
-    if (file_sz <= 0) {
-        goto terminate;
-    }
-
-    size_t read_sz;
-    uint32_t offset = 0;
-    buf = VS_IOT_CALLOC(1, file_sz);
-    CHECK_NOT_ZERO_RET(buf, VS_CODE_ERR_NO_MEMORY);
-
-    if (VS_CODE_OK != _read_data(desc_id, 0, buf, file_sz, &read_sz)) {
-        res = VS_CODE_ERR_FILE_READ;
-        goto terminate;
+    if (_running_hash.active &&
+        0 == VS_IOT_MEMCMP(_running_hash.descriptor.info.manufacture_id,
+                           descriptor->info.manufacture_id,
+                           VS_DEVICE_MANUFACTURE_ID_SIZE) &&
+        0 == VS_IOT_MEMCMP(_running_hash.descriptor.info.device_type,
+                           descriptor->info.device_type,
+                           VS_DEVICE_TYPE_SIZE)) {
+        _running_hash.active = false;
     }
 
-    while (offset < file_sz || offset + sizeof(vs_firmware_descriptor_t) > file_sz) {
-        vs_firmware_descriptor_t *ptr = (vs_firmware_descriptor_t *)(buf + offset);
-
-        if (0 == memcmp(ptr->info.manufacture_id, descriptor->info.manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE) &&
-            0 == memcmp(ptr->info.device_type, descriptor->info.device_type, VS_DEVICE_TYPE_SIZE)) {
-            VS_IOT_MEMMOVE(buf + offset,
-                           buf + offset + sizeof(vs_firmware_descriptor_t),
-                           file_sz - offset - sizeof(vs_firmware_descriptor_t));
-            file_sz -= sizeof(vs_firmware_descriptor_t);
-            break;
-        }
-        offset += sizeof(vs_firmware_descriptor_t);
+    // Buffered data is not needed anymore
+    if (0 == VS_IOT_MEMCMP(_write_buffer.data_id, data_id, sizeof(vs_storage_element_id_t))) {
+        _write_buffer.active = false;
+        _write_buffer.dirty = false;
+        _write_buffer.used = 0;
     }
 
-    if (VS_CODE_OK != _storage_ctx->impl_func.del(_storage_ctx->impl_data, desc_id)) {
-        res = VS_CODE_ERR_FILE_DELETE;
+    if (!_descriptors_count) {
         goto terminate;
     }
 
     res = VS_CODE_OK;
-    if (file_sz) {
-        res = _write_data(desc_id, true, 0, buf, file_sz);
+    if (_find_descriptor_slot(descriptor->info.manufacture_id, descriptor->info.device_type, &slot)) {
+        res = _save_descriptor_slot(slot, &_free_descriptor_slot);
     }
 
-terminate:
-    if (buf) {
-        VS_IOT_FREE(buf);
+    // Remove descriptors file if there are no descriptors
+    if (VS_CODE_OK == res && !_has_descriptors()) {
+        if (VS_CODE_OK != _storage_ctx->impl_func.del(_storage_ctx->impl_data, desc_id)) {
+            res = VS_CODE_ERR_FILE_DELETE;
+        } else {
+            _descriptors_count = 0;
+        }
     }
 
-    if (VS_CODE_OK != _storage_ctx->impl_func.del(_storage_ctx->impl_data, data_id)) {
+terminate:
+    if (VS_CODE_OK != vs_firmware_delete_data(data_id)) {
         return VS_CODE_ERR_FILE_DELETE;
     }
 
     return res;
 }
 
-/******************************************************************************/
-static bool
-_is_rule_equal_to(vs_key_type_e type) {
-    uint8_t i;
-    for (i = 0; i < VS_FW_SIGNATURES_QTY; ++i) {
-        if (sign_rules_list[i] == type) {
-            return true;
-        }
-    }
-    return false;
-}
-
 /*************************************************************************/
 int
 vs_firmware_get_expected_footer_len(void) {
@@ -523,18 +1086,128 @@ vs_firmware_get_own_firmware_descriptor(vs_firmware_descriptor_t *descriptor) {
     return VS_CODE_OK;
 }
 
+/*************************************************************************/
+vs_status_e
+vs_firmware_verify_hash_signatures(const uint8_t *hash,
+                                   const uint8_t *signatures,
+                                   uint8_t signatures_count,
+                                   size_t signatures_sz) {
+    vs_status_e res = vs_provision_verify_hash_signatures(
+            hash, signatures, signatures_count, signatures_sz, sign_rules_list, VS_FW_SIGNATURES_QTY);
+
+    VS_LOG_DEBUG("New FW Image. Sign rules is %s", VS_CODE_OK == res ? "correct" : "wrong");
+
+    return res;
+}
+
+/*************************************************************************/
+static bool
+_can_read_async(const vs_storage_element_id_t data_id) {
+    if (!_storage_ctx->impl_func.submit || !_storage_ctx->impl_func.complete) {
+        return false;
+    }
+
+#if FIRMWARE_DEDUP
+    if (vs_firmware_dedup_is_packed(data_id)) {
+        return false;
+    }
+#endif // FIRMWARE_DEDUP
+
+    return true;
+}
+
+/*************************************************************************/
+static vs_status_e
+_submit_chunk_read(const vs_firmware_descriptor_t *descriptor,
+                   vs_storage_file_t f,
+                   vs_storage_request_t *request,
+                   uint8_t *buf,
+                   uint32_t offset) {
+    uint32_t fw_rest = descriptor->firmware_length - offset;
+
+    VS_IOT_MEMSET(request, 0, sizeof(*request));
+    request->offset = offset;
+    request->data = buf;
+    request->data_sz = fw_rest > descriptor->chunk_size ? descriptor->chunk_size : fw_rest;
+
+    return _storage_ctx->impl_func.submit(_storage_ctx->impl_data, f, request);
+}
+
+/*************************************************************************/
+// Next firmware chunk is being read while the current one is being hashed
+static vs_status_e
+_hash_firmware_async(const vs_firmware_descriptor_t *descriptor,
+                     const vs_storage_element_id_t data_id,
+                     vs_secmodule_sw_sha256_ctx *hash_ctx) {
+    vs_storage_request_t requests[2];
+    bool pending[2] = {false, false};
+    uint8_t *bufs;
+    vs_storage_file_t f;
+    uint32_t offset = 0;
+    uint32_t next_offset;
+    size_t cur = 0;
+    size_t next;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(descriptor->chunk_size, VS_CODE_ERR_INCORRECT_ARGUMENT);
+
+    bufs = VS_IOT_MALLOC(2 * descriptor->chunk_size);
+    CHECK_NOT_ZERO_RET(bufs, VS_CODE_ERR_NO_MEMORY);
+
+    f = _storage_ctx->impl_func.open(_storage_ctx->impl_data, data_id);
+    if (!f) {
+        VS_IOT_FREE(bufs);
+        VS_LOG_ERROR("Can't open file");
+        return VS_CODE_ERR_FILE;
+    }
+
+    ret_code = _submit_chunk_read(descriptor, f, &requests[cur], bufs, offset);
+    pending[cur] = VS_CODE_OK == ret_code;
+
+    while (VS_CODE_OK == ret_code && offset < descriptor->firmware_length) {
+        next = cur ^ 1;
+        next_offset = offset + requests[cur].data_sz;
+
+        if (next_offset < descriptor->firmware_length) {
+            ret_code = _submit_chunk_read(
+                    descriptor, f, &requests[next], &bufs[next * descriptor->chunk_size], next_offset);
+            pending[next] = VS_CODE_OK == ret_code;
+            if (VS_CODE_OK != ret_code) {
+                break;
+            }
+        }
+
+        ret_code = _storage_ctx->impl_func.complete(_storage_ctx->impl_data, &requests[cur]);
+        pending[cur] = false;
+        if (VS_CODE_OK != ret_code) {
+            break;
+        }
+
+        _secmodule->hash_update(hash_ctx, requests[cur].data, requests[cur].data_sz);
+
+        offset = next_offset;
+        cur = next;
+    }
+
+    // Requests must be finished before file close
+    for (cur = 0; cur < 2; ++cur) {
+        if (pending[cur]) {
+            _storage_ctx->impl_func.complete(_storage_ctx->impl_data, &requests[cur]);
+        }
+    }
+
+    _storage_ctx->impl_func.close(_storage_ctx->impl_data, f);
+    VS_IOT_FREE(bufs);
+
+    return ret_code;
+}
+
 /*************************************************************************/
 vs_status_e
 vs_firmware_verify_firmware(const vs_firmware_descriptor_t *descriptor) {
     vs_storage_element_id_t data_id;
     ssize_t file_sz;
-    uint8_t *pubkey;
-    int sign_len;
-    int key_len;
-    uint8_t sign_rules = 0;
-    uint16_t i;
     vs_secmodule_sw_sha256_ctx hash_ctx;
-    vs_status_e ret_code;
 
     // TODO: Need to support all hash types
     uint8_t hash[VS_HASH_SHA256_LEN];
@@ -548,7 +1221,11 @@ vs_firmware_verify_firmware(const vs_firmware_descriptor_t *descriptor) {
     // cppcheck-suppress uninitvar
     _create_data_filename(descriptor->info.manufacture_id, descriptor->info.device_type, data_id);
 
-    file_sz = _storage_ctx->impl_func.size(_storage_ctx->impl_data, data_id);
+    if (VS_CODE_OK != _write_buffer_flush_for(data_id)) {
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    file_sz = vs_firmware_data_size(data_id);
 
     if (file_sz <= 0) {
         return VS_CODE_ERR_FILE;
@@ -557,6 +1234,24 @@ vs_firmware_verify_firmware(const vs_firmware_descriptor_t *descriptor) {
     int32_t footer_sz = file_sz - descriptor->firmware_length;
     CHECK_RET(footer_sz > 0 && footer_sz < UINT16_MAX, VS_CODE_ERR_FORMAT_OVERFLOW, "Incorrect footer size");
 
+    // Firmware has been hashed while it was being saved
+    if (_is_running_hash_for(descriptor) && _running_hash.finished && _running_hash.footer_sz == footer_sz) {
+        uint8_t footer_buf[footer_sz];
+        vs_firmware_footer_t *saved_footer = (vs_firmware_footer_t *)footer_buf;
+        size_t footer_read_sz;
+
+        _running_hash.active = false;
+
+        if (VS_CODE_OK != vs_firmware_load_firmware_footer(descriptor, footer_buf, footer_sz, &footer_read_sz)) {
+            return VS_CODE_ERR_FILE_READ;
+        }
+
+        return vs_firmware_verify_hash_signatures(_running_hash.hash,
+                                                  saved_footer->signatures,
+                                                  saved_footer->signatures_count,
+                                                  footer_sz - sizeof(vs_firmware_footer_t));
+    }
+
     uint8_t buf[descriptor->chunk_size < footer_sz ? footer_sz : descriptor->chunk_size];
     vs_firmware_footer_t *footer = (vs_firmware_footer_t *)buf;
     uint32_t offset = 0;
@@ -565,6 +1260,13 @@ vs_firmware_verify_firmware(const vs_firmware_descriptor_t *descriptor) {
     _secmodule->hash_init(&hash_ctx);
 
     // Update hash by firmware
+    if (_can_read_async(data_id)) {
+        CHECK_RET(VS_CODE_OK == _hash_firmware_async(descriptor, data_id, &hash_ctx),
+                  VS_CODE_ERR_FILE_READ,
+                  "Can't read firmware");
+        offset = descriptor->firmware_length;
+    }
+
     while (offset < descriptor->firmware_length) {
         uint32_t fw_rest = descriptor->firmware_length - offset;
         uint32_t required_chunk_size = fw_rest > descriptor->chunk_size ? descriptor->chunk_size : fw_rest;
@@ -580,15 +1282,9 @@ vs_firmware_verify_firmware(const vs_firmware_descriptor_t *descriptor) {
     // Calculate fill size
     uint32_t fill_sz = descriptor->app_size - descriptor->firmware_length;
     CHECK_RET(footer_sz <= fill_sz, VS_CODE_ERR_INCORRECT_PARAMETER, "Bad fill size of image");
-    fill_sz -= footer_sz;
-    VS_IOT_MEMSET(buf, 0xFF, descriptor->chunk_size > fill_sz ? fill_sz : descriptor->chunk_size);
 
     // Update hash by fill
-    while (fill_sz) {
-        uint16_t sz = descriptor->chunk_size > fill_sz ? fill_sz : descriptor->chunk_size;
-        _secmodule->hash_update(&hash_ctx, buf, sz);
-        fill_sz -= sz;
-    }
+    _hash_fill(&hash_ctx, fill_sz - footer_sz);
 
     // Update hash by footer
     if (VS_CODE_OK != vs_firmware_load_firmware_footer(descriptor, buf, footer_sz, &read_sz)) {
@@ -598,44 +1294,8 @@ vs_firmware_verify_firmware(const vs_firmware_descriptor_t *descriptor) {
     _secmodule->hash_update(&hash_ctx, buf, sizeof(vs_firmware_footer_t));
     _secmodule->hash_finish(&hash_ctx, hash);
 
-    // First signature
-    vs_sign_t *sign = (vs_sign_t *)footer->signatures;
-
-    CHECK_RET(footer->signatures_count >= VS_FW_SIGNATURES_QTY, VS_CODE_ERR_FILE, "There are not enough signatures");
-
-    for (i = 0; i < footer->signatures_count; ++i) {
-        CHECK_RET(sign->hash_type == VS_HASH_SHA_256, VS_CODE_ERR_UNSUPPORTED, "Unsupported hash size for sign FW");
-
-        sign_len = vs_secmodule_get_signature_len(sign->ec_type);
-        key_len = vs_secmodule_get_pubkey_len(sign->ec_type);
-
-        CHECK_RET(sign_len > 0 && key_len > 0, VS_CODE_ERR_UNSUPPORTED, "Unsupported signature ec_type");
-
-        // Signer raw key pointer
-        pubkey = sign->raw_sign_pubkey + (uint16_t)sign_len;
-
-        STATUS_CHECK_RET(vs_provision_search_hl_pubkey(sign->signer_type, sign->ec_type, pubkey, (uint16_t)key_len),
-                         "Signer key is wrong");
-
-        if (_is_rule_equal_to(sign->signer_type)) {
-            STATUS_CHECK_RET(_secmodule->ecdsa_verify(sign->ec_type,
-                                                      pubkey,
-                                                      (uint16_t)key_len,
-                                                      sign->hash_type,
-                                                      hash,
-                                                      sign->raw_sign_pubkey,
-                                                      (uint16_t)sign_len),
-                             "Signature is wrong");
-            sign_rules++;
-        }
-
-        // Next signature
-        sign = (vs_sign_t *)(pubkey + (uint16_t)key_len);
-    }
-
-    VS_LOG_DEBUG("New FW Image. Sign rules is %s", sign_rules >= VS_FW_SIGNATURES_QTY ? "correct" : "wrong");
-
-    return sign_rules >= VS_FW_SIGNATURES_QTY ? VS_CODE_OK : VS_CODE_ERR_VERIFY;
+    return vs_firmware_verify_hash_signatures(
+            hash, footer->signatures, footer->signatures_count, footer_sz - sizeof(vs_firmware_footer_t));
 }
 
 /*************************************************************************/
@@ -687,7 +1347,11 @@ vs_firmware_install_firmware(const vs_firmware_descriptor_t *descriptor) {
     // cppcheck-suppress uninitvar
     _create_data_filename(descriptor->info.manufacture_id, descriptor->info.device_type, data_id);
 
-    file_sz = _storage_ctx->impl_func.size(_storage_ctx->impl_data, data_id);
+    if (VS_CODE_OK != _write_buffer_flush_for(data_id)) {
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    file_sz = vs_firmware_data_size(data_id);
 
     if (file_sz <= 0) {
         return VS_CODE_ERR_FILE;
@@ -787,3 +1451,55 @@ vs_firmware_hton_header(vs_firmware_header_t *header) {
 }
 
 /*************************************************************************/
+
+#if FIRMWARE_CUT_THROUGH
+/*************************************************************************/
+vs_status_e
+vs_firmware_relay_start(const vs_firmware_descriptor_t *descriptor) {
+    CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&_relay_mutex);
+    // cppcheck-suppress uninitvar
+    _create_data_filename(descriptor->info.manufacture_id, descriptor->info.device_type, _relay.data_id);
+    _relay.firmware_length = descriptor->firmware_length;
+    _relay.stored_sz = 0;
+    _relay.active = true;
+    pthread_mutex_unlock(&_relay_mutex);
+
+    VS_LOG_DEBUG("Start relay of firmware with %u bytes", descriptor->firmware_length);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+void
+vs_firmware_relay_stop(void) {
+    pthread_mutex_lock(&_relay_mutex);
+    _relay.active = false;
+    pthread_mutex_unlock(&_relay_mutex);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_relay_available(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                            const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                            uint32_t *available_sz,
+                            bool *is_complete) {
+    vs_storage_element_id_t data_id;
+
+    CHECK_NOT_ZERO_RET(available_sz, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(is_complete, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // cppcheck-suppress uninitvar
+    _create_data_filename(manufacture_id, device_type, data_id);
+
+    pthread_mutex_lock(&_relay_mutex);
+    *is_complete = !_relay.active || 0 != VS_IOT_MEMCMP(_relay.data_id, data_id, sizeof(vs_storage_element_id_t));
+    if (!*is_complete) {
+        *available_sz = _relay.stored_sz;
+    }
+    pthread_mutex_unlock(&_relay_mutex);
+
+    return VS_CODE_OK;
+}
+#endif // FIRMWARE_CUT_THROUGH
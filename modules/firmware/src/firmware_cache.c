@@ -0,0 +1,903 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+#if FIRMWARE_CACHE
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include <stdlib-config.h>
+#include <update-config.h>
+
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_cache.h>
+#include <virgil/iot/firmware/firmware_dedup.h>
+#include <virgil/iot/storage_hal/storage_hal.h>
+#include <virgil/iot/logger/logger.h>
+
+#include "private/firmware-private.h"
+
+#define CACHE_FILENAME "firmware_cache"
+#define PREVIOUS_FILENAME_SUFFIX "v"
+
+// Firmware is copied by blocks of this size
+#define CACHE_COPY_BLOCK_SZ (1024)
+
+// State with requests statistics is saved each time this amount of requests has been counted
+#define CACHE_SAVE_REQUESTS_PERIOD (64)
+
+#define CACHE_IMAGE_USED (1 << 0)
+#define CACHE_IMAGE_PREVIOUS (1 << 1)
+#define CACHE_IMAGE_PINNED (1 << 2)
+#define CACHE_IMAGE_RESERVED (1 << 3) // The same version is being downloaded again
+
+typedef struct __attribute__((__packed__)) {
+    vs_firmware_descriptor_t descriptor; // Host byte order
+    uint8_t flags;
+    uint32_t hits;
+    uint32_t last_request;
+} vs_firmware_cache_image_t;
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t clock; // Incremented by each request, it orders images for LRU policy
+    uint32_t requests;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    vs_firmware_cache_image_t images[VS_FIRMWARE_CACHE_IMAGES_MAX];
+} vs_firmware_cache_state_t;
+
+static vs_firmware_cache_state_t _state;
+static size_t _quota = 0;
+static vs_firmware_cache_policy_e _policy = VS_FIRMWARE_CACHE_LRU;
+static bool _ready = false;
+
+// Cloud thread stores firmware while FLDT server thread counts requests
+static pthread_mutex_t _cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*************************************************************************/
+static void
+_create_cache_filename(vs_storage_element_id_t id) {
+    VS_IOT_MEMSET(id, 0, sizeof(vs_storage_element_id_t));
+    VS_IOT_MEMCPY(&id[0], CACHE_FILENAME, sizeof(CACHE_FILENAME));
+}
+
+/*************************************************************************/
+static void
+_create_previous_filename(const vs_firmware_descriptor_t *descriptor, vs_storage_element_id_t id) {
+    size_t pos = VS_DEVICE_MANUFACTURE_ID_SIZE + VS_DEVICE_TYPE_SIZE;
+
+    VS_IOT_MEMSET(id, 0, sizeof(vs_storage_element_id_t));
+    VS_IOT_MEMCPY(&id[0], descriptor->info.manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE);
+    VS_IOT_MEMCPY(&id[VS_DEVICE_MANUFACTURE_ID_SIZE], descriptor->info.device_type, VS_DEVICE_TYPE_SIZE);
+    VS_IOT_MEMCPY(&id[pos], PREVIOUS_FILENAME_SUFFIX, sizeof(PREVIOUS_FILENAME_SUFFIX) - 1);
+    pos += sizeof(PREVIOUS_FILENAME_SUFFIX) - 1;
+
+    VS_IOT_ASSERT(pos + sizeof(vs_file_version_t) <= sizeof(vs_storage_element_id_t));
+    VS_IOT_MEMCPY(&id[pos], &descriptor->info.version, sizeof(vs_file_version_t));
+}
+
+/*************************************************************************/
+static size_t
+_image_size(const vs_firmware_descriptor_t *descriptor) {
+    return descriptor->app_size > descriptor->firmware_length ? descriptor->app_size : descriptor->firmware_length;
+}
+
+/*************************************************************************/
+static int
+_find_image(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+            const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+            const vs_file_version_t *version,
+            bool previous) {
+    const vs_firmware_cache_image_t *image;
+    int i;
+
+    for (i = 0; i < VS_FIRMWARE_CACHE_IMAGES_MAX; ++i) {
+        image = &_state.images[i];
+
+        if ((image->flags & CACHE_IMAGE_USED) && previous == !!(image->flags & CACHE_IMAGE_PREVIOUS) &&
+            0 == VS_IOT_MEMCMP(image->descriptor.info.manufacture_id, manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE) &&
+            0 == VS_IOT_MEMCMP(image->descriptor.info.device_type, device_type, VS_DEVICE_TYPE_SIZE) &&
+            (!version || 0 == VS_IOT_MEMCMP(&image->descriptor.info.version, version, sizeof(vs_file_version_t)))) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*************************************************************************/
+static size_t
+_used_size(void) {
+    size_t used = 0;
+    int i;
+
+    for (i = 0; i < VS_FIRMWARE_CACHE_IMAGES_MAX; ++i) {
+        if (_state.images[i].flags & CACHE_IMAGE_USED) {
+            used += _image_size(&_state.images[i].descriptor);
+        }
+    }
+
+    return used;
+}
+
+/*************************************************************************/
+static vs_status_e
+_save_state(void) {
+    vs_storage_element_id_t id;
+
+    // cppcheck-suppress uninitvar
+    _create_cache_filename(id);
+
+    return vs_firmware_write_data(id, true, 0, &_state, sizeof(_state));
+}
+
+/*************************************************************************/
+static void
+_load_state(void) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_storage_element_id_t id;
+    size_t data_sz;
+
+    // cppcheck-suppress uninitvar
+    _create_cache_filename(id);
+
+    VS_IOT_MEMSET(&_state, 0, sizeof(_state));
+
+    if (storage->impl_func.size(storage->impl_data, id) != (ssize_t)sizeof(_state)) {
+        return;
+    }
+
+    if (VS_CODE_OK != vs_firmware_read_data(id, 0, (uint8_t *)&_state, sizeof(_state), &data_sz) ||
+        data_sz != sizeof(_state)) {
+        VS_LOG_WARNING("Unable to load firmware cache state");
+        VS_IOT_MEMSET(&_state, 0, sizeof(_state));
+    }
+}
+
+/*************************************************************************/
+static void
+_remove_image(int i, bool evicted) {
+    vs_firmware_cache_image_t *image = &_state.images[i];
+    vs_storage_element_id_t id;
+
+    if (image->flags & CACHE_IMAGE_PREVIOUS) {
+        // cppcheck-suppress uninitvar
+        _create_previous_filename(&image->descriptor, id);
+        if (VS_CODE_OK != vs_firmware_delete_data(id)) {
+            VS_LOG_WARNING("Unable to remove previous firmware version");
+        }
+    } else if (VS_CODE_OK != vs_firmware_delete_firmware(&image->descriptor)) {
+        VS_LOG_WARNING("Unable to remove firmware");
+    }
+
+    if (evicted) {
+        _state.evictions++;
+    }
+
+    VS_IOT_MEMSET(image, 0, sizeof(*image));
+}
+
+/*************************************************************************/
+static int
+_victim(int exclude) {
+    const vs_firmware_cache_image_t *image;
+    const vs_firmware_cache_image_t *victim = NULL;
+    int victim_idx = -1;
+    int i;
+
+    for (i = 0; i < VS_FIRMWARE_CACHE_IMAGES_MAX; ++i) {
+        image = &_state.images[i];
+
+        if (i == exclude || !(image->flags & CACHE_IMAGE_USED) ||
+            (image->flags & (CACHE_IMAGE_PINNED | CACHE_IMAGE_RESERVED))) {
+            continue;
+        }
+
+        if (victim && VS_FIRMWARE_CACHE_LFU == _policy && image->hits != victim->hits) {
+            if (image->hits > victim->hits) {
+                continue;
+            }
+        } else if (victim && image->last_request >= victim->last_request) {
+            continue;
+        }
+
+        victim = image;
+        victim_idx = i;
+    }
+
+    return victim_idx;
+}
+
+/*************************************************************************/
+static uint32_t
+_type_hits(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+           const uint8_t device_type[VS_DEVICE_TYPE_SIZE]) {
+    const vs_firmware_cache_image_t *image;
+    uint32_t hits = 0;
+    int i;
+
+    for (i = 0; i < VS_FIRMWARE_CACHE_IMAGES_MAX; ++i) {
+        image = &_state.images[i];
+
+        if ((image->flags & CACHE_IMAGE_USED) && image->hits > hits &&
+            0 == VS_IOT_MEMCMP(image->descriptor.info.manufacture_id, manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE) &&
+            0 == VS_IOT_MEMCMP(image->descriptor.info.device_type, device_type, VS_DEVICE_TYPE_SIZE)) {
+            hits = image->hits;
+        }
+    }
+
+    return hits;
+}
+
+/*************************************************************************/
+static vs_status_e
+_make_room(size_t size, int exclude) {
+    int victim;
+
+    while (_used_size() + size > _quota) {
+        victim = _victim(exclude);
+        CHECK_RET(victim >= 0, VS_CODE_ERR_NO_MEMORY, "Pinned firmware images don't leave room in cache");
+        _remove_image(victim, true);
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static int
+_free_image_slot(int exclude) {
+    int i;
+
+    for (i = 0; i < VS_FIRMWARE_CACHE_IMAGES_MAX; ++i) {
+        if (!(_state.images[i].flags & CACHE_IMAGE_USED)) {
+            return i;
+        }
+    }
+
+    i = _victim(exclude);
+    if (i >= 0) {
+        _remove_image(i, true);
+    }
+
+    return i;
+}
+
+/*************************************************************************/
+static int
+_track_active(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+              const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+              int exclude) {
+    vs_firmware_descriptor_t descriptor;
+    vs_firmware_cache_image_t *image;
+    int i = _find_image(manufacture_id, device_type, NULL, false);
+
+    // Firmware can be stored or removed by Firmware calls directly
+    if (VS_CODE_OK != vs_firmware_load_firmware_descriptor(manufacture_id, device_type, &descriptor)) {
+        if (i >= 0 && !(_state.images[i].flags & CACHE_IMAGE_RESERVED)) {
+            VS_IOT_MEMSET(&_state.images[i], 0, sizeof(_state.images[i]));
+        }
+        return -1;
+    }
+
+    if (i < 0) {
+        i = _free_image_slot(exclude);
+        if (i < 0) {
+            return -1;
+        }
+        image = &_state.images[i];
+        image->flags = CACHE_IMAGE_USED;
+        image->hits = 0;
+        image->last_request = _state.clock;
+    } else {
+        image = &_state.images[i];
+        if (0 != VS_IOT_MEMCMP(&image->descriptor, &descriptor, sizeof(descriptor))) {
+            image->flags &= ~CACHE_IMAGE_PINNED;
+            image->hits = 0;
+        }
+    }
+
+    VS_IOT_MEMCPY(&image->descriptor, &descriptor, sizeof(descriptor));
+
+    return i;
+}
+
+/*************************************************************************/
+static void
+_sync_images(void) {
+    vs_firmware_cache_image_t *image;
+    vs_storage_element_id_t id;
+    int i;
+
+    for (i = 0; i < VS_FIRMWARE_CACHE_IMAGES_MAX; ++i) {
+        image = &_state.images[i];
+
+        if (!(image->flags & CACHE_IMAGE_USED)) {
+            continue;
+        }
+
+        if (image->flags & CACHE_IMAGE_PREVIOUS) {
+            // cppcheck-suppress uninitvar
+            _create_previous_filename(&image->descriptor, id);
+            if (vs_firmware_data_size(id) <= (ssize_t)image->descriptor.firmware_length) {
+                VS_IOT_MEMSET(image, 0, sizeof(*image));
+            }
+        } else {
+            _track_active(image->descriptor.info.manufacture_id, image->descriptor.info.device_type, -1);
+        }
+    }
+}
+
+/*************************************************************************/
+static vs_status_e
+_load_footer(const vs_firmware_descriptor_t *descriptor, uint8_t **buf, size_t *buf_sz, size_t *footer_sz) {
+    vs_status_e ret_code = vs_firmware_load_firmware_footer(descriptor, *buf, *buf_sz, footer_sz);
+
+    // Footer with many signatures can be bigger than copy block
+    if (VS_CODE_OK != ret_code && *footer_sz > *buf_sz) {
+        VS_IOT_FREE(*buf);
+        *buf_sz = *footer_sz;
+        *buf = VS_IOT_MALLOC(*buf_sz);
+        CHECK_NOT_ZERO_RET(*buf, VS_CODE_ERR_NO_MEMORY);
+
+        ret_code = vs_firmware_load_firmware_footer(descriptor, *buf, *buf_sz, footer_sz);
+    }
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_copy_to_previous(const vs_firmware_descriptor_t *descriptor) {
+    vs_storage_element_id_t id;
+    size_t buf_sz = CACHE_COPY_BLOCK_SZ;
+    uint8_t *buf = VS_IOT_MALLOC(buf_sz);
+    uint32_t offset = 0;
+    size_t part_sz;
+    size_t data_sz = 0;
+    vs_status_e ret_code = VS_CODE_OK;
+
+    CHECK_NOT_ZERO_RET(buf, VS_CODE_ERR_NO_MEMORY);
+
+    // cppcheck-suppress uninitvar
+    _create_previous_filename(descriptor, id);
+    vs_firmware_delete_data(id);
+
+    while (VS_CODE_OK == ret_code && offset < descriptor->firmware_length) {
+        part_sz = descriptor->firmware_length - offset;
+        if (part_sz > buf_sz) {
+            part_sz = buf_sz;
+        }
+
+        ret_code = vs_firmware_load_firmware_chunk(descriptor, offset, buf, part_sz, &data_sz);
+        if (VS_CODE_OK == ret_code && data_sz != part_sz) {
+            ret_code = VS_CODE_ERR_FILE_READ;
+        }
+        if (VS_CODE_OK == ret_code) {
+            ret_code = vs_firmware_write_data(id, false, offset, buf, data_sz);
+        }
+        offset += data_sz;
+    }
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = _load_footer(descriptor, &buf, &buf_sz, &data_sz);
+    }
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = vs_firmware_write_data(id, true, descriptor->firmware_length, buf, data_sz);
+    }
+
+    VS_IOT_FREE(buf);
+
+    if (VS_CODE_OK != ret_code) {
+        vs_firmware_delete_data(id);
+        return ret_code;
+    }
+
+#if FIRMWARE_DEDUP
+    // Previous version shares most of its blocks with the active one
+    if (VS_CODE_OK != vs_firmware_dedup_pack(id, descriptor->firmware_length)) {
+        VS_LOG_WARNING("Unable to deduplicate previous firmware version");
+    }
+#endif // FIRMWARE_DEDUP
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_copy_from_previous(const vs_firmware_descriptor_t *descriptor) {
+    vs_storage_element_id_t id;
+    ssize_t file_sz;
+    size_t buf_sz;
+    uint8_t *buf;
+    uint32_t offset = 0;
+    size_t part_sz;
+    size_t data_sz = 0;
+    vs_status_e ret_code;
+
+    // cppcheck-suppress uninitvar
+    _create_previous_filename(descriptor, id);
+
+    file_sz = vs_firmware_data_size(id);
+    CHECK_RET(file_sz > (ssize_t)descriptor->firmware_length, VS_CODE_ERR_FILE, "Previous firmware is damaged");
+
+    // The last block is the footer
+    buf_sz = file_sz - descriptor->firmware_length;
+    if (buf_sz < CACHE_COPY_BLOCK_SZ) {
+        buf_sz = CACHE_COPY_BLOCK_SZ;
+    }
+    buf = VS_IOT_MALLOC(buf_sz);
+    CHECK_NOT_ZERO_RET(buf, VS_CODE_ERR_NO_MEMORY);
+
+    ret_code = vs_firmware_save_firmware_descriptor(descriptor);
+
+    while (VS_CODE_OK == ret_code && offset < descriptor->firmware_length) {
+        part_sz = descriptor->firmware_length - offset;
+        if (part_sz > CACHE_COPY_BLOCK_SZ) {
+            part_sz = CACHE_COPY_BLOCK_SZ;
+        }
+
+        ret_code = vs_firmware_read_data(id, offset, buf, part_sz, &data_sz);
+        if (VS_CODE_OK == ret_code && data_sz != part_sz) {
+            ret_code = VS_CODE_ERR_FILE_READ;
+        }
+        if (VS_CODE_OK == ret_code) {
+            ret_code = vs_firmware_save_firmware_chunk(descriptor, buf, data_sz, offset);
+        }
+        offset += data_sz;
+    }
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = vs_firmware_read_data(
+                id, descriptor->firmware_length, buf, file_sz - descriptor->firmware_length, &data_sz);
+    }
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = vs_firmware_save_firmware_footer(descriptor, buf);
+    }
+
+    VS_IOT_FREE(buf);
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = vs_firmware_verify_firmware(descriptor);
+    }
+
+    if (VS_CODE_OK != ret_code) {
+        vs_firmware_delete_firmware(descriptor);
+    }
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_retire_active(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+               const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+               const vs_file_version_t *new_version,
+               int exclude) {
+    vs_firmware_cache_image_t *image;
+    int previous;
+    int i = _track_active(manufacture_id, device_type, exclude);
+    bool keep;
+
+    if (i < 0) {
+        return VS_CODE_OK;
+    }
+
+    image = &_state.images[i];
+    keep = VS_FIRMWARE_CACHE_KEEP_PREVIOUS || (image->flags & CACHE_IMAGE_PINNED);
+    previous = _find_image(manufacture_id, device_type, &image->descriptor.info.version, true);
+
+    // The same version is downloaded again, so its image keeps pin and requests statistics
+    if (previous < 0 && 0 == VS_IOT_MEMCMP(&image->descriptor.info.version, new_version, sizeof(vs_file_version_t))) {
+        if (VS_CODE_OK != vs_firmware_delete_firmware(&image->descriptor)) {
+            VS_LOG_WARNING("Unable to remove firmware");
+        }
+        image->flags |= CACHE_IMAGE_RESERVED;
+        return VS_CODE_OK;
+    }
+
+    // This version has already been kept
+    if (previous >= 0) {
+        _state.images[previous].flags |= image->flags & CACHE_IMAGE_PINNED;
+        keep = false;
+    }
+
+    if (keep) {
+        if (VS_CODE_OK != _copy_to_previous(&image->descriptor)) {
+            CHECK_RET(!(image->flags & CACHE_IMAGE_PINNED),
+                      VS_CODE_ERR_FILE_WRITE,
+                      "Unable to keep pinned firmware version");
+            VS_LOG_WARNING("Unable to keep previous firmware version");
+            keep = false;
+        }
+    }
+
+    if (!keep) {
+        _remove_image(i, false);
+        return VS_CODE_OK;
+    }
+
+    if (VS_CODE_OK != vs_firmware_delete_firmware(&image->descriptor)) {
+        VS_LOG_WARNING("Unable to remove firmware");
+    }
+    image->flags |= CACHE_IMAGE_PREVIOUS;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_reserve(const vs_firmware_descriptor_t *descriptor) {
+    vs_status_e ret_code;
+    int i;
+
+    CHECK_RET(_image_size(descriptor) <= _quota, VS_CODE_ERR_NO_MEMORY, "Firmware is bigger than cache quota");
+
+    _sync_images();
+
+    STATUS_CHECK_RET(_retire_active(descriptor->info.manufacture_id,
+                                    descriptor->info.device_type,
+                                    &descriptor->info.version,
+                                    -1),
+                     "Unable to remove old firmware");
+
+    i = _find_image(descriptor->info.manufacture_id, descriptor->info.device_type, &descriptor->info.version, false);
+    if (i >= 0) {
+        // Image of the same version is reused, so only its new size is counted
+        VS_IOT_MEMCPY(&_state.images[i].descriptor, descriptor, sizeof(*descriptor));
+        ret_code = _make_room(0, i);
+    } else {
+        ret_code = _make_room(_image_size(descriptor), -1);
+
+        if (VS_CODE_OK == ret_code) {
+            i = _free_image_slot(-1);
+            CHECK_RET(i >= 0, VS_CODE_ERR_NO_MEMORY, "All firmware cache images are pinned");
+        }
+    }
+
+    _save_state();
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_pin(const vs_file_info_t *info, bool pinned) {
+    int i = _track_active(info->manufacture_id, info->device_type, -1);
+
+    if (i < 0 ||
+        0 != VS_IOT_MEMCMP(&_state.images[i].descriptor.info.version, &info->version, sizeof(vs_file_version_t))) {
+        i = _find_image(info->manufacture_id, info->device_type, &info->version, true);
+    }
+
+    CHECK_RET(i >= 0, VS_CODE_ERR_NOT_FOUND, "There is no firmware to be pinned");
+
+    if (pinned) {
+        _state.images[i].flags |= CACHE_IMAGE_PINNED;
+    } else {
+        _state.images[i].flags &= ~CACHE_IMAGE_PINNED;
+    }
+
+    return _save_state();
+}
+
+/*************************************************************************/
+static vs_status_e
+_restore(const vs_file_info_t *info) {
+    vs_firmware_cache_image_t *image;
+    vs_storage_element_id_t id;
+    vs_status_e ret_code;
+    int i;
+
+    _sync_images();
+
+    i = _find_image(info->manufacture_id, info->device_type, &info->version, true);
+    CHECK_RET(i >= 0, VS_CODE_ERR_NOT_FOUND, "There is no such previous firmware version");
+    image = &_state.images[i];
+
+    CHECK_RET(_image_size(&image->descriptor) <= _quota,
+              VS_CODE_ERR_NO_MEMORY,
+              "Firmware is bigger than cache quota");
+
+    STATUS_CHECK_RET(_retire_active(info->manufacture_id, info->device_type, &info->version, i),
+                     "Unable to remove current firmware");
+
+    // Current version kept for rollback can exceed quota
+    ret_code = _make_room(0, i);
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = _copy_from_previous(&image->descriptor);
+    }
+
+    if (VS_CODE_OK == ret_code) {
+        // cppcheck-suppress uninitvar
+        _create_previous_filename(&image->descriptor, id);
+        vs_firmware_delete_data(id);
+
+        image->flags &= ~CACHE_IMAGE_PREVIOUS;
+        image->last_request = _state.clock;
+
+#if FIRMWARE_DEDUP
+        if (VS_CODE_OK != vs_firmware_dedup_firmware(&image->descriptor)) {
+            VS_LOG_WARNING("Unable to deduplicate restored firmware");
+        }
+#endif // FIRMWARE_DEDUP
+    } else {
+        VS_LOG_ERROR("Unable to restore previous firmware version");
+    }
+
+    _save_state();
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_cache_init(size_t quota, vs_firmware_cache_policy_e policy) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_status_e ret_code;
+    int i;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(storage->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(storage->impl_func.del, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&_cache_mutex);
+
+    _quota = quota;
+    _policy = policy;
+
+    _load_state();
+
+    // Download of the same version has been interrupted
+    for (i = 0; i < VS_FIRMWARE_CACHE_IMAGES_MAX; ++i) {
+        _state.images[i].flags &= ~CACHE_IMAGE_RESERVED;
+    }
+
+    _sync_images();
+    _ready = true;
+
+    if (VS_CODE_OK != _make_room(0, -1)) {
+        VS_LOG_WARNING("Stored firmware images exceed cache quota");
+    }
+
+    ret_code = _save_state();
+
+    pthread_mutex_unlock(&_cache_mutex);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_cache_deinit(void) {
+    vs_status_e ret_code;
+
+    pthread_mutex_lock(&_cache_mutex);
+
+    if (_ready) {
+        _ready = false;
+        ret_code = _save_state();
+    } else {
+        VS_LOG_ERROR("Firmware cache is not initialized");
+        ret_code = VS_CODE_ERR_NOINIT;
+    }
+
+    pthread_mutex_unlock(&_cache_mutex);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_cache_reserve(const vs_firmware_descriptor_t *descriptor) {
+    vs_firmware_descriptor_t old_descriptor;
+    vs_status_e ret_code = VS_CODE_OK;
+
+    CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&_cache_mutex);
+
+    if (_ready) {
+        ret_code = _reserve(descriptor);
+    } else if (VS_CODE_OK == vs_firmware_load_firmware_descriptor(
+                                     descriptor->info.manufacture_id, descriptor->info.device_type, &old_descriptor)) {
+        ret_code = vs_firmware_delete_firmware(&old_descriptor);
+    }
+
+    pthread_mutex_unlock(&_cache_mutex);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_cache_commit(const vs_firmware_descriptor_t *descriptor) {
+    vs_firmware_cache_image_t *image;
+    vs_status_e ret_code = VS_CODE_OK;
+    int i;
+
+    CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&_cache_mutex);
+
+    if (_ready) {
+        i = _find_image(descriptor->info.manufacture_id, descriptor->info.device_type, NULL, false);
+        if (i >= 0) {
+            _state.images[i].flags &= ~CACHE_IMAGE_RESERVED;
+        }
+
+        i = _track_active(descriptor->info.manufacture_id, descriptor->info.device_type, -1);
+        if (i < 0) {
+            VS_LOG_ERROR("Firmware has not been stored");
+            ret_code = VS_CODE_ERR_NOT_FOUND;
+        } else {
+            // Requests frequency belongs to device type, so new version doesn't become the first LFU victim
+            image = &_state.images[i];
+            image->hits = _type_hits(descriptor->info.manufacture_id, descriptor->info.device_type);
+            image->last_request = _state.clock;
+
+            ret_code = _save_state();
+        }
+    }
+
+    pthread_mutex_unlock(&_cache_mutex);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+void
+vs_firmware_cache_request(const vs_file_info_t *info) {
+    vs_firmware_cache_image_t *image;
+    int i;
+
+    if (!info) {
+        return;
+    }
+
+    pthread_mutex_lock(&_cache_mutex);
+
+    if (_ready) {
+        _state.clock++;
+        _state.requests++;
+
+        i = _track_active(info->manufacture_id, info->device_type, -1);
+        if (i < 0 || (_state.images[i].flags & CACHE_IMAGE_RESERVED)) {
+            _state.misses++;
+        } else {
+            image = &_state.images[i];
+            image->hits++;
+            image->last_request = _state.clock;
+            _state.hits++;
+        }
+
+        if (0 == _state.requests % CACHE_SAVE_REQUESTS_PERIOD && VS_CODE_OK != _save_state()) {
+            VS_LOG_WARNING("Unable to save firmware cache state");
+        }
+    }
+
+    pthread_mutex_unlock(&_cache_mutex);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_cache_pin(const vs_file_info_t *info, bool pinned) {
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(info, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&_cache_mutex);
+
+    if (_ready) {
+        ret_code = _pin(info, pinned);
+    } else {
+        VS_LOG_ERROR("Firmware cache is not initialized");
+        ret_code = VS_CODE_ERR_NOINIT;
+    }
+
+    pthread_mutex_unlock(&_cache_mutex);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_cache_restore(const vs_file_info_t *info) {
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(info, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&_cache_mutex);
+
+    if (_ready) {
+        ret_code = _restore(info);
+    } else {
+        VS_LOG_ERROR("Firmware cache is not initialized");
+        ret_code = VS_CODE_ERR_NOINIT;
+    }
+
+    pthread_mutex_unlock(&_cache_mutex);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_cache_stats(vs_firmware_cache_stats_t *stats) {
+    vs_status_e ret_code = VS_CODE_OK;
+    int i;
+
+    CHECK_NOT_ZERO_RET(stats, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    pthread_mutex_lock(&_cache_mutex);
+
+    if (!_ready) {
+        VS_LOG_ERROR("Firmware cache is not initialized");
+        ret_code = VS_CODE_ERR_NOINIT;
+        goto terminate;
+    }
+
+    _sync_images();
+
+    VS_IOT_MEMSET(stats, 0, sizeof(*stats));
+    stats->requests = _state.requests;
+    stats->hits = _state.hits;
+    stats->misses = _state.misses;
+    stats->evictions = _state.evictions;
+    stats->quota = _quota;
+    stats->used = _used_size();
+
+    for (i = 0; i < VS_FIRMWARE_CACHE_IMAGES_MAX; ++i) {
+        if (_state.images[i].flags & CACHE_IMAGE_USED) {
+            stats->images++;
+            if (_state.images[i].flags & CACHE_IMAGE_PINNED) {
+                stats->pinned++;
+            }
+        }
+    }
+
+terminate:
+    pthread_mutex_unlock(&_cache_mutex);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_CACHE
@@ -0,0 +1,423 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_CHUNK_HASHES
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <endian-config.h>
+
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_chunk_hashes.h>
+#include <virgil/iot/secmodule/secmodule.h>
+#include <virgil/iot/secmodule/secmodule-helpers.h>
+#include <virgil/iot/logger/logger.h>
+
+#include "private/firmware-private.h"
+#include "private/firmware-encoded.h"
+
+#define CHUNKED_FILENAME_SUFFIX "ch"
+
+// Hashes are read by several ones while table is being verified
+#define HASHES_READ_QTY (8)
+
+/*************************************************************************/
+static void
+_chunked_file(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+              const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+              uint32_t hashes_length,
+              vs_firmware_encoded_file_t *file) {
+    vs_firmware_encoded_file_init(file,
+                                  CHUNKED_FILENAME_SUFFIX,
+                                  manufacture_id,
+                                  device_type,
+                                  sizeof(vs_firmware_chunked_header_t),
+                                  hashes_length);
+}
+
+/*************************************************************************/
+static uint32_t
+_chunks_count(const vs_firmware_descriptor_t *descriptor) {
+    return descriptor->firmware_length / descriptor->chunk_size +
+           (descriptor->firmware_length % descriptor->chunk_size ? 1 : 0);
+}
+
+/*************************************************************************/
+static uint32_t
+_hashes_end(uint32_t chunks_count) {
+    return sizeof(vs_firmware_chunk_hashes_t) + chunks_count * VS_HASH_SHA256_LEN;
+}
+
+/*************************************************************************/
+static vs_status_e
+_verify_hashes(const vs_firmware_chunks_ctx_t *ctx) {
+    vs_secmodule_impl_t *secmodule = vs_firmware_secmodule();
+    vs_firmware_encoded_file_t file;
+    vs_firmware_chunk_hashes_t table;
+    vs_secmodule_sw_sha256_ctx hash_ctx;
+    uint8_t hash[VS_HASH_SHA256_LEN];
+    uint8_t buf[VS_HASH_SHA256_LEN * HASHES_READ_QTY];
+    uint32_t hashes_end = _hashes_end(ctx->chunks_count);
+    uint32_t signatures_sz = ctx->header.hashes_length - hashes_end;
+    uint8_t *signatures = NULL;
+    uint32_t offset;
+    size_t read_sz;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(secmodule, VS_CODE_ERR_NOINIT);
+
+    _chunked_file(ctx->header.descriptor.info.manufacture_id,
+                  ctx->header.descriptor.info.device_type,
+                  ctx->header.hashes_length,
+                  &file);
+
+    STATUS_CHECK_RET(vs_firmware_encoded_load_data(&file, 0, (uint8_t *)&table, sizeof(table), &read_sz),
+                     "Unable to load hashes table header");
+    CHECK_RET(sizeof(table) == read_sz, VS_CODE_ERR_FILE_READ, "Incorrect hashes table header size");
+
+    vs_firmware_ntoh_descriptor(&table.descriptor);
+    table.chunks_count = VS_IOT_NTOHL(table.chunks_count);
+
+    CHECK_RET(0 == VS_IOT_MEMCMP(&table.descriptor, &ctx->header.descriptor, sizeof(table.descriptor)) &&
+                      table.chunks_count == ctx->chunks_count && VS_HASH_SHA_256 == table.hash_type,
+              VS_CODE_ERR_VERIFY,
+              "Hashes table doesn't correspond to firmware");
+
+    // Signatures cover table header and hashes as they are stored
+    secmodule->hash_init(&hash_ctx);
+
+    for (offset = 0; offset < hashes_end; offset += read_sz) {
+        STATUS_CHECK_RET(vs_firmware_encoded_load_data(&file,
+                                                       offset,
+                                                       buf,
+                                                       hashes_end - offset > sizeof(buf) ? sizeof(buf)
+                                                                                         : hashes_end - offset,
+                                                       &read_sz),
+                         "Unable to load hashes table");
+        CHECK_RET(read_sz, VS_CODE_ERR_FILE_READ, "Hashes table is incomplete");
+        secmodule->hash_update(&hash_ctx, buf, read_sz);
+    }
+
+    secmodule->hash_finish(&hash_ctx, hash);
+
+    signatures = VS_IOT_MALLOC(signatures_sz);
+    CHECK_NOT_ZERO_RET(signatures, VS_CODE_ERR_NO_MEMORY);
+
+    ret_code = vs_firmware_encoded_load_data(&file, hashes_end, signatures, signatures_sz, &read_sz);
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = signatures_sz == read_sz
+                           ? vs_firmware_verify_hash_signatures(hash, signatures, table.signatures_count, signatures_sz)
+                           : VS_CODE_ERR_FILE_READ;
+    }
+
+    VS_IOT_FREE(signatures);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+void
+vs_firmware_chunked_ntoh_header(vs_firmware_chunked_header_t *header) {
+    VS_IOT_ASSERT(header);
+
+    vs_firmware_ntoh_descriptor(&header->descriptor);
+    header->hashes_length = VS_IOT_NTOHL(header->hashes_length);
+}
+
+/*************************************************************************/
+void
+vs_firmware_chunked_hton_header(vs_firmware_chunked_header_t *header) {
+    VS_IOT_ASSERT(header);
+
+    vs_firmware_hton_descriptor(&header->descriptor);
+    header->hashes_length = VS_IOT_HTONL(header->hashes_length);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_chunks_init(vs_firmware_chunks_ctx_t *ctx, const vs_firmware_chunked_header_t *header) {
+    vs_firmware_encoded_file_t file;
+    vs_firmware_chunked_header_t net_header;
+    uint32_t chunks_count;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header->descriptor.chunk_size, VS_CODE_ERR_INCORRECT_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header->descriptor.firmware_length, VS_CODE_ERR_INCORRECT_ARGUMENT);
+
+    chunks_count = _chunks_count(&header->descriptor);
+
+    CHECK_RET(chunks_count < (UINT32_MAX - sizeof(vs_firmware_chunk_hashes_t)) / VS_HASH_SHA256_LEN &&
+                      header->hashes_length > _hashes_end(chunks_count) &&
+                      header->hashes_length - _hashes_end(chunks_count) < UINT16_MAX,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Incorrect hashes table size %u for %u chunks",
+              header->hashes_length,
+              chunks_count);
+
+    VS_IOT_MEMSET(ctx, 0, sizeof(*ctx));
+    VS_IOT_MEMCPY(&ctx->header, header, sizeof(ctx->header));
+    ctx->chunks_count = chunks_count;
+
+    ctx->received = VS_IOT_CALLOC(1, chunks_count / 8 + 1);
+    CHECK_NOT_ZERO_RET(ctx->received, VS_CODE_ERR_NO_MEMORY);
+
+    _chunked_file(
+            header->descriptor.info.manufacture_id, header->descriptor.info.device_type, header->hashes_length, &file);
+
+    VS_IOT_MEMCPY(&net_header, header, sizeof(net_header));
+    vs_firmware_chunked_hton_header(&net_header);
+
+    ret_code = vs_firmware_encoded_save_header(&file, &net_header);
+    if (VS_CODE_OK != ret_code) {
+        vs_firmware_chunks_free(ctx);
+        return ret_code;
+    }
+
+    VS_LOG_DEBUG("Receive firmware %s by %u verified chunks",
+                 VS_UPDATE_FILE_VERSION_STR_STATIC(&header->descriptor.info.version),
+                 chunks_count);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_chunks_save_hashes(vs_firmware_chunks_ctx_t *ctx, uint32_t offset, const uint8_t *data, uint32_t data_sz) {
+    vs_firmware_encoded_file_t file;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(ctx->received, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // Table is saved sequentially, repeated parts are skipped
+    if (offset < ctx->hashes_offset) {
+        VS_LOG_DEBUG("Skip already saved hashes, offset %u", offset);
+        return VS_CODE_OK;
+    }
+
+    CHECK_RET(offset == ctx->hashes_offset && data_sz <= ctx->header.hashes_length - offset,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Hashes table offset %u while %u is expected",
+              offset,
+              ctx->hashes_offset);
+
+    _chunked_file(ctx->header.descriptor.info.manufacture_id,
+                  ctx->header.descriptor.info.device_type,
+                  ctx->header.hashes_length,
+                  &file);
+
+    STATUS_CHECK_RET(vs_firmware_encoded_save_data(
+                             &file, offset + data_sz == ctx->header.hashes_length, offset, data, data_sz),
+                     "Unable to save hashes table");
+
+    ctx->hashes_offset += data_sz;
+
+    if (ctx->hashes_offset == ctx->header.hashes_length) {
+        if (VS_CODE_OK != _verify_hashes(ctx)) {
+            VS_LOG_WARNING("Firmware chunk hashes table is wrong");
+
+            // Damaged part is unknown, so the whole table has to be received again
+            ctx->hashes_offset = 0;
+            return VS_CODE_ERR_VERIFY;
+        }
+        ctx->hashes_verified = true;
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_chunks_save_chunk(vs_firmware_chunks_ctx_t *ctx, uint32_t offset, const uint8_t *chunk, uint32_t chunk_sz) {
+    const vs_firmware_descriptor_t *descriptor;
+    vs_secmodule_impl_t *secmodule = vs_firmware_secmodule();
+    vs_firmware_encoded_file_t file;
+    vs_secmodule_sw_sha256_ctx hash_ctx;
+    uint8_t expected_hash[VS_HASH_SHA256_LEN];
+    uint8_t hash[VS_HASH_SHA256_LEN];
+    uint32_t chunk_id;
+    uint32_t rest;
+    size_t read_sz;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(ctx->received, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(chunk, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(secmodule, VS_CODE_ERR_NOINIT);
+    CHECK_RET(ctx->hashes_verified, VS_CODE_ERR_NOINIT, "Chunk hashes table has not been verified");
+
+    descriptor = &ctx->header.descriptor;
+
+    CHECK_RET(offset < descriptor->firmware_length && 0 == offset % descriptor->chunk_size,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Incorrect firmware chunk offset %u",
+              offset);
+
+    chunk_id = offset / descriptor->chunk_size;
+    rest = descriptor->firmware_length - offset;
+
+    CHECK_RET(chunk_sz == (rest > descriptor->chunk_size ? descriptor->chunk_size : rest),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Incorrect firmware chunk size %u at offset %u",
+              chunk_sz,
+              offset);
+
+    _chunked_file(descriptor->info.manufacture_id, descriptor->info.device_type, ctx->header.hashes_length, &file);
+
+    STATUS_CHECK_RET(vs_firmware_encoded_load_data(&file,
+                                                   sizeof(vs_firmware_chunk_hashes_t) + chunk_id * VS_HASH_SHA256_LEN,
+                                                   expected_hash,
+                                                   sizeof(expected_hash),
+                                                   &read_sz),
+                     "Unable to load chunk hash");
+    CHECK_RET(sizeof(expected_hash) == read_sz, VS_CODE_ERR_FILE_READ, "Incorrect chunk hash size");
+
+    secmodule->hash_init(&hash_ctx);
+    secmodule->hash_update(&hash_ctx, chunk, chunk_sz);
+    secmodule->hash_finish(&hash_ctx, hash);
+
+    if (0 != VS_IOT_MEMCMP(hash, expected_hash, sizeof(hash))) {
+        VS_LOG_WARNING("Firmware chunk at offset %u doesn't match its hash", offset);
+        return VS_CODE_ERR_VERIFY;
+    }
+
+    if (ctx->received[chunk_id / 8] & (1 << (chunk_id % 8))) {
+        VS_LOG_DEBUG("Skip already saved firmware chunk, offset %u", offset);
+        return VS_CODE_OK;
+    }
+
+    STATUS_CHECK_RET(vs_firmware_save_firmware_chunk(descriptor, chunk, chunk_sz, offset),
+                     "Unable to save firmware chunk");
+
+    ctx->received[chunk_id / 8] |= 1 << (chunk_id % 8);
+    ctx->chunks_received++;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_chunks_next_missing(const vs_firmware_chunks_ctx_t *ctx, uint32_t from_offset, uint32_t *offset) {
+    uint32_t chunk_id;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(ctx->received, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(offset, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    for (chunk_id = from_offset / ctx->header.descriptor.chunk_size; chunk_id < ctx->chunks_count; ++chunk_id) {
+        if (!(ctx->received[chunk_id / 8] & (1 << (chunk_id % 8)))) {
+            *offset = chunk_id * ctx->header.descriptor.chunk_size;
+            return VS_CODE_OK;
+        }
+    }
+
+    return VS_CODE_ERR_NOT_FOUND;
+}
+
+/*************************************************************************/
+bool
+vs_firmware_chunks_is_complete(const vs_firmware_chunks_ctx_t *ctx) {
+    VS_IOT_ASSERT(ctx);
+
+    return ctx->received && ctx->hashes_verified && ctx->chunks_received == ctx->chunks_count;
+}
+
+/*************************************************************************/
+void
+vs_firmware_chunks_free(vs_firmware_chunks_ctx_t *ctx) {
+    VS_IOT_ASSERT(ctx);
+
+    VS_IOT_FREE(ctx->received);
+    VS_IOT_MEMSET(ctx, 0, sizeof(*ctx));
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_chunked_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                                const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                                vs_firmware_chunked_header_t *header) {
+    vs_firmware_encoded_file_t file;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _chunked_file(manufacture_id, device_type, 0, &file);
+
+    STATUS_CHECK_RET(vs_firmware_encoded_load_header(&file, header), "Unable to load chunked firmware header");
+
+    vs_firmware_chunked_ntoh_header(header);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_chunked_load_hashes(const vs_firmware_chunked_header_t *header,
+                                uint32_t offset,
+                                uint8_t *data,
+                                size_t buf_sz,
+                                size_t *data_sz) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _chunked_file(
+            header->descriptor.info.manufacture_id, header->descriptor.info.device_type, header->hashes_length, &file);
+
+    return vs_firmware_encoded_load_data(&file, offset, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_chunked_delete(const vs_firmware_chunked_header_t *header) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _chunked_file(
+            header->descriptor.info.manufacture_id, header->descriptor.info.device_type, header->hashes_length, &file);
+
+    return vs_firmware_encoded_delete(&file);
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_CHUNK_HASHES
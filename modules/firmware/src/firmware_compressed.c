@@ -0,0 +1,340 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_COMPRESSION
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <endian-config.h>
+
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_compression.h>
+#include <virgil/iot/logger/logger.h>
+
+#include "private/firmware-private.h"
+#include "private/firmware-encoded.h"
+
+#define COMPRESSED_FILENAME_SUFFIX "lz"
+
+/*************************************************************************/
+static void
+_compressed_file(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                 const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                 uint32_t compressed_length,
+                 vs_firmware_encoded_file_t *file) {
+    vs_firmware_encoded_file_init(file,
+                                  COMPRESSED_FILENAME_SUFFIX,
+                                  manufacture_id,
+                                  device_type,
+                                  sizeof(vs_firmware_compressed_header_t),
+                                  compressed_length);
+}
+
+/*************************************************************************/
+void
+vs_firmware_compressed_ntoh_header(vs_firmware_compressed_header_t *header) {
+    VS_IOT_ASSERT(header);
+
+    vs_firmware_ntoh_descriptor(&header->descriptor);
+    header->compressed_length = VS_IOT_NTOHL(header->compressed_length);
+}
+
+/*************************************************************************/
+void
+vs_firmware_compressed_hton_header(vs_firmware_compressed_header_t *header) {
+    VS_IOT_ASSERT(header);
+
+    vs_firmware_hton_descriptor(&header->descriptor);
+    header->compressed_length = VS_IOT_HTONL(header->compressed_length);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_save_header(const vs_firmware_compressed_header_t *header) {
+    vs_firmware_encoded_file_t file;
+    vs_firmware_compressed_header_t net_header;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _compressed_file(header->descriptor.info.manufacture_id,
+                     header->descriptor.info.device_type,
+                     header->compressed_length,
+                     &file);
+
+    VS_IOT_MEMCPY(&net_header, header, sizeof(net_header));
+    vs_firmware_compressed_hton_header(&net_header);
+
+    return vs_firmware_encoded_save_header(&file, &net_header);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_save_chunk(const vs_firmware_compressed_header_t *header,
+                                  const uint8_t *chunk,
+                                  size_t chunk_sz,
+                                  uint32_t offset) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _compressed_file(header->descriptor.info.manufacture_id,
+                     header->descriptor.info.device_type,
+                     header->compressed_length,
+                     &file);
+
+    return vs_firmware_encoded_save_data(&file, false, offset, chunk, chunk_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_save_footer(const vs_firmware_compressed_header_t *header,
+                                   const uint8_t *footer,
+                                   size_t footer_sz) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _compressed_file(header->descriptor.info.manufacture_id,
+                     header->descriptor.info.device_type,
+                     header->compressed_length,
+                     &file);
+
+    return vs_firmware_encoded_save_footer(&file, footer, footer_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                                   const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                                   vs_firmware_compressed_header_t *header) {
+    vs_firmware_encoded_file_t file;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _compressed_file(manufacture_id, device_type, 0, &file);
+
+    STATUS_CHECK_RET(vs_firmware_encoded_load_header(&file, header), "Unable to load compressed firmware header");
+
+    vs_firmware_compressed_ntoh_header(header);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_load_chunk(const vs_firmware_compressed_header_t *header,
+                                  uint32_t offset,
+                                  uint8_t *data,
+                                  size_t buf_sz,
+                                  size_t *data_sz) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _compressed_file(header->descriptor.info.manufacture_id,
+                     header->descriptor.info.device_type,
+                     header->compressed_length,
+                     &file);
+
+    return vs_firmware_encoded_load_data(&file, offset, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_load_footer(const vs_firmware_compressed_header_t *header,
+                                   uint8_t *data,
+                                   size_t buf_sz,
+                                   size_t *data_sz) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _compressed_file(header->descriptor.info.manufacture_id,
+                     header->descriptor.info.device_type,
+                     header->compressed_length,
+                     &file);
+
+    return vs_firmware_encoded_load_footer(&file, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_delete(const vs_firmware_compressed_header_t *header) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _compressed_file(header->descriptor.info.manufacture_id,
+                     header->descriptor.info.device_type,
+                     header->compressed_length,
+                     &file);
+
+    return vs_firmware_encoded_delete(&file);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_apply_init(vs_firmware_compressed_ctx_t *ctx,
+                                  const vs_firmware_descriptor_t *descriptor,
+                                  uint32_t compressed_length) {
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(descriptor->chunk_size, VS_CODE_ERR_INCORRECT_ARGUMENT);
+    CHECK_NOT_ZERO_RET(descriptor->firmware_length, VS_CODE_ERR_INCORRECT_ARGUMENT);
+    CHECK_RET(compressed_length > VS_FIRMWARE_LZ_HEADER_SIZE,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Incorrect compressed stream size %u",
+              compressed_length);
+
+    VS_IOT_MEMSET(ctx, 0, sizeof(*ctx));
+    VS_IOT_MEMCPY(&ctx->descriptor, descriptor, sizeof(ctx->descriptor));
+    ctx->compressed_length = compressed_length;
+
+    ctx->chunk = VS_IOT_MALLOC(descriptor->chunk_size);
+    CHECK_NOT_ZERO_RET(ctx->chunk, VS_CODE_ERR_NO_MEMORY);
+
+    ret_code = vs_firmware_lz_decode_init(&ctx->lz);
+    if (VS_CODE_OK != ret_code) {
+        VS_IOT_FREE(ctx->chunk);
+        ctx->chunk = NULL;
+        return ret_code;
+    }
+
+    VS_LOG_DEBUG("Decompress firmware %s, %u bytes from %u bytes",
+                 VS_UPDATE_FILE_VERSION_STR_STATIC(&descriptor->info.version),
+                 descriptor->firmware_length,
+                 compressed_length);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_apply_data(vs_firmware_compressed_ctx_t *ctx, const uint8_t *data, uint32_t data_sz) {
+    uint32_t out_rest;
+    size_t out_sz;
+    size_t in_used;
+    size_t out_used;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(ctx->chunk, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(data_sz <= ctx->compressed_length - ctx->compressed_offset,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Data is outside of compressed stream");
+
+    ctx->compressed_offset += data_sz;
+
+    while (data_sz) {
+        out_rest = ctx->descriptor.firmware_length - ctx->out_offset - ctx->chunk_used;
+        out_sz = ctx->descriptor.chunk_size - ctx->chunk_used;
+        if (out_sz > out_rest) {
+            out_sz = out_rest;
+        }
+
+        CHECK_RET(out_sz, VS_CODE_ERR_FORMAT_OVERFLOW, "Compressed stream produces too big firmware");
+
+        STATUS_CHECK_RET(vs_firmware_lz_decode(
+                                 &ctx->lz, data, data_sz, &in_used, ctx->chunk + ctx->chunk_used, out_sz, &out_used),
+                         "Unable to decompress firmware");
+
+        data += in_used;
+        data_sz -= in_used;
+        ctx->chunk_used += out_used;
+
+        // Output is flushed either by full chunk or by the firmware end
+        if (out_used == out_sz) {
+            STATUS_CHECK_RET(vs_firmware_save_firmware_chunk(
+                                     &ctx->descriptor, ctx->chunk, ctx->chunk_used, ctx->out_offset),
+                             "Unable to save decompressed firmware chunk");
+            ctx->out_offset += ctx->chunk_used;
+            ctx->chunk_used = 0;
+
+            // The rest of stream can contain unused flag bits only
+            if (ctx->out_offset == ctx->descriptor.firmware_length) {
+                break;
+            }
+        }
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_compressed_apply_finish(vs_firmware_compressed_ctx_t *ctx, const uint8_t *footer) {
+    vs_firmware_descriptor_t footer_descriptor;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(ctx->chunk, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(footer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    CHECK_RET(ctx->compressed_offset == ctx->compressed_length,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Compressed stream is incomplete");
+    CHECK_RET(ctx->out_offset == ctx->descriptor.firmware_length,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Decompressed firmware size %u is not equal to expected %u",
+              ctx->out_offset + ctx->chunk_used,
+              ctx->descriptor.firmware_length);
+
+    VS_IOT_MEMCPY(&footer_descriptor, &((const vs_firmware_footer_t *)footer)->descriptor, sizeof(footer_descriptor));
+    vs_firmware_ntoh_descriptor(&footer_descriptor);
+    CHECK_RET(0 == VS_IOT_MEMCMP(&footer_descriptor, &ctx->descriptor, sizeof(footer_descriptor)),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Invalid firmware descriptor");
+
+    return vs_firmware_save_firmware_footer(&ctx->descriptor, footer);
+}
+
+/*************************************************************************/
+void
+vs_firmware_compressed_apply_free(vs_firmware_compressed_ctx_t *ctx) {
+    VS_IOT_ASSERT(ctx);
+
+    vs_firmware_lz_decode_free(&ctx->lz);
+    VS_IOT_FREE(ctx->chunk);
+    VS_IOT_MEMSET(ctx, 0, sizeof(*ctx));
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_COMPRESSION
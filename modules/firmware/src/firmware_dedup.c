@@ -0,0 +1,979 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_DEDUP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include <stdlib-config.h>
+#include <update-config.h>
+
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_dedup.h>
+#include <virgil/iot/storage_hal/storage_hal.h>
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/secmodule/secmodule.h>
+#include <virgil/iot/secmodule/secmodule-helpers.h>
+
+#include "private/firmware-private.h"
+
+// Array of deduplicated storage elements identifiers. Free slot is filled by zeros
+#define IMAGES_FILENAME "firmware_dedup"
+// Manifest of image is stored in element with the same slot number as image
+#define MANIFEST_FILENAME "firmware_manifest_"
+#define CHUNK_FILENAME "fwchunk_"
+// Hashes of chunks that can be left unreferenced by interrupted packing or removal. They are checked by init
+#define SWEEP_FILENAME "firmware_dedup_sweep"
+
+// Chunk storage element name contains the beginning of its hash
+#define CHUNK_NAME_HASH_SZ (sizeof(vs_storage_element_id_t) - (sizeof(CHUNK_FILENAME) - 1))
+
+#define MANIFEST_MAGIC (0x56534444)
+
+#define CHUNKS_GROW_STEP (64)
+#define IMAGES_GROW_STEP (4)
+
+// Manifest header is followed by hashes of data blocks and by the rest of element (footer)
+typedef struct __attribute__((__packed__)) {
+    uint32_t magic;
+    uint32_t data_sz;
+    uint32_t block_sz;
+    uint32_t tail_sz;
+} vs_firmware_dedup_manifest_t;
+
+// Chunks index is sorted by hash. References are counted by manifests loading
+typedef struct {
+    uint8_t hash[VS_HASH_SHA256_LEN];
+    uint32_t refs;
+    uint32_t size;
+} vs_firmware_dedup_chunk_t;
+
+typedef struct {
+    vs_storage_element_id_t id;
+    bool expanding; // Element data is being restored, so it's not deduplicated for Firmware calls
+    vs_firmware_dedup_manifest_t *manifest;
+} vs_firmware_dedup_image_t;
+
+static const vs_storage_element_id_t _free_slot;
+
+static vs_firmware_dedup_chunk_t *_chunks = NULL;
+static size_t _chunks_count = 0;
+static size_t _chunks_capacity = 0;
+
+static vs_firmware_dedup_image_t *_images = NULL;
+static size_t _images_count = 0;
+
+static size_t _sweep_sz = 0;
+
+// Cloud thread packs images while FLDT server thread reads them.
+// Mutex is recursive because packing reads data by Firmware calls
+static pthread_mutex_t _dedup_mutex;
+static pthread_once_t _dedup_mutex_once = PTHREAD_ONCE_INIT;
+
+/*************************************************************************/
+static void
+_dedup_mutex_init(void) {
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_dedup_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/*************************************************************************/
+void
+vs_firmware_dedup_lock(void) {
+    pthread_once(&_dedup_mutex_once, _dedup_mutex_init);
+    pthread_mutex_lock(&_dedup_mutex);
+}
+
+/*************************************************************************/
+void
+vs_firmware_dedup_unlock(void) {
+    pthread_mutex_unlock(&_dedup_mutex);
+}
+
+/*************************************************************************/
+static void
+_create_images_filename(vs_storage_element_id_t id) {
+    VS_IOT_MEMSET(id, 0, sizeof(vs_storage_element_id_t));
+    VS_IOT_MEMCPY(&id[0], IMAGES_FILENAME, sizeof(IMAGES_FILENAME));
+}
+
+/*************************************************************************/
+static void
+_create_manifest_filename(size_t slot, vs_storage_element_id_t id) {
+    uint16_t slot_num = slot;
+
+    VS_IOT_MEMSET(id, 0, sizeof(vs_storage_element_id_t));
+    VS_IOT_MEMCPY(&id[0], MANIFEST_FILENAME, sizeof(MANIFEST_FILENAME) - 1);
+    VS_IOT_MEMCPY(&id[sizeof(MANIFEST_FILENAME) - 1], &slot_num, sizeof(slot_num));
+}
+
+/*************************************************************************/
+static void
+_create_sweep_filename(vs_storage_element_id_t id) {
+    VS_IOT_MEMSET(id, 0, sizeof(vs_storage_element_id_t));
+    VS_IOT_MEMCPY(&id[0], SWEEP_FILENAME, sizeof(SWEEP_FILENAME));
+}
+
+/*************************************************************************/
+static void
+_create_chunk_filename(const uint8_t hash[VS_HASH_SHA256_LEN], vs_storage_element_id_t id) {
+    VS_IOT_MEMCPY(&id[0], CHUNK_FILENAME, sizeof(CHUNK_FILENAME) - 1);
+    VS_IOT_MEMCPY(&id[sizeof(CHUNK_FILENAME) - 1], hash, CHUNK_NAME_HASH_SZ);
+}
+
+/*************************************************************************/
+static uint32_t
+_blocks_count(const vs_firmware_dedup_manifest_t *manifest) {
+    return (manifest->data_sz + manifest->block_sz - 1) / manifest->block_sz;
+}
+
+/*************************************************************************/
+static uint32_t
+_block_size(const vs_firmware_dedup_manifest_t *manifest, uint32_t block) {
+    uint32_t rest = manifest->data_sz - block * manifest->block_sz;
+
+    return rest < manifest->block_sz ? rest : manifest->block_sz;
+}
+
+/*************************************************************************/
+static uint8_t *
+_block_hash(vs_firmware_dedup_manifest_t *manifest, uint32_t block) {
+    return (uint8_t *)&manifest[1] + block * VS_HASH_SHA256_LEN;
+}
+
+/*************************************************************************/
+static uint8_t *
+_manifest_tail(vs_firmware_dedup_manifest_t *manifest) {
+    return _block_hash(manifest, _blocks_count(manifest));
+}
+
+/*************************************************************************/
+static size_t
+_manifest_size(const vs_firmware_dedup_manifest_t *manifest) {
+    return sizeof(vs_firmware_dedup_manifest_t) + _blocks_count(manifest) * VS_HASH_SHA256_LEN + manifest->tail_sz;
+}
+
+/*************************************************************************/
+static bool
+_find_chunk(const uint8_t hash[VS_HASH_SHA256_LEN], size_t *pos) {
+    size_t low = 0;
+    size_t high = _chunks_count;
+    size_t mid;
+    int cmp;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        cmp = VS_IOT_MEMCMP(_chunks[mid].hash, hash, VS_HASH_SHA256_LEN);
+
+        if (0 == cmp) {
+            *pos = mid;
+            return true;
+        }
+
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    *pos = low;
+    return false;
+}
+
+/*************************************************************************/
+static bool
+_chunk_name_collision(const uint8_t hash[VS_HASH_SHA256_LEN], size_t pos) {
+    // Index is sorted by hash, so hashes with the same beginning are neighbours
+    return (pos > 0 && 0 == VS_IOT_MEMCMP(_chunks[pos - 1].hash, hash, CHUNK_NAME_HASH_SZ)) ||
+           (pos < _chunks_count && 0 == VS_IOT_MEMCMP(_chunks[pos].hash, hash, CHUNK_NAME_HASH_SZ));
+}
+
+/*************************************************************************/
+static vs_status_e
+_sweep_add(const uint8_t *hashes, uint32_t count) {
+    vs_storage_element_id_t id;
+    vs_status_e ret_code;
+
+    // cppcheck-suppress uninitvar
+    _create_sweep_filename(id);
+
+    STATUS_CHECK_RET(vs_firmware_write_data(id, true, _sweep_sz, hashes, count * VS_HASH_SHA256_LEN),
+                     "Unable to save firmware chunks sweep list");
+    _sweep_sz += count * VS_HASH_SHA256_LEN;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static void
+_sweep(void) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_storage_element_id_t sweep_id;
+    vs_storage_element_id_t id;
+    uint8_t hash[VS_HASH_SHA256_LEN];
+    ssize_t file_sz;
+    size_t read_sz;
+    size_t offset;
+    size_t pos;
+
+    // cppcheck-suppress uninitvar
+    _create_sweep_filename(sweep_id);
+
+    file_sz = storage->impl_func.size(storage->impl_data, sweep_id);
+    if (file_sz <= 0) {
+        return;
+    }
+
+    for (offset = 0; offset + VS_HASH_SHA256_LEN <= (size_t)file_sz; offset += VS_HASH_SHA256_LEN) {
+        if (VS_CODE_OK != vs_firmware_read_data(sweep_id, offset, hash, VS_HASH_SHA256_LEN, &read_sz) ||
+            read_sz != VS_HASH_SHA256_LEN) {
+            VS_LOG_WARNING("Unable to read firmware chunks sweep list");
+            break;
+        }
+
+        if (!_find_chunk(hash, &pos) && !_chunk_name_collision(hash, pos)) {
+            // cppcheck-suppress uninitvar
+            _create_chunk_filename(hash, id);
+            storage->impl_func.del(storage->impl_data, id);
+        }
+    }
+
+    if (VS_CODE_OK == storage->impl_func.del(storage->impl_data, sweep_id)) {
+        _sweep_sz = 0;
+    } else {
+        _sweep_sz = file_sz;
+    }
+}
+
+/*************************************************************************/
+static vs_status_e
+_add_chunk_ref(const uint8_t hash[VS_HASH_SHA256_LEN], uint32_t size) {
+    vs_firmware_dedup_chunk_t *chunks;
+    size_t pos;
+
+    if (_find_chunk(hash, &pos)) {
+        CHECK_RET(_chunks[pos].size == size, VS_CODE_ERR_FORMAT_OVERFLOW, "Firmware chunk size mismatch");
+        _chunks[pos].refs++;
+        return VS_CODE_OK;
+    }
+
+    if (_chunks_count == _chunks_capacity) {
+        chunks = VS_IOT_CALLOC(_chunks_capacity + CHUNKS_GROW_STEP, sizeof(vs_firmware_dedup_chunk_t));
+        CHECK_NOT_ZERO_RET(chunks, VS_CODE_ERR_NO_MEMORY);
+
+        if (_chunks_count) {
+            VS_IOT_MEMCPY(chunks, _chunks, _chunks_count * sizeof(vs_firmware_dedup_chunk_t));
+        }
+        VS_IOT_FREE(_chunks);
+        _chunks = chunks;
+        _chunks_capacity += CHUNKS_GROW_STEP;
+    }
+
+    VS_IOT_MEMMOVE(&_chunks[pos + 1], &_chunks[pos], (_chunks_count - pos) * sizeof(vs_firmware_dedup_chunk_t));
+    VS_IOT_MEMCPY(_chunks[pos].hash, hash, VS_HASH_SHA256_LEN);
+    _chunks[pos].refs = 1;
+    _chunks[pos].size = size;
+    _chunks_count++;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static void
+_release_chunk(const uint8_t hash[VS_HASH_SHA256_LEN]) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_storage_element_id_t id;
+    size_t pos;
+
+    if (!_find_chunk(hash, &pos)) {
+        return;
+    }
+
+    if (--_chunks[pos].refs) {
+        return;
+    }
+
+    // cppcheck-suppress uninitvar
+    _create_chunk_filename(hash, id);
+    if (VS_CODE_OK != storage->impl_func.del(storage->impl_data, id)) {
+        VS_LOG_WARNING("Unable to remove firmware chunk");
+    }
+
+    _chunks_count--;
+    VS_IOT_MEMMOVE(&_chunks[pos], &_chunks[pos + 1], (_chunks_count - pos) * sizeof(vs_firmware_dedup_chunk_t));
+}
+
+/*************************************************************************/
+static vs_status_e
+_store_chunk(const uint8_t hash[VS_HASH_SHA256_LEN], const uint8_t *data, uint32_t size) {
+    vs_storage_element_id_t id;
+    vs_status_e ret_code;
+    size_t pos;
+
+    // Unique chunk is written before its reference is counted
+    if (!_find_chunk(hash, &pos)) {
+        CHECK_RET(!_chunk_name_collision(hash, pos), VS_CODE_ERR_FILE_WRITE, "Firmware chunk name is already used");
+        STATUS_CHECK_RET(_sweep_add(hash, 1), "Unable to register firmware chunk");
+
+        // cppcheck-suppress uninitvar
+        _create_chunk_filename(hash, id);
+        STATUS_CHECK_RET(vs_firmware_write_data(id, true, 0, data, size), "Unable to save firmware chunk");
+    }
+
+    return _add_chunk_ref(hash, size);
+}
+
+/*************************************************************************/
+static void
+_release_blocks(vs_firmware_dedup_manifest_t *manifest, uint32_t blocks) {
+    uint32_t i;
+
+    for (i = 0; i < blocks; ++i) {
+        _release_chunk(_block_hash(manifest, i));
+    }
+}
+
+/*************************************************************************/
+static int
+_find_image(const vs_storage_element_id_t id) {
+    size_t i;
+
+    for (i = 0; i < _images_count; ++i) {
+        if (_images[i].manifest && 0 == VS_IOT_MEMCMP(_images[i].id, id, sizeof(vs_storage_element_id_t))) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*************************************************************************/
+static bool
+_has_images(void) {
+    size_t i;
+
+    for (i = 0; i < _images_count; ++i) {
+        if (_images[i].manifest) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*************************************************************************/
+static vs_status_e
+_save_image_slot(size_t slot, const vs_storage_element_id_t id) {
+    vs_storage_element_id_t images_id;
+
+    // cppcheck-suppress uninitvar
+    _create_images_filename(images_id);
+
+    return vs_firmware_write_data(
+            images_id, true, slot * sizeof(vs_storage_element_id_t), id, sizeof(vs_storage_element_id_t));
+}
+
+/*************************************************************************/
+static int
+_free_image_slot(void) {
+    vs_firmware_dedup_image_t *images;
+    size_t i;
+
+    for (i = 0; i < _images_count; ++i) {
+        if (!_images[i].manifest) {
+            return i;
+        }
+    }
+
+    images = VS_IOT_CALLOC(_images_count + IMAGES_GROW_STEP, sizeof(vs_firmware_dedup_image_t));
+    if (!images) {
+        return -1;
+    }
+
+    if (_images_count) {
+        VS_IOT_MEMCPY(images, _images, _images_count * sizeof(vs_firmware_dedup_image_t));
+    }
+    VS_IOT_FREE(_images);
+    _images = images;
+    _images_count += IMAGES_GROW_STEP;
+
+    return i;
+}
+
+/*************************************************************************/
+static vs_status_e
+_remove_image(size_t slot) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_firmware_dedup_image_t *image = &_images[slot];
+    vs_storage_element_id_t manifest_id;
+    vs_storage_element_id_t images_id;
+    vs_status_e ret_code;
+
+    STATUS_CHECK_RET(_sweep_add(_block_hash(image->manifest, 0), _blocks_count(image->manifest)),
+                     "Unable to register firmware chunks");
+    STATUS_CHECK_RET(_save_image_slot(slot, _free_slot), "Unable to remove deduplicated image");
+
+    // cppcheck-suppress uninitvar
+    _create_manifest_filename(slot, manifest_id);
+    if (VS_CODE_OK != storage->impl_func.del(storage->impl_data, manifest_id)) {
+        VS_LOG_WARNING("Unable to remove firmware manifest");
+    }
+
+    _release_blocks(image->manifest, _blocks_count(image->manifest));
+    _sweep();
+
+    VS_IOT_FREE(image->manifest);
+    VS_IOT_MEMSET(image, 0, sizeof(*image));
+
+    // Remove images file if there are no deduplicated images
+    if (!_has_images()) {
+        // cppcheck-suppress uninitvar
+        _create_images_filename(images_id);
+        if (VS_CODE_OK == storage->impl_func.del(storage->impl_data, images_id)) {
+            VS_IOT_FREE(_images);
+            _images = NULL;
+            _images_count = 0;
+        }
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_read_image(vs_firmware_dedup_image_t *image, uint32_t offset, uint8_t *data, size_t buff_sz, size_t *data_sz) {
+    vs_firmware_dedup_manifest_t *manifest = image->manifest;
+    vs_storage_element_id_t id;
+    vs_status_e ret_code;
+    uint32_t block;
+    uint32_t block_offset;
+    size_t size = manifest->data_sz + manifest->tail_sz;
+    size_t part_sz;
+    size_t read_sz;
+
+    *data_sz = 0;
+    CHECK_RET(size >= offset, VS_CODE_ERR_FILE, "File format error");
+
+    size -= offset;
+    buff_sz = size < buff_sz ? size : buff_sz;
+
+    while (*data_sz < buff_sz) {
+        if (offset < manifest->data_sz) {
+            block = offset / manifest->block_sz;
+            block_offset = offset % manifest->block_sz;
+            part_sz = _block_size(manifest, block) - block_offset;
+            part_sz = part_sz < buff_sz - *data_sz ? part_sz : buff_sz - *data_sz;
+
+            // cppcheck-suppress uninitvar
+            _create_chunk_filename(_block_hash(manifest, block), id);
+            STATUS_CHECK_RET(vs_firmware_read_data(id, block_offset, data, part_sz, &read_sz),
+                             "Unable to read firmware chunk");
+            CHECK_RET(read_sz == part_sz, VS_CODE_ERR_FILE_READ, "Firmware chunk is too short");
+        } else {
+            part_sz = buff_sz - *data_sz;
+            VS_IOT_MEMCPY(data, _manifest_tail(manifest) + offset - manifest->data_sz, part_sz);
+        }
+
+        data += part_sz;
+        offset += part_sz;
+        *data_sz += part_sz;
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_firmware_dedup_manifest_t *
+_load_manifest(size_t slot) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_firmware_dedup_manifest_t header;
+    vs_firmware_dedup_manifest_t *manifest;
+    vs_storage_element_id_t manifest_id;
+    ssize_t file_sz;
+    size_t read_sz;
+
+    // cppcheck-suppress uninitvar
+    _create_manifest_filename(slot, manifest_id);
+
+    file_sz = storage->impl_func.size(storage->impl_data, manifest_id);
+    if (file_sz < (ssize_t)sizeof(header) ||
+        VS_CODE_OK != vs_firmware_read_data(manifest_id, 0, (uint8_t *)&header, sizeof(header), &read_sz) ||
+        MANIFEST_MAGIC != header.magic || !header.block_sz || (ssize_t)_manifest_size(&header) != file_sz) {
+        return NULL;
+    }
+
+    manifest = VS_IOT_MALLOC(file_sz);
+    if (manifest && (VS_CODE_OK != vs_firmware_read_data(manifest_id, 0, (uint8_t *)manifest, file_sz, &read_sz) ||
+                     (ssize_t)read_sz != file_sz)) {
+        VS_IOT_FREE(manifest);
+        manifest = NULL;
+    }
+
+    return manifest;
+}
+
+/*************************************************************************/
+static void
+_free_index(void) {
+    size_t i;
+
+    for (i = 0; i < _images_count; ++i) {
+        VS_IOT_FREE(_images[i].manifest);
+    }
+
+    VS_IOT_FREE(_images);
+    _images = NULL;
+    _images_count = 0;
+
+    VS_IOT_FREE(_chunks);
+    _chunks = NULL;
+    _chunks_count = 0;
+    _chunks_capacity = 0;
+}
+
+/*************************************************************************/
+static vs_status_e
+_dedup_init(void) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_firmware_dedup_image_t *image;
+    vs_storage_element_id_t images_id;
+    ssize_t file_sz;
+    size_t read_sz;
+    size_t i;
+    uint32_t block;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(storage->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(storage->impl_func.del, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _free_index();
+
+    // cppcheck-suppress uninitvar
+    _create_images_filename(images_id);
+
+    file_sz = storage->impl_func.size(storage->impl_data, images_id);
+    if (file_sz < (ssize_t)sizeof(vs_storage_element_id_t)) {
+        _sweep();
+        return VS_CODE_OK;
+    }
+
+    _images_count = file_sz / sizeof(vs_storage_element_id_t);
+    _images = VS_IOT_CALLOC(_images_count, sizeof(vs_firmware_dedup_image_t));
+    if (!_images) {
+        _images_count = 0;
+        return VS_CODE_ERR_NO_MEMORY;
+    }
+
+    for (i = 0; i < _images_count; ++i) {
+        image = &_images[i];
+
+        if (VS_CODE_OK != vs_firmware_read_data(images_id,
+                                                i * sizeof(vs_storage_element_id_t),
+                                                image->id,
+                                                sizeof(vs_storage_element_id_t),
+                                                &read_sz) ||
+            read_sz != sizeof(vs_storage_element_id_t)) {
+            _free_index();
+            return VS_CODE_ERR_FILE_READ;
+        }
+
+        if (0 == VS_IOT_MEMCMP(image->id, _free_slot, sizeof(vs_storage_element_id_t))) {
+            continue;
+        }
+
+        image->manifest = _load_manifest(i);
+        if (!image->manifest) {
+            VS_LOG_ERROR("Deduplicated firmware manifest is damaged");
+            VS_IOT_MEMSET(image->id, 0, sizeof(vs_storage_element_id_t));
+            _save_image_slot(i, _free_slot);
+            continue;
+        }
+
+        for (block = 0; block < _blocks_count(image->manifest); ++block) {
+            if (VS_CODE_OK != _add_chunk_ref(_block_hash(image->manifest, block),
+                                             _block_size(image->manifest, block))) {
+                _free_index();
+                return VS_CODE_ERR_NO_MEMORY;
+            }
+        }
+
+        // Remove data left by interrupted deduplication or expanding
+        if (storage->impl_func.size(storage->impl_data, image->id) > 0) {
+            storage->impl_func.del(storage->impl_data, image->id);
+        }
+    }
+
+    // Chunks are referenced by loaded manifests only, so the rest of listed ones are orphans
+    _sweep();
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+void
+vs_firmware_dedup_deinit(void) {
+    vs_firmware_dedup_lock();
+    _free_index();
+    vs_firmware_dedup_unlock();
+}
+
+/*************************************************************************/
+bool
+vs_firmware_dedup_is_packed(const vs_storage_element_id_t id) {
+    bool res;
+    int slot;
+
+    vs_firmware_dedup_lock();
+    slot = _find_image(id);
+    res = slot >= 0 && !_images[slot].expanding;
+    vs_firmware_dedup_unlock();
+
+    return res;
+}
+
+/*************************************************************************/
+ssize_t
+vs_firmware_dedup_size(const vs_storage_element_id_t id) {
+    ssize_t size = -1;
+    int slot;
+
+    vs_firmware_dedup_lock();
+    slot = _find_image(id);
+    if (slot >= 0) {
+        size = _images[slot].manifest->data_sz + _images[slot].manifest->tail_sz;
+    }
+    vs_firmware_dedup_unlock();
+
+    return size;
+}
+
+/*************************************************************************/
+static vs_status_e
+_dedup_read(const vs_storage_element_id_t id, uint32_t offset, uint8_t *data, size_t buff_sz, size_t *data_sz) {
+    int slot = _find_image(id);
+
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data_sz, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(slot >= 0, VS_CODE_ERR_NOT_FOUND, "Storage element is not deduplicated");
+
+    return _read_image(&_images[slot], offset, data, buff_sz, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_dedup_pack(const vs_storage_element_id_t id, uint32_t data_sz) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_secmodule_impl_t *secmodule = vs_firmware_secmodule();
+    vs_secmodule_sw_sha256_ctx hash_ctx;
+    vs_firmware_dedup_manifest_t header;
+    vs_firmware_dedup_manifest_t *manifest = NULL;
+    vs_storage_element_id_t manifest_id;
+    vs_status_e ret_code = VS_CODE_OK;
+    uint8_t *buf = NULL;
+    uint32_t blocks;
+    uint32_t block = 0;
+    uint32_t block_sz;
+    ssize_t file_sz;
+    size_t read_sz;
+    int slot;
+
+    CHECK_NOT_ZERO_RET(storage, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(secmodule, VS_CODE_ERR_NOINIT);
+
+    if (_find_image(id) >= 0) {
+        return VS_CODE_OK;
+    }
+
+    file_sz = storage->impl_func.size(storage->impl_data, id);
+    CHECK_RET(file_sz > 0 && file_sz >= data_sz, VS_CODE_ERR_FILE, "There is no data to be deduplicated");
+
+    header.magic = MANIFEST_MAGIC;
+    header.data_sz = data_sz;
+    header.block_sz = VS_FIRMWARE_DEDUP_BLOCK_SIZE;
+    header.tail_sz = file_sz - data_sz;
+    blocks = _blocks_count(&header);
+
+    slot = _free_image_slot();
+    CHECK_RET(slot >= 0, VS_CODE_ERR_NO_MEMORY, "Unable to allocate deduplicated image");
+
+    manifest = VS_IOT_MALLOC(_manifest_size(&header));
+    buf = VS_IOT_MALLOC(header.block_sz);
+    CHECK(manifest && buf, "Unable to allocate memory for firmware deduplication");
+    VS_IOT_MEMCPY(manifest, &header, sizeof(header));
+
+    // Store unique blocks
+    for (block = 0; block < blocks; ++block) {
+        block_sz = _block_size(manifest, block);
+
+        ret_code = vs_firmware_read_data((uint8_t *)id, block * header.block_sz, buf, block_sz, &read_sz);
+        CHECK(VS_CODE_OK == ret_code && read_sz == block_sz, "Unable to read firmware data");
+
+        secmodule->hash_init(&hash_ctx);
+        secmodule->hash_update(&hash_ctx, buf, block_sz);
+        secmodule->hash_finish(&hash_ctx, _block_hash(manifest, block));
+
+        ret_code = _store_chunk(_block_hash(manifest, block), buf, block_sz);
+        CHECK(VS_CODE_OK == ret_code, "Unable to store firmware chunk");
+    }
+
+    if (header.tail_sz) {
+        ret_code = vs_firmware_read_data((uint8_t *)id, data_sz, _manifest_tail(manifest), header.tail_sz, &read_sz);
+        CHECK(VS_CODE_OK == ret_code && read_sz == header.tail_sz, "Unable to read firmware footer");
+    }
+
+    // Image becomes deduplicated when its slot is saved
+    // cppcheck-suppress uninitvar
+    _create_manifest_filename(slot, manifest_id);
+    storage->impl_func.del(storage->impl_data, manifest_id);
+
+    ret_code = vs_firmware_write_data(manifest_id, true, 0, manifest, _manifest_size(manifest));
+    CHECK(VS_CODE_OK == ret_code, "Unable to save firmware manifest");
+
+    ret_code = _save_image_slot(slot, id);
+    if (VS_CODE_OK != ret_code) {
+        storage->impl_func.del(storage->impl_data, manifest_id);
+    }
+    CHECK(VS_CODE_OK == ret_code, "Unable to save deduplicated image");
+
+    VS_IOT_MEMCPY(_images[slot].id, id, sizeof(vs_storage_element_id_t));
+    _images[slot].expanding = false;
+    _images[slot].manifest = manifest;
+    manifest = NULL;
+
+    if (VS_CODE_OK != storage->impl_func.del(storage->impl_data, id)) {
+        VS_LOG_WARNING("Unable to remove deduplicated firmware data");
+    }
+
+terminate:
+    if (manifest) {
+        _release_blocks(manifest, block);
+        VS_IOT_FREE(manifest);
+        if (VS_CODE_OK == ret_code) {
+            ret_code = VS_CODE_ERR_NO_MEMORY;
+        }
+    }
+    VS_IOT_FREE(buf);
+
+    // Remove chunks of failed packing
+    _sweep();
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_dedup_expand(const vs_storage_element_id_t id) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_firmware_dedup_image_t *image;
+    vs_status_e ret_code = VS_CODE_OK;
+    uint8_t *buf;
+    uint32_t offset = 0;
+    size_t size;
+    size_t read_sz;
+    int slot = _find_image(id);
+
+    CHECK_RET(slot >= 0, VS_CODE_ERR_NOT_FOUND, "Storage element is not deduplicated");
+    image = &_images[slot];
+
+    buf = VS_IOT_MALLOC(image->manifest->block_sz);
+    CHECK_NOT_ZERO_RET(buf, VS_CODE_ERR_NO_MEMORY);
+
+    // Restored data is not used until image slot is removed
+    image->expanding = true;
+    size = image->manifest->data_sz + image->manifest->tail_sz;
+    storage->impl_func.del(storage->impl_data, image->id);
+
+    while (VS_CODE_OK == ret_code && offset < size) {
+        ret_code = _read_image(image, offset, buf, image->manifest->block_sz, &read_sz);
+
+        if (VS_CODE_OK == ret_code) {
+            ret_code = vs_firmware_write_data(image->id, offset + read_sz == size, offset, buf, read_sz);
+        }
+
+        offset += read_sz;
+    }
+
+    VS_IOT_FREE(buf);
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = _remove_image(slot);
+    }
+
+    if (VS_CODE_OK != ret_code) {
+        VS_LOG_ERROR("Unable to expand deduplicated firmware");
+        storage->impl_func.del(storage->impl_data, image->id);
+        image->expanding = false;
+    }
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_dedup_delete(const vs_storage_element_id_t id) {
+    vs_storage_op_ctx_t *storage = vs_firmware_storage_ctx();
+    vs_status_e ret_code;
+    int slot = _find_image(id);
+
+    CHECK_RET(slot >= 0, VS_CODE_ERR_NOT_FOUND, "Storage element is not deduplicated");
+
+    STATUS_CHECK_RET(_remove_image(slot), "Unable to remove deduplicated image");
+
+    // Data can be left by interrupted expanding
+    storage->impl_func.del(storage->impl_data, id);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_dedup_init(void) {
+    vs_status_e ret_code;
+
+    vs_firmware_dedup_lock();
+    ret_code = _dedup_init();
+    vs_firmware_dedup_unlock();
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_dedup_read(const vs_storage_element_id_t id,
+                       uint32_t offset,
+                       uint8_t *data,
+                       size_t buff_sz,
+                       size_t *data_sz) {
+    vs_status_e ret_code;
+
+    vs_firmware_dedup_lock();
+    ret_code = _dedup_read(id, offset, data, buff_sz, data_sz);
+    vs_firmware_dedup_unlock();
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_dedup_pack(const vs_storage_element_id_t id, uint32_t data_sz) {
+    vs_status_e ret_code;
+
+    vs_firmware_dedup_lock();
+    ret_code = _dedup_pack(id, data_sz);
+    vs_firmware_dedup_unlock();
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_dedup_expand(const vs_storage_element_id_t id) {
+    vs_status_e ret_code;
+
+    vs_firmware_dedup_lock();
+    ret_code = _dedup_expand(id);
+    vs_firmware_dedup_unlock();
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_dedup_delete(const vs_storage_element_id_t id) {
+    vs_status_e ret_code;
+
+    vs_firmware_dedup_lock();
+    ret_code = _dedup_delete(id);
+    vs_firmware_dedup_unlock();
+
+    return ret_code;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_dedup_firmware(const vs_firmware_descriptor_t *descriptor) {
+    vs_storage_element_id_t data_id;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(descriptor, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    VS_IOT_MEMSET(data_id, 0, sizeof(data_id));
+    VS_IOT_MEMCPY(&data_id[0], descriptor->info.manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE);
+    VS_IOT_MEMCPY(&data_id[VS_DEVICE_MANUFACTURE_ID_SIZE], descriptor->info.device_type, VS_DEVICE_TYPE_SIZE);
+
+    // Buffered chunks must be written before data is moved
+    STATUS_CHECK_RET(vs_firmware_flush_firmware_chunks(), "Unable to flush firmware data");
+
+    return vs_firmware_dedup_pack(data_id, descriptor->firmware_length);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_dedup_stats(vs_firmware_dedup_stats_t *stats) {
+    size_t i;
+
+    CHECK_NOT_ZERO_RET(stats, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    vs_firmware_dedup_lock();
+
+    VS_IOT_MEMSET(stats, 0, sizeof(*stats));
+
+    for (i = 0; i < _images_count; ++i) {
+        if (_images[i].manifest) {
+            stats->images++;
+            stats->logical_size += _images[i].manifest->data_sz;
+        }
+    }
+
+    for (i = 0; i < _chunks_count; ++i) {
+        stats->chunks++;
+        stats->references += _chunks[i].refs;
+        stats->stored_size += _chunks[i].size;
+    }
+
+    vs_firmware_dedup_unlock();
+
+    return VS_CODE_OK;
+}
+
+#endif // FIRMWARE_DEDUP
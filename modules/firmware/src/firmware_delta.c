@@ -0,0 +1,438 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_DELTA
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <endian-config.h>
+
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_delta.h>
+#include <virgil/iot/firmware/firmware_hal.h>
+#include <virgil/iot/logger/logger.h>
+
+#include "private/firmware-private.h"
+#include "private/firmware-encoded.h"
+
+#define DELTA_FILENAME_SUFFIX "delta"
+
+/*************************************************************************/
+static void
+_delta_file(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+            const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+            uint32_t patch_length,
+            vs_firmware_encoded_file_t *file) {
+    vs_firmware_encoded_file_init(file,
+                                  DELTA_FILENAME_SUFFIX,
+                                  manufacture_id,
+                                  device_type,
+                                  sizeof(vs_firmware_delta_header_t),
+                                  patch_length);
+}
+
+/*************************************************************************/
+void
+vs_firmware_delta_ntoh_header(vs_firmware_delta_header_t *header) {
+    VS_IOT_ASSERT(header);
+
+    vs_firmware_ntoh_descriptor(&header->base);
+    vs_firmware_ntoh_descriptor(&header->target);
+    header->patch_length = VS_IOT_NTOHL(header->patch_length);
+}
+
+/*************************************************************************/
+void
+vs_firmware_delta_hton_header(vs_firmware_delta_header_t *header) {
+    VS_IOT_ASSERT(header);
+
+    vs_firmware_hton_descriptor(&header->base);
+    vs_firmware_hton_descriptor(&header->target);
+    header->patch_length = VS_IOT_HTONL(header->patch_length);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_save_header(const vs_firmware_delta_header_t *header) {
+    vs_firmware_encoded_file_t file;
+    vs_firmware_delta_header_t net_header;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _delta_file(header->target.info.manufacture_id, header->target.info.device_type, header->patch_length, &file);
+
+    VS_IOT_MEMCPY(&net_header, header, sizeof(net_header));
+    vs_firmware_delta_hton_header(&net_header);
+
+    return vs_firmware_encoded_save_header(&file, &net_header);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_save_chunk(const vs_firmware_delta_header_t *header,
+                             const uint8_t *chunk,
+                             size_t chunk_sz,
+                             uint32_t offset) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _delta_file(header->target.info.manufacture_id, header->target.info.device_type, header->patch_length, &file);
+
+    return vs_firmware_encoded_save_data(&file, false, offset, chunk, chunk_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_save_footer(const vs_firmware_delta_header_t *header, const uint8_t *footer, size_t footer_sz) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _delta_file(header->target.info.manufacture_id, header->target.info.device_type, header->patch_length, &file);
+
+    return vs_firmware_encoded_save_footer(&file, footer, footer_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                              const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                              vs_firmware_delta_header_t *header) {
+    vs_firmware_encoded_file_t file;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _delta_file(manufacture_id, device_type, 0, &file);
+
+    STATUS_CHECK_RET(vs_firmware_encoded_load_header(&file, header), "Unable to load delta header");
+
+    vs_firmware_delta_ntoh_header(header);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_load_chunk(const vs_firmware_delta_header_t *header,
+                             uint32_t offset,
+                             uint8_t *data,
+                             size_t buf_sz,
+                             size_t *data_sz) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _delta_file(header->target.info.manufacture_id, header->target.info.device_type, header->patch_length, &file);
+
+    return vs_firmware_encoded_load_data(&file, offset, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_load_footer(const vs_firmware_delta_header_t *header, uint8_t *data, size_t buf_sz, size_t *data_sz) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _delta_file(header->target.info.manufacture_id, header->target.info.device_type, header->patch_length, &file);
+
+    return vs_firmware_encoded_load_footer(&file, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_delete(const vs_firmware_delta_header_t *header) {
+    vs_firmware_encoded_file_t file;
+
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    _delta_file(header->target.info.manufacture_id, header->target.info.device_type, header->patch_length, &file);
+
+    return vs_firmware_encoded_delete(&file);
+}
+
+/*************************************************************************/
+static vs_status_e
+_flush_chunk(vs_firmware_delta_ctx_t *ctx) {
+    vs_status_e ret_code;
+
+    if (!ctx->chunk_used) {
+        return VS_CODE_OK;
+    }
+
+    STATUS_CHECK_RET(vs_firmware_save_firmware_chunk(&ctx->header.target, ctx->chunk, ctx->chunk_used, ctx->out_offset),
+                     "Unable to save restored firmware chunk");
+
+    ctx->out_offset += ctx->chunk_used;
+    ctx->chunk_used = 0;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_reserve_output(vs_firmware_delta_ctx_t *ctx, uint32_t sz) {
+    uint32_t produced = ctx->out_offset + ctx->chunk_used;
+
+    CHECK_RET(produced <= ctx->header.target.firmware_length && sz <= ctx->header.target.firmware_length - produced,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Patch produces firmware bigger than %u bytes",
+              ctx->header.target.firmware_length);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_copy_from_own_firmware(vs_firmware_delta_ctx_t *ctx, uint32_t offset, uint32_t sz) {
+    uint16_t piece;
+    vs_status_e ret_code;
+
+    CHECK_RET(offset <= ctx->header.base.firmware_length && sz <= ctx->header.base.firmware_length - offset,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Patch copies data outside of current firmware");
+    STATUS_CHECK_RET(_reserve_output(ctx, sz), "Wrong copy operation");
+
+    while (sz) {
+        piece = ctx->header.target.chunk_size - ctx->chunk_used;
+        if (piece > sz) {
+            piece = sz;
+        }
+
+        STATUS_CHECK_RET(vs_firmware_read_own_firmware_hal(offset, ctx->chunk + ctx->chunk_used, piece),
+                         "Unable to read current firmware");
+
+        ctx->chunk_used += piece;
+        offset += piece;
+        sz -= piece;
+
+        if (ctx->chunk_used == ctx->header.target.chunk_size) {
+            STATUS_CHECK_RET(_flush_chunk(ctx), "Unable to flush restored firmware");
+        }
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_insert_from_patch(vs_firmware_delta_ctx_t *ctx, const uint8_t *data, uint32_t sz) {
+    uint16_t piece;
+    vs_status_e ret_code;
+
+    while (sz) {
+        piece = ctx->header.target.chunk_size - ctx->chunk_used;
+        if (piece > sz) {
+            piece = sz;
+        }
+
+        VS_IOT_MEMCPY(ctx->chunk + ctx->chunk_used, data, piece);
+
+        ctx->chunk_used += piece;
+        data += piece;
+        sz -= piece;
+
+        if (ctx->chunk_used == ctx->header.target.chunk_size) {
+            STATUS_CHECK_RET(_flush_chunk(ctx), "Unable to flush restored firmware");
+        }
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static uint8_t
+_op_header_size(uint8_t op) {
+    switch (op) {
+    case VS_FIRMWARE_DELTA_OP_COPY:
+        return 1 + 2 * sizeof(uint32_t);
+    case VS_FIRMWARE_DELTA_OP_INSERT:
+        return 1 + sizeof(uint32_t);
+    default:
+        return 0;
+    }
+}
+
+/*************************************************************************/
+static uint32_t
+_get_be32(const uint8_t *data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_apply_init(vs_firmware_delta_ctx_t *ctx, const vs_firmware_delta_header_t *header) {
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header->target.chunk_size, VS_CODE_ERR_INCORRECT_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header->target.firmware_length, VS_CODE_ERR_INCORRECT_ARGUMENT);
+    CHECK_RET(0 == VS_IOT_MEMCMP(header->base.info.manufacture_id,
+                                 header->target.info.manufacture_id,
+                                 VS_DEVICE_MANUFACTURE_ID_SIZE),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Delta base and target are for different manufacturers");
+    CHECK_RET(0 == VS_IOT_MEMCMP(header->base.info.device_type, header->target.info.device_type, VS_DEVICE_TYPE_SIZE),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Delta base and target are for different devices");
+
+    VS_IOT_MEMSET(ctx, 0, sizeof(*ctx));
+    VS_IOT_MEMCPY(&ctx->header, header, sizeof(ctx->header));
+
+    ctx->chunk = VS_IOT_MALLOC(header->target.chunk_size);
+    CHECK_NOT_ZERO_RET(ctx->chunk, VS_CODE_ERR_NO_MEMORY);
+
+    VS_LOG_DEBUG("Apply firmware delta %s -> %s, patch size %u bytes",
+                 VS_UPDATE_FILE_VERSION_STR_STATIC(&header->base.info.version),
+                 VS_UPDATE_FILE_VERSION_STR_STATIC(&header->target.info.version),
+                 header->patch_length);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_apply_data(vs_firmware_delta_ctx_t *ctx, const uint8_t *data, uint32_t data_sz) {
+    uint8_t header_sz;
+    uint32_t piece;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(ctx->chunk, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(data_sz <= ctx->header.patch_length - ctx->patch_offset,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Data is outside of patch");
+
+    ctx->patch_offset += data_sz;
+
+    while (data_sz) {
+
+        // Insert operation data
+        if (VS_FIRMWARE_DELTA_OP_INSERT == ctx->op) {
+            piece = ctx->op_rest > data_sz ? data_sz : ctx->op_rest;
+
+            STATUS_CHECK_RET(_insert_from_patch(ctx, data, piece), "Unable to insert patch data");
+
+            data += piece;
+            data_sz -= piece;
+            ctx->op_rest -= piece;
+            if (!ctx->op_rest) {
+                ctx->op = 0;
+            }
+            continue;
+        }
+
+        // Operation header, which can be split between data parts
+        if (!ctx->op_used) {
+            CHECK_RET(_op_header_size(*data), VS_CODE_ERR_FORMAT_OVERFLOW, "Unknown patch operation %u", *data);
+        }
+        header_sz = _op_header_size(ctx->op_used ? ctx->op_buf[0] : *data);
+
+        piece = header_sz - ctx->op_used;
+        if (piece > data_sz) {
+            piece = data_sz;
+        }
+
+        VS_IOT_MEMCPY(ctx->op_buf + ctx->op_used, data, piece);
+        ctx->op_used += piece;
+        data += piece;
+        data_sz -= piece;
+
+        if (ctx->op_used < header_sz) {
+            continue;
+        }
+
+        ctx->op_used = 0;
+
+        if (VS_FIRMWARE_DELTA_OP_COPY == ctx->op_buf[0]) {
+            STATUS_CHECK_RET(_copy_from_own_firmware(ctx, _get_be32(&ctx->op_buf[1]), _get_be32(&ctx->op_buf[5])),
+                             "Unable to copy current firmware data");
+        } else {
+            ctx->op_rest = _get_be32(&ctx->op_buf[1]);
+            STATUS_CHECK_RET(_reserve_output(ctx, ctx->op_rest), "Wrong insert operation");
+            ctx->op = ctx->op_rest ? VS_FIRMWARE_DELTA_OP_INSERT : 0;
+        }
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_delta_apply_finish(vs_firmware_delta_ctx_t *ctx, const uint8_t *footer) {
+    vs_firmware_descriptor_t footer_descriptor;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(ctx->chunk, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(footer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    CHECK_RET(ctx->patch_offset == ctx->header.patch_length && !ctx->op && !ctx->op_used,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Patch is incomplete");
+
+    STATUS_CHECK_RET(_flush_chunk(ctx), "Unable to flush restored firmware");
+
+    CHECK_RET(ctx->out_offset == ctx->header.target.firmware_length,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Restored firmware size %u is not equal to expected %u",
+              ctx->out_offset,
+              ctx->header.target.firmware_length);
+
+    VS_IOT_MEMCPY(&footer_descriptor, &((const vs_firmware_footer_t *)footer)->descriptor, sizeof(footer_descriptor));
+    vs_firmware_ntoh_descriptor(&footer_descriptor);
+    CHECK_RET(0 == VS_IOT_MEMCMP(&footer_descriptor, &ctx->header.target, sizeof(footer_descriptor)),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Invalid firmware descriptor");
+
+    return vs_firmware_save_firmware_footer(&ctx->header.target, footer);
+}
+
+/*************************************************************************/
+void
+vs_firmware_delta_apply_free(vs_firmware_delta_ctx_t *ctx) {
+    VS_IOT_ASSERT(ctx);
+
+    VS_IOT_FREE(ctx->chunk);
+    VS_IOT_MEMSET(ctx, 0, sizeof(*ctx));
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_DELTA
@@ -0,0 +1,197 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_DELTA || FIRMWARE_COMPRESSION || FIRMWARE_CHUNK_HASHES
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/storage_hal/storage_hal.h>
+#include <virgil/iot/logger/logger.h>
+
+#include "private/firmware-private.h"
+#include "private/firmware-encoded.h"
+
+/*************************************************************************/
+void
+vs_firmware_encoded_file_init(vs_firmware_encoded_file_t *file,
+                              const char *suffix,
+                              const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                              const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                              uint32_t header_sz,
+                              uint32_t payload_sz) {
+    size_t suffix_sz;
+
+    VS_IOT_ASSERT(file);
+    VS_IOT_ASSERT(suffix);
+
+    suffix_sz = VS_IOT_STRLEN(suffix);
+    VS_IOT_ASSERT(suffix_sz <= sizeof(vs_storage_element_id_t) - VS_DEVICE_MANUFACTURE_ID_SIZE - VS_DEVICE_TYPE_SIZE);
+
+    VS_IOT_MEMSET(file->id, 0, sizeof(vs_storage_element_id_t));
+    VS_IOT_MEMCPY(&file->id[0], manufacture_id, VS_DEVICE_MANUFACTURE_ID_SIZE);
+    VS_IOT_MEMCPY(&file->id[VS_DEVICE_MANUFACTURE_ID_SIZE], device_type, VS_DEVICE_TYPE_SIZE);
+    VS_IOT_MEMCPY(&file->id[VS_DEVICE_MANUFACTURE_ID_SIZE + VS_DEVICE_TYPE_SIZE], suffix, suffix_sz);
+
+    file->header_sz = header_sz;
+    file->payload_sz = payload_sz;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_encoded_save_header(const vs_firmware_encoded_file_t *file, const void *net_header) {
+    vs_storage_op_ctx_t *storage_ctx = vs_firmware_storage_ctx();
+
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(net_header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(storage_ctx->impl_func.del, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // Footer size is calculated by file size, so previous file has to be removed
+    storage_ctx->impl_func.del(storage_ctx->impl_data, file->id);
+
+    return vs_firmware_write_data((uint8_t *)file->id, true, 0, net_header, file->header_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_encoded_save_data(const vs_firmware_encoded_file_t *file,
+                              bool need_sync,
+                              uint32_t offset,
+                              const void *data,
+                              size_t data_sz) {
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(offset <= file->payload_sz && data_sz <= file->payload_sz - offset,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Data is outside of file payload");
+
+    return vs_firmware_write_data((uint8_t *)file->id, need_sync, file->header_sz + offset, data, data_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_encoded_save_footer(const vs_firmware_encoded_file_t *file, const uint8_t *footer, size_t footer_sz) {
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(footer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(footer_sz >= sizeof(vs_firmware_footer_t) && footer_sz < UINT16_MAX,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Incorrect footer size");
+
+    return vs_firmware_write_data((uint8_t *)file->id, true, file->header_sz + file->payload_sz, footer, footer_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_encoded_load_header(const vs_firmware_encoded_file_t *file, void *net_header) {
+    size_t read_sz;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(net_header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    STATUS_CHECK_RET(vs_firmware_read_data((uint8_t *)file->id, 0, net_header, file->header_sz, &read_sz),
+                     "Unable to load header");
+    CHECK_RET(file->header_sz == read_sz, VS_CODE_ERR_FILE_READ, "Incorrect header size");
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_encoded_load_data(const vs_firmware_encoded_file_t *file,
+                              uint32_t offset,
+                              uint8_t *data,
+                              size_t buf_sz,
+                              size_t *data_sz) {
+    size_t rest;
+
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data_sz, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(offset < file->payload_sz, VS_CODE_ERR_INCORRECT_ARGUMENT, "Offset is outside of file payload");
+
+    rest = file->payload_sz - offset;
+
+    return vs_firmware_read_data(
+            (uint8_t *)file->id, file->header_sz + offset, data, buf_sz > rest ? rest : buf_sz, data_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_encoded_load_footer(const vs_firmware_encoded_file_t *file, uint8_t *data, size_t buf_sz, size_t *data_sz) {
+    vs_storage_op_ctx_t *storage_ctx = vs_firmware_storage_ctx();
+    uint32_t footer_offset;
+    ssize_t file_sz;
+
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data_sz, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(storage_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    *data_sz = 0;
+
+    file_sz = storage_ctx->impl_func.size(storage_ctx->impl_data, file->id);
+    footer_offset = file->header_sz + file->payload_sz;
+
+    CHECK_RET(file_sz > footer_offset, VS_CODE_ERR_FILE_READ, "There is no footer");
+    CHECK_RET(file_sz - footer_offset < UINT16_MAX, VS_CODE_ERR_FORMAT_OVERFLOW, "Incorrect footer size");
+    CHECK_RET((size_t)(file_sz - footer_offset) <= buf_sz, VS_CODE_ERR_TOO_SMALL_BUFFER, "Buffer to small");
+
+    return vs_firmware_read_data((uint8_t *)file->id, footer_offset, data, file_sz - footer_offset, data_sz);
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_encoded_delete(const vs_firmware_encoded_file_t *file) {
+    vs_storage_op_ctx_t *storage_ctx = vs_firmware_storage_ctx();
+
+    CHECK_NOT_ZERO_RET(file, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(storage_ctx->impl_func.del, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    CHECK_RET(VS_CODE_OK == storage_ctx->impl_func.del(storage_ctx->impl_data, file->id),
+              VS_CODE_ERR_FILE_DELETE,
+              "Unable to delete encoded firmware file");
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_DELTA || FIRMWARE_COMPRESSION || FIRMWARE_CHUNK_HASHES
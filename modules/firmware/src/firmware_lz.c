@@ -0,0 +1,190 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_COMPRESSION
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <update-config.h>
+
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/firmware/firmware_compression.h>
+#include <virgil/iot/logger/logger.h>
+
+#if VS_FIRMWARE_LZ_WINDOW_BITS < 8 || VS_FIRMWARE_LZ_WINDOW_BITS > VS_FIRMWARE_LZ_MAX_WINDOW_BITS
+#error "VS_FIRMWARE_LZ_WINDOW_BITS must be in 8..12 range"
+#endif
+
+static const uint8_t _lz_magic[] = {'V', 'L', 'Z'};
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_lz_decode_init(vs_firmware_lz_ctx_t *ctx) {
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    VS_IOT_MEMSET(ctx, 0, sizeof(*ctx));
+
+    ctx->window = VS_IOT_CALLOC(1, 1 << VS_FIRMWARE_LZ_WINDOW_BITS);
+    CHECK_NOT_ZERO_RET(ctx->window, VS_CODE_ERR_NO_MEMORY);
+
+    ctx->window_mask = (1 << VS_FIRMWARE_LZ_WINDOW_BITS) - 1;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+void
+vs_firmware_lz_decode_free(vs_firmware_lz_ctx_t *ctx) {
+    VS_IOT_ASSERT(ctx);
+
+    VS_IOT_FREE(ctx->window);
+    VS_IOT_MEMSET(ctx, 0, sizeof(*ctx));
+}
+
+/*************************************************************************/
+static vs_status_e
+_check_header(const vs_firmware_lz_ctx_t *ctx) {
+    uint8_t window_bits = ctx->header[sizeof(_lz_magic)];
+
+    CHECK_RET(0 == VS_IOT_MEMCMP(ctx->header, _lz_magic, sizeof(_lz_magic)),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Data is not LZ compressed");
+    CHECK_RET(window_bits <= VS_FIRMWARE_LZ_WINDOW_BITS,
+              VS_CODE_ERR_UNSUPPORTED_PARAMETER,
+              "LZ window 2^%u is bigger than supported 2^%u",
+              window_bits,
+              VS_FIRMWARE_LZ_WINDOW_BITS);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_lz_decode(vs_firmware_lz_ctx_t *ctx,
+                      const uint8_t *in,
+                      size_t in_sz,
+                      size_t *in_used,
+                      uint8_t *out,
+                      size_t out_sz,
+                      size_t *out_used) {
+    const uint8_t *in_end = in + in_sz;
+    uint8_t *out_start = out;
+    uint8_t *out_end = out + out_sz;
+    uint8_t *window;
+    uint16_t mask;
+    uint16_t pos;
+    uint16_t token;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(ctx->window, VS_CODE_ERR_NOINIT);
+    CHECK_NOT_ZERO_RET(in, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(in_used, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(out, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(out_used, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    *in_used = 0;
+    *out_used = 0;
+
+    // Stream header
+    while (ctx->header_used < VS_FIRMWARE_LZ_HEADER_SIZE && in < in_end) {
+        ctx->header[ctx->header_used++] = *in++;
+        if (VS_FIRMWARE_LZ_HEADER_SIZE == ctx->header_used) {
+            STATUS_CHECK_RET(_check_header(ctx), "Wrong LZ stream header");
+        }
+    }
+
+    window = ctx->window;
+    mask = ctx->window_mask;
+    pos = ctx->window_pos;
+
+    while (out < out_end) {
+
+        // Match copying can be interrupted by full output buffer
+        if (ctx->match_left) {
+            *out = window[(pos - ctx->match_distance) & mask];
+            window[pos] = *out++;
+            pos = (pos + 1) & mask;
+            --ctx->match_left;
+            continue;
+        }
+
+        if (in == in_end) {
+            break;
+        }
+
+        if (!ctx->flags_left) {
+            ctx->flags = *in++;
+            ctx->flags_left = 8;
+            continue;
+        }
+
+        // Literal
+        if (ctx->flags & 1) {
+            *out = *in++;
+            window[pos] = *out++;
+            pos = (pos + 1) & mask;
+            ctx->flags >>= 1;
+            --ctx->flags_left;
+            continue;
+        }
+
+        // Match, which can be split between input parts
+        if (!ctx->match_started) {
+            ctx->match_hi = *in++;
+            ctx->match_started = true;
+            continue;
+        }
+
+        token = ((uint16_t)ctx->match_hi << 8) | *in++;
+        ctx->match_started = false;
+        ctx->match_distance = (token >> 4) + 1;
+        ctx->match_left = (token & 0x0F) + VS_FIRMWARE_LZ_MIN_MATCH;
+        ctx->flags >>= 1;
+        --ctx->flags_left;
+    }
+
+    ctx->window_pos = pos;
+
+    *in_used = in_sz - (in_end - in);
+    *out_used = out - out_start;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_COMPRESSION
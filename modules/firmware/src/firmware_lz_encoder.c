@@ -0,0 +1,201 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_COMPRESSION
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/status_code/status_code.h>
+#include <virgil/iot/firmware/firmware_compression.h>
+#include <virgil/iot/logger/logger.h>
+
+#define LZ_HASH_BITS (12)
+#define LZ_MAX_CHAIN (64)
+#define LZ_NO_POS (-1)
+
+/*************************************************************************/
+static uint16_t
+_hash(const uint8_t *data) {
+    uint32_t key = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+    return (key * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+/*************************************************************************/
+static void
+_insert(int32_t *head, int32_t *prev, uint16_t window_mask, const uint8_t *in, size_t in_sz, size_t pos) {
+    uint16_t hash;
+
+    if (pos + VS_FIRMWARE_LZ_MIN_MATCH > in_sz) {
+        return;
+    }
+
+    hash = _hash(&in[pos]);
+    prev[pos & window_mask] = head[hash];
+    head[hash] = pos;
+}
+
+/*************************************************************************/
+static size_t
+_find_match(const int32_t *head,
+            const int32_t *prev,
+            size_t window_sz,
+            const uint8_t *in,
+            size_t in_sz,
+            size_t pos,
+            size_t *distance) {
+    size_t max_len = in_sz - pos;
+    size_t best_len = 0;
+    size_t len;
+    int32_t cand;
+    int chain = 0;
+
+    if (max_len < VS_FIRMWARE_LZ_MIN_MATCH) {
+        return 0;
+    }
+    if (max_len > VS_FIRMWARE_LZ_MAX_MATCH) {
+        max_len = VS_FIRMWARE_LZ_MAX_MATCH;
+    }
+
+    cand = head[_hash(&in[pos])];
+    while (cand != LZ_NO_POS && pos - cand <= window_sz && chain++ < LZ_MAX_CHAIN) {
+        for (len = 0; len < max_len && in[cand + len] == in[pos + len]; ++len) {
+        }
+
+        if (len > best_len) {
+            best_len = len;
+            *distance = pos - cand;
+            if (len == max_len) {
+                break;
+            }
+        }
+
+        // Older positions are overwritten in the circular chain
+        if (prev[cand & (window_sz - 1)] >= cand) {
+            break;
+        }
+        cand = prev[cand & (window_sz - 1)];
+    }
+
+    return best_len >= VS_FIRMWARE_LZ_MIN_MATCH ? best_len : 0;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_lz_encode(const uint8_t *in,
+                      size_t in_sz,
+                      uint8_t window_bits,
+                      uint8_t *out,
+                      size_t out_buf_sz,
+                      size_t *out_sz) {
+    size_t window_sz;
+    int32_t *head = NULL;
+    int32_t *prev = NULL;
+    uint8_t *flags = NULL;
+    uint8_t flags_cnt = 8;
+    size_t out_pos = 0;
+    size_t pos = 0;
+    size_t len;
+    size_t distance = 0;
+    size_t i;
+    uint16_t token;
+    vs_status_e ret_code = VS_CODE_ERR_NO_MEMORY;
+
+    CHECK_NOT_ZERO_RET(in, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(out, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(out_sz, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(window_bits >= 8 && window_bits <= VS_FIRMWARE_LZ_MAX_WINDOW_BITS,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Unsupported LZ window 2^%u",
+              window_bits);
+    CHECK_RET(out_buf_sz >= VS_FIRMWARE_LZ_HEADER_SIZE, VS_CODE_ERR_TOO_SMALL_BUFFER, "Output buffer is too small");
+
+    window_sz = 1 << window_bits;
+
+    head = VS_IOT_MALLOC(sizeof(int32_t) << LZ_HASH_BITS);
+    prev = VS_IOT_MALLOC(sizeof(int32_t) * window_sz);
+    CHECK(head && prev, "No memory for LZ encoder");
+    ret_code = VS_CODE_ERR_TOO_SMALL_BUFFER;
+
+    for (i = 0; i < (1 << LZ_HASH_BITS); ++i) {
+        head[i] = LZ_NO_POS;
+    }
+
+    out[out_pos++] = 'V';
+    out[out_pos++] = 'L';
+    out[out_pos++] = 'Z';
+    out[out_pos++] = window_bits;
+
+    while (pos < in_sz) {
+        if (8 == flags_cnt) {
+            CHECK(out_pos < out_buf_sz, "Output buffer is too small");
+            flags = &out[out_pos++];
+            *flags = 0;
+            flags_cnt = 0;
+        }
+
+        len = _find_match(head, prev, window_sz, in, in_sz, pos, &distance);
+
+        if (len) {
+            CHECK(out_pos + 2 <= out_buf_sz, "Output buffer is too small");
+            token = ((distance - 1) << 4) | (len - VS_FIRMWARE_LZ_MIN_MATCH);
+            out[out_pos++] = token >> 8;
+            out[out_pos++] = token & 0xFF;
+        } else {
+            CHECK(out_pos < out_buf_sz, "Output buffer is too small");
+            *flags |= 1 << flags_cnt;
+            out[out_pos++] = in[pos];
+            len = 1;
+        }
+        ++flags_cnt;
+
+        for (i = 0; i < len; ++i, ++pos) {
+            _insert(head, prev, window_sz - 1, in, in_sz, pos);
+        }
+    }
+
+    *out_sz = out_pos;
+    ret_code = VS_CODE_OK;
+
+terminate:
+    VS_IOT_FREE(head);
+    VS_IOT_FREE(prev);
+
+    return ret_code;
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_COMPRESSION
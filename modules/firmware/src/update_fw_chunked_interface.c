@@ -0,0 +1,226 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_CHUNK_HASHES
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_chunk_hashes.h>
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/update/update.h>
+#include <virgil/iot/macros/macros.h>
+
+#include "private/firmware-private.h"
+#include "private/firmware-encoded.h"
+
+static vs_update_interface_t _chunked_update_ctx = {.storage_context = NULL};
+static vs_firmware_chunks_ctx_t _chunks_ctx;
+
+/*************************************************************************/
+static void
+_chunked_ntoh_header(void *header) {
+    vs_firmware_chunked_ntoh_header(header);
+}
+
+/*************************************************************************/
+static void
+_chunked_hton_header(void *header) {
+    vs_firmware_chunked_hton_header(header);
+}
+
+/*************************************************************************/
+static uint32_t
+_chunked_data_size(const void *header) {
+    const vs_firmware_chunked_header_t *chunked_header = header;
+
+    return chunked_header->hashes_length + chunked_header->descriptor.firmware_length;
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                     const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                     void *header) {
+    return vs_firmware_chunked_load_header(manufacture_id, device_type, header);
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_load_data(const void *header, uint32_t offset, uint8_t *data, size_t buf_sz, size_t *data_sz) {
+    const vs_firmware_chunked_header_t *chunked_header = header;
+    const vs_firmware_descriptor_t *descriptor = &chunked_header->descriptor;
+    uint32_t fw_offset;
+    uint32_t fw_rest;
+    size_t chunk_size;
+
+    if (offset < chunked_header->hashes_length) {
+        return vs_firmware_chunked_load_hashes(chunked_header, offset, data, buf_sz, data_sz);
+    }
+
+    // Each data part is a whole firmware chunk, so it can be verified by thing
+    fw_offset = offset - chunked_header->hashes_length;
+    CHECK_RET(fw_offset < descriptor->firmware_length && 0 == fw_offset % descriptor->chunk_size,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Incorrect firmware chunk offset %u",
+              fw_offset);
+
+    fw_rest = descriptor->firmware_length - fw_offset;
+    chunk_size = fw_rest > descriptor->chunk_size ? descriptor->chunk_size : fw_rest;
+
+    CHECK_RET(buf_sz >= chunk_size,
+              VS_CODE_ERR_TOO_SMALL_BUFFER,
+              "Buffer size %u bytes is not enough to store firmware chunk %u bytes size",
+              (uint32_t)buf_sz,
+              (uint32_t)chunk_size);
+
+    return vs_firmware_load_firmware_chunk(descriptor, fw_offset, data, chunk_size, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_load_footer(const void *header, uint8_t *data, size_t buf_sz, size_t *data_sz) {
+    const vs_firmware_chunked_header_t *chunked_header = header;
+
+    return vs_firmware_load_firmware_footer(&chunked_header->descriptor, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_delete_file(const void *header) {
+    return vs_firmware_chunked_delete(header);
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_current_header(const vs_update_file_type_t *file_type, void *header) {
+    vs_firmware_chunked_header_t *chunked_header = header;
+
+    // Thing has no stored hashes table, so it reports the firmware saved or installed by it
+    return vs_firmware_load_firmware_descriptor(
+            file_type->info.manufacture_id, file_type->info.device_type, &chunked_header->descriptor);
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_check_header(const void *header) {
+    const vs_firmware_chunked_header_t *chunked_header = header;
+
+    CHECK_RET(chunked_header->hashes_length < UINT32_MAX - chunked_header->descriptor.firmware_length,
+              VS_CODE_ERR_FORMAT_OVERFLOW,
+              "Chunked firmware is too big");
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_start(const void *header) {
+    return vs_firmware_chunks_init(&_chunks_ctx, header);
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_save_data(const uint8_t *data, uint32_t data_sz, uint32_t offset) {
+    if (offset < _chunks_ctx.header.hashes_length) {
+        return vs_firmware_chunks_save_hashes(&_chunks_ctx, offset, data, data_sz);
+    }
+
+    return vs_firmware_chunks_save_chunk(&_chunks_ctx, offset - _chunks_ctx.header.hashes_length, data, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_chunked_finish(const uint8_t *footer) {
+    // Chunks are verified already, but the whole image signatures are required for installation
+    if (!vs_firmware_chunks_is_complete(&_chunks_ctx)) {
+        VS_LOG_WARNING("Chunked firmware is incomplete");
+        return VS_CODE_ERR_VERIFY;
+    }
+
+    return vs_firmware_save_firmware_footer(&_chunks_ctx.header.descriptor, footer);
+}
+
+/*************************************************************************/
+static void
+_chunked_stop(void) {
+    vs_firmware_chunks_free(&_chunks_ctx);
+}
+
+// Gateway keeps the whole firmware as well, so its signatures are checked directly
+static const vs_firmware_encoded_type_t _chunked_type = {
+        .file_type = VS_UPDATE_FIRMWARE_CHUNKED,
+        .name = "chunked",
+        .header_sz = sizeof(vs_firmware_chunked_header_t),
+        .descriptor_offset = offsetof(vs_firmware_chunked_header_t, descriptor),
+        .ntoh_header = _chunked_ntoh_header,
+        .hton_header = _chunked_hton_header,
+        .data_size = _chunked_data_size,
+        .load_header = _chunked_load_header,
+        .load_data = _chunked_load_data,
+        .load_footer = _chunked_load_footer,
+        .delete_file = _chunked_delete_file,
+        .current_header = _chunked_current_header,
+        .check_header = _chunked_check_header,
+        .start = _chunked_start,
+        .save_data = _chunked_save_data,
+        .finish = _chunked_finish,
+        .stop = _chunked_stop,
+        .verify = NULL,
+};
+
+/*************************************************************************/
+vs_status_e
+vs_update_firmware_chunked_init(vs_storage_op_ctx_t *storage_ctx,
+                                vs_device_manufacture_id_t manufacture,
+                                vs_device_type_t device_type) {
+    return vs_firmware_encoded_update_init(&_chunked_update_ctx, &_chunked_type, storage_ctx, manufacture, device_type);
+}
+
+/*************************************************************************/
+vs_update_interface_t *
+vs_firmware_chunked_update_ctx(void) {
+    return &_chunked_update_ctx;
+}
+
+/*************************************************************************/
+const vs_update_file_type_t *
+vs_firmware_chunked_update_file_type(void) {
+    return vs_firmware_encoded_update_file_type(VS_UPDATE_FIRMWARE_CHUNKED);
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_CHUNK_HASHES
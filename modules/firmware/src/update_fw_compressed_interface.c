@@ -0,0 +1,190 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_COMPRESSION
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_compression.h>
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/update/update.h>
+#include <virgil/iot/macros/macros.h>
+
+#include "private/firmware-private.h"
+#include "private/firmware-encoded.h"
+
+static vs_update_interface_t _compressed_update_ctx = {.storage_context = NULL};
+static vs_firmware_compressed_ctx_t _compressed_apply_ctx;
+
+/*************************************************************************/
+static void
+_compressed_ntoh_header(void *header) {
+    vs_firmware_compressed_ntoh_header(header);
+}
+
+/*************************************************************************/
+static void
+_compressed_hton_header(void *header) {
+    vs_firmware_compressed_hton_header(header);
+}
+
+/*************************************************************************/
+static uint32_t
+_compressed_data_size(const void *header) {
+    return ((const vs_firmware_compressed_header_t *)header)->compressed_length;
+}
+
+/*************************************************************************/
+static vs_status_e
+_compressed_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                        const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                        void *header) {
+    return vs_firmware_compressed_load_header(manufacture_id, device_type, header);
+}
+
+/*************************************************************************/
+static vs_status_e
+_compressed_load_data(const void *header, uint32_t offset, uint8_t *data, size_t buf_sz, size_t *data_sz) {
+    return vs_firmware_compressed_load_chunk(header, offset, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_compressed_load_footer(const void *header, uint8_t *data, size_t buf_sz, size_t *data_sz) {
+    return vs_firmware_compressed_load_footer(header, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_compressed_delete_file(const void *header) {
+    return vs_firmware_compressed_delete(header);
+}
+
+/*************************************************************************/
+static vs_status_e
+_compressed_current_header(const vs_update_file_type_t *file_type, void *header) {
+    vs_firmware_compressed_header_t *compressed_header = header;
+
+    // Thing has no stored compressed firmware, so it reports the firmware saved or installed by it
+    return vs_firmware_load_firmware_descriptor(
+            file_type->info.manufacture_id, file_type->info.device_type, &compressed_header->descriptor);
+}
+
+/*************************************************************************/
+static vs_status_e
+_compressed_start(const void *header) {
+    const vs_firmware_compressed_header_t *compressed_header = header;
+
+    return vs_firmware_compressed_apply_init(
+            &_compressed_apply_ctx, &compressed_header->descriptor, compressed_header->compressed_length);
+}
+
+/*************************************************************************/
+static vs_status_e
+_compressed_save_data(const uint8_t *data, uint32_t data_sz, uint32_t offset) {
+    // Stream is decompressed sequentially, repeated data parts are skipped
+    if (offset < _compressed_apply_ctx.compressed_offset) {
+        VS_LOG_DEBUG("Skip already decompressed data, offset %u", offset);
+        return VS_CODE_OK;
+    }
+
+    CHECK_RET(offset == _compressed_apply_ctx.compressed_offset,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Compressed data offset %u while %u is expected",
+              offset,
+              _compressed_apply_ctx.compressed_offset);
+
+    return vs_firmware_compressed_apply_data(&_compressed_apply_ctx, data, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_compressed_finish(const uint8_t *footer) {
+    return vs_firmware_compressed_apply_finish(&_compressed_apply_ctx, footer);
+}
+
+/*************************************************************************/
+static void
+_compressed_stop(void) {
+    vs_firmware_compressed_apply_free(&_compressed_apply_ctx);
+}
+
+// Gateway keeps decompressed firmware as well, so its signatures are checked directly
+static const vs_firmware_encoded_type_t _compressed_type = {
+        .file_type = VS_UPDATE_FIRMWARE_COMPRESSED,
+        .name = "compressed",
+        .header_sz = sizeof(vs_firmware_compressed_header_t),
+        .descriptor_offset = offsetof(vs_firmware_compressed_header_t, descriptor),
+        .ntoh_header = _compressed_ntoh_header,
+        .hton_header = _compressed_hton_header,
+        .data_size = _compressed_data_size,
+        .load_header = _compressed_load_header,
+        .load_data = _compressed_load_data,
+        .load_footer = _compressed_load_footer,
+        .delete_file = _compressed_delete_file,
+        .current_header = _compressed_current_header,
+        .check_header = NULL,
+        .start = _compressed_start,
+        .save_data = _compressed_save_data,
+        .finish = _compressed_finish,
+        .stop = _compressed_stop,
+        .verify = NULL,
+};
+
+/*************************************************************************/
+vs_status_e
+vs_update_firmware_compressed_init(vs_storage_op_ctx_t *storage_ctx,
+                                   vs_device_manufacture_id_t manufacture,
+                                   vs_device_type_t device_type) {
+    return vs_firmware_encoded_update_init(
+            &_compressed_update_ctx, &_compressed_type, storage_ctx, manufacture, device_type);
+}
+
+/*************************************************************************/
+vs_update_interface_t *
+vs_firmware_compressed_update_ctx(void) {
+    return &_compressed_update_ctx;
+}
+
+/*************************************************************************/
+const vs_update_file_type_t *
+vs_firmware_compressed_update_file_type(void) {
+    return vs_firmware_encoded_update_file_type(VS_UPDATE_FIRMWARE_COMPRESSED);
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_COMPRESSION
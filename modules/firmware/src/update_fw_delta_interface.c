@@ -0,0 +1,252 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_DELTA
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_delta.h>
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/update/update.h>
+#include <virgil/iot/macros/macros.h>
+
+#include "private/firmware-private.h"
+#include "private/firmware-encoded.h"
+
+static vs_update_interface_t _delta_update_ctx = {.storage_context = NULL};
+static vs_firmware_delta_ctx_t _delta_apply_ctx;
+static vs_device_manufacture_id_t _manufacture;
+static vs_device_type_t _device_type;
+
+/*************************************************************************/
+static void
+_delta_ntoh_header(void *header) {
+    vs_firmware_delta_ntoh_header(header);
+}
+
+/*************************************************************************/
+static void
+_delta_hton_header(void *header) {
+    vs_firmware_delta_hton_header(header);
+}
+
+/*************************************************************************/
+static uint32_t
+_delta_data_size(const void *header) {
+    return ((const vs_firmware_delta_header_t *)header)->patch_length;
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_load_header(const uint8_t manufacture_id[VS_DEVICE_MANUFACTURE_ID_SIZE],
+                   const uint8_t device_type[VS_DEVICE_TYPE_SIZE],
+                   void *header) {
+    return vs_firmware_delta_load_header(manufacture_id, device_type, header);
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_load_data(const void *header, uint32_t offset, uint8_t *data, size_t buf_sz, size_t *data_sz) {
+    return vs_firmware_delta_load_chunk(header, offset, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_load_footer(const void *header, uint8_t *data, size_t buf_sz, size_t *data_sz) {
+    return vs_firmware_delta_load_footer(header, data, buf_sz, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_delete_file(const void *header) {
+    return vs_firmware_delta_delete(header);
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_current_header(const vs_update_file_type_t *file_type, void *header) {
+    vs_firmware_delta_header_t *delta_header = header;
+
+    // Thing has no stored delta, so it reports version of the running firmware
+    if (0 != VS_IOT_MEMCMP(file_type->info.manufacture_id, _manufacture, sizeof(_manufacture)) ||
+        0 != VS_IOT_MEMCMP(file_type->info.device_type, _device_type, sizeof(_device_type)) ||
+        VS_CODE_OK != vs_firmware_get_own_firmware_descriptor(&delta_header->target)) {
+        return VS_CODE_ERR_NOT_FOUND;
+    }
+
+    VS_IOT_MEMCPY(&delta_header->base, &delta_header->target, sizeof(delta_header->base));
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_check_header(const void *header) {
+    const vs_firmware_delta_header_t *delta_header = header;
+    vs_firmware_descriptor_t own_descriptor;
+    vs_status_e ret_code;
+
+    // Patch is applicable to the running firmware only
+    STATUS_CHECK_RET(vs_firmware_get_own_firmware_descriptor(&own_descriptor), "Unable to get own firmware descriptor");
+    CHECK_RET(0 == VS_IOT_MEMCMP(&own_descriptor.info, &delta_header->base.info, sizeof(own_descriptor.info)),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Delta is made for firmware %s",
+              VS_UPDATE_FILE_VERSION_STR_STATIC(&delta_header->base.info.version));
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_start(const void *header) {
+    return vs_firmware_delta_apply_init(&_delta_apply_ctx, header);
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_save_data(const uint8_t *data, uint32_t data_sz, uint32_t offset) {
+    // Patch is applied sequentially, repeated data parts are skipped
+    if (offset < _delta_apply_ctx.patch_offset) {
+        VS_LOG_DEBUG("Skip already applied patch data, offset %u", offset);
+        return VS_CODE_OK;
+    }
+
+    CHECK_RET(offset == _delta_apply_ctx.patch_offset,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Patch data offset %u while %u is expected",
+              offset,
+              _delta_apply_ctx.patch_offset);
+
+    return vs_firmware_delta_apply_data(&_delta_apply_ctx, data, data_sz);
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_finish(const uint8_t *footer) {
+    return vs_firmware_delta_apply_finish(&_delta_apply_ctx, footer);
+}
+
+/*************************************************************************/
+static void
+_delta_stop(void) {
+    vs_firmware_delta_apply_free(&_delta_apply_ctx);
+}
+
+/*************************************************************************/
+static vs_status_e
+_delta_verify(const void *header) {
+    const vs_firmware_delta_header_t *delta_header = header;
+    vs_firmware_footer_t *footer;
+    uint8_t *buf = NULL;
+    size_t buf_sz;
+    size_t footer_sz;
+    vs_status_e ret_code;
+
+    // Signatures are checked by Thing against restored firmware, so only the footer consistency is checked here
+    buf_sz = vs_firmware_get_expected_footer_len();
+    buf = VS_IOT_CALLOC(1, buf_sz);
+    CHECK_NOT_ZERO_RET(buf, VS_CODE_ERR_NO_MEMORY);
+
+    STATUS_CHECK(vs_firmware_delta_load_footer(delta_header, buf, buf_sz, &footer_sz), "Unable to load delta footer");
+
+    footer = (vs_firmware_footer_t *)buf;
+    vs_firmware_ntoh_descriptor(&footer->descriptor);
+
+    ret_code = VS_CODE_OK;
+    if (0 != VS_IOT_MEMCMP(&footer->descriptor, &delta_header->target, sizeof(delta_header->target))) {
+        VS_LOG_WARNING("Firmware delta footer doesn't correspond to its header");
+        ret_code = VS_CODE_ERR_VERIFY;
+    }
+
+terminate:
+    VS_IOT_FREE(buf);
+
+    return ret_code;
+}
+
+static const vs_firmware_encoded_type_t _delta_type = {
+        .file_type = VS_UPDATE_FIRMWARE_DELTA,
+        .name = "delta",
+        .header_sz = sizeof(vs_firmware_delta_header_t),
+        .descriptor_offset = offsetof(vs_firmware_delta_header_t, target),
+        .ntoh_header = _delta_ntoh_header,
+        .hton_header = _delta_hton_header,
+        .data_size = _delta_data_size,
+        .load_header = _delta_load_header,
+        .load_data = _delta_load_data,
+        .load_footer = _delta_load_footer,
+        .delete_file = _delta_delete_file,
+        .current_header = _delta_current_header,
+        .check_header = _delta_check_header,
+        .start = _delta_start,
+        .save_data = _delta_save_data,
+        .finish = _delta_finish,
+        .stop = _delta_stop,
+        .verify = _delta_verify,
+};
+
+/*************************************************************************/
+vs_status_e
+vs_update_firmware_delta_init(vs_storage_op_ctx_t *storage_ctx,
+                              vs_device_manufacture_id_t manufacture,
+                              vs_device_type_t device_type) {
+    vs_status_e ret_code;
+
+    STATUS_CHECK_RET(
+            vs_firmware_encoded_update_init(&_delta_update_ctx, &_delta_type, storage_ctx, manufacture, device_type),
+            "Unable to initialize firmware delta update interface");
+
+    VS_IOT_MEMCPY(_manufacture, manufacture, sizeof(_manufacture));
+    VS_IOT_MEMCPY(_device_type, device_type, sizeof(_device_type));
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_update_interface_t *
+vs_firmware_delta_update_ctx(void) {
+    return &_delta_update_ctx;
+}
+
+/*************************************************************************/
+const vs_update_file_type_t *
+vs_firmware_delta_update_file_type(void) {
+    return vs_firmware_encoded_update_file_type(VS_UPDATE_FIRMWARE_DELTA);
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_DELTA
@@ -0,0 +1,535 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#if FIRMWARE_DELTA || FIRMWARE_COMPRESSION || FIRMWARE_CHUNK_HASHES
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/update/update.h>
+#include <virgil/iot/macros/macros.h>
+
+#include "private/firmware-private.h"
+#include "private/firmware-encoded.h"
+
+#define ENCODED_TYPES_MAX (3)
+
+typedef struct {
+    const vs_firmware_encoded_type_t *type;
+    vs_update_file_type_t file_type;
+    vs_firmware_descriptor_t descriptor; // Firmware being received
+    bool receiving;
+} vs_firmware_encoded_slot_t;
+
+static vs_firmware_encoded_slot_t _slots[ENCODED_TYPES_MAX];
+
+/*************************************************************************/
+static vs_firmware_encoded_slot_t *
+_find_slot(uint16_t file_type) {
+    size_t pos;
+
+    for (pos = 0; pos < ENCODED_TYPES_MAX; ++pos) {
+        if (_slots[pos].type && _slots[pos].type->file_type == file_type) {
+            return &_slots[pos];
+        }
+    }
+
+    return NULL;
+}
+
+/*************************************************************************/
+static vs_firmware_descriptor_t *
+_descriptor(const vs_firmware_encoded_type_t *type, void *header) {
+    return (vs_firmware_descriptor_t *)((uint8_t *)header + type->descriptor_offset);
+}
+
+/*************************************************************************/
+static void
+_stop_receiving(vs_firmware_encoded_slot_t *slot) {
+    slot->type->stop();
+    slot->receiving = false;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_get_header(void *context,
+                           vs_update_file_type_t *file_type,
+                           void *header_buffer,
+                           uint32_t buffer_size,
+                           uint32_t *header_size) {
+    vs_firmware_encoded_slot_t *slot;
+    const vs_firmware_encoded_type_t *type;
+    vs_firmware_descriptor_t *descriptor;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header_buffer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+
+    type = slot->type;
+    descriptor = _descriptor(type, header_buffer);
+
+    *header_size = type->header_sz;
+    CHECK_RET(buffer_size >= *header_size,
+              VS_CODE_ERR_TOO_SMALL_BUFFER,
+              "Buffer size %d bytes is not enough to store header %d bytes size",
+              buffer_size,
+              *header_size);
+
+    if (VS_CODE_OK != type->load_header(file_type->info.manufacture_id, file_type->info.device_type, header_buffer)) {
+        VS_IOT_MEMSET(header_buffer, 0, type->header_sz);
+
+        // Thing has no stored file, so it reports the firmware it has
+        if (!type->current_header || VS_CODE_OK != type->current_header(file_type, header_buffer)) {
+            VS_LOG_WARNING("Unable to load %s firmware header", type->name);
+            VS_IOT_MEMCPY(&descriptor->info.manufacture_id,
+                          file_type->info.manufacture_id,
+                          sizeof(descriptor->info.manufacture_id));
+            VS_IOT_MEMCPY(&descriptor->info.device_type,
+                          file_type->info.device_type,
+                          sizeof(descriptor->info.device_type));
+        }
+    }
+
+    VS_IOT_MEMCPY(&file_type->info, &descriptor->info, sizeof(descriptor->info));
+
+    // Normalize byte order
+    type->hton_header(header_buffer);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_get_data(void *context,
+                         vs_update_file_type_t *file_type,
+                         const void *file_header,
+                         void *data_buffer,
+                         uint32_t buffer_size,
+                         uint32_t *data_size,
+                         uint32_t data_offset) {
+    vs_firmware_encoded_slot_t *slot;
+    vs_status_e ret_code;
+    size_t chunk_size;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data_buffer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(buffer_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+
+    uint8_t header[slot->type->header_sz];
+    VS_IOT_MEMCPY(header, file_header, sizeof(header));
+
+    // Normalize byte order
+    slot->type->ntoh_header(header);
+
+    ret_code = slot->type->load_data(header, data_offset, data_buffer, buffer_size, &chunk_size);
+    *data_size = chunk_size;
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_get_footer(void *context,
+                           vs_update_file_type_t *file_type,
+                           const void *file_header,
+                           void *footer_buffer,
+                           uint32_t buffer_size,
+                           uint32_t *footer_size) {
+    vs_firmware_encoded_slot_t *slot;
+    vs_status_e ret_code;
+    size_t data_sz;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(footer_buffer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(buffer_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(footer_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+
+    uint8_t header[slot->type->header_sz];
+    VS_IOT_MEMCPY(header, file_header, sizeof(header));
+
+    // Normalize byte order
+    slot->type->ntoh_header(header);
+
+    ret_code = slot->type->load_footer(header, footer_buffer, buffer_size, &data_sz);
+    *footer_size = data_sz;
+
+    return ret_code;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_set_header(void *context,
+                           vs_update_file_type_t *file_type,
+                           const void *file_header,
+                           uint32_t header_size,
+                           uint32_t *file_size) {
+    vs_firmware_encoded_slot_t *slot;
+    const vs_firmware_encoded_type_t *type;
+    void *header = (void *)file_header;
+    vs_status_e ret_code;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+
+    type = slot->type;
+
+    CHECK_RET(header_size == type->header_sz,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Incorrect header size %d byte while %s firmware header is %d bytes length",
+              header_size,
+              type->name,
+              type->header_sz);
+
+    // Normalize byte order
+    type->ntoh_header(header);
+
+    if (type->check_header) {
+        STATUS_CHECK_RET(type->check_header(header), "Wrong %s firmware header", type->name);
+    }
+
+    _stop_receiving(slot);
+
+    VS_IOT_MEMCPY(&slot->descriptor, _descriptor(type, header), sizeof(slot->descriptor));
+
+    STATUS_CHECK_RET(vs_firmware_save_firmware_descriptor(&slot->descriptor), "Unable to save firmware descriptor");
+    STATUS_CHECK_RET(type->start(header), "Unable to start %s firmware receiving", type->name);
+
+    slot->receiving = true;
+    *file_size = type->data_size(header);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_set_data(void *context,
+                         vs_update_file_type_t *file_type,
+                         const void *file_header,
+                         const void *file_data,
+                         uint32_t data_size,
+                         uint32_t data_offset) {
+    vs_firmware_encoded_slot_t *slot;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(data_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+    CHECK_RET(slot->receiving, VS_CODE_ERR_NOINIT, "There is no %s firmware receiving", slot->type->name);
+
+    return slot->type->save_data(file_data, data_size, data_offset);
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_set_footer(void *context,
+                           vs_update_file_type_t *file_type,
+                           const void *file_header,
+                           const void *file_footer,
+                           uint32_t footer_size) {
+    vs_firmware_encoded_slot_t *slot;
+    vs_firmware_descriptor_t fw_descr;
+    vs_status_e res = VS_CODE_ERR_NOINIT;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_footer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(footer_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+
+    VS_IOT_MEMCPY(&fw_descr, &slot->descriptor, sizeof(fw_descr));
+
+    if (slot->receiving) {
+        res = vs_firmware_check_footer_size(file_footer, footer_size);
+        if (VS_CODE_OK == res) {
+            res = slot->type->finish(file_footer);
+        }
+        _stop_receiving(slot);
+    }
+
+    if (VS_CODE_OK != res || VS_CODE_OK != vs_firmware_verify_firmware(&fw_descr)) {
+        VS_LOG_WARNING("Error while receiving %s firmware", slot->type->name);
+
+        if (VS_CODE_OK != (res = vs_firmware_delete_firmware(&fw_descr))) {
+            VS_LOG_ERROR("Unable to delete firmware");
+            return res;
+        }
+
+        return VS_CODE_ERR_VERIFY;
+    }
+
+    return vs_firmware_install_firmware(&fw_descr);
+}
+
+/*************************************************************************/
+static void
+_encoded_update_delete_object(void *context, vs_update_file_type_t *file_type) {
+    vs_firmware_encoded_slot_t *slot;
+    (void)context;
+
+    if (!file_type || NULL == (slot = _find_slot(file_type->type))) {
+        return;
+    }
+
+    if (slot->receiving) {
+        vs_firmware_delete_firmware(&slot->descriptor);
+        _stop_receiving(slot);
+    }
+
+    uint8_t header[slot->type->header_sz];
+    if (VS_CODE_OK ==
+        slot->type->load_header(file_type->info.manufacture_id, file_type->info.device_type, header)) {
+        slot->type->delete_file(header);
+    }
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_verify_object(void *context, vs_update_file_type_t *file_type) {
+    vs_firmware_encoded_slot_t *slot;
+    vs_status_e ret_code;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+
+    uint8_t header[slot->type->header_sz];
+    STATUS_CHECK_RET(slot->type->load_header(file_type->info.manufacture_id, file_type->info.device_type, header),
+                     "Unable to load %s firmware header",
+                     slot->type->name);
+
+    if (slot->type->verify) {
+        return slot->type->verify(header);
+    }
+
+    // Gateway keeps received firmware as well, so its signatures are checked directly
+    if (VS_CODE_OK != vs_firmware_verify_firmware(_descriptor(slot->type, header))) {
+        VS_LOG_WARNING("Error while verifying firmware");
+        return VS_CODE_ERR_VERIFY;
+    }
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static void
+_encoded_update_free_item(void *context, vs_update_file_type_t *file_type) {
+    (void)context;
+    (void)file_type;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_periodical(void *context, vs_update_file_type_t *file_type) {
+    (void)context;
+    (void)file_type;
+
+    // Decoded firmware is written by vs_firmware_save_firmware_chunk()
+    return vs_firmware_flush_expired_chunks();
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_get_header_size(void *context, vs_update_file_type_t *file_type, uint32_t *header_size) {
+    vs_firmware_encoded_slot_t *slot;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(header_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+
+    *header_size = slot->type->header_sz;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_get_file_size(void *context,
+                              vs_update_file_type_t *file_type,
+                              const void *file_header,
+                              uint32_t *file_size) {
+    vs_firmware_encoded_slot_t *slot;
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_header, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(file_type->type);
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NOINIT);
+
+    uint8_t header[slot->type->header_sz];
+    VS_IOT_MEMCPY(header, file_header, sizeof(header));
+
+    // Normalize byte order
+    slot->type->ntoh_header(header);
+
+    *file_size = slot->type->data_size(header);
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_has_footer(void *context, vs_update_file_type_t *file_type, bool *has_footer) {
+    (void)context;
+    (void)file_type;
+
+    CHECK_NOT_ZERO_RET(has_footer, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    *has_footer = true;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+static vs_status_e
+_encoded_update_inc_data_offset(void *context,
+                                vs_update_file_type_t *file_type,
+                                uint32_t current_offset,
+                                uint32_t loaded_data_size,
+                                uint32_t *next_offset) {
+    (void)context;
+    (void)file_type;
+    size_t offset;
+
+    CHECK_NOT_ZERO_RET(next_offset, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    offset = current_offset + loaded_data_size;
+    CHECK_RET(offset < UINT32_MAX, VS_CODE_ERR_INCORRECT_ARGUMENT, "Next offset is outside of file");
+
+    *next_offset = offset;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+vs_status_e
+vs_firmware_encoded_update_init(vs_update_interface_t *update_ctx,
+                                const vs_firmware_encoded_type_t *type,
+                                vs_storage_op_ctx_t *storage_ctx,
+                                vs_device_manufacture_id_t manufacture,
+                                vs_device_type_t device_type) {
+    vs_firmware_encoded_slot_t *slot;
+    size_t pos;
+
+    CHECK_NOT_ZERO_RET(update_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(manufacture, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(device_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    slot = _find_slot(type->file_type);
+    for (pos = 0; !slot && pos < ENCODED_TYPES_MAX; ++pos) {
+        if (!_slots[pos].type) {
+            slot = &_slots[pos];
+        }
+    }
+    CHECK_NOT_ZERO_RET(slot, VS_CODE_ERR_NO_MEMORY);
+
+    type->stop();
+
+    VS_IOT_MEMSET(slot, 0, sizeof(*slot));
+    slot->type = type;
+    slot->file_type.type = type->file_type;
+    VS_IOT_MEMCPY(slot->file_type.info.manufacture_id, manufacture, sizeof(vs_device_manufacture_id_t));
+    VS_IOT_MEMCPY(slot->file_type.info.device_type, device_type, sizeof(vs_device_type_t));
+
+    VS_IOT_MEMSET(update_ctx, 0, sizeof(*update_ctx));
+
+    update_ctx->get_header_size = _encoded_update_get_header_size;
+    update_ctx->get_file_size = _encoded_update_get_file_size;
+    update_ctx->has_footer = _encoded_update_has_footer;
+    update_ctx->inc_data_offset = _encoded_update_inc_data_offset;
+    update_ctx->get_header = _encoded_update_get_header;
+    update_ctx->get_data = _encoded_update_get_data;
+    update_ctx->get_footer = _encoded_update_get_footer;
+    update_ctx->set_header = _encoded_update_set_header;
+    update_ctx->set_data = _encoded_update_set_data;
+    update_ctx->set_footer = _encoded_update_set_footer;
+    update_ctx->free_item = _encoded_update_free_item;
+    update_ctx->verify_object = _encoded_update_verify_object;
+    update_ctx->delete_object = _encoded_update_delete_object;
+    update_ctx->periodical = _encoded_update_periodical;
+    update_ctx->storage_context = storage_ctx;
+
+    return VS_CODE_OK;
+}
+
+/*************************************************************************/
+const vs_update_file_type_t *
+vs_firmware_encoded_update_file_type(uint16_t file_type) {
+    vs_firmware_encoded_slot_t *slot = _find_slot(file_type);
+
+    VS_IOT_ASSERT(slot);
+
+    return slot ? &slot->file_type : NULL;
+}
+
+/*************************************************************************/
+
+#endif // FIRMWARE_DELTA || FIRMWARE_COMPRESSION || FIRMWARE_CHUNK_HASHES
@@ -38,6 +38,8 @@
 #include <endian-config.h>
 
 #include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_cache.h>
+#include <virgil/iot/firmware/firmware_relay.h>
 #include <virgil/iot/logger/logger.h>
 #include <virgil/iot/update/update.h>
 #include <virgil/iot/macros/macros.h>
@@ -289,6 +291,43 @@ _fw_update_free_item(void *context, vs_update_file_type_t *file_type) {
     (void)file_type;
 }
 
+#if FIRMWARE_CACHE
+/*************************************************************************/
+static void
+_fw_update_file_requested(void *context, const vs_update_file_type_t *file_type) {
+    (void)context;
+
+    if (file_type) {
+        vs_firmware_cache_request(&file_type->info);
+    }
+}
+#endif // FIRMWARE_CACHE
+
+/*************************************************************************/
+static vs_status_e
+_fw_update_periodical(void *context, vs_update_file_type_t *file_type) {
+    (void)context;
+    (void)file_type;
+
+    return vs_firmware_flush_expired_chunks();
+}
+
+#if FIRMWARE_CUT_THROUGH
+/*************************************************************************/
+static vs_status_e
+_fw_update_get_available_size(void *context,
+                              vs_update_file_type_t *file_type,
+                              uint32_t *available_size,
+                              bool *is_complete) {
+    (void)context;
+
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return vs_firmware_relay_available(
+            file_type->info.manufacture_id, file_type->info.device_type, available_size, is_complete);
+}
+#endif // FIRMWARE_CUT_THROUGH
+
 /*************************************************************************/
 static vs_status_e
 _fw_update_get_header_size(void *context, vs_update_file_type_t *file_type, uint32_t *header_size) {
@@ -387,6 +426,13 @@ vs_update_firmware_init(vs_storage_op_ctx_t *storage_ctx,
     _fw_update_ctx.free_item = _fw_update_free_item;
     _fw_update_ctx.verify_object = _fw_update_verify_object;
     _fw_update_ctx.delete_object = _fw_update_delete_object;
+    _fw_update_ctx.periodical = _fw_update_periodical;
+#if FIRMWARE_CACHE
+    _fw_update_ctx.file_requested = _fw_update_file_requested;
+#endif // FIRMWARE_CACHE
+#if FIRMWARE_CUT_THROUGH
+    _fw_update_ctx.get_available_size = _fw_update_get_available_size;
+#endif // FIRMWARE_CUT_THROUGH
     _fw_update_ctx.storage_context = storage_ctx;
 
     VS_IOT_MEMCPY(_manufacture, manufacture, sizeof(_manufacture));
@@ -0,0 +1,68 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#ifndef VS_FLDT_MAPPING_H
+#define VS_FLDT_MAPPING_H
+
+#include <virgil/iot/update/update.h>
+#include <virgil/iot/status_code/status_code.h>
+
+// Hashed index of FLDT file type mapping elements.
+// Each element is allocated separately, so pointers stay valid until element removal.
+// Element structure MUST start with vs_update_file_type_t field, which is used as a key.
+// elem_sz MUST be set statically, other fields are zero for an empty index.
+typedef struct {
+    void **slots;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t tombstones;
+    size_t elem_sz;
+} vs_fldt_mapping_t;
+
+void *
+vs_fldt_mapping_find(const vs_fldt_mapping_t *mapping, const vs_update_file_type_t *file_type);
+
+vs_status_e
+vs_fldt_mapping_add(vs_fldt_mapping_t *mapping, const vs_update_file_type_t *file_type, void **elem);
+
+void
+vs_fldt_mapping_remove(vs_fldt_mapping_t *mapping, void *elem);
+
+void *
+vs_fldt_mapping_next(const vs_fldt_mapping_t *mapping, uint32_t *pos);
+
+void
+vs_fldt_mapping_clear(vs_fldt_mapping_t *mapping);
+
+#endif // VS_FLDT_MAPPING_H
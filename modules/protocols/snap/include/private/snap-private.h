@@ -43,4 +43,7 @@ _snap_fill_header(const vs_mac_addr_t *recipient_mac, vs_snap_packet_t *packet);
 vs_snap_transaction_id_t
 _snap_transaction_id();
 
+const vs_mac_addr_t *
+_snap_request_sender(void);
+
 #endif // VS_SNAP_PRIVATE_H
@@ -85,6 +85,19 @@
  * \endcode
  *
  * In this example _app_restart() function is called for firmware that has been successfully updated.
+ *
+ * \section fldt_client_retransmission FLDT Client Retransmissions
+ *
+ * Lost requests are repeated after retransmission timeout. It is calculated for each file type from measured
+ * round-trip time and its variation (RFC 6298) within #VS_FLDT_RTO_MIN_MS .. #VS_FLDT_RTO_MAX_MS range and is doubled
+ * for each retry. Timeouts are checked by SNAP periodical processing using #vs_impl_msec time, so its call period
+ * limits recovery time. Call it several times per second to benefit from fast links. If platform has no millisecond
+ * clock (#VS_IMPL_MSEC is 0), timeout is not less than 2 seconds.
+ *
+ * \section fldt_client_telemetry FLDT Client Telemetry
+ *
+ * #vs_fldt_client_get_stats returns progress, retries, round-trip time and duration of the current or the last file
+ * download. The last download statistics is published by INFO service too, see #VS_SNAP_INFO_FLDT.
  */
 
 #ifndef VS_SECURITY_SDK_SNAP_SERVICES_FLDT_CLIENT_H
@@ -155,6 +168,32 @@ vs_fldt_client_add_file_type(const vs_update_file_type_t *file_type, vs_update_i
 vs_status_e
 vs_fldt_client_request_all_files(void);
 
+/** FLDT client download statistics */
+typedef struct {
+    vs_update_file_type_t type; /**< File type with version that is being downloaded or has been downloaded */
+    bool in_progress;           /**< File is being downloaded */
+    bool completed;             /**< File has been successfully downloaded */
+    uint32_t file_size;         /**< File size without header and footer. 0 if it is unknown */
+    uint32_t received_size;     /**< Received file data size */
+    uint32_t retries;           /**< Requests repeated after retransmission timeout */
+    uint32_t postponed;         /**< Requests postponed by gateway */
+    uint32_t srtt_ms;           /**< Smoothed round-trip time. 0 if it has not been measured */
+    uint32_t rto_ms;            /**< Current retransmission timeout */
+    uint32_t duration_ms;       /**< Time since download start or download duration if it has been finished */
+    uint32_t eta_ms;            /**< Estimated time to completion. 0 if it is unknown */
+    vs_status_e last_error;     /**< Result of the last finished download */
+} vs_fldt_client_stats_t;
+
+/** Get FLDT client download statistics
+ *
+ * \param[in] file_type File type to get statistics for. NULL to get statistics for the last started download.
+ * \param[out] stats Output buffer for statistics. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code. #VS_CODE_ERR_NOT_FOUND if there were no downloads.
+ */
+vs_status_e
+vs_fldt_client_get_stats(const vs_update_file_type_t *file_type, vs_fldt_client_stats_t *stats);
+
 #ifdef __cplusplus
 } // extern "C"
 } // namespace VirgilIoTKit
@@ -153,6 +153,13 @@ typedef struct __attribute__((__packed__)) {
     uint8_t footer_data[];
 } vs_fldt_gnff_footer_response_t;
 
+// "Retry later" hint. Negative response to GNFH, GNFD or GNFF request of busy gateway
+typedef struct __attribute__((__packed__)) {
+    vs_update_file_type_t type;
+    uint32_t offset;
+    uint32_t delay_ms;
+} vs_fldt_retry_later_t;
+
 typedef struct {
     vs_update_file_type_t type;
     vs_file_version_t prev_file_version; // for client only
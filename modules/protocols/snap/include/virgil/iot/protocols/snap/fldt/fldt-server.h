@@ -82,6 +82,19 @@
  * }
  * \endcode
  *
+ * \section fldt_server_scheduling FLDT Server Transfers Scheduling
+ *
+ * Not more than #VS_FLDT_SERVER_TRANSFERS_MAX transfers download file data simultaneously. Transfer is identified by
+ * client MAC address and file type, so a client downloading several files takes one transfer per file. Each
+ * #VS_FLDT_SERVER_ROUND_MS round #VS_FLDT_SERVER_ROUND_CHUNKS data responses are shared equally between them. Clients
+ * that are not admitted or have exhausted their part receive negative response with "retry later" hint, so FLDT
+ * clients postpone their requests instead of timing out.
+ *
+ * \section fldt_server_telemetry FLDT Server Telemetry
+ *
+ * #vs_fldt_server_get_stats returns active transfers with amount of data served to each client, chunk rate and file
+ * information cache hits. The same counters are published by INFO service, see #VS_SNAP_INFO_FLDT.
+ *
  */
 
 #ifndef VS_SECURITY_SDK_SNAP_SERVICES_FLDT_SERVER_H
@@ -143,6 +156,45 @@ vs_fldt_server_add_file_type(const vs_update_file_type_t *file_type,
                              vs_update_interface_t *update_context,
                              bool broadcast_file_info);
 
+/** FLDT server statistics
+ *
+ * Counters are accumulated since #vs_snap_fldt_server call.
+ */
+typedef struct {
+    uint32_t active_transfers;    /**< Clients that are downloading file data now */
+    uint32_t transfers_completed; /**< Clients that have received file footer */
+    uint32_t bytes_served;        /**< File data bytes sent to all clients */
+    uint32_t chunks_served;       /**< Data responses sent to all clients */
+    uint32_t chunk_rate;          /**< Data responses per second during the last scheduling round */
+    uint32_t retry_later;         /**< Requests answered by "retry later" hint */
+    uint32_t cache_hits;          /**< Requests served by file information that has been already loaded */
+    uint32_t cache_misses;        /**< Requests that have required file information loading */
+} vs_fldt_server_stats_t;
+
+/** FLDT server transfer statistics */
+typedef struct {
+    vs_mac_addr_t client_mac;   /**< Client MAC address */
+    vs_update_file_type_t type; /**< File being downloaded by this client */
+    uint32_t bytes_served;      /**< File data bytes sent to this client */
+    uint32_t chunks_served;     /**< Data responses sent to this client */
+    uint32_t duration_ms;       /**< Time since transfer admission */
+} vs_fldt_server_transfer_stats_t;
+
+/** Get FLDT server statistics
+ *
+ * \param[out] stats Output buffer for server statistics. Must not be NULL.
+ * \param[out] transfers Output buffer for active transfers statistics. Can be NULL.
+ * \param[in] transfers_max Amount of \a transfers elements.
+ * \param[out] transfers_cnt Amount of active transfers stored to \a transfers. Can be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_fldt_server_get_stats(vs_fldt_server_stats_t *stats,
+                         vs_fldt_server_transfer_stats_t *transfers,
+                         uint32_t transfers_max,
+                         uint32_t *transfers_cnt);
+
 #ifdef __cplusplus
 } // extern "C"
 } // namespace VirgilIoTKit
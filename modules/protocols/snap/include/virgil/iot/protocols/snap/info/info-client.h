@@ -181,6 +181,18 @@ typedef vs_status_e (*vs_snap_info_general_cb_t)(vs_info_general_t *general_info
  */
 typedef vs_status_e (*vs_snap_info_statistics_cb_t)(vs_info_statistics_t *statistics);
 
+/** FLDT statistics request
+ *
+ * This function is called by receiving device FLDT statistics.
+ *
+ * FLDT statistics polling is started by #vs_snap_info_set_polling call when \a elements contains VS_SNAP_INFO_FLDT bit.
+ *
+ * \param[in] fldt_statistics FLDT server and client statistics. Cannot be NULL.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+typedef vs_status_e (*vs_snap_info_fldt_cb_t)(vs_info_fldt_statistics_t *fldt_statistics);
+
 /** INFO client implementations
  *
  * \note Any callback can be NULL. In this case standard flow will be used.
@@ -190,6 +202,7 @@ typedef struct {
     vs_snap_info_start_notif_cb_t device_start; /**< Startup notification */
     vs_snap_info_general_cb_t general_info;     /**< General information */
     vs_snap_info_statistics_cb_t statistics;    /**< Device statistics */
+    vs_snap_info_fldt_cb_t fldt_statistics;     /**< FLDT statistics */
 } vs_snap_info_client_service_t;
 
 /** INFO Client SNAP Service implementation
@@ -55,6 +55,7 @@ typedef enum {
     VS_INFO_GINF = HTONL_IN_COMPILE_TIME('GINF'), /* General INFormation */
     VS_INFO_STAT = HTONL_IN_COMPILE_TIME('STAT'), /* STATistics */
     VS_INFO_POLL = HTONL_IN_COMPILE_TIME('POLL'), /* Enable/disable POLLing of INFO elements by mask */
+    VS_INFO_FLDT = HTONL_IN_COMPILE_TIME('FLDT'), /* FLDT transfers statistics */
 } vs_snap_info_element_e;
 #pragma GCC diagnostic pop
 
@@ -78,6 +79,34 @@ typedef struct __attribute__((__packed__)) {
     vs_mac_addr_t mac;
 } vs_info_stat_response_t;
 
+typedef struct __attribute__((__packed__)) {
+    vs_mac_addr_t mac;
+
+    // FLDT server
+    uint32_t active_transfers;
+    uint32_t transfers_completed;
+    uint32_t bytes_served;
+    uint32_t chunks_served;
+    uint32_t chunk_rate;
+    uint32_t retry_later;
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+
+    // FLDT client
+    vs_update_file_type_t file_type;
+    uint8_t in_progress;
+    uint8_t completed;
+    uint32_t file_size;
+    uint32_t received_size;
+    uint32_t retries;
+    uint32_t postponed;
+    uint32_t srtt_ms;
+    uint32_t rto_ms;
+    uint32_t duration_ms;
+    uint32_t eta_ms;
+    int32_t last_error; // vs_status_e
+} vs_info_fldt_response_t;
+
 typedef struct __attribute__((__packed__)) {
     uint32_t elements; // CODEGEN: SKIP
     uint8_t enable;
@@ -46,6 +46,7 @@
 #include <virgil/iot/trust_list/trust_list.h>
 #include <virgil/iot/trust_list/tl_structs.h>
 #include <virgil/iot/protocols/snap/snap-structs.h>
+#include <virgil/iot/update/update.h>
 
 #ifdef __cplusplus
 namespace VirgilIoTKit {
@@ -97,6 +98,37 @@ typedef struct {
     uint8_t default_netif_mac[ETH_ADDR_LEN];
 } vs_info_statistics_t;
 
+/** FLDT statistics
+ *
+ * FLDT server and client statistics as parameter for #vs_snap_info_fldt_cb_t call. Fields of the role that is not
+ * supported by device are zero. See #vs_fldt_server_stats_t and #vs_fldt_client_stats_t for details.
+ */
+typedef struct {
+    uint8_t default_netif_mac[ETH_ADDR_LEN]; /**< Default network interface MAC address*/
+
+    uint32_t active_transfers;    /**< Server : clients that are downloading file data now */
+    uint32_t transfers_completed; /**< Server : clients that have received file footer */
+    uint32_t bytes_served;        /**< Server : file data bytes sent to all clients */
+    uint32_t chunks_served;       /**< Server : data responses sent to all clients */
+    uint32_t chunk_rate;          /**< Server : data responses per second */
+    uint32_t retry_later;         /**< Server : requests answered by "retry later" hint */
+    uint32_t cache_hits;          /**< Server : requests served by already loaded file information */
+    uint32_t cache_misses;        /**< Server : requests that have required file information loading */
+
+    vs_update_file_type_t file_type; /**< Client : the last downloaded file */
+    bool in_progress;                /**< Client : file is being downloaded */
+    bool completed;                  /**< Client : file has been successfully downloaded */
+    uint32_t file_size;              /**< Client : file size */
+    uint32_t received_size;          /**< Client : received file data size */
+    uint32_t retries;                /**< Client : requests repeated after retransmission timeout */
+    uint32_t postponed;              /**< Client : requests postponed by gateway */
+    uint32_t srtt_ms;                /**< Client : smoothed round-trip time */
+    uint32_t rto_ms;                 /**< Client : retransmission timeout */
+    uint32_t duration_ms;            /**< Client : download duration */
+    uint32_t eta_ms;                 /**< Client : estimated time to completion */
+    vs_status_e last_error;          /**< Client : result of the last finished download */
+} vs_info_fldt_statistics_t;
+
 /** Device statistics
  *
  * Element mask for #vs_snap_info_set_polling call
@@ -105,6 +137,7 @@ typedef enum {
     VS_SNAP_INFO_GENERAL =
             HTONL_IN_COMPILE_TIME(0x0001), /**< General device information #vs_info_general_t will be sent */
     VS_SNAP_INFO_STATISTICS = HTONL_IN_COMPILE_TIME(0x0002), /**< Device statistic #vs_info_statistics_t will be sent */
+    VS_SNAP_INFO_FLDT = HTONL_IN_COMPILE_TIME(0x0004), /**< FLDT statistics #vs_info_fldt_statistics_t will be sent */
 } vs_snap_info_element_mask_e;
 
 #ifdef __cplusplus
@@ -36,89 +36,51 @@
 
 
 /******************************************************************************/
-// Converting encode function for (vs_info_stat_response_t)
-void
-vs_info_stat_response_t_encode(vs_info_stat_response_t *src_data) {
-    src_data->sent = VS_IOT_HTONL(src_data->sent);
-    src_data->received = VS_IOT_HTONL(src_data->received);
-}
-
-/******************************************************************************/
-// Converting decode function for (vs_info_stat_response_t)
-void
-vs_info_stat_response_t_decode(vs_info_stat_response_t *src_data) {
-    src_data->sent = VS_IOT_NTOHL(src_data->sent);
-    src_data->received = VS_IOT_NTOHL(src_data->received);
-}
-
-/******************************************************************************/
-// Converting encode function for (vs_fldt_file_info_t)
-void
-vs_fldt_file_info_t_encode(vs_fldt_file_info_t *src_data) {
-    vs_update_file_type_t_encode(&src_data->type);
-}
-
-/******************************************************************************/
-// Converting decode function for (vs_fldt_file_info_t)
-void
-vs_fldt_file_info_t_decode(vs_fldt_file_info_t *src_data) {
-    vs_update_file_type_t_decode(&src_data->type);
-}
-
-/******************************************************************************/
-// Converting encode function for (vs_fldt_gnfh_header_response_t)
+// Converting encode function for (vs_ethernet_header_t)
 void
-vs_fldt_gnfh_header_response_t_encode(vs_fldt_gnfh_header_response_t *src_data) {
-    src_data->header_size = VS_IOT_HTONS(src_data->header_size);
-    vs_fldt_file_info_t_encode(&src_data->fldt_info);
-    src_data->file_size = VS_IOT_HTONL(src_data->file_size);
+vs_ethernet_header_t_encode(vs_ethernet_header_t *src_data) {
+    src_data->type = VS_IOT_HTONS(src_data->type);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_fldt_gnfh_header_response_t)
+// Converting decode function for (vs_ethernet_header_t)
 void
-vs_fldt_gnfh_header_response_t_decode(vs_fldt_gnfh_header_response_t *src_data) {
-    src_data->header_size = VS_IOT_NTOHS(src_data->header_size);
-    vs_fldt_file_info_t_decode(&src_data->fldt_info);
-    src_data->file_size = VS_IOT_NTOHL(src_data->file_size);
+vs_ethernet_header_t_decode(vs_ethernet_header_t *src_data) {
+    src_data->type = VS_IOT_NTOHS(src_data->type);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_fldt_gnfd_data_response_t)
+// Converting encode function for (vs_snap_header_t)
 void
-vs_fldt_gnfd_data_response_t_encode(vs_fldt_gnfd_data_response_t *src_data) {
-    vs_update_file_type_t_encode(&src_data->type);
-    src_data->offset = VS_IOT_HTONL(src_data->offset);
-    src_data->next_offset = VS_IOT_HTONL(src_data->next_offset);
-    src_data->data_size = VS_IOT_HTONS(src_data->data_size);
+vs_snap_header_t_encode(vs_snap_header_t *src_data) {
+    src_data->transaction_id = VS_IOT_HTONS(src_data->transaction_id);
+    src_data->padding = VS_IOT_HTONS(src_data->padding);
+    src_data->content_size = VS_IOT_HTONS(src_data->content_size);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_fldt_gnfd_data_response_t)
+// Converting decode function for (vs_snap_header_t)
 void
-vs_fldt_gnfd_data_response_t_decode(vs_fldt_gnfd_data_response_t *src_data) {
-    vs_update_file_type_t_decode(&src_data->type);
-    src_data->offset = VS_IOT_NTOHL(src_data->offset);
-    src_data->next_offset = VS_IOT_NTOHL(src_data->next_offset);
-    src_data->data_size = VS_IOT_NTOHS(src_data->data_size);
+vs_snap_header_t_decode(vs_snap_header_t *src_data) {
+    src_data->transaction_id = VS_IOT_NTOHS(src_data->transaction_id);
+    src_data->padding = VS_IOT_NTOHS(src_data->padding);
+    src_data->content_size = VS_IOT_NTOHS(src_data->content_size);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_pubkey_dated_t)
+// Converting encode function for (vs_snap_packet_t)
 void
-vs_pubkey_dated_t_encode(vs_pubkey_dated_t *src_data) {
-    src_data->start_date = VS_IOT_HTONL(src_data->start_date);
-    src_data->expire_date = VS_IOT_HTONL(src_data->expire_date);
-    vs_pubkey_t_encode(&src_data->pubkey);
+vs_snap_packet_t_encode(vs_snap_packet_t *src_data) {
+    vs_ethernet_header_t_encode(&src_data->eth_header);
+    vs_snap_header_t_encode(&src_data->header);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_pubkey_dated_t)
+// Converting decode function for (vs_snap_packet_t)
 void
-vs_pubkey_dated_t_decode(vs_pubkey_dated_t *src_data) {
-    src_data->start_date = VS_IOT_NTOHL(src_data->start_date);
-    src_data->expire_date = VS_IOT_NTOHL(src_data->expire_date);
-    vs_pubkey_t_decode(&src_data->pubkey);
+vs_snap_packet_t_decode(vs_snap_packet_t *src_data) {
+    vs_ethernet_header_t_decode(&src_data->eth_header);
+    vs_snap_header_t_decode(&src_data->header);
 }
 
 /******************************************************************************/
@@ -153,6 +115,70 @@ vs_info_ginf_response_t_decode(vs_info_ginf_response_t *src_data) {
     src_data->device_roles = VS_IOT_NTOHL(src_data->device_roles);
 }
 
+/******************************************************************************/
+// Converting encode function for (vs_info_stat_response_t)
+void
+vs_info_stat_response_t_encode(vs_info_stat_response_t *src_data) {
+    src_data->sent = VS_IOT_HTONL(src_data->sent);
+    src_data->received = VS_IOT_HTONL(src_data->received);
+}
+
+/******************************************************************************/
+// Converting decode function for (vs_info_stat_response_t)
+void
+vs_info_stat_response_t_decode(vs_info_stat_response_t *src_data) {
+    src_data->sent = VS_IOT_NTOHL(src_data->sent);
+    src_data->received = VS_IOT_NTOHL(src_data->received);
+}
+
+/******************************************************************************/
+// Converting encode function for (vs_info_fldt_response_t)
+void
+vs_info_fldt_response_t_encode(vs_info_fldt_response_t *src_data) {
+    src_data->active_transfers = VS_IOT_HTONL(src_data->active_transfers);
+    src_data->transfers_completed = VS_IOT_HTONL(src_data->transfers_completed);
+    src_data->bytes_served = VS_IOT_HTONL(src_data->bytes_served);
+    src_data->chunks_served = VS_IOT_HTONL(src_data->chunks_served);
+    src_data->chunk_rate = VS_IOT_HTONL(src_data->chunk_rate);
+    src_data->retry_later = VS_IOT_HTONL(src_data->retry_later);
+    src_data->cache_hits = VS_IOT_HTONL(src_data->cache_hits);
+    src_data->cache_misses = VS_IOT_HTONL(src_data->cache_misses);
+    vs_update_file_type_t_encode(&src_data->file_type);
+    src_data->file_size = VS_IOT_HTONL(src_data->file_size);
+    src_data->received_size = VS_IOT_HTONL(src_data->received_size);
+    src_data->retries = VS_IOT_HTONL(src_data->retries);
+    src_data->postponed = VS_IOT_HTONL(src_data->postponed);
+    src_data->srtt_ms = VS_IOT_HTONL(src_data->srtt_ms);
+    src_data->rto_ms = VS_IOT_HTONL(src_data->rto_ms);
+    src_data->duration_ms = VS_IOT_HTONL(src_data->duration_ms);
+    src_data->eta_ms = VS_IOT_HTONL(src_data->eta_ms);
+    src_data->last_error = (int32_t)VS_IOT_HTONL((uint32_t)src_data->last_error);
+}
+
+/******************************************************************************/
+// Converting decode function for (vs_info_fldt_response_t)
+void
+vs_info_fldt_response_t_decode(vs_info_fldt_response_t *src_data) {
+    src_data->active_transfers = VS_IOT_NTOHL(src_data->active_transfers);
+    src_data->transfers_completed = VS_IOT_NTOHL(src_data->transfers_completed);
+    src_data->bytes_served = VS_IOT_NTOHL(src_data->bytes_served);
+    src_data->chunks_served = VS_IOT_NTOHL(src_data->chunks_served);
+    src_data->chunk_rate = VS_IOT_NTOHL(src_data->chunk_rate);
+    src_data->retry_later = VS_IOT_NTOHL(src_data->retry_later);
+    src_data->cache_hits = VS_IOT_NTOHL(src_data->cache_hits);
+    src_data->cache_misses = VS_IOT_NTOHL(src_data->cache_misses);
+    vs_update_file_type_t_decode(&src_data->file_type);
+    src_data->file_size = VS_IOT_NTOHL(src_data->file_size);
+    src_data->received_size = VS_IOT_NTOHL(src_data->received_size);
+    src_data->retries = VS_IOT_NTOHL(src_data->retries);
+    src_data->postponed = VS_IOT_NTOHL(src_data->postponed);
+    src_data->srtt_ms = VS_IOT_NTOHL(src_data->srtt_ms);
+    src_data->rto_ms = VS_IOT_NTOHL(src_data->rto_ms);
+    src_data->duration_ms = VS_IOT_NTOHL(src_data->duration_ms);
+    src_data->eta_ms = VS_IOT_NTOHL(src_data->eta_ms);
+    src_data->last_error = (int32_t)VS_IOT_NTOHL((uint32_t)src_data->last_error);
+}
+
 /******************************************************************************/
 // Converting encode function for (vs_info_poll_request_t)
 void
@@ -167,6 +193,20 @@ vs_info_poll_request_t_decode(vs_info_poll_request_t *src_data) {
     src_data->period_seconds = VS_IOT_NTOHS(src_data->period_seconds);
 }
 
+/******************************************************************************/
+// Converting encode function for (vs_fldt_file_info_t)
+void
+vs_fldt_file_info_t_encode(vs_fldt_file_info_t *src_data) {
+    vs_update_file_type_t_encode(&src_data->type);
+}
+
+/******************************************************************************/
+// Converting decode function for (vs_fldt_file_info_t)
+void
+vs_fldt_file_info_t_decode(vs_fldt_file_info_t *src_data) {
+    vs_update_file_type_t_decode(&src_data->type);
+}
+
 /******************************************************************************/
 // Converting encode function for (vs_fldt_gnfh_header_request_t)
 void
@@ -182,95 +222,105 @@ vs_fldt_gnfh_header_request_t_decode(vs_fldt_gnfh_header_request_t *src_data) {
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_fldt_gnff_footer_response_t)
+// Converting encode function for (vs_fldt_gnfh_header_response_t)
 void
-vs_fldt_gnff_footer_response_t_encode(vs_fldt_gnff_footer_response_t *src_data) {
-    vs_update_file_type_t_encode(&src_data->type);
-    src_data->footer_size = VS_IOT_HTONS(src_data->footer_size);
+vs_fldt_gnfh_header_response_t_encode(vs_fldt_gnfh_header_response_t *src_data) {
+    vs_fldt_file_info_t_encode(&src_data->fldt_info);
+    src_data->file_size = VS_IOT_HTONL(src_data->file_size);
+    src_data->header_size = VS_IOT_HTONS(src_data->header_size);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_fldt_gnff_footer_response_t)
+// Converting decode function for (vs_fldt_gnfh_header_response_t)
 void
-vs_fldt_gnff_footer_response_t_decode(vs_fldt_gnff_footer_response_t *src_data) {
-    vs_update_file_type_t_decode(&src_data->type);
-    src_data->footer_size = VS_IOT_NTOHS(src_data->footer_size);
+vs_fldt_gnfh_header_response_t_decode(vs_fldt_gnfh_header_response_t *src_data) {
+    vs_fldt_file_info_t_decode(&src_data->fldt_info);
+    src_data->file_size = VS_IOT_NTOHL(src_data->file_size);
+    src_data->header_size = VS_IOT_NTOHS(src_data->header_size);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_file_version_t)
+// Converting encode function for (vs_fldt_gnfd_data_request_t)
 void
-vs_file_version_t_encode(vs_file_version_t *src_data) {
-    src_data->build = VS_IOT_HTONL(src_data->build);
-    src_data->timestamp = VS_IOT_HTONL(src_data->timestamp);
+vs_fldt_gnfd_data_request_t_encode(vs_fldt_gnfd_data_request_t *src_data) {
+    vs_update_file_type_t_encode(&src_data->type);
+    src_data->offset = VS_IOT_HTONL(src_data->offset);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_file_version_t)
+// Converting decode function for (vs_fldt_gnfd_data_request_t)
 void
-vs_file_version_t_decode(vs_file_version_t *src_data) {
-    src_data->build = VS_IOT_NTOHL(src_data->build);
-    src_data->timestamp = VS_IOT_NTOHL(src_data->timestamp);
+vs_fldt_gnfd_data_request_t_decode(vs_fldt_gnfd_data_request_t *src_data) {
+    vs_update_file_type_t_decode(&src_data->type);
+    src_data->offset = VS_IOT_NTOHL(src_data->offset);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_update_file_type_t)
+// Converting encode function for (vs_fldt_gnfd_data_response_t)
 void
-vs_update_file_type_t_encode(vs_update_file_type_t *src_data) {
-    src_data->type = VS_IOT_HTONS(src_data->type);
-    vs_file_info_t_encode(&src_data->info);
+vs_fldt_gnfd_data_response_t_encode(vs_fldt_gnfd_data_response_t *src_data) {
+    vs_update_file_type_t_encode(&src_data->type);
+    src_data->offset = VS_IOT_HTONL(src_data->offset);
+    src_data->next_offset = VS_IOT_HTONL(src_data->next_offset);
+    src_data->data_size = VS_IOT_HTONS(src_data->data_size);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_update_file_type_t)
+// Converting decode function for (vs_fldt_gnfd_data_response_t)
 void
-vs_update_file_type_t_decode(vs_update_file_type_t *src_data) {
-    src_data->type = VS_IOT_NTOHS(src_data->type);
-    vs_file_info_t_decode(&src_data->info);
+vs_fldt_gnfd_data_response_t_decode(vs_fldt_gnfd_data_response_t *src_data) {
+    vs_update_file_type_t_decode(&src_data->type);
+    src_data->offset = VS_IOT_NTOHL(src_data->offset);
+    src_data->next_offset = VS_IOT_NTOHL(src_data->next_offset);
+    src_data->data_size = VS_IOT_NTOHS(src_data->data_size);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_ethernet_header_t)
+// Converting encode function for (vs_fldt_gnff_footer_request_t)
 void
-vs_ethernet_header_t_encode(vs_ethernet_header_t *src_data) {
-    src_data->type = VS_IOT_HTONS(src_data->type);
+vs_fldt_gnff_footer_request_t_encode(vs_fldt_gnff_footer_request_t *src_data) {
+    vs_update_file_type_t_encode(&src_data->type);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_ethernet_header_t)
+// Converting decode function for (vs_fldt_gnff_footer_request_t)
 void
-vs_ethernet_header_t_decode(vs_ethernet_header_t *src_data) {
-    src_data->type = VS_IOT_NTOHS(src_data->type);
+vs_fldt_gnff_footer_request_t_decode(vs_fldt_gnff_footer_request_t *src_data) {
+    vs_update_file_type_t_decode(&src_data->type);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_fldt_gnfd_data_request_t)
+// Converting encode function for (vs_fldt_gnff_footer_response_t)
 void
-vs_fldt_gnfd_data_request_t_encode(vs_fldt_gnfd_data_request_t *src_data) {
+vs_fldt_gnff_footer_response_t_encode(vs_fldt_gnff_footer_response_t *src_data) {
     vs_update_file_type_t_encode(&src_data->type);
-    src_data->offset = VS_IOT_HTONL(src_data->offset);
+    src_data->footer_size = VS_IOT_HTONS(src_data->footer_size);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_fldt_gnfd_data_request_t)
+// Converting decode function for (vs_fldt_gnff_footer_response_t)
 void
-vs_fldt_gnfd_data_request_t_decode(vs_fldt_gnfd_data_request_t *src_data) {
+vs_fldt_gnff_footer_response_t_decode(vs_fldt_gnff_footer_response_t *src_data) {
     vs_update_file_type_t_decode(&src_data->type);
-    src_data->offset = VS_IOT_NTOHL(src_data->offset);
+    src_data->footer_size = VS_IOT_NTOHS(src_data->footer_size);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_fldt_gnff_footer_request_t)
+// Converting encode function for (vs_fldt_retry_later_t)
 void
-vs_fldt_gnff_footer_request_t_encode(vs_fldt_gnff_footer_request_t *src_data) {
+vs_fldt_retry_later_t_encode(vs_fldt_retry_later_t *src_data) {
     vs_update_file_type_t_encode(&src_data->type);
+    src_data->offset = VS_IOT_HTONL(src_data->offset);
+    src_data->delay_ms = VS_IOT_HTONL(src_data->delay_ms);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_fldt_gnff_footer_request_t)
+// Converting decode function for (vs_fldt_retry_later_t)
 void
-vs_fldt_gnff_footer_request_t_decode(vs_fldt_gnff_footer_request_t *src_data) {
+vs_fldt_retry_later_t_decode(vs_fldt_retry_later_t *src_data) {
     vs_update_file_type_t_decode(&src_data->type);
+    src_data->offset = VS_IOT_NTOHL(src_data->offset);
+    src_data->delay_ms = VS_IOT_NTOHL(src_data->delay_ms);
 }
 
 /******************************************************************************/
@@ -288,49 +338,65 @@ vs_pubkey_t_decode(vs_pubkey_t *src_data) {
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_file_info_t)
+// Converting encode function for (vs_pubkey_dated_t)
 void
-vs_file_info_t_encode(vs_file_info_t *src_data) {
-    vs_file_version_t_encode(&src_data->version);
+vs_pubkey_dated_t_encode(vs_pubkey_dated_t *src_data) {
+    src_data->start_date = VS_IOT_HTONL(src_data->start_date);
+    src_data->expire_date = VS_IOT_HTONL(src_data->expire_date);
+    vs_pubkey_t_encode(&src_data->pubkey);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_file_info_t)
+// Converting decode function for (vs_pubkey_dated_t)
 void
-vs_file_info_t_decode(vs_file_info_t *src_data) {
-    vs_file_version_t_decode(&src_data->version);
+vs_pubkey_dated_t_decode(vs_pubkey_dated_t *src_data) {
+    src_data->start_date = VS_IOT_NTOHL(src_data->start_date);
+    src_data->expire_date = VS_IOT_NTOHL(src_data->expire_date);
+    vs_pubkey_t_decode(&src_data->pubkey);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_snap_header_t)
+// Converting encode function for (vs_file_version_t)
 void
-vs_snap_header_t_encode(vs_snap_header_t *src_data) {
-    src_data->transaction_id = VS_IOT_HTONS(src_data->transaction_id);
-    src_data->padding = VS_IOT_HTONS(src_data->padding);
-    src_data->content_size = VS_IOT_HTONS(src_data->content_size);
+vs_file_version_t_encode(vs_file_version_t *src_data) {
+    src_data->build = VS_IOT_HTONL(src_data->build);
+    src_data->timestamp = VS_IOT_HTONL(src_data->timestamp);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_snap_header_t)
+// Converting decode function for (vs_file_version_t)
 void
-vs_snap_header_t_decode(vs_snap_header_t *src_data) {
-    src_data->transaction_id = VS_IOT_NTOHS(src_data->transaction_id);
-    src_data->padding = VS_IOT_NTOHS(src_data->padding);
-    src_data->content_size = VS_IOT_NTOHS(src_data->content_size);
+vs_file_version_t_decode(vs_file_version_t *src_data) {
+    src_data->build = VS_IOT_NTOHL(src_data->build);
+    src_data->timestamp = VS_IOT_NTOHL(src_data->timestamp);
 }
 
 /******************************************************************************/
-// Converting encode function for (vs_snap_packet_t)
+// Converting encode function for (vs_file_info_t)
 void
-vs_snap_packet_t_encode(vs_snap_packet_t *src_data) {
-    vs_snap_header_t_encode(&src_data->header);
-    vs_ethernet_header_t_encode(&src_data->eth_header);
+vs_file_info_t_encode(vs_file_info_t *src_data) {
+    vs_file_version_t_encode(&src_data->version);
 }
 
 /******************************************************************************/
-// Converting decode function for (vs_snap_packet_t)
+// Converting decode function for (vs_file_info_t)
 void
-vs_snap_packet_t_decode(vs_snap_packet_t *src_data) {
-    vs_snap_header_t_decode(&src_data->header);
-    vs_ethernet_header_t_decode(&src_data->eth_header);
-}
\ No newline at end of file
+vs_file_info_t_decode(vs_file_info_t *src_data) {
+    vs_file_version_t_decode(&src_data->version);
+}
+
+/******************************************************************************/
+// Converting encode function for (vs_update_file_type_t)
+void
+vs_update_file_type_t_encode(vs_update_file_type_t *src_data) {
+    src_data->type = VS_IOT_HTONS(src_data->type);
+    vs_file_info_t_encode(&src_data->info);
+}
+
+/******************************************************************************/
+// Converting decode function for (vs_update_file_type_t)
+void
+vs_update_file_type_t_decode(vs_update_file_type_t *src_data) {
+    src_data->type = VS_IOT_NTOHS(src_data->type);
+    vs_file_info_t_decode(&src_data->info);
+}
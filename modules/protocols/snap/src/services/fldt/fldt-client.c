@@ -42,23 +42,23 @@
 #include <virgil/iot/macros/macros.h>
 #include <virgil/iot/update/update.h>
 #include <stdlib-config.h>
+#include <update-config.h>
 #include <global-hal.h>
 #include <virgil/iot/trust_list/trust_list.h>
+#include <private/fldt-mapping.h>
 
 static vs_snap_service_t _fldt_client = {0};
 
 #define VS_FLDT_RETRY_MAX (5)
-#define VS_FLDT_WAIT_MAX (10) // Seconds
 
 #define VS_FLDT_REQUEST_SZ_MAX (150)
 
-// TODO : This setting might be moved to some config
-#define CLIENT_FILE_TYPE_ARRAY_SIZE (10)
-
 typedef struct {
     bool in_progress;
     int retry_used;
-    int tick_cnt;
+    bool postponed;
+    uint32_t sent_ms;
+    uint32_t timeout_ms;
     uint32_t expected_offset;
     vs_mac_addr_t gateway_mac;
     uint32_t command;
@@ -66,6 +66,27 @@ typedef struct {
     uint16_t data_sz;
 } vs_fldt_client_retry_ctx_t;
 
+// Round-trip time estimation, RFC 6298
+typedef struct {
+    bool measured;
+    uint32_t srtt_ms;
+    uint32_t rttvar_ms;
+    uint32_t rto_ms;
+} vs_fldt_client_rtt_t;
+
+// Download telemetry
+typedef struct {
+    vs_file_version_t version;
+    bool in_progress;
+    bool completed;
+    uint32_t received_size;
+    uint32_t retries;
+    uint32_t postponed;
+    uint32_t started_ms;
+    uint32_t duration_ms;
+    vs_status_e last_error;
+} vs_fldt_client_telemetry_t;
+
 typedef struct {
     vs_update_file_type_t type;
     vs_file_version_t prev_file_version;
@@ -75,22 +96,109 @@ typedef struct {
     uint32_t file_size;
     vs_mac_addr_t gateway_mac;
     vs_fldt_client_retry_ctx_t retry_ctx;
+    vs_fldt_client_rtt_t rtt;
+    vs_fldt_client_telemetry_t telemetry;
 } vs_fldt_client_file_type_mapping_t;
 
-static uint32_t _file_type_mapping_array_size = 0;
-static vs_fldt_client_file_type_mapping_t _client_file_type_mapping[CLIENT_FILE_TYPE_ARRAY_SIZE];
+#if VS_IMPL_MSEC
+#define FLDT_RTO_MIN_MS VS_FLDT_RTO_MIN_MS
+#define FLDT_RTO_INITIAL_MS VS_FLDT_RTO_INITIAL_MS
+#else
+// Second resolution clock can report up to one second more than really elapsed
+#define FLDT_RTO_MIN_MS (VS_FLDT_RTO_MIN_MS > 2000 ? VS_FLDT_RTO_MIN_MS : 2000)
+#define FLDT_RTO_INITIAL_MS (VS_FLDT_RTO_INITIAL_MS > FLDT_RTO_MIN_MS ? VS_FLDT_RTO_INITIAL_MS : FLDT_RTO_MIN_MS)
+#endif // VS_IMPL_MSEC
+
+static vs_fldt_mapping_t _client_file_type_mapping = {.elem_sz = sizeof(vs_fldt_client_file_type_mapping_t)};
 static vs_fldt_got_file _got_file_callback = NULL;
+static vs_update_file_type_t _last_download_type;
+static bool _has_last_download = false;
 static vs_status_e
 _ask_file_type_info(const char *file_type_descr,
                     vs_fldt_gnfh_header_request_t *gnfh_request,
                     vs_fldt_client_file_type_mapping_t *file_type_info);
 
+/******************************************************************/
+static void
+_rtt_reset(vs_fldt_client_rtt_t *rtt) {
+    VS_IOT_MEMSET(rtt, 0, sizeof(*rtt));
+    rtt->rto_ms = FLDT_RTO_INITIAL_MS;
+}
+
+/******************************************************************/
+static void
+_rtt_sample(vs_fldt_client_file_type_mapping_t *object_info, uint32_t command, uint32_t offset) {
+    vs_fldt_client_retry_ctx_t *retry_ctx = &object_info->retry_ctx;
+    vs_fldt_client_rtt_t *rtt = &object_info->rtt;
+    uint32_t rtt_ms;
+    uint32_t delta_ms;
+    uint32_t rto_ms;
+
+    // Response to retransmitted request is ambiguous (Karn's algorithm)
+    if (!retry_ctx->in_progress || retry_ctx->command != command || retry_ctx->expected_offset != offset ||
+        retry_ctx->retry_used) {
+        return;
+    }
+
+    rtt_ms = vs_impl_msec() - retry_ctx->sent_ms;
+
+    if (!rtt->measured) {
+        rtt->srtt_ms = rtt_ms;
+        rtt->rttvar_ms = rtt_ms / 2;
+        rtt->measured = true;
+    } else {
+        delta_ms = rtt->srtt_ms > rtt_ms ? rtt->srtt_ms - rtt_ms : rtt_ms - rtt->srtt_ms;
+        rtt->rttvar_ms = (3 * rtt->rttvar_ms + delta_ms) / 4;
+        rtt->srtt_ms = (7 * rtt->srtt_ms + rtt_ms) / 8;
+    }
+
+    rto_ms = rtt->srtt_ms + 4 * rtt->rttvar_ms;
+    if (rto_ms < FLDT_RTO_MIN_MS) {
+        rto_ms = FLDT_RTO_MIN_MS;
+    } else if (rto_ms > VS_FLDT_RTO_MAX_MS) {
+        rto_ms = VS_FLDT_RTO_MAX_MS;
+    }
+    rtt->rto_ms = rto_ms;
+}
+
+/******************************************************************/
+static void
+_telemetry_start(vs_fldt_client_file_type_mapping_t *object_info) {
+    vs_fldt_client_telemetry_t *telemetry = &object_info->telemetry;
+
+    VS_IOT_MEMSET(telemetry, 0, sizeof(*telemetry));
+    telemetry->version = object_info->cur_file_version;
+    telemetry->in_progress = true;
+    telemetry->started_ms = vs_impl_msec();
+
+    _last_download_type = object_info->type;
+    _has_last_download = true;
+}
+
+/******************************************************************/
+static void
+_telemetry_finish(vs_fldt_client_file_type_mapping_t *object_info, vs_status_e status) {
+    vs_fldt_client_telemetry_t *telemetry = &object_info->telemetry;
+
+    if (!telemetry->in_progress) {
+        return;
+    }
+
+    telemetry->in_progress = false;
+    telemetry->completed = (VS_CODE_OK == status);
+    telemetry->duration_ms = vs_impl_msec() - telemetry->started_ms;
+    telemetry->last_error = status;
+}
+
 /******************************************************************/
 static void
 _update_process_reset(vs_fldt_client_file_type_mapping_t *object_info) {
     CHECK_NOT_ZERO(object_info);
     vs_fldt_client_retry_ctx_t *retry_ctx = &object_info->retry_ctx;
 
+    // Download has been interrupted
+    _telemetry_finish(object_info, VS_CODE_ERR_FILE);
+
     if (object_info->retry_ctx.in_progress) {
         switch (object_info->retry_ctx.command) {
         case VS_FLDT_GNFH:
@@ -112,36 +220,15 @@ terminate:;
 
 /******************************************************************/
 static void
-_delete_mapping_element(vs_fldt_client_file_type_mapping_t *file_element_to_delete) {
-    vs_fldt_client_file_type_mapping_t *file_type_info = _client_file_type_mapping;
-    uint32_t id;
-    bool found = false;
-    if (0 == _file_type_mapping_array_size) {
-        return;
+_free_mapping_element_data(vs_fldt_client_file_type_mapping_t *file_element) {
+    if (file_element->update_interface && file_element->update_interface->free_item) {
+        file_element->update_interface->free_item(file_element->update_interface->storage_context,
+                                                  &file_element->type);
     }
 
-    for (id = 0; id < _file_type_mapping_array_size; ++id, ++file_type_info) {
-        if (!found) {
-            if (file_element_to_delete == file_type_info) {
-                if (file_element_to_delete->update_interface && file_element_to_delete->update_interface->free_item) {
-                    file_element_to_delete->update_interface->free_item(
-                            file_element_to_delete->update_interface->storage_context, &file_element_to_delete->type);
-                }
-
-                if (file_element_to_delete->file_header) {
-                    VS_IOT_FREE(file_element_to_delete->file_header);
-                    file_element_to_delete->file_header = NULL;
-                }
-                found = true;
-            }
-        } else {
-            _client_file_type_mapping[id - 1] = *file_type_info;
-            VS_IOT_MEMSET(file_type_info, 0, sizeof(vs_fldt_client_file_type_mapping_t));
-        }
-    }
-
-    if (found) {
-        _file_type_mapping_array_size--;
+    if (file_element->file_header) {
+        VS_IOT_FREE(file_element->file_header);
+        file_element->file_header = NULL;
     }
 }
 
@@ -163,7 +250,9 @@ _update_process_set(vs_fldt_client_file_type_mapping_t *object_info,
     }
 
     retry_ctx->in_progress = true;
-    retry_ctx->tick_cnt = 0;
+    retry_ctx->postponed = false;
+    retry_ctx->sent_ms = vs_impl_msec();
+    retry_ctx->timeout_ms = object_info->rtt.rto_ms;
     retry_ctx->retry_used = 0;
     retry_ctx->command = command;
     retry_ctx->gateway_mac = object_info->gateway_mac;
@@ -180,16 +269,34 @@ _update_process_retry(vs_fldt_client_file_type_mapping_t *object_info) {
     CHECK_NOT_ZERO_RET(object_info, VS_CODE_ERR_INCORRECT_ARGUMENT);
     vs_fldt_client_retry_ctx_t *retry_ctx = &object_info->retry_ctx;
 
-    retry_ctx->retry_used++;
+    // Request postponed by gateway is not a retry
+    if (retry_ctx->postponed) {
+        retry_ctx->postponed = false;
+    } else {
+        retry_ctx->retry_used++;
+        if (object_info->telemetry.in_progress) {
+            object_info->telemetry.retries++;
+        }
 
-    if (retry_ctx->retry_used > VS_FLDT_RETRY_MAX) {
-        VS_FLDT_PRINT_DEBUG(
-                object_info->type.type, retry_ctx->command, "Update process has been stopped, because of retry limit");
-        _update_process_reset(object_info);
-        return VS_CODE_OK;
+        if (retry_ctx->retry_used > VS_FLDT_RETRY_MAX) {
+            VS_FLDT_PRINT_DEBUG(object_info->type.type,
+                                retry_ctx->command,
+                                "Update process has been stopped, because of retry limit");
+            _telemetry_finish(object_info, VS_CODE_ERR_REQUEST_SEND);
+            _update_process_reset(object_info);
+            return VS_CODE_OK;
+        }
+
+        // Exponential backoff. Backed off timeout is kept until new round-trip time measurement
+        object_info->rtt.rto_ms = object_info->rtt.rto_ms * 2 > VS_FLDT_RTO_MAX_MS ? VS_FLDT_RTO_MAX_MS
+                                                                                     : object_info->rtt.rto_ms * 2;
     }
 
+    retry_ctx->sent_ms = vs_impl_msec();
+    retry_ctx->timeout_ms = object_info->rtt.rto_ms;
+
     VS_FLDT_PRINT_DEBUG(object_info->type.type, retry_ctx->command, "_update_process_retry");
+    VS_LOG_DEBUG("[FLDT] Retry %d, next timeout %u ms", retry_ctx->retry_used, object_info->rtt.rto_ms);
 
     CHECK_RET(!vs_snap_send_request(NULL,
                                     &retry_ctx->gateway_mac,
@@ -206,18 +313,13 @@ _update_process_retry(vs_fldt_client_file_type_mapping_t *object_info) {
 /******************************************************************/
 static vs_fldt_client_file_type_mapping_t *
 _get_mapping_elem(const vs_update_file_type_t *file_type) {
-    vs_fldt_client_file_type_mapping_t *file_type_info = _client_file_type_mapping;
-    uint32_t id;
+    vs_fldt_client_file_type_mapping_t *file_type_info = vs_fldt_mapping_find(&_client_file_type_mapping, file_type);
 
-    for (id = 0; id < _file_type_mapping_array_size; ++id, ++file_type_info) {
-        if (vs_update_equal_file_type(&file_type_info->type, file_type)) {
-            return file_type_info;
-        }
+    if (!file_type_info) {
+        VS_LOG_WARNING("[FLDT] Unable to find file type specified");
     }
 
-    VS_LOG_WARNING("[FLDT] Unable to find file type specified");
-
-    return NULL;
+    return file_type_info;
 }
 
 /*************************************************************************/
@@ -291,6 +393,10 @@ vs_fldt_INFV_request_processor(const uint8_t *request,
                  VS_UPDATE_FILE_TYPE_STR_STATIC(&file_type_info->type),
                  VS_UPDATE_FILE_VERSION_STR_STATIC(new_file_ver));
 
+    // Round-trip time of another gateway is unknown
+    if (0 != VS_IOT_MEMCMP(&file_type_info->gateway_mac, &new_file->gateway_mac, sizeof(new_file->gateway_mac))) {
+        _rtt_reset(&file_type_info->rtt);
+    }
     file_type_info->gateway_mac = new_file->gateway_mac;
 
     if (_check_download_need("INFV", &file_type_info->cur_file_version, new_file_ver)) {
@@ -351,6 +457,8 @@ vs_fldt_GNFH_response_processor(bool is_ack, const uint8_t *response, const uint
               VS_CODE_ERR_UNREGISTERED_MAPPING_TYPE,
               "Unregistered file type");
 
+    _rtt_sample(file_type_info, VS_FLDT_GNFH, 0);
+
     if (!_check_download_need("GNFH", &file_type_info->cur_file_version, file_ver)) {
         file_type_info->retry_ctx.in_progress = false;
         VS_LOG_WARNING("[FLDT:GNFH] File [type %d] header contains an old version", file_type->type);
@@ -387,6 +495,8 @@ vs_fldt_GNFH_response_processor(bool is_ack, const uint8_t *response, const uint
               file_header->header_size);
     VS_IOT_MEMCPY(file_type_info->file_header, file_header->header_data, file_header->header_size);
 
+    _telemetry_start(file_type_info);
+
     VS_IOT_MEMSET(&data_request, 0, sizeof(data_request));
 
     data_request.offset = 0;
@@ -403,7 +513,7 @@ vs_fldt_GNFH_response_processor(bool is_ack, const uint8_t *response, const uint
 
     CHECK_RET(VS_CODE_OK == _update_process_set(file_type_info,
                                                 VS_FLDT_GNFD,
-                                                data_request.offset,
+                                                0,
                                                 (const uint8_t *)&data_request,
                                                 sizeof(data_request)),
               VS_CODE_ERR_INCORRECT_SEND_REQUEST,
@@ -452,6 +562,8 @@ vs_fldt_GNFD_response_processor(bool is_ack, const uint8_t *response, const uint
               VS_CODE_ERR_INCORRECT_ARGUMENT,
               "Response must be of vs_fldt_gnfd_data_response_t type");
 
+    _rtt_sample(file_type_info, VS_FLDT_GNFD, file_data->offset);
+
     if (0 != VS_IOT_MEMCMP(&file_type_info->cur_file_version, file_ver, sizeof(file_type_info->cur_file_version))) {
         VS_LOG_WARNING("[FLDT:GNFD] File [type %d] data contains an old version", file_type->type);
         vs_fldt_gnfh_header_request_t header_request;
@@ -461,14 +573,28 @@ vs_fldt_GNFD_response_processor(bool is_ack, const uint8_t *response, const uint
         return VS_CODE_OLD_VERSION;
     }
 
-    STATUS_CHECK_RET(file_type_info->update_interface->set_data(file_type_info->update_interface->storage_context,
-                                                                file_type,
-                                                                file_type_info->file_header,
-                                                                file_data->data,
-                                                                file_data->data_size,
-                                                                file_data->offset),
-                     "Unable to set header for %s",
-                     VS_UPDATE_FILE_TYPE_STR_STATIC(&file_type_info->type));
+    ret_code = file_type_info->update_interface->set_data(file_type_info->update_interface->storage_context,
+                                                          file_type,
+                                                          file_type_info->file_header,
+                                                          file_data->data,
+                                                          file_data->data_size,
+                                                          file_data->offset);
+
+    // Damaged data part is requested again, the rest of file is kept
+    if (VS_CODE_ERR_VERIFY == ret_code && file_type_info->retry_ctx.in_progress &&
+        VS_FLDT_GNFD == file_type_info->retry_ctx.command &&
+        file_data->offset == file_type_info->retry_ctx.expected_offset) {
+        VS_LOG_WARNING("[FLDT:GNFD] Data for %s at offset %u is damaged",
+                       VS_UPDATE_FILE_TYPE_STR_STATIC(&file_type_info->type),
+                       file_data->offset);
+        return _update_process_retry(file_type_info);
+    }
+
+    STATUS_CHECK_RET(ret_code, "Unable to set header for %s", VS_UPDATE_FILE_TYPE_STR_STATIC(&file_type_info->type));
+
+    file_type_info->telemetry.received_size = file_data->next_offset < file_type_info->file_size
+                                                      ? file_data->next_offset
+                                                      : file_type_info->file_size;
 
     if (file_data->next_offset < file_type_info->file_size) {
 
@@ -483,7 +609,7 @@ vs_fldt_GNFD_response_processor(bool is_ack, const uint8_t *response, const uint
 
         CHECK_RET(VS_CODE_OK == _update_process_set(file_type_info,
                                                     VS_FLDT_GNFD,
-                                                    data_request.offset,
+                                                    file_data->next_offset,
                                                     (const uint8_t *)&data_request,
                                                     sizeof(data_request)),
                   VS_CODE_ERR_INCORRECT_SEND_REQUEST,
@@ -529,6 +655,51 @@ vs_fldt_GNFD_response_processor(bool is_ack, const uint8_t *response, const uint
     return VS_CODE_OK;
 }
 
+/******************************************************************/
+static int
+_retry_later_response_processor(vs_snap_element_t element_id,
+                                const uint8_t *response,
+                                const uint16_t response_sz) {
+    vs_fldt_retry_later_t *retry_later = (vs_fldt_retry_later_t *)response;
+    vs_fldt_client_file_type_mapping_t *file_type_info = NULL;
+    vs_fldt_client_retry_ctx_t *retry_ctx;
+
+    CHECK_NOT_ZERO_RET(response, VS_CODE_ERR_INCORRECT_ARGUMENT);
+    CHECK_RET(response_sz == sizeof(*retry_later),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Response must be of vs_fldt_retry_later_t type");
+
+    // Normalize byte order
+    vs_fldt_retry_later_t_decode(retry_later);
+
+    CHECK_RET(file_type_info = _get_mapping_elem(&retry_later->type),
+              VS_CODE_ERR_UNREGISTERED_MAPPING_TYPE,
+              "Unregistered file type");
+
+    retry_ctx = &file_type_info->retry_ctx;
+    if (!retry_ctx->in_progress || retry_ctx->command != element_id ||
+        retry_ctx->expected_offset != retry_later->offset) {
+        return VS_CODE_OK;
+    }
+
+    // Gateway is alive, so its response is used for round-trip time measurement
+    _rtt_sample(file_type_info, element_id, retry_later->offset);
+
+    VS_LOG_DEBUG("[FLDT] Gateway is busy, repeat request for %s in %u ms",
+                 VS_UPDATE_FILE_TYPE_STR_STATIC(&file_type_info->type),
+                 retry_later->delay_ms);
+
+    retry_ctx->postponed = true;
+    retry_ctx->sent_ms = vs_impl_msec();
+    retry_ctx->timeout_ms = retry_later->delay_ms;
+
+    if (file_type_info->telemetry.in_progress) {
+        file_type_info->telemetry.postponed++;
+    }
+
+    return VS_CODE_OK;
+}
+
 /******************************************************************/
 static vs_status_e
 _ask_file_type_info(const char *file_type_descr,
@@ -594,6 +765,8 @@ vs_fldt_GNFF_response_processor(bool is_ack, const uint8_t *response, const uint
               VS_CODE_ERR_INCORRECT_ARGUMENT,
               "Response must be of vs_fldt_gnff_footer_response_t type");
 
+    _rtt_sample(file_type_info, VS_FLDT_GNFF, 0);
+
     if (0 != VS_IOT_MEMCMP(&file_type_info->cur_file_version, file_ver, sizeof(file_type_info->cur_file_version))) {
         VS_LOG_WARNING("[FLDT:GNFF] File %s footer contains an old version",
                        VS_UPDATE_FILE_TYPE_STR_STATIC(&file_type_info->type));
@@ -613,6 +786,8 @@ vs_fldt_GNFF_response_processor(bool is_ack, const uint8_t *response, const uint
     // Stop retries
     file_type_info->retry_ctx.in_progress = !successfully_updated;
 
+    _telemetry_finish(file_type_info, ret_code);
+
     _got_file_callback(file_type,
                        &file_type_info->prev_file_version,
                        file_ver,
@@ -630,15 +805,8 @@ vs_fldt_GNFF_response_processor(bool is_ack, const uint8_t *response, const uint
 
 /******************************************************************/
 static vs_status_e
-_new_mapping_element(vs_fldt_client_file_type_mapping_t **file_element_to_add) {
-    VS_IOT_ASSERT(_file_type_mapping_array_size < (CLIENT_FILE_TYPE_ARRAY_SIZE - 1));
-    CHECK_RET(_file_type_mapping_array_size < (CLIENT_FILE_TYPE_ARRAY_SIZE - 1),
-              VS_CODE_ERR_NO_MEMORY,
-              "[FLDT] Can't add new file type. Array is full");
-    *file_element_to_add = &_client_file_type_mapping[_file_type_mapping_array_size++];
-    VS_LOG_DEBUG("[FLDT] File type was not initialized, add new entry. Array size = %d", _file_type_mapping_array_size);
-    VS_IOT_MEMSET(*file_element_to_add, 0, sizeof(vs_fldt_client_file_type_mapping_t));
-    return VS_CODE_OK;
+_new_mapping_element(const vs_update_file_type_t *file_type, vs_fldt_client_file_type_mapping_t **file_element_to_add) {
+    return vs_fldt_mapping_add(&_client_file_type_mapping, file_type, (void **)file_element_to_add);
 }
 
 /******************************************************************/
@@ -659,6 +827,7 @@ vs_fldt_client_add_file_type(const vs_update_file_type_t *file_type, vs_update_i
 
     file_element_to_add.type = *file_type;
     file_element_to_add.update_interface = update_interface;
+    _rtt_reset(&file_element_to_add.rtt);
 
     VS_LOG_DEBUG("[FLDT] Add file type %s",
                  vs_update_file_type_str(&file_element_to_add.type, type_str, sizeof(type_str)));
@@ -686,6 +855,7 @@ vs_fldt_client_add_file_type(const vs_update_file_type_t *file_type, vs_update_i
 
         file_element_to_add.cur_file_version = file_element_to_add.type.info.version;
         file_element_to_add.prev_file_version = file_element_to_add.cur_file_version;
+        file_element_to_add.telemetry.version = file_element_to_add.cur_file_version;
     } else {
         VS_LOG_WARNING("[FLDT] File type was not found by Update library");
         VS_IOT_FREE(file_element_to_add.file_header);
@@ -695,10 +865,15 @@ vs_fldt_client_add_file_type(const vs_update_file_type_t *file_type, vs_update_i
     existing_file_element = _get_mapping_elem(file_type);
 
     if (!existing_file_element) {
-        STATUS_CHECK_RET(_new_mapping_element(&existing_file_element), "[FLDT] Error to create new mapping element");
+        ret_code = _new_mapping_element(file_type, &existing_file_element);
+        if (VS_CODE_OK != ret_code) {
+            VS_LOG_ERROR("[FLDT] Error to create new mapping element");
+            VS_IOT_FREE(file_element_to_add.file_header);
+            return ret_code;
+        }
     } else {
         _update_process_reset(existing_file_element);
-        _delete_mapping_element(existing_file_element);
+        _free_mapping_element_data(existing_file_element);
         VS_LOG_DEBUG("[FLDT] File type is initialized present, update it");
     }
 
@@ -714,16 +889,15 @@ vs_fldt_client_add_file_type(const vs_update_file_type_t *file_type, vs_update_i
 /******************************************************************/
 static vs_status_e
 _fldt_destroy_client(void) {
-    uint32_t id;
-    vs_fldt_client_file_type_mapping_t *file_type_mapping = _client_file_type_mapping;
+    uint32_t pos = 0;
+    vs_fldt_client_file_type_mapping_t *file_type_mapping;
 
-    for (id = 0; id < _file_type_mapping_array_size; ++id, ++file_type_mapping) {
-        file_type_mapping->update_interface->free_item(file_type_mapping->update_interface->storage_context,
-                                                       &file_type_mapping->type);
-        VS_IOT_FREE(file_type_mapping->file_header);
+    while (NULL != (file_type_mapping = vs_fldt_mapping_next(&_client_file_type_mapping, &pos))) {
+        _free_mapping_element_data(file_type_mapping);
     }
 
-    _file_type_mapping_array_size = 0;
+    vs_fldt_mapping_clear(&_client_file_type_mapping);
+    _has_last_download = false;
 
     return VS_CODE_OK;
 }
@@ -768,6 +942,12 @@ _fldt_client_response_processor(const struct vs_netif_t *netif,
                                 const uint16_t response_sz) {
     (void)netif;
 
+    // Busy gateway asks to repeat request later
+    if (!is_ack && response_sz == sizeof(vs_fldt_retry_later_t) &&
+        (VS_FLDT_GNFH == element_id || VS_FLDT_GNFD == element_id || VS_FLDT_GNFF == element_id)) {
+        return _retry_later_response_processor(element_id, response, response_sz);
+    }
+
     switch (element_id) {
 
     case VS_FLDT_INFV:
@@ -796,17 +976,24 @@ _fldt_client_response_processor(const struct vs_netif_t *netif,
 /******************************************************************************/
 static int
 _fldt_client_periodical_processor(void) {
-    vs_fldt_client_file_type_mapping_t *file_type_info = _client_file_type_mapping;
+    vs_fldt_client_file_type_mapping_t *file_type_info;
     vs_fldt_client_retry_ctx_t *_retry_ctx;
-    uint32_t id;
+    uint32_t pos = 0;
+    uint32_t now_ms = vs_impl_msec();
 
-    for (id = 0; id < _file_type_mapping_array_size; ++id, ++file_type_info) {
+    while (NULL != (file_type_info = vs_fldt_mapping_next(&_client_file_type_mapping, &pos))) {
         _retry_ctx = &file_type_info->retry_ctx;
-        if (_retry_ctx->in_progress) {
-            _retry_ctx->tick_cnt++;
-            if (_retry_ctx->tick_cnt > VS_FLDT_WAIT_MAX) {
-                _update_process_retry(file_type_info);
-            }
+        if (!_retry_ctx->in_progress) {
+            continue;
+        }
+
+        if (file_type_info->update_interface->periodical) {
+            file_type_info->update_interface->periodical(file_type_info->update_interface->storage_context,
+                                                         &file_type_info->type);
+        }
+
+        if (now_ms - _retry_ctx->sent_ms >= _retry_ctx->timeout_ms) {
+            _update_process_retry(file_type_info);
         }
     }
 
@@ -818,7 +1005,6 @@ const vs_snap_service_t *
 vs_snap_fldt_client(vs_fldt_got_file got_file_callback) {
 
     VS_IOT_ASSERT(got_file_callback);
-    VS_IOT_ASSERT(CLIENT_FILE_TYPE_ARRAY_SIZE);
 
     _fldt_client.user_data = 0;
     _fldt_client.id = VS_FLDT_SERVICE_ID;
@@ -835,7 +1021,7 @@ vs_snap_fldt_client(vs_fldt_got_file got_file_callback) {
 /******************************************************************************/
 vs_status_e
 vs_fldt_client_request_all_files(void) {
-    size_t id;
+    uint32_t pos = 0;
     vs_fldt_gnfh_header_request_t gnfh_request;
     vs_fldt_client_file_type_mapping_t *file_type_info = NULL;
     vs_status_e ret_code;
@@ -843,13 +1029,12 @@ vs_fldt_client_request_all_files(void) {
 
     VS_LOG_DEBUG("[FLDT] Request info for all registered file types");
 
-    if (!_file_type_mapping_array_size) {
+    if (!_client_file_type_mapping.count) {
         VS_LOG_WARNING("[FLDT] No registered file types");
         return VS_CODE_OK;
     }
 
-    for (id = 0; id < _file_type_mapping_array_size; ++id) {
-        file_type_info = &_client_file_type_mapping[id];
+    while (NULL != (file_type_info = vs_fldt_mapping_next(&_client_file_type_mapping, &pos))) {
 
         VS_LOG_DEBUG("[FLDT] Request file type %s",
                      type_desc_buf = VS_UPDATE_FILE_TYPE_STR_STATIC(&file_type_info->type));
@@ -863,4 +1048,52 @@ vs_fldt_client_request_all_files(void) {
     return VS_CODE_OK;
 }
 
-#endif // FLDT_CLIENT
\ No newline at end of file
+/******************************************************************************/
+vs_status_e
+vs_fldt_client_get_stats(const vs_update_file_type_t *file_type, vs_fldt_client_stats_t *stats) {
+    vs_fldt_client_file_type_mapping_t *file_type_info = NULL;
+    const vs_fldt_client_telemetry_t *telemetry;
+
+    CHECK_NOT_ZERO_RET(stats, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    if (!file_type) {
+        CHECK_RET(_has_last_download, VS_CODE_ERR_NOT_FOUND, "There were no FLDT downloads");
+        file_type = &_last_download_type;
+    }
+
+    CHECK_RET(file_type_info = _get_mapping_elem(file_type),
+              VS_CODE_ERR_UNREGISTERED_MAPPING_TYPE,
+              "Unregistered file type");
+
+    telemetry = &file_type_info->telemetry;
+
+    VS_IOT_MEMSET(stats, 0, sizeof(*stats));
+    stats->type = file_type_info->type;
+    stats->type.info.version = telemetry->version;
+    stats->in_progress = telemetry->in_progress;
+    stats->completed = telemetry->completed;
+    stats->file_size = file_type_info->file_size;
+    stats->received_size = telemetry->received_size;
+    stats->retries = telemetry->retries;
+    stats->postponed = telemetry->postponed;
+    stats->srtt_ms = file_type_info->rtt.measured ? file_type_info->rtt.srtt_ms : 0;
+    stats->rto_ms = file_type_info->rtt.rto_ms;
+    stats->last_error = telemetry->last_error;
+
+    if (telemetry->in_progress) {
+        stats->duration_ms = vs_impl_msec() - telemetry->started_ms;
+
+        // Remaining data is expected to be received with the same rate
+        if (telemetry->received_size && telemetry->received_size < file_type_info->file_size) {
+            stats->eta_ms = (uint32_t)((uint64_t)stats->duration_ms *
+                                       (file_type_info->file_size - telemetry->received_size) /
+                                       telemetry->received_size);
+        }
+    } else {
+        stats->duration_ms = telemetry->duration_ms;
+    }
+
+    return VS_CODE_OK;
+}
+
+#endif // FLDT_CLIENT
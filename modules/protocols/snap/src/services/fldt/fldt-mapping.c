@@ -0,0 +1,250 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+#include <private/fldt-mapping.h>
+#include <virgil/iot/logger/logger.h>
+#include <virgil/iot/macros/macros.h>
+#include <stdlib-config.h>
+#include <update-config.h>
+
+#define FNV_OFFSET_BASIS (2166136261U)
+#define FNV_PRIME (16777619U)
+
+// Marks removed element, so probe sequences of other elements are not broken
+static uint8_t _tombstone;
+#define TOMBSTONE ((void *)&_tombstone)
+
+/******************************************************************/
+static uint32_t
+_fnv1a(uint32_t hash, const uint8_t *data, size_t data_sz) {
+    size_t pos;
+
+    for (pos = 0; pos < data_sz; ++pos) {
+        hash ^= data[pos];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/******************************************************************/
+static uint32_t
+_file_type_hash(const vs_update_file_type_t *file_type) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    uint8_t type[sizeof(file_type->type)];
+
+    type[0] = file_type->type & 0xFF;
+    type[1] = file_type->type >> 8;
+
+    hash = _fnv1a(hash, type, sizeof(type));
+    hash = _fnv1a(hash, file_type->info.manufacture_id, sizeof(file_type->info.manufacture_id));
+    hash = _fnv1a(hash, file_type->info.device_type, sizeof(file_type->info.device_type));
+
+    return hash;
+}
+
+/******************************************************************/
+static vs_status_e
+_rehash(vs_fldt_mapping_t *mapping, uint32_t new_capacity) {
+    void **new_slots;
+    uint32_t id;
+    uint32_t pos;
+    uint32_t mask = new_capacity - 1;
+
+    VS_IOT_ASSERT(new_capacity && !(new_capacity & mask));
+
+    new_slots = VS_IOT_CALLOC(new_capacity, sizeof(void *));
+    CHECK_NOT_ZERO_RET(new_slots, VS_CODE_ERR_NO_MEMORY);
+
+    for (id = 0; id < mapping->capacity; ++id) {
+        if (!mapping->slots[id] || TOMBSTONE == mapping->slots[id]) {
+            continue;
+        }
+
+        pos = _file_type_hash((vs_update_file_type_t *)mapping->slots[id]) & mask;
+        while (new_slots[pos]) {
+            pos = (pos + 1) & mask;
+        }
+        new_slots[pos] = mapping->slots[id];
+    }
+
+    VS_IOT_FREE(mapping->slots);
+    mapping->slots = new_slots;
+    mapping->capacity = new_capacity;
+    mapping->tombstones = 0;
+
+    VS_LOG_DEBUG("[FLDT] File types index capacity = %d", new_capacity);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************/
+void *
+vs_fldt_mapping_find(const vs_fldt_mapping_t *mapping, const vs_update_file_type_t *file_type) {
+    uint32_t mask;
+    uint32_t pos;
+    uint32_t probes;
+    void *elem;
+
+    if (!mapping->count) {
+        return NULL;
+    }
+
+    mask = mapping->capacity - 1;
+    pos = _file_type_hash(file_type) & mask;
+
+    for (probes = 0; probes < mapping->capacity; ++probes, pos = (pos + 1) & mask) {
+        elem = mapping->slots[pos];
+        if (!elem) {
+            break;
+        }
+        if (TOMBSTONE != elem && vs_update_equal_file_type((vs_update_file_type_t *)elem, file_type)) {
+            return elem;
+        }
+    }
+
+    return NULL;
+}
+
+/******************************************************************/
+vs_status_e
+vs_fldt_mapping_add(vs_fldt_mapping_t *mapping, const vs_update_file_type_t *file_type, void **elem) {
+    uint32_t new_capacity;
+    uint32_t mask;
+    uint32_t pos;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(mapping, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(file_type, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(elem, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(mapping->elem_sz >= sizeof(*file_type), VS_CODE_ERR_NOINIT, "[FLDT] Wrong mapping element size");
+
+    *elem = NULL;
+
+    // Keep load factor (including removed elements) below 3/4
+    if ((mapping->count + mapping->tombstones + 1) * 4 > mapping->capacity * 3) {
+        if (!mapping->capacity) {
+            new_capacity = VS_FLDT_FILE_TYPES_INITIAL_CAPACITY;
+        } else if ((mapping->count + 1) * 2 > mapping->capacity) {
+            new_capacity = mapping->capacity * 2;
+        } else {
+            new_capacity = mapping->capacity;
+        }
+        STATUS_CHECK_RET(_rehash(mapping, new_capacity), "[FLDT] Unable to grow file types index");
+    }
+
+    *elem = VS_IOT_CALLOC(1, mapping->elem_sz);
+    CHECK_NOT_ZERO_RET(*elem, VS_CODE_ERR_NO_MEMORY);
+    VS_IOT_MEMCPY(*elem, file_type, sizeof(*file_type));
+
+    mask = mapping->capacity - 1;
+    pos = _file_type_hash(file_type) & mask;
+    while (mapping->slots[pos] && TOMBSTONE != mapping->slots[pos]) {
+        pos = (pos + 1) & mask;
+    }
+
+    if (TOMBSTONE == mapping->slots[pos]) {
+        mapping->tombstones--;
+    }
+    mapping->slots[pos] = *elem;
+    mapping->count++;
+
+    VS_LOG_DEBUG("[FLDT] File type was not initialized, add new entry. Index size = %d", mapping->count);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************/
+void
+vs_fldt_mapping_remove(vs_fldt_mapping_t *mapping, void *elem) {
+    uint32_t mask;
+    uint32_t pos;
+    uint32_t probes;
+
+    if (!elem || !mapping->count) {
+        return;
+    }
+
+    mask = mapping->capacity - 1;
+    pos = _file_type_hash((vs_update_file_type_t *)elem) & mask;
+
+    for (probes = 0; probes < mapping->capacity; ++probes, pos = (pos + 1) & mask) {
+        if (!mapping->slots[pos]) {
+            break;
+        }
+        if (elem == mapping->slots[pos]) {
+            mapping->slots[pos] = TOMBSTONE;
+            mapping->tombstones++;
+            mapping->count--;
+            VS_IOT_FREE(elem);
+            return;
+        }
+    }
+
+    VS_LOG_WARNING("[FLDT] Unable to find file type element to remove");
+}
+
+/******************************************************************/
+void *
+vs_fldt_mapping_next(const vs_fldt_mapping_t *mapping, uint32_t *pos) {
+    void *elem;
+
+    while (*pos < mapping->capacity) {
+        elem = mapping->slots[(*pos)++];
+        if (elem && TOMBSTONE != elem) {
+            return elem;
+        }
+    }
+
+    return NULL;
+}
+
+/******************************************************************/
+void
+vs_fldt_mapping_clear(vs_fldt_mapping_t *mapping) {
+    uint32_t pos = 0;
+    void *elem;
+
+    while (NULL != (elem = vs_fldt_mapping_next(mapping, &pos))) {
+        VS_IOT_FREE(elem);
+    }
+
+    VS_IOT_FREE(mapping->slots);
+    mapping->slots = NULL;
+    mapping->capacity = 0;
+    mapping->count = 0;
+    mapping->tombstones = 0;
+}
+
+/******************************************************************/
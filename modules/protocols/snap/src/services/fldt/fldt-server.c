@@ -41,10 +41,11 @@
 #include <virgil/iot/trust_list/tl_structs.h>
 #include <virgil/iot/macros/macros.h>
 #include <endian-config.h>
+#include <update-config.h>
+#include <global-hal.h>
 #include <virgil/iot/update/update.h>
-
-// TODO : This setting might be moved to some config
-#define SERVER_FILE_TYPE_ARRAY_SIZE (10)
+#include <private/fldt-mapping.h>
+#include <private/snap-private.h>
 
 static vs_snap_service_t _fldt_server = {0};
 
@@ -54,80 +55,100 @@ typedef struct {
     vs_file_version_t current_version;
     void *file_header;
     uint32_t file_size;
+    bool is_verified; // File that is being received is verified after its receiving
 } vs_fldt_server_file_type_mapping_t;
 
-static uint32_t _file_type_mapping_array_size = 0;
-static vs_fldt_server_file_type_mapping_t _server_file_type_mapping[SERVER_FILE_TYPE_ARRAY_SIZE];
+static vs_fldt_mapping_t _server_file_type_mapping = {.elem_sz = sizeof(vs_fldt_server_file_type_mapping_t)};
 static vs_fldt_server_add_filetype_cb _add_filetype_callback = NULL;
 static vs_mac_addr_t _gateway_mac;
 
+// Transfers scheduler
+typedef struct {
+    bool active;
+    vs_mac_addr_t client_mac;
+    vs_update_file_type_t type;
+    uint32_t last_request_ms;
+    uint32_t round_served;
+    uint32_t started_ms;
+    uint32_t bytes_served;
+    uint32_t chunks_served;
+} vs_fldt_server_transfer_t;
+
+static vs_fldt_server_transfer_t _transfers[VS_FLDT_SERVER_TRANSFERS_MAX];
+static uint32_t _round_start_ms = 0;
+
+// Telemetry
+static vs_fldt_server_stats_t _stats;
+static uint32_t _round_chunks = 0;
+
 static vs_status_e
 _fldt_destroy_server(void);
 
 /******************************************************************/
 static vs_fldt_server_file_type_mapping_t *
 _get_mapping_elem(const vs_update_file_type_t *file_type) {
-    vs_fldt_server_file_type_mapping_t *file_type_info = _server_file_type_mapping;
-    uint32_t id;
+    vs_fldt_server_file_type_mapping_t *file_type_info = vs_fldt_mapping_find(&_server_file_type_mapping, file_type);
 
-    for (id = 0; id < _file_type_mapping_array_size; ++id, ++file_type_info) {
-        if (vs_update_equal_file_type(&file_type_info->type, file_type)) {
-            return file_type_info;
-        }
+    if (!file_type_info) {
+        VS_LOG_WARNING("[FLDT] Unable to find file type specified");
     }
 
-    VS_LOG_WARNING("[FLDT] Unable to find file type specified");
-
-    return NULL;
+    return file_type_info;
 }
 
 /******************************************************************/
 static vs_status_e
-_new_mapping_element(vs_fldt_server_file_type_mapping_t **file_element_to_add) {
-    VS_IOT_ASSERT(_file_type_mapping_array_size < (SERVER_FILE_TYPE_ARRAY_SIZE - 1));
-    CHECK_RET(_file_type_mapping_array_size < (SERVER_FILE_TYPE_ARRAY_SIZE - 1),
-              VS_CODE_ERR_NO_MEMORY,
-              "[FLDT] Can't add new file type. Array is full");
-    *file_element_to_add = &_server_file_type_mapping[_file_type_mapping_array_size++];
-    VS_LOG_DEBUG("[FLDT] File type was not initialized, add new entry. Array size = %d", _file_type_mapping_array_size);
-    VS_IOT_MEMSET(*file_element_to_add, 0, sizeof(vs_fldt_server_file_type_mapping_t));
-    return VS_CODE_OK;
+_new_mapping_element(const vs_update_file_type_t *file_type, vs_fldt_server_file_type_mapping_t **file_element_to_add) {
+    return vs_fldt_mapping_add(&_server_file_type_mapping, file_type, (void **)file_element_to_add);
+}
+
+/******************************************************************/
+static void
+_free_mapping_element_data(vs_fldt_server_file_type_mapping_t *file_element) {
+    if (file_element->update_context && file_element->update_context->free_item) {
+        file_element->update_context->free_item(file_element->update_context->storage_context, &file_element->type);
+    }
+    if (file_element->file_header) {
+        VS_LOG_DEBUG("Delete file header : %s", VS_UPDATE_FILE_TYPE_STR_STATIC(&file_element->type));
+        VS_IOT_FREE(file_element->file_header);
+        file_element->file_header = NULL;
+    }
 }
 
 /******************************************************************/
 static void
 _delete_mapping_element(vs_fldt_server_file_type_mapping_t *file_element_to_delete) {
-    vs_fldt_server_file_type_mapping_t *file_type_info = _server_file_type_mapping;
-    uint32_t id;
-    bool found = false;
-    if (0 == _file_type_mapping_array_size) {
+    if (!file_element_to_delete) {
         return;
     }
 
-    for (id = 0; id < _file_type_mapping_array_size; ++id, ++file_type_info) {
-        if (!found) {
-            if (file_element_to_delete == file_type_info) {
-                if (file_element_to_delete->update_context && file_element_to_delete->update_context->free_item) {
-                    file_element_to_delete->update_context->free_item(
-                            file_element_to_delete->update_context->storage_context, &file_element_to_delete->type);
-                }
-                if (file_element_to_delete->file_header) {
-                    VS_LOG_DEBUG("Delete file header : %s",
-                                 VS_UPDATE_FILE_TYPE_STR_STATIC(&file_element_to_delete->type));
-                    VS_IOT_FREE(file_element_to_delete->file_header);
-                    file_element_to_delete->file_header = NULL;
-                }
-                found = true;
-            }
-        } else {
-            _server_file_type_mapping[id - 1] = *file_type_info;
-            VS_IOT_MEMSET(file_type_info, 0, sizeof(vs_fldt_server_file_type_mapping_t));
-        }
+    _free_mapping_element_data(file_element_to_delete);
+    vs_fldt_mapping_remove(&_server_file_type_mapping, file_element_to_delete);
+}
+
+/******************************************************************/
+static vs_status_e
+_get_available_size(vs_fldt_server_file_type_mapping_t *file_element, uint32_t *available_size, bool *is_complete) {
+    vs_update_interface_t *update_context = file_element->update_context;
+    vs_status_e ret_code;
+
+    *available_size = file_element->file_size;
+    *is_complete = true;
+
+    if (!update_context->get_available_size) {
+        return VS_CODE_OK;
     }
 
-    if (found) {
-        _file_type_mapping_array_size--;
+    STATUS_CHECK_RET(update_context->get_available_size(
+                             update_context->storage_context, &file_element->type, available_size, is_complete),
+                     "Unable to get available size for file type %s",
+                     VS_UPDATE_FILE_TYPE_STR_STATIC(&file_element->type));
+
+    if (*is_complete || *available_size > file_element->file_size) {
+        *available_size = file_element->file_size;
     }
+
+    return VS_CODE_OK;
 }
 
 /******************************************************************/
@@ -140,6 +161,8 @@ _update_object_info(const vs_update_file_type_t *file_type,
     file_element->type = *file_type;
     file_element->update_context = update_context;
     uint32_t file_header_size;
+    uint32_t available_size;
+    bool is_complete;
 
     ret_code = update_context->get_header_size(update_context->storage_context, &file_element->type, &file_header_size);
     if (VS_CODE_OK != ret_code || !file_header_size) {
@@ -164,15 +187,27 @@ _update_object_info(const vs_update_file_type_t *file_type,
     STATUS_CHECK(
             ret_code, "Unable to get header for file type %s", VS_UPDATE_FILE_TYPE_STR_STATIC(&file_element->type));
 
-    ret_code = update_context->verify_object(update_context->storage_context, &file_element->type);
-    STATUS_CHECK(ret_code, "Unable to verify object type %s", VS_UPDATE_FILE_TYPE_STR_STATIC(&file_element->type));
-
     ret_code = update_context->get_file_size(
             update_context->storage_context, &file_element->type, file_element->file_header, &file_element->file_size);
     STATUS_CHECK(ret_code,
                  "Unable to get header size for file type %s",
                  VS_UPDATE_FILE_TYPE_STR_STATIC(&file_element->type));
 
+    ret_code = _get_available_size(file_element, &available_size, &is_complete);
+    STATUS_CHECK(ret_code, "");
+
+    // File that is being received is verified before footer sending
+    if (is_complete) {
+        ret_code = update_context->verify_object(update_context->storage_context, &file_element->type);
+        STATUS_CHECK(
+                ret_code, "Unable to verify object type %s", VS_UPDATE_FILE_TYPE_STR_STATIC(&file_element->type));
+    } else {
+        VS_LOG_DEBUG("[FLDT] File %s is being received, %u bytes are available",
+                     VS_UPDATE_FILE_TYPE_STR_STATIC(&file_element->type),
+                     available_size);
+    }
+    file_element->is_verified = is_complete;
+
     file_element->current_version = file_element->type.info.version;
 
     VS_LOG_DEBUG("[FLDT] Update file %s", VS_UPDATE_FILE_VERSION_STR_STATIC(&file_element->current_version));
@@ -200,6 +235,189 @@ terminate:
     return ret_code;
 }
 
+/******************************************************************/
+static vs_fldt_server_transfer_t *
+_transfer_find(const vs_mac_addr_t *client_mac, const vs_update_file_type_t *file_type) {
+    uint32_t i;
+
+    // Client can download several files simultaneously, each of them is a separate transfer
+    for (i = 0; i < VS_FLDT_SERVER_TRANSFERS_MAX; ++i) {
+        if (_transfers[i].active &&
+            0 == VS_IOT_MEMCMP(&_transfers[i].client_mac, client_mac, sizeof(_transfers[i].client_mac)) &&
+            vs_update_equal_file_type(&_transfers[i].type, file_type)) {
+            return &_transfers[i];
+        }
+    }
+
+    return NULL;
+}
+
+/******************************************************************/
+static uint32_t
+_transfers_active(void) {
+    uint32_t i;
+    uint32_t active = 0;
+
+    for (i = 0; i < VS_FLDT_SERVER_TRANSFERS_MAX; ++i) {
+        if (_transfers[i].active) {
+            ++active;
+        }
+    }
+
+    return active;
+}
+
+/******************************************************************/
+static void
+_transfers_reap(uint32_t now_ms) {
+    uint32_t i;
+
+    for (i = 0; i < VS_FLDT_SERVER_TRANSFERS_MAX; ++i) {
+        if (_transfers[i].active && now_ms - _transfers[i].last_request_ms >= VS_FLDT_SERVER_TRANSFER_IDLE_MS) {
+            VS_LOG_DEBUG("[FLDT] Transfer of %s for " FLDT_MAC_PRINT_TEMPLATE " is idle, release it",
+                         VS_UPDATE_FILE_TYPE_STR_STATIC(&_transfers[i].type),
+                         FLDT_MAC_PRINT_ARG(_transfers[i].client_mac));
+            _transfers[i].active = false;
+        }
+    }
+}
+
+/******************************************************************/
+static vs_fldt_server_transfer_t *
+_transfer_admit(const vs_mac_addr_t *client_mac, const vs_update_file_type_t *file_type, uint32_t now_ms) {
+    vs_fldt_server_transfer_t *transfer = _transfer_find(client_mac, file_type);
+    uint32_t i;
+
+    if (transfer) {
+        return transfer;
+    }
+
+    _transfers_reap(now_ms);
+
+    for (i = 0; i < VS_FLDT_SERVER_TRANSFERS_MAX && !transfer; ++i) {
+        if (!_transfers[i].active) {
+            transfer = &_transfers[i];
+        }
+    }
+
+    if (transfer) {
+        VS_IOT_MEMSET(transfer, 0, sizeof(*transfer));
+        transfer->active = true;
+        transfer->client_mac = *client_mac;
+        transfer->type = *file_type;
+        transfer->last_request_ms = now_ms;
+        transfer->started_ms = now_ms;
+        VS_LOG_DEBUG("[FLDT] Start transfer of %s for " FLDT_MAC_PRINT_TEMPLATE,
+                     VS_UPDATE_FILE_TYPE_STR_STATIC(file_type),
+                     FLDT_MAC_PRINT_ARG(*client_mac));
+    }
+
+    return transfer;
+}
+
+/******************************************************************/
+static void
+_transfer_finish(const vs_update_file_type_t *file_type) {
+    const vs_mac_addr_t *client_mac = _snap_request_sender();
+    vs_fldt_server_transfer_t *transfer;
+
+    if (client_mac && NULL != (transfer = _transfer_find(client_mac, file_type))) {
+        VS_LOG_DEBUG("[FLDT] Finish transfer of %s for " FLDT_MAC_PRINT_TEMPLATE,
+                     VS_UPDATE_FILE_TYPE_STR_STATIC(file_type),
+                     FLDT_MAC_PRINT_ARG(*client_mac));
+        transfer->active = false;
+        _stats.transfers_completed++;
+    }
+}
+
+/******************************************************************/
+static void
+_transfer_served(const vs_update_file_type_t *file_type, uint32_t data_sz) {
+    const vs_mac_addr_t *client_mac = _snap_request_sender();
+    vs_fldt_server_transfer_t *transfer;
+
+    _stats.bytes_served += data_sz;
+    _stats.chunks_served++;
+    _round_chunks++;
+
+    if (client_mac && NULL != (transfer = _transfer_find(client_mac, file_type))) {
+        transfer->bytes_served += data_sz;
+        transfer->chunks_served++;
+    }
+}
+
+/******************************************************************/
+static vs_status_e
+_schedule_data_request(const vs_update_file_type_t *file_type, uint32_t *delay_ms) {
+    const vs_mac_addr_t *client_mac = _snap_request_sender();
+    vs_fldt_server_transfer_t *transfer;
+    uint32_t now_ms = vs_impl_msec();
+    uint32_t i;
+
+    if (!client_mac) {
+        return VS_CODE_OK;
+    }
+
+    // Each round every active transfer gets its part of data responses
+    if (now_ms - _round_start_ms >= VS_FLDT_SERVER_ROUND_MS) {
+        _stats.chunk_rate = _round_chunks * 1000 / (now_ms - _round_start_ms);
+        _round_chunks = 0;
+        _round_start_ms = now_ms;
+        for (i = 0; i < VS_FLDT_SERVER_TRANSFERS_MAX; ++i) {
+            _transfers[i].round_served = 0;
+        }
+    }
+
+    // Admission control
+    transfer = _transfer_admit(client_mac, file_type, now_ms);
+    if (!transfer) {
+        VS_LOG_DEBUG("[FLDT] Too many transfers, " FLDT_MAC_PRINT_TEMPLATE " has to retry later",
+                     FLDT_MAC_PRINT_ARG(*client_mac));
+        *delay_ms = VS_FLDT_SERVER_ADMISSION_RETRY_MS;
+        return VS_CODE_COMMAND_RETRY_LATER;
+    }
+
+    transfer->last_request_ms = now_ms;
+
+#if VS_FLDT_SERVER_ROUND_CHUNKS
+    if (transfer->round_served && transfer->round_served >= VS_FLDT_SERVER_ROUND_CHUNKS / _transfers_active()) {
+        *delay_ms = VS_FLDT_SERVER_ROUND_MS - (now_ms - _round_start_ms);
+        return VS_CODE_COMMAND_RETRY_LATER;
+    }
+#endif
+
+    transfer->round_served++;
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************/
+static vs_status_e
+_retry_later_response(const vs_update_file_type_t *file_type,
+                      uint32_t offset,
+                      uint32_t delay_ms,
+                      uint8_t *response,
+                      const uint16_t response_buf_sz,
+                      uint16_t *response_sz) {
+    vs_fldt_retry_later_t *retry_later = (vs_fldt_retry_later_t *)response;
+
+    CHECK_RET(response_buf_sz >= sizeof(*retry_later),
+              VS_CODE_ERR_TOO_SMALL_BUFFER,
+              "Response buffer must have enough size to store vs_fldt_retry_later_t structure");
+
+    retry_later->type = *file_type;
+    retry_later->offset = offset;
+    retry_later->delay_ms = delay_ms;
+    *response_sz = sizeof(*retry_later);
+
+    _stats.retry_later++;
+
+    // Normalize byte order
+    vs_fldt_retry_later_t_encode(retry_later);
+
+    return VS_CODE_COMMAND_RETRY_LATER;
+}
+
 /*************************************************************************/
 static bool
 _file_is_newer(const vs_file_version_t *available_file, const vs_file_version_t *new_file) {
@@ -214,6 +432,7 @@ _get_object_info_by_type(const vs_update_file_type_t *requested_file_type,
     vs_status_e ret_code;
     vs_update_interface_t *update_context;
     vs_fldt_server_file_type_mapping_t *file_element = NULL;
+    bool is_loaded = false;
     *element_type_info_ptr = NULL;
 
     file_element = _get_mapping_elem(requested_file_type);
@@ -225,6 +444,7 @@ _get_object_info_by_type(const vs_update_file_type_t *requested_file_type,
             _delete_mapping_element(file_element);
             return VS_CODE_ERR_UNREGISTERED_MAPPING_TYPE;
         }
+        is_loaded = true;
     }
 
     if (!file_element) {
@@ -238,17 +458,24 @@ _get_object_info_by_type(const vs_update_file_type_t *requested_file_type,
                          "Unable to add file type [%d]",
                          requested_file_type->type);
 
-        STATUS_CHECK_RET(_new_mapping_element(&file_element), "");
+        STATUS_CHECK_RET(_new_mapping_element(requested_file_type, &file_element), "");
 
         ret_code = _update_object_info(requested_file_type, update_context, file_element, file_type_for_object);
         if (VS_CODE_OK != ret_code) {
             _delete_mapping_element(file_element);
             return VS_CODE_ERR_UNREGISTERED_MAPPING_TYPE;
         }
+        is_loaded = true;
     } else {
         VS_IOT_MEMCPY(file_type_for_object, &file_element->type, sizeof(file_element->type));
     }
 
+    if (is_loaded) {
+        _stats.cache_misses++;
+    } else {
+        _stats.cache_hits++;
+    }
+
     *element_type_info_ptr = file_element;
     return VS_CODE_OK;
 }
@@ -296,6 +523,11 @@ vs_fldt_GNFH_request_processor(const uint8_t *request,
 
     VS_LOG_DEBUG("[FLDT:GNFH] Header request for %s", VS_UPDATE_FILE_TYPE_STR_STATIC(&header_request->type));
 
+    if (file_element->update_context->file_requested) {
+        file_element->update_context->file_requested(file_element->update_context->storage_context,
+                                                     requested_file_type);
+    }
+
     header_response->file_size = file_element->file_size;
 
     STATUS_CHECK_RET(file_element->update_context->has_footer(
@@ -357,6 +589,9 @@ vs_fldt_GNFD_request_processor(const uint8_t *request,
     vs_status_e ret_code;
     uint32_t cur_offset;
     uint32_t next_offset;
+    uint32_t delay_ms;
+    uint32_t available_size;
+    bool is_complete;
 
     *response_sz = 0;
     VS_IOT_MEMSET(data_response, 0, sizeof(*data_response));
@@ -376,6 +611,11 @@ vs_fldt_GNFD_request_processor(const uint8_t *request,
               VS_CODE_ERR_INCORRECT_ARGUMENT,
               "Response buffer must have enough size to store vs_fldt_gnfd_data_response_t structure");
 
+    if (VS_CODE_COMMAND_RETRY_LATER == _schedule_data_request(&data_request->type, &delay_ms)) {
+        return _retry_later_response(
+                &data_request->type, data_request->offset, delay_ms, response, response_buf_sz, response_sz);
+    }
+
     requested_file_type = &data_request->type;
     STATUS_CHECK_RET(_get_object_info_by_type(requested_file_type, &existing_file_element, &data_response->type),
                      "Unable to get information for file %s",
@@ -387,6 +627,18 @@ vs_fldt_GNFD_request_processor(const uint8_t *request,
               data_request->offset,
               existing_file_element->file_size);
 
+    STATUS_CHECK_RET(_get_available_size(existing_file_element, &available_size, &is_complete), "");
+
+    // Data has not been received by gateway yet
+    if (data_request->offset >= available_size) {
+        return _retry_later_response(&data_request->type,
+                                     data_request->offset,
+                                     VS_FLDT_SERVER_RELAY_RETRY_MS,
+                                     response,
+                                     response_buf_sz,
+                                     response_sz);
+    }
+
     data_response->type.info.version = data_request->type.info.version;
     data_response->type = data_request->type;
     data_response->offset = data_request->offset;
@@ -396,6 +648,9 @@ vs_fldt_GNFD_request_processor(const uint8_t *request,
         max_data_size_to_read = DATA_SZ;
     }
     cur_offset = data_request->offset;
+    if (!is_complete && max_data_size_to_read > available_size - cur_offset) {
+        max_data_size_to_read = available_size - cur_offset;
+    }
 
     STATUS_CHECK_RET(
             existing_file_element->update_context->get_data(existing_file_element->update_context->storage_context,
@@ -425,6 +680,8 @@ vs_fldt_GNFD_request_processor(const uint8_t *request,
 
     *response_sz = sizeof(vs_fldt_gnfd_data_response_t) + data_response->data_size;
 
+    _transfer_served(&data_request->type, data_size_read);
+
     // Normalize byte order
     vs_fldt_gnfd_data_response_t_encode(data_response);
 
@@ -445,8 +702,10 @@ vs_fldt_GNFF_request_processor(const uint8_t *request,
     vs_fldt_gnff_footer_response_t *footer_response = (vs_fldt_gnff_footer_response_t *)response;
     static const uint16_t DATA_SZ = 512;
     uint32_t data_size;
+    uint32_t available_size;
     vs_status_e ret_code;
     bool has_footer;
+    bool is_complete;
 
     *response_sz = 0;
     VS_IOT_MEMSET(footer_response, 0, sizeof(*footer_response));
@@ -476,6 +735,29 @@ vs_fldt_GNFF_request_processor(const uint8_t *request,
                  VS_UPDATE_FILE_TYPE_STR_STATIC(&existing_file_element->type),
                  VS_UPDATE_FILE_VERSION_STR_STATIC(file_ver));
 
+    // Footer is sent after the whole file has been received and verified by gateway
+    STATUS_CHECK_RET(_get_available_size(existing_file_element, &available_size, &is_complete), "");
+    if (!is_complete) {
+        return _retry_later_response(&footer_request->type,
+                                     0,
+                                     VS_FLDT_SERVER_RELAY_RETRY_MS,
+                                     response,
+                                     response_buf_sz,
+                                     response_sz);
+    }
+
+    if (!existing_file_element->is_verified) {
+        ret_code = existing_file_element->update_context->verify_object(
+                existing_file_element->update_context->storage_context, &existing_file_element->type);
+        if (VS_CODE_OK != ret_code) {
+            VS_LOG_ERROR("[FLDT:GNFF] Unable to verify received file %s",
+                         VS_UPDATE_FILE_TYPE_STR_STATIC(&existing_file_element->type));
+            _delete_mapping_element(existing_file_element);
+            return ret_code;
+        }
+        existing_file_element->is_verified = true;
+    }
+
     STATUS_CHECK_RET(
             existing_file_element->update_context->has_footer(
                     existing_file_element->update_context->storage_context, &existing_file_element->type, &has_footer),
@@ -510,6 +792,9 @@ vs_fldt_GNFF_request_processor(const uint8_t *request,
 
     *response_sz = sizeof(vs_fldt_gnff_footer_response_t) + footer_response->footer_size;
 
+    // Client has downloaded the whole file
+    _transfer_finish(&footer_request->type);
+
     // Normalize byte order
     vs_fldt_gnff_footer_response_t_encode(footer_response);
 
@@ -538,9 +823,14 @@ vs_fldt_server_add_file_type(const vs_update_file_type_t *file_type,
     existing_file_element = _get_mapping_elem(file_type);
 
     if (!existing_file_element) {
-        STATUS_CHECK_RET(_new_mapping_element(&existing_file_element), "[FLDT] Error to create new mapping element");
+        ret_code = _new_mapping_element(file_type, &existing_file_element);
+        if (VS_CODE_OK != ret_code) {
+            VS_LOG_ERROR("[FLDT] Error to create new mapping element");
+            VS_IOT_FREE(file_element_to_add.file_header);
+            return ret_code;
+        }
     } else {
-        _delete_mapping_element(existing_file_element);
+        _free_mapping_element_data(existing_file_element);
         VS_LOG_DEBUG("[FLDT] File type is initialized and present, update it");
     }
 
@@ -569,6 +859,49 @@ vs_fldt_server_add_file_type(const vs_update_file_type_t *file_type,
     return VS_CODE_OK;
 }
 
+/******************************************************************/
+vs_status_e
+vs_fldt_server_get_stats(vs_fldt_server_stats_t *stats,
+                         vs_fldt_server_transfer_stats_t *transfers,
+                         uint32_t transfers_max,
+                         uint32_t *transfers_cnt) {
+    uint32_t now_ms = vs_impl_msec();
+    uint32_t cnt = 0;
+    uint32_t i;
+
+    CHECK_NOT_ZERO_RET(stats, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    *stats = _stats;
+
+    // Chunk rate is calculated at the end of round, so it is outdated if there are no data requests
+    if (now_ms - _round_start_ms >= 2 * VS_FLDT_SERVER_ROUND_MS) {
+        stats->chunk_rate = 0;
+    }
+
+    for (i = 0; i < VS_FLDT_SERVER_TRANSFERS_MAX; ++i) {
+        if (!_transfers[i].active || now_ms - _transfers[i].last_request_ms >= VS_FLDT_SERVER_TRANSFER_IDLE_MS) {
+            continue;
+        }
+
+        stats->active_transfers++;
+
+        if (transfers && cnt < transfers_max) {
+            transfers[cnt].client_mac = _transfers[i].client_mac;
+            transfers[cnt].type = _transfers[i].type;
+            transfers[cnt].bytes_served = _transfers[i].bytes_served;
+            transfers[cnt].chunks_served = _transfers[i].chunks_served;
+            transfers[cnt].duration_ms = now_ms - _transfers[i].started_ms;
+            ++cnt;
+        }
+    }
+
+    if (transfers_cnt) {
+        *transfers_cnt = cnt;
+    }
+
+    return VS_CODE_OK;
+}
+
 /******************************************************************/
 static void
 _init_server(const vs_mac_addr_t *gateway_mac, vs_fldt_server_add_filetype_cb add_filetype) {
@@ -586,23 +919,18 @@ terminate:;
 /******************************************************************/
 static vs_status_e
 _fldt_destroy_server(void) {
-    uint32_t id;
-    char type_str[VS_UPDATE_DEFAULT_DESC_BUF_SZ];
-    vs_fldt_server_file_type_mapping_t *file_type_mapping = _server_file_type_mapping;
+    uint32_t pos = 0;
+    vs_fldt_server_file_type_mapping_t *file_type_mapping;
 
     VS_LOG_DEBUG("_fldt_destroy_server");
-    for (id = 0; id < _file_type_mapping_array_size; ++id, ++file_type_mapping) {
-        file_type_mapping->update_context->free_item(file_type_mapping->update_context->storage_context,
-                                                     &file_type_mapping->type);
-        if (file_type_mapping->file_header) {
-            VS_LOG_DEBUG("Destroy file header : %s",
-                         vs_update_file_type_str(&file_type_mapping->type, type_str, sizeof(type_str)));
-            VS_IOT_FREE(file_type_mapping->file_header);
-            file_type_mapping->file_header = NULL;
-        }
+    while (NULL != (file_type_mapping = vs_fldt_mapping_next(&_server_file_type_mapping, &pos))) {
+        _free_mapping_element_data(file_type_mapping);
     }
 
-    _file_type_mapping_array_size = 0;
+    vs_fldt_mapping_clear(&_server_file_type_mapping);
+    VS_IOT_MEMSET(_transfers, 0, sizeof(_transfers));
+    VS_IOT_MEMSET(&_stats, 0, sizeof(_stats));
+    _round_chunks = 0;
 
     return VS_CODE_OK;
 }
@@ -665,16 +993,24 @@ _fldt_server_response_processor(const struct vs_netif_t *netif,
     }
 }
 
+/******************************************************************************/
+static vs_status_e
+_fldt_server_periodical_processor(void) {
+    // Release slots of clients that have stopped downloading, so waiting clients are admitted on their next retry
+    _transfers_reap(vs_impl_msec());
+
+    return VS_CODE_OK;
+}
+
 /******************************************************************************/
 const vs_snap_service_t *
 vs_snap_fldt_server(const vs_mac_addr_t *gateway_mac, vs_fldt_server_add_filetype_cb add_filetype) {
 
-    VS_IOT_ASSERT(SERVER_FILE_TYPE_ARRAY_SIZE);
     _fldt_server.user_data = 0;
     _fldt_server.id = VS_FLDT_SERVICE_ID;
     _fldt_server.request_process = _fldt_server_request_processor;
     _fldt_server.response_process = _fldt_server_response_processor;
-    _fldt_server.periodical_process = NULL;
+    _fldt_server.periodical_process = _fldt_server_periodical_processor;
     _fldt_server.deinit = _fldt_destroy_server;
 
     _init_server(gateway_mac, add_filetype);
@@ -52,7 +52,7 @@ static size_t _devices_list_max = 0;
 static size_t _devices_list_cnt = 0;
 
 // Callbacks for devices polling
-static vs_snap_info_client_service_t _impl = {NULL, NULL, NULL};
+static vs_snap_info_client_service_t _impl = {NULL, NULL, NULL, NULL};
 
 /******************************************************************************/
 vs_status_e
@@ -238,6 +238,65 @@ _stat_request_processor(const uint8_t *request,
     return VS_CODE_OK;
 }
 
+/******************************************************************************/
+static vs_status_e
+_fldt_request_processor(const uint8_t *request,
+                        const uint16_t request_sz,
+                        uint8_t *response,
+                        const uint16_t response_buf_sz,
+                        uint16_t *response_sz) {
+
+    vs_info_fldt_response_t *fldt_request = (vs_info_fldt_response_t *)request;
+    vs_info_fldt_statistics_t fldt_info;
+
+    // Check is callback present
+    if (!_impl.fldt_statistics) {
+        return VS_CODE_OK;
+    }
+
+    // Check input parameters
+    CHECK_RET(request, VS_CODE_ERR_INCORRECT_PARAMETER, "SNAP:FLDT error on a remote device");
+    CHECK_RET(sizeof(vs_info_fldt_response_t) == request_sz, VS_CODE_ERR_INCORRECT_ARGUMENT, "Wrong data size");
+
+    // Normalize byte order
+    vs_info_fldt_response_t_decode(fldt_request);
+
+    // Get data from packed structure
+    VS_IOT_MEMSET(&fldt_info, 0, sizeof(fldt_info));
+    VS_IOT_MEMCPY(fldt_info.default_netif_mac, fldt_request->mac.bytes, ETH_ADDR_LEN);
+
+    // FLDT server
+    fldt_info.active_transfers = fldt_request->active_transfers;
+    fldt_info.transfers_completed = fldt_request->transfers_completed;
+    fldt_info.bytes_served = fldt_request->bytes_served;
+    fldt_info.chunks_served = fldt_request->chunks_served;
+    fldt_info.chunk_rate = fldt_request->chunk_rate;
+    fldt_info.retry_later = fldt_request->retry_later;
+    fldt_info.cache_hits = fldt_request->cache_hits;
+    fldt_info.cache_misses = fldt_request->cache_misses;
+
+    // FLDT client
+    fldt_info.file_type = fldt_request->file_type;
+    fldt_info.in_progress = fldt_request->in_progress != 0;
+    fldt_info.completed = fldt_request->completed != 0;
+    fldt_info.file_size = fldt_request->file_size;
+    fldt_info.received_size = fldt_request->received_size;
+    fldt_info.retries = fldt_request->retries;
+    fldt_info.postponed = fldt_request->postponed;
+    fldt_info.srtt_ms = fldt_request->srtt_ms;
+    fldt_info.rto_ms = fldt_request->rto_ms;
+    fldt_info.duration_ms = fldt_request->duration_ms;
+    fldt_info.eta_ms = fldt_request->eta_ms;
+    fldt_info.last_error = (vs_status_e)fldt_request->last_error;
+
+    // Invoke callback function
+    _impl.fldt_statistics(&fldt_info);
+
+    *response_sz = 0;
+
+    return VS_CODE_OK;
+}
+
 /******************************************************************************/
 static vs_status_e
 _enum_response_processor(bool is_ack, const uint8_t *response, const uint16_t response_sz) {
@@ -293,6 +352,9 @@ _info_client_request_processor(const struct vs_netif_t *netif,
     case VS_INFO_STAT:
         return _stat_request_processor(request, request_sz, response, response_buf_sz, response_sz);
 
+    case VS_INFO_FLDT:
+        return _fldt_request_processor(request, request_sz, response, response_buf_sz, response_sz);
+
     default:
         VS_LOG_ERROR("Unsupported INFO command");
         VS_IOT_ASSERT(false);
@@ -314,6 +376,7 @@ _info_client_response_processor(const struct vs_netif_t *netif,
     case VS_INFO_SNOT:
     case VS_INFO_GINF:
     case VS_INFO_STAT:
+    case VS_INFO_FLDT:
         return VS_CODE_COMMAND_NO_RESPONSE;
 
     case VS_INFO_ENUM:
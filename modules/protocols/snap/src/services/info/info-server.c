@@ -38,6 +38,10 @@
 #include <virgil/iot/protocols/snap/fldt/fldt-client.h>
 #endif
 
+#if FLDT_SERVER
+#include <virgil/iot/protocols/snap/fldt/fldt-server.h>
+#endif
+
 #include <virgil/iot/protocols/snap/info/info-server.h>
 #include <virgil/iot/protocols/snap/info/info-private.h>
 #include <virgil/iot/protocols/snap/info/info-structs.h>
@@ -48,12 +52,13 @@
 #include <virgil/iot/macros/macros.h>
 #include <stdlib-config.h>
 #include <endian-config.h>
+#include <global-hal.h>
 
 // Polling
 typedef struct {
     uint32_t elements_mask;
     uint16_t period_seconds;
-    uint16_t time_counter;
+    uint32_t last_send_ms;
     vs_mac_addr_t dest_mac;
 } vs_poll_ctx_t;
 
@@ -127,7 +132,8 @@ _poll_request_processing(const uint8_t *request,
     if (poll_request->enable) {
         _poll_ctx.period_seconds = poll_request->period_seconds;
         _poll_ctx.elements_mask |= poll_request->elements;
-        _poll_ctx.time_counter = _poll_ctx.period_seconds;
+        // Send state at the next periodical call
+        _poll_ctx.last_send_ms = vs_impl_msec() - _poll_ctx.period_seconds * 1000U;
         VS_IOT_MEMCPY(&_poll_ctx.dest_mac, &poll_request->recipient_mac, sizeof(poll_request->recipient_mac));
     } else {
         _poll_ctx.elements_mask &= ~poll_request->elements;
@@ -189,6 +195,66 @@ _fill_ginf_data(vs_info_ginf_response_t *general_info) {
     return VS_CODE_OK;
 }
 
+/******************************************************************/
+static vs_status_e
+_fill_fldt_data(vs_info_fldt_response_t *fldt_data) {
+    const vs_netif_t *default_netif;
+#if FLDT_SERVER
+    vs_fldt_server_stats_t server_stats;
+#endif
+#if FLDT_CLIENT
+    vs_fldt_client_stats_t client_stats;
+#endif
+#if FLDT_SERVER || FLDT_CLIENT
+    vs_status_e ret_code;
+#endif
+
+    CHECK_NOT_ZERO_RET(fldt_data, VS_CODE_ERR_INCORRECT_ARGUMENT);
+
+    VS_IOT_MEMSET(fldt_data, 0, sizeof(*fldt_data));
+
+    default_netif = vs_snap_default_netif();
+    CHECK_RET(!default_netif->mac_addr(default_netif, &fldt_data->mac),
+              -1,
+              "Cannot get MAC for Default Network Interface");
+
+#if FLDT_SERVER
+    STATUS_CHECK_RET(vs_fldt_server_get_stats(&server_stats, NULL, 0, NULL), "Cannot get FLDT server statistics");
+    fldt_data->active_transfers = server_stats.active_transfers;
+    fldt_data->transfers_completed = server_stats.transfers_completed;
+    fldt_data->bytes_served = server_stats.bytes_served;
+    fldt_data->chunks_served = server_stats.chunks_served;
+    fldt_data->chunk_rate = server_stats.chunk_rate;
+    fldt_data->retry_later = server_stats.retry_later;
+    fldt_data->cache_hits = server_stats.cache_hits;
+    fldt_data->cache_misses = server_stats.cache_misses;
+#endif
+
+#if FLDT_CLIENT
+    // There were no downloads yet
+    ret_code = vs_fldt_client_get_stats(NULL, &client_stats);
+    if (VS_CODE_OK == ret_code) {
+        fldt_data->file_type = client_stats.type;
+        fldt_data->in_progress = client_stats.in_progress ? 1 : 0;
+        fldt_data->completed = client_stats.completed ? 1 : 0;
+        fldt_data->file_size = client_stats.file_size;
+        fldt_data->received_size = client_stats.received_size;
+        fldt_data->retries = client_stats.retries;
+        fldt_data->postponed = client_stats.postponed;
+        fldt_data->srtt_ms = client_stats.srtt_ms;
+        fldt_data->rto_ms = client_stats.rto_ms;
+        fldt_data->duration_ms = client_stats.duration_ms;
+        fldt_data->eta_ms = client_stats.eta_ms;
+        fldt_data->last_error = client_stats.last_error;
+    }
+#endif
+
+    // Normalize byte order
+    vs_info_fldt_response_t_encode(fldt_data);
+
+    return VS_CODE_OK;
+}
+
 /******************************************************************************/
 static vs_status_e
 _snot_request_processor(const uint8_t *request,
@@ -260,6 +326,7 @@ _info_request_processor(const struct vs_netif_t *netif,
 
     case VS_INFO_GINF:
     case VS_INFO_STAT:
+    case VS_INFO_FLDT:
         return VS_CODE_COMMAND_NO_RESPONSE;
 
     default:
@@ -272,10 +339,11 @@ _info_request_processor(const struct vs_netif_t *netif,
 static vs_status_e
 _info_server_periodical_processor(void) {
     vs_status_e ret_code;
+    uint32_t now_ms = vs_impl_msec();
 
-    _poll_ctx.time_counter++;
-    if (_poll_ctx.time_counter >= _poll_ctx.period_seconds) {
-        _poll_ctx.time_counter = 0;
+    // Periodical processing can be called more often than once per second
+    if (now_ms - _poll_ctx.last_send_ms >= _poll_ctx.period_seconds * 1000U) {
+        _poll_ctx.last_send_ms = now_ms;
         if (_poll_ctx.elements_mask & VS_SNAP_INFO_GENERAL) {
             vs_info_ginf_response_t general_info;
             STATUS_CHECK_RET(_fill_ginf_data(&general_info), "Error _fill_ginf_data");
@@ -299,6 +367,17 @@ _info_server_periodical_processor(void) {
                                  (uint8_t *)&stat_data,
                                  sizeof(stat_data));
         }
+
+        if (_poll_ctx.elements_mask & VS_SNAP_INFO_FLDT) {
+            vs_info_fldt_response_t fldt_data;
+            STATUS_CHECK_RET(_fill_fldt_data(&fldt_data), "Cannot fill FLDT statistics");
+            vs_snap_send_request(NULL,
+                                 vs_snap_broadcast_mac(),
+                                 VS_INFO_SERVICE_ID,
+                                 VS_INFO_FLDT,
+                                 (uint8_t *)&fldt_data,
+                                 sizeof(fldt_data));
+        }
     }
 
     return VS_CODE_OK;
@@ -53,6 +53,7 @@ static uint32_t _snap_services_num = 0;
 static vs_mac_addr_t _snap_broadcast_mac = {.bytes = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}};
 
 static vs_snap_stat_t _statistics = {0, 0};
+static const vs_mac_addr_t *_request_sender = NULL;
 
 static vs_device_manufacture_id_t _manufacture_id;
 static vs_device_type_t _device_type;
@@ -134,6 +135,7 @@ _process_packet(const vs_netif_t *netif, vs_snap_packet_t *packet) {
             } else if (_snap_services[i]->request_process) {
                 need_response = true;
                 _statistics.received++;
+                _request_sender = &packet->eth_header.src;
                 res = _snap_services[i]->request_process(netif,
                                                          packet->header.element_id,
                                                          packet->content,
@@ -141,6 +143,7 @@ _process_packet(const vs_netif_t *netif, vs_snap_packet_t *packet) {
                                                          response_packet->content,
                                                          RESPONSE_SZ_MAX,
                                                          &response_sz);
+                _request_sender = NULL;
                 if (0 == res) {
                     // Send response
                     response_packet->header.content_size = response_sz;
@@ -148,6 +151,10 @@ _process_packet(const vs_netif_t *netif, vs_snap_packet_t *packet) {
                 } else {
                     if (VS_CODE_COMMAND_NO_RESPONSE == res) {
                         need_response = false;
+                    } else if (VS_CODE_COMMAND_RETRY_LATER == res) {
+                        // Negative response with service specific hint
+                        response_packet->header.flags |= VS_SNAP_FLAG_NACK;
+                        response_packet->header.content_size = response_sz;
                     } else {
                         // Send response with error code
                         // TODO: Fill structure with error code here
@@ -464,6 +471,12 @@ _snap_fill_header(const vs_mac_addr_t *recipient_mac, vs_snap_packet_t *packet)
     return VS_CODE_OK;
 }
 
+/******************************************************************************/
+const vs_mac_addr_t *
+_snap_request_sender(void) {
+    return _request_sender;
+}
+
 /******************************************************************************/
 const vs_mac_addr_t *
 vs_snap_broadcast_mac(void) {
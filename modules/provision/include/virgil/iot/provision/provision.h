@@ -168,6 +168,44 @@ vs_provision_search_hl_pubkey(vs_key_type_e key_type,
 vs_status_e
 vs_provision_verify_hl_key(const uint8_t *key_to_check, uint16_t key_size);
 
+/** Verify hash signatures
+ *
+ * This function verifies signatures block of Firmware or Trust List. Each signer key has to be found by
+ * #vs_provision_search_hl_pubkey. Signatures of signers from \a rules list are verified by Security Module, and there
+ * must be at least \a rules_count of them. Verification fails if any check fails.
+ *
+ * If library has been built with VIRGIL_IOT_PARALLEL_VERIFY option, signatures are checked concurrently by a thread
+ * pool. In this case Security Module \a slot_load and \a ecdsa_verify calls must be thread safe.
+ *
+ * \param[in] hash SHA-256 hash of signed data. Must not be NULL.
+ * \param[in] signatures Sequence of #vs_sign_t signatures with signature and public key data. Must not be NULL.
+ * \param[in] signatures_count Signatures amount.
+ * \param[in] signatures_sz \a signatures buffer size.
+ * \param[in] rules Signer types which signatures are required. Must not be NULL.
+ * \param[in] rules_count \a rules amount.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_provision_verify_hash_signatures(const uint8_t *hash,
+                                    const uint8_t *signatures,
+                                    uint8_t signatures_count,
+                                    size_t signatures_sz,
+                                    const vs_key_type_e *rules,
+                                    uint8_t rules_count);
+
+/** Set quantity of signatures verification threads
+ *
+ * Threads verify signatures together with the calling one. Zero disables parallel verification.
+ *
+ * \param[in] threads_count Threads quantity up to #VS_PROVISION_VERIFY_THREADS_QTY.
+ *
+ * \return #VS_CODE_OK in case of success or #VS_CODE_ERR_UNSUPPORTED if library has been built without
+ * VIRGIL_IOT_PARALLEL_VERIFY option.
+ */
+vs_status_e
+vs_provision_set_verify_threads(uint8_t threads_count);
+
 /** Get Thing service URL
  *
  * This function returns Cloud URL for Thing service.
@@ -35,6 +35,11 @@
 
 #include <stdlib-config.h>
 #include <endian-config.h>
+#include <trust_list-config.h>
+
+#if PROVISION_PARALLEL_VERIFY
+#include <pthread.h>
+#endif
 
 #include <virgil/iot/secmodule/secmodule.h>
 #include <virgil/iot/secmodule/secmodule-helpers.h>
@@ -56,6 +61,38 @@ static vs_secmodule_impl_t *_secmodule = NULL;
 
 static char *_base_url = NULL;
 
+// Check of one signature
+typedef struct {
+    const vs_sign_t *sign;
+    const uint8_t *pubkey;
+    uint16_t sign_len;
+    uint16_t key_len;
+    bool check_signature;
+    const uint8_t *hash;
+    vs_status_e result;
+} vs_provision_sign_job_t;
+
+#if PROVISION_PARALLEL_VERIFY
+// Signatures of one vs_provision_verify_hash_signatures call
+typedef struct vs_provision_sign_batch_s {
+    vs_provision_sign_job_t *jobs;
+    uint16_t count;
+    uint16_t taken;
+    uint16_t done;
+    bool failed;
+    pthread_cond_t done_cond;
+    struct vs_provision_sign_batch_s *next;
+} vs_provision_sign_batch_t;
+
+static pthread_mutex_t _pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _pool_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t _pool_threads[VS_PROVISION_VERIFY_THREADS_QTY];
+static uint8_t _pool_threads_count = 0;
+static uint8_t _pool_threads_required = VS_PROVISION_VERIFY_THREADS_QTY;
+static bool _pool_stop = false;
+static vs_provision_sign_batch_t *_pool_queue = NULL;
+#endif // PROVISION_PARALLEL_VERIFY
+
 /******************************************************************************/
 static vs_status_e
 _get_pubkey_slot_num(vs_key_type_e key_type, uint8_t index, vs_iot_secmodule_slot_e *slot) {
@@ -245,6 +282,301 @@ vs_provision_verify_hl_key(const uint8_t *key_to_check, uint16_t key_size) {
     return VS_CODE_OK;
 }
 
+/******************************************************************************/
+static bool
+_is_signer_in_rules(uint8_t signer_type, const vs_key_type_e *rules, uint8_t rules_count) {
+    uint8_t i;
+    for (i = 0; i < rules_count; ++i) {
+        if (rules[i] == signer_type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/******************************************************************************/
+static vs_status_e
+_verify_sign_job(const vs_provision_sign_job_t *job) {
+    vs_status_e ret_code;
+
+    STATUS_CHECK_RET(
+            vs_provision_search_hl_pubkey(job->sign->signer_type, job->sign->ec_type, job->pubkey, job->key_len),
+            "Signer key is wrong");
+
+    if (job->check_signature) {
+        STATUS_CHECK_RET(_secmodule->ecdsa_verify(job->sign->ec_type,
+                                                  job->pubkey,
+                                                  job->key_len,
+                                                  job->sign->hash_type,
+                                                  job->hash,
+                                                  job->sign->raw_sign_pubkey,
+                                                  job->sign_len),
+                         "Signature is wrong");
+    }
+
+    return VS_CODE_OK;
+}
+
+#if PROVISION_PARALLEL_VERIFY
+/******************************************************************************/
+// _pool_mutex must be locked
+static vs_provision_sign_job_t *
+_batch_take_job(vs_provision_sign_batch_t *batch) {
+    vs_provision_sign_batch_t **ptr;
+
+    if (batch->taken >= batch->count) {
+        return NULL;
+    }
+
+    // All jobs have been taken, so batch isn't needed in queue
+    if (batch->taken + 1 == batch->count) {
+        for (ptr = &_pool_queue; *ptr; ptr = &(*ptr)->next) {
+            if (*ptr == batch) {
+                *ptr = batch->next;
+                break;
+            }
+        }
+    }
+
+    return &batch->jobs[batch->taken++];
+}
+
+/******************************************************************************/
+// _pool_mutex must be locked. It is unlocked while signature is verified
+static void
+_batch_run_job(vs_provision_sign_batch_t *batch, vs_provision_sign_job_t *job) {
+    // There is no need to verify the rest after the first fail
+    bool skip = batch->failed;
+
+    pthread_mutex_unlock(&_pool_mutex);
+    job->result = skip ? VS_CODE_ERR_VERIFY : _verify_sign_job(job);
+    pthread_mutex_lock(&_pool_mutex);
+
+    if (VS_CODE_OK != job->result) {
+        batch->failed = true;
+    }
+
+    if (++batch->done == batch->count) {
+        pthread_cond_signal(&batch->done_cond);
+    }
+}
+
+/******************************************************************************/
+static void *
+_pool_thread(void *arg) {
+    vs_provision_sign_batch_t *batch;
+    (void)arg;
+
+    pthread_mutex_lock(&_pool_mutex);
+
+    while (!_pool_stop) {
+        if (!_pool_queue) {
+            pthread_cond_wait(&_pool_cond, &_pool_mutex);
+            continue;
+        }
+
+        batch = _pool_queue;
+        _batch_run_job(batch, _batch_take_job(batch));
+    }
+
+    pthread_mutex_unlock(&_pool_mutex);
+
+    return NULL;
+}
+
+/******************************************************************************/
+// _pool_mutex must be locked
+static void
+_pool_start_threads(void) {
+    while (!_pool_stop && _pool_threads_count < _pool_threads_required) {
+        if (0 != pthread_create(&_pool_threads[_pool_threads_count], NULL, _pool_thread, NULL)) {
+            VS_LOG_WARNING("Unable to start signatures verification thread");
+            break;
+        }
+        ++_pool_threads_count;
+    }
+}
+
+/******************************************************************************/
+static void
+_pool_stop_threads(void) {
+    uint8_t i;
+    uint8_t threads_count;
+
+    pthread_mutex_lock(&_pool_mutex);
+    _pool_stop = true;
+    threads_count = _pool_threads_count;
+    pthread_cond_broadcast(&_pool_cond);
+    pthread_mutex_unlock(&_pool_mutex);
+
+    // Callers verify the rest of their signatures by themselves
+    for (i = 0; i < threads_count; ++i) {
+        pthread_join(_pool_threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&_pool_mutex);
+    _pool_threads_count = 0;
+    _pool_stop = false;
+    pthread_mutex_unlock(&_pool_mutex);
+}
+
+/******************************************************************************/
+static vs_status_e
+_verify_sign_jobs(vs_provision_sign_job_t *jobs, uint16_t count) {
+    vs_provision_sign_batch_t batch;
+    vs_provision_sign_batch_t **ptr;
+    vs_provision_sign_job_t *job;
+    uint16_t i;
+
+    VS_IOT_MEMSET(&batch, 0, sizeof(batch));
+    batch.jobs = jobs;
+    batch.count = count;
+    pthread_cond_init(&batch.done_cond, NULL);
+
+    pthread_mutex_lock(&_pool_mutex);
+
+    _pool_start_threads();
+
+    if (_pool_threads_count && count > 1) {
+        ptr = &_pool_queue;
+        while (*ptr) {
+            ptr = &(*ptr)->next;
+        }
+        *ptr = &batch;
+        pthread_cond_broadcast(&_pool_cond);
+    }
+
+    // Calling thread verifies signatures too
+    while (NULL != (job = _batch_take_job(&batch))) {
+        _batch_run_job(&batch, job);
+    }
+
+    while (batch.done < batch.count) {
+        pthread_cond_wait(&batch.done_cond, &_pool_mutex);
+    }
+
+    pthread_mutex_unlock(&_pool_mutex);
+    pthread_cond_destroy(&batch.done_cond);
+
+    for (i = 0; i < count; ++i) {
+        if (VS_CODE_OK != jobs[i].result) {
+            return jobs[i].result;
+        }
+    }
+
+    return VS_CODE_OK;
+}
+
+#endif // PROVISION_PARALLEL_VERIFY
+
+/******************************************************************************/
+vs_status_e
+vs_provision_verify_hash_signatures(const uint8_t *hash,
+                                    const uint8_t *signatures,
+                                    uint8_t signatures_count,
+                                    size_t signatures_sz,
+                                    const vs_key_type_e *rules,
+                                    uint8_t rules_count) {
+    const uint8_t *signatures_end = signatures + signatures_sz;
+    const vs_sign_t *sign = (const vs_sign_t *)signatures;
+    uint8_t sign_rules = 0;
+    int sign_len;
+    int key_len;
+    uint16_t i;
+
+    VS_IOT_ASSERT(_secmodule);
+
+    CHECK_NOT_ZERO_RET(hash, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(signatures, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(rules, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(signatures_count >= rules_count, VS_CODE_ERR_VERIFY, "There are not enough signatures");
+    CHECK_RET(signatures_count, VS_CODE_ERR_VERIFY, "There are no signatures");
+
+#if PROVISION_PARALLEL_VERIFY
+    // Parse all signatures before checks
+    vs_provision_sign_job_t jobs[signatures_count];
+    vs_provision_sign_job_t *job;
+#else
+    // Check each signature after parsing
+    vs_provision_sign_job_t job[1];
+    vs_status_e ret_code;
+#endif
+
+    for (i = 0; i < signatures_count; ++i) {
+#if PROVISION_PARALLEL_VERIFY
+        job = &jobs[i];
+#endif
+        CHECK_RET((const uint8_t *)sign->raw_sign_pubkey <= signatures_end,
+                  VS_CODE_ERR_FORMAT_OVERFLOW,
+                  "Signature is outside of signatures block");
+        CHECK_RET(sign->hash_type == VS_HASH_SHA_256, VS_CODE_ERR_UNSUPPORTED, "Unsupported hash type of signature");
+
+        sign_len = vs_secmodule_get_signature_len(sign->ec_type);
+        key_len = vs_secmodule_get_pubkey_len(sign->ec_type);
+
+        CHECK_RET(sign_len > 0 && key_len > 0, VS_CODE_ERR_UNSUPPORTED, "Unsupported signature ec_type");
+        CHECK_RET(sign->raw_sign_pubkey + sign_len + key_len <= signatures_end,
+                  VS_CODE_ERR_FORMAT_OVERFLOW,
+                  "Signature is outside of signatures block");
+
+        job->sign = sign;
+        job->sign_len = (uint16_t)sign_len;
+        job->key_len = (uint16_t)key_len;
+        // Signer raw key pointer
+        job->pubkey = sign->raw_sign_pubkey + (uint16_t)sign_len;
+        job->check_signature = _is_signer_in_rules(sign->signer_type, rules, rules_count);
+        job->hash = hash;
+        job->result = VS_CODE_OK;
+
+        if (job->check_signature) {
+            sign_rules++;
+        }
+
+#if !PROVISION_PARALLEL_VERIFY
+        STATUS_CHECK_RET(_verify_sign_job(job), "Signature verification error");
+#endif
+
+        // Next signature
+        sign = (const vs_sign_t *)(job->pubkey + (uint16_t)key_len);
+    }
+
+    CHECK_RET(sign_rules >= rules_count, VS_CODE_ERR_VERIFY, "Sign rules are wrong");
+
+#if PROVISION_PARALLEL_VERIFY
+    return _verify_sign_jobs(jobs, signatures_count);
+#else
+    return VS_CODE_OK;
+#endif
+}
+
+/******************************************************************************/
+vs_status_e
+vs_provision_set_verify_threads(uint8_t threads_count) {
+#if PROVISION_PARALLEL_VERIFY
+    bool need_stop;
+
+    CHECK_RET(threads_count <= VS_PROVISION_VERIFY_THREADS_QTY,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Threads quantity must not exceed %d",
+              VS_PROVISION_VERIFY_THREADS_QTY);
+
+    pthread_mutex_lock(&_pool_mutex);
+    _pool_threads_required = threads_count;
+    need_stop = threads_count < _pool_threads_count;
+    pthread_mutex_unlock(&_pool_mutex);
+
+    // Required threads will be started by the next verification
+    if (need_stop) {
+        _pool_stop_threads();
+    }
+
+    return VS_CODE_OK;
+#else
+    (void)threads_count;
+    return VS_CODE_ERR_UNSUPPORTED;
+#endif // PROVISION_PARALLEL_VERIFY
+}
+
 /******************************************************************************/
 vs_status_e
 vs_provision_init(vs_storage_op_ctx_t *tl_storage_ctx,
@@ -260,6 +592,9 @@ vs_provision_init(vs_storage_op_ctx_t *tl_storage_ctx,
 /******************************************************************************/
 vs_status_e
 vs_provision_deinit(void) {
+#if PROVISION_PARALLEL_VERIFY
+    _pool_stop_threads();
+#endif
     VS_IOT_FREE(_base_url);
     return vs_tl_deinit();
 }
@@ -319,8 +654,8 @@ vs_provision_tl_find_next_key(vs_provision_tl_find_ctx_t *search_ctx,
                               uint16_t *pubkey_sz,
                               uint8_t **meta,
                               uint16_t *meta_sz) {
-    vs_status_e res = VS_CODE_ERR_NOT_FOUND;
-    vs_tl_element_info_t element;
+    vs_status_e res;
+    vs_tl_key_handle handle;
     uint16_t data_sz = 0;
 
     CHECK_NOT_ZERO_RET(search_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
@@ -332,24 +667,21 @@ vs_provision_tl_find_next_key(vs_provision_tl_find_ctx_t *search_ctx,
 
     *pubkey_dated = (vs_pubkey_dated_t *)search_ctx->element_buf;
 
-    // Prepare element info
-    element.id = VS_TL_ELEMENT_TLC;
-    element.index = search_ctx->last_pos + 1;
-
-    while (VS_CODE_OK == vs_tl_load_part(&element, search_ctx->element_buf, VS_TL_STORAGE_MAX_PART_SIZE, &data_sz)) {
-        element.index++;
-        if ((*pubkey_dated)->pubkey.key_type != search_ctx->key_type) {
-            continue;
-        }
-        if (element.index >= search_ctx->last_pos) {
-            *meta_sz = VS_IOT_NTOHS((*pubkey_dated)->pubkey.meta_data_sz);
-            *meta = (*pubkey_dated)->pubkey.meta_and_pubkey;
-            *pubkey_sz = vs_secmodule_get_pubkey_len((*pubkey_dated)->pubkey.ec_type);
-            *pubkey = &(*pubkey_dated)->pubkey.meta_and_pubkey[*meta_sz];
-            res = VS_CODE_OK;
-            search_ctx->last_pos = element.index;
-            break;
-        }
+    handle = search_ctx->last_pos + 1;
+
+    res = vs_tl_find_key(search_ctx->key_type,
+                         VS_KEYPAIR_INVALID,
+                         &handle,
+                         search_ctx->element_buf,
+                         VS_TL_STORAGE_MAX_PART_SIZE,
+                         &data_sz);
+
+    if (VS_CODE_OK == res) {
+        *meta_sz = VS_IOT_NTOHS((*pubkey_dated)->pubkey.meta_data_sz);
+        *meta = (*pubkey_dated)->pubkey.meta_and_pubkey;
+        *pubkey_sz = vs_secmodule_get_pubkey_len((*pubkey_dated)->pubkey.ec_type);
+        *pubkey = &(*pubkey_dated)->pubkey.meta_and_pubkey[*meta_sz];
+        search_ctx->last_pos = handle;
     }
 
     return res;
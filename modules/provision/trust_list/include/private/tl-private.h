@@ -1,7 +1,9 @@
 #ifndef TL_OPERATIONS_H
 #define TL_OPERATIONS_H
 
+#include <trust_list-config.h>
 #include <virgil/iot/secmodule/secmodule.h>
+#include <virgil/iot/secmodule/secmodule-helpers.h>
 #include <virgil/iot/macros/macros.h>
 #include <virgil/iot/storage_hal/storage_hal.h>
 #include <virgil/iot/status_code/status_code.h>
@@ -15,14 +17,50 @@ typedef struct {
     uint16_t keys_count;
 } tl_keys_qty_t;
 
+// Verification result of Trust List with such header, signed hash and footer hash. It is sealed by device MAC.
+typedef struct __attribute__((__packed__)) {
+    vs_tl_header_t header;
+    uint8_t tl_hash[VS_HASH_SHA256_LEN];
+    uint8_t footer_hash[VS_HASH_SHA256_LEN];
+    uint16_t uses;
+    uint8_t mac[VS_HASH_SHA256_LEN];
+} vs_tl_verify_cache_t;
+
+#define VS_TL_VERIFY_CACHE_ELEMENT VS_TL_ELEMENT_MAX
+
 typedef struct {
     bool ready;
+    bool legacy;
     const vs_storage_op_ctx_t *storage_ctx;
     vs_tl_storage_ctx_t storage;
     vs_tl_header_t header;
     tl_keys_qty_t keys_qty;
+    uint32_t data_offset;
+    uint32_t footer_offset;
+#if VS_TL_VERIFY_CACHE
+    vs_tl_verify_cache_t verified;
+#endif // VS_TL_VERIFY_CACHE
 } vs_tl_context_t;
 
+// Trust List is packed into one storage element : header, offsets table, public keys and footer. Offsets table
+// contains network byte order offsets of each key, footer and Trust List end.
+#define VS_TL_PACKED_ELEMENT VS_TL_ELEMENT_MIN
+#define VS_TL_PACKED_TABLE_POS(INDEX) (sizeof(vs_tl_header_t) + (INDEX) * sizeof(uint32_t))
+
+typedef struct {
+    uint8_t key_type;
+    uint8_t ec_type;
+    uint16_t key_sz;
+    uint32_t offset;
+    vs_tl_key_handle handle;
+} vs_tl_key_index_entry_t;
+
+typedef struct {
+    vs_tl_key_index_entry_t *entries;
+    uint8_t *keys;
+    uint16_t entries_cnt;
+} vs_tl_key_index_t;
+
 vs_status_e
 vs_tl_storage_init_internal(vs_storage_op_ctx_t *op_ctx, vs_secmodule_impl_t *secmodule);
 vs_status_e
@@ -46,6 +84,15 @@ vs_status_e
 vs_tl_key_load(size_t storage_type, vs_tl_key_handle handle, uint8_t *key, uint16_t buf_sz, uint16_t *key_sz);
 vs_status_e
 vs_tl_verify_storage(size_t storage_type);
+vs_status_e
+vs_tl_delta_apply_to_tmp(const uint8_t *delta, size_t delta_sz);
+vs_status_e
+vs_tl_key_search(vs_key_type_e key_type,
+                 vs_secmodule_keypair_type_e ec_type,
+                 vs_tl_key_handle *handle,
+                 uint8_t *key,
+                 uint16_t buf_sz,
+                 uint16_t *key_sz);
 
 vs_status_e
 vs_update_trust_list_init(vs_storage_op_ctx_t *storage_ctx);
@@ -72,6 +72,25 @@ typedef struct __attribute__((__packed__)) {
     uint8_t signatures[]; /**< Signatures */
 } vs_tl_footer_t;
 
+/** Trust List delta operations */
+typedef enum {
+    VS_TL_DELTA_OP_REMOVE = 0, /**< Remove public key from base Trust List */
+    VS_TL_DELTA_OP_ADD,        /**< Append public key to the end of result Trust List */
+} vs_tl_delta_op_e;
+
+/** Trust List delta header
+ *
+ * Delta consists of this header, \a ops_count operations and the footer of result Trust List. Each operation is
+ * #vs_tl_delta_op_e byte followed by the whole #vs_pubkey_dated_t element. Result keys are base keys without removed
+ * ones in the same order, then added keys in operations order. Footer signatures are made for result Trust List, so
+ * the delta is accepted only if result is equal to full Trust List of \a target_header version.
+ */
+typedef struct __attribute__((__packed__)) {
+    vs_file_version_t base_version; /**< Trust List version this delta can be applied to */
+    vs_tl_header_t target_header;   /**< Result Trust List header */
+    uint16_t ops_count;             /**< Operations amount */
+} vs_tl_delta_header_t;
+
 typedef enum {
     VS_TL_ELEMENT_MIN = 0,
     VS_TL_ELEMENT_TLH,
@@ -127,7 +127,8 @@ extern "C" {
 
 /** Trust List initialization
  *
- * Initializes Trust List.
+ * Initializes Trust List. If #VS_TL_VERIFY_CACHE is enabled, signatures of Trust List that has been verified on this
+ * device already are not verified again.
  *
  * \note It is called by #vs_provision_init.
  *
@@ -163,6 +164,43 @@ vs_tl_deinit(void);
 vs_status_e
 vs_tl_save_part(vs_tl_element_info_t *element_info, const uint8_t *in_data, uint16_t data_sz);
 
+/** Trust List key search
+ *
+ * Searches the key of \a key_type type in current Trust List starting from \a handle position. If Trust List keys
+ * index is enabled by #VS_TL_KEY_INDEX, keys are taken from RAM without storage access.
+ *
+ * \param[in] key_type Key type.
+ * \param[in] ec_type Key pair type. #VS_KEYPAIR_INVALID to find key of any type.
+ * \param[in,out] handle Key position to start search from. Found key position is stored here. Must not be NULL.
+ * \param[out] key Output buffer for #vs_pubkey_dated_t key. Must not be NULL.
+ * \param[in] buf_sz Buffer size.
+ * \param[out] key_sz Pointer to save key size. Must not be NULL.
+ *
+ * \return #VS_CODE_OK in case of success, #VS_CODE_ERR_NOT_FOUND if there are no more keys or error code.
+ */
+vs_status_e
+vs_tl_find_key(vs_key_type_e key_type,
+               vs_secmodule_keypair_type_e ec_type,
+               vs_tl_key_handle *handle,
+               uint8_t *key,
+               uint16_t buf_sz,
+               uint16_t *key_sz);
+
+/** Trust List delta applying
+ *
+ * Builds new Trust List from current one and \a delta. It is an alternative to the whole Trust List saving by
+ * #vs_tl_save_part when only few keys are changed. See #vs_tl_delta_header_t for delta format. Result Trust List is
+ * verified by footer signatures before it replaces current one, so current Trust List remains unchanged in case of
+ * any error.
+ *
+ * \param[in] delta Delta data. Must not be NULL.
+ * \param[in] delta_sz Delta size.
+ *
+ * \return #VS_CODE_OK in case of success or error code.
+ */
+vs_status_e
+vs_tl_apply_delta(const uint8_t *delta, size_t delta_sz);
+
 /** Trust List element loading
  *
  * Loads Trust List header, footer or data chunk. Element selection is performed by \a element_info selector.
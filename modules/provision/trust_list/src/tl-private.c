@@ -55,6 +55,10 @@ static const vs_key_type_e sign_rules_list[VS_TL_SIGNATURES_QTY] = VS_TL_SIGNER_
 
 static vs_secmodule_impl_t *_secmodule = NULL;
 
+#if VS_TL_KEY_INDEX
+static vs_tl_key_index_t _key_index;
+#endif // VS_TL_KEY_INDEX
+
 /*************************************************************************/
 static void
 _create_data_filename(size_t storage_type, vs_tl_element_e el_id, size_t index, vs_storage_element_id_t file_id) {
@@ -136,33 +140,540 @@ _write_data(const vs_storage_op_ctx_t *op_ctx,
     return op_ctx->impl_func.close(op_ctx->impl_data, f);
 }
 
+/******************************************************************************/
+static vs_status_e
+_packed_open(const vs_tl_context_t *tl_ctx, vs_storage_file_t *f, ssize_t *file_sz) {
+    const vs_storage_op_ctx_t *op_ctx = tl_ctx->storage_ctx;
+    vs_storage_element_id_t file_id;
+
+    CHECK_NOT_ZERO_RET(op_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.open, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.load, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.close, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // cppcheck-suppress uninitvar
+    _create_data_filename(tl_ctx->storage.storage_type, VS_TL_PACKED_ELEMENT, 0, file_id);
+
+    if (file_sz) {
+        *file_sz = op_ctx->impl_func.size(op_ctx->impl_data, file_id);
+        CHECK_RET(0 < *file_sz, VS_CODE_ERR_NOT_FOUND, "Can't find file");
+    }
+
+    *f = op_ctx->impl_func.open(op_ctx->impl_data, file_id);
+    CHECK_RET(NULL != *f, VS_CODE_ERR_FILE, "Can't open file");
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_packed_load(const vs_tl_context_t *tl_ctx,
+             vs_storage_file_t f,
+             ssize_t file_sz,
+             uint32_t offset,
+             void *data,
+             uint16_t data_sz) {
+    const vs_storage_op_ctx_t *op_ctx = tl_ctx->storage_ctx;
+
+    CHECK_RET(file_sz >= offset + data_sz, VS_CODE_ERR_FILE, "File format error");
+    CHECK_RET(VS_CODE_OK == op_ctx->impl_func.load(op_ctx->impl_data, f, offset, data, data_sz),
+              VS_CODE_ERR_FILE_READ,
+              "Can't load data from file");
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_packed_load_range(const vs_tl_context_t *tl_ctx, uint32_t offset, uint8_t *data, uint16_t data_sz) {
+    vs_storage_file_t f = NULL;
+    ssize_t file_sz;
+    vs_status_e ret_code;
+
+    STATUS_CHECK_RET(_packed_open(tl_ctx, &f, &file_sz), "Can't open TL storage");
+
+    ret_code = _packed_load(tl_ctx, f, file_sz, offset, data, data_sz);
+
+    tl_ctx->storage_ctx->impl_func.close(tl_ctx->storage_ctx->impl_data, f);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_packed_load_part(const vs_tl_context_t *tl_ctx, uint16_t index, uint8_t *data, uint16_t buf_sz, uint16_t *data_sz) {
+    vs_storage_file_t f = NULL;
+    ssize_t file_sz;
+    uint32_t offsets[2];
+    uint32_t part_sz;
+    vs_status_e ret_code;
+
+    STATUS_CHECK_RET(_packed_open(tl_ctx, &f, &file_sz), "Can't open TL storage");
+
+    // Part position is taken from offsets table, so part is loaded by one storage element opening
+    ret_code = _packed_load(tl_ctx, f, file_sz, VS_TL_PACKED_TABLE_POS(index), offsets, sizeof(offsets));
+
+    if (VS_CODE_OK == ret_code) {
+        offsets[0] = VS_IOT_NTOHL(offsets[0]);
+        offsets[1] = VS_IOT_NTOHL(offsets[1]);
+        part_sz = offsets[1] - offsets[0];
+
+        if (offsets[1] < offsets[0]) {
+            VS_LOG_ERROR("Wrong TL offsets table");
+            ret_code = VS_CODE_ERR_FILE_READ;
+        } else if (part_sz > buf_sz) {
+            VS_LOG_ERROR("Out buffer too small");
+            ret_code = VS_CODE_ERR_TOO_SMALL_BUFFER;
+        } else {
+            ret_code = _packed_load(tl_ctx, f, file_sz, offsets[0], data, part_sz);
+            *data_sz = part_sz;
+        }
+    }
+
+    tl_ctx->storage_ctx->impl_func.close(tl_ctx->storage_ctx->impl_data, f);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_packed_append(vs_tl_context_t *tl_ctx, uint16_t index, const uint8_t *data, uint16_t data_sz) {
+    const vs_storage_op_ctx_t *op_ctx = tl_ctx->storage_ctx;
+    vs_storage_file_t f = NULL;
+    uint32_t offsets[2];
+    vs_status_e ret_code = VS_CODE_ERR_FILE_WRITE;
+
+    CHECK_NOT_ZERO_RET(op_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.save, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.sync, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(tl_ctx->data_offset + data_sz <= op_ctx->file_sz_limit,
+              VS_CODE_ERR_TOO_SMALL_BUFFER,
+              "TL is too big for storage element");
+
+    STATUS_CHECK_RET(_packed_open(tl_ctx, &f, NULL), "Can't open TL storage");
+
+    // Data is appended and its offsets table entries are updated by one storage element opening
+    offsets[0] = VS_IOT_HTONL(tl_ctx->data_offset);
+    offsets[1] = VS_IOT_HTONL(tl_ctx->data_offset + data_sz);
+
+    CHECK(VS_CODE_OK == op_ctx->impl_func.save(op_ctx->impl_data, f, tl_ctx->data_offset, data, data_sz) &&
+                  VS_CODE_OK == op_ctx->impl_func.save(op_ctx->impl_data,
+                                                       f,
+                                                       VS_TL_PACKED_TABLE_POS(index),
+                                                       (uint8_t *)offsets,
+                                                       sizeof(offsets)),
+          "Can't save data to file");
+    CHECK(VS_CODE_OK == op_ctx->impl_func.sync(op_ctx->impl_data, f), "Can't sync file");
+
+    tl_ctx->data_offset += data_sz;
+    ret_code = VS_CODE_OK;
+
+terminate:
+    op_ctx->impl_func.close(op_ctx->impl_data, f);
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_footer_check(const vs_tl_context_t *tl_ctx, const uint8_t *footer, uint16_t footer_sz) {
+    const vs_sign_t *element;
+    uint16_t _sz = sizeof(vs_tl_footer_t);
+    int sign_len;
+    int key_len;
+    uint8_t i;
+
+    // Footer size must correspond to its signatures
+    for (i = 0; i < tl_ctx->header.signatures_count; ++i) {
+        CHECK_RET(_sz + sizeof(vs_sign_t) <= footer_sz, VS_CODE_ERR_FILE_READ, "TL footer format error");
+
+        element = (const vs_sign_t *)(footer + _sz);
+        sign_len = vs_secmodule_get_signature_len(element->ec_type);
+        key_len = vs_secmodule_get_pubkey_len(element->ec_type);
+
+        CHECK_RET(sign_len > 0 && key_len > 0, VS_CODE_ERR_FILE_READ, "Unsupported signature ec_type");
+
+        _sz += sizeof(vs_sign_t) + key_len + sign_len;
+    }
+
+    CHECK_RET(_sz == footer_sz, VS_CODE_ERR_FILE_READ, "TL footer format error");
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_legacy_load(const vs_tl_context_t *tl_ctx,
+             vs_tl_element_e el_id,
+             size_t index,
+             uint8_t *data,
+             uint16_t buf_sz,
+             uint16_t *data_sz) {
+    const vs_storage_op_ctx_t *op_ctx = tl_ctx->storage_ctx;
+    vs_storage_element_id_t file_id;
+    ssize_t file_sz;
+
+    CHECK_NOT_ZERO_RET(op_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.size, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // cppcheck-suppress uninitvar
+    _create_data_filename(tl_ctx->storage.storage_type, el_id, index, file_id);
+
+    // Each element contains one Trust List part, so it is read at once and parsed in memory
+    file_sz = op_ctx->impl_func.size(op_ctx->impl_data, file_id);
+    CHECK_RET(0 < file_sz, VS_CODE_ERR_FILE_READ, "Can't find TL element");
+    CHECK_RET(file_sz <= buf_sz, VS_CODE_ERR_TOO_SMALL_BUFFER, "Out buffer too small");
+
+    return _read_data(op_ctx, file_id, 0, data, file_sz, data_sz);
+}
+
+/******************************************************************************/
+static vs_status_e
+_legacy_key_load(const vs_tl_context_t *tl_ctx,
+                 vs_tl_key_handle handle,
+                 uint8_t *key,
+                 uint16_t buf_sz,
+                 uint16_t *key_sz) {
+    vs_pubkey_dated_t *element = (vs_pubkey_dated_t *)key;
+    int key_len;
+    vs_status_e ret_code;
+
+    STATUS_CHECK_RET(_legacy_load(tl_ctx, VS_TL_ELEMENT_TLC, handle, key, buf_sz, key_sz), "Error TL key load");
+    CHECK_RET(*key_sz >= sizeof(vs_pubkey_dated_t), VS_CODE_ERR_FILE_READ, "Error TL key load");
+
+    key_len = vs_secmodule_get_pubkey_len(element->pubkey.ec_type);
+
+    CHECK_RET(key_len > 0, VS_CODE_ERR_FILE_READ, "Unsupported ec_type");
+
+    // Full size of key stuff is raw key size and meta info
+    key_len += sizeof(vs_pubkey_dated_t) + VS_IOT_NTOHS(element->pubkey.meta_data_sz);
+
+    // Legacy key element can be longer than the key, only the key is returned as it was read before
+    CHECK_RET(key_len <= *key_sz, VS_CODE_ERR_FILE_READ, "Error TL key load");
+    *key_sz = key_len;
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_legacy_footer_load(const vs_tl_context_t *tl_ctx, uint8_t *footer, uint16_t buf_sz, uint16_t *footer_sz) {
+    vs_status_e ret_code;
+
+    STATUS_CHECK_RET(_legacy_load(tl_ctx, VS_TL_ELEMENT_TLF, 0, footer, buf_sz, footer_sz), "Error TL footer load");
+
+    return _footer_check(tl_ctx, footer, *footer_sz);
+}
+
+/******************************************************************************/
+static void
+_legacy_delete(const vs_tl_context_t *tl_ctx) {
+    const vs_storage_op_ctx_t *op_ctx = tl_ctx->storage_ctx;
+    vs_storage_element_id_t file_id;
+    vs_tl_header_t header;
+    uint16_t keys_count = 0;
+    uint16_t res_sz;
+    uint16_t i;
+
+    if (VS_CODE_OK == _legacy_load(tl_ctx, VS_TL_ELEMENT_TLH, 0, (uint8_t *)&header, sizeof(header), &res_sz) &&
+        sizeof(header) == res_sz) {
+        keys_count = VS_IOT_NTOHS(header.pub_keys_count);
+    }
+
+    // Header is removed last, so interrupted removal is repeated on the next start
+    // cppcheck-suppress uninitvar
+    _create_data_filename(tl_ctx->storage.storage_type, VS_TL_ELEMENT_TLF, 0, file_id);
+    op_ctx->impl_func.del(op_ctx->impl_data, file_id);
+
+    for (i = 0; i < keys_count; ++i) {
+        // cppcheck-suppress uninitvar
+        _create_data_filename(tl_ctx->storage.storage_type, VS_TL_ELEMENT_TLC, i, file_id);
+        op_ctx->impl_func.del(op_ctx->impl_data, file_id);
+    }
+
+    // cppcheck-suppress uninitvar
+    _create_data_filename(tl_ctx->storage.storage_type, VS_TL_ELEMENT_TLH, 0, file_id);
+    op_ctx->impl_func.del(op_ctx->impl_data, file_id);
+}
+
+/******************************************************************************/
+static bool
+_legacy_verify(vs_tl_context_t *tl_ctx) {
+    uint8_t buf[VS_TL_STORAGE_MAX_PART_SIZE];
+    vs_tl_footer_t *footer = (vs_tl_footer_t *)buf;
+    vs_tl_header_t host_header;
+    vs_secmodule_sw_sha256_ctx ctx;
+    uint8_t hash[VS_HASH_SHA256_LEN];
+    uint16_t header_sz;
+    uint16_t res_sz;
+    uint16_t i;
+
+    tl_ctx->ready = false;
+
+    header_sz = sizeof(vs_tl_header_t);
+    if (VS_CODE_OK != _legacy_load(tl_ctx, VS_TL_ELEMENT_TLH, 0, (uint8_t *)&tl_ctx->header, header_sz, &res_sz) ||
+        header_sz != res_sz) {
+        VS_LOG_ERROR("Error TL header load");
+        return false;
+    }
+
+    vs_tl_header_to_host(&tl_ctx->header, &host_header);
+
+    _secmodule->hash_init(&ctx);
+    _secmodule->hash_update(&ctx, (uint8_t *)&tl_ctx->header, sizeof(vs_tl_header_t));
+
+    for (i = 0; i < host_header.pub_keys_count; ++i) {
+        if (VS_CODE_OK != _legacy_key_load(tl_ctx, i, buf, sizeof(buf), &res_sz)) {
+            VS_LOG_ERROR("Error TL key %u load", i);
+            return false;
+        }
+        _secmodule->hash_update(&ctx, buf, res_sz);
+    }
+
+    if (VS_CODE_OK != _legacy_footer_load(tl_ctx, buf, sizeof(buf), &res_sz)) {
+        VS_LOG_ERROR("Wrong TL footer");
+        return false;
+    }
+
+    _secmodule->hash_update(&ctx, (uint8_t *)&footer->tl_type, sizeof(footer->tl_type));
+    _secmodule->hash_finish(&ctx, hash);
+
+    if (VS_CODE_OK != vs_provision_verify_hash_signatures(hash,
+                                                          footer->signatures,
+                                                          host_header.signatures_count,
+                                                          res_sz - sizeof(vs_tl_footer_t),
+                                                          sign_rules_list,
+                                                          VS_TL_SIGNATURES_QTY)) {
+        return false;
+    }
+
+    tl_ctx->ready = true;
+    tl_ctx->keys_qty.keys_amount = host_header.pub_keys_count;
+    tl_ctx->keys_qty.keys_count = host_header.pub_keys_count;
+
+    return true;
+}
+
+/******************************************************************************/
+static vs_status_e
+_legacy_copy(size_t storage_type, const vs_tl_context_t *src) {
+    uint8_t buf[VS_TL_STORAGE_MAX_PART_SIZE];
+    vs_tl_header_t header;
+    vs_tl_header_t host_header;
+    uint16_t res_sz;
+    uint16_t i;
+    vs_status_e ret_code;
+
+    // Read errors mean broken Trust List, while write ones mean storage that cannot keep packed Trust List
+    STATUS_CHECK_RET(_legacy_load(src, VS_TL_ELEMENT_TLH, 0, (uint8_t *)&header, sizeof(header), &res_sz),
+                     "Error TL header load");
+    CHECK_RET(sizeof(header) == res_sz, VS_CODE_ERR_FILE_READ, "Error TL header load");
+
+    vs_tl_header_to_host(&header, &host_header);
+
+    CHECK_RET(VS_CODE_OK == vs_tl_header_save(storage_type, &header), VS_CODE_ERR_FILE_WRITE, "Error TL header save");
+
+    for (i = 0; i < host_header.pub_keys_count; ++i) {
+        STATUS_CHECK_RET(_legacy_key_load(src, i, buf, sizeof(buf), &res_sz), "Error TL key %u load", i);
+        CHECK_RET(VS_CODE_OK == vs_tl_key_save(storage_type, buf, res_sz),
+                  VS_CODE_ERR_FILE_WRITE,
+                  "Error TL key %u save",
+                  i);
+    }
+
+    STATUS_CHECK_RET(_legacy_footer_load(src, buf, sizeof(buf), &res_sz), "Error TL footer load");
+    CHECK_RET(VS_CODE_OK == vs_tl_footer_save(storage_type, buf, res_sz),
+              VS_CODE_ERR_FILE_WRITE,
+              "Error TL footer save");
+
+    return VS_CODE_OK;
+}
+
+#if VS_TL_VERIFY_CACHE
+/******************************************************************************/
+static vs_status_e
+_verify_cache_key(uint8_t *key, uint16_t key_sz) {
+    static const char label[] = "Trust List verification cache";
+    vs_secmodule_keypair_type_e ec_type;
+    uint16_t pubkey_sz = vs_secmodule_get_pubkey_len(VS_KEYPAIR_EC_SECP256R1);
+    uint8_t pubkey[pubkey_sz];
+    uint8_t secret[VS_AES_256_KEY_SIZE + sizeof(label)];
+    uint16_t secret_sz;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(_secmodule->get_pubkey, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_secmodule->ecdh, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(_secmodule->kdf, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // MAC key is derived from the device private key each time, so it isn't stored anywhere
+    STATUS_CHECK_RET(_secmodule->get_pubkey(PRIVATE_KEY_SLOT, pubkey, pubkey_sz, &pubkey_sz, &ec_type),
+                     "Unable to get device public key");
+    STATUS_CHECK_RET(
+            _secmodule->ecdh(PRIVATE_KEY_SLOT, ec_type, pubkey, pubkey_sz, secret, VS_AES_256_KEY_SIZE, &secret_sz),
+            "Unable to calculate ECDH");
+
+    VS_IOT_MEMCPY(&secret[secret_sz], label, sizeof(label));
+    ret_code = _secmodule->kdf(VS_KDF_2, VS_HASH_SHA_256, secret, secret_sz + sizeof(label), key, key_sz);
+    VS_IOT_MEMSET(secret, 0, sizeof(secret));
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_verify_cache_mac(const uint8_t *key, uint16_t key_sz, const vs_tl_verify_cache_t *cache, uint8_t *mac) {
+    uint16_t mac_sz;
+
+    CHECK_NOT_ZERO_RET(_secmodule->hmac, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    return _secmodule->hmac(VS_HASH_SHA_256,
+                            key,
+                            key_sz,
+                            (const uint8_t *)cache,
+                            sizeof(vs_tl_verify_cache_t) - sizeof(cache->mac),
+                            mac,
+                            sizeof(cache->mac),
+                            &mac_sz);
+}
+
+/******************************************************************************/
+static vs_status_e
+_verify_cache_save(const vs_tl_context_t *tl_ctx, const uint8_t *key, uint16_t key_sz, vs_tl_verify_cache_t *cache) {
+    vs_storage_element_id_t file_id;
+    vs_status_e ret_code;
+
+    STATUS_CHECK_RET(_verify_cache_mac(key, key_sz, cache, cache->mac), "Unable to calculate TL verification MAC");
+
+    // cppcheck-suppress uninitvar
+    _create_data_filename(tl_ctx->storage.storage_type, VS_TL_VERIFY_CACHE_ELEMENT, 0, file_id);
+
+    return _write_data(tl_ctx->storage_ctx, file_id, 0, cache, sizeof(vs_tl_verify_cache_t));
+}
+
+/******************************************************************************/
+static void
+_verify_cache_store(vs_tl_context_t *tl_ctx) {
+    uint8_t key[VS_HASH_SHA256_LEN];
+
+    // Verification of temporary Trust List is used for its copying only
+    if (TL_STORAGE_TYPE_TMP == tl_ctx->storage.storage_type) {
+        return;
+    }
+
+    tl_ctx->verified.uses = 0;
+    if (VS_CODE_OK != _verify_cache_key(key, sizeof(key)) ||
+        VS_CODE_OK != _verify_cache_save(tl_ctx, key, sizeof(key), &tl_ctx->verified)) {
+        VS_LOG_WARNING("Unable to save TL %u verification result", tl_ctx->storage.storage_type);
+    }
+
+    VS_IOT_MEMSET(key, 0, sizeof(key));
+}
+
+/******************************************************************************/
+static bool
+_verify_cache_check(vs_tl_context_t *tl_ctx) {
+    vs_tl_verify_cache_t cache;
+    vs_storage_element_id_t file_id;
+    uint8_t key[VS_HASH_SHA256_LEN];
+    uint8_t mac[VS_HASH_SHA256_LEN];
+    uint16_t _sz;
+    bool res = false;
+
+    if (TL_STORAGE_TYPE_TMP == tl_ctx->storage.storage_type) {
+        return false;
+    }
+
+    // cppcheck-suppress uninitvar
+    _create_data_filename(tl_ctx->storage.storage_type, VS_TL_VERIFY_CACHE_ELEMENT, 0, file_id);
+    if (VS_CODE_OK != _read_data(tl_ctx->storage_ctx, file_id, 0, (uint8_t *)&cache, sizeof(cache), &_sz)) {
+        return false;
+    }
+
+    // Cache is made for the same Trust List content
+    if (0 != VS_IOT_MEMCMP(&cache, &tl_ctx->verified, sizeof(cache) - sizeof(cache.uses) - sizeof(cache.mac))) {
+        return false;
+    }
+
+#if VS_TL_VERIFY_CACHE_PERIOD
+    if (cache.uses >= VS_TL_VERIFY_CACHE_PERIOD) {
+        VS_LOG_DEBUG("TL %u full verification is required by period", tl_ctx->storage.storage_type);
+        return false;
+    }
+#endif // VS_TL_VERIFY_CACHE_PERIOD
+
+    if (VS_CODE_OK == _verify_cache_key(key, sizeof(key)) &&
+        VS_CODE_OK == _verify_cache_mac(key, sizeof(key), &cache, mac) &&
+        0 == VS_IOT_MEMCMP(mac, cache.mac, sizeof(mac))) {
+        res = true;
+        tl_ctx->verified.uses = cache.uses;
+
+#if VS_TL_VERIFY_CACHE_PERIOD
+        ++cache.uses;
+        if (VS_CODE_OK != _verify_cache_save(tl_ctx, key, sizeof(key), &cache)) {
+            VS_LOG_WARNING("Unable to save TL %u verification cache uses", tl_ctx->storage.storage_type);
+        }
+#endif // VS_TL_VERIFY_CACHE_PERIOD
+    }
+
+    VS_IOT_MEMSET(key, 0, sizeof(key));
+
+    return res;
+}
+
 /******************************************************************************/
 static bool
-_is_rule_equal_to(vs_key_type_e type) {
+_verify_cache_signers(const vs_tl_footer_t *footer, uint8_t signatures_count) {
+    const vs_sign_t *sign = (const vs_sign_t *)footer->signatures;
+    int sign_len;
+    int key_len;
     uint8_t i;
-    for (i = 0; i < VS_TL_SIGNATURES_QTY; ++i) {
-        if (sign_rules_list[i] == type) {
-            return true;
+
+    // High-level keys could be replaced after caching, so signer keys are checked each time. Footer format is checked
+    for (i = 0; i < signatures_count; ++i) {
+        sign_len = vs_secmodule_get_signature_len(sign->ec_type);
+        key_len = vs_secmodule_get_pubkey_len(sign->ec_type);
+
+        if (VS_CODE_OK != vs_provision_search_hl_pubkey(
+                                  sign->signer_type, sign->ec_type, sign->raw_sign_pubkey + sign_len, key_len)) {
+            VS_LOG_WARNING("TL signer key has been changed since verification caching");
+            return false;
         }
+
+        sign = (const vs_sign_t *)(sign->raw_sign_pubkey + sign_len + key_len);
     }
-    return false;
+
+    return true;
 }
 
+/******************************************************************************/
+static void
+_verify_cache_drop(const vs_tl_context_t *tl_ctx) {
+    vs_storage_element_id_t file_id;
+
+    // cppcheck-suppress uninitvar
+    _create_data_filename(tl_ctx->storage.storage_type, VS_TL_VERIFY_CACHE_ELEMENT, 0, file_id);
+    tl_ctx->storage_ctx->impl_func.del(tl_ctx->storage_ctx->impl_data, file_id);
+}
+#endif // VS_TL_VERIFY_CACHE
+
 /******************************************************************************/
 static bool
 _verify_tl(vs_tl_context_t *tl_ctx) {
     uint8_t buf[VS_TL_STORAGE_MAX_PART_SIZE];
-    uint16_t res_sz;
+    vs_storage_file_t f = NULL;
+    ssize_t file_sz;
+    uint32_t offsets[2];
+    uint32_t offset;
+    uint16_t part_sz = 0;
     uint16_t i;
+    int key_len;
     vs_secmodule_sw_sha256_ctx ctx;
 
-    vs_tl_footer_t *footer;
-    vs_sign_t *sign;
-    uint8_t *pubkey;
-    int sign_len;
-    int key_len;
-    uint8_t sign_rules = 0;
+    vs_tl_footer_t *footer = (vs_tl_footer_t *)buf;
+    vs_pubkey_dated_t *key = (vs_pubkey_dated_t *)buf;
     vs_tl_header_t host_header;
+    vs_status_e res = VS_CODE_ERR_VERIFY;
 
     VS_IOT_ASSERT(_secmodule);
     VS_IOT_ASSERT(_secmodule->hash_init);
@@ -174,81 +685,102 @@ _verify_tl(vs_tl_context_t *tl_ctx) {
     // TODO: Need to support all hash types
     uint8_t hash[VS_HASH_SHA256_LEN];
 
-    tl_ctx->ready = true;
-    if (VS_CODE_OK != vs_tl_header_load(tl_ctx->storage.storage_type, &(tl_ctx->header))) {
-        tl_ctx->ready = false;
+    tl_ctx->ready = false;
+
+    // Trust List which storage cannot keep packed is used in layout of previous versions
+    if (tl_ctx->legacy) {
+        return _legacy_verify(tl_ctx);
+    }
+
+    // The whole Trust List is read sequentially by one storage element opening
+    if (VS_CODE_OK != _packed_open(tl_ctx, &f, &file_sz)) {
         return false;
     }
 
+    CHECK(VS_CODE_OK == _packed_load(tl_ctx, f, file_sz, 0, &tl_ctx->header, sizeof(vs_tl_header_t)),
+          "Error TL header load");
+
     vs_tl_header_to_host(&(tl_ctx->header), &host_header);
 
-    if (host_header.tl_size > VS_TL_STORAGE_SIZE) {
-        tl_ctx->ready = false;
-        return false;
-    }
+    CHECK(host_header.tl_size <= VS_TL_STORAGE_SIZE, "TL is too big");
 
     _secmodule->hash_init(&ctx);
     _secmodule->hash_update(&ctx, (uint8_t *)&tl_ctx->header, sizeof(vs_tl_header_t));
 
-    for (i = 0; i < host_header.pub_keys_count; ++i) {
-
-        if (VS_CODE_OK != vs_tl_key_load(tl_ctx->storage.storage_type, i, buf, sizeof(buf), &res_sz)) {
-            tl_ctx->ready = false;
-            return false;
+    // Keys and footer are placed one by one after offsets table
+    offset = VS_TL_PACKED_TABLE_POS(host_header.pub_keys_count + 2);
+
+    for (i = 0; i <= host_header.pub_keys_count; ++i) {
+        CHECK(VS_CODE_OK == _packed_load(tl_ctx, f, file_sz, VS_TL_PACKED_TABLE_POS(i), offsets, sizeof(offsets)),
+              "Error TL offsets table load");
+        CHECK(VS_IOT_NTOHL(offsets[0]) == offset && VS_IOT_NTOHL(offsets[1]) > offset &&
+                      VS_IOT_NTOHL(offsets[1]) - offset <= sizeof(buf),
+              "Wrong TL offsets table");
+
+        part_sz = VS_IOT_NTOHL(offsets[1]) - offset;
+        CHECK(VS_CODE_OK == _packed_load(tl_ctx, f, file_sz, offset, buf, part_sz), "Error TL part %u load", i);
+        offset += part_sz;
+
+        if (i < host_header.pub_keys_count) {
+            key_len = vs_secmodule_get_pubkey_len(key->pubkey.ec_type);
+            CHECK(part_sz >= sizeof(vs_pubkey_dated_t) && key_len > 0 &&
+                          part_sz == sizeof(vs_pubkey_dated_t) + key_len + VS_IOT_NTOHS(key->pubkey.meta_data_sz),
+                  "Wrong TL key %u",
+                  i);
+            _secmodule->hash_update(&ctx, buf, part_sz);
         }
-        _secmodule->hash_update(&ctx, buf, res_sz);
     }
 
-    if (VS_CODE_OK != vs_tl_footer_load(tl_ctx->storage.storage_type, buf, sizeof(buf), &res_sz)) {
-        tl_ctx->ready = false;
-        return false;
-    }
+    // Footer is in buffer now
+    CHECK(VS_CODE_OK == _footer_check(tl_ctx, buf, part_sz), "Wrong TL footer");
 
-    footer = (vs_tl_footer_t *)buf;
     _secmodule->hash_update(&ctx, (uint8_t *)&footer->tl_type, sizeof(footer->tl_type));
     _secmodule->hash_finish(&ctx, hash);
 
-    // First signature
-    sign = (vs_sign_t *)footer->signatures;
-
-    BOOL_CHECK_RET(host_header.signatures_count >= VS_TL_SIGNATURES_QTY, "There are not enough signatures");
-
-    for (i = 0; i < host_header.signatures_count; ++i) {
-        BOOL_CHECK_RET(sign->hash_type == VS_HASH_SHA_256, "Unsupported hash size for sign TL");
-
-        sign_len = vs_secmodule_get_signature_len(sign->ec_type);
-        key_len = vs_secmodule_get_pubkey_len(sign->ec_type);
-
-        BOOL_CHECK_RET(sign_len > 0 && key_len > 0, "Unsupported signature ec_type");
-
-        // Signer raw key pointer
-        pubkey = sign->raw_sign_pubkey + (uint16_t)sign_len;
-
-        BOOL_CHECK_RET(VS_CODE_OK == vs_provision_search_hl_pubkey(
-                                             sign->signer_type, sign->ec_type, pubkey, (uint16_t)key_len),
-                       "Signer key is wrong");
-
-        if (_is_rule_equal_to(sign->signer_type)) {
-            BOOL_CHECK_RET(VS_CODE_OK == _secmodule->ecdsa_verify(sign->ec_type,
-                                                                  pubkey,
-                                                                  (uint16_t)key_len,
-                                                                  sign->hash_type,
-                                                                  hash,
-                                                                  sign->raw_sign_pubkey,
-                                                                  (uint16_t)sign_len),
-                           "Signature is wrong");
-            sign_rules++;
+#if VS_TL_VERIFY_CACHE
+    // Signatures aren't covered by Trust List hash, so footer hash is cached too
+    VS_IOT_MEMCPY(&tl_ctx->verified.header, &tl_ctx->header, sizeof(vs_tl_header_t));
+    VS_IOT_MEMCPY(tl_ctx->verified.tl_hash, hash, sizeof(hash));
+    _secmodule->hash_init(&ctx);
+    _secmodule->hash_update(&ctx, buf, part_sz);
+    _secmodule->hash_finish(&ctx, tl_ctx->verified.footer_hash);
+
+    if (_verify_cache_check(tl_ctx) && _verify_cache_signers(footer, host_header.signatures_count)) {
+        res = VS_CODE_OK;
+    } else {
+        res = vs_provision_verify_hash_signatures(hash,
+                                                  footer->signatures,
+                                                  host_header.signatures_count,
+                                                  part_sz - sizeof(vs_tl_footer_t),
+                                                  sign_rules_list,
+                                                  VS_TL_SIGNATURES_QTY);
+        if (VS_CODE_OK == res) {
+            _verify_cache_store(tl_ctx);
         }
-
-        // Next signature
-        sign = (vs_sign_t *)(pubkey + (uint16_t)key_len);
     }
+#else
+    res = vs_provision_verify_hash_signatures(hash,
+                                              footer->signatures,
+                                              host_header.signatures_count,
+                                              part_sz - sizeof(vs_tl_footer_t),
+                                              sign_rules_list,
+                                              VS_TL_SIGNATURES_QTY);
+#endif // VS_TL_VERIFY_CACHE
+
+    if (VS_CODE_OK == res) {
+        tl_ctx->ready = true;
+        tl_ctx->keys_qty.keys_amount = host_header.pub_keys_count;
+        tl_ctx->keys_qty.keys_count = host_header.pub_keys_count;
+        tl_ctx->data_offset = offset;
+        tl_ctx->footer_offset = offset - part_sz;
+    }
+
+terminate:
+    tl_ctx->storage_ctx->impl_func.close(tl_ctx->storage_ctx->impl_data, f);
 
-    VS_LOG_DEBUG("TL %u. Sign rules is %s",
-                 tl_ctx->storage.storage_type,
-                 sign_rules >= VS_TL_SIGNATURES_QTY ? "correct" : "wrong");
+    VS_LOG_DEBUG("TL %u. Sign rules is %s", tl_ctx->storage.storage_type, VS_CODE_OK == res ? "correct" : "wrong");
 
-    return sign_rules >= VS_TL_SIGNATURES_QTY;
+    return tl_ctx->ready;
 }
 
 /******************************************************************************/
@@ -281,45 +813,184 @@ _get_tl_ctx(size_t storage_type) {
 /******************************************************************************/
 static vs_status_e
 _copy_tl_file(vs_tl_context_t *dst, vs_tl_context_t *src) {
-    vs_tl_header_t header;
-    vs_tl_header_t host_header;
+    const vs_storage_op_ctx_t *op_ctx = dst->storage_ctx;
     uint8_t buf[VS_TL_STORAGE_MAX_PART_SIZE];
-    uint16_t res_sz;
-    uint16_t i;
+    vs_storage_file_t src_f = NULL;
+    vs_storage_file_t dst_f = NULL;
+    ssize_t file_sz;
+    uint32_t offset;
+    uint16_t part_sz;
+    vs_status_e ret_code = VS_CODE_ERR_FILE_WRITE;
 
     if (!src->ready) {
         return VS_CODE_ERR_CTX_NOT_READY;
     }
 
-    if (VS_CODE_OK != vs_tl_header_load(src->storage.storage_type, &header) ||
-        VS_CODE_OK != vs_tl_header_save(dst->storage.storage_type, &header)) {
-        dst->ready = false;
-        return VS_CODE_ERR_FILE_WRITE;
-    }
+    CHECK_NOT_ZERO_RET(op_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.save, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(op_ctx->impl_func.sync, VS_CODE_ERR_NULLPTR_ARGUMENT);
 
-    vs_tl_header_to_host(&header, &host_header);
+    vs_tl_invalidate(dst->storage.storage_type);
 
-    for (i = 0; i < host_header.pub_keys_count; ++i) {
-        if (VS_CODE_OK != vs_tl_key_load(src->storage.storage_type, i, buf, sizeof(buf), &res_sz) ||
-            VS_CODE_OK != vs_tl_key_save(dst->storage.storage_type, buf, res_sz)) {
-            dst->ready = false;
-            return VS_CODE_ERR_FILE_WRITE;
-        }
+    if (src->legacy) {
+        return _legacy_copy(dst->storage.storage_type, src);
     }
 
-    if (VS_CODE_OK != vs_tl_footer_load(src->storage.storage_type, buf, sizeof(buf), &res_sz) ||
-        VS_CODE_OK != vs_tl_footer_save(dst->storage.storage_type, buf, res_sz)) {
-        dst->ready = false;
-        return VS_CODE_ERR_FILE_WRITE;
+    // Packed Trust List is copied by sequential I/O without parsing
+    CHECK(VS_CODE_OK == _packed_open(src, &src_f, &file_sz) && VS_CODE_OK == _packed_open(dst, &dst_f, NULL),
+          "Can't open TL storage");
+
+    for (offset = 0; offset < src->data_offset; offset += part_sz) {
+        part_sz = src->data_offset - offset < sizeof(buf) ? src->data_offset - offset : sizeof(buf);
+        CHECK(VS_CODE_OK == _packed_load(src, src_f, file_sz, offset, buf, part_sz) &&
+                      VS_CODE_OK == op_ctx->impl_func.save(op_ctx->impl_data, dst_f, offset, buf, part_sz),
+              "Can't copy TL");
     }
 
+    CHECK(VS_CODE_OK == op_ctx->impl_func.sync(op_ctx->impl_data, dst_f), "Can't sync file");
+
+    VS_IOT_MEMCPY(&dst->header, &src->header, sizeof(vs_tl_header_t));
     dst->ready = true;
     dst->keys_qty.keys_amount = src->keys_qty.keys_amount;
     dst->keys_qty.keys_count = src->keys_qty.keys_count;
+    dst->data_offset = src->data_offset;
+    dst->footer_offset = src->footer_offset;
+    ret_code = VS_CODE_OK;
+
+#if VS_TL_VERIFY_CACHE
+    // Copy has the same content, so source verification result is valid for it
+    VS_IOT_MEMCPY(&dst->verified, &src->verified, sizeof(vs_tl_verify_cache_t));
+    _verify_cache_store(dst);
+#endif // VS_TL_VERIFY_CACHE
+
+terminate:
+    if (src_f) {
+        op_ctx->impl_func.close(op_ctx->impl_data, src_f);
+    }
+    if (dst_f) {
+        op_ctx->impl_func.close(op_ctx->impl_data, dst_f);
+    }
+
+    return ret_code;
+}
+
+#if VS_TL_KEY_INDEX
+/******************************************************************************/
+static void
+_key_index_free(vs_tl_key_index_t *index) {
+    VS_IOT_FREE(index->entries);
+    VS_IOT_FREE(index->keys);
+    VS_IOT_MEMSET(index, 0, sizeof(vs_tl_key_index_t));
+}
+
+/******************************************************************************/
+static vs_status_e
+_key_index_build(vs_tl_key_index_t *index) {
+    vs_tl_key_index_entry_t entry;
+    vs_tl_header_t host_header;
+    uint8_t buf[VS_TL_STORAGE_MAX_PART_SIZE];
+    vs_pubkey_dated_t *key = (vs_pubkey_dated_t *)buf;
+    uint32_t offset = 0;
+    uint16_t key_sz;
+    uint16_t i;
+    uint16_t pos;
+
+    VS_IOT_MEMSET(index, 0, sizeof(vs_tl_key_index_t));
+    CHECK_RET(_tl_dynamic_ctx.ready, VS_CODE_ERR_CTX_NOT_READY, "Trust List is not ready");
+
+    vs_tl_header_to_host(&_tl_dynamic_ctx.header, &host_header);
+    if (!host_header.pub_keys_count) {
+        return VS_CODE_OK;
+    }
+
+    // Keys size is less than Trust List one, that has been verified already
+    index->entries = VS_IOT_CALLOC(host_header.pub_keys_count, sizeof(vs_tl_key_index_entry_t));
+    index->keys = VS_IOT_MALLOC(host_header.tl_size);
+    if (!index->entries || !index->keys) {
+        _key_index_free(index);
+        return VS_CODE_ERR_NO_MEMORY;
+    }
+
+    for (i = 0; i < host_header.pub_keys_count; ++i) {
+        if (VS_CODE_OK != vs_tl_key_load(TL_STORAGE_TYPE_DYNAMIC, i, buf, sizeof(buf), &key_sz) ||
+            offset + key_sz > host_header.tl_size) {
+            _key_index_free(index);
+            return VS_CODE_ERR_FILE_READ;
+        }
+
+        VS_IOT_MEMCPY(&index->keys[offset], buf, key_sz);
+
+        entry.key_type = key->pubkey.key_type;
+        entry.ec_type = key->pubkey.ec_type;
+        entry.key_sz = key_sz;
+        entry.offset = offset;
+        entry.handle = i;
+        offset += key_sz;
+
+        // Keys are sorted by key type. Keys of the same type are in Trust List order
+        for (pos = i; pos > 0 && index->entries[pos - 1].key_type > entry.key_type; --pos) {
+            index->entries[pos] = index->entries[pos - 1];
+        }
+        index->entries[pos] = entry;
+    }
+
+    index->entries_cnt = host_header.pub_keys_count;
 
     return VS_CODE_OK;
 }
 
+/******************************************************************************/
+static void
+_key_index_update(void) {
+    vs_tl_key_index_t index;
+
+    // Previous index is replaced only by completely built one
+    if (VS_CODE_OK != _key_index_build(&index)) {
+        VS_LOG_WARNING("Unable to build Trust List keys index. Keys will be searched in storage");
+    }
+
+    _key_index_free(&_key_index);
+    _key_index = index;
+}
+#endif // VS_TL_KEY_INDEX
+
+/******************************************************************************/
+static void
+_migrate_legacy_tl(vs_tl_context_t *tl_ctx) {
+    size_t storage_type = tl_ctx->storage.storage_type;
+    vs_storage_element_id_t file_id;
+    vs_status_e ret_code;
+
+    // Previous versions stored Trust List element by element. Such Trust List is repacked on first start and
+    // removed after that. If repacking is interrupted, it is repeated on next start.
+    // cppcheck-suppress uninitvar
+    _create_data_filename(storage_type, VS_TL_ELEMENT_TLH, 0, file_id);
+    if (0 >= tl_ctx->storage_ctx->impl_func.size(tl_ctx->storage_ctx->impl_data, file_id)) {
+        return;
+    }
+
+    VS_LOG_INFO("Migrate TL %u to packed storage", storage_type);
+
+    ret_code = _legacy_copy(storage_type, tl_ctx);
+
+    if (VS_CODE_ERR_FILE_WRITE == ret_code) {
+        // Packed Trust List must fit one storage element. Otherwise partial one is dropped, and Trust List is used in
+        // previous layout until it is replaced by new one
+        VS_LOG_WARNING("Unable to pack TL %u. Previous storage layout is used", storage_type);
+        vs_tl_invalidate(storage_type);
+        tl_ctx->legacy = true;
+        return;
+    }
+
+    if (VS_CODE_OK != ret_code) {
+        // Broken Trust List cannot be used anyway, so it is removed to avoid migration on each start
+        vs_tl_invalidate(storage_type);
+    }
+
+    // Packed Trust List has the same content, so it is verified instead of the previous one
+    _legacy_delete(tl_ctx);
+}
+
 /******************************************************************************/
 vs_status_e
 vs_tl_verify_storage(size_t storage_type) {
@@ -348,14 +1019,25 @@ vs_tl_storage_init_internal(vs_storage_op_ctx_t *op_ctx, vs_secmodule_impl_t *se
     _init_tl_ctx(TL_STORAGE_TYPE_STATIC, op_ctx, &_tl_static_ctx);
     _init_tl_ctx(TL_STORAGE_TYPE_TMP, op_ctx, &_tl_tmp_ctx);
 
+    _migrate_legacy_tl(&_tl_dynamic_ctx);
+    _migrate_legacy_tl(&_tl_static_ctx);
+
     if (_verify_tl(&_tl_dynamic_ctx)) {
+#if VS_TL_KEY_INDEX
+        _key_index_update();
+#endif // VS_TL_KEY_INDEX
         return VS_CODE_OK;
     }
 
     if (_verify_tl(&_tl_static_ctx)) {
         vs_status_e ret_code = _copy_tl_file(&_tl_dynamic_ctx, &_tl_static_ctx);
         if (VS_CODE_OK == ret_code) {
-            return _verify_tl(&_tl_dynamic_ctx) ? VS_CODE_OK : VS_CODE_ERR_VERIFY;
+            if (!_verify_tl(&_tl_dynamic_ctx)) {
+                return VS_CODE_ERR_VERIFY;
+            }
+#if VS_TL_KEY_INDEX
+            _key_index_update();
+#endif // VS_TL_KEY_INDEX
         }
         return ret_code;
     }
@@ -376,6 +1058,9 @@ vs_tl_storage_deinit_internal() {
     VS_IOT_MEMSET(&_tl_dynamic_ctx, 0, sizeof(vs_tl_context_t));
     VS_IOT_MEMSET(&_tl_static_ctx, 0, sizeof(vs_tl_context_t));
     VS_IOT_MEMSET(&_tl_tmp_ctx, 0, sizeof(vs_tl_context_t));
+#if VS_TL_KEY_INDEX
+    _key_index_free(&_key_index);
+#endif // VS_TL_KEY_INDEX
 
     return op_ctx->impl_func.deinit(op_ctx->impl_data);
 }
@@ -401,13 +1086,36 @@ vs_tl_header_save(size_t storage_type, const vs_tl_header_t *header) {
     tl_ctx->keys_qty.keys_count = 0;
     tl_ctx->keys_qty.keys_amount = host_header.pub_keys_count;
 
+    // New Trust List replaces the one in previous layout too
+    if (tl_ctx->legacy) {
+        _legacy_delete(tl_ctx);
+        tl_ctx->legacy = false;
+    }
+
+#if VS_TL_KEY_INDEX
+    if (TL_STORAGE_TYPE_DYNAMIC == storage_type) {
+        _key_index_free(&_key_index);
+    }
+#endif // VS_TL_KEY_INDEX
+
+    CHECK_NOT_ZERO_RET(tl_ctx->storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(tl_ctx->storage_ctx->impl_func.del, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    // New Trust List replaces the whole storage element
     // cppcheck-suppress uninitvar
-    _create_data_filename(storage_type, VS_TL_ELEMENT_TLH, 0, file_id);
+    _create_data_filename(storage_type, VS_TL_PACKED_ELEMENT, 0, file_id);
+    tl_ctx->storage_ctx->impl_func.del(tl_ctx->storage_ctx->impl_data, file_id);
+
+#if VS_TL_VERIFY_CACHE
+    _verify_cache_drop(tl_ctx);
+#endif // VS_TL_VERIFY_CACHE
+
     CHECK_RET(VS_CODE_OK == _write_data(tl_ctx->storage_ctx, file_id, 0, (uint8_t *)header, sizeof(vs_tl_header_t)),
               VS_CODE_ERR_FILE_WRITE,
               "Error TL header save");
 
     VS_IOT_MEMCPY(&tl_ctx->header, header, sizeof(vs_tl_header_t));
+    tl_ctx->data_offset = VS_TL_PACKED_TABLE_POS(host_header.pub_keys_count + 2);
     return VS_CODE_OK;
 }
 
@@ -422,7 +1130,7 @@ vs_tl_header_load(size_t storage_type, vs_tl_header_t *header) {
     CHECK_RET(tl_ctx->ready, VS_CODE_ERR_NULLPTR_ARGUMENT, "TL Storage is not ready");
 
     // cppcheck-suppress uninitvar
-    _create_data_filename(storage_type, VS_TL_ELEMENT_TLH, 0, file_id);
+    _create_data_filename(storage_type, tl_ctx->legacy ? VS_TL_ELEMENT_TLH : VS_TL_PACKED_ELEMENT, 0, file_id);
     CHECK_RET(VS_CODE_OK ==
                       _read_data(tl_ctx->storage_ctx, file_id, 0, (uint8_t *)header, sizeof(vs_tl_header_t), &_sz),
               VS_CODE_ERR_FILE_READ,
@@ -436,7 +1144,6 @@ vs_tl_header_load(size_t storage_type, vs_tl_header_t *header) {
 vs_status_e
 vs_tl_footer_save(size_t storage_type, const uint8_t *footer, uint16_t footer_sz) {
     vs_tl_context_t *tl_ctx = _get_tl_ctx(storage_type);
-    vs_storage_element_id_t file_id;
 
     CHECK_RET(NULL != tl_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT, "Invalid storage type");
     CHECK_RET(tl_ctx->keys_qty.keys_amount == tl_ctx->keys_qty.keys_count,
@@ -444,12 +1151,12 @@ vs_tl_footer_save(size_t storage_type, const uint8_t *footer, uint16_t footer_sz
               "Keys amount is not equal");
     CHECK_RET(footer_sz <= tl_ctx->storage_ctx->file_sz_limit, VS_CODE_ERR_INCORRECT_PARAMETER, "Incorrect key size");
 
-    // cppcheck-suppress uninitvar
-    _create_data_filename(storage_type, VS_TL_ELEMENT_TLF, 0, file_id);
-    CHECK_RET(VS_CODE_OK == _write_data(tl_ctx->storage_ctx, file_id, 0, footer, footer_sz),
+    CHECK_RET(VS_CODE_OK == _packed_append(tl_ctx, tl_ctx->keys_qty.keys_count, footer, footer_sz),
               VS_CODE_ERR_FILE_WRITE,
               "Error TL footer save");
 
+    tl_ctx->footer_offset = tl_ctx->data_offset - footer_sz;
+
     return VS_CODE_OK;
 }
 
@@ -457,56 +1164,25 @@ vs_tl_footer_save(size_t storage_type, const uint8_t *footer, uint16_t footer_sz
 vs_status_e
 vs_tl_footer_load(size_t storage_type, uint8_t *footer, uint16_t buf_sz, uint16_t *footer_sz) {
     vs_tl_context_t *tl_ctx = _get_tl_ctx(storage_type);
-    uint8_t buf[VS_TL_STORAGE_MAX_PART_SIZE];
-    vs_storage_element_id_t file_id;
-
-    // Pointer to first signature
-    vs_sign_t *element = (vs_sign_t *)(buf + sizeof(vs_tl_footer_t));
-
-    // Start determination of footer size
-    uint16_t _sz = sizeof(vs_tl_footer_t);
-    uint16_t read_sz;
-    int sign_len;
-    int key_len;
-    uint8_t i;
+    uint32_t _sz;
+    vs_status_e ret_code;
 
     CHECK_RET(NULL != tl_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT, "Invalid storage type");
     CHECK_RET(NULL != footer && NULL != footer_sz, VS_CODE_ERR_NULLPTR_ARGUMENT, "Invalid args");
     CHECK_RET(tl_ctx->ready, VS_CODE_ERR_NULLPTR_ARGUMENT, "TL Storage is not ready");
 
-    // cppcheck-suppress uninitvar
-    _create_data_filename(storage_type, VS_TL_ELEMENT_TLF, 0, file_id);
-
-    for (i = 0; i < tl_ctx->header.signatures_count; ++i) {
-
-        // Add meta info size of current signature
-        _sz += sizeof(vs_sign_t);
-
-        CHECK_RET(VS_CODE_OK == _read_data(tl_ctx->storage_ctx, file_id, 0, buf, _sz, &read_sz),
-                  VS_CODE_ERR_FILE_READ,
-                  "Error TL footer load");
-
-        sign_len = vs_secmodule_get_signature_len(element->ec_type);
-        key_len = vs_secmodule_get_pubkey_len(element->ec_type);
-
-        CHECK_RET(sign_len > 0 && key_len > 0, VS_CODE_ERR_FILE_READ, "Unsupported signature ec_type");
-
-        // add the rest of vs_sign_t structure
-        _sz += key_len + sign_len;
-
-        // Pointer to the next signature
-        element = (vs_sign_t *)((uint8_t *)element + sizeof(vs_sign_t) + key_len + sign_len);
+    if (tl_ctx->legacy) {
+        return _legacy_footer_load(tl_ctx, footer, buf_sz, footer_sz);
     }
 
-    CHECK_RET(buf_sz >= _sz, VS_CODE_ERR_TOO_SMALL_BUFFER, "Out buffer too small");
-
-    CHECK_RET(VS_CODE_OK == _read_data(tl_ctx->storage_ctx, file_id, 0, footer, _sz, &read_sz),
-              VS_CODE_ERR_FILE_READ,
-              "Error TL footer load");
+    // Footer position is known since Trust List verification, so footer is loaded by one read
+    _sz = tl_ctx->data_offset - tl_ctx->footer_offset;
+    CHECK_RET(_sz <= buf_sz, VS_CODE_ERR_TOO_SMALL_BUFFER, "Out buffer too small");
 
+    STATUS_CHECK_RET(_packed_load_range(tl_ctx, tl_ctx->footer_offset, footer, _sz), "Error TL footer load");
     *footer_sz = _sz;
 
-    return VS_CODE_OK;
+    return _footer_check(tl_ctx, footer, *footer_sz);
 }
 
 /******************************************************************************/
@@ -515,7 +1191,6 @@ vs_tl_key_save(size_t storage_type, const uint8_t *key, uint16_t key_sz) {
     vs_pubkey_dated_t *element = (vs_pubkey_dated_t *)key;
     int key_len = vs_secmodule_get_pubkey_len(element->pubkey.ec_type);
     vs_tl_context_t *tl_ctx = _get_tl_ctx(storage_type);
-    vs_storage_element_id_t file_id;
 
     CHECK_RET(NULL != tl_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT, "Invalid storage type");
     CHECK_RET(key_len > 0, VS_CODE_ERR_INCORRECT_PARAMETER, "Unsupported ec_type");
@@ -532,9 +1207,7 @@ vs_tl_key_save(size_t storage_type, const uint8_t *key, uint16_t key_sz) {
         return VS_CODE_ERR_FILE_WRITE;
     }
 
-    // cppcheck-suppress uninitvar
-    _create_data_filename(storage_type, VS_TL_ELEMENT_TLC, tl_ctx->keys_qty.keys_count, file_id);
-    if (VS_CODE_OK != _write_data(tl_ctx->storage_ctx, file_id, 0, key, key_sz)) {
+    if (VS_CODE_OK != _packed_append(tl_ctx, tl_ctx->keys_qty.keys_count, key, key_sz)) {
         return VS_CODE_ERR_FILE_WRITE;
     }
 
@@ -545,40 +1218,33 @@ vs_tl_key_save(size_t storage_type, const uint8_t *key, uint16_t key_sz) {
 /******************************************************************************/
 vs_status_e
 vs_tl_key_load(size_t storage_type, vs_tl_key_handle handle, uint8_t *key, uint16_t buf_sz, uint16_t *key_sz) {
+    vs_status_e ret_code;
     int key_len;
     vs_tl_context_t *tl_ctx = _get_tl_ctx(storage_type);
-    vs_pubkey_dated_t element;
-    vs_storage_element_id_t file_id;
-    uint16_t _sz;
+    vs_pubkey_dated_t *element = (vs_pubkey_dated_t *)key;
 
     CHECK_RET(NULL != tl_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT, "Invalid storage type");
     CHECK_RET(NULL != key && NULL != key_sz, VS_CODE_ERR_NULLPTR_ARGUMENT, "Invalid args");
 
     CHECK_RET(tl_ctx->ready, VS_CODE_ERR_NULLPTR_ARGUMENT, "TL Storage is not ready");
+    CHECK_RET(handle < VS_IOT_NTOHS(tl_ctx->header.pub_keys_count), VS_CODE_ERR_FILE_READ, "Wrong TL key handle");
 
-    // cppcheck-suppress uninitvar
-    _create_data_filename(storage_type, VS_TL_ELEMENT_TLC, handle, file_id);
+    if (tl_ctx->legacy) {
+        return _legacy_key_load(tl_ctx, handle, key, buf_sz, key_sz);
+    }
 
-    // First, we need to load a meta info of required key to determine a full size
-    CHECK_RET(VS_CODE_OK ==
-                      _read_data(tl_ctx->storage_ctx, file_id, 0, (uint8_t *)&element, sizeof(vs_pubkey_dated_t), &_sz),
-              VS_CODE_ERR_FILE_READ,
-              "Error TL key load");
+    STATUS_CHECK_RET(_packed_load_part(tl_ctx, handle, key, buf_sz, key_sz), "Error TL key load");
+
+    CHECK_RET(*key_sz >= sizeof(vs_pubkey_dated_t), VS_CODE_ERR_FILE_READ, "Error TL key load");
 
-    key_len = vs_secmodule_get_pubkey_len(element.pubkey.ec_type);
+    key_len = vs_secmodule_get_pubkey_len(element->pubkey.ec_type);
 
     CHECK_RET(key_len > 0, VS_CODE_ERR_FILE_READ, "Unsupported ec_type");
 
     // Full size of key stuff is raw key size and meta info
-    key_len += sizeof(vs_pubkey_dated_t) + VS_IOT_NTOHS(element.pubkey.meta_data_sz);
-
-    CHECK_RET(key_len <= buf_sz, VS_CODE_ERR_TOO_SMALL_BUFFER, "Out buffer too small");
-
-    CHECK_RET(VS_CODE_OK == _read_data(tl_ctx->storage_ctx, file_id, 0, key, key_len, &_sz),
-              VS_CODE_ERR_FILE_READ,
-              "Error TL key load");
+    key_len += sizeof(vs_pubkey_dated_t) + VS_IOT_NTOHS(element->pubkey.meta_data_sz);
 
-    *key_sz = key_len;
+    CHECK_RET(key_len == *key_sz, VS_CODE_ERR_FILE_READ, "Error TL key load");
 
     return VS_CODE_OK;
 }
@@ -586,43 +1252,38 @@ vs_tl_key_load(size_t storage_type, vs_tl_key_handle handle, uint8_t *key, uint1
 /******************************************************************************/
 vs_status_e
 vs_tl_invalidate(size_t storage_type) {
-    vs_tl_header_t header;
-
     vs_tl_context_t *tl_ctx = _get_tl_ctx(storage_type);
     vs_storage_element_id_t file_id;
-    uint16_t i;
 
     CHECK_RET(NULL != tl_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT, "Invalid storage type");
     CHECK_NOT_ZERO_RET(tl_ctx->storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(tl_ctx->storage_ctx->impl_func.del, VS_CODE_ERR_NULLPTR_ARGUMENT);
 
+    tl_ctx->ready = false;
     tl_ctx->keys_qty.keys_count = 0;
     tl_ctx->keys_qty.keys_amount = 0;
+    tl_ctx->data_offset = 0;
+    tl_ctx->footer_offset = 0;
 
-    // cppcheck-suppress uninitvar
-    _create_data_filename(storage_type, VS_TL_ELEMENT_TLH, 0, file_id);
-
-    if (!tl_ctx->ready || VS_CODE_OK != vs_tl_header_load(storage_type, &header) ||
-        (VS_CODE_OK != tl_ctx->storage_ctx->impl_func.del(tl_ctx->storage_ctx->impl_data, file_id))) {
-        return VS_CODE_OK;
+#if VS_TL_KEY_INDEX
+    if (TL_STORAGE_TYPE_DYNAMIC == storage_type) {
+        _key_index_free(&_key_index);
     }
-
-    tl_ctx->ready = false;
+#endif // VS_TL_KEY_INDEX
 
     // cppcheck-suppress uninitvar
-    _create_data_filename(storage_type, VS_TL_ELEMENT_TLF, 0, file_id);
-    if (VS_CODE_OK != tl_ctx->storage_ctx->impl_func.del(tl_ctx->storage_ctx->impl_data, file_id)) {
-        return VS_CODE_OK;
-    }
+    _create_data_filename(storage_type, VS_TL_PACKED_ELEMENT, 0, file_id);
+    tl_ctx->storage_ctx->impl_func.del(tl_ctx->storage_ctx->impl_data, file_id);
 
-    for (i = 0; i < VS_IOT_NTOHS(header.pub_keys_count); ++i) {
-        // cppcheck-suppress uninitvar
-        _create_data_filename(storage_type, VS_TL_ELEMENT_TLC, i, file_id);
-        if (VS_CODE_OK != tl_ctx->storage_ctx->impl_func.del(tl_ctx->storage_ctx->impl_data, file_id)) {
-            return VS_CODE_OK;
-        }
+    if (tl_ctx->legacy) {
+        _legacy_delete(tl_ctx);
+        tl_ctx->legacy = false;
     }
 
+#if VS_TL_VERIFY_CACHE
+    _verify_cache_drop(tl_ctx);
+#endif // VS_TL_VERIFY_CACHE
+
     return VS_CODE_OK;
 }
 
@@ -638,10 +1299,202 @@ vs_tl_apply_tmp_to(size_t storage_type) {
             return VS_CODE_ERR_VERIFY;
         }
 
+#if VS_TL_KEY_INDEX
+        vs_status_e ret_code = _copy_tl_file(tl_ctx, &_tl_tmp_ctx);
+        if (VS_CODE_OK == ret_code && TL_STORAGE_TYPE_DYNAMIC == storage_type) {
+            _key_index_update();
+        }
+        return ret_code;
+#else
         return _copy_tl_file(tl_ctx, &_tl_tmp_ctx);
+#endif // VS_TL_KEY_INDEX
     }
 
     return VS_CODE_ERR_FILE;
 }
 
+/******************************************************************************/
+static vs_status_e
+_delta_op_size(const uint8_t *op, size_t avail, uint16_t *op_sz) {
+    const vs_pubkey_dated_t *element = (const vs_pubkey_dated_t *)(op + 1);
+    size_t key_len;
+    int pubkey_len;
+
+    CHECK_RET(avail >= 1 + sizeof(vs_pubkey_dated_t), VS_CODE_ERR_INCORRECT_ARGUMENT, "TL delta is truncated");
+    CHECK_RET(VS_TL_DELTA_OP_REMOVE == op[0] || VS_TL_DELTA_OP_ADD == op[0],
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Unknown TL delta operation %d",
+              op[0]);
+
+    pubkey_len = vs_secmodule_get_pubkey_len(element->pubkey.ec_type);
+    CHECK_RET(pubkey_len > 0, VS_CODE_ERR_INCORRECT_ARGUMENT, "Unsupported ec_type");
+
+    key_len = sizeof(vs_pubkey_dated_t) + pubkey_len + VS_IOT_NTOHS(element->pubkey.meta_data_sz);
+    CHECK_RET(key_len <= VS_TL_STORAGE_MAX_PART_SIZE && 1 + key_len <= avail,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "TL delta is truncated");
+
+    *op_sz = 1 + key_len;
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+vs_status_e
+vs_tl_delta_apply_to_tmp(const uint8_t *delta, size_t delta_sz) {
+    const vs_tl_delta_header_t *delta_header = (const vs_tl_delta_header_t *)delta;
+    const uint8_t *ops = delta + sizeof(vs_tl_delta_header_t);
+    const uint8_t *cur;
+    const uint8_t *end = delta + delta_sz;
+    vs_tl_header_t base_header;
+    vs_tl_header_t target_header;
+    uint8_t buf[VS_TL_STORAGE_MAX_PART_SIZE];
+    uint16_t ops_count;
+    uint16_t removes = 0;
+    uint16_t removed = 0;
+    uint16_t adds = 0;
+    uint16_t op_sz;
+    uint16_t key_sz;
+    uint16_t i;
+    uint16_t j;
+    bool is_removed;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(delta, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(delta_sz >= sizeof(vs_tl_delta_header_t), VS_CODE_ERR_INCORRECT_ARGUMENT, "TL delta is too small");
+    CHECK_RET(_tl_dynamic_ctx.ready, VS_CODE_ERR_CTX_NOT_READY, "There is no base Trust List for delta");
+
+    STATUS_CHECK_RET(vs_tl_header_load(TL_STORAGE_TYPE_DYNAMIC, &base_header), "Unable to load base TL header");
+    CHECK_RET(0 == VS_IOT_MEMCMP(&base_header.version, &delta_header->base_version, sizeof(vs_file_version_t)),
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "TL delta is made for another Trust List version");
+
+    vs_tl_header_to_host(&base_header, &base_header);
+    vs_tl_header_to_host(&delta_header->target_header, &target_header);
+    ops_count = VS_IOT_NTOHS(delta_header->ops_count);
+
+    // Validate operations before any storage changes
+    cur = ops;
+    for (i = 0; i < ops_count; ++i) {
+        STATUS_CHECK_RET(_delta_op_size(cur, end - cur, &op_sz), "Wrong TL delta operation %u", i);
+        if (VS_TL_DELTA_OP_REMOVE == cur[0]) {
+            ++removes;
+        } else {
+            ++adds;
+        }
+        cur += op_sz;
+    }
+
+    CHECK_RET((size_t)(end - cur) >= sizeof(vs_tl_footer_t) && (size_t)(end - cur) <= VS_TL_STORAGE_MAX_PART_SIZE,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Wrong TL delta footer size");
+    CHECK_RET(removes <= base_header.pub_keys_count &&
+                      base_header.pub_keys_count - removes + adds == target_header.pub_keys_count,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "TL delta keys amount mismatch");
+
+    // Build result Trust List in TMP storage. Base one stays untouched until result is verified
+    vs_tl_invalidate(TL_STORAGE_TYPE_TMP);
+    STATUS_CHECK_RET(vs_tl_header_save(TL_STORAGE_TYPE_TMP, &delta_header->target_header),
+                     "Unable to save TL delta header");
+
+    for (i = 0; i < base_header.pub_keys_count; ++i) {
+        STATUS_CHECK_RET(vs_tl_key_load(TL_STORAGE_TYPE_DYNAMIC, i, buf, sizeof(buf), &key_sz),
+                         "Unable to load base TL key %u",
+                         i);
+
+        is_removed = false;
+        cur = ops;
+        for (j = 0; j < ops_count && !is_removed; ++j) {
+            _delta_op_size(cur, end - cur, &op_sz);
+            is_removed = VS_TL_DELTA_OP_REMOVE == cur[0] && op_sz - 1 == key_sz &&
+                         0 == VS_IOT_MEMCMP(cur + 1, buf, key_sz);
+            cur += op_sz;
+        }
+
+        if (is_removed) {
+            ++removed;
+        } else {
+            STATUS_CHECK_RET(vs_tl_key_save(TL_STORAGE_TYPE_TMP, buf, key_sz), "Unable to save TL key %u", i);
+        }
+    }
+
+    CHECK_RET(removed == removes, VS_CODE_ERR_INCORRECT_ARGUMENT, "TL delta removes absent keys");
+
+    cur = ops;
+    for (j = 0; j < ops_count; ++j) {
+        _delta_op_size(cur, end - cur, &op_sz);
+        if (VS_TL_DELTA_OP_ADD == cur[0]) {
+            STATUS_CHECK_RET(vs_tl_key_save(TL_STORAGE_TYPE_TMP, cur + 1, op_sz - 1), "Unable to save TL delta key");
+        }
+        cur += op_sz;
+    }
+
+    return vs_tl_footer_save(TL_STORAGE_TYPE_TMP, cur, end - cur);
+}
+
+/******************************************************************************/
+vs_status_e
+vs_tl_key_search(vs_key_type_e key_type,
+                 vs_secmodule_keypair_type_e ec_type,
+                 vs_tl_key_handle *handle,
+                 uint8_t *key,
+                 uint16_t buf_sz,
+                 uint16_t *key_sz) {
+    vs_pubkey_dated_t *element = (vs_pubkey_dated_t *)key;
+    vs_tl_key_handle i;
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(handle, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(key, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_NOT_ZERO_RET(key_sz, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+#if VS_TL_KEY_INDEX
+    if (_key_index.entries) {
+        const vs_tl_key_index_entry_t *entry;
+        size_t first = 0;
+        size_t last = _key_index.entries_cnt;
+        size_t mid;
+
+        // Find the first key of required type that is not before handle
+        while (first < last) {
+            mid = first + (last - first) / 2;
+            entry = &_key_index.entries[mid];
+            if (entry->key_type < key_type || (entry->key_type == key_type && entry->handle < *handle)) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+
+        for (; first < _key_index.entries_cnt && _key_index.entries[first].key_type == key_type; ++first) {
+            entry = &_key_index.entries[first];
+            if (VS_KEYPAIR_INVALID != ec_type && entry->ec_type != ec_type) {
+                continue;
+            }
+
+            CHECK_RET(entry->key_sz <= buf_sz, VS_CODE_ERR_TOO_SMALL_BUFFER, "Out buffer too small");
+            VS_IOT_MEMCPY(key, &_key_index.keys[entry->offset], entry->key_sz);
+            *key_sz = entry->key_sz;
+            *handle = entry->handle;
+            return VS_CODE_OK;
+        }
+
+        return VS_CODE_ERR_NOT_FOUND;
+    }
+#endif // VS_TL_KEY_INDEX
+
+    CHECK_RET(_tl_dynamic_ctx.ready, VS_CODE_ERR_CTX_NOT_READY, "Trust List is not ready");
+
+    for (i = *handle; i < VS_IOT_NTOHS(_tl_dynamic_ctx.header.pub_keys_count); ++i) {
+        STATUS_CHECK_RET(vs_tl_key_load(TL_STORAGE_TYPE_DYNAMIC, i, key, buf_sz, key_sz), "Unable to load TL key");
+        if (element->pubkey.key_type == key_type &&
+            (VS_KEYPAIR_INVALID == ec_type || element->pubkey.ec_type == ec_type)) {
+            *handle = i;
+            return VS_CODE_OK;
+        }
+    }
+
+    return VS_CODE_ERR_NOT_FOUND;
+}
+
 /******************************************************************************/
\ No newline at end of file
@@ -138,6 +138,31 @@ vs_tl_save_part(vs_tl_element_info_t *element_info, const uint8_t *in_data, uint
     return ret_code;
 }
 
+/******************************************************************************/
+vs_status_e
+vs_tl_apply_delta(const uint8_t *delta, size_t delta_sz) {
+    vs_status_e ret_code;
+
+    CHECK_NOT_ZERO_RET(delta, VS_CODE_ERR_NULLPTR_ARGUMENT);
+
+    ret_code = vs_tl_delta_apply_to_tmp(delta, delta_sz);
+
+    if (VS_CODE_OK == ret_code) {
+        ret_code = vs_tl_apply_tmp_to(TL_STORAGE_TYPE_DYNAMIC);
+        if (VS_CODE_OK == ret_code && VS_CODE_OK != vs_tl_verify_storage(TL_STORAGE_TYPE_STATIC)) {
+            ret_code = vs_tl_apply_tmp_to(TL_STORAGE_TYPE_STATIC);
+        }
+    }
+
+    vs_tl_invalidate(TL_STORAGE_TYPE_TMP);
+
+    if (VS_CODE_OK == ret_code) {
+        STATUS_CHECK_RET(vs_tl_update_info_server(), "Unable to update current Trust List file version");
+    }
+
+    return ret_code;
+}
+
 /******************************************************************************/
 vs_status_e
 vs_tl_load_part(vs_tl_element_info_t *element_info, uint8_t *out_data, uint16_t buf_sz, uint16_t *out_sz) {
@@ -173,6 +198,17 @@ vs_tl_load_part(vs_tl_element_info_t *element_info, uint8_t *out_data, uint16_t
     return res;
 }
 
+/******************************************************************************/
+vs_status_e
+vs_tl_find_key(vs_key_type_e key_type,
+               vs_secmodule_keypair_type_e ec_type,
+               vs_tl_key_handle *handle,
+               uint8_t *key,
+               uint16_t buf_sz,
+               uint16_t *key_sz) {
+    return vs_tl_key_search(key_type, ec_type, handle, key, buf_sz, key_sz);
+}
+
 /******************************************************************************/
 void
 vs_tl_header_to_host(const vs_tl_header_t *src_data, vs_tl_header_t *dst_data) {
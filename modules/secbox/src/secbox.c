@@ -14,16 +14,35 @@ static vs_secmodule_impl_t *_secmodule = NULL;
 
 /******************************************************************************/
 static vs_status_e
-_secbox_verify_signature(vs_storage_file_t f, uint8_t data_type, uint8_t *data, size_t data_sz) {
+_secbox_load_signed_data(vs_storage_file_t f, uint8_t *data, size_t data_sz, uint8_t *sign, uint16_t sign_sz) {
+    vs_status_e ret_code;
+
+    // Data and signature are stored one after another
+    if (_storage_ctx->impl_func.load_v) {
+        vs_storage_buf_t bufs[] = {{data, data_sz}, {sign, sign_sz}};
+        return _storage_ctx->impl_func.load_v(_storage_ctx->impl_data, f, 1, bufs, sizeof(bufs) / sizeof(bufs[0]));
+    }
+
+    STATUS_CHECK_RET(_storage_ctx->impl_func.load(_storage_ctx->impl_data, f, 1, data, data_sz),
+                     "Can't load data from file");
+
+    ret_code = _storage_ctx->impl_func.load(_storage_ctx->impl_data, f, data_sz + 1, sign, sign_sz);
+    if (VS_CODE_OK != ret_code) {
+        VS_LOG_ERROR("Can't load signature from file");
+    }
+
+    return ret_code;
+}
+
+/******************************************************************************/
+static vs_status_e
+_secbox_verify_signature(uint8_t data_type, uint8_t *data, size_t data_sz, uint8_t *sign, uint16_t sign_sz) {
     vs_status_e ret_code;
     uint16_t hash_len = (uint16_t)vs_secmodule_get_hash_len(VS_HASH_SHA_256);
     uint8_t hash[hash_len];
 
     VS_IOT_ASSERT(_secmodule);
 
-    uint16_t sign_sz = (uint16_t)vs_secmodule_get_signature_len(VS_KEYPAIR_EC_SECP256R1);
-    uint8_t sign[sign_sz];
-
     vs_secmodule_keypair_type_e pubkey_type;
     uint16_t pubkey_sz = (uint16_t)vs_secmodule_get_pubkey_len(VS_KEYPAIR_EC_SECP256R1);
     uint8_t pubkey[pubkey_sz];
@@ -35,13 +54,6 @@ _secbox_verify_signature(vs_storage_file_t f, uint8_t data_type, uint8_t *data,
     _secmodule->hash_update(&hash_ctx, data, data_sz);
     _secmodule->hash_finish(&hash_ctx, hash);
 
-    ret_code = _storage_ctx->impl_func.load(_storage_ctx->impl_data, f, data_sz + 1, sign, sign_sz);
-    if (VS_CODE_OK != ret_code) {
-        VS_LOG_ERROR("Can't load signature from file");
-        _storage_ctx->impl_func.close(_storage_ctx->impl_data, f);
-        return ret_code;
-    }
-
     STATUS_CHECK_RET(_secmodule->get_pubkey(PRIVATE_KEY_SLOT, pubkey, sizeof(pubkey), &pubkey_sz, &pubkey_type),
                      "Unable to get public key");
     STATUS_CHECK_RET(_secmodule->ecdsa_verify(pubkey_type, pubkey, pubkey_sz, VS_HASH_SHA_256, hash, sign, sign_sz),
@@ -208,13 +220,22 @@ vs_secbox_save(vs_secbox_type_t type, vs_storage_element_id_t id, const uint8_t
 
     CHECK(f = _storage_ctx->impl_func.open(_storage_ctx->impl_data, id), "Cannot open file");
 
-    // Save data type to file
-    STATUS_CHECK(res = _storage_ctx->impl_func.save(_storage_ctx->impl_data, f, 0, &u8_type, 1),
-                 "Can't save type to file");
-    STATUS_CHECK(res = _storage_ctx->impl_func.save(_storage_ctx->impl_data, f, 1, data_to_save, data_to_save_sz),
-                 "Can't save data to file");
-    STATUS_CHECK(res = _storage_ctx->impl_func.save(_storage_ctx->impl_data, f, data_to_save_sz + 1, sign, sign_sz),
-                 "Can't save sign to file");
+    // Save data type, data and signature to file
+    if (_storage_ctx->impl_func.save_v) {
+        vs_storage_buf_t bufs[] = {{&u8_type, 1}, {data_to_save, data_to_save_sz}, {sign, sign_sz}};
+        STATUS_CHECK(res = _storage_ctx->impl_func.save_v(
+                             _storage_ctx->impl_data, f, 0, bufs, sizeof(bufs) / sizeof(bufs[0])),
+                     "Can't save secbox file");
+    } else {
+        STATUS_CHECK(res = _storage_ctx->impl_func.save(_storage_ctx->impl_data, f, 0, &u8_type, 1),
+                     "Can't save type to file");
+        STATUS_CHECK(res = _storage_ctx->impl_func.save(
+                             _storage_ctx->impl_data, f, 1, data_to_save, data_to_save_sz),
+                     "Can't save data to file");
+        STATUS_CHECK(res = _storage_ctx->impl_func.save(
+                             _storage_ctx->impl_data, f, data_to_save_sz + 1, sign, sign_sz),
+                     "Can't save sign to file");
+    }
 
     STATUS_CHECK(res = _storage_ctx->impl_func.sync(_storage_ctx->impl_data, f), "Can't sync secbox file");
 
@@ -240,6 +261,7 @@ vs_secbox_load(vs_storage_element_id_t id, uint8_t *data, size_t data_sz) {
     size_t data_load_sz;
 
     uint16_t sign_sz = (uint16_t)vs_secmodule_get_signature_len(VS_KEYPAIR_EC_SECP256R1);
+    uint8_t sign[sign_sz];
 
     CHECK_NOT_ZERO_RET(_secmodule, VS_CODE_ERR_NULLPTR_ARGUMENT);
     CHECK_NOT_ZERO_RET(_storage_ctx, VS_CODE_ERR_NULLPTR_ARGUMENT);
@@ -269,9 +291,9 @@ vs_secbox_load(vs_storage_element_id_t id, uint8_t *data, size_t data_sz) {
         }
 
         res = VS_CODE_ERR_FILE_WRITE;
-        STATUS_CHECK(_storage_ctx->impl_func.load(_storage_ctx->impl_data, f, 1, data_load, data_load_sz),
-                     "Can't load data from file");
-        STATUS_CHECK(_secbox_verify_signature(f, type, data_load, data_load_sz), "Can't verify signature");
+        STATUS_CHECK(_secbox_load_signed_data(f, data_load, data_load_sz, sign, sign_sz), "Can't load data from file");
+        STATUS_CHECK(_secbox_verify_signature(type, data_load, data_load_sz, sign, sign_sz),
+                     "Can't verify signature");
         STATUS_CHECK(vs_secmodule_ecies_decrypt(_secmodule,
                                                 id,
                                                 sizeof(vs_storage_element_id_t),
@@ -293,13 +315,13 @@ vs_secbox_load(vs_storage_element_id_t id, uint8_t *data, size_t data_sz) {
             goto terminate;
         }
 
-        res = _storage_ctx->impl_func.load(_storage_ctx->impl_data, f, 1, data, data_load_sz);
+        res = _secbox_load_signed_data(f, data, data_load_sz, sign, sign_sz);
         if (VS_CODE_OK != res) {
             VS_LOG_ERROR("Can't load data from file");
             goto terminate;
         }
 
-        res = _secbox_verify_signature(f, type, data, data_load_sz);
+        res = _secbox_verify_signature(type, data, data_load_sz, sign, sign_sz);
 
         break;
     default:
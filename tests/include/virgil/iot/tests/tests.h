@@ -40,6 +40,7 @@
 
 #define TEST_MANUFACTURE_ID "VRGL"
 #define TEST_DEVICE_TYPE "TEST"
+#define TEST_OWN_FIRMWARE_DATA "test firmware data for checking update library"
 
 uint16_t
 vs_snap_tests(void);
@@ -53,4 +54,11 @@ vs_secbox_test(vs_secmodule_impl_t *secmodule_impl);
 uint16_t
 vs_firmware_test(vs_secmodule_impl_t *secmodule_impl);
 
+uint16_t
+vs_storage_test(void);
+
+// Soft security module must not be initialized. Test initializes it by its own slots storage and deinitializes it.
+uint16_t
+vs_soft_secmodule_slots_test(void);
+
 #endif // VS_IOT_SDK_TESTS_H
@@ -13,6 +13,7 @@
 #include <virgil/iot/macros/macros.h>
 #include <virgil/iot/secmodule/secmodule.h>
 #include <virgil/iot/secmodule/secmodule-helpers.h>
+#include <virgil/iot/storage_hal/storage_hal.h>
 
 #include <private/test_hl_keys_data.h>
 #include <private/test_tl_data.h>
@@ -30,6 +31,18 @@ static uint16_t test_key_max_size = 0;
 static const vs_tl_footer_t *test_footer = NULL;
 static uint16_t test_footer_sz;
 
+#define TEST_TL_FILES_QTY (32)
+
+typedef struct {
+    bool used;
+    vs_storage_element_id_t id;
+    uint8_t *data;
+    size_t size;
+} test_tl_file_t;
+
+static test_tl_file_t test_tl_files[TEST_TL_FILES_QTY];
+static vs_storage_op_ctx_t test_tl_storage;
+
 #define BOOL_CHECK_RET_LOGLEV_RESTORE(CONDITION)                                                                       \
     if (!(CONDITION)) {                                                                                                \
         VS_LOG_SET_LOGLEVEL(prev_loglevel);                                                                            \
@@ -410,6 +423,457 @@ _test_tl_read_pass() {
     return _test_tl_header_read_pass() && _test_tl_keys_read_pass() && _test_tl_footer_read_pass();
 }
 
+/******************************************************************************/
+static bool
+_test_tl_find_keys() {
+    uint8_t key[VS_TL_STORAGE_MAX_PART_SIZE];
+    uint16_t key_sz;
+    uint16_t pub_keys_count = VS_IOT_NTOHS(test_header->pub_keys_count);
+    vs_tl_key_handle handle;
+    vs_pubkey_dated_t *test_key;
+    uint16_t i;
+
+    for (i = 0; i < pub_keys_count; ++i) {
+        test_key = (vs_pubkey_dated_t *)test_tl_keys[i].key;
+        handle = i;
+
+        BOOL_CHECK_RET(VS_CODE_OK == vs_tl_find_key(test_key->pubkey.key_type,
+                                                    test_key->pubkey.ec_type,
+                                                    &handle,
+                                                    key,
+                                                    sizeof(key),
+                                                    &key_sz) &&
+                               handle == i && key_sz == test_tl_keys[i].size,
+                       "Unable to find tl key %u",
+                       i);
+
+        MEMCMP_CHECK_RET(test_tl_keys[i].key, key, key_sz, false);
+    }
+
+    handle = 0;
+    BOOL_CHECK_RET(VS_CODE_ERR_NOT_FOUND ==
+                           vs_tl_find_key(VS_KEY_UNSUPPORTED, VS_KEYPAIR_INVALID, &handle, key, sizeof(key), &key_sz),
+                   "Unsupported key type has been found");
+
+    return true;
+}
+
+/******************************************************************************/
+static uint16_t
+_make_tl_delta(uint8_t *delta, uint16_t key_index) {
+    vs_tl_delta_header_t *delta_header = (vs_tl_delta_header_t *)delta;
+    uint8_t *ptr = delta + sizeof(vs_tl_delta_header_t);
+
+    // Remove key and add it again, so result keys differ from the base ones by key position only
+    VS_IOT_MEMCPY(&delta_header->base_version, &test_header->version, sizeof(vs_file_version_t));
+    VS_IOT_MEMCPY(&delta_header->target_header, test_header, test_header_sz);
+    delta_header->ops_count = VS_IOT_HTONS(2);
+
+    *ptr++ = VS_TL_DELTA_OP_REMOVE;
+    VS_IOT_MEMCPY(ptr, test_tl_keys[key_index].key, test_tl_keys[key_index].size);
+    ptr += test_tl_keys[key_index].size;
+
+    *ptr++ = VS_TL_DELTA_OP_ADD;
+    VS_IOT_MEMCPY(ptr, test_tl_keys[key_index].key, test_tl_keys[key_index].size);
+    ptr += test_tl_keys[key_index].size;
+
+    VS_IOT_MEMCPY(ptr, test_footer, test_footer_sz);
+    ptr += test_footer_sz;
+
+    return ptr - delta;
+}
+
+/******************************************************************************/
+static bool
+_test_tl_delta() {
+    uint8_t delta[sizeof(vs_tl_delta_header_t) + 2 * (1 + test_key_max_size) + test_footer_sz];
+    vs_tl_delta_header_t *delta_header = (vs_tl_delta_header_t *)delta;
+    uint16_t pub_keys_count = VS_IOT_NTOHS(test_header->pub_keys_count);
+    uint16_t delta_sz;
+    bool res;
+    vs_log_level_t prev_loglevel;
+
+    BOOL_CHECK_RET(_test_tl_save_pass(), "Unable to save base Trust List");
+
+    VS_HEADER_SUBCASE("delta keeps keys order");
+    delta_sz = _make_tl_delta(delta, pub_keys_count - 1);
+    BOOL_CHECK_RET(VS_CODE_OK == vs_tl_apply_delta(delta, delta_sz), "Unable to apply Trust List delta");
+    BOOL_CHECK_RET(_test_tl_read_pass(), "Wrong Trust List after delta applying");
+
+    prev_loglevel = VS_LOG_SET_LOGLEVEL(VS_LOGLEV_ALERT);
+
+    VS_HEADER_SUBCASE("delta has wrong base version");
+    delta_header->base_version.major++;
+    res = VS_CODE_OK != vs_tl_apply_delta(delta, delta_sz);
+    delta_header->base_version.major--;
+    res &= _test_tl_read_pass();
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    VS_HEADER_SUBCASE("delta is truncated");
+    res = VS_CODE_OK != vs_tl_apply_delta(delta, delta_sz - 1);
+    res &= _test_tl_read_pass();
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    if (pub_keys_count > 1) {
+        VS_HEADER_SUBCASE("delta changes keys order");
+        delta_sz = _make_tl_delta(delta, 0);
+        res = VS_CODE_OK != vs_tl_apply_delta(delta, delta_sz);
+        res &= _test_tl_read_pass();
+        BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+    }
+
+    VS_LOG_SET_LOGLEVEL(prev_loglevel);
+    return true;
+}
+
+/******************************************************************************/
+static test_tl_file_t *
+_test_storage_find(const vs_storage_element_id_t id) {
+    size_t i;
+
+    for (i = 0; i < TEST_TL_FILES_QTY; ++i) {
+        if (test_tl_files[i].used && 0 == VS_IOT_MEMCMP(test_tl_files[i].id, id, sizeof(vs_storage_element_id_t))) {
+            return &test_tl_files[i];
+        }
+    }
+
+    return NULL;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    size_t i;
+
+    for (i = 0; i < TEST_TL_FILES_QTY; ++i) {
+        VS_IOT_FREE(test_tl_files[i].data);
+    }
+    VS_IOT_MEMSET(test_tl_files, 0, sizeof(test_tl_files));
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_storage_file_t
+_test_storage_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    test_tl_file_t *file = _test_storage_find(id);
+    size_t i;
+
+    for (i = 0; !file && i < TEST_TL_FILES_QTY; ++i) {
+        if (!test_tl_files[i].used) {
+            file = &test_tl_files[i];
+            file->used = true;
+            VS_IOT_MEMCPY(file->id, id, sizeof(vs_storage_element_id_t));
+        }
+    }
+
+    return file;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_save(const vs_storage_impl_data_ctx_t storage_ctx,
+                   const vs_storage_file_t file,
+                   size_t offset,
+                   const uint8_t *in_data,
+                   size_t data_sz) {
+    test_tl_file_t *f = (test_tl_file_t *)file;
+    uint8_t *data;
+
+    if (offset + data_sz > f->size) {
+        data = VS_IOT_CALLOC(1, offset + data_sz);
+        CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NO_MEMORY);
+        if (f->data) {
+            VS_IOT_MEMCPY(data, f->data, f->size);
+            VS_IOT_FREE(f->data);
+        }
+        f->data = data;
+        f->size = offset + data_sz;
+    }
+
+    VS_IOT_MEMCPY(&f->data[offset], in_data, data_sz);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_load(const vs_storage_impl_data_ctx_t storage_ctx,
+                   const vs_storage_file_t file,
+                   size_t offset,
+                   uint8_t *out_data,
+                   size_t data_sz) {
+    test_tl_file_t *f = (test_tl_file_t *)file;
+
+    CHECK_RET(offset + data_sz <= f->size, VS_CODE_ERR_FILE_READ, "Out of file bounds");
+    VS_IOT_MEMCPY(out_data, &f->data[offset], data_sz);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static ssize_t
+_test_storage_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    test_tl_file_t *file = _test_storage_find(id);
+
+    return (file && file->size) ? (ssize_t)file->size : VS_CODE_ERR_NOT_FOUND;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    test_tl_file_t *file = _test_storage_find(id);
+
+    if (file) {
+        VS_IOT_FREE(file->data);
+        VS_IOT_MEMSET(file, 0, sizeof(test_tl_file_t));
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static void
+_test_storage_init(size_t file_sz_limit) {
+    _test_storage_deinit(NULL);
+    VS_IOT_MEMSET(&test_tl_storage, 0, sizeof(test_tl_storage));
+
+    test_tl_storage.impl_data = test_tl_files;
+    test_tl_storage.impl_func.deinit = _test_storage_deinit;
+    test_tl_storage.impl_func.open = _test_storage_open;
+    test_tl_storage.impl_func.sync = _test_storage_sync;
+    test_tl_storage.impl_func.close = _test_storage_close;
+    test_tl_storage.impl_func.save = _test_storage_save;
+    test_tl_storage.impl_func.load = _test_storage_load;
+    test_tl_storage.impl_func.size = _test_storage_size;
+    test_tl_storage.impl_func.del = _test_storage_del;
+    test_tl_storage.file_sz_limit = file_sz_limit;
+}
+
+/******************************************************************************/
+static void
+_legacy_element_id(vs_tl_element_e el, size_t index, vs_storage_element_id_t id) {
+    size_t storage_type = TL_STORAGE_TYPE_DYNAMIC;
+
+    // Previous versions stored each Trust List element separately
+    VS_IOT_MEMSET(id, 0, sizeof(vs_storage_element_id_t));
+    VS_IOT_MEMCPY(&id[0], &storage_type, sizeof(storage_type));
+    VS_IOT_MEMCPY(&id[sizeof(storage_type)], &el, sizeof(el));
+    VS_IOT_MEMCPY(&id[sizeof(storage_type) + sizeof(el)], &index, sizeof(index));
+}
+
+/******************************************************************************/
+static bool
+_save_legacy_tl_part(vs_tl_element_e el, size_t index, const void *data, uint16_t size) {
+    vs_storage_element_id_t id;
+    vs_storage_file_t f;
+
+    _legacy_element_id(el, index, id);
+    f = _test_storage_open(test_tl_storage.impl_data, id);
+
+    return f && VS_CODE_OK == _test_storage_save(test_tl_storage.impl_data, f, 0, data, size);
+}
+
+/******************************************************************************/
+static bool
+_save_legacy_tl(uint16_t keys_count) {
+    uint16_t i;
+
+    BOOL_CHECK_RET(_save_legacy_tl_part(VS_TL_ELEMENT_TLH, 0, test_header, test_header_sz), "Error write tl header");
+
+    for (i = 0; i < keys_count; ++i) {
+        BOOL_CHECK_RET(_save_legacy_tl_part(VS_TL_ELEMENT_TLC, i, test_tl_keys[i].key, test_tl_keys[i].size),
+                       "Error write tl key %u",
+                       i);
+    }
+
+    BOOL_CHECK_RET(_save_legacy_tl_part(VS_TL_ELEMENT_TLF, 0, test_footer, test_footer_sz), "Error write tl footer");
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_legacy_tl_exists(void) {
+    vs_storage_element_id_t id;
+
+    _legacy_element_id(VS_TL_ELEMENT_TLH, 0, id);
+
+    return 0 < _test_storage_size(test_tl_storage.impl_data, id);
+}
+
+/******************************************************************************/
+static bool
+_test_tl_migration(vs_secmodule_impl_t *secmodule_impl) {
+    uint16_t pub_keys_count = VS_IOT_NTOHS(test_header->pub_keys_count);
+    bool res;
+    vs_log_level_t prev_loglevel = VS_LOG_SET_LOGLEVEL(VS_LOGLEV_ALERT);
+
+    // Trust List is initialized by memory storage, so storage content is fully controlled
+    VS_HEADER_SUBCASE("broken legacy TL is removed");
+    _test_storage_init(2 * VS_TL_STORAGE_SIZE);
+    res = _save_legacy_tl(pub_keys_count - 1);
+    res &= VS_CODE_OK != vs_tl_init(&test_tl_storage, secmodule_impl, NULL);
+    res &= !_legacy_tl_exists();
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    // Packed Trust List has offsets table, so it is bigger than all its elements
+    VS_HEADER_SUBCASE("legacy TL bigger than storage element is used in previous layout");
+    _test_storage_init(tl_data1_len);
+    res = _save_legacy_tl(pub_keys_count);
+    res &= VS_CODE_OK == vs_tl_init(&test_tl_storage, secmodule_impl, NULL);
+    res &= _legacy_tl_exists();
+    res &= _test_tl_read_pass() && _test_tl_find_keys();
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    VS_HEADER_SUBCASE("legacy TL is migrated");
+    test_tl_storage.file_sz_limit = 2 * VS_TL_STORAGE_SIZE;
+    res = VS_CODE_OK == vs_tl_init(&test_tl_storage, secmodule_impl, NULL);
+    res &= !_legacy_tl_exists();
+    res &= _test_tl_read_pass() && _test_tl_find_keys();
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    VS_LOG_SET_LOGLEVEL(prev_loglevel);
+    return true;
+}
+
+#if VS_TL_VERIFY_CACHE
+static vs_secmodule_ecdsa_verify_t _ecdsa_verify_orig = NULL;
+static uint32_t _ecdsa_verify_cnt = 0;
+
+/******************************************************************************/
+static vs_status_e
+_ecdsa_verify_counter(vs_secmodule_keypair_type_e keypair_type,
+                      const uint8_t *public_key,
+                      uint16_t public_key_sz,
+                      vs_secmodule_hash_type_e hash_type,
+                      const uint8_t *hash,
+                      const uint8_t *signature,
+                      uint16_t signature_sz) {
+    ++_ecdsa_verify_cnt;
+    return _ecdsa_verify_orig(keypair_type, public_key, public_key_sz, hash_type, hash, signature, signature_sz);
+}
+
+/******************************************************************************/
+static uint32_t
+_tl_init_verifies(vs_secmodule_impl_t *secmodule_impl, bool *init_ok) {
+    _ecdsa_verify_cnt = 0;
+    *init_ok = VS_CODE_OK == vs_tl_init(&test_tl_storage, secmodule_impl, NULL);
+    return _ecdsa_verify_cnt;
+}
+
+/******************************************************************************/
+static bool
+_tamper_verify_cache(bool mac) {
+    vs_storage_element_id_t id;
+    test_tl_file_t *file;
+
+    // Verification cache is stored as Trust List element next to the last one
+    _legacy_element_id(VS_TL_ELEMENT_MAX, 0, id);
+    file = _test_storage_find(id);
+    if (!file || !file->size) {
+        return false;
+    }
+
+    file->data[mac ? file->size - 1 : 0] ^= 0xFF;
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_tl_verify_cache_cases(vs_secmodule_impl_t *secmodule_impl) {
+    uint16_t pub_keys_count = VS_IOT_NTOHS(test_header->pub_keys_count);
+    uint32_t full_cnt;
+    uint32_t cnt;
+#if VS_TL_VERIFY_CACHE_PERIOD
+    uint16_t i;
+#endif
+    bool init_ok;
+    bool res;
+    vs_log_level_t prev_loglevel = VS_LOG_SET_LOGLEVEL(VS_LOGLEV_ALERT);
+
+    // Migrated Trust List is fully verified and its verification result is stored
+    _test_storage_init(2 * VS_TL_STORAGE_SIZE);
+    res = _save_legacy_tl(pub_keys_count);
+    res &= VS_CODE_OK == vs_tl_init(&test_tl_storage, secmodule_impl, NULL);
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    VS_HEADER_SUBCASE("tampered cache MAC requires full verification");
+    res = _tamper_verify_cache(true);
+    full_cnt = _tl_init_verifies(secmodule_impl, &init_ok);
+    res &= init_ok && full_cnt > 0;
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    // High-level signer keys are checked on cached start, but Trust List signatures are not
+    VS_HEADER_SUBCASE("cached start skips signatures verification");
+    cnt = _tl_init_verifies(secmodule_impl, &init_ok);
+    res = init_ok && cnt < full_cnt;
+    res &= _test_tl_read_pass() && _test_tl_find_keys();
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    VS_HEADER_SUBCASE("tampered cache record requires full verification");
+    res = _tamper_verify_cache(false);
+    cnt = _tl_init_verifies(secmodule_impl, &init_ok);
+    res &= init_ok && cnt == full_cnt;
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+#if VS_TL_VERIFY_CACHE_PERIOD
+    VS_HEADER_SUBCASE("full verification is required by period");
+    for (i = 0; i < VS_TL_VERIFY_CACHE_PERIOD; ++i) {
+        cnt = _tl_init_verifies(secmodule_impl, &init_ok);
+        BOOL_CHECK_RET_LOGLEV_RESTORE(init_ok && cnt < full_cnt);
+    }
+    cnt = _tl_init_verifies(secmodule_impl, &init_ok);
+    res = init_ok && cnt == full_cnt;
+    cnt = _tl_init_verifies(secmodule_impl, &init_ok);
+    res &= init_ok && cnt < full_cnt;
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+#endif // VS_TL_VERIFY_CACHE_PERIOD
+
+    // Trust List keys slots contain key of another type, so cached signer key is not found
+    VS_HEADER_SUBCASE("replaced high-level key invalidates cache");
+    res = VS_CODE_OK == secmodule_impl->slot_save(TL1_KEY_SLOT, auth1_pub, auth1_pub_len);
+    res &= VS_CODE_OK == secmodule_impl->slot_save(TL2_KEY_SLOT, auth1_pub, auth1_pub_len);
+    res &= VS_CODE_OK != vs_tl_init(&test_tl_storage, secmodule_impl, NULL);
+    res &= vs_test_save_hl_pubkeys(secmodule_impl);
+    _test_storage_init(2 * VS_TL_STORAGE_SIZE);
+    res &= _save_legacy_tl(pub_keys_count);
+    res &= VS_CODE_OK == vs_tl_init(&test_tl_storage, secmodule_impl, NULL);
+    BOOL_CHECK_RET_LOGLEV_RESTORE(res);
+
+    VS_LOG_SET_LOGLEVEL(prev_loglevel);
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_tl_verify_cache(vs_secmodule_impl_t *secmodule_impl) {
+    bool res;
+
+    // Verification cache MAC key is derived from device key
+    BOOL_CHECK_RET(vs_test_create_device_key(secmodule_impl), "Unable to create device key");
+
+    _ecdsa_verify_orig = secmodule_impl->ecdsa_verify;
+    secmodule_impl->ecdsa_verify = _ecdsa_verify_counter;
+    res = _test_tl_verify_cache_cases(secmodule_impl);
+    secmodule_impl->ecdsa_verify = _ecdsa_verify_orig;
+
+    return res;
+}
+#endif // VS_TL_VERIFY_CACHE
+
 /******************************************************************************/
 uint16_t
 test_keystorage_and_tl(vs_secmodule_impl_t *secmodule_impl) {
@@ -428,12 +892,19 @@ test_keystorage_and_tl(vs_secmodule_impl_t *secmodule_impl) {
 
     TEST_CASE_OK("TL save", _test_tl_save_pass());
     TEST_CASE_OK("TL read", _test_tl_read_pass());
+    TEST_CASE_OK("TL find keys", _test_tl_find_keys());
 
     TEST_CASE_OK("TL header save fail", _test_tl_save_header_fail());
     TEST_CASE_OK("TL keys save fail", _test_tl_save_keys_fail());
 
     TEST_CASE_OK("TL save footer fail", _test_tl_save_footer_fail());
 
+    TEST_CASE_OK("TL delta", _test_tl_delta());
+    TEST_CASE_OK("TL legacy layout migration", _test_tl_migration(secmodule_impl));
+#if VS_TL_VERIFY_CACHE
+    TEST_CASE_OK("TL verification cache", _test_tl_verify_cache(secmodule_impl));
+#endif
+
 terminate:
 
     VS_IOT_FREE(test_tl_keys);
@@ -36,13 +36,27 @@
 
 #include <global-hal.h>
 #include <update-config.h>
+#include <endian-config.h>
 #include <virgil/iot/tests/tests.h>
 #include <virgil/iot/tests/helpers.h>
 #include <virgil/iot/macros/macros.h>
 
 #include <virgil/iot/firmware/firmware.h>
+#include <virgil/iot/firmware/firmware_delta.h>
+#include <virgil/iot/firmware/firmware_compression.h>
+#include <virgil/iot/firmware/firmware_chunk_hashes.h>
+#include <virgil/iot/firmware/firmware_cache.h>
+#include <virgil/iot/firmware/firmware_dedup.h>
+#include <virgil/iot/firmware/firmware_relay.h>
 #include <virgil/iot/secmodule/secmodule-helpers.h>
 #include <virgil/iot/provision/provision.h>
+#include <private/firmware-private.h>
+#if VS_TEST_MSEC
+#include <private/msec_test_impl.h>
+#endif
+#if VS_STORAGE_FAULT_INJECTION_TEST
+#include <virgil/iot/storage_hal/storage_fault_injection.h>
+#endif
 
 #define VS_TEST_FIRMWARE_DATA "test firmware data for verifying update library"
 #define VS_TEST_FILL_SIZE 256
@@ -154,6 +168,15 @@ _test_firmware_save_load_descriptor(void) {
                    "Error load descriptor");
     MEMCMP_CHECK_RET(&desc, &_test_descriptor, sizeof(vs_firmware_descriptor_t), false);
 
+    desc.info.version.build++;
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(&desc), "Error update descriptor");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_load_firmware_descriptor((uint8_t *)_test_descriptor.info.manufacture_id,
+                                                                      (uint8_t *)_test_descriptor.info.device_type,
+                                                                      &desc),
+                   "Error load updated descriptor");
+    BOOL_CHECK_RET(desc.info.version.build == _test_descriptor.info.version.build + 1,
+                   "Descriptor has not been updated");
+
     BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delete_firmware(&desc), "Error delete descriptor");
     BOOL_CHECK_RET(VS_CODE_ERR_NOT_FOUND ==
                            vs_firmware_load_firmware_descriptor((uint8_t *)_test_descriptor.info.manufacture_id,
@@ -181,6 +204,7 @@ _test_firmware_save_load_data(void) {
                                                                  sizeof(VS_TEST_FIRMWARE_DATA),
                                                                  0),
                    "Error save data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_flush_firmware_chunks(), "Error flush data");
     BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &_sz),
                    "Error read data");
     BOOL_CHECK_RET(_sz == sizeof(VS_TEST_FIRMWARE_DATA), "Error size of reading data");
@@ -194,6 +218,50 @@ _test_firmware_save_load_data(void) {
 
     BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify firmware");
 
+    // Second verification reads stored image
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify stored firmware");
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delete_firmware(&_test_descriptor), "Error delete firmware");
+
+    return true;
+}
+
+/**********************************************************/
+static bool
+_test_firmware_verify_unordered(void) {
+    const size_t half_sz = sizeof(VS_TEST_FIRMWARE_DATA) / 2;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(&_test_descriptor), "Error save descriptor");
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                                 (uint8_t *)VS_TEST_FIRMWARE_DATA + half_sz,
+                                                                 sizeof(VS_TEST_FIRMWARE_DATA) - half_sz,
+                                                                 half_sz),
+                   "Error save data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                                 (uint8_t *)VS_TEST_FIRMWARE_DATA,
+                                                                 half_sz,
+                                                                 0),
+                   "Error save data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_footer(&_test_descriptor, _fw_footer), "Error save footer");
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify firmware");
+
+    VS_HEADER_SUBCASE("Damaged chunk after sequential save");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                                 (uint8_t *)VS_TEST_FIRMWARE_DATA,
+                                                                 sizeof(VS_TEST_FIRMWARE_DATA),
+                                                                 0),
+                   "Error save data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                                 (uint8_t *)VS_TEST_FIRMWARE_DATA + 1,
+                                                                 half_sz,
+                                                                 0),
+                   "Error save data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_footer(&_test_descriptor, _fw_footer), "Error save footer");
+
+    BOOL_CHECK_RET(VS_CODE_OK != vs_firmware_verify_firmware(&_test_descriptor), "Damaged firmware has been verified");
+
     BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delete_firmware(&_test_descriptor), "Error delete firmware");
 
     return true;
@@ -234,6 +302,663 @@ _test_firmware_install(vs_secmodule_impl_t *secmodule_impl) {
     return true;
 }
 
+#if VS_FIRMWARE_WRITE_BUFFER_SIZE
+// Firmware storage writes are counted to check data buffering
+static vs_storage_save_hal_t _test_fw_storage_save = NULL;
+static uint32_t _test_fw_saves = 0;
+static bool _test_fw_save_fails = false;
+
+/**********************************************************/
+static vs_status_e
+_test_fw_counting_save(const vs_storage_impl_data_ctx_t storage_ctx,
+                       const vs_storage_file_t file,
+                       size_t offset,
+                       const uint8_t *in_data,
+                       size_t data_sz) {
+    _test_fw_saves++;
+
+    if (_test_fw_save_fails) {
+        return VS_CODE_ERR_FILE_WRITE;
+    }
+
+    return _test_fw_storage_save(storage_ctx, file, offset, in_data, data_sz);
+}
+
+/**********************************************************/
+static bool
+_test_firmware_write_buffer(void) {
+    vs_storage_op_ctx_t *storage_ctx = vs_firmware_storage_ctx();
+    const size_t chunk_sz = sizeof(VS_TEST_FIRMWARE_DATA) / 3;
+    uint8_t buf[sizeof(VS_TEST_FIRMWARE_DATA)];
+    size_t offset;
+    size_t _sz;
+    bool res = false;
+#if VS_TEST_MSEC
+    uint32_t saves;
+    vs_update_interface_t *update_ctx = vs_firmware_update_ctx();
+    vs_update_file_type_t file_type;
+
+    file_type.type = VS_UPDATE_FIRMWARE;
+    VS_IOT_MEMCPY(&file_type.info, &_test_descriptor.info, sizeof(file_type.info));
+#endif
+
+    BOOL_CHECK_RET(NULL != storage_ctx, "Firmware storage is not initialized");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(&_test_descriptor), "Error save descriptor");
+
+    _test_fw_storage_save = storage_ctx->impl_func.save;
+    storage_ctx->impl_func.save = _test_fw_counting_save;
+    _test_fw_saves = 0;
+    _test_fw_save_fails = false;
+
+    VS_HEADER_SUBCASE("Consecutive chunks are coalesced");
+    for (offset = 0; offset < sizeof(VS_TEST_FIRMWARE_DATA); offset += chunk_sz) {
+        _sz = sizeof(VS_TEST_FIRMWARE_DATA) - offset < chunk_sz ? sizeof(VS_TEST_FIRMWARE_DATA) - offset : chunk_sz;
+        CHECK(VS_CODE_OK == vs_firmware_save_firmware_chunk(
+                                    &_test_descriptor, (uint8_t *)VS_TEST_FIRMWARE_DATA + offset, _sz, offset),
+              "Error save data");
+    }
+    CHECK(0 == _test_fw_saves, "Buffered chunks have been written");
+    CHECK(VS_CODE_OK == vs_firmware_flush_firmware_chunks(), "Error flush data");
+    CHECK(1 == _test_fw_saves, "Chunks have been written by %u calls", _test_fw_saves);
+
+    VS_HEADER_SUBCASE("Non consecutive chunk");
+    _test_fw_saves = 0;
+    CHECK(VS_CODE_OK ==
+                  vs_firmware_save_firmware_chunk(&_test_descriptor, (uint8_t *)VS_TEST_FIRMWARE_DATA, chunk_sz, 0),
+          "Error save data");
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                        (uint8_t *)VS_TEST_FIRMWARE_DATA + 2 * chunk_sz,
+                                                        sizeof(VS_TEST_FIRMWARE_DATA) - 2 * chunk_sz,
+                                                        2 * chunk_sz),
+          "Error save data");
+    CHECK(1 == _test_fw_saves, "Buffered data has not been written before non consecutive chunk");
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_chunk(
+                                &_test_descriptor, (uint8_t *)VS_TEST_FIRMWARE_DATA + chunk_sz, chunk_sz, chunk_sz),
+          "Error save data");
+    CHECK(2 == _test_fw_saves, "Buffered data has not been written before non consecutive chunk");
+
+    VS_HEADER_SUBCASE("Flush before load");
+    CHECK(VS_CODE_OK == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &_sz),
+          "Error read data");
+    CHECK(3 == _test_fw_saves, "Buffered data has not been written before load");
+    MEMCMP_CHECK(buf, VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA));
+
+    VS_HEADER_SUBCASE("Flush before footer");
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_chunk(
+                                &_test_descriptor, (uint8_t *)VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), 0),
+          "Error save data");
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_footer(&_test_descriptor, _fw_footer), "Error save footer");
+    _test_fw_save_fails = true;
+    CHECK(VS_CODE_OK == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &_sz),
+          "Buffered data has not been written before footer");
+    _test_fw_save_fails = false;
+
+    VS_HEADER_SUBCASE("Flush before verify");
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_chunk(
+                                &_test_descriptor, (uint8_t *)VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), 0),
+          "Error save data");
+    _test_fw_save_fails = true;
+    CHECK(VS_CODE_OK != vs_firmware_verify_firmware(&_test_descriptor),
+          "Buffered data has not been written before verification");
+    _test_fw_save_fails = false;
+    CHECK(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify firmware");
+
+#if VS_TEST_MSEC
+    VS_HEADER_SUBCASE("Expired buffer is written periodically");
+    vs_test_msec_set(0);
+    CHECK(VS_CODE_OK ==
+                  vs_firmware_save_firmware_chunk(&_test_descriptor, (uint8_t *)VS_TEST_FIRMWARE_DATA, chunk_sz, 0),
+          "Error save data");
+    saves = _test_fw_saves;
+    vs_test_msec_advance(VS_FIRMWARE_WRITE_BUFFER_FLUSH_MS - 1);
+    CHECK(VS_CODE_OK == update_ctx->periodical(update_ctx->storage_context, &file_type), "Periodical call failed");
+    CHECK(saves == _test_fw_saves, "Buffered data has been written before expiration");
+    vs_test_msec_advance(1);
+    CHECK(VS_CODE_OK == update_ctx->periodical(update_ctx->storage_context, &file_type), "Periodical call failed");
+    CHECK(saves + 1 == _test_fw_saves, "Expired buffered data has not been written");
+    vs_test_msec_release();
+#endif
+
+    VS_HEADER_SUBCASE("Write error drops running hash");
+    CHECK(VS_CODE_OK == vs_firmware_delete_firmware(&_test_descriptor), "Error delete firmware");
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_descriptor(&_test_descriptor), "Error save descriptor");
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_chunk(
+                                &_test_descriptor, (uint8_t *)VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), 0),
+          "Error save data");
+    _test_fw_save_fails = true;
+    CHECK(VS_CODE_OK != vs_firmware_flush_firmware_chunks(), "Write error has been ignored");
+    _test_fw_save_fails = false;
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_footer(&_test_descriptor, _fw_footer), "Error save footer");
+    CHECK(VS_CODE_OK != vs_firmware_verify_firmware(&_test_descriptor), "Firmware with lost data has been verified");
+
+    res = true;
+
+terminate:
+#if VS_TEST_MSEC
+    vs_test_msec_release();
+#endif
+    storage_ctx->impl_func.save = _test_fw_storage_save;
+    vs_firmware_delete_firmware(&_test_descriptor);
+
+    return res;
+}
+#endif // VS_FIRMWARE_WRITE_BUFFER_SIZE
+
+#if FIRMWARE_DELTA
+/**********************************************************/
+static bool
+_test_firmware_delta(void) {
+    // "test firmware data for checking update library" -> "test firmware data for verifying update library"
+    // COPY 0..23, INSERT "verifying", COPY 31..47
+    static const char patch[] = "\x01\x00\x00\x00\x00\x00\x00\x00\x17"
+                                "\x02\x00\x00\x00\x09"
+                                "verifying"
+                                "\x01\x00\x00\x00\x1f\x00\x00\x00\x10";
+    vs_firmware_delta_header_t header;
+    vs_firmware_delta_ctx_t ctx;
+    uint8_t buf[sizeof(VS_TEST_FIRMWARE_DATA)];
+    size_t _sz;
+    size_t pos;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_get_own_firmware_descriptor(&header.base),
+                   "Error get own firmware descriptor");
+    header.base.firmware_length = sizeof(TEST_OWN_FIRMWARE_DATA);
+    VS_IOT_MEMCPY(&header.target, &_test_descriptor, sizeof(header.target));
+    header.patch_length = sizeof(patch) - 1;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(&header.target), "Error save descriptor");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delta_apply_init(&ctx, &header), "Error init delta");
+
+    // Operation headers are split between data parts
+    for (pos = 0; pos < header.patch_length; ++pos) {
+        if (VS_CODE_OK != vs_firmware_delta_apply_data(&ctx, (const uint8_t *)&patch[pos], 1)) {
+            vs_firmware_delta_apply_free(&ctx);
+            VS_LOG_ERROR("Error apply delta at %lu", (unsigned long)pos);
+            return false;
+        }
+    }
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delta_apply_finish(&ctx, _fw_footer), "Error finish delta");
+    vs_firmware_delta_apply_free(&ctx);
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &_sz),
+                   "Error read data");
+    BOOL_CHECK_RET(_sz == sizeof(VS_TEST_FIRMWARE_DATA), "Error size of reading data");
+    MEMCMP_CHECK_RET(buf, VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), false);
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify firmware");
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delete_firmware(&_test_descriptor), "Error delete firmware");
+
+    return true;
+}
+#endif // FIRMWARE_DELTA
+
+#if FIRMWARE_COMPRESSION
+/**********************************************************/
+static bool
+_test_firmware_compressed(void) {
+    uint8_t compressed[sizeof(VS_TEST_FIRMWARE_DATA) + sizeof(VS_TEST_FIRMWARE_DATA) / 8 + 5];
+    uint8_t buf[sizeof(VS_TEST_FIRMWARE_DATA)];
+    vs_firmware_compressed_ctx_t ctx;
+    size_t compressed_sz;
+    size_t _sz;
+    size_t pos;
+    size_t part;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_lz_encode((const uint8_t *)VS_TEST_FIRMWARE_DATA,
+                                                       sizeof(VS_TEST_FIRMWARE_DATA),
+                                                       VS_FIRMWARE_LZ_WINDOW_BITS,
+                                                       compressed,
+                                                       sizeof(compressed),
+                                                       &compressed_sz),
+                   "Error compress firmware");
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(&_test_descriptor), "Error save descriptor");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_compressed_apply_init(&ctx, &_test_descriptor, compressed_sz),
+                   "Error init decompression");
+
+    // Compressed stream is split to small parts
+    for (pos = 0; pos < compressed_sz; pos += part) {
+        part = compressed_sz - pos > 3 ? 3 : compressed_sz - pos;
+        if (VS_CODE_OK != vs_firmware_compressed_apply_data(&ctx, &compressed[pos], part)) {
+            vs_firmware_compressed_apply_free(&ctx);
+            VS_LOG_ERROR("Error decompress firmware at %lu", (unsigned long)pos);
+            return false;
+        }
+    }
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_compressed_apply_finish(&ctx, _fw_footer), "Error finish decompression");
+    vs_firmware_compressed_apply_free(&ctx);
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &_sz),
+                   "Error read data");
+    BOOL_CHECK_RET(_sz == sizeof(VS_TEST_FIRMWARE_DATA), "Error size of reading data");
+    MEMCMP_CHECK_RET(buf, VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), false);
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify firmware");
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delete_firmware(&_test_descriptor), "Error delete firmware");
+
+    return true;
+}
+#endif // FIRMWARE_COMPRESSION
+
+#if FIRMWARE_CHUNK_HASHES
+/**********************************************************/
+static bool
+_test_firmware_chunk_hashes(vs_secmodule_impl_t *secmodule_impl) {
+    int key_len = vs_secmodule_get_pubkey_len(VS_KEYPAIR_EC_SECP256R1);
+    int sign_len = vs_secmodule_get_signature_len(VS_KEYPAIR_EC_SECP256R1);
+    vs_firmware_descriptor_t desc = _test_descriptor;
+    const uint32_t chunks_count = 3;
+    const uint32_t hashes_end = sizeof(vs_firmware_chunk_hashes_t) + chunks_count * 32;
+    uint32_t table_sz = hashes_end + VS_FW_SIGNATURES_QTY * (sizeof(vs_sign_t) + key_len + sign_len);
+    uint8_t table_buf[table_sz];
+    vs_firmware_chunk_hashes_t *table = (vs_firmware_chunk_hashes_t *)table_buf;
+    vs_firmware_chunked_header_t header;
+    vs_firmware_chunks_ctx_t ctx;
+    vs_secmodule_sw_sha256_ctx hash_ctx;
+    uint8_t hash[32];
+    uint8_t damaged[16];
+    uint8_t buf[sizeof(VS_TEST_FIRMWARE_DATA)];
+    uint32_t offset;
+    uint32_t i;
+    size_t _sz;
+    bool res = false;
+
+    // Test data is split to 16, 16 and 16 bytes chunks
+    desc.chunk_size = 16;
+    BOOL_CHECK_RET(sizeof(VS_TEST_FIRMWARE_DATA) == chunks_count * desc.chunk_size, "Unexpected test data size");
+
+    VS_IOT_MEMCPY(&table->descriptor, &desc, sizeof(desc));
+    vs_firmware_hton_descriptor(&table->descriptor);
+    table->chunks_count = VS_IOT_HTONL(chunks_count);
+    table->hash_type = VS_HASH_SHA_256;
+    table->signatures_count = VS_FW_SIGNATURES_QTY;
+
+    for (i = 0; i < chunks_count; ++i) {
+        secmodule_impl->hash_init(&hash_ctx);
+        secmodule_impl->hash_update(&hash_ctx, (uint8_t *)VS_TEST_FIRMWARE_DATA + i * desc.chunk_size, desc.chunk_size);
+        secmodule_impl->hash_finish(&hash_ctx, &table->data[i * 32]);
+    }
+
+    secmodule_impl->hash_init(&hash_ctx);
+    secmodule_impl->hash_update(&hash_ctx, table_buf, hashes_end);
+    secmodule_impl->hash_finish(&hash_ctx, hash);
+
+    vs_sign_t *sign = (vs_sign_t *)&table_buf[hashes_end];
+    BOOL_CHECK_RET(_create_test_firmware_signature(secmodule_impl, VS_KEY_AUTH, TEST_AUTH_KEYPAIR, hash, sign),
+                   "Error while creating auth signature");
+    sign = (vs_sign_t *)(sign->raw_sign_pubkey + sign_len + key_len);
+    BOOL_CHECK_RET(_create_test_firmware_signature(secmodule_impl, VS_KEY_FIRMWARE, TEST_FW_KEYPAIR, hash, sign),
+                   "Error while creating fw signature");
+
+    VS_IOT_MEMCPY(&header.descriptor, &desc, sizeof(desc));
+    header.hashes_length = table_sz;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(&desc), "Error save descriptor");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_chunks_init(&ctx, &header), "Error init chunks receiving");
+
+    // Table is passed by two parts, the first one is repeated
+    CHECK(VS_CODE_OK == vs_firmware_chunks_save_hashes(&ctx, 0, table_buf, 40), "Error save hashes");
+    CHECK(VS_CODE_OK == vs_firmware_chunks_save_hashes(&ctx, 0, table_buf, 40), "Error skip repeated hashes");
+    CHECK(VS_CODE_OK == vs_firmware_chunks_save_hashes(&ctx, 40, &table_buf[40], table_sz - 40),
+          "Error verify hashes");
+    CHECK(ctx.hashes_verified, "Hashes have not been verified");
+
+    // Chunks are passed in reverse order, damaged one is rejected
+    VS_IOT_MEMCPY(damaged, VS_TEST_FIRMWARE_DATA, sizeof(damaged));
+    damaged[5] ^= 0x01;
+
+    CHECK(VS_CODE_OK == vs_firmware_chunks_save_chunk(&ctx, 32, (uint8_t *)VS_TEST_FIRMWARE_DATA + 32, 16),
+          "Error save last chunk");
+    CHECK(VS_CODE_ERR_VERIFY == vs_firmware_chunks_save_chunk(&ctx, 0, damaged, sizeof(damaged)),
+          "Damaged chunk has been accepted");
+    CHECK(VS_CODE_OK == vs_firmware_chunks_save_chunk(&ctx, 16, (uint8_t *)VS_TEST_FIRMWARE_DATA + 16, 16),
+          "Error save middle chunk");
+
+    CHECK(!vs_firmware_chunks_is_complete(&ctx), "Incomplete firmware is reported as complete");
+    CHECK(VS_CODE_OK == vs_firmware_chunks_next_missing(&ctx, 0, &offset) && 0 == offset, "Wrong missing chunk");
+
+    CHECK(VS_CODE_OK == vs_firmware_chunks_save_chunk(&ctx, 0, (uint8_t *)VS_TEST_FIRMWARE_DATA, 16),
+          "Error save first chunk");
+    CHECK(vs_firmware_chunks_is_complete(&ctx), "Complete firmware is reported as incomplete");
+    CHECK(VS_CODE_ERR_NOT_FOUND == vs_firmware_chunks_next_missing(&ctx, 0, &offset), "Unexpected missing chunk");
+
+    CHECK(VS_CODE_OK == vs_firmware_load_firmware_chunk(&desc, 0, buf, sizeof(buf), &_sz), "Error read data");
+    CHECK(_sz == sizeof(VS_TEST_FIRMWARE_DATA), "Error size of reading data");
+    CHECK(0 == VS_IOT_MEMCMP(buf, VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA)), "Wrong firmware data");
+
+    CHECK(VS_CODE_OK == vs_firmware_chunked_load_hashes(&header, 0, buf, sizeof(buf), &_sz) && _sz == sizeof(buf) &&
+                  0 == VS_IOT_MEMCMP(buf, table_buf, sizeof(buf)),
+          "Error load hashes");
+
+    res = true;
+
+terminate:
+    vs_firmware_chunks_free(&ctx);
+    vs_firmware_chunked_delete(&header);
+    vs_firmware_delete_firmware(&desc);
+
+    return res;
+}
+#endif // FIRMWARE_CHUNK_HASHES
+
+#if FIRMWARE_CACHE
+/**********************************************************/
+static bool
+_store_cached_firmware(const vs_firmware_descriptor_t *desc) {
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_reserve(desc), "Error reserve cache");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_chunk(
+                                         desc, (uint8_t *)VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), 0),
+                   "Error save data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_footer(desc, _fw_footer), "Error save footer");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(desc), "Error save descriptor");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_commit(desc), "Error commit cache");
+
+    return true;
+}
+
+/**********************************************************/
+static bool
+_test_firmware_cache(void) {
+    vs_firmware_descriptor_t new_desc = _test_descriptor;
+    vs_firmware_descriptor_t other_desc = _test_descriptor;
+    vs_firmware_descriptor_t desc;
+    vs_firmware_cache_stats_t before;
+    vs_firmware_cache_stats_t stats;
+
+    new_desc.info.version.major++;
+    other_desc.info.device_type[0] ^= 0xFF;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_init(2 * _test_descriptor.app_size, VS_FIRMWARE_CACHE_LFU),
+                   "Error init cache");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_stats(&before), "Error get cache stats");
+
+    VS_HEADER_SUBCASE("Keep previous version");
+    BOOL_CHECK_RET(_store_cached_firmware(&_test_descriptor), "Error store firmware");
+    vs_firmware_cache_request(&_test_descriptor.info);
+    vs_firmware_cache_request(&other_desc.info);
+    BOOL_CHECK_RET(_store_cached_firmware(&new_desc), "Error store new firmware");
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_stats(&stats), "Error get cache stats");
+    BOOL_CHECK_RET(stats.hits == before.hits + 1 && stats.misses == before.misses + 1, "Wrong cache hits");
+    BOOL_CHECK_RET(stats.images == 2 && stats.used == 2 * _test_descriptor.app_size, "Previous version is not kept");
+
+    VS_HEADER_SUBCASE("Restore previous version");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_restore(&_test_descriptor.info), "Error restore firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_load_firmware_descriptor(_test_descriptor.info.manufacture_id,
+                                                                      _test_descriptor.info.device_type,
+                                                                      &desc),
+                   "Error load descriptor");
+    MEMCMP_CHECK_RET(&desc, &_test_descriptor, sizeof(vs_firmware_descriptor_t), false);
+
+    VS_HEADER_SUBCASE("Pinned versions are not evicted");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_pin(&_test_descriptor.info, true), "Error pin firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_pin(&new_desc.info, true), "Error pin firmware");
+    BOOL_CHECK_RET(VS_CODE_ERR_NO_MEMORY == vs_firmware_cache_reserve(&other_desc), "Pinned firmware has been evicted");
+
+    VS_HEADER_SUBCASE("Evict by quota");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_pin(&new_desc.info, false), "Error unpin firmware");
+    BOOL_CHECK_RET(_store_cached_firmware(&other_desc), "Error store other firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_stats(&stats), "Error get cache stats");
+    BOOL_CHECK_RET(stats.evictions == before.evictions + 1 && stats.images == 2 && stats.pinned == 1,
+                   "Wrong eviction");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_load_firmware_descriptor(_test_descriptor.info.manufacture_id,
+                                                                      _test_descriptor.info.device_type,
+                                                                      &desc),
+                   "Pinned firmware has been evicted");
+
+    VS_HEADER_SUBCASE("Same version download keeps pin");
+    BOOL_CHECK_RET(_store_cached_firmware(&_test_descriptor), "Error store firmware again");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_stats(&stats), "Error get cache stats");
+    BOOL_CHECK_RET(stats.images == 2 && stats.pinned == 1, "Pinned firmware image has been lost");
+
+    // Zero quota evicts all unpinned images
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_pin(&_test_descriptor.info, false), "Error unpin firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_deinit(), "Error deinit cache");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_init(0, VS_FIRMWARE_CACHE_LRU), "Error init cache");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_stats(&stats) && 0 == stats.images, "Cache has not been cleaned");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_cache_deinit(), "Error deinit cache");
+
+    return true;
+}
+#endif // FIRMWARE_CACHE
+
+#if FIRMWARE_DEDUP
+/**********************************************************/
+static bool
+_store_dedup_firmware(const vs_firmware_descriptor_t *desc) {
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(desc), "Error save descriptor");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_chunk(
+                                         desc, (uint8_t *)VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), 0),
+                   "Error save data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_footer(desc, _fw_footer), "Error save footer");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_dedup_firmware(desc), "Error deduplicate firmware");
+
+    return true;
+}
+
+/**********************************************************/
+static bool
+_test_firmware_dedup(void) {
+    vs_firmware_descriptor_t other_desc = _test_descriptor;
+    vs_firmware_dedup_stats_t before;
+    vs_firmware_dedup_stats_t stats;
+    uint8_t buf[sizeof(VS_TEST_FIRMWARE_DATA)];
+    size_t _sz;
+
+    other_desc.info.device_type[0] ^= 0xFF;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_dedup_stats(&before), "Error get chunk store stats");
+
+    VS_HEADER_SUBCASE("Read deduplicated firmware");
+    BOOL_CHECK_RET(_store_dedup_firmware(&_test_descriptor), "Error store firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &_sz),
+                   "Error read data");
+    BOOL_CHECK_RET(_sz == sizeof(VS_TEST_FIRMWARE_DATA), "Error size of reading data");
+    MEMCMP_CHECK_RET(buf, VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), false);
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify firmware");
+
+    VS_HEADER_SUBCASE("Share chunks between images");
+    BOOL_CHECK_RET(_store_dedup_firmware(&other_desc), "Error store other firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_dedup_stats(&stats), "Error get chunk store stats");
+    BOOL_CHECK_RET(stats.images == before.images + 2 && stats.chunks == before.chunks + 1 &&
+                           stats.references == before.references + 2,
+                   "Chunks have not been shared");
+
+    VS_HEADER_SUBCASE("Release chunks");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delete_firmware(&other_desc), "Error delete firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delete_firmware(&_test_descriptor), "Error delete firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_dedup_stats(&stats), "Error get chunk store stats");
+    BOOL_CHECK_RET(0 == VS_IOT_MEMCMP(&stats, &before, sizeof(stats)), "Chunks have not been released");
+
+    return true;
+}
+#endif // FIRMWARE_DEDUP
+
+#if FIRMWARE_CUT_THROUGH
+/**********************************************************/
+static bool
+_test_firmware_relay(void) {
+    vs_update_interface_t *update_ctx = vs_firmware_update_ctx();
+#if VS_FIRMWARE_WRITE_BUFFER_SIZE
+    vs_storage_op_ctx_t *storage_ctx = vs_firmware_storage_ctx();
+    const size_t half_sz = sizeof(VS_TEST_FIRMWARE_DATA) / 2;
+    vs_status_e ret_code;
+#endif
+    vs_update_file_type_t file_type;
+    uint8_t buf[sizeof(VS_TEST_FIRMWARE_DATA)];
+    uint32_t available_sz = 0;
+    bool is_complete = true;
+    size_t _sz;
+
+    file_type.type = VS_UPDATE_FIRMWARE;
+    VS_IOT_MEMCPY(&file_type.info, &_test_descriptor.info, sizeof(file_type.info));
+
+    VS_HEADER_SUBCASE("Firmware is being received");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_descriptor(&_test_descriptor), "Error save descriptor");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_relay_start(&_test_descriptor), "Error start relay");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                                 (uint8_t *)VS_TEST_FIRMWARE_DATA,
+                                                                 sizeof(VS_TEST_FIRMWARE_DATA),
+                                                                 0),
+                   "Error save data");
+    BOOL_CHECK_RET(VS_CODE_OK ==
+                           update_ctx->get_available_size(NULL, &file_type, &available_sz, &is_complete),
+                   "Error get available size");
+    BOOL_CHECK_RET(!is_complete && 0 == available_sz, "Buffered data is available");
+
+    VS_HEADER_SUBCASE("Read stored data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_flush_firmware_chunks(), "Error flush data");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_relay_available(_test_descriptor.info.manufacture_id,
+                                                             _test_descriptor.info.device_type,
+                                                             &available_sz,
+                                                             &is_complete),
+                   "Error get available size");
+    BOOL_CHECK_RET(!is_complete && sizeof(VS_TEST_FIRMWARE_DATA) == available_sz, "Stored data is not available");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, available_sz, &_sz),
+                   "Error read data");
+    MEMCMP_CHECK_RET(buf, VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA), false);
+
+#if VS_FIRMWARE_WRITE_BUFFER_SIZE
+    VS_HEADER_SUBCASE("Read stored tail by whole buffer");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_chunk(
+                                         &_test_descriptor, (uint8_t *)VS_TEST_FIRMWARE_DATA, half_sz, 0),
+                   "Error save data");
+    _test_fw_storage_save = storage_ctx->impl_func.save;
+    storage_ctx->impl_func.save = _test_fw_counting_save;
+    _test_fw_saves = 0;
+    ret_code = vs_firmware_load_firmware_chunk(&_test_descriptor, half_sz, buf, sizeof(buf), &_sz);
+    storage_ctx->impl_func.save = _test_fw_storage_save;
+    BOOL_CHECK_RET(VS_CODE_OK == ret_code && sizeof(VS_TEST_FIRMWARE_DATA) - half_sz == _sz, "Error read data");
+    BOOL_CHECK_RET(0 == _test_fw_saves, "Relayed data read has written buffered data");
+    MEMCMP_CHECK_RET(buf, VS_TEST_FIRMWARE_DATA + half_sz, _sz, false);
+#endif // VS_FIRMWARE_WRITE_BUFFER_SIZE
+
+    VS_HEADER_SUBCASE("Finish receiving");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_save_firmware_footer(&_test_descriptor, _fw_footer), "Error save footer");
+    vs_firmware_relay_stop();
+    BOOL_CHECK_RET(VS_CODE_OK ==
+                           update_ctx->get_available_size(NULL, &file_type, &available_sz, &is_complete),
+                   "Error get available size");
+    BOOL_CHECK_RET(is_complete, "Firmware is not complete");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_verify_firmware(&_test_descriptor), "Error verify firmware");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_firmware_delete_firmware(&_test_descriptor), "Error delete firmware");
+
+    return true;
+}
+#endif // FIRMWARE_CUT_THROUGH
+
+#if VS_STORAGE_FAULT_INJECTION_TEST
+/**********************************************************/
+static bool
+_test_firmware_faults_configure(const vs_storage_op_ctx_t *storage_ctx, uint32_t failure_ops) {
+    vs_storage_fault_config_t faults;
+
+    VS_IOT_MEMSET(&faults, 0, sizeof(faults));
+    faults.failures_per_mille = failure_ops ? 1000 : 0;
+    faults.failure_ops = failure_ops;
+
+    return VS_CODE_OK == vs_storage_fault_injection_configure(storage_ctx, &faults);
+}
+
+/**********************************************************/
+static bool
+_test_firmware_storage_faults(void) {
+    vs_storage_op_ctx_t *storage_ctx = vs_firmware_storage_ctx();
+    vs_storage_op_ctx_t firmware_storage;
+    vs_storage_op_ctx_t backend;
+    vs_storage_fault_stats_t stats;
+    vs_firmware_descriptor_t desc;
+    uint8_t buf[sizeof(VS_TEST_FIRMWARE_DATA)];
+    size_t sz;
+    bool res = false;
+
+    BOOL_CHECK_RET(NULL != storage_ctx, "Firmware storage is not initialized");
+    vs_firmware_delete_firmware(&_test_descriptor);
+
+    // Firmware storage is wrapped in place and restored without destroying
+    VS_IOT_MEMCPY(&firmware_storage, storage_ctx, sizeof(firmware_storage));
+    VS_IOT_MEMCPY(&backend, storage_ctx, sizeof(backend));
+    backend.impl_func.deinit = NULL;
+    BOOL_CHECK_RET(VS_CODE_OK == vs_storage_fault_injection_init(storage_ctx, &backend, NULL),
+                   "Cannot wrap firmware storage by fault injection");
+
+    VS_HEADER_SUBCASE("Descriptor save failure");
+    CHECK(_test_firmware_faults_configure(storage_ctx, VS_STORAGE_FAULT_SAVE), "Cannot configure faults");
+    CHECK(VS_CODE_OK != vs_firmware_save_firmware_descriptor(&_test_descriptor), "Failed descriptor save succeeded");
+    CHECK(_test_firmware_faults_configure(storage_ctx, 0), "Cannot configure faults");
+    CHECK(VS_CODE_ERR_NOT_FOUND == vs_firmware_load_firmware_descriptor(_test_descriptor.info.manufacture_id,
+                                                                        _test_descriptor.info.device_type,
+                                                                        &desc),
+          "Descriptor of failed save is present");
+
+    VS_HEADER_SUBCASE("Descriptor sync failure");
+    CHECK(_test_firmware_faults_configure(storage_ctx, VS_STORAGE_FAULT_SYNC), "Cannot configure faults");
+    CHECK(VS_CODE_OK != vs_firmware_save_firmware_descriptor(&_test_descriptor), "Failed descriptor sync succeeded");
+    CHECK(_test_firmware_faults_configure(storage_ctx, 0), "Cannot configure faults");
+    CHECK(VS_CODE_ERR_NOT_FOUND == vs_firmware_load_firmware_descriptor(_test_descriptor.info.manufacture_id,
+                                                                        _test_descriptor.info.device_type,
+                                                                        &desc),
+          "Descriptor of failed sync is present");
+
+    VS_HEADER_SUBCASE("Data save failure");
+    CHECK(_test_firmware_faults_configure(storage_ctx, VS_STORAGE_FAULT_SAVE), "Cannot configure faults");
+    // Buffered data is written by flush call
+    CHECK(VS_CODE_OK != vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                        (uint8_t *)VS_TEST_FIRMWARE_DATA,
+                                                        sizeof(VS_TEST_FIRMWARE_DATA),
+                                                        0) ||
+                  VS_CODE_OK != vs_firmware_flush_firmware_chunks(),
+          "Failed data save succeeded");
+
+    // Data can be saved again after failure
+    CHECK(_test_firmware_faults_configure(storage_ctx, 0), "Cannot configure faults");
+    CHECK(VS_CODE_OK == vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                        (uint8_t *)VS_TEST_FIRMWARE_DATA,
+                                                        sizeof(VS_TEST_FIRMWARE_DATA),
+                                                        0),
+          "Error save data");
+    CHECK(VS_CODE_OK == vs_firmware_flush_firmware_chunks(), "Error flush data");
+    CHECK(VS_CODE_OK == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &sz),
+          "Error read data");
+    CHECK(sz == sizeof(VS_TEST_FIRMWARE_DATA), "Error size of reading data");
+    MEMCMP_CHECK(buf, VS_TEST_FIRMWARE_DATA, sizeof(VS_TEST_FIRMWARE_DATA));
+
+    VS_HEADER_SUBCASE("Data load failure");
+    CHECK(_test_firmware_faults_configure(storage_ctx, VS_STORAGE_FAULT_LOAD), "Cannot configure faults");
+    CHECK(VS_CODE_ERR_FILE_READ == vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &sz),
+          "Failed data load succeeded");
+
+    VS_HEADER_SUBCASE("Data open failure");
+    CHECK(_test_firmware_faults_configure(storage_ctx, VS_STORAGE_FAULT_OPEN), "Cannot configure faults");
+    CHECK(VS_CODE_OK != vs_firmware_load_firmware_chunk(&_test_descriptor, 0, buf, sizeof(buf), &sz),
+          "Data load of failed open succeeded");
+    CHECK(VS_CODE_OK != vs_firmware_save_firmware_chunk(&_test_descriptor,
+                                                        (uint8_t *)VS_TEST_FIRMWARE_DATA,
+                                                        sizeof(VS_TEST_FIRMWARE_DATA),
+                                                        0) ||
+                  VS_CODE_OK != vs_firmware_flush_firmware_chunks(),
+          "Data save of failed open succeeded");
+
+    CHECK(_test_firmware_faults_configure(storage_ctx, 0), "Cannot configure faults");
+    CHECK(VS_CODE_OK == vs_storage_fault_injection_get_stats(storage_ctx, &stats) && stats.failures >= 6,
+          "Storage faults have not been injected");
+
+    res = true;
+
+terminate:
+    storage_ctx->impl_func.deinit(storage_ctx->impl_data);
+    VS_IOT_MEMCPY(storage_ctx, &firmware_storage, sizeof(firmware_storage));
+    vs_firmware_delete_firmware(&_test_descriptor);
+
+    return res;
+}
+#endif // VS_STORAGE_FAULT_INJECTION_TEST
+
 /**********************************************************/
 uint16_t
 vs_firmware_test(vs_secmodule_impl_t *secmodule_impl) {
@@ -248,6 +973,31 @@ vs_firmware_test(vs_secmodule_impl_t *secmodule_impl) {
                          _create_test_firmware_footer(secmodule_impl, &_test_descriptor));
     TEST_CASE_OK("Save load firmware descriptor", _test_firmware_save_load_descriptor());
     TEST_CASE_OK("Save load firmware data", _test_firmware_save_load_data());
+    TEST_CASE_OK("Verify firmware saved out of order", _test_firmware_verify_unordered());
+#if VS_FIRMWARE_WRITE_BUFFER_SIZE
+    TEST_CASE_OK("Firmware write buffer", _test_firmware_write_buffer());
+#endif // VS_FIRMWARE_WRITE_BUFFER_SIZE
+#if FIRMWARE_DELTA
+    TEST_CASE_OK("Apply firmware delta", _test_firmware_delta());
+#endif // FIRMWARE_DELTA
+#if FIRMWARE_COMPRESSION
+    TEST_CASE_OK("Decompress firmware", _test_firmware_compressed());
+#endif // FIRMWARE_COMPRESSION
+#if FIRMWARE_CHUNK_HASHES
+    TEST_CASE_OK("Verify firmware chunks", _test_firmware_chunk_hashes(secmodule_impl));
+#endif // FIRMWARE_CHUNK_HASHES
+#if FIRMWARE_CACHE
+    TEST_CASE_OK("Firmware cache", _test_firmware_cache());
+#endif // FIRMWARE_CACHE
+#if FIRMWARE_DEDUP
+    TEST_CASE_OK("Firmware chunks deduplication", _test_firmware_dedup());
+#endif // FIRMWARE_DEDUP
+#if FIRMWARE_CUT_THROUGH
+    TEST_CASE_OK("Firmware cut-through relay", _test_firmware_relay());
+#endif // FIRMWARE_CUT_THROUGH
+#if VS_STORAGE_FAULT_INJECTION_TEST
+    TEST_CASE_OK("Firmware storage faults", _test_firmware_storage_faults());
+#endif // VS_STORAGE_FAULT_INJECTION_TEST
     TEST_CASE_OK("Save install firmware", _test_firmware_install(secmodule_impl));
 
 terminate:
@@ -76,3 +76,20 @@ vs_firmware_get_own_firmware_footer_hal(void *footer, size_t footer_sz) {
 
     return VS_CODE_OK;
 }
+
+#if FIRMWARE_DELTA
+/******************************************************************************/
+vs_status_e
+vs_firmware_read_own_firmware_hal(uint32_t offset, void *data, uint16_t data_sz) {
+    static const char _own_firmware[] = TEST_OWN_FIRMWARE_DATA;
+
+    CHECK_NOT_ZERO_RET(data, VS_CODE_ERR_NULLPTR_ARGUMENT);
+    CHECK_RET(offset <= sizeof(_own_firmware) && data_sz <= sizeof(_own_firmware) - offset,
+              VS_CODE_ERR_INCORRECT_ARGUMENT,
+              "Read outside of own firmware");
+
+    VS_IOT_MEMCPY(data, &_own_firmware[offset], data_sz);
+
+    return VS_CODE_OK;
+}
+#endif // FIRMWARE_DELTA
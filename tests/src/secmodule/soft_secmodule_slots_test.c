@@ -0,0 +1,407 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+
+#include <virgil/iot/tests/helpers.h>
+#include <virgil/iot/tests/tests.h>
+#include <virgil/iot/macros/macros.h>
+#include <stdlib-config.h>
+
+#if VS_SOFT_SECMODULE_SLOT_CACHE_TEST
+#include <pthread.h>
+#include <virgil/iot/secmodule/devices/secmodule-soft.h>
+#include <virgil/iot/vs-soft-secmodule/vs-soft-secmodule.h>
+
+#define TEST_SLOT_FILES_QTY (4)
+#define TEST_SLOT_DATA_SZ (64)
+
+// RAM slots storage that counts storage accesses. Its load call can be suspended to reorder concurrent slot calls.
+typedef struct {
+    bool used;
+    vs_storage_element_id_t id;
+    uint8_t data[TEST_SLOT_DATA_SZ];
+    size_t size;
+} test_slot_file_t;
+
+static test_slot_file_t test_slot_files[TEST_SLOT_FILES_QTY];
+static vs_storage_op_ctx_t test_slot_storage;
+static size_t test_slot_opens;
+static size_t test_slot_loads;
+
+static pthread_mutex_t test_race_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t test_race_cond = PTHREAD_COND_INITIALIZER;
+static bool test_race_armed;
+static bool test_race_loading;
+static bool test_race_saved;
+static pthread_t test_race_thread;
+static vs_secmodule_impl_t *test_secmodule;
+
+/******************************************************************************/
+static test_slot_file_t *
+_test_slot_find(const vs_storage_element_id_t id) {
+    size_t i;
+
+    for (i = 0; i < TEST_SLOT_FILES_QTY; ++i) {
+        if (test_slot_files[i].used && 0 == VS_IOT_MEMCMP(test_slot_files[i].id, id, sizeof(vs_storage_element_id_t))) {
+            return &test_slot_files[i];
+        }
+    }
+
+    return NULL;
+}
+
+/******************************************************************************/
+// Soft secmodule deinitialization doesn't destroy storage, so restart keeps slots content
+static vs_status_e
+_test_slot_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_storage_file_t
+_test_slot_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    test_slot_file_t *file = _test_slot_find(id);
+    size_t i;
+
+    for (i = 0; !file && i < TEST_SLOT_FILES_QTY; ++i) {
+        if (!test_slot_files[i].used) {
+            file = &test_slot_files[i];
+            file->used = true;
+            file->size = 0;
+            VS_IOT_MEMCPY(file->id, id, sizeof(vs_storage_element_id_t));
+        }
+    }
+
+    ++test_slot_opens;
+
+    return file;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_slot_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_slot_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_slot_save(const vs_storage_impl_data_ctx_t storage_ctx,
+                const vs_storage_file_t file,
+                size_t offset,
+                const uint8_t *data,
+                size_t data_sz) {
+    test_slot_file_t *f = (test_slot_file_t *)file;
+
+    CHECK_RET(offset + data_sz <= TEST_SLOT_DATA_SZ, VS_CODE_ERR_FILE_WRITE, "Too big slot data");
+    VS_IOT_MEMCPY(&f->data[offset], data, data_sz);
+    if (f->size < offset + data_sz) {
+        f->size = offset + data_sz;
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+// Armed race suspends load after reading the previous content until concurrent slot save is finished
+static vs_status_e
+_test_slot_load(const vs_storage_impl_data_ctx_t storage_ctx,
+                const vs_storage_file_t file,
+                size_t offset,
+                uint8_t *out_data,
+                size_t data_sz) {
+    const test_slot_file_t *f = (const test_slot_file_t *)file;
+
+    CHECK_RET(offset + data_sz <= f->size, VS_CODE_ERR_FILE_READ, "Out of slot bounds");
+    VS_IOT_MEMCPY(out_data, &f->data[offset], data_sz);
+    ++test_slot_loads;
+
+    pthread_mutex_lock(&test_race_lock);
+    if (test_race_armed && pthread_equal(pthread_self(), test_race_thread)) {
+        test_race_loading = true;
+        pthread_cond_broadcast(&test_race_cond);
+        while (!test_race_saved) {
+            pthread_cond_wait(&test_race_cond, &test_race_lock);
+        }
+    }
+    pthread_mutex_unlock(&test_race_lock);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static ssize_t
+_test_slot_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    const test_slot_file_t *file = _test_slot_find(id);
+
+    return (file && file->size) ? (ssize_t)file->size : VS_CODE_ERR_NOT_FOUND;
+}
+
+/******************************************************************************/
+static void *
+_test_race_load(void *ctx) {
+    uint8_t buf[TEST_SLOT_DATA_SZ];
+    uint16_t sz;
+
+    test_secmodule->slot_load(TL1_KEY_SLOT, buf, sizeof(buf), &sz);
+
+    return NULL;
+}
+
+/******************************************************************************/
+// Armed race starts slot load after slot save has invalidated cache and before it has changed storage content
+static vs_status_e
+_test_slot_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    test_slot_file_t *file;
+
+    pthread_mutex_lock(&test_race_lock);
+    if (test_race_armed && !test_race_loading &&
+        0 == pthread_create(&test_race_thread, NULL, _test_race_load, NULL)) {
+        while (!test_race_loading) {
+            pthread_cond_wait(&test_race_cond, &test_race_lock);
+        }
+    }
+    pthread_mutex_unlock(&test_race_lock);
+
+    file = _test_slot_find(id);
+    if (file) {
+        VS_IOT_MEMSET(file, 0, sizeof(test_slot_file_t));
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static void
+_test_slot_storage_init(void) {
+    VS_IOT_MEMSET(test_slot_files, 0, sizeof(test_slot_files));
+    VS_IOT_MEMSET(&test_slot_storage, 0, sizeof(test_slot_storage));
+
+    test_slot_storage.impl_data = test_slot_files;
+    test_slot_storage.impl_func.deinit = _test_slot_deinit;
+    test_slot_storage.impl_func.open = _test_slot_open;
+    test_slot_storage.impl_func.sync = _test_slot_sync;
+    test_slot_storage.impl_func.close = _test_slot_close;
+    test_slot_storage.impl_func.save = _test_slot_save;
+    test_slot_storage.impl_func.load = _test_slot_load;
+    test_slot_storage.impl_func.size = _test_slot_size;
+    test_slot_storage.impl_func.del = _test_slot_del;
+    test_slot_storage.file_sz_limit = TEST_SLOT_DATA_SZ;
+
+    test_slot_opens = 0;
+    test_slot_loads = 0;
+}
+
+/******************************************************************************/
+// Secure module restart drops slots cache and keeps storage content
+static bool
+_test_secmodule_restart(void) {
+    vs_soft_secmodule_deinit();
+    test_secmodule = vs_soft_secmodule_impl(&test_slot_storage);
+
+    return NULL != test_secmodule;
+}
+
+/******************************************************************************/
+static bool
+_test_slot_check(vs_iot_secmodule_slot_e slot, const uint8_t *data, uint16_t data_sz, size_t storage_loads) {
+    uint8_t buf[TEST_SLOT_DATA_SZ];
+    uint16_t sz = 0;
+    size_t loads = test_slot_loads;
+
+    if (data) {
+        BOOL_CHECK_RET(VS_CODE_OK == test_secmodule->slot_load(slot, buf, sizeof(buf), &sz), "Cannot load slot");
+        BOOL_CHECK_RET(sz == data_sz, "Slot has %u bytes while %u are expected", sz, data_sz);
+        MEMCMP_CHECK_RET(buf, data, data_sz, false);
+    } else {
+        BOOL_CHECK_RET(VS_CODE_OK != test_secmodule->slot_load(slot, buf, sizeof(buf), &sz), "Absent slot is loaded");
+    }
+
+    BOOL_CHECK_RET(storage_loads == test_slot_loads - loads,
+                   "Slot load has read storage %lu times while %lu are expected",
+                   (unsigned long)(test_slot_loads - loads),
+                   (unsigned long)storage_loads);
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_slot_cache_hit(void) {
+    const uint8_t key[] = "public key slot content";
+
+    BOOL_CHECK_RET(VS_CODE_OK == test_secmodule->slot_save(TL1_KEY_SLOT, key, sizeof(key)), "Cannot save slot");
+    BOOL_CHECK_RET(_test_secmodule_restart(), "Cannot restart secure module");
+
+    VS_HEADER_SUBCASE("The first load reads storage");
+    BOOL_CHECK_RET(_test_slot_check(TL1_KEY_SLOT, key, sizeof(key), 1), "Slot is not read from storage");
+
+    VS_HEADER_SUBCASE("Next loads use cache");
+    BOOL_CHECK_RET(_test_slot_check(TL1_KEY_SLOT, key, sizeof(key), 0), "Cached slot is read from storage");
+    BOOL_CHECK_RET(_test_slot_check(TL1_KEY_SLOT, key, sizeof(key), 0), "Cached slot is read from storage");
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_slot_cache_absent(void) {
+    size_t opens = test_slot_opens;
+
+    VS_HEADER_SUBCASE("Absent slot is checked by storage once");
+    BOOL_CHECK_RET(_test_slot_check(TL2_KEY_SLOT, NULL, 0, 0), "Absent slot is loaded");
+    BOOL_CHECK_RET(test_slot_opens > opens, "Absent slot is not checked by storage");
+
+    opens = test_slot_opens;
+    BOOL_CHECK_RET(_test_slot_check(TL2_KEY_SLOT, NULL, 0, 0), "Absent slot is loaded");
+    BOOL_CHECK_RET(test_slot_opens == opens, "Cached absent slot is checked by storage");
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_slot_cache_invalidation(void) {
+    const uint8_t prev_key[] = "previous public key";
+    const uint8_t new_key[] = "new public key";
+    size_t opens;
+
+    BOOL_CHECK_RET(VS_CODE_OK == test_secmodule->slot_save(TL1_KEY_SLOT, prev_key, sizeof(prev_key)),
+                   "Cannot save slot");
+    BOOL_CHECK_RET(_test_slot_check(TL1_KEY_SLOT, prev_key, sizeof(prev_key), 0), "Saved slot is not cached");
+
+    VS_HEADER_SUBCASE("Slot save replaces cached content");
+    BOOL_CHECK_RET(VS_CODE_OK == test_secmodule->slot_save(TL1_KEY_SLOT, new_key, sizeof(new_key)),
+                   "Cannot save slot");
+    BOOL_CHECK_RET(_test_slot_check(TL1_KEY_SLOT, new_key, sizeof(new_key), 0), "Previous slot content is loaded");
+
+    VS_HEADER_SUBCASE("Slot clean caches slot absence");
+    BOOL_CHECK_RET(VS_CODE_OK == test_secmodule->slot_clean(TL1_KEY_SLOT), "Cannot clean slot");
+    opens = test_slot_opens;
+    BOOL_CHECK_RET(_test_slot_check(TL1_KEY_SLOT, NULL, 0, 0), "Cleaned slot is loaded");
+    BOOL_CHECK_RET(test_slot_opens == opens, "Cleaned slot is checked by storage");
+
+    VS_HEADER_SUBCASE("Restarted secure module doesn't find cleaned slot");
+    BOOL_CHECK_RET(_test_secmodule_restart(), "Cannot restart secure module");
+    BOOL_CHECK_RET(_test_slot_check(TL1_KEY_SLOT, NULL, 0, 0), "Cleaned slot is loaded");
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_slot_cache_private_key(void) {
+    const uint8_t key[] = "private key slot content";
+
+    VS_HEADER_SUBCASE("Private key slot is read from storage each time");
+    BOOL_CHECK_RET(VS_CODE_OK == test_secmodule->slot_save(PRIVATE_KEY_SLOT, key, sizeof(key)), "Cannot save slot");
+    BOOL_CHECK_RET(_test_slot_check(PRIVATE_KEY_SLOT, key, sizeof(key), 1), "Private key is cached");
+    BOOL_CHECK_RET(_test_slot_check(PRIVATE_KEY_SLOT, key, sizeof(key), 1), "Private key is cached");
+
+    return true;
+}
+
+/******************************************************************************/
+// Load gets slot generation after save has invalidated the slot and reads previous content before save stores the new
+// one. Load fills cache after save, so it must be rejected.
+static bool
+_test_slot_cache_stale_fill(void) {
+    const uint8_t prev_key[] = "previous public key";
+    const uint8_t new_key[] = "new public key";
+    vs_status_e ret_code;
+    bool raced;
+
+    BOOL_CHECK_RET(VS_CODE_OK == test_secmodule->slot_save(TL1_KEY_SLOT, prev_key, sizeof(prev_key)),
+                   "Cannot save slot");
+
+    pthread_mutex_lock(&test_race_lock);
+    test_race_armed = true;
+    test_race_loading = false;
+    test_race_saved = false;
+    pthread_mutex_unlock(&test_race_lock);
+
+    ret_code = test_secmodule->slot_save(TL1_KEY_SLOT, new_key, sizeof(new_key));
+
+    pthread_mutex_lock(&test_race_lock);
+    raced = test_race_loading;
+    test_race_saved = true;
+    pthread_cond_broadcast(&test_race_cond);
+    pthread_mutex_unlock(&test_race_lock);
+
+    if (raced) {
+        pthread_join(test_race_thread, NULL);
+    }
+
+    pthread_mutex_lock(&test_race_lock);
+    test_race_armed = false;
+    pthread_mutex_unlock(&test_race_lock);
+
+    BOOL_CHECK_RET(VS_CODE_OK == ret_code, "Cannot save slot");
+    BOOL_CHECK_RET(raced, "Concurrent slot load hasn't been started");
+
+    VS_HEADER_SUBCASE("Load started before save doesn't replace saved content");
+    BOOL_CHECK_RET(_test_slot_check(TL1_KEY_SLOT, new_key, sizeof(new_key), 0), "Previous slot content is cached");
+
+    return true;
+}
+#endif // VS_SOFT_SECMODULE_SLOT_CACHE_TEST
+
+/******************************************************************************/
+uint16_t
+vs_soft_secmodule_slots_test(void) {
+    uint16_t failed_test_result = 0;
+
+#if VS_SOFT_SECMODULE_SLOT_CACHE_TEST
+    START_TEST("Soft security module slots cache tests");
+
+    _test_slot_storage_init();
+    test_secmodule = vs_soft_secmodule_impl(&test_slot_storage);
+
+    TEST_CASE_OK("Slot is cached after the first load", _test_slot_cache_hit());
+    TEST_CASE_OK("Slot absence is cached", _test_slot_cache_absent());
+    TEST_CASE_OK("Slot save and clean replace cached content", _test_slot_cache_invalidation());
+    TEST_CASE_OK("Private key is not cached", _test_slot_cache_private_key());
+    TEST_CASE_OK("Load started before save doesn't cache previous content", _test_slot_cache_stale_fill());
+
+terminate:
+    vs_soft_secmodule_deinit();
+#endif
+
+    return failed_test_result;
+}
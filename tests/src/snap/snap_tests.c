@@ -36,6 +36,34 @@
 #include <private/netif_test_impl.h>
 #include <virgil/iot/protocols/snap/snap-structs.h>
 #include <virgil/iot/protocols/snap.h>
+#include <private/fldt-mapping.h>
+#include <update-config.h>
+
+#if VS_SNAP_FLDT_TEST
+#include <virgil/iot/protocols/snap/fldt/fldt-server.h>
+#include <virgil/iot/protocols/snap/fldt/fldt-client.h>
+#include <virgil/iot/protocols/snap/fldt/fldt-private.h>
+#include <virgil/iot/protocols/snap/info/info-private.h>
+#include <virgil/iot/protocols/snap/generated/snap_cvt.h>
+#include <private/msec_test_impl.h>
+#endif
+
+#define TEST_MAPPING_ELEMENTS (40)
+#define TEST_MAPPING_CHURN (1000)
+
+#define TEST_FLDT_START_MS (100000)
+#define TEST_FLDT_HEADER_SZ (16)
+#define TEST_FLDT_FILE_SZ (4096)
+#define TEST_FLDT_FOOTER_SZ (64)
+#define TEST_FLDT_GATEWAY (0xFF)
+#define TEST_FLDT_OTHER_GATEWAY (0xFE)
+#define TEST_FLDT_CLIENT (0x01)
+#define TEST_FLDT_CHUNK_SZ (256)
+
+typedef struct {
+    vs_update_file_type_t file_type;
+    uint32_t value;
+} test_mapping_elem_t;
 
 
 static vs_netif_t *test_netif;
@@ -107,6 +135,1107 @@ terminate:
     return false;
 }
 
+/**********************************************************/
+static void
+_test_mapping_file_type(uint32_t id, vs_update_file_type_t *file_type) {
+    VS_IOT_MEMSET(file_type, 0, sizeof(*file_type));
+    file_type->type = (uint16_t)(id % 3);
+    file_type->info.manufacture_id[0] = (uint8_t)id;
+    file_type->info.device_type[0] = (uint8_t)(id >> 8);
+}
+
+/**********************************************************/
+static bool
+_test_mapping_check(const vs_fldt_mapping_t *mapping, uint32_t first, uint32_t last, uint32_t step, bool present) {
+    vs_update_file_type_t file_type;
+    test_mapping_elem_t *elem;
+    uint32_t id;
+
+    for (id = first; id < last; id += step) {
+        _test_mapping_file_type(id, &file_type);
+        elem = vs_fldt_mapping_find(mapping, &file_type);
+        if (present != (NULL != elem) || (elem && elem->value != id)) {
+            VS_LOG_ERROR("Wrong lookup result for file type element %u", id);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**********************************************************/
+static bool
+_test_mapping_add(vs_fldt_mapping_t *mapping, uint32_t first, uint32_t last, uint32_t step) {
+    vs_update_file_type_t file_type;
+    test_mapping_elem_t *elem;
+    uint32_t id;
+
+    for (id = first; id < last; id += step) {
+        _test_mapping_file_type(id, &file_type);
+        if (VS_CODE_OK != vs_fldt_mapping_add(mapping, &file_type, (void **)&elem) || !elem) {
+            return false;
+        }
+        elem->value = id;
+    }
+
+    return true;
+}
+
+/**********************************************************/
+static bool
+_test_mapping_remove(vs_fldt_mapping_t *mapping, uint32_t first, uint32_t last, uint32_t step) {
+    vs_update_file_type_t file_type;
+    uint32_t id;
+
+    for (id = first; id < last; id += step) {
+        _test_mapping_file_type(id, &file_type);
+        vs_fldt_mapping_remove(mapping, vs_fldt_mapping_find(mapping, &file_type));
+    }
+
+    return true;
+}
+
+/**********************************************************/
+static bool
+test_fldt_mapping(void) {
+    vs_fldt_mapping_t mapping = {.elem_sz = sizeof(test_mapping_elem_t)};
+    vs_update_file_type_t file_type;
+    uint32_t pos = 0;
+    uint32_t count = 0;
+    uint32_t capacity;
+    uint32_t i;
+
+    VS_HEADER_SUBCASE("Insert with growth");
+    CHECK(_test_mapping_add(&mapping, 0, TEST_MAPPING_ELEMENTS, 1), "Unable to add file type elements");
+    CHECK(TEST_MAPPING_ELEMENTS == mapping.count, "Wrong elements count %u", mapping.count);
+    CHECK(mapping.capacity > VS_FLDT_FILE_TYPES_INITIAL_CAPACITY && mapping.count * 4 <= mapping.capacity * 3,
+          "Index has not been grown properly, capacity %u",
+          mapping.capacity);
+    CHECK(_test_mapping_check(&mapping, 0, TEST_MAPPING_ELEMENTS, 1, true), "Lookup after growth failed");
+    _test_mapping_file_type(TEST_MAPPING_ELEMENTS, &file_type);
+    CHECK(!vs_fldt_mapping_find(&mapping, &file_type), "Unknown file type has been found");
+
+    VS_HEADER_SUBCASE("Lookup after tombstones");
+    CHECK(_test_mapping_remove(&mapping, 0, TEST_MAPPING_ELEMENTS, 2), "Unable to remove file type elements");
+    CHECK(TEST_MAPPING_ELEMENTS / 2 == mapping.count && mapping.tombstones, "Removed elements are not tombstones");
+    CHECK(_test_mapping_check(&mapping, 0, TEST_MAPPING_ELEMENTS, 2, false), "Removed element has been found");
+    CHECK(_test_mapping_check(&mapping, 1, TEST_MAPPING_ELEMENTS, 2, true), "Lookup through tombstones failed");
+
+    while (vs_fldt_mapping_next(&mapping, &pos)) {
+        ++count;
+    }
+    CHECK(count == mapping.count, "Iteration returns %u elements instead of %u", count, mapping.count);
+
+    VS_HEADER_SUBCASE("Insert over tombstones");
+    CHECK(_test_mapping_add(&mapping, 0, TEST_MAPPING_ELEMENTS, 2), "Unable to add file type elements again");
+    CHECK(TEST_MAPPING_ELEMENTS == mapping.count, "Wrong elements count %u", mapping.count);
+    CHECK(_test_mapping_check(&mapping, 0, TEST_MAPPING_ELEMENTS, 1, true), "Lookup after reinsertion failed");
+
+    VS_HEADER_SUBCASE("Remove and insert churn");
+    capacity = mapping.capacity;
+    for (i = 0; i < TEST_MAPPING_CHURN; ++i) {
+        CHECK(_test_mapping_remove(&mapping, i % TEST_MAPPING_ELEMENTS, i % TEST_MAPPING_ELEMENTS + 1, 1) &&
+                      _test_mapping_add(&mapping, i % TEST_MAPPING_ELEMENTS, i % TEST_MAPPING_ELEMENTS + 1, 1),
+              "Unable to replace file type element");
+    }
+    CHECK(mapping.capacity <= capacity * 2, "Tombstones have grown index from %u to %u", capacity, mapping.capacity);
+    CHECK(_test_mapping_check(&mapping, 0, TEST_MAPPING_ELEMENTS, 1, true), "Lookup after churn failed");
+
+    VS_HEADER_SUBCASE("Clear");
+    vs_fldt_mapping_clear(&mapping);
+    CHECK(!mapping.count && !mapping.capacity && !mapping.slots, "Index has not been cleared");
+    CHECK(_test_mapping_check(&mapping, 0, TEST_MAPPING_ELEMENTS, 1, false), "Element has been found after clear");
+
+    return true;
+
+terminate:
+
+    vs_fldt_mapping_clear(&mapping);
+
+    return false;
+}
+
+#if VS_SNAP_FLDT_TEST
+
+static vs_status_e
+_test_fldt_netif_tx(struct vs_netif_t *netif, const uint8_t *data, const uint16_t data_sz);
+static vs_status_e
+_test_fldt_netif_mac_addr(const struct vs_netif_t *netif, struct vs_mac_addr_t *mac_addr);
+static vs_status_e
+_test_fldt_netif_init(struct vs_netif_t *netif, const vs_netif_rx_cb_t rx_cb, const vs_netif_process_cb_t process_cb);
+static vs_status_e
+_test_fldt_netif_deinit(struct vs_netif_t *netif);
+
+// FLDT packets are not looped back. Test sends packets of other devices and checks the last sent one
+static vs_netif_t _test_fldt_netif = {
+        .init = _test_fldt_netif_init,
+        .deinit = _test_fldt_netif_deinit,
+        .mac_addr = _test_fldt_netif_mac_addr,
+        .tx = _test_fldt_netif_tx,
+};
+
+static vs_netif_rx_cb_t _test_fldt_rx_cb;
+static vs_netif_process_cb_t _test_fldt_process_cb;
+static vs_mac_addr_t _test_fldt_own_mac;
+static uint8_t _test_fldt_sent[sizeof(vs_snap_packet_t) + 2 * VS_NETIF_PACKET_BUF_SIZE];
+static uint16_t _test_fldt_sent_sz = 0;
+static uint32_t _test_fldt_sent_cnt = 0;
+static uint32_t _test_fldt_requests_cnt = 0;
+static vs_snap_element_t _test_fldt_request_element = 0;
+static uint32_t _test_fldt_next_offset = 0;
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_netif_tx(struct vs_netif_t *netif, const uint8_t *data, const uint16_t data_sz) {
+    const vs_snap_packet_t *packet;
+
+    (void)netif;
+
+    if (data_sz > sizeof(_test_fldt_sent)) {
+        return VS_CODE_ERR_TOO_SMALL_BUFFER;
+    }
+
+    VS_IOT_MEMCPY(_test_fldt_sent, data, data_sz);
+    _test_fldt_sent_sz = data_sz;
+    _test_fldt_sent_cnt++;
+
+    // Packet flags and element are not converted, so requests are counted to check retransmissions
+    packet = (const vs_snap_packet_t *)data;
+    if (data_sz >= sizeof(*packet) && !(packet->header.flags & (VS_SNAP_FLAG_ACK | VS_SNAP_FLAG_NACK))) {
+        _test_fldt_request_element = packet->header.element_id;
+        _test_fldt_requests_cnt++;
+    }
+
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_netif_mac_addr(const struct vs_netif_t *netif, struct vs_mac_addr_t *mac_addr) {
+    (void)netif;
+    *mac_addr = _test_fldt_own_mac;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_netif_init(struct vs_netif_t *netif, const vs_netif_rx_cb_t rx_cb, const vs_netif_process_cb_t process_cb) {
+    (void)netif;
+    _test_fldt_rx_cb = rx_cb;
+    _test_fldt_process_cb = process_cb;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_netif_deinit(struct vs_netif_t *netif) {
+    (void)netif;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static void
+_test_fldt_mac(uint8_t id, vs_mac_addr_t *mac) {
+    VS_IOT_MEMSET(mac, 0, sizeof(*mac));
+    mac->bytes[0] = 0x02;
+    mac->bytes[ETH_ADDR_LEN - 1] = id;
+}
+
+/**********************************************************/
+static void
+_test_fldt_file_type(uint16_t type, vs_update_file_type_t *file_type) {
+    VS_IOT_MEMSET(file_type, 0, sizeof(*file_type));
+    file_type->type = type;
+    file_type->info.version.major = 1;
+}
+
+/**********************************************************/
+static bool
+_test_fldt_receive(uint8_t sender, vs_snap_element_t element_id, uint32_t flags, const void *content, uint16_t sz) {
+    uint8_t buf[sizeof(vs_snap_packet_t) + sz];
+    vs_snap_packet_t *packet = (vs_snap_packet_t *)buf;
+    const uint8_t *packet_data;
+    uint16_t packet_data_sz;
+
+    VS_IOT_MEMSET(buf, 0, sizeof(buf));
+    packet->eth_header.dest = _test_fldt_own_mac;
+    _test_fldt_mac(sender, &packet->eth_header.src);
+    packet->eth_header.type = VS_ETHERTYPE_VIRGIL;
+    packet->header.service_id = VS_FLDT_SERVICE_ID;
+    packet->header.element_id = element_id;
+    packet->header.flags = flags;
+    packet->header.content_size = sz;
+    VS_IOT_MEMCPY(packet->content, content, sz);
+
+    // Normalize byte order
+    vs_snap_packet_t_encode(packet);
+
+    _test_fldt_sent_sz = 0;
+
+    return VS_CODE_OK == _test_fldt_rx_cb(&_test_fldt_netif, buf, sizeof(buf), &packet_data, &packet_data_sz) &&
+           VS_CODE_OK == _test_fldt_process_cb(&_test_fldt_netif, packet_data, packet_data_sz);
+}
+
+/**********************************************************/
+static bool
+_test_fldt_periodical(void) {
+    return VS_CODE_OK == _test_fldt_process_cb(&_test_fldt_netif, NULL, 0);
+}
+
+/**********************************************************/
+static vs_snap_packet_t *
+_test_fldt_sent_packet(vs_snap_element_t element_id) {
+    vs_snap_packet_t *packet = (vs_snap_packet_t *)_test_fldt_sent;
+
+    if (_test_fldt_sent_sz < sizeof(*packet)) {
+        return NULL;
+    }
+
+    // Normalize byte order
+    vs_snap_packet_t_decode(packet);
+    _test_fldt_sent_sz = 0;
+
+    if (packet->header.service_id != VS_FLDT_SERVICE_ID || packet->header.element_id != element_id) {
+        return NULL;
+    }
+
+    return packet;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_get_header_size(void *context, vs_update_file_type_t *file_type, uint32_t *header_size) {
+    *header_size = TEST_FLDT_HEADER_SZ;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_get_file_size(void *context,
+                         vs_update_file_type_t *file_type,
+                         const void *file_header,
+                         uint32_t *file_size) {
+    *file_size = TEST_FLDT_FILE_SZ;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_has_footer(void *context, vs_update_file_type_t *file_type, bool *has_footer) {
+    *has_footer = true;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_inc_data_offset(void *context,
+                           vs_update_file_type_t *file_type,
+                           uint32_t current_offset,
+                           uint32_t loaded_data_size,
+                           uint32_t *next_offset) {
+    *next_offset = current_offset + loaded_data_size;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_get_header(void *context,
+                      vs_update_file_type_t *file_type,
+                      void *header_buffer,
+                      uint32_t buffer_size,
+                      uint32_t *header_size) {
+    CHECK_RET(buffer_size >= TEST_FLDT_HEADER_SZ, VS_CODE_ERR_TOO_SMALL_BUFFER, "Header buffer is too small");
+    VS_IOT_MEMSET(header_buffer, (uint8_t)file_type->type, TEST_FLDT_HEADER_SZ);
+    *header_size = TEST_FLDT_HEADER_SZ;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_get_data(void *context,
+                    vs_update_file_type_t *file_type,
+                    const void *file_header,
+                    void *data_buffer,
+                    uint32_t buffer_size,
+                    uint32_t *data_size,
+                    uint32_t data_offset) {
+    uint32_t i;
+
+    CHECK_RET(data_offset < TEST_FLDT_FILE_SZ, VS_CODE_ERR_INCORRECT_ARGUMENT, "Wrong data offset %u", data_offset);
+
+    *data_size = TEST_FLDT_FILE_SZ - data_offset;
+    if (*data_size > buffer_size) {
+        *data_size = buffer_size;
+    }
+
+    for (i = 0; i < *data_size; ++i) {
+        ((uint8_t *)data_buffer)[i] = (uint8_t)(data_offset + i);
+    }
+
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_get_footer(void *context,
+                      vs_update_file_type_t *file_type,
+                      const void *file_header,
+                      void *footer_buffer,
+                      uint32_t buffer_size,
+                      uint32_t *footer_size) {
+    CHECK_RET(buffer_size >= TEST_FLDT_FOOTER_SZ, VS_CODE_ERR_TOO_SMALL_BUFFER, "Footer buffer is too small");
+    VS_IOT_MEMSET(footer_buffer, 0xF0, TEST_FLDT_FOOTER_SZ);
+    *footer_size = TEST_FLDT_FOOTER_SZ;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_verify_object(void *context, vs_update_file_type_t *file_type) {
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_set_header(void *context,
+                      vs_update_file_type_t *file_type,
+                      const void *file_header,
+                      uint32_t header_size,
+                      uint32_t *file_size) {
+    *file_size = TEST_FLDT_FILE_SZ;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_set_data(void *context,
+                    vs_update_file_type_t *file_type,
+                    const void *file_header,
+                    const void *file_data,
+                    uint32_t data_size,
+                    uint32_t data_offset) {
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_set_footer(void *context,
+                      vs_update_file_type_t *file_type,
+                      const void *file_header,
+                      const void *file_footer,
+                      uint32_t footer_size) {
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static void
+_test_fldt_delete_object(void *context, vs_update_file_type_t *file_type) {
+}
+
+static vs_update_interface_t _test_fldt_update_ctx = {
+        .get_header_size = _test_fldt_get_header_size,
+        .get_file_size = _test_fldt_get_file_size,
+        .has_footer = _test_fldt_has_footer,
+        .inc_data_offset = _test_fldt_inc_data_offset,
+        .get_header = _test_fldt_get_header,
+        .get_data = _test_fldt_get_data,
+        .get_footer = _test_fldt_get_footer,
+        .set_header = _test_fldt_set_header,
+        .set_data = _test_fldt_set_data,
+        .set_footer = _test_fldt_set_footer,
+        .delete_object = _test_fldt_delete_object,
+        .verify_object = _test_fldt_verify_object,
+};
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_add_filetype(const vs_update_file_type_t *file_type, vs_update_interface_t **update_ctx) {
+    *update_ctx = &_test_fldt_update_ctx;
+    return VS_CODE_OK;
+}
+
+/**********************************************************/
+static bool
+_test_fldt_server_start(const vs_update_file_type_t *file_a, const vs_update_file_type_t *file_b) {
+    const vs_device_manufacture_id_t manufacturer_id = {0};
+    const vs_device_type_t device_type = {0};
+    const vs_device_serial_t device_serial = {0};
+
+    _test_fldt_mac(TEST_FLDT_GATEWAY, &_test_fldt_own_mac);
+    vs_test_msec_set(TEST_FLDT_START_MS);
+
+    CHECK(VS_CODE_OK == vs_snap_init(&_test_fldt_netif, manufacturer_id, device_type, device_serial, 0),
+          "vs_snap_init call");
+    CHECK(VS_CODE_OK == vs_snap_register_service(vs_snap_fldt_server(&_test_fldt_own_mac, _test_fldt_add_filetype)),
+          "Unable to register FLDT server");
+    CHECK(VS_CODE_OK == vs_fldt_server_add_file_type(file_a, &_test_fldt_update_ctx, false) &&
+                  VS_CODE_OK == vs_fldt_server_add_file_type(file_b, &_test_fldt_update_ctx, false),
+          "Unable to add file types");
+
+    return true;
+
+terminate:
+
+    return false;
+}
+
+/**********************************************************/
+static void
+_test_fldt_stop(void) {
+    vs_snap_deinit();
+    vs_test_msec_release();
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_gnfd(uint8_t client, const vs_update_file_type_t *file_type, uint32_t offset, uint32_t *delay_ms) {
+    vs_fldt_gnfd_data_request_t request;
+    vs_fldt_gnfd_data_response_t *data_response;
+    vs_fldt_retry_later_t *retry_later;
+    vs_snap_packet_t *packet;
+
+    request.type = *file_type;
+    request.offset = offset;
+
+    // Normalize byte order
+    vs_fldt_gnfd_data_request_t_encode(&request);
+
+    if (!_test_fldt_receive(client, VS_FLDT_GNFD, 0, &request, sizeof(request)) ||
+        NULL == (packet = _test_fldt_sent_packet(VS_FLDT_GNFD))) {
+        return VS_CODE_ERR_SNAP_UNKNOWN;
+    }
+
+    if (packet->header.flags & VS_SNAP_FLAG_ACK) {
+        data_response = (vs_fldt_gnfd_data_response_t *)packet->content;
+        vs_fldt_gnfd_data_response_t_decode(data_response);
+        _test_fldt_next_offset = data_response->next_offset;
+        return VS_CODE_OK;
+    }
+
+    if (packet->header.content_size != sizeof(*retry_later)) {
+        return VS_CODE_ERR_INCORRECT_ARGUMENT;
+    }
+
+    retry_later = (vs_fldt_retry_later_t *)packet->content;
+    vs_fldt_retry_later_t_decode(retry_later);
+    *delay_ms = retry_later->delay_ms;
+
+    return VS_CODE_COMMAND_RETRY_LATER;
+}
+
+/**********************************************************/
+static vs_status_e
+_test_fldt_gnff(uint8_t client, const vs_update_file_type_t *file_type) {
+    vs_fldt_gnff_footer_request_t request;
+    vs_snap_packet_t *packet;
+
+    request.type = *file_type;
+
+    // Normalize byte order
+    vs_fldt_gnff_footer_request_t_encode(&request);
+
+    if (!_test_fldt_receive(client, VS_FLDT_GNFF, 0, &request, sizeof(request)) ||
+        NULL == (packet = _test_fldt_sent_packet(VS_FLDT_GNFF))) {
+        return VS_CODE_ERR_SNAP_UNKNOWN;
+    }
+
+    return (packet->header.flags & VS_SNAP_FLAG_ACK) ? VS_CODE_OK : VS_CODE_ERR_INCORRECT_ARGUMENT;
+}
+
+/**********************************************************/
+static bool
+test_fldt_server_admission(void) {
+    vs_update_file_type_t file_a;
+    vs_update_file_type_t file_b;
+    vs_fldt_server_stats_t stats;
+    vs_fldt_server_transfer_stats_t transfers[VS_FLDT_SERVER_TRANSFERS_MAX];
+    uint32_t transfers_cnt;
+    uint32_t delay_ms = 0;
+    uint8_t client;
+
+    _test_fldt_file_type(VS_UPDATE_FIRMWARE, &file_a);
+    _test_fldt_file_type(VS_UPDATE_TRUST_LIST, &file_b);
+    CHECK(_test_fldt_server_start(&file_a, &file_b), "Unable to start FLDT server");
+
+    VS_HEADER_SUBCASE("Admission");
+    for (client = 1; client <= VS_FLDT_SERVER_TRANSFERS_MAX; ++client) {
+        CHECK(VS_CODE_OK == _test_fldt_gnfd(client, &file_a, 0, &delay_ms), "Client %u has not been admitted", client);
+    }
+    CHECK(VS_CODE_COMMAND_RETRY_LATER == _test_fldt_gnfd(client, &file_a, 0, &delay_ms) &&
+                  VS_FLDT_SERVER_ADMISSION_RETRY_MS == delay_ms,
+          "Client over transfers limit has not been asked to retry later");
+    CHECK(VS_CODE_COMMAND_RETRY_LATER == _test_fldt_gnfd(1, &file_b, 0, &delay_ms) &&
+                  VS_FLDT_SERVER_ADMISSION_RETRY_MS == delay_ms,
+          "Another file of admitted client has been served over transfers limit");
+
+    VS_HEADER_SUBCASE("Finish by file type");
+    CHECK(VS_CODE_OK == _test_fldt_gnff(1, &file_b), "Footer request has failed");
+    CHECK(VS_CODE_COMMAND_RETRY_LATER == _test_fldt_gnfd(client, &file_a, 0, &delay_ms),
+          "Footer of another file has finished client's transfer");
+    CHECK(VS_CODE_OK == _test_fldt_gnff(1, &file_a), "Footer request has failed");
+    CHECK(VS_CODE_OK == _test_fldt_gnfd(client, &file_a, 0, &delay_ms),
+          "Client has not been admitted after finished transfer");
+    CHECK(VS_CODE_OK == vs_fldt_server_get_stats(&stats, NULL, 0, NULL), "Unable to get FLDT server statistics");
+    CHECK(1 == stats.transfers_completed && VS_FLDT_SERVER_TRANSFERS_MAX == stats.active_transfers,
+          "Wrong transfers statistics : %u completed, %u active",
+          stats.transfers_completed,
+          stats.active_transfers);
+
+    VS_HEADER_SUBCASE("Idle transfers release");
+    vs_test_msec_advance(VS_FLDT_SERVER_TRANSFER_IDLE_MS);
+    CHECK(_test_fldt_periodical(), "Periodical processing has failed");
+    CHECK(VS_CODE_OK == _test_fldt_gnfd(2, &file_a, 0, &delay_ms), "Client has not been admitted again");
+    CHECK(VS_CODE_OK == vs_fldt_server_get_stats(&stats, transfers, VS_FLDT_SERVER_TRANSFERS_MAX, &transfers_cnt),
+          "Unable to get FLDT server statistics");
+    CHECK(1 == transfers_cnt && 1 == transfers[0].chunks_served && 0 == transfers[0].duration_ms &&
+                  vs_update_equal_file_type(&transfers[0].type, &file_a),
+          "Idle transfer has not been released by periodical processing");
+
+    _test_fldt_stop();
+
+    return true;
+
+terminate:
+
+    _test_fldt_stop();
+
+    return false;
+}
+
+#if VS_FLDT_SERVER_ROUND_CHUNKS
+/**********************************************************/
+static bool
+test_fldt_server_fairness(void) {
+    vs_update_file_type_t file_a;
+    vs_update_file_type_t file_b;
+    uint32_t delay_ms = 0;
+    uint32_t i;
+
+    _test_fldt_file_type(VS_UPDATE_FIRMWARE, &file_a);
+    _test_fldt_file_type(VS_UPDATE_TRUST_LIST, &file_b);
+    CHECK(_test_fldt_server_start(&file_a, &file_b), "Unable to start FLDT server");
+
+    // New round starts with the first request
+    vs_test_msec_advance(VS_FLDT_SERVER_ROUND_MS);
+    CHECK(VS_CODE_OK == _test_fldt_gnfd(1, &file_a, 0, &delay_ms) &&
+                  VS_CODE_OK == _test_fldt_gnfd(2, &file_a, 0, &delay_ms),
+          "Clients have not been admitted");
+
+    for (i = 1; i < VS_FLDT_SERVER_ROUND_CHUNKS / 2; ++i) {
+        CHECK(VS_CODE_OK == _test_fldt_gnfd(1, &file_a, 0, &delay_ms), "Client has not received its part of round");
+    }
+    CHECK(VS_CODE_COMMAND_RETRY_LATER == _test_fldt_gnfd(1, &file_a, 0, &delay_ms) &&
+                  VS_FLDT_SERVER_ROUND_MS == delay_ms,
+          "Client has exceeded its part of round");
+
+    vs_test_msec_advance(VS_FLDT_SERVER_ROUND_MS / 2);
+    for (i = 1; i < VS_FLDT_SERVER_ROUND_CHUNKS / 2; ++i) {
+        CHECK(VS_CODE_OK == _test_fldt_gnfd(2, &file_a, 0, &delay_ms),
+              "Another client has not received its part of round");
+    }
+    CHECK(VS_CODE_COMMAND_RETRY_LATER == _test_fldt_gnfd(2, &file_a, 0, &delay_ms) &&
+                  VS_FLDT_SERVER_ROUND_MS / 2 == delay_ms,
+          "Retry delay is not the rest of round");
+
+    vs_test_msec_advance(VS_FLDT_SERVER_ROUND_MS / 2);
+    CHECK(VS_CODE_OK == _test_fldt_gnfd(1, &file_a, 0, &delay_ms) &&
+                  VS_CODE_OK == _test_fldt_gnfd(2, &file_a, 0, &delay_ms),
+          "Clients have not been served in the next round");
+
+    _test_fldt_stop();
+
+    return true;
+
+terminate:
+
+    _test_fldt_stop();
+
+    return false;
+}
+#endif // VS_FLDT_SERVER_ROUND_CHUNKS
+
+/**********************************************************/
+static bool
+test_fldt_server_telemetry(void) {
+    vs_update_file_type_t file_a;
+    vs_update_file_type_t file_b;
+    vs_fldt_server_stats_t stats;
+    vs_fldt_server_transfer_stats_t transfers[VS_FLDT_SERVER_TRANSFERS_MAX];
+    uint32_t transfers_cnt;
+    uint32_t delay_ms = 0;
+    uint32_t offset;
+    uint32_t chunks = 0;
+    vs_mac_addr_t client_mac;
+    uint8_t client;
+
+    _test_fldt_file_type(VS_UPDATE_FIRMWARE, &file_a);
+    _test_fldt_file_type(VS_UPDATE_TRUST_LIST, &file_b);
+    _test_fldt_mac(1, &client_mac);
+    CHECK(_test_fldt_server_start(&file_a, &file_b), "Unable to start FLDT server");
+
+    // New round starts with the first request
+    vs_test_msec_advance(VS_FLDT_SERVER_ROUND_MS);
+
+    VS_HEADER_SUBCASE("Served data");
+    for (offset = 0; offset < TEST_FLDT_FILE_SZ; offset = _test_fldt_next_offset) {
+        CHECK(VS_CODE_OK == _test_fldt_gnfd(1, &file_a, offset, &delay_ms), "Data request has failed");
+        chunks++;
+    }
+    CHECK(VS_CODE_OK == vs_fldt_server_get_stats(&stats, transfers, VS_FLDT_SERVER_TRANSFERS_MAX, &transfers_cnt),
+          "Unable to get FLDT server statistics");
+    CHECK(TEST_FLDT_FILE_SZ == stats.bytes_served && chunks == stats.chunks_served && 1 == stats.active_transfers,
+          "Wrong served data statistics : %u bytes, %u chunks",
+          stats.bytes_served,
+          stats.chunks_served);
+    CHECK(1 == transfers_cnt && 0 == VS_IOT_MEMCMP(&transfers[0].client_mac, &client_mac, sizeof(client_mac)) &&
+                  TEST_FLDT_FILE_SZ == transfers[0].bytes_served && chunks == transfers[0].chunks_served,
+          "Wrong transfer statistics");
+
+    VS_HEADER_SUBCASE("Chunk rate");
+    vs_test_msec_advance(VS_FLDT_SERVER_ROUND_MS);
+    CHECK(VS_CODE_OK == _test_fldt_gnfd(1, &file_a, 0, &delay_ms), "Data request has failed");
+    CHECK(VS_CODE_OK == vs_fldt_server_get_stats(&stats, transfers, VS_FLDT_SERVER_TRANSFERS_MAX, &transfers_cnt),
+          "Unable to get FLDT server statistics");
+    CHECK(chunks * 1000 / VS_FLDT_SERVER_ROUND_MS == stats.chunk_rate, "Wrong chunk rate %u", stats.chunk_rate);
+    CHECK(1 == transfers_cnt && VS_FLDT_SERVER_ROUND_MS == transfers[0].duration_ms &&
+                  chunks + 1 == transfers[0].chunks_served,
+          "Wrong transfer duration %u ms",
+          transfers[0].duration_ms);
+    vs_test_msec_advance(2 * VS_FLDT_SERVER_ROUND_MS);
+    CHECK(VS_CODE_OK == vs_fldt_server_get_stats(&stats, NULL, 0, NULL) && 0 == stats.chunk_rate,
+          "Outdated chunk rate has been reported");
+
+    VS_HEADER_SUBCASE("Retry later answers");
+    for (client = 2; client <= VS_FLDT_SERVER_TRANSFERS_MAX; ++client) {
+        CHECK(VS_CODE_OK == _test_fldt_gnfd(client, &file_a, 0, &delay_ms), "Client %u has not been admitted", client);
+    }
+    CHECK(VS_CODE_COMMAND_RETRY_LATER == _test_fldt_gnfd(client, &file_a, 0, &delay_ms),
+          "Client over transfers limit has been admitted");
+    CHECK(VS_CODE_OK == vs_fldt_server_get_stats(&stats, NULL, 0, NULL) && 1 == stats.retry_later,
+          "Retry later answers have not been counted");
+
+    VS_HEADER_SUBCASE("Completed transfer");
+    CHECK(VS_CODE_OK == _test_fldt_gnff(1, &file_a), "Footer request has failed");
+    CHECK(VS_CODE_OK == vs_fldt_server_get_stats(&stats, NULL, 0, NULL), "Unable to get FLDT server statistics");
+    CHECK(1 == stats.transfers_completed && VS_FLDT_SERVER_TRANSFERS_MAX - 1 == stats.active_transfers,
+          "Wrong transfers statistics : %u completed, %u active",
+          stats.transfers_completed,
+          stats.active_transfers);
+
+    _test_fldt_stop();
+
+    return true;
+
+terminate:
+
+    _test_fldt_stop();
+
+    return false;
+}
+
+#if VS_IMPL_MSEC
+/**********************************************************/
+static void
+_test_fldt_got_file(vs_update_file_type_t *file_type,
+                    const vs_file_version_t *prev_file_ver,
+                    const vs_file_version_t *new_file_ver,
+                    vs_update_interface_t *update_interface,
+                    const vs_mac_addr_t *gateway,
+                    bool successfully_updated) {
+}
+
+/**********************************************************/
+static bool
+_test_fldt_client_start(const vs_update_file_type_t *file_type) {
+    const vs_device_manufacture_id_t manufacturer_id = {0};
+    const vs_device_type_t device_type = {0};
+    const vs_device_serial_t device_serial = {0};
+
+    _test_fldt_mac(TEST_FLDT_CLIENT, &_test_fldt_own_mac);
+    vs_test_msec_set(TEST_FLDT_START_MS);
+
+    CHECK(VS_CODE_OK == vs_snap_init(&_test_fldt_netif, manufacturer_id, device_type, device_serial, 0),
+          "vs_snap_init call");
+    CHECK(VS_CODE_OK == vs_snap_register_service(vs_snap_fldt_client(_test_fldt_got_file)),
+          "Unable to register FLDT client");
+    CHECK(VS_CODE_OK == vs_fldt_client_add_file_type(file_type, &_test_fldt_update_ctx), "Unable to add file type");
+
+    return true;
+
+terminate:
+
+    return false;
+}
+
+/**********************************************************/
+static bool
+_test_fldt_infv(uint8_t gateway, const vs_update_file_type_t *file_type) {
+    vs_fldt_infv_new_file_request_t request;
+
+    request.type = *file_type;
+    _test_fldt_mac(gateway, &request.gateway_mac);
+
+    // Normalize byte order
+    vs_fldt_file_info_t_encode(&request);
+
+    return _test_fldt_receive(gateway, VS_FLDT_INFV, 0, &request, sizeof(request));
+}
+
+/**********************************************************/
+static bool
+_test_fldt_gnfh_response(uint8_t gateway, const vs_update_file_type_t *file_type) {
+    uint8_t buf[sizeof(vs_fldt_gnfh_header_response_t) + TEST_FLDT_HEADER_SZ];
+    vs_fldt_gnfh_header_response_t *response = (vs_fldt_gnfh_header_response_t *)buf;
+
+    VS_IOT_MEMSET(buf, 0, sizeof(buf));
+    response->fldt_info.type = *file_type;
+    _test_fldt_mac(gateway, &response->fldt_info.gateway_mac);
+    response->file_size = TEST_FLDT_FILE_SZ;
+    response->has_footer = 1;
+    response->header_size = TEST_FLDT_HEADER_SZ;
+
+    // Normalize byte order
+    vs_fldt_gnfh_header_response_t_encode(response);
+
+    return _test_fldt_receive(gateway, VS_FLDT_GNFH, VS_SNAP_FLAG_ACK, buf, sizeof(buf));
+}
+
+/**********************************************************/
+static bool
+_test_fldt_gnfd_response(uint8_t gateway, const vs_update_file_type_t *file_type, uint32_t offset) {
+    uint8_t buf[sizeof(vs_fldt_gnfd_data_response_t) + TEST_FLDT_CHUNK_SZ];
+    vs_fldt_gnfd_data_response_t *response = (vs_fldt_gnfd_data_response_t *)buf;
+
+    VS_IOT_MEMSET(buf, 0, sizeof(buf));
+    response->type = *file_type;
+    response->offset = offset;
+    response->next_offset = offset + TEST_FLDT_CHUNK_SZ;
+    response->data_size = TEST_FLDT_CHUNK_SZ;
+
+    // Normalize byte order
+    vs_fldt_gnfd_data_response_t_encode(response);
+
+    return _test_fldt_receive(gateway, VS_FLDT_GNFD, VS_SNAP_FLAG_ACK, buf, sizeof(buf));
+}
+
+/**********************************************************/
+static bool
+_test_fldt_gnff_response(uint8_t gateway, const vs_update_file_type_t *file_type) {
+    uint8_t buf[sizeof(vs_fldt_gnff_footer_response_t) + TEST_FLDT_FOOTER_SZ];
+    vs_fldt_gnff_footer_response_t *response = (vs_fldt_gnff_footer_response_t *)buf;
+
+    VS_IOT_MEMSET(buf, 0, sizeof(buf));
+    response->type = *file_type;
+    response->footer_size = TEST_FLDT_FOOTER_SZ;
+
+    // Normalize byte order
+    vs_fldt_gnff_footer_response_t_encode(response);
+
+    return _test_fldt_receive(gateway, VS_FLDT_GNFF, VS_SNAP_FLAG_ACK, buf, sizeof(buf));
+}
+
+/**********************************************************/
+static bool
+_test_fldt_retry_later(uint8_t gateway, const vs_update_file_type_t *file_type, uint32_t offset, uint32_t delay_ms) {
+    vs_fldt_retry_later_t response;
+
+    response.type = *file_type;
+    response.offset = offset;
+    response.delay_ms = delay_ms;
+
+    // Normalize byte order
+    vs_fldt_retry_later_t_encode(&response);
+
+    return _test_fldt_receive(gateway, VS_FLDT_GNFD, VS_SNAP_FLAG_NACK, &response, sizeof(response));
+}
+
+/**********************************************************/
+static uint32_t
+_test_fldt_rto(uint32_t srtt_ms, uint32_t rttvar_ms) {
+    uint32_t rto_ms = srtt_ms + 4 * rttvar_ms;
+
+    if (rto_ms < VS_FLDT_RTO_MIN_MS) {
+        return VS_FLDT_RTO_MIN_MS;
+    }
+
+    return rto_ms > VS_FLDT_RTO_MAX_MS ? VS_FLDT_RTO_MAX_MS : rto_ms;
+}
+
+/**********************************************************/
+static bool
+_test_fldt_client_rtt(const vs_update_file_type_t *file_type, uint32_t srtt_ms, uint32_t rto_ms) {
+    vs_fldt_client_stats_t stats;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_fldt_client_get_stats(file_type, &stats), "Unable to get FLDT client statistics");
+    BOOL_CHECK_RET(srtt_ms == stats.srtt_ms && rto_ms == stats.rto_ms,
+                   "Round-trip time %u ms and retransmission timeout %u ms are expected, but %u ms and %u ms are used",
+                   srtt_ms,
+                   rto_ms,
+                   stats.srtt_ms,
+                   stats.rto_ms);
+
+    return true;
+}
+
+/**********************************************************/
+static bool
+_test_fldt_client_retransmits(uint32_t timeout_ms) {
+    uint32_t requests = _test_fldt_requests_cnt;
+
+    vs_test_msec_advance(timeout_ms - 1);
+    BOOL_CHECK_RET(_test_fldt_periodical(), "Periodical processing has failed");
+    BOOL_CHECK_RET(requests == _test_fldt_requests_cnt, "Request has been repeated before timeout");
+
+    vs_test_msec_advance(1);
+    BOOL_CHECK_RET(_test_fldt_periodical(), "Periodical processing has failed");
+    BOOL_CHECK_RET(requests + 1 == _test_fldt_requests_cnt && VS_FLDT_GNFD == _test_fldt_request_element,
+                   "Request has not been repeated after timeout");
+
+    return true;
+}
+
+/**********************************************************/
+static bool
+test_fldt_client_rto(void) {
+    vs_update_file_type_t file_type;
+    vs_update_file_type_t new_file;
+    vs_fldt_client_stats_t stats;
+    uint32_t srtt_ms;
+    uint32_t rttvar_ms;
+    uint32_t rto_ms;
+
+    _test_fldt_file_type(VS_UPDATE_FIRMWARE, &file_type);
+    new_file = file_type;
+    new_file.info.version.major++;
+    CHECK(_test_fldt_client_start(&file_type), "Unable to start FLDT client");
+    CHECK(_test_fldt_client_rtt(&file_type, 0, VS_FLDT_RTO_INITIAL_MS), "Wrong initial retransmission timeout");
+
+    VS_HEADER_SUBCASE("First round-trip time sample");
+    CHECK(_test_fldt_infv(TEST_FLDT_GATEWAY, &new_file), "New file information has not been processed");
+    vs_test_msec_advance(200);
+    CHECK(_test_fldt_gnfh_response(TEST_FLDT_GATEWAY, &new_file), "Header response has not been processed");
+    srtt_ms = 200;
+    rttvar_ms = 200 / 2;
+    CHECK(_test_fldt_client_rtt(&file_type, srtt_ms, _test_fldt_rto(srtt_ms, rttvar_ms)),
+          "Wrong retransmission timeout after the first sample");
+
+    VS_HEADER_SUBCASE("Next round-trip time sample");
+    vs_test_msec_advance(100);
+    CHECK(_test_fldt_gnfd_response(TEST_FLDT_GATEWAY, &new_file, 0), "Data response has not been processed");
+    rttvar_ms = (3 * rttvar_ms + (srtt_ms - 100)) / 4;
+    srtt_ms = (7 * srtt_ms + 100) / 8;
+    rto_ms = _test_fldt_rto(srtt_ms, rttvar_ms);
+    CHECK(_test_fldt_client_rtt(&file_type, srtt_ms, rto_ms), "Wrong retransmission timeout after the next sample");
+
+    VS_HEADER_SUBCASE("Retransmitted request is not sampled");
+    CHECK(_test_fldt_client_retransmits(rto_ms), "Request has not been retransmitted by timeout");
+    rto_ms = 2 * rto_ms > VS_FLDT_RTO_MAX_MS ? VS_FLDT_RTO_MAX_MS : 2 * rto_ms;
+    vs_test_msec_advance(50);
+    CHECK(_test_fldt_gnfd_response(TEST_FLDT_GATEWAY, &new_file, TEST_FLDT_CHUNK_SZ),
+          "Data response has not been processed");
+    CHECK(_test_fldt_client_rtt(&file_type, srtt_ms, rto_ms), "Response to retransmitted request has been sampled");
+
+    VS_HEADER_SUBCASE("Backed off timeout is kept until the next sample");
+    CHECK(_test_fldt_client_retransmits(rto_ms), "Backed off timeout has not been used for the next request");
+    rto_ms = 2 * rto_ms > VS_FLDT_RTO_MAX_MS ? VS_FLDT_RTO_MAX_MS : 2 * rto_ms;
+    CHECK(_test_fldt_gnfd_response(TEST_FLDT_GATEWAY, &new_file, 2 * TEST_FLDT_CHUNK_SZ),
+          "Data response has not been processed");
+    CHECK(_test_fldt_client_rtt(&file_type, srtt_ms, rto_ms), "Response to retransmitted request has been sampled");
+    CHECK(VS_CODE_OK == vs_fldt_client_get_stats(&file_type, &stats) && 2 == stats.retries,
+          "Retransmissions have not been counted");
+
+    vs_test_msec_advance(100);
+    CHECK(_test_fldt_gnfd_response(TEST_FLDT_GATEWAY, &new_file, 3 * TEST_FLDT_CHUNK_SZ),
+          "Data response has not been processed");
+    rttvar_ms = (3 * rttvar_ms + (srtt_ms - 100)) / 4;
+    srtt_ms = (7 * srtt_ms + 100) / 8;
+    CHECK(_test_fldt_client_rtt(&file_type, srtt_ms, _test_fldt_rto(srtt_ms, rttvar_ms)),
+          "Backed off timeout has not been replaced by the new sample");
+
+    VS_HEADER_SUBCASE("Estimation is reset for another gateway");
+    new_file.info.version.major++;
+    CHECK(_test_fldt_infv(TEST_FLDT_OTHER_GATEWAY, &new_file), "New file information has not been processed");
+    CHECK(_test_fldt_client_rtt(&file_type, 0, VS_FLDT_RTO_INITIAL_MS),
+          "Round-trip time estimation has not been reset");
+
+    VS_HEADER_SUBCASE("Retransmission timeout limits");
+    CHECK(_test_fldt_gnfh_response(TEST_FLDT_OTHER_GATEWAY, &new_file), "Header response has not been processed");
+    CHECK(_test_fldt_client_rtt(&file_type, 0, VS_FLDT_RTO_MIN_MS), "Retransmission timeout is below the minimum");
+    // Smoothed round-trip time is 1/8 of the sample after zero one, variation is 1/4 of it
+    vs_test_msec_advance(8 * VS_FLDT_RTO_MAX_MS);
+    CHECK(_test_fldt_gnfd_response(TEST_FLDT_OTHER_GATEWAY, &new_file, 0), "Data response has not been processed");
+    CHECK(_test_fldt_client_rtt(&file_type, VS_FLDT_RTO_MAX_MS, VS_FLDT_RTO_MAX_MS),
+          "Retransmission timeout is above the maximum");
+
+    _test_fldt_stop();
+
+    return true;
+
+terminate:
+
+    _test_fldt_stop();
+
+    return false;
+}
+
+/**********************************************************/
+static bool
+test_fldt_client_telemetry(void) {
+    vs_update_file_type_t file_type;
+    vs_update_file_type_t new_file;
+    vs_fldt_client_stats_t stats;
+    uint32_t duration_ms = 0;
+    uint32_t offset;
+
+    _test_fldt_file_type(VS_UPDATE_FIRMWARE, &file_type);
+    new_file = file_type;
+    new_file.info.version.major++;
+    CHECK(_test_fldt_client_start(&file_type), "Unable to start FLDT client");
+    CHECK(_test_fldt_infv(TEST_FLDT_GATEWAY, &new_file), "New file information has not been processed");
+    vs_test_msec_advance(100);
+    CHECK(_test_fldt_gnfh_response(TEST_FLDT_GATEWAY, &new_file), "Header response has not been processed");
+
+    VS_HEADER_SUBCASE("Download progress");
+    for (offset = 0; offset < TEST_FLDT_FILE_SZ / 2; offset += TEST_FLDT_CHUNK_SZ) {
+        vs_test_msec_advance(10);
+        duration_ms += 10;
+        CHECK(_test_fldt_gnfd_response(TEST_FLDT_GATEWAY, &new_file, offset), "Data response has not been processed");
+    }
+    CHECK(VS_CODE_OK == vs_fldt_client_get_stats(&file_type, &stats), "Unable to get FLDT client statistics");
+    CHECK(stats.in_progress && !stats.completed && TEST_FLDT_FILE_SZ == stats.file_size &&
+                  TEST_FLDT_FILE_SZ / 2 == stats.received_size,
+          "Wrong download progress : %u of %u bytes",
+          stats.received_size,
+          stats.file_size);
+    CHECK(duration_ms == stats.duration_ms && duration_ms == stats.eta_ms,
+          "Wrong download duration %u ms or estimated time %u ms",
+          stats.duration_ms,
+          stats.eta_ms);
+
+    VS_HEADER_SUBCASE("Retries and postponed requests");
+    CHECK(_test_fldt_client_retransmits(stats.rto_ms), "Request has not been retransmitted by timeout");
+    duration_ms += stats.rto_ms;
+    CHECK(_test_fldt_retry_later(TEST_FLDT_GATEWAY, &new_file, offset, VS_FLDT_SERVER_RELAY_RETRY_MS),
+          "Retry later response has not been processed");
+    CHECK(VS_CODE_OK == vs_fldt_client_get_stats(&file_type, &stats), "Unable to get FLDT client statistics");
+    CHECK(1 == stats.retries && 1 == stats.postponed,
+          "Wrong %u retries and %u postponed requests",
+          stats.retries,
+          stats.postponed);
+
+    VS_HEADER_SUBCASE("Completed download");
+    for (; offset < TEST_FLDT_FILE_SZ; offset += TEST_FLDT_CHUNK_SZ) {
+        vs_test_msec_advance(10);
+        duration_ms += 10;
+        CHECK(_test_fldt_gnfd_response(TEST_FLDT_GATEWAY, &new_file, offset), "Data response has not been processed");
+    }
+    CHECK(VS_FLDT_GNFF == _test_fldt_request_element, "Footer has not been requested");
+    vs_test_msec_advance(10);
+    duration_ms += 10;
+    CHECK(_test_fldt_gnff_response(TEST_FLDT_GATEWAY, &new_file), "Footer response has not been processed");
+    vs_test_msec_advance(1000);
+
+    // The last download is reported without file type
+    CHECK(VS_CODE_OK == vs_fldt_client_get_stats(NULL, &stats), "Unable to get FLDT client statistics");
+    CHECK(!stats.in_progress && stats.completed && VS_CODE_OK == stats.last_error &&
+                  TEST_FLDT_FILE_SZ == stats.received_size &&
+                  0 == VS_IOT_MEMCMP(&stats.type.info.version, &new_file.info.version, sizeof(new_file.info.version)),
+          "Download has not been completed");
+    CHECK(duration_ms == stats.duration_ms && 0 == stats.eta_ms && 1 == stats.retries && 1 == stats.postponed,
+          "Wrong completed download statistics : %u ms",
+          stats.duration_ms);
+
+    _test_fldt_stop();
+
+    return true;
+
+terminate:
+
+    _test_fldt_stop();
+
+    return false;
+}
+#endif // VS_IMPL_MSEC
+
+/**********************************************************/
+static bool
+_test_snap_is_be32(const void *field, uint32_t value) {
+    const uint8_t *bytes = (const uint8_t *)field;
+
+    return bytes[0] == (uint8_t)(value >> 24) && bytes[1] == (uint8_t)(value >> 16) &&
+           bytes[2] == (uint8_t)(value >> 8) && bytes[3] == (uint8_t)value;
+}
+
+/**********************************************************/
+static bool
+test_snap_cvt_telemetry(void) {
+    vs_info_fldt_response_t fldt_info;
+    vs_info_fldt_response_t fldt_info_src;
+    vs_fldt_retry_later_t retry_later;
+    vs_fldt_retry_later_t retry_later_src;
+
+    VS_HEADER_SUBCASE("INFO FLDT statistics");
+    VS_IOT_MEMSET(&fldt_info, 0, sizeof(fldt_info));
+    _test_fldt_mac(TEST_FLDT_GATEWAY, &fldt_info.mac);
+    fldt_info.active_transfers = 0x01020304;
+    fldt_info.transfers_completed = 0x05060708;
+    fldt_info.bytes_served = 0x090A0B0C;
+    fldt_info.chunks_served = 0x0D0E0F10;
+    fldt_info.chunk_rate = 0x11121314;
+    fldt_info.retry_later = 0x15161718;
+    fldt_info.cache_hits = 0x191A1B1C;
+    fldt_info.cache_misses = 0x1D1E1F20;
+    _test_fldt_file_type(VS_UPDATE_FIRMWARE, &fldt_info.file_type);
+    fldt_info.in_progress = 1;
+    fldt_info.completed = 0;
+    fldt_info.file_size = 0x21222324;
+    fldt_info.received_size = 0x25262728;
+    fldt_info.retries = 0x292A2B2C;
+    fldt_info.postponed = 0x2D2E2F30;
+    fldt_info.srtt_ms = 0x31323334;
+    fldt_info.rto_ms = 0x35363738;
+    fldt_info.duration_ms = 0x393A3B3C;
+    fldt_info.eta_ms = 0x3D3E3F40;
+    fldt_info.last_error = VS_CODE_ERR_REQUEST_SEND;
+    fldt_info_src = fldt_info;
+
+    vs_info_fldt_response_t_encode(&fldt_info);
+    CHECK(_test_snap_is_be32(&fldt_info.active_transfers, fldt_info_src.active_transfers) &&
+                  _test_snap_is_be32(&fldt_info.cache_misses, fldt_info_src.cache_misses) &&
+                  _test_snap_is_be32(&fldt_info.file_size, fldt_info_src.file_size) &&
+                  _test_snap_is_be32(&fldt_info.eta_ms, fldt_info_src.eta_ms) &&
+                  _test_snap_is_be32(&fldt_info.last_error, (uint32_t)fldt_info_src.last_error),
+          "FLDT statistics have not been encoded to network byte order");
+    CHECK(0 == VS_IOT_MEMCMP(&fldt_info.mac, &fldt_info_src.mac, sizeof(fldt_info.mac)) &&
+                  fldt_info.in_progress == fldt_info_src.in_progress,
+          "Byte fields have been changed by encoding");
+
+    vs_info_fldt_response_t_decode(&fldt_info);
+    MEMCMP_CHECK(&fldt_info, &fldt_info_src, sizeof(fldt_info));
+
+    VS_HEADER_SUBCASE("FLDT retry later hint");
+    _test_fldt_file_type(VS_UPDATE_TRUST_LIST, &retry_later.type);
+    retry_later.offset = 0x01020304;
+    retry_later.delay_ms = 0x05060708;
+    retry_later_src = retry_later;
+
+    vs_fldt_retry_later_t_encode(&retry_later);
+    CHECK(_test_snap_is_be32(&retry_later.offset, retry_later_src.offset) &&
+                  _test_snap_is_be32(&retry_later.delay_ms, retry_later_src.delay_ms),
+          "Retry later hint has not been encoded to network byte order");
+
+    vs_fldt_retry_later_t_decode(&retry_later);
+    MEMCMP_CHECK(&retry_later, &retry_later_src, sizeof(retry_later));
+
+    return true;
+
+terminate:
+
+    return false;
+}
+
+#endif // VS_SNAP_FLDT_TEST
+
 /**********************************************************/
 uint16_t
 vs_snap_tests(void) {
@@ -119,6 +1248,19 @@ vs_snap_tests(void) {
     TEST_CASE_OK("Initialization / deinitialization", test_snap_init_deinit());
     TEST_CASE_OK("Send", test_snap_send());
     TEST_CASE_OK("Mac address", test_snap_mac_addr());
+    TEST_CASE_OK("FLDT file types index", test_fldt_mapping());
+#if VS_SNAP_FLDT_TEST
+    TEST_CASE_OK("FLDT server admission", test_fldt_server_admission());
+#if VS_FLDT_SERVER_ROUND_CHUNKS
+    TEST_CASE_OK("FLDT server round fairness", test_fldt_server_fairness());
+#endif
+    TEST_CASE_OK("FLDT server telemetry", test_fldt_server_telemetry());
+#if VS_IMPL_MSEC
+    TEST_CASE_OK("FLDT client retransmission timeout", test_fldt_client_rto());
+    TEST_CASE_OK("FLDT client telemetry", test_fldt_client_telemetry());
+#endif
+    TEST_CASE_OK("Telemetry structures conversion", test_snap_cvt_telemetry());
+#endif
 
     CHECK(VS_CODE_OK == vs_snap_deinit(test_netif), "vs_snap_deinit call");
 
@@ -0,0 +1,1321 @@
+//  Copyright (C) 2015-2020 Virgil Security, Inc.
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//      (1) Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//      (2) Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//      (3) Neither the name of the copyright holder nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//  IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//  POSSIBILITY OF SUCH DAMAGE.
+//
+//  Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+
+#include <virgil/iot/tests/helpers.h>
+#include <virgil/iot/tests/tests.h>
+#include <virgil/iot/macros/macros.h>
+#include <virgil/iot/storage_hal/storage_hal.h>
+#include <stdlib-config.h>
+
+#if VS_STORAGE_HANDLE_CACHE_TEST
+#include <virgil/iot/storage_hal/storage_handle_cache.h>
+
+#define TEST_STORAGE_FILES_QTY (4)
+#define TEST_STORAGE_FILE_SZ (64)
+
+// RAM backend for handles cache. Each open call allocates new handle, so opened backend handles are counted.
+typedef struct {
+    bool used;
+    vs_storage_element_id_t id;
+    uint8_t data[TEST_STORAGE_FILE_SZ];
+    size_t size;
+} test_storage_file_t;
+
+typedef struct {
+    vs_storage_element_id_t id;
+} test_storage_handle_t;
+
+static test_storage_file_t test_storage_files[TEST_STORAGE_FILES_QTY];
+static size_t test_storage_opened;
+static bool test_storage_destroyed;
+
+/******************************************************************************/
+static test_storage_file_t *
+_test_storage_find(const vs_storage_element_id_t id, bool create) {
+    size_t i;
+
+    for (i = 0; i < TEST_STORAGE_FILES_QTY; ++i) {
+        if (test_storage_files[i].used &&
+            0 == VS_IOT_MEMCMP(test_storage_files[i].id, id, sizeof(vs_storage_element_id_t))) {
+            return &test_storage_files[i];
+        }
+    }
+
+    for (i = 0; create && i < TEST_STORAGE_FILES_QTY; ++i) {
+        if (!test_storage_files[i].used) {
+            VS_IOT_MEMSET(&test_storage_files[i], 0, sizeof(test_storage_files[i]));
+            VS_IOT_MEMCPY(test_storage_files[i].id, id, sizeof(test_storage_files[i].id));
+            test_storage_files[i].used = true;
+            return &test_storage_files[i];
+        }
+    }
+
+    return NULL;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_deinit(vs_storage_impl_data_ctx_t storage_ctx) {
+    test_storage_destroyed = true;
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_storage_file_t
+_test_storage_open(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    test_storage_handle_t *handle = VS_IOT_CALLOC(1, sizeof(test_storage_handle_t));
+
+    if (handle) {
+        VS_IOT_MEMCPY(handle->id, id, sizeof(handle->id));
+        ++test_storage_opened;
+    }
+
+    return handle;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_sync(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_file_t file) {
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_close(const vs_storage_impl_data_ctx_t storage_ctx, vs_storage_file_t file) {
+    --test_storage_opened;
+    VS_IOT_FREE(file);
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_save(const vs_storage_impl_data_ctx_t storage_ctx,
+                   const vs_storage_file_t file,
+                   size_t offset,
+                   const uint8_t *data,
+                   size_t data_sz) {
+    test_storage_file_t *f = _test_storage_find(((const test_storage_handle_t *)file)->id, true);
+
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_NO_MEMORY);
+    CHECK_RET(offset + data_sz <= TEST_STORAGE_FILE_SZ, VS_CODE_ERR_INCORRECT_ARGUMENT, "Too big data");
+
+    VS_IOT_MEMCPY(&f->data[offset], data, data_sz);
+    if (f->size < offset + data_sz) {
+        f->size = offset + data_sz;
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_load(const vs_storage_impl_data_ctx_t storage_ctx,
+                   const vs_storage_file_t file,
+                   size_t offset,
+                   uint8_t *out_data,
+                   size_t data_sz) {
+    test_storage_file_t *f = _test_storage_find(((const test_storage_handle_t *)file)->id, false);
+
+    CHECK_NOT_ZERO_RET(f, VS_CODE_ERR_FILE_READ);
+    CHECK_RET(offset + data_sz <= f->size, VS_CODE_ERR_FILE_READ, "Too big data");
+
+    VS_IOT_MEMCPY(out_data, &f->data[offset], data_sz);
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static ssize_t
+_test_storage_size(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    test_storage_file_t *f = _test_storage_find(id, false);
+
+    return f ? (ssize_t)f->size : VS_CODE_ERR_NOT_FOUND;
+}
+
+/******************************************************************************/
+static vs_status_e
+_test_storage_del(const vs_storage_impl_data_ctx_t storage_ctx, const vs_storage_element_id_t id) {
+    test_storage_file_t *f = _test_storage_find(id, false);
+
+    if (f) {
+        f->used = false;
+    }
+
+    return VS_CODE_OK;
+}
+
+/******************************************************************************/
+static bool
+_test_handle_cache_init(vs_storage_op_ctx_t *storage, size_t max_open) {
+    vs_storage_op_ctx_t backend;
+
+    VS_IOT_MEMSET(test_storage_files, 0, sizeof(test_storage_files));
+    test_storage_opened = 0;
+    test_storage_destroyed = false;
+
+    VS_IOT_MEMSET(&backend, 0, sizeof(backend));
+    backend.impl_func.deinit = _test_storage_deinit;
+    backend.impl_func.open = _test_storage_open;
+    backend.impl_func.sync = _test_storage_sync;
+    backend.impl_func.close = _test_storage_close;
+    backend.impl_func.save = _test_storage_save;
+    backend.impl_func.load = _test_storage_load;
+    backend.impl_func.size = _test_storage_size;
+    backend.impl_func.del = _test_storage_del;
+    backend.file_sz_limit = TEST_STORAGE_FILE_SZ;
+
+    return VS_CODE_OK == vs_storage_handle_cache_init(storage, &backend, max_open);
+}
+
+/******************************************************************************/
+static bool
+_test_handle_cache_stats(const vs_storage_op_ctx_t *storage, uint32_t hits, uint32_t misses, uint32_t opened) {
+    vs_storage_handle_cache_stats_t stats;
+
+    BOOL_CHECK_RET(VS_CODE_OK == vs_storage_handle_cache_get_stats(storage, &stats), "Cannot get cache statistics");
+    BOOL_CHECK_RET(hits == stats.hits && misses == stats.misses && opened == stats.opened,
+                   "Cache statistics hits %u, misses %u, opened %u while %u, %u, %u are expected",
+                   stats.hits,
+                   stats.misses,
+                   stats.opened,
+                   hits,
+                   misses,
+                   opened);
+    BOOL_CHECK_RET(opened == test_storage_opened,
+                   "Backend has %lu opened handles while %u are expected",
+                   (unsigned long)test_storage_opened,
+                   opened);
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_handle_cache_reuse(void) {
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id = {"handle_cache_reuse"};
+    vs_storage_file_t file;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_handle_cache_init(&storage, 2), "Cannot initialize handles cache");
+
+    VS_HEADER_SUBCASE("Closed handle is kept opened");
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(VS_CODE_OK == storage.impl_func.close(storage.impl_data, file), "Cannot close element");
+    CHECK(_test_handle_cache_stats(&storage, 0, 1, 1), "Wrong statistics after the first open");
+
+    VS_HEADER_SUBCASE("Next open reuses the same handle");
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(VS_CODE_OK == storage.impl_func.close(storage.impl_data, file), "Cannot close element");
+    CHECK(_test_handle_cache_stats(&storage, 1, 1, 1), "Wrong statistics after the second open");
+
+    VS_HEADER_SUBCASE("Flush closes unreferenced handles");
+    CHECK(VS_CODE_OK == vs_storage_handle_cache_flush(&storage), "Cannot flush cache");
+    CHECK(_test_handle_cache_stats(&storage, 1, 1, 0), "Wrong statistics after flush");
+
+    res = true;
+
+terminate:
+    storage.impl_func.deinit(storage.impl_data);
+
+    return res && test_storage_destroyed;
+}
+
+/******************************************************************************/
+static bool
+_test_handle_cache_del_unreferenced(void) {
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id = {"handle_cache_del"};
+    const uint8_t data[] = "unreferenced element data";
+    vs_storage_file_t file;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_handle_cache_init(&storage, 2), "Cannot initialize handles cache");
+
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, data, sizeof(data)), "Cannot save element");
+    CHECK(VS_CODE_OK == storage.impl_func.close(storage.impl_data, file), "Cannot close element");
+
+    VS_HEADER_SUBCASE("Delete closes unreferenced handle");
+    CHECK(VS_CODE_OK == storage.impl_func.del(storage.impl_data, id), "Cannot delete element");
+    CHECK(_test_handle_cache_stats(&storage, 0, 1, 0), "Handle is kept after delete");
+    CHECK(0 > storage.impl_func.size(storage.impl_data, id), "Deleted element is present");
+
+    VS_HEADER_SUBCASE("Deleted element is opened again");
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(VS_CODE_OK == storage.impl_func.close(storage.impl_data, file), "Cannot close element");
+    CHECK(_test_handle_cache_stats(&storage, 0, 2, 1), "Deleted element handle has been reused");
+
+    res = true;
+
+terminate:
+    storage.impl_func.deinit(storage.impl_data);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_handle_cache_del_referenced(void) {
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id = {"handle_cache_stale"};
+    const uint8_t data[] = "stale element data";
+    uint8_t buf[sizeof(data)];
+    vs_storage_file_t stale = NULL;
+    vs_storage_file_t file = NULL;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_handle_cache_init(&storage, 2), "Cannot initialize handles cache");
+
+    CHECK(stale = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+
+    VS_HEADER_SUBCASE("Delete keeps referenced handle usable");
+    CHECK(VS_CODE_OK == storage.impl_func.del(storage.impl_data, id), "Cannot delete element");
+    CHECK(_test_handle_cache_stats(&storage, 0, 1, 1), "Referenced handle is closed by delete");
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, stale, 0, data, sizeof(data)),
+          "Cannot save element by stale handle");
+    CHECK(VS_CODE_OK == storage.impl_func.load(storage.impl_data, stale, 0, buf, sizeof(buf)),
+          "Cannot load element by stale handle");
+    MEMCMP_CHECK(buf, data, sizeof(data));
+
+    VS_HEADER_SUBCASE("Stale handle is not returned by open");
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(file != stale, "Stale handle has been reused");
+    CHECK(_test_handle_cache_stats(&storage, 0, 2, 2), "Wrong statistics after stale element open");
+
+    VS_HEADER_SUBCASE("Stale handle is closed by its last close");
+    CHECK(VS_CODE_OK == storage.impl_func.close(storage.impl_data, stale), "Cannot close stale handle");
+    stale = NULL;
+    CHECK(_test_handle_cache_stats(&storage, 0, 2, 1), "Stale handle is not closed");
+    CHECK(VS_CODE_OK == storage.impl_func.close(storage.impl_data, file), "Cannot close element");
+    file = NULL;
+    CHECK(_test_handle_cache_stats(&storage, 0, 2, 1), "Actual handle is not cached");
+
+    VS_HEADER_SUBCASE("Actual handle is reused");
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(_test_handle_cache_stats(&storage, 1, 2, 1), "Actual handle is not reused");
+
+    res = true;
+
+terminate:
+    if (stale) {
+        storage.impl_func.close(storage.impl_data, stale);
+    }
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    storage.impl_func.deinit(storage.impl_data);
+
+    return res;
+}
+#endif // VS_STORAGE_HANDLE_CACHE_TEST
+
+#if VS_STORAGE_LOG_TEST
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <virgil/iot/vs-log-storage/log-storage.h>
+
+#define TEST_LOG_FILE_SZ (64 * 1024)
+#define TEST_LOG_KEPT_QTY (64)
+#define TEST_LOG_COMPACTIONS (2)
+#define TEST_LOG_MAX_REWRITES (2000)
+
+static char test_log_path[64];
+
+/******************************************************************************/
+static void
+_test_log_fill(uint8_t *data, size_t data_sz, size_t seed) {
+    size_t i;
+
+    for (i = 0; i < data_sz; ++i) {
+        data[i] = (uint8_t)(seed + i);
+    }
+}
+
+/******************************************************************************/
+static bool
+_test_log_save(vs_storage_op_ctx_t *storage, const char *name, const uint8_t *data, size_t data_sz, bool sync) {
+    vs_storage_element_id_t id;
+    vs_storage_file_t file;
+    vs_status_e ret_code;
+
+    VS_IOT_MEMSET(id, 0, sizeof(id));
+    VS_IOT_STRCPY((char *)id, name);
+
+    BOOL_CHECK_RET(file = storage->impl_func.open(storage->impl_data, id), "Cannot open element %s", name);
+    ret_code = storage->impl_func.save(storage->impl_data, file, 0, data, data_sz);
+    if (VS_CODE_OK == ret_code && sync) {
+        ret_code = storage->impl_func.sync(storage->impl_data, file);
+    }
+    if (VS_CODE_OK == ret_code) {
+        ret_code = storage->impl_func.close(storage->impl_data, file);
+    } else {
+        storage->impl_func.close(storage->impl_data, file);
+    }
+    BOOL_CHECK_RET(VS_CODE_OK == ret_code, "Cannot save element %s", name);
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_log_del(vs_storage_op_ctx_t *storage, const char *name, bool sync) {
+    vs_storage_element_id_t id;
+    vs_storage_file_t file;
+    vs_status_e ret_code = VS_CODE_OK;
+
+    VS_IOT_MEMSET(id, 0, sizeof(id));
+    VS_IOT_STRCPY((char *)id, name);
+
+    BOOL_CHECK_RET(VS_CODE_OK == storage->impl_func.del(storage->impl_data, id), "Cannot delete element %s", name);
+    if (sync) {
+        BOOL_CHECK_RET(file = storage->impl_func.open(storage->impl_data, id), "Cannot open element %s", name);
+        ret_code = storage->impl_func.sync(storage->impl_data, file);
+        storage->impl_func.close(storage->impl_data, file);
+    }
+    BOOL_CHECK_RET(VS_CODE_OK == ret_code, "Cannot sync deletion of element %s", name);
+
+    return true;
+}
+
+/******************************************************************************/
+// Absent element is checked if data is NULL
+static bool
+_test_log_check(vs_storage_op_ctx_t *storage, const char *name, const uint8_t *data, size_t data_sz) {
+    vs_storage_element_id_t id;
+    vs_storage_file_t file;
+    static uint8_t buf[TEST_LOG_FILE_SZ];
+    ssize_t sz;
+    vs_status_e ret_code;
+
+    VS_IOT_MEMSET(id, 0, sizeof(id));
+    VS_IOT_STRCPY((char *)id, name);
+
+    sz = storage->impl_func.size(storage->impl_data, id);
+    if (!data) {
+        BOOL_CHECK_RET(VS_CODE_ERR_NOT_FOUND == sz, "Deleted element %s is present", name);
+        return true;
+    }
+    BOOL_CHECK_RET(sz == (ssize_t)data_sz, "Element %s has size %d while %d is expected", name, (int)sz, (int)data_sz);
+
+    BOOL_CHECK_RET(file = storage->impl_func.open(storage->impl_data, id), "Cannot open element %s", name);
+    ret_code = storage->impl_func.load(storage->impl_data, file, 0, buf, data_sz);
+    storage->impl_func.close(storage->impl_data, file);
+    BOOL_CHECK_RET(VS_CODE_OK == ret_code, "Cannot load element %s", name);
+    MEMCMP_CHECK_RET(buf, data, data_sz, false);
+
+    return true;
+}
+
+/******************************************************************************/
+static off_t
+_test_log_file_size(void) {
+    struct stat st;
+
+    return 0 == stat(test_log_path, &st) ? st.st_size : -1;
+}
+
+/******************************************************************************/
+static bool
+_test_log_reinit(vs_storage_op_ctx_t *storage, vs_log_storage_stats_t *stats) {
+    BOOL_CHECK_RET(VS_CODE_OK == storage->impl_func.deinit(storage->impl_data), "Cannot destroy log storage");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_log_storage_init(storage, test_log_path, TEST_LOG_FILE_SZ),
+                   "Cannot initialize log storage");
+    BOOL_CHECK_RET(VS_CODE_OK == vs_log_storage_get_stats(storage, stats), "Cannot get log storage statistics");
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_log_torn_tail(void) {
+    vs_storage_op_ctx_t storage;
+    vs_log_storage_stats_t stats;
+    const uint8_t first[] = "first element content";
+    const uint8_t second[] = "second element content";
+    const uint8_t rewritten[] = "rewritten content of the first element";
+    const uint8_t garbage[] = "incomplete record";
+    off_t valid_sz;
+    FILE *f;
+    bool res = false;
+
+    unlink(test_log_path);
+    BOOL_CHECK_RET(VS_CODE_OK == vs_log_storage_init(&storage, test_log_path, TEST_LOG_FILE_SZ),
+                   "Cannot initialize log storage");
+
+    CHECK(_test_log_save(&storage, "first", first, sizeof(first), false), "Cannot save the first element");
+    CHECK(_test_log_save(&storage, "second", second, sizeof(second), true), "Cannot save the second element");
+    CHECK(_test_log_reinit(&storage, &stats), "Cannot reinitialize log storage");
+    valid_sz = _test_log_file_size();
+
+    VS_HEADER_SUBCASE("Garbage after the last record is removed");
+    CHECK(f = fopen(test_log_path, "ab"), "Cannot open log file");
+    fwrite(garbage, 1, sizeof(garbage), f);
+    fclose(f);
+    CHECK(_test_log_reinit(&storage, &stats), "Cannot reinitialize log storage");
+    CHECK(sizeof(garbage) == stats.recovered_bytes, "Garbage is not removed");
+    CHECK(valid_sz == _test_log_file_size() && stats.log_sz == (size_t)valid_sz, "Log is not truncated");
+    CHECK(_test_log_check(&storage, "first", first, sizeof(first)), "The first element is damaged");
+    CHECK(_test_log_check(&storage, "second", second, sizeof(second)), "The second element is damaged");
+
+    VS_HEADER_SUBCASE("Torn record keeps previous element content");
+    CHECK(_test_log_save(&storage, "first", rewritten, sizeof(rewritten), true), "Cannot rewrite the first element");
+    CHECK(_test_log_reinit(&storage, &stats), "Cannot reinitialize log storage");
+    CHECK(0 == truncate(test_log_path, _test_log_file_size() - 1), "Cannot truncate log file");
+    CHECK(_test_log_reinit(&storage, &stats), "Cannot reinitialize log storage");
+    CHECK(stats.recovered_bytes && valid_sz == _test_log_file_size() && stats.log_sz == (size_t)valid_sz,
+          "Torn record is not removed");
+    CHECK(_test_log_check(&storage, "first", first, sizeof(first)), "The first element is not restored");
+    CHECK(_test_log_check(&storage, "second", second, sizeof(second)), "The second element is damaged");
+
+    res = true;
+
+terminate:
+    storage.impl_func.deinit(storage.impl_data);
+    unlink(test_log_path);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_log_deletion(void) {
+    vs_storage_op_ctx_t storage;
+    vs_log_storage_stats_t stats;
+    const uint8_t data[] = "element to be deleted";
+    const uint8_t resaved[] = "element saved after deletion";
+    vs_storage_element_id_t id = {"unsaved"};
+    vs_storage_file_t file = NULL;
+    uint64_t records;
+    bool res = false;
+
+    unlink(test_log_path);
+    BOOL_CHECK_RET(VS_CODE_OK == vs_log_storage_init(&storage, test_log_path, TEST_LOG_FILE_SZ),
+                   "Cannot initialize log storage");
+
+    VS_HEADER_SUBCASE("Deletion record removes element after restart");
+    CHECK(_test_log_save(&storage, "deleted", data, sizeof(data), true), "Cannot save element");
+    CHECK(_test_log_del(&storage, "deleted", true), "Cannot delete element");
+    CHECK(VS_CODE_OK == vs_log_storage_get_stats(&storage, &stats) && 2 == stats.records && 0 == stats.alive_sz,
+          "Deletion record is not appended");
+    CHECK(_test_log_reinit(&storage, &stats), "Cannot reinitialize log storage");
+    CHECK(_test_log_check(&storage, "deleted", NULL, 0), "Deleted element is restored");
+
+    VS_HEADER_SUBCASE("Deletion is dropped by the next save");
+    CHECK(_test_log_save(&storage, "resaved", data, sizeof(data), true), "Cannot save element");
+    CHECK(VS_CODE_OK == vs_log_storage_get_stats(&storage, &stats), "Cannot get log storage statistics");
+    records = stats.records;
+    CHECK(_test_log_del(&storage, "resaved", false), "Cannot delete element");
+    CHECK(_test_log_save(&storage, "resaved", resaved, sizeof(resaved), true), "Cannot save element");
+    CHECK(VS_CODE_OK == vs_log_storage_get_stats(&storage, &stats) && records + 1 == stats.records,
+          "Deletion record is appended before saved element");
+
+    VS_HEADER_SUBCASE("Element absent in the log doesn't need deletion record");
+    CHECK(VS_CODE_OK == vs_log_storage_get_stats(&storage, &stats), "Cannot get log storage statistics");
+    records = stats.records;
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, data, sizeof(data)), "Cannot save element");
+    CHECK(_test_log_del(&storage, "unsaved", true), "Cannot delete element");
+    CHECK(VS_CODE_OK == storage.impl_func.close(storage.impl_data, file), "Cannot close element");
+    file = NULL;
+    CHECK(VS_CODE_OK == vs_log_storage_get_stats(&storage, &stats) && records == stats.records,
+          "Deletion record is appended for element absent in the log");
+
+    CHECK(_test_log_reinit(&storage, &stats), "Cannot reinitialize log storage");
+    CHECK(_test_log_check(&storage, "resaved", resaved, sizeof(resaved)), "Saved element is not restored");
+    CHECK(_test_log_check(&storage, "unsaved", NULL, 0), "Deleted element is restored");
+
+    res = true;
+
+terminate:
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    storage.impl_func.deinit(storage.impl_data);
+    unlink(test_log_path);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_log_stale_handle(void) {
+    vs_storage_op_ctx_t storage;
+    vs_log_storage_stats_t stats;
+    vs_storage_element_id_t id = {"stale"};
+    const uint8_t data[] = "element content";
+    const uint8_t resaved[] = "element content saved by handle opened before deletion";
+    uint8_t buf[sizeof(data)];
+    vs_storage_file_t file = NULL;
+    bool res = false;
+
+    unlink(test_log_path);
+    BOOL_CHECK_RET(VS_CODE_OK == vs_log_storage_init(&storage, test_log_path, TEST_LOG_FILE_SZ),
+                   "Cannot initialize log storage");
+
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, data, sizeof(data)), "Cannot save element");
+    CHECK(VS_CODE_OK == storage.impl_func.sync(storage.impl_data, file), "Cannot sync element");
+
+    VS_HEADER_SUBCASE("Element deleted while its handle is opened is not loaded");
+    CHECK(_test_log_del(&storage, "stale", true), "Cannot delete element");
+    CHECK(VS_CODE_OK != storage.impl_func.load(storage.impl_data, file, 0, buf, sizeof(buf)),
+          "Deleted element is loaded");
+
+    VS_HEADER_SUBCASE("Handle opened before deletion saves element again");
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, resaved, sizeof(resaved)),
+          "Cannot save element");
+    CHECK(VS_CODE_OK == storage.impl_func.close(storage.impl_data, file), "Cannot close element");
+    file = NULL;
+    CHECK(_test_log_reinit(&storage, &stats), "Cannot reinitialize log storage");
+    CHECK(_test_log_check(&storage, "stale", resaved, sizeof(resaved)), "Element is not restored");
+
+    res = true;
+
+terminate:
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    storage.impl_func.deinit(storage.impl_data);
+    unlink(test_log_path);
+
+    return res;
+}
+
+/******************************************************************************/
+// Elements are rewritten while compaction thread copies alive records, so records appended during snapshot writing
+// are copied as the log tail. Alive records size is constant, so compaction with tail copies more than alive size.
+static bool
+_test_log_compaction(void) {
+    vs_storage_op_ctx_t storage;
+    vs_log_storage_stats_t stats;
+    static uint8_t big[TEST_LOG_FILE_SZ];
+    uint8_t small[16];
+    char name[16];
+    bool tail_copied = false;
+    size_t i;
+    bool res = false;
+
+    unlink(test_log_path);
+    BOOL_CHECK_RET(VS_CODE_OK == vs_log_storage_init(&storage, test_log_path, TEST_LOG_FILE_SZ),
+                   "Cannot initialize log storage");
+
+    // Not rewritten elements make snapshot writing longer than scheduler time slice
+    for (i = 0; i < TEST_LOG_KEPT_QTY; ++i) {
+        VS_IOT_SNPRINTF(name, sizeof(name), "kept_%d", (int)i);
+        _test_log_fill(big, sizeof(big), i);
+        CHECK(_test_log_save(&storage, name, big, sizeof(big), false), "Cannot save element %s", name);
+    }
+
+    VS_HEADER_SUBCASE("Log is compacted while elements are rewritten");
+    for (i = 0; i < TEST_LOG_MAX_REWRITES; ++i) {
+        _test_log_fill(big, sizeof(big), i);
+        _test_log_fill(small, sizeof(small), i * 3);
+        CHECK(_test_log_save(&storage, "big", big, sizeof(big), false), "Cannot save big element");
+        CHECK(_test_log_save(&storage, "small", small, sizeof(small), false), "Cannot save small element");
+        CHECK(VS_CODE_OK == vs_log_storage_get_stats(&storage, &stats), "Cannot get log storage statistics");
+        tail_copied = stats.compacted_bytes > stats.compactions * stats.alive_sz;
+        if (stats.compactions >= TEST_LOG_COMPACTIONS && tail_copied) {
+            break;
+        }
+    }
+    CHECK(stats.compactions >= TEST_LOG_COMPACTIONS, "Log is not compacted");
+    if (!tail_copied) {
+        VS_LOG_WARNING("Records haven't been appended during compaction, log tail copy isn't checked");
+    }
+    CHECK(stats.log_sz < stats.bytes_written - stats.compacted_bytes, "Log size is not reduced");
+    CHECK(_test_log_check(&storage, "big", big, sizeof(big)), "Big element is damaged");
+    CHECK(_test_log_check(&storage, "small", small, sizeof(small)), "Small element is damaged");
+
+    VS_HEADER_SUBCASE("Compacted log is restored");
+    CHECK(_test_log_reinit(&storage, &stats), "Cannot reinitialize log storage");
+    CHECK(0 == stats.recovered_bytes && (off_t)stats.log_sz == _test_log_file_size(), "Compacted log is damaged");
+    CHECK(_test_log_check(&storage, "big", big, sizeof(big)), "Big element is not restored");
+    CHECK(_test_log_check(&storage, "small", small, sizeof(small)), "Small element is not restored");
+    for (i = 0; i < TEST_LOG_KEPT_QTY; ++i) {
+        VS_IOT_SNPRINTF(name, sizeof(name), "kept_%d", (int)i);
+        _test_log_fill(big, sizeof(big), i);
+        CHECK(_test_log_check(&storage, name, big, sizeof(big)), "Element %s is not restored", name);
+    }
+
+    res = true;
+
+terminate:
+    storage.impl_func.deinit(storage.impl_data);
+    unlink(test_log_path);
+
+    return res;
+}
+#endif // VS_STORAGE_LOG_TEST
+
+#if VS_POSIX_STORAGE_TEST
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <virgil/iot/vs-posix-storage/posix-storage.h>
+#include <private/posix-storage-internal.h>
+
+#define TEST_POSIX_FILE_SZ (16 * 1024)
+#define TEST_POSIX_REQUESTS_QTY (8)
+#define TEST_POSIX_CHUNK_SZ (TEST_POSIX_FILE_SZ / TEST_POSIX_REQUESTS_QTY)
+#define TEST_POSIX_ELEMENTS_QTY (4)
+
+static char test_posix_dir[64];
+static uint8_t test_posix_data[TEST_POSIX_FILE_SZ];
+static uint8_t test_posix_buf[TEST_POSIX_FILE_SZ];
+
+/******************************************************************************/
+static void
+_test_posix_id(vs_storage_element_id_t id, uint8_t element) {
+    VS_IOT_MEMSET(id, 0, sizeof(vs_storage_element_id_t));
+    id[0] = element;
+}
+
+/******************************************************************************/
+static void
+_test_posix_fill(uint8_t *data, size_t data_sz, size_t seed) {
+    size_t i;
+
+    for (i = 0; i < data_sz; ++i) {
+        data[i] = (uint8_t)(seed + i * 7 + i / 251);
+    }
+}
+
+/******************************************************************************/
+static bool
+_test_posix_init(vs_storage_op_ctx_t *storage) {
+    BOOL_CHECK_RET(VS_CODE_OK == vs_posix_storage_init(storage, test_posix_dir, TEST_POSIX_FILE_SZ),
+                   "Cannot initialize POSIX storage");
+    _test_posix_fill(test_posix_data, sizeof(test_posix_data), 0);
+    VS_IOT_MEMSET(test_posix_buf, 0, sizeof(test_posix_buf));
+
+    return true;
+}
+
+/******************************************************************************/
+static void
+_test_posix_cleanup(vs_storage_op_ctx_t *storage) {
+    vs_storage_element_id_t id;
+    uint8_t element;
+
+    for (element = 1; element <= TEST_POSIX_ELEMENTS_QTY; ++element) {
+        _test_posix_id(id, element);
+        storage->impl_func.del(storage->impl_data, id);
+    }
+    storage->impl_func.deinit(storage->impl_data);
+    rmdir(test_posix_dir);
+}
+
+/******************************************************************************/
+static bool
+_test_posix_save(vs_storage_op_ctx_t *storage, uint8_t element, const uint8_t *data, size_t data_sz) {
+    vs_storage_element_id_t id;
+    vs_storage_file_t file;
+    vs_status_e ret_code;
+
+    _test_posix_id(id, element);
+    BOOL_CHECK_RET(file = storage->impl_func.open(storage->impl_data, id), "Cannot open element %u", element);
+    ret_code = storage->impl_func.save(storage->impl_data, file, 0, data, data_sz);
+    storage->impl_func.close(storage->impl_data, file);
+    BOOL_CHECK_RET(VS_CODE_OK == ret_code, "Cannot save element %u", element);
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_check(vs_storage_op_ctx_t *storage, uint8_t element, const uint8_t *data, size_t data_sz) {
+    vs_storage_element_id_t id;
+    vs_storage_file_t file;
+    vs_status_e ret_code;
+
+    _test_posix_id(id, element);
+    BOOL_CHECK_RET((ssize_t)data_sz == storage->impl_func.size(storage->impl_data, id),
+                   "Wrong element %u size",
+                   element);
+    BOOL_CHECK_RET(file = storage->impl_func.open(storage->impl_data, id), "Cannot open element %u", element);
+    ret_code = storage->impl_func.load(storage->impl_data, file, 0, test_posix_buf, data_sz);
+    storage->impl_func.close(storage->impl_data, file);
+    BOOL_CHECK_RET(VS_CODE_OK == ret_code, "Cannot load element %u", element);
+    MEMCMP_CHECK_RET(test_posix_buf, data, data_sz, false);
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_out_of_order(void) {
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id;
+    vs_storage_file_t file = NULL;
+    vs_storage_request_t requests[TEST_POSIX_REQUESTS_QTY];
+    uint8_t new_data[TEST_POSIX_FILE_SZ];
+    size_t i;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_posix_init(&storage), "Cannot initialize storage");
+    VS_LOG_DEBUG("Requests are performed %s",
+                 ((vs_posix_storage_t *)storage.impl_data)->uring ? "by io_uring" : "synchronously");
+    CHECK(_test_posix_save(&storage, 1, test_posix_data, sizeof(test_posix_data)), "Cannot save element");
+    _test_posix_id(id, 1);
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+
+    VS_HEADER_SUBCASE("Loads completed in reverse order");
+    for (i = 0; i < TEST_POSIX_REQUESTS_QTY; ++i) {
+        VS_IOT_MEMSET(&requests[i], 0, sizeof(requests[i]));
+        requests[i].offset = i * TEST_POSIX_CHUNK_SZ;
+        requests[i].data = &test_posix_buf[i * TEST_POSIX_CHUNK_SZ];
+        requests[i].data_sz = TEST_POSIX_CHUNK_SZ;
+        CHECK(VS_CODE_OK == storage.impl_func.submit(storage.impl_data, file, &requests[i]),
+              "Cannot submit load %u",
+              (unsigned)i);
+    }
+    for (i = TEST_POSIX_REQUESTS_QTY; i > 0; --i) {
+        CHECK(VS_CODE_OK == storage.impl_func.complete(storage.impl_data, &requests[i - 1]),
+              "Load %u has failed",
+              (unsigned)(i - 1));
+    }
+    MEMCMP_CHECK(test_posix_buf, test_posix_data, sizeof(test_posix_data));
+
+    VS_HEADER_SUBCASE("Saves completed in reverse order");
+    _test_posix_fill(new_data, sizeof(new_data), 0x55);
+    for (i = 0; i < TEST_POSIX_REQUESTS_QTY; ++i) {
+        VS_IOT_MEMSET(&requests[i], 0, sizeof(requests[i]));
+        requests[i].save = true;
+        requests[i].offset = i * TEST_POSIX_CHUNK_SZ;
+        requests[i].data = &new_data[i * TEST_POSIX_CHUNK_SZ];
+        requests[i].data_sz = TEST_POSIX_CHUNK_SZ;
+        CHECK(VS_CODE_OK == storage.impl_func.submit(storage.impl_data, file, &requests[i]),
+              "Cannot submit save %u",
+              (unsigned)i);
+    }
+    for (i = TEST_POSIX_REQUESTS_QTY; i > 0; --i) {
+        CHECK(VS_CODE_OK == storage.impl_func.complete(storage.impl_data, &requests[i - 1]),
+              "Save %u has failed",
+              (unsigned)(i - 1));
+    }
+    storage.impl_func.close(storage.impl_data, file);
+    file = NULL;
+    CHECK(_test_posix_check(&storage, 1, new_data, sizeof(new_data)), "Wrong element content after saves");
+
+    res = true;
+
+terminate:
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    _test_posix_cleanup(&storage);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_sync_fallback(void) {
+    vs_storage_op_ctx_t storage;
+    vs_posix_storage_t *posix_storage;
+    vs_posix_storage_uring_t *uring;
+    vs_storage_element_id_t id;
+    vs_storage_file_t file = NULL;
+    vs_storage_request_t request;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_posix_init(&storage), "Cannot initialize storage");
+
+    // Storage without io_uring performs requests by submit call
+    posix_storage = (vs_posix_storage_t *)storage.impl_data;
+    uring = posix_storage->uring;
+    posix_storage->uring = NULL;
+
+    CHECK(_test_posix_save(&storage, 1, test_posix_data, sizeof(test_posix_data)), "Cannot save element");
+    _test_posix_id(id, 1);
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+
+    VS_HEADER_SUBCASE("Load is performed by submit");
+    VS_IOT_MEMSET(&request, 0, sizeof(request));
+    request.offset = TEST_POSIX_CHUNK_SZ;
+    request.data = test_posix_buf;
+    request.data_sz = TEST_POSIX_CHUNK_SZ;
+    CHECK(VS_CODE_OK == storage.impl_func.submit(storage.impl_data, file, &request), "Cannot submit load");
+    CHECK(!request.impl_data && VS_CODE_OK == request.result, "Load has not been performed by submit");
+    CHECK(VS_CODE_OK == storage.impl_func.complete(storage.impl_data, &request), "Load has failed");
+    MEMCMP_CHECK(test_posix_buf, &test_posix_data[TEST_POSIX_CHUNK_SZ], TEST_POSIX_CHUNK_SZ);
+
+    VS_HEADER_SUBCASE("Save is performed by submit");
+    _test_posix_fill(test_posix_buf, TEST_POSIX_CHUNK_SZ, 0xAA);
+    VS_IOT_MEMCPY(test_posix_data, test_posix_buf, TEST_POSIX_CHUNK_SZ);
+    VS_IOT_MEMSET(&request, 0, sizeof(request));
+    request.save = true;
+    request.data = test_posix_buf;
+    request.data_sz = TEST_POSIX_CHUNK_SZ;
+    CHECK(VS_CODE_OK == storage.impl_func.submit(storage.impl_data, file, &request), "Cannot submit save");
+    CHECK(!request.impl_data && VS_CODE_OK == request.result, "Save has not been performed by submit");
+    CHECK(VS_CODE_OK == storage.impl_func.complete(storage.impl_data, &request), "Save has failed");
+
+    VS_HEADER_SUBCASE("Failed load is reported by completion");
+    VS_IOT_MEMSET(&request, 0, sizeof(request));
+    request.offset = TEST_POSIX_FILE_SZ;
+    request.data = test_posix_buf;
+    request.data_sz = TEST_POSIX_CHUNK_SZ;
+    CHECK(VS_CODE_OK == storage.impl_func.submit(storage.impl_data, file, &request), "Cannot submit load");
+    CHECK(VS_CODE_ERR_FILE_READ == storage.impl_func.complete(storage.impl_data, &request),
+          "Load past the end of element has succeeded");
+
+    storage.impl_func.close(storage.impl_data, file);
+    file = NULL;
+    CHECK(_test_posix_check(&storage, 1, test_posix_data, sizeof(test_posix_data)), "Wrong element content");
+
+    res = true;
+
+terminate:
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    posix_storage->uring = uring;
+    _test_posix_cleanup(&storage);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_short_read(void) {
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id;
+    vs_storage_file_t file = NULL;
+    vs_storage_request_t request;
+    vs_storage_buf_t bufs[2];
+    const size_t element_sz = TEST_POSIX_FILE_SZ / 2 + 3;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_posix_init(&storage), "Cannot initialize storage");
+    CHECK(_test_posix_save(&storage, 1, test_posix_data, element_sz), "Cannot save element");
+    _test_posix_id(id, 1);
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+
+    VS_HEADER_SUBCASE("Request ends at the end of element");
+    VS_IOT_MEMSET(&request, 0, sizeof(request));
+    request.offset = element_sz - TEST_POSIX_CHUNK_SZ;
+    request.data = test_posix_buf;
+    request.data_sz = TEST_POSIX_CHUNK_SZ;
+    CHECK(VS_CODE_OK == storage.impl_func.submit(storage.impl_data, file, &request), "Cannot submit load");
+    CHECK(VS_CODE_OK == storage.impl_func.complete(storage.impl_data, &request), "Load of element tail has failed");
+    MEMCMP_CHECK(test_posix_buf, &test_posix_data[request.offset], TEST_POSIX_CHUNK_SZ);
+
+    VS_HEADER_SUBCASE("Request crosses the end of element");
+    VS_IOT_MEMSET(&request, 0, sizeof(request));
+    request.offset = element_sz - TEST_POSIX_CHUNK_SZ / 2;
+    request.data = test_posix_buf;
+    request.data_sz = TEST_POSIX_CHUNK_SZ;
+    CHECK(VS_CODE_OK == storage.impl_func.submit(storage.impl_data, file, &request), "Cannot submit load");
+    CHECK(VS_CODE_ERR_FILE_READ == storage.impl_func.complete(storage.impl_data, &request),
+          "Short load has succeeded");
+
+    VS_HEADER_SUBCASE("Request starts past the end of element");
+    VS_IOT_MEMSET(&request, 0, sizeof(request));
+    request.offset = element_sz + 1;
+    request.data = test_posix_buf;
+    request.data_sz = 1;
+    CHECK(VS_CODE_OK == storage.impl_func.submit(storage.impl_data, file, &request), "Cannot submit load");
+    CHECK(VS_CODE_ERR_FILE_READ == storage.impl_func.complete(storage.impl_data, &request),
+          "Load past the end of element has succeeded");
+
+    VS_HEADER_SUBCASE("Synchronous loads cross the end of element");
+    CHECK(VS_CODE_ERR_FILE_READ ==
+                  storage.impl_func.load(storage.impl_data, file, element_sz - 1, test_posix_buf, 2),
+          "Short load has succeeded");
+    bufs[0].data = test_posix_buf;
+    bufs[0].data_sz = 1;
+    bufs[1].data = &test_posix_buf[1];
+    bufs[1].data_sz = 1;
+    CHECK(VS_CODE_ERR_FILE_READ == storage.impl_func.load_v(storage.impl_data, file, element_sz - 1, bufs, 2),
+          "Short vectored load has succeeded");
+
+    res = true;
+
+terminate:
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    _test_posix_cleanup(&storage);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_vectored(void) {
+    // Buffers sizes don't match each other, so save and load buffers boundaries differ
+    static const size_t save_sizes[] = {1, 4095, 3000, 13};
+    static const size_t load_sizes[] = {7, 5000, 2101};
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id;
+    vs_storage_file_t file = NULL;
+    vs_storage_buf_t bufs[4];
+    size_t pos;
+    size_t i;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_posix_init(&storage), "Cannot initialize storage");
+    _test_posix_id(id, 1);
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+
+    VS_HEADER_SUBCASE("Vectored save of whole element");
+    for (i = 0, pos = 0; i < sizeof(save_sizes) / sizeof(save_sizes[0]); pos += save_sizes[i], ++i) {
+        bufs[i].data = &test_posix_data[pos];
+        bufs[i].data_sz = save_sizes[i];
+    }
+    CHECK(VS_CODE_OK == storage.impl_func.save_v(storage.impl_data, file, 0, bufs, i), "Cannot save element");
+    CHECK(_test_posix_check(&storage, 1, test_posix_data, pos), "Wrong element content");
+
+    VS_HEADER_SUBCASE("Vectored load");
+    VS_IOT_MEMSET(test_posix_buf, 0, sizeof(test_posix_buf));
+    for (i = 0, pos = 0; i < sizeof(load_sizes) / sizeof(load_sizes[0]); pos += load_sizes[i], ++i) {
+        bufs[i].data = &test_posix_buf[pos];
+        bufs[i].data_sz = load_sizes[i];
+    }
+    CHECK(VS_CODE_OK == storage.impl_func.load_v(storage.impl_data, file, 1, bufs, i), "Cannot load element");
+    MEMCMP_CHECK(test_posix_buf, &test_posix_data[1], pos);
+
+    VS_HEADER_SUBCASE("Vectored save inside element");
+    _test_posix_fill(test_posix_buf, sizeof(test_posix_buf), 0x33);
+    for (i = 0, pos = 0; i < sizeof(load_sizes) / sizeof(load_sizes[0]); pos += load_sizes[i], ++i) {
+        bufs[i].data = &test_posix_buf[pos];
+        bufs[i].data_sz = load_sizes[i];
+    }
+    VS_IOT_MEMCPY(&test_posix_data[100], test_posix_buf, pos);
+    CHECK(VS_CODE_OK == storage.impl_func.save_v(storage.impl_data, file, 100, bufs, i), "Cannot save data");
+    storage.impl_func.close(storage.impl_data, file);
+    file = NULL;
+    CHECK(_test_posix_check(&storage, 1, test_posix_data, 100 + pos), "Wrong element content");
+
+    res = true;
+
+terminate:
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    _test_posix_cleanup(&storage);
+
+    return res;
+}
+/******************************************************************************/
+static bool
+_test_posix_inode(vs_storage_file_t file, ino_t *inode) {
+    struct stat st;
+
+    BOOL_CHECK_RET(0 == stat(((vs_posix_storage_file_t *)file)->path, &st), "Cannot get element status");
+    *inode = st.st_ino;
+
+    return true;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_rewrite(void) {
+    vs_storage_op_ctx_t storage;
+    vs_posix_storage_t *posix_storage;
+    vs_storage_element_id_t id;
+    vs_storage_file_t file = NULL;
+    int dir_fd;
+    ino_t prev_inode;
+    ino_t inode;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_posix_init(&storage), "Cannot initialize storage");
+    posix_storage = (vs_posix_storage_t *)storage.impl_data;
+    dir_fd = posix_storage->dir_fd;
+    _test_posix_id(id, 1);
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+
+    VS_HEADER_SUBCASE("Absent element is created by rename");
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, test_posix_data, TEST_POSIX_CHUNK_SZ),
+          "Cannot save element");
+    CHECK(((vs_posix_storage_file_t *)file)->renamed, "Element has not been renamed");
+    CHECK(_test_posix_inode(file, &prev_inode), "Cannot get element inode");
+
+    VS_HEADER_SUBCASE("Directory is synced after rename");
+    // Invalid directory descriptor makes directory sync fail, so sync call shows whether directory is synced
+    posix_storage->dir_fd = -1;
+    CHECK(VS_CODE_ERR_FILE_WRITE == storage.impl_func.sync(storage.impl_data, file),
+          "Directory has not been synced after rename");
+    posix_storage->dir_fd = dir_fd;
+    CHECK(VS_CODE_OK == storage.impl_func.sync(storage.impl_data, file), "Cannot sync element");
+    CHECK(!((vs_posix_storage_file_t *)file)->renamed, "Rename has not been stored by sync");
+
+    VS_HEADER_SUBCASE("Whole element is rewritten by rename");
+    _test_posix_fill(test_posix_data, TEST_POSIX_CHUNK_SZ, 0x11);
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, test_posix_data, TEST_POSIX_CHUNK_SZ),
+          "Cannot save element");
+    CHECK(_test_posix_inode(file, &inode), "Cannot get element inode");
+    CHECK(((vs_posix_storage_file_t *)file)->renamed && inode != prev_inode, "Element has not been renamed");
+    CHECK(VS_CODE_OK == storage.impl_func.sync(storage.impl_data, file), "Cannot sync element");
+    prev_inode = inode;
+
+    VS_HEADER_SUBCASE("Data inside element is written in place");
+    _test_posix_fill(&test_posix_data[TEST_POSIX_CHUNK_SZ / 2], TEST_POSIX_CHUNK_SZ, 0x22);
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data,
+                                               file,
+                                               TEST_POSIX_CHUNK_SZ / 2,
+                                               &test_posix_data[TEST_POSIX_CHUNK_SZ / 2],
+                                               TEST_POSIX_CHUNK_SZ),
+          "Cannot save data");
+    CHECK(_test_posix_inode(file, &inode), "Cannot get element inode");
+    CHECK(!((vs_posix_storage_file_t *)file)->renamed && inode == prev_inode, "Element has been renamed");
+
+    // Directory is not synced without rename
+    posix_storage->dir_fd = -1;
+    CHECK(VS_CODE_OK == storage.impl_func.sync(storage.impl_data, file), "Cannot sync element written in place");
+    posix_storage->dir_fd = dir_fd;
+
+    storage.impl_func.close(storage.impl_data, file);
+    file = NULL;
+    CHECK(_test_posix_check(&storage, 1, test_posix_data, TEST_POSIX_CHUNK_SZ * 3 / 2), "Wrong element content");
+
+    res = true;
+
+terminate:
+    posix_storage->dir_fd = dir_fd;
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    _test_posix_cleanup(&storage);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_reserved_rewrite(void) {
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id;
+    vs_storage_file_t file = NULL;
+    struct stat st;
+    ino_t prev_inode;
+    ino_t inode;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_posix_init(&storage), "Cannot initialize storage");
+    _test_posix_id(id, 1);
+
+    CHECK(storage.impl_func.reserve, "POSIX storage doesn't reserve space");
+    CHECK(VS_CODE_OK == storage.impl_func.reserve(storage.impl_data, id, TEST_POSIX_FILE_SZ), "Cannot reserve space");
+    CHECK(0 == storage.impl_func.size(storage.impl_data, id), "Reservation has changed element size");
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+    CHECK(0 == stat(((vs_posix_storage_file_t *)file)->path, &st), "Cannot get element status");
+    if (st.st_blocks * 512 < TEST_POSIX_FILE_SZ) {
+        VS_LOG_WARNING("File system doesn't preallocate space, so reserved element rewrite is not checked");
+        res = true;
+        goto terminate;
+    }
+    prev_inode = st.st_ino;
+
+    VS_HEADER_SUBCASE("Reserved element is written in place");
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, test_posix_data, TEST_POSIX_CHUNK_SZ),
+          "Cannot save element");
+    CHECK(_test_posix_inode(file, &inode), "Cannot get element inode");
+    CHECK(!((vs_posix_storage_file_t *)file)->renamed && inode == prev_inode, "Reserved element has been renamed");
+
+    VS_HEADER_SUBCASE("Reserved element rewrite");
+    _test_posix_fill(test_posix_data, TEST_POSIX_FILE_SZ, 0x44);
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, test_posix_data, TEST_POSIX_FILE_SZ),
+          "Cannot save element");
+    CHECK(_test_posix_inode(file, &inode), "Cannot get element inode");
+    CHECK(!((vs_posix_storage_file_t *)file)->renamed && inode == prev_inode, "Reserved element has been renamed");
+
+    storage.impl_func.close(storage.impl_data, file);
+    file = NULL;
+    CHECK(_test_posix_check(&storage, 1, test_posix_data, TEST_POSIX_FILE_SZ), "Wrong element content");
+
+    res = true;
+
+terminate:
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    _test_posix_cleanup(&storage);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_size_limit(void) {
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id;
+    vs_storage_file_t file = NULL;
+    vs_storage_request_t request;
+    vs_storage_buf_t bufs[2];
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_posix_init(&storage), "Cannot initialize storage");
+    CHECK(_test_posix_save(&storage, 1, test_posix_data, TEST_POSIX_CHUNK_SZ), "Cannot save element");
+    _test_posix_id(id, 1);
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+
+    VS_HEADER_SUBCASE("Save over size limit");
+    CHECK(VS_CODE_ERR_INCORRECT_ARGUMENT ==
+                  storage.impl_func.save(storage.impl_data, file, 0, test_posix_buf, TEST_POSIX_FILE_SZ + 1),
+          "Element over size limit has been saved");
+    CHECK(VS_CODE_ERR_INCORRECT_ARGUMENT ==
+                  storage.impl_func.save(storage.impl_data, file, TEST_POSIX_FILE_SZ - 1, test_posix_buf, 2),
+          "Data over size limit has been saved");
+
+    VS_HEADER_SUBCASE("Vectored save over size limit");
+    bufs[0].data = test_posix_buf;
+    bufs[0].data_sz = TEST_POSIX_FILE_SZ;
+    bufs[1].data = test_posix_buf;
+    bufs[1].data_sz = 1;
+    CHECK(VS_CODE_ERR_INCORRECT_ARGUMENT == storage.impl_func.save_v(storage.impl_data, file, 0, bufs, 2),
+          "Vectored save over size limit has succeeded");
+
+    VS_HEADER_SUBCASE("Asynchronous save over size limit");
+    VS_IOT_MEMSET(&request, 0, sizeof(request));
+    request.save = true;
+    request.offset = TEST_POSIX_FILE_SZ;
+    request.data = test_posix_buf;
+    request.data_sz = 1;
+    CHECK(VS_CODE_ERR_INCORRECT_ARGUMENT == storage.impl_func.submit(storage.impl_data, file, &request),
+          "Asynchronous save over size limit has been submitted");
+
+    VS_HEADER_SUBCASE("Save up to size limit");
+    CHECK(VS_CODE_OK == storage.impl_func.save(storage.impl_data, file, 0, test_posix_data, TEST_POSIX_FILE_SZ),
+          "Element of limit size has not been saved");
+
+    storage.impl_func.close(storage.impl_data, file);
+    file = NULL;
+    CHECK(_test_posix_check(&storage, 1, test_posix_data, TEST_POSIX_FILE_SZ), "Wrong element content");
+
+    res = true;
+
+terminate:
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    _test_posix_cleanup(&storage);
+
+    return res;
+}
+
+/******************************************************************************/
+static bool
+_test_posix_failed_rewrite(void) {
+    vs_storage_op_ctx_t storage;
+    vs_storage_element_id_t id;
+    vs_storage_file_t file = NULL;
+    uint8_t new_data[TEST_POSIX_CHUNK_SZ];
+    char tmp_path[256];
+    bool tmp_created = false;
+    bool res = false;
+
+    BOOL_CHECK_RET(_test_posix_init(&storage), "Cannot initialize storage");
+    CHECK(_test_posix_save(&storage, 1, test_posix_data, TEST_POSIX_CHUNK_SZ), "Cannot save element");
+    _test_posix_id(id, 1);
+    CHECK(file = storage.impl_func.open(storage.impl_data, id), "Cannot open element");
+
+    // Directory in place of temporary file makes rewrite fail
+    VS_IOT_SNPRINTF(tmp_path, sizeof(tmp_path), "%s.tmp", ((vs_posix_storage_file_t *)file)->path);
+    CHECK(0 == mkdir(tmp_path, S_IRWXU), "Cannot create %s", tmp_path);
+    tmp_created = true;
+
+    _test_posix_fill(new_data, sizeof(new_data), 0x66);
+    CHECK(VS_CODE_ERR_FILE_WRITE == storage.impl_func.save(storage.impl_data, file, 0, new_data, sizeof(new_data)),
+          "Failed rewrite has succeeded");
+    CHECK(!((vs_posix_storage_file_t *)file)->renamed, "Element has been renamed by failed rewrite");
+
+    // Element keeps previous content by the same handle and by the new one
+    CHECK(VS_CODE_OK == storage.impl_func.load(storage.impl_data, file, 0, test_posix_buf, TEST_POSIX_CHUNK_SZ),
+          "Cannot load element");
+    MEMCMP_CHECK(test_posix_buf, test_posix_data, TEST_POSIX_CHUNK_SZ);
+    storage.impl_func.close(storage.impl_data, file);
+    file = NULL;
+    CHECK(_test_posix_check(&storage, 1, test_posix_data, TEST_POSIX_CHUNK_SZ), "Wrong element content");
+
+    res = true;
+
+terminate:
+    if (tmp_created) {
+        rmdir(tmp_path);
+    }
+    if (file) {
+        storage.impl_func.close(storage.impl_data, file);
+    }
+    _test_posix_cleanup(&storage);
+
+    return res;
+}
+#endif // VS_POSIX_STORAGE_TEST
+
+/******************************************************************************/
+uint16_t
+vs_storage_test(void) {
+    uint16_t failed_test_result = 0;
+
+    START_TEST("Storage tests");
+
+#if VS_STORAGE_HANDLE_CACHE_TEST
+    TEST_CASE_OK("Handles cache reuses closed handles", _test_handle_cache_reuse());
+    TEST_CASE_OK("Handles cache closes deleted element handle", _test_handle_cache_del_unreferenced());
+    TEST_CASE_OK("Handles cache keeps deleted element handle until its close", _test_handle_cache_del_referenced());
+#endif
+
+#if VS_STORAGE_LOG_TEST
+    VS_IOT_SNPRINTF(test_log_path, sizeof(test_log_path), "/tmp/vs-storage-test-%d.log", (int)getpid());
+
+    TEST_CASE_OK("Log storage removes torn tail", _test_log_torn_tail());
+    TEST_CASE_OK("Log storage appends deletion records", _test_log_deletion());
+    TEST_CASE_OK("Log storage keeps handle of deleted element", _test_log_stale_handle());
+    TEST_CASE_OK("Log storage compaction", _test_log_compaction());
+#endif
+
+#if VS_POSIX_STORAGE_TEST
+    VS_IOT_SNPRINTF(test_posix_dir, sizeof(test_posix_dir), "/tmp/vs-posix-storage-test-%d", (int)getpid());
+
+    TEST_CASE_OK("POSIX storage completes requests out of order", _test_posix_out_of_order());
+    TEST_CASE_OK("POSIX storage performs requests synchronously without io_uring", _test_posix_sync_fallback());
+    TEST_CASE_OK("POSIX storage reports short loads", _test_posix_short_read());
+    TEST_CASE_OK("POSIX storage vectored calls", _test_posix_vectored());
+    TEST_CASE_OK("POSIX storage rewrites element by rename", _test_posix_rewrite());
+    TEST_CASE_OK("POSIX storage rewrites reserved element in place", _test_posix_reserved_rewrite());
+    TEST_CASE_OK("POSIX storage rejects elements over size limit", _test_posix_size_limit());
+    TEST_CASE_OK("POSIX storage keeps element after failed rewrite", _test_posix_failed_rewrite());
+#endif
+
+#if VS_STORAGE_HANDLE_CACHE_TEST || VS_STORAGE_LOG_TEST || VS_POSIX_STORAGE_TEST
+terminate:
+#endif
+    return failed_test_result;
+}
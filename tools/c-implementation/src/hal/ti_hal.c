@@ -34,7 +34,9 @@
 
 #include <unistd.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <time.h>
 
 /******************************************************************************/
 void
@@ -42,6 +44,15 @@ vs_impl_msleep(size_t msec) {
     usleep(msec * 1000);
 }
 
+/******************************************************************************/
+uint32_t
+vs_impl_msec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
 /******************************************************************************/
 bool
 vs_logger_output_hal(const char *buffer) {
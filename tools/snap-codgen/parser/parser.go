@@ -1,6 +1,7 @@
 package parser
 
 import (
+	"../types"
 	"bufio"
 	"bytes"
 	"errors"
@@ -22,13 +23,14 @@ func CheckEqualType(StructDataType string, DataTypes []string) bool {
 }
 
 //********************************************************************************************************************
-func GetStructrures(InputFiles []string, SkipMarker string) (AllStructs map[string]map[string]string, errret error) {
+// Structures and their fields are returned in the declaration order to get reproducible output
+func GetStructrures(InputFiles []string, SkipMarker string) (AllStructs map[string][]types.StructField_t, StructsOrder []string, errret error) {
 
 	var RLine string
 	var StructType string
-	var StructData map[string]string
+	var StructData []types.StructField_t
 
-	AllStructs = make(map[string]map[string]string)
+	AllStructs = make(map[string][]types.StructField_t)
 
 	// While on file list
 	fmt.Print("### PARSING FILES \n")
@@ -39,12 +41,12 @@ func GetStructrures(InputFiles []string, SkipMarker string) (AllStructs map[stri
 		InFile, err := os.Open(InputFileName)
 		if err != nil {
 			errret = errors.New(fmt.Sprintf("[GetStructrures]: Error opening File [%s]", InputFileName))
-			return AllStructs, errret
+			return AllStructs, StructsOrder, errret
 		}
 		FileReader := bufio.NewReader(InFile)
 		if FileReader == nil {
 			errret = errors.New(fmt.Sprintf("[GetStructrures]: Error opening Reader for File [%s]", InputFileName))
-			return AllStructs, errret
+			return AllStructs, StructsOrder, errret
 		}
 
 		//Parsing file
@@ -64,7 +66,7 @@ func GetStructrures(InputFiles []string, SkipMarker string) (AllStructs map[stri
 
 				// Clear temporary map
 				StructType = ""
-				StructData = make(map[string]string)
+				StructData = nil
 
 				// Read the body structure to "}"
 				RLine, err = FileReader.ReadString('}') // reading body structure
@@ -84,7 +86,7 @@ func GetStructrures(InputFiles []string, SkipMarker string) (AllStructs map[stri
 						    fmt.Printf("^^^ SKIP\n")
                             continue
                         }
-						StructData[FieldsStructLine[1]] = FieldsStructLine[0]
+						StructData = append(StructData, types.StructField_t{FieldsStructLine[1], FieldsStructLine[0]})
 					}
 				}
 
@@ -101,6 +103,9 @@ func GetStructrures(InputFiles []string, SkipMarker string) (AllStructs map[stri
 				//Append data to final structure
 				StructType = strings.TrimRight(strings.TrimLeft(RLine, " "), ";")
 				if len(StructType) > 0 {
+					if _, ok := AllStructs[StructType]; !ok {
+						StructsOrder = append(StructsOrder, StructType)
+					}
 					AllStructs[StructType] = StructData
 					fmt.Printf("###===--- FOUND [%s]\n", StructType)
 				}
@@ -111,11 +116,12 @@ func GetStructrures(InputFiles []string, SkipMarker string) (AllStructs map[stri
 	// If Structs not found (reset final data)
 	if len(AllStructs) < 1 {
 		AllStructs = nil
+		StructsOrder = nil
 		errret = errors.New(fmt.Sprintf("Structs not found"))
-		return AllStructs, errret
+		return AllStructs, StructsOrder, errret
 	}
 
-	return AllStructs, errret
+	return AllStructs, StructsOrder, errret
 }
 
 //********************************************************************************************************************
@@ -163,6 +169,8 @@ func ReplaceTypedefs(InputFileName string, DataTypes []string) (errret error) {
 						fmt.Println(err)
 						os.Exit(1)
 					}
+					// "uint32_t" contains "int32_t" too
+					break
 				}
 			}
 
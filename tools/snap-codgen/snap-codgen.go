@@ -18,7 +18,7 @@ import (
 // Settings
 var (
 	// Type for convert
-	ConvertTypes                   = []string{"uint16_t", "uint32_t"}
+	ConvertTypes                   = []string{"uint16_t", "uint32_t", "int32_t"}
 	ConvertEncodeFuncPrefix        = "_encode"
 	ConvertDecodeFuncPrefix        = "_decode"
 	SkipMarker                     = "CODEGEN: SKIP"
@@ -60,11 +60,12 @@ func CreateFile(FileName string) *os.File {
 
 
 //********************************************************************************************************************
-func GetCascadeData(StructsList map[string]map[string]string, StructName string) (ConvertedStrings []types.StructPrep_t) {
+func GetCascadeData(StructsList map[string][]types.StructField_t, StructName string) (ConvertedStrings []types.StructPrep_t) {
 	fmt.Printf("###=== SEARCH:[%s] \n", StructName)
 	// Search strycture by name
 	if StructData, ok := StructsList[StructName]; ok {
-		for DataName, DataType := range StructData {
+		for _, Field := range StructData {
+			DataName, DataType := Field.VarName, Field.TypeName
 			// Check base types
 			if parser.CheckEqualType(DataType, ConvertTypes)     {
 				fmt.Printf("###===--- APPEND BASE[%s] <= BASE TYPE\n", DataName)
@@ -83,11 +84,11 @@ func GetCascadeData(StructsList map[string]map[string]string, StructName string)
 }
 
 //********************************************************************************************************************
-func CreateFinalData(StructsList map[string]map[string]string) (FinData types.Structs_t) {
+func CreateFinalData(StructsList map[string][]types.StructField_t, StructsOrder []string) (FinData types.Structs_t) {
 	var StructData types.StructData_t
 
 	fmt.Print("### PREPARING FINAL DATA \n")
-	for SrcStructName, _ := range StructsList {
+	for _, SrcStructName := range StructsOrder {
 		fmt.Printf("###=== Struct: [%s]\n", SrcStructName)
 		TmpDt := GetCascadeData(StructsList, SrcStructName)
 		if len(TmpDt) > 0 {
@@ -132,7 +133,8 @@ func main() {
 		//		CTemplate *template.Template
 		//		HTemplate *template.Template
 		InFiles       TypeInFiles
-		ParsedStructs map[string]map[string]string
+		ParsedStructs map[string][]types.StructField_t
+		StructsOrder  []string
 	)
 
 	// Program argv
@@ -164,14 +166,13 @@ func main() {
 		preparedFiles = append(preparedFiles, dst)
 	}
 
-	ParsedStructs = make(map[string]map[string]string)
-	ParsedStructs, errret = parser.GetStructrures(preparedFiles, SkipMarker)
+	ParsedStructs, StructsOrder, errret = parser.GetStructrures(preparedFiles, SkipMarker)
 	if errret != nil {
 		fmt.Printf("ERROR reading Structs [%s]\n", errret)
 		os.Exit(1)
 	}
 
-	FinStructsData = CreateFinalData(ParsedStructs)
+	FinStructsData = CreateFinalData(ParsedStructs, StructsOrder)
 	if len(FinStructsData.StructsList) < 1 {
 		fmt.Println("STRUCTS FOR CONVERTINF NOT FOUND")
 		os.Exit(1)
@@ -1,5 +1,10 @@
 package types
 
+type StructField_t struct {
+	VarName  string
+	TypeName string
+}
+
 type StructPrep_t struct {
 	TypeCascade bool
 	VarName string
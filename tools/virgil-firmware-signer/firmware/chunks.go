@@ -0,0 +1,88 @@
+//   Copyright (C) 2015-2019 Virgil Security Inc.
+//
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are
+//   met:
+//
+//       (1) Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//       (2) Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in
+//       the documentation and/or other materials provided with the
+//       distribution.
+//
+//       (3) Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//   IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//   POSSIBILITY OF SUCH DAMAGE.
+//
+//   Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+package firmware
+
+import (
+	"bytes"
+	"crypto/sha256"
+	"encoding/binary"
+	"fmt"
+)
+
+const (
+	CHUNK_HASHES_META_SIZE = DESCRIPTOR_SIZE + 4 + 1 + 1 // descriptor + chunks count + hash type + signatures count
+	CHUNK_HASH_SIZE        = sha256.Size
+	CHUNK_HASH_TYPE_SHA256 = 0
+)
+
+// Size: 42 + 4 + 1 + 1 = 48
+type ChunkHashesMeta struct {
+	Descriptor      Descriptor
+	ChunksCount     uint32
+	HashType        uint8
+	SignaturesCount uint8
+}
+
+// MakeChunkHashes returns unsigned chunk hashes table: meta followed by SHA-256 of each chunkSize bytes of code.
+// Signatures of the returned data have to be appended to it
+func MakeChunkHashes(code []byte, chunkSize int, descriptor Descriptor, signaturesCount uint8) ([]byte, error) {
+	if chunkSize <= 0 {
+		return nil, fmt.Errorf("chunk size has to be specified for chunk hashes")
+	}
+
+	chunksCount := (len(code) + chunkSize - 1) / chunkSize
+	meta := ChunkHashesMeta{
+		Descriptor:      descriptor,
+		ChunksCount:     uint32(chunksCount),
+		HashType:        CHUNK_HASH_TYPE_SHA256,
+		SignaturesCount: signaturesCount,
+	}
+
+	buf := new(bytes.Buffer)
+	if err := binary.Write(buf, binary.BigEndian, meta); err != nil {
+		return nil, fmt.Errorf("failed to serialize chunk hashes meta: %v", err)
+	}
+
+	for offset := 0; offset < len(code); offset += chunkSize {
+		end := offset + chunkSize
+		if end > len(code) {
+			end = len(code)
+		}
+		hash := sha256.Sum256(code[offset:end])
+		buf.Write(hash[:])
+	}
+
+	return buf.Bytes(), nil
+}
@@ -0,0 +1,123 @@
+//   Copyright (C) 2015-2019 Virgil Security Inc.
+//
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are
+//   met:
+//
+//       (1) Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//       (2) Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in
+//       the documentation and/or other materials provided with the
+//       distribution.
+//
+//       (3) Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//   IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//   POSSIBILITY OF SUCH DAMAGE.
+//
+//   Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+package firmware
+
+import (
+	"bytes"
+	"encoding/binary"
+)
+
+const (
+	DELTA_HEADER_SIZE   = 2*DESCRIPTOR_SIZE + 4
+	DELTA_OP_COPY       = 1
+	DELTA_OP_INSERT     = 2
+	DELTA_BLOCK_SIZE    = 16 // base firmware indexing granularity
+	DELTA_MIN_COPY_SIZE = 24 // shorter matches are cheaper to insert than to copy
+)
+
+// Size: 42 + 42 + 4 = 88
+type DeltaHeader struct {
+	Base        Descriptor
+	Target      Descriptor
+	PatchLength uint32
+}
+
+// MakeDeltaPatch produces a sequence of COPY (from base) and INSERT (literal data) operations restoring target
+func MakeDeltaPatch(base []byte, target []byte) []byte {
+	patch := new(bytes.Buffer)
+
+	// Index of base blocks, the first occurrence wins
+	index := make(map[string]int)
+	for pos := 0; pos+DELTA_BLOCK_SIZE <= len(base); pos++ {
+		key := string(base[pos : pos+DELTA_BLOCK_SIZE])
+		if _, ok := index[key]; !ok {
+			index[key] = pos
+		}
+	}
+
+	insertFrom := 0
+	pos := 0
+	for pos+DELTA_BLOCK_SIZE <= len(target) {
+		basePos, ok := index[string(target[pos:pos+DELTA_BLOCK_SIZE])]
+		if !ok {
+			pos++
+			continue
+		}
+
+		matchLen := DELTA_BLOCK_SIZE
+		for pos+matchLen < len(target) && basePos+matchLen < len(base) && target[pos+matchLen] == base[basePos+matchLen] {
+			matchLen++
+		}
+
+		// Extend match backwards into pending insert data
+		matchPos := pos
+		for matchPos > insertFrom && basePos > 0 && target[matchPos-1] == base[basePos-1] {
+			matchPos--
+			basePos--
+			matchLen++
+		}
+
+		// Scanning goes on after the block, so rejected match cannot be found again
+		if matchLen < DELTA_MIN_COPY_SIZE {
+			pos++
+			continue
+		}
+
+		writeInsert(patch, target[insertFrom:matchPos])
+		writeCopy(patch, uint32(basePos), uint32(matchLen))
+
+		pos = matchPos + matchLen
+		insertFrom = pos
+	}
+
+	writeInsert(patch, target[insertFrom:])
+
+	return patch.Bytes()
+}
+
+func writeInsert(patch *bytes.Buffer, data []byte) {
+	if len(data) == 0 {
+		return
+	}
+	patch.WriteByte(DELTA_OP_INSERT)
+	_ = binary.Write(patch, binary.BigEndian, uint32(len(data)))
+	patch.Write(data)
+}
+
+func writeCopy(patch *bytes.Buffer, offset uint32, length uint32) {
+	patch.WriteByte(DELTA_OP_COPY)
+	_ = binary.Write(patch, binary.BigEndian, offset)
+	_ = binary.Write(patch, binary.BigEndian, length)
+}
@@ -0,0 +1,128 @@
+//   Copyright (C) 2015-2019 Virgil Security Inc.
+//
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are
+//   met:
+//
+//       (1) Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//       (2) Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in
+//       the documentation and/or other materials provided with the
+//       distribution.
+//
+//       (3) Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//   IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//   POSSIBILITY OF SUCH DAMAGE.
+//
+//   Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+package firmware
+
+import (
+	"bytes"
+	"encoding/binary"
+	"testing"
+	"time"
+)
+
+// applyDeltaPatch restores target from base as firmware module does
+func applyDeltaPatch(t *testing.T, base []byte, patch []byte) []byte {
+	target := new(bytes.Buffer)
+
+	for len(patch) > 0 {
+		switch patch[0] {
+		case DELTA_OP_COPY:
+			offset := binary.BigEndian.Uint32(patch[1:5])
+			length := binary.BigEndian.Uint32(patch[5:9])
+			target.Write(base[offset : offset+length])
+			patch = patch[9:]
+		case DELTA_OP_INSERT:
+			length := binary.BigEndian.Uint32(patch[1:5])
+			target.Write(patch[5 : 5+length])
+			patch = patch[5+length:]
+		default:
+			t.Fatalf("unknown delta operation %d", patch[0])
+		}
+	}
+
+	return target.Bytes()
+}
+
+func makeDeltaPatchWithTimeout(t *testing.T, base []byte, target []byte) []byte {
+	result := make(chan []byte, 1)
+
+	go func() {
+		result <- MakeDeltaPatch(base, target)
+	}()
+
+	select {
+	case patch := <-result:
+		return patch
+	case <-time.After(5 * time.Second):
+		t.Fatal("MakeDeltaPatch does not finish")
+	}
+
+	return nil
+}
+
+func TestMakeDeltaPatchShortBackwardMatch(t *testing.T) {
+	base := make([]byte, 64)
+	for i := range base {
+		base[i] = byte(i)
+	}
+
+	// Matches of DELTA_BLOCK_SIZE..DELTA_MIN_COPY_SIZE-1 bytes are found by several blocks
+	// and extended backwards before rejection
+	for matchLen := DELTA_BLOCK_SIZE; matchLen < DELTA_MIN_COPY_SIZE; matchLen++ {
+		target := append([]byte{200, 201, 202, 203, 204, 205, 206, 207}, base[10:10+matchLen]...)
+		target = append(target, 210, 211, 212, 213)
+
+		patch := makeDeltaPatchWithTimeout(t, base, target)
+		if patch[0] != DELTA_OP_INSERT || len(patch) != 5+len(target) {
+			t.Errorf("match of %d bytes is not inserted", matchLen)
+		}
+		if !bytes.Equal(applyDeltaPatch(t, base, patch), target) {
+			t.Errorf("patch for match of %d bytes does not restore target", matchLen)
+		}
+	}
+}
+
+func TestMakeDeltaPatchBackwardExtension(t *testing.T) {
+	base := make([]byte, 256)
+	for i := range base {
+		base[i] = byte(i * 7)
+	}
+
+	// The first block of the match is indexed at another base position, so the match is found by the second block
+	// and extended backwards by one byte
+	copy(base[96:96+DELTA_BLOCK_SIZE], base[20:20+DELTA_BLOCK_SIZE])
+	target := append([]byte{1, 2, 3}, base[96:160]...)
+	target = append(target, 4, 5, 6)
+
+	patch := makeDeltaPatchWithTimeout(t, base, target)
+	if !bytes.Equal(applyDeltaPatch(t, base, patch), target) {
+		t.Fatal("patch does not restore target")
+	}
+
+	copyOp := patch[5+3:]
+	if copyOp[0] != DELTA_OP_COPY || binary.BigEndian.Uint32(copyOp[1:5]) != 96 ||
+		binary.BigEndian.Uint32(copyOp[5:9]) != 64 {
+		t.Error("match is not extended backwards to its start")
+	}
+}
@@ -0,0 +1,140 @@
+//   Copyright (C) 2015-2019 Virgil Security Inc.
+//
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are
+//   met:
+//
+//       (1) Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//       (2) Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in
+//       the documentation and/or other materials provided with the
+//       distribution.
+//
+//       (3) Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR
+//   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+//   IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+//   POSSIBILITY OF SUCH DAMAGE.
+//
+//   Lead Maintainer: Virgil Security Inc. <support@virgilsecurity.com>
+
+package firmware
+
+import (
+	"fmt"
+)
+
+const (
+	LZ_HEADER_SIZE     = 4
+	LZ_MIN_MATCH       = 3
+	LZ_MAX_MATCH       = LZ_MIN_MATCH + 15
+	LZ_MIN_WINDOW_BITS = 8
+	LZ_MAX_WINDOW_BITS = 12
+	LZ_MAX_CHAIN       = 64 // matches search depth
+)
+
+// CompressLZ produces "VLZ" stream decompressed by Virgil IoTKit firmware module:
+// header ("VLZ" + window bits) followed by groups of up to 8 tokens, each group is prefixed by flags byte.
+// Flag 1 means literal byte, flag 0 means 2 bytes big-endian match: (distance - 1) << 4 | (length - 3)
+func CompressLZ(data []byte, windowBits int) ([]byte, error) {
+	if windowBits < LZ_MIN_WINDOW_BITS || windowBits > LZ_MAX_WINDOW_BITS {
+		return nil, fmt.Errorf("unsupported LZ window bits %d (%d..%d)", windowBits, LZ_MIN_WINDOW_BITS, LZ_MAX_WINDOW_BITS)
+	}
+	windowSize := 1 << uint(windowBits)
+
+	out := make([]byte, 0, LZ_HEADER_SIZE+len(data)+len(data)/8+1)
+	out = append(out, 'V', 'L', 'Z', byte(windowBits))
+
+	// Last position of each 3 bytes sequence and previous positions with the same sequence
+	head := make(map[[LZ_MIN_MATCH]byte]int)
+	prev := make([]int, len(data))
+
+	insert := func(pos int) {
+		if pos+LZ_MIN_MATCH > len(data) {
+			return
+		}
+		var key [LZ_MIN_MATCH]byte
+		copy(key[:], data[pos:])
+		if last, ok := head[key]; ok {
+			prev[pos] = last
+		} else {
+			prev[pos] = -1
+		}
+		head[key] = pos
+	}
+
+	findMatch := func(pos int) (bestLen int, distance int) {
+		maxLen := len(data) - pos
+		if maxLen < LZ_MIN_MATCH {
+			return 0, 0
+		}
+		if maxLen > LZ_MAX_MATCH {
+			maxLen = LZ_MAX_MATCH
+		}
+
+		var key [LZ_MIN_MATCH]byte
+		copy(key[:], data[pos:])
+		cand, ok := head[key]
+		for chain := 0; ok && cand >= 0 && pos-cand <= windowSize && chain < LZ_MAX_CHAIN; chain++ {
+			length := 0
+			for length < maxLen && data[cand+length] == data[pos+length] {
+				length++
+			}
+			if length > bestLen {
+				bestLen = length
+				distance = pos - cand
+				if length == maxLen {
+					break
+				}
+			}
+			cand = prev[cand]
+		}
+
+		if bestLen < LZ_MIN_MATCH {
+			return 0, 0
+		}
+		return bestLen, distance
+	}
+
+	flagsPos := 0
+	flagsCount := 8
+	for pos := 0; pos < len(data); {
+		if flagsCount == 8 {
+			flagsPos = len(out)
+			out = append(out, 0)
+			flagsCount = 0
+		}
+
+		length, distance := findMatch(pos)
+		if length != 0 {
+			token := uint16(distance-1)<<4 | uint16(length-LZ_MIN_MATCH)
+			out = append(out, byte(token>>8), byte(token))
+		} else {
+			out[flagsPos] |= 1 << uint(flagsCount)
+			out = append(out, data[pos])
+			length = 1
+		}
+		flagsCount++
+
+		for i := 0; i < length; i++ {
+			insert(pos + i)
+		}
+		pos += length
+	}
+
+	return out, nil
+}
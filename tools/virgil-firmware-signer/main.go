@@ -35,6 +35,7 @@
 package main
 
 import (
+    "./firmware"
     "./signers"
     "./utility"
     "fmt"
@@ -83,6 +84,23 @@ func main()  {
             Aliases: []string{"k"},
             Usage:   "Chunk size",
         },
+        &cli.PathFlag{
+            Name:    "delta-base",
+            Usage:   "_Prog.bin file of the installed firmware to create _Delta.bin file against (optional)",
+        },
+        &cli.BoolFlag{
+            Name:    "compress",
+            Usage:   "Store compressed firmware code in _Update.bin file (optional)",
+        },
+        &cli.IntFlag{
+            Name:    "lz-window",
+            Usage:   "Compression window as log2 of bytes amount, 8..12. It cannot exceed VS_FIRMWARE_LZ_WINDOW_BITS of devices",
+            Value:   firmware.LZ_MAX_WINDOW_BITS,
+        },
+        &cli.BoolFlag{
+            Name:    "chunk-hashes",
+            Usage:   "Store signed table of firmware chunk hashes in _Update.bin file (optional)",
+        },
     }
 
     app := &cli.App{
@@ -161,6 +179,35 @@ func signerFunc(context *cli.Context) (err error) {
     // --chunk-size
     signerUtil.ChunkSize = context.Int("chunk-size")
 
+    // --delta-base
+    if deltaBase := context.Path("delta-base"); deltaBase != "" {
+        if _, err = os.Stat(deltaBase); err != nil {
+            return fmt.Errorf("delta base file by given path %s doesn't exist", deltaBase)
+        }
+        signerUtil.DeltaBasePath = deltaBase
+    }
+
+    // --compress, --lz-window
+    if context.Bool("compress") {
+        lzWindow := context.Int("lz-window")
+        if lzWindow < firmware.LZ_MIN_WINDOW_BITS || lzWindow > firmware.LZ_MAX_WINDOW_BITS {
+            return fmt.Errorf("--lz-window (%d) has to be in range %d..%d",
+                lzWindow, firmware.LZ_MIN_WINDOW_BITS, firmware.LZ_MAX_WINDOW_BITS)
+        }
+        signerUtil.LZWindowBits = lzWindow
+    }
+
+    // --chunk-hashes
+    if context.Bool("chunk-hashes") {
+        if context.Bool("compress") {
+            return fmt.Errorf("--chunk-hashes cannot be used with --compress")
+        }
+        if signerUtil.ChunkSize <= 0 {
+            return fmt.Errorf("--chunk-hashes requires --chunk-size")
+        }
+        signerUtil.ChunkHashes = true
+    }
+
     // Sign
     err = signerUtil.CreateSignedFirmware()
     if err != nil {
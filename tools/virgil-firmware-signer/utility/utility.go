@@ -62,6 +62,9 @@ type SignerUtility struct {
 	Manufacturer    string
 	Model           string
 	ChunkSize       int
+	DeltaBasePath   string
+	LZWindowBits    int  // 0 means _Update file is not compressed
+	ChunkHashes     bool // Signed chunk hashes table is placed between _Update file header and code
 
 	progFile *firmware.ProgFile
 }
@@ -71,6 +74,7 @@ func (s *SignerUtility) CreateSignedFirmware() (err error) {
 	fwPathNoExtension := strings.TrimSuffix(fwPath, filepath.Ext(fwPath))
 	progFilePath := fwPathNoExtension + "_Prog.bin"
 	updateFilePath := fwPathNoExtension + "_Update.bin"
+	deltaFilePath := fwPathNoExtension + "_Delta.bin"
 
 	// Create _Prog file
 	if err = s.createProgFile(progFilePath); err != nil {
@@ -82,6 +86,13 @@ func (s *SignerUtility) CreateSignedFirmware() (err error) {
 		return fmt.Errorf("failed to create _Update file: %v", err)
 	}
 
+	// Create _Delta file
+	if s.DeltaBasePath != "" {
+		if err = s.createDeltaFile(deltaFilePath); err != nil {
+			return fmt.Errorf("failed to create _Delta file: %v", err)
+		}
+	}
+
 	return nil
 }
 
@@ -183,13 +194,39 @@ func (s *SignerUtility) createUpdateFile(filePath string) error {
 	fmt.Println("\nStart creation of _Update file")
 	updateBuf := new(bytes.Buffer)
 
+	// FW code, compressed one is used only if it is smaller
+	code := s.progFile.FirmwareCode
+	if s.LZWindowBits != 0 {
+		compressed, err := firmware.CompressLZ(code, s.LZWindowBits)
+		if err != nil {
+			return err
+		}
+		fmt.Printf("Code compressed: %d bytes instead of %d bytes\n", len(compressed), len(code))
+		if len(compressed) < len(code) {
+			code = compressed
+		} else {
+			fmt.Println("Compression is not effective, code is stored uncompressed")
+		}
+	}
+
+	// Chunk hashes table
+	var hashes []byte
+	if s.ChunkHashes {
+		var err error
+		if hashes, err = s.createChunkHashes(); err != nil {
+			return err
+		}
+		fmt.Printf("Chunk hashes table prepared: %d bytes\n", len(hashes))
+	}
+
 	// Header
-	fwLength := len(s.progFile.FirmwareCode)
+	codeOffset := firmware.HEADER_SIZE + len(hashes)
+	codeLength := len(code)
 	footerLen := s.calculateFooterSize()
 	header := firmware.Header{
-		CodeOffset:      firmware.HEADER_SIZE,
-		CodeLength:      uint32(fwLength),
-		FooterOffset:    uint32(firmware.HEADER_SIZE + fwLength),
+		CodeOffset:      uint32(codeOffset),
+		CodeLength:      uint32(codeLength),
+		FooterOffset:    uint32(codeOffset + codeLength),
 		FooterLength:    uint32(footerLen),
 		SignaturesCount: s.progFile.Footer.SignaturesCount,
 		Descriptor:      s.progFile.Footer.Descriptor,
@@ -201,8 +238,13 @@ func (s *SignerUtility) createUpdateFile(filePath string) error {
 		return err
 	}
 
+	// Write chunk hashes table to buffer
+	if _, err := updateBuf.Write(hashes); err != nil {
+		return err
+	}
+
 	// Write FW code to buffer
-	if err := binary.Write(updateBuf, binary.BigEndian, s.progFile.FirmwareCode); err != nil {
+	if err := binary.Write(updateBuf, binary.BigEndian, code); err != nil {
 		return err
 	}
 
@@ -233,6 +275,106 @@ func (s *SignerUtility) createUpdateFile(filePath string) error {
 	return nil
 }
 
+func (s *SignerUtility) createChunkHashes() ([]byte, error) {
+	footer := &s.progFile.Footer
+	hashes, err := firmware.MakeChunkHashes(s.progFile.FirmwareCode, s.ChunkSize, footer.Descriptor, footer.SignaturesCount)
+	if err != nil {
+		return nil, err
+	}
+
+	// Table is signed by the same keys as firmware
+	signatures, err := s.Signer.Sign(hashes)
+	if err != nil {
+		return nil, err
+	}
+
+	for _, signature := range signatures {
+		signatureBytes, err := signature.ToBytes()
+		if err != nil {
+			return nil, err
+		}
+		hashes = append(hashes, signatureBytes...)
+	}
+
+	return hashes, nil
+}
+
+func (s *SignerUtility) createDeltaFile(filePath string) error {
+	fmt.Println("\nStart creation of _Delta file")
+	deltaBuf := new(bytes.Buffer)
+
+	// Base firmware is _Prog.bin file of currently installed firmware
+	baseProg, err := ioutil.ReadFile(s.DeltaBasePath)
+	if err != nil {
+		return err
+	}
+
+	footerLen := s.calculateFooterSize()
+	if len(baseProg) < footerLen {
+		return fmt.Errorf("base _Prog file %s is too small", s.DeltaBasePath)
+	}
+
+	var baseDescriptor firmware.Descriptor
+	descriptorReader := bytes.NewReader(baseProg[len(baseProg)-footerLen+1:])
+	if err := binary.Read(descriptorReader, binary.BigEndian, &baseDescriptor); err != nil {
+		return fmt.Errorf("failed to read base firmware descriptor: %v", err)
+	}
+
+	if int(baseDescriptor.AppSize) != len(baseProg) || int(baseDescriptor.FirmwareLength) > len(baseProg)-footerLen {
+		return fmt.Errorf("base _Prog file %s has unexpected footer", s.DeltaBasePath)
+	}
+	if baseDescriptor.ManufactureID != s.progFile.Footer.Descriptor.ManufactureID ||
+		baseDescriptor.DeviceType != s.progFile.Footer.Descriptor.DeviceType {
+		return fmt.Errorf("base firmware is intended for another manufacturer or model")
+	}
+
+	patch := firmware.MakeDeltaPatch(baseProg[:baseDescriptor.FirmwareLength], s.progFile.FirmwareCode)
+	fmt.Printf("Patch prepared: %d bytes instead of %d bytes of firmware\n", len(patch), len(s.progFile.FirmwareCode))
+
+	header := firmware.DeltaHeader{
+		Base:        baseDescriptor,
+		Target:      s.progFile.Footer.Descriptor,
+		PatchLength: uint32(len(patch)),
+	}
+	fmt.Printf("Delta header prepared: %+v\n", header)
+
+	// Write header to buffer
+	if err := binary.Write(deltaBuf, binary.BigEndian, header); err != nil {
+		return err
+	}
+
+	// Write patch to buffer
+	if _, err := deltaBuf.Write(patch); err != nil {
+		return err
+	}
+
+	// Write Footer meta to buffer
+	if err := binary.Write(deltaBuf, binary.BigEndian, s.progFile.Footer.SignaturesCount); err != nil {
+		return err
+	}
+	if err := binary.Write(deltaBuf, binary.BigEndian, s.progFile.Footer.Descriptor); err != nil {
+		return err
+	}
+
+	// Write signatures to buffer
+	for _, signature := range s.progFile.Footer.Signatures {
+		signatureBytes, err := signature.ToBytes()
+		if err != nil {
+			return err
+		}
+		if err := binary.Write(deltaBuf, binary.BigEndian, signatureBytes); err != nil {
+			return err
+		}
+	}
+
+	// Save to file
+	if err := saveBufferToFile(deltaBuf, filePath); err != nil {
+		return err
+	}
+
+	return nil
+}
+
 func (s *SignerUtility) prepareVersion() (ver firmware.Version, err error) {
 	// Version parts
 	versionParts := strings.Split(s.FirmwareVersion, ".")
@@ -1 +1 @@
-from .trustlist_type import TrustList
+from .trustlist_type import TrustList, TrustListDelta
@@ -212,12 +212,14 @@ class TrustList:
                  pub_keys_dict: dict,
                  signer_keys: List[KeyGeneratorInterface],
                  tl_type: consts.TrustListType,
-                 tl_version: str
+                 tl_version: str,
+                 base_tl: bytes = None
                  ):
         self._pub_keys_dict = pub_keys_dict
         self._signer_keys = signer_keys
         self._tl_type = tl_type
         self._tl_version = FileVersion.from_string(tl_version)
+        self._base_tl = base_tl
 
         self._header = None  # type: Header
         self._body = None    # type: Body
@@ -237,6 +239,30 @@ class TrustList:
     def __len__(self):
         return len(self.header) + len(self.body) + len(self.footer)
 
+    @staticmethod
+    def parse_version(tl: bytes) -> bytes:
+        """
+        Get raw FileVersion from TrustList header
+        """
+        return tl[4:4 + FileVersion.SIZE]
+
+    @staticmethod
+    def parse_pub_keys(tl: bytes) -> List[bytes]:
+        """
+        Get raw PubKeyStructure list from TrustList body
+        """
+        pub_keys_count = int.from_bytes(tl[4 + FileVersion.SIZE:4 + FileVersion.SIZE + 2], byteorder=TL_BYTE_ORDER)
+        keys = []
+        offset = Header.SIZE
+        for _ in range(pub_keys_count):
+            ec_type = next(virgil_ec_type for virgil_ec_type, secmodule_ec_type
+                           in consts.ec_type_vs_to_secmodule_map.items() if secmodule_ec_type == tl[offset + 9])
+            meta_data_sz = int.from_bytes(tl[offset + 10:offset + 12], byteorder=TL_BYTE_ORDER)
+            key_size = 12 + meta_data_sz + consts.pub_keys_sizes[ec_type]
+            keys.append(bytes(tl[offset:offset + key_size]))
+            offset += key_size
+        return keys
+
     @property
     def header(self) -> Header:
         if self._header is None:
@@ -279,6 +305,10 @@ class TrustList:
                     pub_key=b64_to_bytes(key_data["key"])
                 )
                 keys.append(key)
+            if self._base_tl is not None:
+                # Keep base TrustList keys order, so the TrustList can be delivered as TrustListDelta
+                base_keys = self.parse_pub_keys(self._base_tl)
+                keys.sort(key=lambda k: base_keys.index(bytes(k)) if bytes(k) in base_keys else len(base_keys))
             self._body = Body(keys)
         return self._body
 
@@ -312,3 +342,51 @@ class TrustList:
                 signatures=signatures
             )
         return self._footer
+
+
+class TrustListDelta:
+    """
+    type TrustListDelta struct {
+        BaseVersion     FileVersion
+        TargetHeader    Header
+        OpsCount        uint16
+        Ops             [OpsCount]struct {
+            Op          uint8
+            PubKey      PubKeyStructure
+        }
+        TargetFooter    Footer
+    }
+    """
+    OP_REMOVE = 0
+    OP_ADD = 1
+
+    def __init__(self, base_tl: bytes, target_tl: TrustList):
+        self._base_tl = base_tl
+        self._target_tl = target_tl
+
+        self.__bytes = None
+
+    @property
+    def ops(self) -> List[tuple]:
+        base_keys = TrustList.parse_pub_keys(self._base_tl)
+        target_keys = [bytes(key) for key in self._target_tl.body.pub_keys]
+        ops = [(self.OP_REMOVE, key) for key in base_keys if key not in target_keys]
+        ops += [(self.OP_ADD, key) for key in target_keys if key not in base_keys]
+        return ops
+
+    def __bytes__(self) -> bytes:
+        if self.__bytes is None:
+            ops = self.ops
+            byte_buffer = io.BytesIO()
+            byte_buffer.write(TrustList.parse_version(self._base_tl))
+            byte_buffer.write(bytes(self._target_tl.header))
+            byte_buffer.write(len(ops).to_bytes(2, byteorder=TL_BYTE_ORDER, signed=False))
+            for op, key in ops:
+                byte_buffer.write(op.to_bytes(1, byteorder=TL_BYTE_ORDER, signed=False))
+                byte_buffer.write(key)
+            byte_buffer.write(bytes(self._target_tl.footer))
+            self.__bytes = byte_buffer.getvalue()
+        return self.__bytes
+
+    def __len__(self):
+        return len(bytes(self))
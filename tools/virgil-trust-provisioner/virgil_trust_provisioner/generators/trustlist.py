@@ -9,7 +9,7 @@ class TrustListGenerator:
         self.__ui = ui
         self.__storage = storage
 
-    def generate(self, signer_keys, tl_version):
+    def generate(self, signer_keys, tl_version, base_tl=None):
         keys_dict = self.__storage.get_all_data()
         tl_type = consts.TrustListType.RELEASE
 
@@ -17,6 +17,7 @@ class TrustListGenerator:
             pub_keys_dict=keys_dict,
             signer_keys=signer_keys,
             tl_type=tl_type,
-            tl_version=tl_version)
+            tl_version=tl_version,
+            base_tl=base_tl)
 
         return self.__tl
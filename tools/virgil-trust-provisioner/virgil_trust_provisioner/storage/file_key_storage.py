@@ -2,7 +2,7 @@ import os
 
 from virgil_trust_provisioner.core_utils import CRCCCITT
 
-from virgil_trust_provisioner.data_types import TrustList
+from virgil_trust_provisioner.data_types import TrustList, TrustListDelta
 
 
 class FileKeyStorage:
@@ -28,6 +28,16 @@ class FileKeyStorage:
         )
         open(file_path, 'wb').write(bytes(trust_list))
 
+    def __save_trust_list_delta(self, file_name, trust_list_delta):
+        file_prefix = CRCCCITT().calculate(bytes(trust_list_delta))
+        if not os.path.exists(self.storage_path):
+            os.makedirs(self.storage_path)
+        file_path = os.path.join(
+            self.storage_path,
+            file_name + '_' + str(file_prefix) + '.tld'
+        )
+        open(file_path, 'wb').write(bytes(trust_list_delta))
+
     def __save_blob(self, file_name, data):
         file_path = os.path.join(self.storage_path, file_name)
         open(file_path, 'wb').write(data)
@@ -42,5 +52,8 @@ class FileKeyStorage:
         if isinstance(data, TrustList):
             self.__save_trust_list(place, data)
 
+        if isinstance(data, TrustListDelta):
+            self.__save_trust_list_delta(place, data)
+
         if isinstance(data, (bytes, bytearray)):
             self.__save_blob(place, data)
@@ -18,7 +18,7 @@ from virgil_trust_provisioner.core_utils import cloud_key, helpers
 from virgil_trust_provisioner.core_utils.card_requests import CardRequestsHandler
 from virgil_trust_provisioner.generators.trustlist import TrustListGenerator
 from virgil_trust_provisioner.generators.keys.virgil import VirgilKeyGenerator
-from virgil_trust_provisioner.data_types.trustlist_type import Signature, PubKeyStructure
+from virgil_trust_provisioner.data_types.trustlist_type import Signature, PubKeyStructure, TrustList, TrustListDelta
 from virgil_trust_provisioner.storage import FileKeyStorage
 from virgil_trust_provisioner.storage.db_storage import DBStorage
 from virgil_trust_provisioner.storage.tl_version_tinydb_storage import TLVersionTinyDBStorage
@@ -334,17 +334,38 @@ class UtilityManager:
 
         signer_keys = [auth_key, tl_key]
 
+        # Previous release TrustList is a base for TrustListDelta
+        base_tl = self.__find_trust_list(trust_list_storage_path, current_tl_version)
+
         # Generate Trust list
-        tl = self.__trust_list_generator.generate(signer_keys, tl_version)
+        tl = self.__trust_list_generator.generate(signer_keys, tl_version, base_tl=base_tl)
         self.__ui.print_message("Generation finished")
         self.__ui.print_message("Storing to file...")
         if not storage:
             storage = FileKeyStorage(trust_list_storage_path)
         storage.save(tl, "TrustList")
         self.__ui.print_message("File stored")
+        if base_tl is not None:
+            storage.save(TrustListDelta(base_tl, tl), "TrustListDelta")
+            self.__ui.print_message("TrustListDelta from version {} stored".format(current_tl_version))
         self.__ui.print_message("TrustList generated and stored")
         self.__logger.info("TrustList generation completed")
 
+    @staticmethod
+    def __find_trust_list(storage_path, tl_version):
+        if not os.path.exists(storage_path):
+            return None
+        major, minor, patch, build = (int(ver_part) for ver_part in tl_version.split("."))
+        raw_version = bytes([major, minor, patch]) + build.to_bytes(4, byteorder="big", signed=False)
+        for file_name in sorted(os.listdir(storage_path)):
+            if not file_name.endswith(".tl"):
+                continue
+            with open(os.path.join(storage_path, file_name), "rb") as f:
+                tl = f.read()
+            if TrustList.parse_version(tl)[:len(raw_version)] == raw_version:
+                return tl
+        return None
+
     def __delete_factory_key(self):
         self.__logger.info("Factory Key deleting")
         self.__ui.print_message("Deleting Factory Key...")